@@ -58,67 +58,55 @@ _skyLight(NULL)
 	_material.Lighting = false;
 	_material.MaterialType = irr::video::E_MATERIAL_TYPE::EMT_TRANSPARENT_ALPHA_CHANNEL;
 
-	//create the geometry
-	BIO::SKY::RawGeometry * dome = BIO::SKY::CreateSkyDomeGeometry(_radius, 12, 12);
+	//create the geometry. The geometry is shared by every sky and has a
+	//radius of 1; the radius is applied in the world transform. Its arrays
+	//are shared too, so they are only read through const pointers.
+	std::shared_ptr<const BIO::SKY::RawGeometry> dome = BIO::SKY::GetSharedUnitSkyDomeGeometry(12, 12);
+	const BIO::Vector3D * domePositions = dome->vertecies;
 	
 	irr::scene::SMeshBuffer * buffer = new irr::scene::SMeshBuffer();
 
-	buffer->Indices.clear();
-	buffer->Indices.set_used(dome->numIndecies);
-	
-	for (int i = 0; i < dome->numIndecies; ++i)
-	{
-		buffer->Indices[i] = dome->indecies[i];
-	}
+	//S3DVertex is position, normal, color and UV coordinates so the
+	//vertecies and indecies are each uploaded with one copy.
+	BIO::SKY::GeometryBuffer domeData(*dome, BIO::SKY::GeometryFormat::PositionNormalColorUV());
 
-	// Create vertices
-	irr::video::SColor clr(255, 255, 255, 255);
+	buffer->Indices.set_used(domeData.GetIndexCount());
+	memcpy(buffer->Indices.pointer(), domeData.GetIndexData(), domeData.GetIndexDataSize());
 
-	buffer->Vertices.clear();
-	buffer->Vertices.reallocate(dome->numVertecies);
-	
-	for (int i = 0; i < dome->numVertecies; i++)
-	{
-		buffer->Vertices.push_back(irr::video::S3DVertex(dome->vertecies[i].X, dome->vertecies[i].Y, dome->vertecies[i].Z, -1, -1, -1, clr, dome->UVTextureCoordinates[i].X, dome->UVTextureCoordinates[i].Y));
-	}
+	buffer->Vertices.set_used(domeData.GetVertexCount());
+	memcpy(buffer->Vertices.pointer(), domeData.GetVertexData(), domeData.GetVertexDataSize());
 
 	// Recalculate bounding box
 	buffer->BoundingBox.reset(0, 0, 0);
 	
 	for (int i = 0; i < dome->numVertecies; ++i)
 	{
-		buffer->BoundingBox.addInternalPoint(buffer->Vertices[i].Pos);
+		buffer->BoundingBox.addInternalPoint(domePositions[i].X, domePositions[i].Y, domePositions[i].Z);
 	}
 
+	_bBox = irr::core::aabbox3d<irr::f32>(
+		buffer->BoundingBox.MinEdge * _radius,
+		buffer->BoundingBox.MaxEdge * _radius);
+
 	_geometry = buffer;
 	buffer = NULL;
 
-	delete dome;
-	dome = NULL;
-
 	
-	BIO::SKY::RawGeometry * night = BIO::SKY::CreateNightSkyDomeGeometry(_radius);
+	std::shared_ptr<const BIO::SKY::RawGeometry> night = BIO::SKY::GetSharedNightSkyDomeGeometry(1.0f);
+	const BIO::Vector3D * nightPositions = night->vertecies;
 	
 	irr::scene::SMeshBuffer * bufferNight = new irr::scene::SMeshBuffer();
-	bufferNight->Indices.clear();
-	bufferNight->Indices.set_used(night->numIndecies);
-	for (int i = 0; i < night->numIndecies; ++i)
-	{
-		bufferNight->Indices[i] = night->indecies[i];
-	}
-	bufferNight->Vertices.clear();
-	bufferNight->Vertices.reallocate(night->numVertecies);
-	for (int i = 0; i < night->numVertecies; i++)
-	{
-		bufferNight->Vertices.push_back(irr::video::S3DVertex(night->vertecies[i].X, night->vertecies[i].Y, night->vertecies[i].Z, -1, -1, -1, clr, night->UVTextureCoordinates[i].X, night->UVTextureCoordinates[i].Y));
-	}
+	BIO::SKY::GeometryBuffer nightData(*night, BIO::SKY::GeometryFormat::PositionNormalColorUV());
+	bufferNight->Indices.set_used(nightData.GetIndexCount());
+	memcpy(bufferNight->Indices.pointer(), nightData.GetIndexData(), nightData.GetIndexDataSize());
+	bufferNight->Vertices.set_used(nightData.GetVertexCount());
+	memcpy(bufferNight->Vertices.pointer(), nightData.GetVertexData(), nightData.GetVertexDataSize());
 	bufferNight->BoundingBox.reset(0, 0, 0);
 	for (int i = 0; i < night->numVertecies; ++i)
 	{
-		bufferNight->BoundingBox.addInternalPoint(bufferNight->Vertices[i].Pos);
+		bufferNight->BoundingBox.addInternalPoint(nightPositions[i].X, nightPositions[i].Y, nightPositions[i].Z);
 	}
 	_nightGeometry = bufferNight;
-	delete night;
 
 	//Create the sun
 	
@@ -127,18 +115,15 @@ _skyLight(NULL)
 
 	int sizeOfTexture = 128;//50;
 	_sunTexture = sm->getVideoDriver()->addTexture(irr::core::dimension2du(sizeOfTexture, sizeOfTexture), "_internal/Sky/SunTexture");
-	unsigned char * tmptex = BIO::SKY::CreateSunTexture(sizeOfTexture);
+	std::shared_ptr<const BIO::SKY::TextureMipChain> sunChain = BIO::SKY::CreateSunTextureMipChain(sizeOfTexture);
 	unsigned char * locked = (unsigned char *)_sunTexture->lock();
-	for (int i = 0; i < sizeOfTexture * sizeOfTexture * 4; i++)
-	{
-		locked[i] = tmptex[i];
-	}
+	memcpy((void*)locked, (void*)sunChain->GetLevel(0).pixels, sizeof(unsigned char) * sizeOfTexture * sizeOfTexture * 4);
 	_sunTexture->unlock();
-	delete[] tmptex;
+	_sunTexture->regenerateMipMapLevels((void*)sunChain->GetLevel(1).pixels);
 
 	_sun->setMaterialTexture(0, _sunTexture);
 	_sun->setMaterialFlag(irr::video::EMF_LIGHTING, false);
-	_sun->setMaterialFlag(irr::video::EMF_USE_MIP_MAPS, false);
+	_sun->setMaterialFlag(irr::video::EMF_USE_MIP_MAPS, true);
 	_sun->setMaterialType(irr::video::EMT_TRANSPARENT_ALPHA_CHANNEL);
 	//-----------------------------------------------------
 
@@ -150,7 +135,7 @@ _skyLight(NULL)
 	int moonTextureWidth = 0;
 	int moonTextureHeight = 0;
 
-	tmptex = BIO::SKY::CreateMoonTexture(&moonTextureWidth, &moonTextureHeight);
+	unsigned char * tmptex = BIO::SKY::CreateMoonTexture(&moonTextureWidth, &moonTextureHeight);
 
 	_moonTexture = sm->getVideoDriver()->addTexture(irr::core::dimension2du(moonTextureWidth, moonTextureHeight), "_internal/Sky/MoonTexture");
 
@@ -160,7 +145,7 @@ _skyLight(NULL)
 		locked[i] = tmptex[i];
 	}
 	_moonTexture->unlock();
-	delete[] tmptex;
+	BIO::SKY::FreeTexture(tmptex);
 
 	_moon->setMaterialTexture(0, _moonTexture);
 	_moon->setMaterialFlag(irr::video::EMF_LIGHTING, false);
@@ -169,33 +154,37 @@ _skyLight(NULL)
 	//-----------------------------------------------------
 
 	//Setup Night material --------------------------------
-	int nightTextureWidth = 0;
-	int nightTextureHeight = 0;
-
-	tmptex = BIO::SKY::CreateNightSkyTexture(&nightTextureWidth, &nightTextureHeight);
+	std::shared_ptr<const BIO::SKY::TextureMipChain> nightChain = BIO::SKY::CreateNightSkyTextureMipChain();
 
-	_nightTexture = sm->getVideoDriver()->addTexture(irr::core::dimension2du(nightTextureWidth, nightTextureHeight), "_internal/Sky/NightSkyTexture");
-
-	
-
-	locked = (unsigned char *)_nightTexture->lock();
-	/*for (int i = 0; i < nightTextureWidth * nightTextureHeight * 4; i++)
+	if (nightChain)
 	{
-		locked[i] = tmptex[i];
-	}*/
-	memcpy((void*)locked, (void*)tmptex, sizeof(unsigned char) * nightTextureWidth * nightTextureHeight * 4);
-	_nightTexture->unlock();
-	delete[] tmptex;
+		const BIO::SKY::TextureMipChain::Level & base = nightChain->GetLevel(0);
+
+		_nightTexture = sm->getVideoDriver()->addTexture(irr::core::dimension2du(base.width, base.height), "_internal/Sky/NightSkyTexture");
+	}
 
 	if (_nightTexture == NULL)
 	{
 		std::cout << "ERROR GETTING NIGHT SKY TEXTURE" << std::endl;
 	}
+	else
+	{
+		const BIO::SKY::TextureMipChain::Level & base = nightChain->GetLevel(0);
+
+		locked = (unsigned char *)_nightTexture->lock();
+		memcpy((void*)locked, (void*)base.pixels, sizeof(unsigned char) * base.width * base.height * 4);
+		_nightTexture->unlock();
+
+		//upload our own filtered mip levels. The levels after the first
+		//are stored one after another in the chain.
+		if (nightChain->GetLevelCount() > 1)
+			_nightTexture->regenerateMipMapLevels((void*)nightChain->GetLevel(1).pixels);
+	}
 
 	_nightMaterial.setTexture(0, _nightTexture);
 	_nightMaterial.Wireframe = false;
 	_nightMaterial.Lighting = false;
-	_nightMaterial.UseMipMaps = false;
+	_nightMaterial.UseMipMaps = true;
 	_nightMaterial.MaterialType = irr::video::E_MATERIAL_TYPE::EMT_TRANSPARENT_ALPHA_CHANNEL;
 	//-----------------------------------------------------
 
@@ -278,8 +267,12 @@ void IrrBIOSkyDome::render()
 {
 	irr::video::IVideoDriver * driver = SceneManager->getVideoDriver();
 
+	//the dome geometry has a radius of 1
+	irr::core::matrix4 scale;
+	scale.setScale(_radius);
+
 	//set the transform
-	driver->setTransform(irr::video::ETS_WORLD, _starTransformations);
+	driver->setTransform(irr::video::ETS_WORLD, _starTransformations * scale);
 
 	if (_nightGeometry)
 	{
@@ -288,7 +281,7 @@ void IrrBIOSkyDome::render()
 		driver->drawMeshBuffer(_nightGeometry);
 	}
 
-	driver->setTransform(irr::video::ETS_WORLD, AbsoluteTransformation);
+	driver->setTransform(irr::video::ETS_WORLD, AbsoluteTransformation * scale);
 	if (_geometry)
 	{
 		//draw day
@@ -305,7 +298,7 @@ void IrrBIOSkyDome::render()
 
 const irr::core::aabbox3d<irr::f32> & IrrBIOSkyDome::getBoundingBox() const
 {
-	return _geometry->getBoundingBox();
+	return _bBox;
 }
 
 irr::u32 IrrBIOSkyDome::getMaterialCount() const
@@ -0,0 +1,373 @@
+/**
+* @file Allocator.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* The allocator used for every block of memory the BIOSky library creates.
+* Applications can replace it to route the library's memory through their own
+* arenas, and can read the allocation statistics for leak and budget
+* tracking.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_ALLOCATOR_HPP__2015___
+#define ___BIOSKY_ALLOCATOR_HPP__2015___
+
+#include "CompileConfig.h"
+
+#include <cstddef>
+#include <new>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**The alignment used when no alignment is requested.*/
+		const std::size_t DefaultAlignment = 16;
+
+		/**
+		* Interface for a memory allocator. Implement this and pass it to
+		* SetAllocator to control where the library's memory comes from.
+		*
+		* @note The functions of this interface can be called from any thread
+		*		the library is used on.
+		*/
+		class IAllocator
+		{
+		public:
+			/**
+			* Destructor
+			*/
+			virtual ~IAllocator() {}
+
+			/**
+			* Allocate a block of memory.
+			*
+			* @param size The number of bytes to allocate.
+			*
+			* @param alignment The alignment of the block. This is always a
+			*			power of two.
+			*
+			* @return Returns a pointer to the block or NULL on failure.
+			*/
+			virtual void * Allocate(std::size_t size, std::size_t alignment) = 0;
+
+			/**
+			* Release a block returned by Allocate.
+			*
+			* @param memory The block to release.
+			*/
+			virtual void Deallocate(void * memory) = 0;
+		};
+
+		/**
+		* Statistics for the memory allocated through the library allocator.
+		* Sizes are the sizes requested by the library and do not include
+		* any bookkeeping overhead.
+		*/
+		struct AllocationStats
+		{
+			/**Bytes that are currently allocated.*/
+			std::size_t currentBytes;
+			/**The highest value currentBytes has reached.*/
+			std::size_t peakBytes;
+			/**Total bytes ever allocated.*/
+			std::size_t totalBytes;
+			/**Number of blocks currently allocated.*/
+			std::size_t currentAllocations;
+			/**Total number of blocks ever allocated.*/
+			std::size_t totalAllocations;
+			/**Total number of blocks ever released.*/
+			std::size_t totalFrees;
+		};
+
+		/**
+		* Set the allocator the library uses for all new allocations. Memory
+		* that was allocated before the change is still released through the
+		* allocator that created it.
+		*
+		* @param allocator The allocator to use. It must stay alive until all
+		*			the memory it allocated has been released. Pass NULL to
+		*			go back to the default (malloc based) allocator.
+		*/
+		BIOSKY_API void SetAllocator(IAllocator * allocator);
+
+		/**
+		* Get the allocator the library is currently using.
+		*/
+		BIOSKY_API IAllocator * GetAllocator();
+
+		/**
+		* Allocate memory through the library allocator.
+		*
+		* @param size The number of bytes to allocate.
+		*
+		* @param alignment The alignment of the memory. Must be a power of
+		*			two.
+		*
+		* @return Returns the memory or NULL if size is 0 or the allocation
+		*			failed. Release it with Free.
+		*/
+		BIOSKY_API void * Allocate(std::size_t size, std::size_t alignment = DefaultAlignment);
+
+		/**
+		* Release memory returned by Allocate. NULL is ignored.
+		*/
+		BIOSKY_API void Free(void * memory);
+
+		/**
+		* Get the size that was requested for a block returned by Allocate.
+		*/
+		BIOSKY_API std::size_t GetAllocationSize(const void * memory);
+
+		/**
+		* Get the current allocation statistics.
+		*/
+		BIOSKY_API AllocationStats GetAllocationStats();
+
+		/**
+		* Reset the peak bytes statistic to the current number of bytes.
+		*/
+		BIOSKY_API void ResetAllocationPeak();
+
+		/**
+		* Allocate and default construct an array.
+		*
+		* @param count The number of elements.
+		*
+		* @return Returns the array or NULL if count is not positive. Release
+		*			it with FreeArray.
+		*
+		* @note Throws std::bad_alloc when the allocator returns NULL, the
+		*		same as new[].
+		*/
+		template <typename T>
+		T * AllocateArray(int count);
+
+		/**
+		* Destroy and release an array created by AllocateArray.
+		*/
+		template <typename T>
+		void FreeArray(T * memory);
+
+		/**
+		* Allocate and construct a single object. Release it with Delete.
+		*
+		* @note Throws std::bad_alloc when the allocator returns NULL, the
+		*		same as new.
+		*/
+		template <typename T>
+		T * New();
+
+		/**
+		* Allocate and copy construct a single object. Release it with
+		* Delete.
+		*/
+		template <typename T>
+		T * New(const T & other);
+
+		/**
+		* Destroy and release an object created by New.
+		*/
+		template <typename T>
+		void Delete(T * object);
+
+		/**
+		* A standard library allocator that gets its memory from the library
+		* allocator, so scratch containers show up in the allocation
+		* statistics and in a custom IAllocator.
+		*
+		* @note Throws std::bad_alloc when the allocator returns NULL, the
+		*		same as std::allocator.
+		*/
+		template <typename T>
+		class StlAllocator
+		{
+		public:
+			typedef T value_type;
+			typedef T * pointer;
+			typedef const T * const_pointer;
+			typedef T & reference;
+			typedef const T & const_reference;
+			typedef std::size_t size_type;
+			typedef std::ptrdiff_t difference_type;
+
+			template <typename U>
+			struct rebind
+			{
+				typedef StlAllocator<U> other;
+			};
+
+			StlAllocator() {}
+
+			template <typename U>
+			StlAllocator(const StlAllocator<U> &) {}
+
+			pointer address(reference value) const { return &value; }
+			const_pointer address(const_reference value) const { return &value; }
+
+			pointer allocate(size_type count, const void * = 0);
+			void deallocate(pointer memory, size_type) { Free(memory); }
+
+			size_type max_size() const { return ((size_type)-1) / sizeof(T); }
+
+			void construct(pointer memory, const T & value) { new ((void *)memory) T(value); }
+			void destroy(pointer memory) { memory->~T(); }
+
+			template <typename U>
+			bool operator==(const StlAllocator<U> &) const { return true; }
+
+			template <typename U>
+			bool operator!=(const StlAllocator<U> &) const { return false; }
+		};
+
+#if BIOSKY_TESTING == 1
+		/**
+		* Test the allocator functions.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		bool AllocatorTests(XNELO::TESTING::Test * test);
+#endif
+	}//end namespace SKY
+}//end namespace BIO
+
+template <typename T>
+inline T * BIO::SKY::AllocateArray(int count)
+{
+	if (count <= 0)
+		return NULL;
+
+	if ((std::size_t)count > ((std::size_t)-1) / sizeof(T))
+		throw std::bad_alloc();
+
+	T * memory = (T *)Allocate(sizeof(T) * count);
+
+	if (memory == NULL)
+		throw std::bad_alloc();
+
+	int constructed = 0;
+
+	try
+	{
+		for (; constructed < count; ++constructed)
+			new (memory + constructed) T();
+	}
+	catch (...)
+	{
+		while (constructed > 0)
+			memory[--constructed].~T();
+
+		Free(memory);
+		throw;
+	}
+
+	return memory;
+}
+
+template <typename T>
+inline void BIO::SKY::FreeArray(T * memory)
+{
+	if (memory == NULL)
+		return;
+
+	std::size_t count = GetAllocationSize(memory) / sizeof(T);
+
+	for (std::size_t i = 0; i < count; ++i)
+		memory[i].~T();
+
+	Free(memory);
+}
+
+template <typename T>
+inline T * BIO::SKY::New()
+{
+	void * memory = Allocate(sizeof(T));
+
+	if (memory == NULL)
+		throw std::bad_alloc();
+
+	try
+	{
+		return new (memory)T();
+	}
+	catch (...)
+	{
+		Free(memory);
+		throw;
+	}
+}
+
+template <typename T>
+inline T * BIO::SKY::New(const T & other)
+{
+	void * memory = Allocate(sizeof(T));
+
+	if (memory == NULL)
+		throw std::bad_alloc();
+
+	try
+	{
+		return new (memory)T(other);
+	}
+	catch (...)
+	{
+		Free(memory);
+		throw;
+	}
+}
+
+template <typename T>
+inline void BIO::SKY::Delete(T * object)
+{
+	if (object == NULL)
+		return;
+
+	object->~T();
+	Free(object);
+}
+
+template <typename T>
+inline T * BIO::SKY::StlAllocator<T>::allocate(size_type count, const void *)
+{
+	if (count == 0)
+		return NULL;
+
+	if (count > max_size())
+		throw std::bad_alloc();
+
+	T * memory = (T *)Allocate(sizeof(T) * count);
+
+	if (memory == NULL)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+#endif //___BIOSKY_ALLOCATOR_HPP__2015___
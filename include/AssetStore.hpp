@@ -0,0 +1,151 @@
+/**
+* @file AssetStore.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A shared, thread safe store for assets (textures, mip chains, geometry...)
+* that are expensive to generate and can be shared between multiple skies.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_ASSETSTORE_HPP__2015___
+#define ___BIOSKY_ASSETSTORE_HPP__2015___
+
+#include "CompileConfig.h"
+
+#include <memory>
+#include <string>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* Base class for anything that can be placed in the AssetStore.
+		* Assets are immutable once they are placed in the store.
+		*/
+		class Asset
+		{
+		public:
+			/**
+			* Destructor
+			*/
+			virtual ~Asset() {}
+		};
+
+		/**
+		* The AssetStore holds generated assets keyed by a string so they only
+		* need to be generated once. Assets are reference counted; removing an
+		* asset from the store does not invalidate references that are still
+		* held by users of the asset.
+		*
+		* All functions in this class are thread safe.
+		*/
+		class AssetStore
+		{
+		public:
+			/**
+			* Find an asset in the store.
+			*
+			* @param key The key of the asset.
+			*
+			* @return Returns the asset or an empty pointer if no asset is
+			*			stored under key.
+			*/
+			BIOSKY_API static std::shared_ptr<const Asset> Find(const std::string & key);
+
+			/**
+			* Find an asset in the store and cast it to the requested type.
+			*
+			* @param key The key of the asset.
+			*
+			* @return Returns the asset or an empty pointer if no asset is
+			*			stored under key or the asset is not of type T.
+			*/
+			template <typename T>
+			static std::shared_ptr<const T> Get(const std::string & key);
+
+			/**
+			* Insert an asset into the store. If another asset was already
+			* stored under key (another thread generated it first) the
+			* existing asset is kept and returned.
+			*
+			* @param key The key to store the asset under.
+			*
+			* @param asset The asset to store.
+			*
+			* @return Returns the asset that is in the store under key after
+			*			this call.
+			*/
+			BIOSKY_API static std::shared_ptr<const Asset> Insert(const std::string & key, const std::shared_ptr<const Asset> & asset);
+
+			/**
+			* Remove an asset from the store.
+			*
+			* @param key The key of the asset to remove.
+			*
+			* @return Returns true iff an asset was removed.
+			*/
+			BIOSKY_API static bool Remove(const std::string & key);
+
+			/**
+			* Remove all of the assets from the store.
+			*/
+			BIOSKY_API static void Clear();
+
+			/**
+			* Get the number of assets in the store.
+			*
+			* @return Returns the number of assets in the store.
+			*/
+			BIOSKY_API static int GetCount();
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+template <typename T>
+inline std::shared_ptr<const T> BIO::SKY::AssetStore::Get(const std::string & key)
+{
+	return std::dynamic_pointer_cast<const T>(Find(key));
+}
+
+#endif //___BIOSKY_ASSETSTORE_HPP__2015___
@@ -44,16 +44,31 @@
 //constants
 #include "MathUtils.hpp"
 #include "Error.hpp"
+#include "Allocator.hpp"
 //Independent helper classes
 #include "SkyPosition.hpp"
 #include "SkyData.hpp"
 #include "RawGeometry.hpp"
+#include "DomeGeometryBuilder.hpp"
+#include "SkyDome.hpp"
+#include "SkyDomeLODSet.hpp"
+#include "GeometryBuffer.hpp"
 #include "Vector3D.hpp"
 #include "Vector2D.hpp"
+#include "Calendar.hpp"
 #include "Date.hpp"
 #include "DateTime.hpp"
+#include "Timestamp.hpp"
 #include "GPS.hpp"
 #include "LightData.hpp"
+#include "AssetStore.hpp"
+#include "TextureMipChain.hpp"
+#include "TextureCompression.hpp"
+#include "NightSkyTiles.hpp"
+#include "StarCatalog.hpp"
+#include "Planets.hpp"
+#include "Ephemeris.hpp"
+#include "SkyEvents.hpp"
 //Interfaces
 #include "IDomeVertecies.hpp"
 #include "IDomeGeometry.hpp"
@@ -67,5 +82,10 @@
 #include "SkyCalculated.hpp"
 #include "SkyCalculatedStatic.hpp"
 #include "SkyCalculatedDynamic.hpp"
+#include "SkyStatePublisher.hpp"
+#include "SkyCalculatedAsync.hpp"
+#include "SkyCommandQueue.hpp"
+#include "SkyPerfCounters.hpp"
+#include "SkyTrace.hpp"
 
 #endif //___BIOSKY_BIOSKY_HPP__2015___
\ No newline at end of file
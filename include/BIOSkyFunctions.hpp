@@ -40,8 +40,16 @@
 #include "SkyPosition.hpp"
 #include "SkyData.hpp"
 #include "Date.hpp"
+#include "Timestamp.hpp"
 #include "RawGeometry.hpp"
 #include "MathUtils.hpp"
+#include "TextureMipChain.hpp"
+#include "TextureCompression.hpp"
+#include "NightSkyTiles.hpp"
+#include "StarCatalog.hpp"
+#include "Allocator.hpp"
+
+#include <memory>
 
 //define library public functions
 namespace BIO
@@ -101,6 +109,13 @@ namespace BIO
 		*/
 		BIOSKY_API float CalculateMoonPhase(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year);
 
+		/**
+		* Calculate the Phase of the moon at a Timestamp.
+		*
+		* @return Returns a float with the moon phase between [0,360]
+		*/
+		BIOSKY_API float CalculateMoonPhase(const Timestamp & time);
+
 		/**
 		* Calculate Moon Position
 		*
@@ -132,6 +147,12 @@ namespace BIO
 		*/
 		BIOSKY_API SkyPosition CalculateMoonPosition(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude);
 
+		/**
+		* Calculate Moon Position at a Timestamp. The latitude and longitude
+		* are the same as the calendar version.
+		*/
+		BIOSKY_API SkyPosition CalculateMoonPosition(const Timestamp & time, float latitude, float longitude);
+
 		/**
 		* Calculate the visibility of the moon.
 		*
@@ -182,6 +203,20 @@ namespace BIO
 		*			position the sun, moon, stars, and moon phase.
 		*/
 		BIOSKY_API SkyData CalculateSkyData(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude);
+
+		/**
+		* Calculate all of the SkyData at a Timestamp. The days since 2000
+		* come straight from the timestamp, so there is no calendar to
+		* convert, and they are not rounded to a float so the sky does not
+		* step decades away from 2000.
+		*
+		* @param time The moment to calculate the sky for.
+		*
+		* @param latitude The latitude of the location in radians.
+		*
+		* @param longitude The longitude of the location in radians.
+		*/
+		BIOSKY_API SkyData CalculateSkyData(const Timestamp & time, float latitude, float longitude);
 		
 		/**
 		* Calculates the rotation angle of the stars around the celestial north
@@ -194,6 +229,29 @@ namespace BIO
 		*/
 		BIOSKY_API float CalculateStarRotation(float standardTime, float UTCoffset);
 
+		/**
+		* Estimate the luminance of a clear sky at the zenith from the
+		* position of the sun. Unlike the Perez model this goes on through
+		* twilight into the night.
+		*
+		* @param sunZenith The zenith of the sun in radians.
+		*
+		* @return Returns the luminance in candela per square meter.
+		*/
+		BIOSKY_API float CalculateZenithSkyLuminance(float sunZenith);
+
+		/**
+		* Calculate the faintest star that can be seen by the naked eye
+		* against a sky of some brightness.
+		*
+		* @param skyLuminance The luminance of the sky in candela per
+		*			square meter. See CalculateZenithSkyLuminance.
+		*
+		* @return Returns the limiting magnitude. About 6.6 under a dark
+		*			sky and below -3 (no stars) in daylight.
+		*/
+		BIOSKY_API float CalculateLimitingMagnitude(float skyLuminance);
+
 		/**
 		* Calculate the position of the sun.
 		*
@@ -225,6 +283,12 @@ namespace BIO
 		*/
 		BIOSKY_API SkyPosition CalculateSunPosition(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude);
 
+		/**
+		* Calculate the position of the sun at a Timestamp. The latitude and
+		* longitude are the same as the calendar version.
+		*/
+		BIOSKY_API SkyPosition CalculateSunPosition(const Timestamp & time, float latitude, float longitude);
+
 		/**
 		* Creates a skydome geometry that is compliant with this engine's
 		* proccesses.
@@ -254,15 +318,358 @@ namespace BIO
 		*			sky dome geometry. Default = true;
 		*
 		* @return Returns a pointer to a Geometry Object. This object was
-		*			created on the heap so you are responsible for deleting
-		*			it after calling this function.
+		*			created with the library allocator so you are 
+		*			responsible for deleting it after calling this function.
 		*/
 		BIOSKY_API RawGeometry * CreateSkyDomeGeometry(float radius = 1.0f, int numVerticalSegments = 12, int numHorozontalSegments = 12, bool fullDome = true);
 
+		/**
+		* Get the number of vertecies and indecies a skydome geometry will
+		* need. Use this to size the buffers passed to the buffer version of
+		* CreateSkyDomeGeometry.
+		*
+		* @param numVerticalSegments See CreateSkyDomeGeometry.
+		*
+		* @param numHorozontalSegments See CreateSkyDomeGeometry.
+		*
+		* @param fullDome See CreateSkyDomeGeometry.
+		*
+		* @param[out] numVertecies The number of vertecies (and UV 
+		*			coordinates) needed. May be NULL.
+		*
+		* @param[out] numIndecies The number of indecies needed. May be NULL.
+		*/
+		BIOSKY_API void GetSkyDomeGeometrySize(int numVerticalSegments, int numHorozontalSegments, bool fullDome, int * numVertecies, int * numIndecies);
+
+		/**
+		* Creates a skydome geometry in buffers supplied by the caller. No
+		* memory is allocated.
+		*
+		* @param radius See CreateSkyDomeGeometry.
+		*
+		* @param numVerticalSegments See CreateSkyDomeGeometry.
+		*
+		* @param numHorozontalSegments See CreateSkyDomeGeometry.
+		*
+		* @param fullDome See CreateSkyDomeGeometry.
+		*
+		* @param[out] vertecies The buffer for the vertecies.
+		*
+		* @param[out] UVTextureCoordinates The buffer for the UV coordinates.
+		*
+		* @param numVertecies The number of elements in the vertecies and
+		*			UVTextureCoordinates buffers.
+		*
+		* @param[out] indecies The buffer for the indecies.
+		*
+		* @param numIndecies The number of elements in the indecies buffer.
+		*
+		* @return Returns true if the geometry was created. Returns false if
+		*			a buffer is NULL or too small (see 
+		*			GetSkyDomeGeometrySize).
+		*/
+		BIOSKY_API bool CreateSkyDomeGeometry(float radius, int numVerticalSegments, int numHorozontalSegments, bool fullDome, Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, unsigned short * indecies, int numIndecies);
+
+		/**
+		* Creates a sky dome from a subdivided icosahedron. The vertecies are
+		* spread evenly over the sphere instead of bunching up at the zenith
+		* like CreateSkyDomeGeometry. One vertex is at the zenith and the
+		* horizon is an edge loop, so the hemisphere has a clean rim.
+		*
+		* The UV coordinates and winding are the same as
+		* CreateSkyDomeGeometry. Geometry with more than 65535 vertecies
+		* uses 32 bit indecies. The triangles are ordered for the vertex
+		* cache.
+		*
+		* @param radius The radius of the dome.
+		*
+		* @param subdivisions The number of times each triangle of the
+		*			icosahedron is split into 4. A full sphere has
+		*			10 x 4^subdivisions + 2 vertecies. A hemisphere
+		*			always uses at least 1, because the horizon edge
+		*			loop comes from the first split.
+		*
+		* @param fullDome Pass true for a full sphere or false for a
+		*			hemisphere.
+		*
+		* @return Returns the geometry. It was created with the library
+		*			allocator; delete it when you are done with it.
+		*/
+		BIOSKY_API RawGeometry * CreateIcosphereDomeGeometry(float radius = 1.0f, int subdivisions = 3, bool fullDome = false);
+
+		/**
+		* A function that gives how dense the vertecies of a dome should be
+		* at a zenith angle. Only the relative values matter.
+		*
+		* @param zenith The zenith angle in radians. 0 is straight up and
+		*			PI/2 is the horizon.
+		*
+		* @param userData The userData passed to
+		*			CreateDensifiedSkyDomeGeometry.
+		*
+		* @return Returns the relative density. Must be greater than 0.
+		*/
+		typedef float(*DomeDensityFunction)(float zenith, void * userData);
+
+		/**
+		* The default density for CreateDensifiedSkyDomeGeometry. It is 1 at
+		* the zenith and rises smoothly to 4 at the horizon, where the sky
+		* color changes the fastest.
+		*/
+		BIOSKY_API float DefaultDomeDensity(float zenith, void * userData);
+
+		/**
+		* Creates a sky dome whose rings of vertecies are spaced by a
+		* density function of the zenith angle. The number of vertecies in
+		* each ring also follows the density (and the size of the ring), so
+		* the small rings near the zenith get few vertecies and the horizon
+		* gets the most. Rings with different vertex counts are stitched
+		* together with triangles that follow the angle around the dome.
+		*
+		* The UV coordinates and winding are the same as
+		* CreateSkyDomeGeometry. Geometry with more than 65535 vertecies
+		* uses 32 bit indecies.
+		*
+		* @param radius The radius of the dome.
+		*
+		* @param numRings The number of rings from the zenith to the horizon
+		*			(to the bottom for a full dome).
+		*
+		* @param maxSegments The number of vertecies in the densest ring.
+		*
+		* @param fullDome Pass true for a full sphere or false for a
+		*			hemisphere.
+		*
+		* @param density The density function. Pass NULL for
+		*			DefaultDomeDensity.
+		*
+		* @param userData Passed to the density function.
+		*
+		* @return Returns the geometry. It was created with the library
+		*			allocator; delete it when you are done with it.
+		*/
+		BIOSKY_API RawGeometry * CreateDensifiedSkyDomeGeometry(float radius = 1.0f, int numRings = 16, int maxSegments = 48, bool fullDome = false, DomeDensityFunction density = NULL, void * userData = NULL);
+
 		BIOSKY_API RawGeometry * CreateNightSkyDomeGeometry(float radius = 1.0f);
 
+		/**
+		* Get the number of vertecies and indecies the night sky dome
+		* geometry needs.
+		*
+		* @param[out] numVertecies The number of vertecies (and UV
+		*			coordinates) needed. May be NULL.
+		*
+		* @param[out] numIndecies The number of indecies needed. May be NULL.
+		*/
+		BIOSKY_API void GetNightSkyDomeGeometrySize(int * numVertecies, int * numIndecies);
+
+		/**
+		* A vertex of the night sky dome on a dome of radius 1.
+		*/
+		struct NightSkyDomeVertex
+		{
+			float x, y, z;
+			float u, v;
+		};
+
+		/**
+		* Get the night sky dome vertecies. This is read only data built into
+		* the library; nothing is copied or allocated. Scale the positions by
+		* the radius of your dome when you use them.
+		*
+		* @return Returns the vertecies. There are as many as
+		*			GetNightSkyDomeGeometrySize returns.
+		*/
+		BIOSKY_API const NightSkyDomeVertex * GetNightSkyDomeVertecies();
+
+		/**
+		* Get the night sky dome indecies. This is read only data built into
+		* the library.
+		*
+		* @return Returns the indecies of the triangle list. There are as
+		*			many as GetNightSkyDomeGeometrySize returns.
+		*/
+		BIOSKY_API const unsigned short * GetNightSkyDomeIndecies();
+
+		/**
+		* Creates the night sky dome geometry in buffers supplied by the
+		* caller. No memory is allocated.
+		*
+		* @param radius The radius of the dome.
+		*
+		* @param[out] vertecies The buffer for the vertecies.
+		*
+		* @param[out] UVTextureCoordinates The buffer for the UV coordinates.
+		*
+		* @param numVertecies The number of elements in the vertecies and
+		*			UVTextureCoordinates buffers.
+		*
+		* @param[out] indecies The buffer for the indecies.
+		*
+		* @param numIndecies The number of elements in the indecies buffer.
+		*
+		* @return Returns true if the geometry was created. Returns false if
+		*			a buffer is NULL or too small (see 
+		*			GetNightSkyDomeGeometrySize).
+		*/
+		BIOSKY_API bool CreateNightSkyDomeGeometry(float radius, Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, unsigned short * indecies, int numIndecies);
+
+		/**
+		* Get sky dome geometry that is shared with every other caller that
+		* asks for the same dome. The dome is built the first time it is
+		* asked for and kept in the AssetStore under a key made from the
+		* radius, segments, fullDome and index width. This is thread safe.
+		*
+		* @warning The const only makes the array pointers of the RawGeometry
+		*		const, not the arrays. Every caller shares the same arrays,
+		*		so never write to them: copy the geometry (for example into
+		*		a GeometryBuffer) and change the copy, and read the arrays
+		*		through const pointers such as const Vector3D *.
+		*
+		* @param radius See CreateSkyDomeGeometry.
+		*
+		* @param numVerticalSegments See CreateSkyDomeGeometry.
+		*
+		* @param numHorozontalSegments See CreateSkyDomeGeometry.
+		*
+		* @param fullDome See CreateSkyDomeGeometry.
+		*
+		* @param largeIndecies If true the geometry uses indecies32 even
+		*			when the vertecies would fit in 16 bit indecies. Domes
+		*			with more than 65535 vertecies always use indecies32.
+		*
+		* @return Returns the geometry. Its arrays must never be written.
+		*/
+		BIOSKY_API std::shared_ptr<const RawGeometry> GetSharedSkyDomeGeometry(float radius = 1.0f, int numVerticalSegments = 12, int numHorozontalSegments = 12, bool fullDome = true, bool largeIndecies = false);
+
+		/**
+		* Get shared sky dome geometry with a radius of 1. Scale it by the
+		* radius of your dome in the world transform so domes of every size
+		* share one copy.
+		*
+		* @param numVerticalSegments See CreateSkyDomeGeometry.
+		*
+		* @param numHorozontalSegments See CreateSkyDomeGeometry.
+		*
+		* @param fullDome See CreateSkyDomeGeometry.
+		*
+		* @param largeIndecies See GetSharedSkyDomeGeometry.
+		*
+		* @return Returns the geometry. Its arrays must never be written;
+		*			see GetSharedSkyDomeGeometry.
+		*/
+		BIOSKY_API std::shared_ptr<const RawGeometry> GetSharedUnitSkyDomeGeometry(int numVerticalSegments = 12, int numHorozontalSegments = 12, bool fullDome = true, bool largeIndecies = false);
+
+		/**
+		* Get night sky dome geometry that is shared with every other caller
+		* that asks for the same radius. Pass a radius of 1 and scale the
+		* dome in the world transform to share one copy between all radii.
+		*
+		* @param radius The radius of the dome.
+		*
+		* @return Returns the geometry. Its arrays must never be written;
+		*			see GetSharedSkyDomeGeometry.
+		*/
+		BIOSKY_API std::shared_ptr<const RawGeometry> GetSharedNightSkyDomeGeometry(float radius = 1.0f);
+
 		BIOSKY_API unsigned char * CreateNightSkyTexture(int * width, int * height);
 
+		/**
+		* Creates the texture for the night sky in a buffer supplied by the
+		* caller. Call with a NULL buffer to query the size.
+		*
+		* @param[out] width The width of the texture. May be NULL.
+		*
+		* @param[out] height The height of the texture. May be NULL.
+		*
+		* @param[out] buffer The buffer to write the B G R A texture into.
+		*			Nothing is written if this is NULL or smaller than the
+		*			returned size.
+		*
+		* @param bufferSize The size of buffer in bytes.
+		*
+		* @return Returns the number of bytes the texture needs or 0 if the
+		*			texture could not be decoded.
+		*/
+		BIOSKY_API int CreateNightSkyTexture(int * width, int * height, unsigned char * buffer, int bufferSize);
+
+		/**
+		* Creates the texture for the night sky at a reduced resolution. The
+		* full resolution texture is filtered down until both the width and
+		* height are less than or equal to maxSize. The format of the
+		* returned texture is the same as CreateNightSkyTexture(int*, int*).
+		*
+		* @param[out] width The width of the returned texture. May be NULL.
+		*
+		* @param[out] height The height of the returned texture. May be NULL.
+		*
+		* @param maxSize The largest width or height that the returned
+		*			texture may have.
+		*
+		* @return Returns an array of unsigned char data points created
+		*			with new[]. Release it with delete[] or FreeTexture when
+		*			you are done with it. Returns NULL if the texture could
+		*			not be created.
+		*/
+		BIOSKY_API unsigned char * CreateNightSkyTexture(int * width, int * height, int maxSize);
+
+		/**
+		* Get the mip chain for the night sky texture. The chain is created
+		* the first time it is requested and then shared through the
+		* AssetStore so every caller gets the same copy.
+		*
+		* @param maxSize The largest width or height the first level of the
+		*			chain may have. Pass 0 to start at full resolution.
+		*
+		* @return Returns the mip chain or an empty pointer if the night sky
+		*			texture could not be decoded.
+		*/
+		BIOSKY_API std::shared_ptr<const TextureMipChain> CreateNightSkyTextureMipChain(int maxSize = 0);
+
+		/**
+		* Get the block compressed night sky texture with all of its mip
+		* levels. The texture is created from the night sky mip chain the
+		* first time it is requested and then shared through the AssetStore.
+		* BC1 needs an eighth of the memory of the uncompressed texture.
+		*
+		* @param format The block format to use.
+		*
+		* @param maxSize The largest width or height the first level may
+		*			have. Pass 0 to start at full resolution.
+		*
+		* @return Returns the compressed texture or an empty pointer if the
+		*			night sky texture could not be decoded.
+		*/
+		BIOSKY_API std::shared_ptr<const CompressedTexture> CreateNightSkyTextureCompressed(TEXTURE_BLOCK_FORMAT format = BLOCK_FORMAT_BC1, int maxSize = 0);
+
+		/**
+		* Get the night sky texture cut into tiles. The tiles are created the
+		* first time a tile size is requested and then shared through the
+		* AssetStore. Use a NightSkyTileStreamer to keep only the tiles that
+		* are above the horizon resident.
+		*
+		* @param tileSize The width and height of a tile in pixels.
+		*
+		* @return Returns the tiles or an empty pointer if the night sky
+		*			texture could not be created.
+		*/
+		BIOSKY_API std::shared_ptr<const NightSkyTiles> CreateNightSkyTiles(int tileSize = DefaultNightSkyTileSize);
+
+		/**
+		* Get a catalog of the brightest stars, which are built into the
+		* library. The catalog is created the first time it is requested
+		* and then shared through the AssetStore.
+		*
+		* @note These are only 82 of the brightest stars (most are brighter
+		*		than magnitude 2.5), not the full Bright Star Catalogue. Load a BSC5 file
+		*		with StarCatalog::LoadBSC5, or its compact form with
+		*		StarCatalog::LoadCompact, for the stars down to magnitude
+		*		6.5.
+		*
+		* @return Returns the catalog.
+		*/
+		BIOSKY_API std::shared_ptr<const StarCatalog> GetBrightStarCatalog();
+
 		/**
 		* Creates a texture for the moon billboard. The resulting
 		* texture will be a square image with dimensions widthxheight. The
@@ -282,12 +689,102 @@ namespace BIO
 		*
 		* @return Returns an array of unsigned char data points
 		*			representing a square texture. This function creates
-		*			the data on the heap and returns a pointer to that data.
-		*			You are responsible for deleting this data when you are
+		*			the data with new[] and returns a pointer to that data.
+		*			Release it with delete[] or FreeTexture when you are
 		*			done with it.
 		*/
 		BIOSKY_API unsigned char * CreateMoonTexture(int * width, int * height);
 
+		/**
+		* Creates the texture for the moon billboard in a buffer supplied by
+		* the caller. Call with a NULL buffer to query the size.
+		*
+		* @param[out] width The width of the texture. May be NULL.
+		*
+		* @param[out] height The height of the texture. May be NULL.
+		*
+		* @param[out] buffer The buffer to write the B G R A texture into.
+		*			Nothing is written if this is NULL or smaller than the
+		*			returned size.
+		*
+		* @param bufferSize The size of buffer in bytes.
+		*
+		* @return Returns the number of bytes the texture needs.
+		*/
+		BIOSKY_API int CreateMoonTexture(int * width, int * height, unsigned char * buffer, int bufferSize);
+
+		/**
+		* Creates the texture for the moon billboard at a reduced resolution.
+		* The full resolution texture is filtered down until both the width
+		* and height are less than or equal to maxSize. The format of the 
+		* returned texture is the same as CreateMoonTexture(int*, int*).
+		*
+		* @param[out] width The width of the returned texture. May be NULL.
+		*
+		* @param[out] height The height of the returned texture. May be NULL.
+		*
+		* @param maxSize The largest width or height that the returned
+		*			texture may have.
+		*
+		* @return Returns an array of unsigned char data points created
+		*			with new[]. Release it with delete[] or FreeTexture when
+		*			you are done with it. Returns NULL if the texture could
+		*			not be created.
+		*/
+		BIOSKY_API unsigned char * CreateMoonTexture(int * width, int * height, int maxSize);
+
+		/**
+		* Get the mip chain for the moon texture. The chain is created the
+		* first time it is requested and then shared through the AssetStore
+		* so every caller gets the same copy.
+		*
+		* @param maxSize The largest width or height the first level of the
+		*			chain may have. Pass 0 to start at full resolution.
+		*
+		* @return Returns the mip chain.
+		*/
+		BIOSKY_API std::shared_ptr<const TextureMipChain> CreateMoonTextureMipChain(int maxSize = 0);
+
+		/**
+		* Get the block compressed moon texture with all of its mip levels.
+		* The texture is created the first time it is requested and then
+		* shared through the AssetStore.
+		*
+		* By default the color is BC1 compressed and the alpha is kept as a
+		* separate 8 bit plane for every level. The phase of the moon only
+		* changes the alpha, so a new phase can be applied to a copy of the
+		* alpha plane with ApplyMoonPhaseToAlpha without touching the
+		* compressed color.
+		*
+		* @param format The block format of the color.
+		*
+		* @param separateAlpha If true the alpha is kept in its own plane.
+		*
+		* @return Returns the compressed texture or an empty pointer if the
+		*			moon mip chain could not be created.
+		*/
+		BIOSKY_API std::shared_ptr<const CompressedTexture> CreateMoonTextureCompressed(TEXTURE_BLOCK_FORMAT format = BLOCK_FORMAT_BC1, bool separateAlpha = true);
+
+		/**
+		* Hide the dark part of the moon by zeroing the alpha of the pixels
+		* that are in shadow for a given phase. This is the mask Sky uses
+		* when the moon phase is set.
+		*
+		* @param phase The phase of the moon in degrees. 0 is a new moon and
+		*			180 is a full moon.
+		*
+		* @param[in,out] alpha A pointer to the alpha of the first pixel.
+		*
+		* @param width The width of the image in pixels.
+		*
+		* @param height The height of the image in pixels.
+		*
+		* @param pixelStride The number of bytes from the alpha of one pixel
+		*			to the next. Use 1 for an alpha plane and 4 for the
+		*			alpha of a B G R A image.
+		*/
+		BIOSKY_API void ApplyMoonPhaseToAlpha(float phase, unsigned char * alpha, int width, int height, int pixelStride);
+
 		/**
 		* Create the texture used for the sun billboard. The resulting
 		* texture will be a square image with sideLength the length of one
@@ -298,12 +795,52 @@ namespace BIO
 		*
 		* @return Returns an array of unsigned char data points
 		*			representing a square texture. This function creates
-		*			the data on the heap and returns a pointer to that data.
-		*			You are responsible for deleting this data when you are
+		*			the data with new[] and returns a pointer to that data.
+		*			Release it with delete[] or FreeTexture when you are
 		*			done with it.
 		*/
 		BIOSKY_API unsigned char * CreateSunTexture(int sideLength);
 
+		/**
+		* Create the texture used for the sun billboard in a buffer supplied
+		* by the caller. The format is the same as CreateSunTexture(int).
+		* Call with a NULL buffer to query the size.
+		*
+		* @param sideLength The length of the side of the square.
+		*
+		* @param[out] buffer The buffer to write the texture into. Nothing is
+		*			written if this is NULL or smaller than the returned 
+		*			size.
+		*
+		* @param bufferSize The size of buffer in bytes.
+		*
+		* @return Returns the number of bytes the texture needs or 0 if
+		*			sideLength is not positive.
+		*/
+		BIOSKY_API int CreateSunTexture(int sideLength, unsigned char * buffer, int bufferSize);
+
+		/**
+		* Release a texture returned by one of the Create*Texture functions.
+		* This is the same as delete[]; the textures are not created with
+		* the library allocator so code that deletes them keeps working. Use
+		* the overloads that take a buffer to control the allocation.
+		*
+		* @param texture The texture to release. NULL is ignored.
+		*/
+		BIOSKY_API void FreeTexture(unsigned char * texture);
+
+		/**
+		* Get the mip chain for the sun texture of a given size. The chain is
+		* created the first time a size is requested and then shared through
+		* the AssetStore.
+		*
+		* @param sideLength The length of the side of the first level.
+		*
+		* @return Returns the mip chain or an empty pointer if sideLength is
+		*			not positive.
+		*/
+		BIOSKY_API std::shared_ptr<const TextureMipChain> CreateSunTextureMipChain(int sideLength);
+
 		BIOSKY_API int DaysSinceJan02000(DATE_MONTH month, unsigned int day, unsigned int year);
 
 		/**
@@ -342,33 +879,12 @@ inline float BIO::SKY::CalculateCelestialNorthPoleZenith(float latitude)
 
 inline float BIO::SKY::CalculateJulianDay(DATE_MONTH month, unsigned int day, int year)
 {
-	int monthInt = Date::MonthToInt(month);
-
-	if (monthInt <= 2)
-	{
-		year -= 1;
-		monthInt += 12;
-	}
-
-	int A = 0;
-	int B = 0;
-
-	if (year > 1582)
-	{
-		A = (int)(year / 100);
-		B = 2 - A + (int)(A / 4);
-	}
-
-	return (int)(365.25*(year + 4716)) + (int)(30.6001 * (monthInt + 1)) + day + B - 1524.5f;
+	return (float)CALENDAR::JulianDay(month, day, year);
 }
 
 inline int BIO::SKY::DaysSinceJan02000(DATE_MONTH month, unsigned int day, unsigned int year)
 {
-	int monthint = Date::MonthToInt(month);
-
-	int d = (367 * (int)year - (7 * ((int)year + ((monthint + 9) / 12))) / 4 + (275 * monthint) / 9 + (int)day - 730530);
-
-	return d;
+	return CALENDAR::DaysSinceJan02000(month, day, (int)year);
 }
 
 #endif //___BIOSKY_BIOSKYFUNCTIONS_HPP__2015___
\ No newline at end of file
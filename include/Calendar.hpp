@@ -0,0 +1,209 @@
+/**
+* @file Calendar.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Calendar arithmetic that can be done at compile time.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#ifndef ___BIOSKY_CALENDAR_HPP__2015___
+#define ___BIOSKY_CALENDAR_HPP__2015___
+
+#include "CompileConfig.h"
+
+namespace BIO
+{
+	enum DATE_MONTH
+	{
+		JANUARY = 0,
+		FEBRUARY,
+		MARCH,
+		APRIL,
+		MAY,
+		JUNE,
+		JULY,
+		AUGUST,
+		SEPTEMBER,
+		OCTOBER,
+		NOVEMBER,
+		DECEMBER
+	};
+
+	/**
+	* The calendar functions behind Date, CalculateJulianDay and
+	* DaysSinceJan02000. They are table lookups and integer math with no
+	* branches, and with a C++14 compiler they are constexpr so a fixed date
+	* folds to a constant:
+	*
+	*		static BIOSKY_CONSTEXPR const double jd = CALENDAR::JulianDay(JANUARY, 1, 2000);
+	*
+	* The tables have a 13th entry that is used for a month outside of
+	* DATE_MONTH, which gives the same answers the old switch statements
+	* did.
+	*/
+	namespace CALENDAR
+	{
+		/**The days in each month, [leap year][month].*/
+		BIOSKY_CONSTEXPR const unsigned char DaysInMonthTable[2][13] =
+		{
+			{ 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31, 30 },
+			{ 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31, 30 }
+		};
+
+		/**The days in the year before the first of each month, [leap year][month].*/
+		BIOSKY_CONSTEXPR const unsigned short DaysBeforeMonthTable[2][13] =
+		{
+			{ 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 0 },
+			{ 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 0 }
+		};
+
+		/**
+		* (int)(30.6001 * (m + 1)) from Meeus' Julian day for the months
+		* March (3) to February of the next year (14).
+		*/
+		BIOSKY_CONSTEXPR const short MeeusMonthTable[12] =
+		{
+			122, 153, 183, 214, 244, 275, 306, 336, 367, 397, 428, 459
+		};
+
+		/**
+		* The index of a month into the tables. 12 if it is not a month.
+		*/
+		BIOSKY_CONSTEXPR unsigned int MonthIndex(DATE_MONTH month);
+
+		/**
+		* Determine if a year is a leap year in the Gregorian calendar.
+		*/
+		BIOSKY_CONSTEXPR bool IsLeapYear(int year);
+
+		/**
+		* Get the month as an integer. Jan = 1; Feb = 2; ect.
+		*/
+		BIOSKY_CONSTEXPR int MonthToInt(DATE_MONTH month);
+
+		/**
+		* Get the month from an integer in [1,12]. Anything else is JANUARY.
+		*/
+		BIOSKY_CONSTEXPR DATE_MONTH IntToMonth(int month);
+
+		/**
+		* Get the number of days in a month.
+		*/
+		BIOSKY_CONSTEXPR unsigned int DaysInMonth(DATE_MONTH month, int year);
+
+		/**
+		* Get the number of days in the year before the first of a month.
+		*/
+		BIOSKY_CONSTEXPR unsigned int DaysBeforeMonth(DATE_MONTH month, int year);
+
+		/**
+		* Get the day of the year, with January 1 as day 1.
+		*/
+		BIOSKY_CONSTEXPR unsigned int DayOfYear(DATE_MONTH month, unsigned int day, int year);
+
+		/**
+		* Calculate the Julian day at midnight starting a date. Dates after
+		* 1582 are Gregorian and dates before are Julian, as in Meeus'
+		* Astronomical Algorithms. Good from -4712.
+		*/
+		BIOSKY_CONSTEXPR double JulianDay(DATE_MONTH month, unsigned int day, int year);
+
+		/**
+		* The days since 2000 Jan 0.0 from Paul Schlyter's formula. Good from
+		* March 1900 to February 2100.
+		*/
+		BIOSKY_CONSTEXPR int DaysSinceJan02000(DATE_MONTH month, unsigned int day, int year);
+
+#if BIOSKY_TESTING == 1
+		/**
+		* Test the calendar functions against the functions they replaced
+		* for every day from -4712 to 9999.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		bool CalendarTests(XNELO::TESTING::Test * test);
+#endif
+	}//end namespace CALENDAR
+}//end namespace BIO
+
+inline BIOSKY_CONSTEXPR unsigned int BIO::CALENDAR::MonthIndex(DATE_MONTH month)
+{
+	return ((unsigned int)month < 12u) ? (unsigned int)month : 12u;
+}
+
+inline BIOSKY_CONSTEXPR bool BIO::CALENDAR::IsLeapYear(int year)
+{
+	return (((year % 4) == 0) & (((year % 100) != 0) | ((year % 400) == 0))) != 0;
+}
+
+inline BIOSKY_CONSTEXPR int BIO::CALENDAR::MonthToInt(DATE_MONTH month)
+{
+	return (int)(MonthIndex(month) % 12u) + 1;
+}
+
+inline BIOSKY_CONSTEXPR BIO::DATE_MONTH BIO::CALENDAR::IntToMonth(int month)
+{
+	return (DATE_MONTH)(((unsigned int)(month - 1) < 12u) ? (month - 1) : 0);
+}
+
+inline BIOSKY_CONSTEXPR unsigned int BIO::CALENDAR::DaysInMonth(DATE_MONTH month, int year)
+{
+	return DaysInMonthTable[IsLeapYear(year)][MonthIndex(month)];
+}
+
+inline BIOSKY_CONSTEXPR unsigned int BIO::CALENDAR::DaysBeforeMonth(DATE_MONTH month, int year)
+{
+	return DaysBeforeMonthTable[IsLeapYear(year)][MonthIndex(month)];
+}
+
+inline BIOSKY_CONSTEXPR unsigned int BIO::CALENDAR::DayOfYear(DATE_MONTH month, unsigned int day, int year)
+{
+	return DaysBeforeMonth(month, year) + day;
+}
+
+inline BIOSKY_CONSTEXPR double BIO::CALENDAR::JulianDay(DATE_MONTH month, unsigned int day, int year)
+{
+	//January and February are months 13 and 14 of the year before, and
+	//the Gregorian correction starts after 1582.
+	int m = MonthToInt(month);
+	int early = (m <= 2);
+	int y = year - early;
+	int gregorian = (y > 1582);
+
+	return (double)((1461 * (y + 4716)) / 4 + MeeusMonthTable[m + 12 * early - 3] + (int)day + gregorian * (2 - y / 100 + y / 400)) - 1524.5;
+}
+
+inline BIOSKY_CONSTEXPR int BIO::CALENDAR::DaysSinceJan02000(DATE_MONTH month, unsigned int day, int year)
+{
+	return 367 * year - (7 * (year + (MonthToInt(month) + 9) / 12)) / 4 + (275 * MonthToInt(month)) / 9 + (int)day - 730530;
+}
+
+#endif //___BIOSKY_CALENDAR_HPP__2015___
@@ -77,6 +77,52 @@
 	#define BIOSKY_API
 #endif //_BIOSKY_PLATFORM_
 
+//SIMD support. SSE2 is always available when building for x64 and is 
+//available on x86 when building with /arch:SSE2. Define BIOSKY_NO_SIMD to 
+//force all of the scalar code paths.
+#if !defined(BIOSKY_NO_SIMD) && \
+	(defined(_M_X64) || \
+	defined(_M_AMD64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2) || \
+	defined(__SSE2__))
+
+	#define BIOSKY_USE_SSE2 1
+#else
+	#define BIOSKY_USE_SSE2 0
+#endif //BIOSKY_NO_SIMD
+
+//constexpr support. Visual Studio 2013 has no constexpr and C++11 constexpr
+//functions can not have loops, so data is only generated at compile time
+//with C++14 compilers. BIOSKY_CONSTEXPR is empty everywhere else and the
+//same code runs when the data is initialized.
+#if (defined(__cpp_constexpr) && __cpp_constexpr >= 201304) || \
+	(defined(_MSC_VER) && _MSC_VER >= 1910)
+
+	#define BIOSKY_HAS_CONSTEXPR 1
+	#define BIOSKY_CONSTEXPR constexpr
+#else
+	#define BIOSKY_HAS_CONSTEXPR 0
+	#define BIOSKY_CONSTEXPR
+#endif //BIOSKY_HAS_CONSTEXPR
+
+//Performance counters. Define BIOSKY_ENABLE_PERF_COUNTERS to time the stages
+//of the sky update (see SkyPerfCounters.hpp). Otherwise the timing is not
+//compiled in at all.
+#ifdef BIOSKY_ENABLE_PERF_COUNTERS
+	#define BIOSKY_PERF_COUNTERS 1
+#else
+	#define BIOSKY_PERF_COUNTERS 0
+#endif //BIOSKY_ENABLE_PERF_COUNTERS
+
+//Tracing. Define BIOSKY_ENABLE_TRACING to record the stages of the sky update,
+//asset decoding and geometry builds as trace events (see SkyTrace.hpp). They
+//are only recorded between StartSkyTrace and StopSkyTrace.
+#ifdef BIOSKY_ENABLE_TRACING
+	#define BIOSKY_TRACING 1
+#else
+	#define BIOSKY_TRACING 0
+#endif //BIOSKY_ENABLE_TRACING
+
 //COPIED DIRECTLY FROM stddef.h
 //This is here just in case in some file
 //doesn't have a heder with NULL in it.
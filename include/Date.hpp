@@ -37,25 +37,10 @@
 #define ___BIOENGINE_DATE_H__2014___
 
 #include "CompileConfig.h"
+#include "Calendar.hpp"
 
 namespace BIO
 {
-	enum DATE_MONTH
-	{
-		JANUARY = 0,
-		FEBRUARY,
-		MARCH,
-		APRIL,
-		MAY,
-		JUNE,
-		JULY,
-		AUGUST,
-		SEPTEMBER,
-		OCTOBER,
-		NOVEMBER,
-		DECEMBER
-	};
-
 	class Date
 	{
 	private:
@@ -126,6 +111,58 @@ namespace BIO
 		*/
 		BIOSKY_API Date operator ++ (int);
 
+		/**
+		* Move the date forward or back a number of days. This takes the same
+		* time for a million days as it does for one. The date will not go
+		* before January 1 of year 0.
+		*
+		* @param days The number of days to add. Negative values go back.
+		*
+		* @return Returns this date.
+		*/
+		BIOSKY_API Date & AddDays(long long days);
+
+		/**
+		* Get the number of days from January 1, 1970 to this date.
+		*
+		* @return Returns the day number. Earlier dates are negative.
+		*/
+		BIOSKY_API long long GetDayNumber() const;
+
+		/**
+		* Set the date from the number of days since January 1, 1970.
+		*
+		* @param dayNumber The day number. Values before January 1 of year 0
+		*			are clamped to it.
+		*/
+		BIOSKY_API void SetDayNumber(long long dayNumber);
+
+		/**
+		* Count the days from January 1, 1970 to a date in the proleptic
+		* Gregorian calendar. This is Howard Hinnant's days_from_civil and
+		* has no loops or tables.
+		*
+		* @see http://howardhinnant.github.io/date_algorithms.html
+		*
+		* @param month The month of the year.
+		* @param day The day of the month.
+		* @param year The year.
+		*
+		* @return Returns the day number. Earlier dates are negative.
+		*/
+		BIOSKY_API static long long DaysFromCivil(DATE_MONTH month, unsigned int day, unsigned int year);
+
+		/**
+		* The inverse of DaysFromCivil (Hinnant's civil_from_days).
+		*
+		* @param dayNumber The number of days since January 1, 1970. This
+		*			must not be before January 1 of year 0.
+		* @param[out] month The month of the year.
+		* @param[out] day The day of the month.
+		* @param[out] year The year.
+		*/
+		BIOSKY_API static void CivilFromDays(long long dayNumber, DATE_MONTH * month, unsigned int * day, unsigned int * year);
+
 		/**
 		* Calculate the day of the year. The day of the year starts with Jan 1
 		* being day 1 and December 31 being 365 (366 on leap year).
@@ -307,7 +344,18 @@ inline bool BIO::Date::operator != (const Date & other) const
 
 inline unsigned int BIO::Date::CalculateDayOfYear(DATE_MONTH month, unsigned int day, unsigned int year)
 {
-	return _NumDaysBefore(month, year) + day;
+	return CALENDAR::DayOfYear(month, day, (int)year);
+}
+
+inline BIO::Date & BIO::Date::AddDays(long long days)
+{
+	SetDayNumber(GetDayNumber() + days);
+	return *this;
+}
+
+inline long long BIO::Date::GetDayNumber() const
+{
+	return DaysFromCivil(_month, _day, _year);
 }
 
 inline unsigned int BIO::Date::GetDay()
@@ -332,35 +380,7 @@ inline unsigned int BIO::Date::GetYear()
 
 inline int BIO::Date::MonthToInt(DATE_MONTH month)
 {
-	switch (month)
-	{
-	case BIO::JANUARY:
-		return 1;
-	case BIO::FEBRUARY:
-		return 2;
-	case BIO::MARCH:
-		return 3;
-	case BIO::APRIL:
-		return 4;
-	case BIO::MAY:
-		return 5;
-	case BIO::JUNE:
-		return 6;
-	case BIO::JULY:
-		return 7;
-	case BIO::AUGUST:
-		return 8;
-	case BIO::SEPTEMBER:
-		return 9;
-	case BIO::OCTOBER:
-		return 10;
-	case BIO::NOVEMBER:
-		return 11;
-	case BIO::DECEMBER:
-		return 12;
-	default:
-		return 1;
-	}
+	return CALENDAR::MonthToInt(month);
 }
 
 inline void BIO::Date::SetDay(unsigned int day)
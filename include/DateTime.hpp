@@ -39,6 +39,7 @@
 #include "CompileConfig.h"
 
 #include "Date.hpp"
+#include "Timestamp.hpp"
 
 namespace BIO
 {
@@ -90,10 +91,29 @@ namespace BIO
 		* Add Time to the date in this class.
 		*
 		* @param timeToAdd A float number representing the amount of time to 
-		*			add in seconds.
+		*			add in seconds. NaN and infinity are ignored. The
+		*			date and time stop at midnight at the start of
+		*			January 1 of year 0.
 		*/
 		BIOSKY_API void AddTime(float timeToAdd);
 
+		/**
+		* Get this date and time as a Timestamp. The time of day is rounded
+		* to the nearest microsecond, which SetTimestamp turns back into the
+		* same float, so DateTime to Timestamp and back is exact.
+		*
+		* @return Returns the moment in Universal Time.
+		*/
+		BIOSKY_API Timestamp GetTimestamp();
+
+		/**
+		* Set the date and time from a Timestamp. The UTC offset is kept and
+		* the date and time are set to the local time at that moment.
+		*
+		* @param timestamp The moment to set.
+		*/
+		BIOSKY_API void SetTimestamp(Timestamp timestamp);
+
 		/**
 		* Get the date stored in this class.
 		*
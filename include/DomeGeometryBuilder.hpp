@@ -0,0 +1,280 @@
+/**
+* @file DomeGeometryBuilder.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Builds high resolution sky dome geometry with 32 bit indecies and index
+* orders that make good use of the vertex cache.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_DOMEGEOMETRYBUILDER_HPP__2015___
+#define ___BIOSKY_DOMEGEOMETRYBUILDER_HPP__2015___
+
+#include "CompileConfig.h"
+#include "RawGeometry.hpp"
+
+#include <ostream>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**The vertex cache size the optimizer and ACMR use by default.*/
+		const int DefaultVertexCacheSize = 32;
+
+		/**
+		* The order the triangles of a dome are written in.
+		*/
+		enum DOME_INDEX_ORDER
+		{
+			/**
+			* Latitude bands from the top down. This is the same order as
+			* CreateSkyDomeGeometry.
+			*/
+			DOME_ORDER_BANDS = 0,
+			/**
+			* A triangle list reordered for the post transform vertex cache
+			* (Tom Forsyth's linear speed optimizer). This is much slower to
+			* build than the other orders; see OptimizeVertexCache.
+			*/
+			DOME_ORDER_VERTEX_CACHE,
+			/**
+			* One triangle strip. The latitude bands are joined with
+			* degenerate triangles.
+			*/
+			DOME_ORDER_STRIP
+		};
+
+		/**
+		* Builds the same latitude/longitude dome as CreateSkyDomeGeometry
+		* (same vertecies, UV coordinates and winding) but without the 65535
+		* vertex limit. The sine and cosine of every ring and segment is
+		* calculated once, so very high resolution domes (512 x 256 and up)
+		* build quickly.
+		*
+		* Build picks 16 bit indecies when the vertecies fit and 32 bit
+		* indecies when they do not.
+		*/
+		class DomeGeometryBuilder
+		{
+		public:
+			/**
+			* Constructor. The parameters are the same as
+			* CreateSkyDomeGeometry.
+			*/
+			BIOSKY_API DomeGeometryBuilder(float radius = 1.0f, int numVerticalSegments = 12, int numHorozontalSegments = 12, bool fullDome = true);
+
+			/**
+			* Set the radius of the dome.
+			*/
+			BIOSKY_API void SetRadius(float radius);
+
+			/**
+			* Set the number of segments. The number of horozontal segments
+			* is made even the same way CreateSkyDomeGeometry does.
+			*/
+			BIOSKY_API void SetSegments(int numVerticalSegments, int numHorozontalSegments);
+
+			/**
+			* Set whether a full sphere or a hemisphere is built.
+			*/
+			BIOSKY_API void SetFullDome(bool fullDome);
+
+			/**
+			* Set the order of the indecies.
+			*/
+			BIOSKY_API void SetIndexOrder(DOME_INDEX_ORDER order);
+
+			BIOSKY_API float GetRadius() const;
+			BIOSKY_API int GetVerticalSegments() const;
+			BIOSKY_API int GetHorozontalSegments() const;
+			BIOSKY_API bool GetFullDome() const;
+			BIOSKY_API DOME_INDEX_ORDER GetIndexOrder() const;
+
+			/**
+			* Get the number of vertecies the dome has.
+			*/
+			BIOSKY_API int GetVertexCount() const;
+
+			/**
+			* Get the number of indecies the dome has in the current index
+			* order.
+			*/
+			BIOSKY_API int GetIndexCount() const;
+
+			/**
+			* Check if the dome has too many vertecies for 16 bit indecies.
+			*/
+			BIOSKY_API bool NeedsLargeIndecies() const;
+
+			/**
+			* Build the dome.
+			*
+			* @return Returns the geometry. It was created with the library
+			*			allocator; delete it when you are done with it.
+			*/
+			BIOSKY_API RawGeometry * Build() const;
+
+			/**
+			* Build the dome into buffers supplied by the caller.
+			*
+			* @param[out] vertecies The buffer for the vertecies.
+			*
+			* @param[out] UVTextureCoordinates The buffer for the UV
+			*			coordinates.
+			*
+			* @param numVertecies The number of elements in the vertecies and
+			*			UVTextureCoordinates buffers.
+			*
+			* @param[out] indecies The buffer for the indecies.
+			*
+			* @param numIndecies The number of elements in indecies.
+			*
+			* @return Returns false if a buffer is NULL or too small.
+			*/
+			BIOSKY_API bool Build(Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, unsigned int * indecies, int numIndecies) const;
+
+			/**
+			* Reorder a triangle list for the post transform vertex cache.
+			* This is Tom Forsyth's "Linear-Speed Vertex Cache Optimisation".
+			*
+			* The time is linear in the number of triangles but every emitted
+			* triangle rescores the triangles of all the cached vertecies.
+			* That is about 0.4 microseconds per triangle: a 512 x 256 dome
+			* (260,000 triangles) takes about 110 ms where the bands and strip
+			* orders take a few ms. Build vertex cache ordered domes once and
+			* keep them instead of rebuilding them.
+			*
+			* @param[in,out] indecies The triangle list.
+			*
+			* @param numIndecies The number of indecies.
+			*
+			* @param numVertecies The number of vertecies the indecies use.
+			*/
+			BIOSKY_API static void OptimizeVertexCache(unsigned int * indecies, int numIndecies, int numVertecies);
+
+			/**
+			* Calculate the average cache miss ratio (vertecies transformed
+			* per triangle) with a FIFO vertex cache. Lower is better; the
+			* best a regular grid can do is about 0.5.
+			*
+			* @param indecies The indecies.
+			*
+			* @param numIndecies The number of indecies.
+			*
+			* @param primitive How the indecies are drawn. Degenerate strip
+			*			triangles are not counted.
+			*
+			* @param cacheSize The number of entries in the cache.
+			*
+			* @return Returns the ACMR.
+			*/
+			BIOSKY_API static float CalculateACMR(const unsigned int * indecies, int numIndecies, GEOMETRY_PRIMITIVE primitive = PRIMITIVE_TRIANGLE_LIST, int cacheSize = DefaultVertexCacheSize);
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			float _radius;
+			int _numVerticalSegments;
+			int _numHorozontalSegments;
+			bool _fullDome;
+			DOME_INDEX_ORDER _order;
+
+			/**
+			* Get the number of rings of vertecies, not counting the poles.
+			*/
+			int _GetRingCount() const;
+
+			/**
+			* Write the vertecies and UV coordinates.
+			*/
+			void _BuildVertecies(Vector3D * vertecies, Vector2D * UVTextureCoordinates) const;
+
+			/**
+			* Write the indecies in the current order.
+			*/
+			void _BuildIndecies(unsigned int * indecies) const;
+		};
+
+		/**
+		* Build full domes from 32 x 32 to 512 x 256 segments in every
+		* DOME_INDEX_ORDER and write the build time and ACMR of each as a
+		* table. The time is the average of as many builds as fit in about
+		* 100 ms. This takes over a second, so it is not part of the tests;
+		* call it from a tool to compare the orders on the target machine.
+		*
+		* @param out The stream to write the table to.
+		*/
+		BIOSKY_API void BenchmarkDomeGeometryBuilder(std::ostream & out);
+	}//end namespace SKY
+}//end namespace BIO
+
+inline float BIO::SKY::DomeGeometryBuilder::GetRadius() const
+{
+	return _radius;
+}
+
+inline int BIO::SKY::DomeGeometryBuilder::GetVerticalSegments() const
+{
+	return _numVerticalSegments;
+}
+
+inline int BIO::SKY::DomeGeometryBuilder::GetHorozontalSegments() const
+{
+	return _numHorozontalSegments;
+}
+
+inline bool BIO::SKY::DomeGeometryBuilder::GetFullDome() const
+{
+	return _fullDome;
+}
+
+inline BIO::SKY::DOME_INDEX_ORDER BIO::SKY::DomeGeometryBuilder::GetIndexOrder() const
+{
+	return _order;
+}
+
+inline bool BIO::SKY::DomeGeometryBuilder::NeedsLargeIndecies() const
+{
+	return GetVertexCount() > 65535;
+}
+
+#endif //___BIOSKY_DOMEGEOMETRYBUILDER_HPP__2015___
@@ -0,0 +1,310 @@
+/**
+* @file Ephemeris.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Accurate positions of the sun and the moon, with a cache so the
+* expensive series only have to be summed once an hour.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_EPHEMERIS_HPP__2015___
+#define ___BIOSKY_EPHEMERIS_HPP__2015___
+
+#include "CompileConfig.h"
+#include "SkyData.hpp"
+#include "SkyPosition.hpp"
+#include "Date.hpp"
+#include "Timestamp.hpp"
+
+#include <ostream>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* Which method is used to find the sun and the moon.
+		*/
+		enum EPHEMERIS_MODEL
+		{
+			/**
+			* Paul Schlyter's method (CalculateSkyData). Fast, with the sun
+			* good to about an arc minute and the moon to a few degrees.
+			*/
+			EPHEMERIS_SIMPLE = 0,
+			/**
+			* The truncated VSOP87 series of NREL's Solar Position Algorithm
+			* for the sun and Meeus' truncated ELP-2000/82 for the moon,
+			* cached by EphemerisCache. Good to a few arc seconds.
+			*/
+			EPHEMERIS_ACCURATE
+		};
+
+		/**
+		* The default time between the points an EphemerisCache sums the
+		* series at, in hours.
+		*/
+		const double DefaultEphemerisNodeSpacing = 1.0;
+
+		/**
+		* A position on the sky in ecliptic coordinates of the date.
+		*/
+		struct EclipticPosition
+		{
+			/**The ecliptic longitude in radians.*/
+			double longitude;
+			/**The ecliptic latitude in radians.*/
+			double latitude;
+			/**The distance from the center of the Earth in kilometers.*/
+			double distance;
+		};
+
+		/**
+		* Estimate Delta T, the difference between Terrestrial Time and
+		* Universal Time, from the polynomials of Espenak and Meeus.
+		*
+		* @param year The year with a fraction.
+		*
+		* @return Returns TT - UT in seconds.
+		*/
+		BIOSKY_API double CalculateDeltaT(double year);
+
+		/**
+		* Calculate the nutation in longitude and the true obliquity of the
+		* ecliptic (the four largest nutation terms).
+		*
+		* @param julianEphemerisDay The Julian day in Terrestrial Time.
+		*
+		* @param[out] nutationLongitude The nutation in longitude in
+		*			radians.
+		*
+		* @param[out] obliquity The true obliquity of the ecliptic in
+		*			radians.
+		*/
+		BIOSKY_API void CalculateNutation(double julianEphemerisDay, double * nutationLongitude, double * obliquity);
+
+		/**
+		* Calculate the apparent position of the sun. This sums the
+		* truncated VSOP87 series of NREL's Solar Position Algorithm and
+		* corrects for nutation and aberration.
+		*
+		* @param julianEphemerisDay The Julian day in Terrestrial Time.
+		*/
+		BIOSKY_API EclipticPosition CalculateSunEcliptic(double julianEphemerisDay);
+
+		/**
+		* Calculate the apparent position of the moon. This sums the
+		* truncated ELP-2000/82 series from Meeus' Astronomical Algorithms
+		* (chapter 47) and corrects for nutation.
+		*
+		* @param julianEphemerisDay The Julian day in Terrestrial Time.
+		*/
+		BIOSKY_API EclipticPosition CalculateMoonEcliptic(double julianEphemerisDay);
+
+		/**
+		* Convert ecliptic coordinates to right ascension and declination.
+		*
+		* @param position The ecliptic position.
+		*
+		* @param obliquity The obliquity of the ecliptic in radians.
+		*
+		* @param[out] rightAscension In radians, [0, 2PI).
+		*
+		* @param[out] declination In radians.
+		*/
+		BIOSKY_API void EclipticToEquatorial(const EclipticPosition & position, double obliquity, double * rightAscension, double * declination);
+
+		/**
+		* Calculate the mean sidereal time at Greenwich.
+		*
+		* @param julianDay The Julian day in Universal Time.
+		*
+		* @return Returns the sidereal time in radians, [0, 2PI).
+		*/
+		BIOSKY_API double CalculateGreenwichSiderealTime(double julianDay);
+
+		/**
+		* Calculate the Julian day in Universal Time.
+		*
+		* @param standardTime The time in 24 hr decimal format.
+		*
+		* @param UTCoffset The number of hours offset from UTC-0 time.
+		*
+		* @param month The month of the year.
+		*
+		* @param day The day of the month.
+		*
+		* @param year The year.
+		*/
+		BIOSKY_API double CalculateJulianDayUT(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year);
+
+		/**
+		* The accurate sun and moon for every frame.
+		*
+		* The series are summed at evenly spaced times (nodes) and kept,
+		* and each frame only interpolates between the four nearest nodes
+		* and turns the result into a place in the sky for the observer.
+		* With the default spacing of an hour the interpolation adds less
+		* than 0.01 arc seconds. A frame that moves into a new hour sums
+		* the series once; going back in time or jumping more than a few
+		* hours just sums the nodes it needs.
+		*
+		* An EphemerisCache is not thread safe; give each thread its own.
+		*/
+		class EphemerisCache
+		{
+		public:
+			/**
+			* Constructor
+			*
+			* @param nodeSpacing The hours between nodes. A day (24) is still
+			*			good to a few arc seconds.
+			*/
+			BIOSKY_API EphemerisCache(double nodeSpacing = DefaultEphemerisNodeSpacing);
+
+			/**
+			* Calculate the SkyData for a time and place. This is a drop in
+			* replacement for CalculateSkyData.
+			*/
+			BIOSKY_API SkyData CalculateSkyData(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude);
+
+			/**
+			* Calculate the SkyData for a time and place.
+			*
+			* @param julianDay The Julian day in Universal Time.
+			*
+			* @param latitude The latitude in radians.
+			*
+			* @param longitude The longitude in radians, east positive.
+			*/
+			BIOSKY_API SkyData CalculateSkyData(double julianDay, float latitude, float longitude);
+
+			/**
+			* Calculate the SkyData for a Timestamp and place.
+			*/
+			BIOSKY_API SkyData CalculateSkyData(const Timestamp & time, float latitude, float longitude);
+
+			/**
+			* Get the interpolated ecliptic positions.
+			*
+			* @param julianDay The Julian day in Universal Time.
+			*
+			* @param[out] sun The apparent position of the sun.
+			*
+			* @param[out] moon The apparent position of the moon.
+			*
+			* @param[out] obliquity The true obliquity of the ecliptic in
+			*			radians. May be NULL.
+			*
+			* @param[out] nutationLongitude The nutation in longitude in
+			*			radians. May be NULL.
+			*/
+			BIOSKY_API void GetPositions(double julianDay, EclipticPosition * sun, EclipticPosition * moon, double * obliquity = NULL, double * nutationLongitude = NULL);
+
+			/**
+			* Forget all the nodes.
+			*/
+			BIOSKY_API void Clear();
+
+			/**
+			* Get the hours between nodes.
+			*/
+			BIOSKY_API double GetNodeSpacing() const;
+
+			/**
+			* Get the number of times the series have been summed.
+			*/
+			BIOSKY_API int GetEvaluationCount() const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			/**The number of values kept at each node.*/
+			enum { _NumValues = 8 };
+
+			/**The number of nodes kept.*/
+			enum { _NumNodes = 8 };
+
+			struct _Node
+			{
+				/**False if the slot is empty.*/
+				bool valid;
+				/**The node number. Node 0 is at J2000.0.*/
+				long long index;
+				double values[_NumValues];
+			};
+
+			_Node _nodes[_NumNodes];
+			double _nodeSpacing;
+			int _evaluations;
+
+			/**
+			* Get a node, summing the series if it is not kept.
+			*/
+			const _Node & _GetNode(long long index);
+		};
+
+		/**
+		* Time a 20 hour time lapse of frames with EPHEMERIS_SIMPLE,
+		* EPHEMERIS_ACCURATE with hourly and daily nodes, and the accurate
+		* series summed every frame, and write the cost per frame, the
+		* number of times the series were summed and the worst sun and moon
+		* error of each as a table. The times depend on the machine, so this
+		* is not part of the tests; call it from a tool to pick a model on
+		* the target machine.
+		*
+		* @param out The stream to write the table to.
+		*/
+		BIOSKY_API void BenchmarkEphemeris(std::ostream & out);
+	}//end namespace SKY
+}//end namespace BIO
+
+inline double BIO::SKY::EphemerisCache::GetNodeSpacing() const
+{
+	return _nodeSpacing;
+}
+
+inline int BIO::SKY::EphemerisCache::GetEvaluationCount() const
+{
+	return _evaluations;
+}
+
+#endif //___BIOSKY_EPHEMERIS_HPP__2015___
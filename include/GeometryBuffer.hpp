@@ -0,0 +1,405 @@
+/**
+* @file GeometryBuffer.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Geometry stored in one aligned block of memory in the vertex layout a
+* renderer wants, so it can be uploaded with a single copy.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_GEOMETRYBUFFER_HPP__2015___
+#define ___BIOSKY_GEOMETRYBUFFER_HPP__2015___
+
+#include "CompileConfig.h"
+#include "RawGeometry.hpp"
+#include "Allocator.hpp"
+
+#include <cstddef>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* How the vertex attributes of a GeometryBuffer are arranged.
+		*/
+		enum GEOMETRY_LAYOUT
+		{
+			/**
+			* Every vertex is stored whole, one after another, with the
+			* attributes at the offsets of the GeometryFormat.
+			*/
+			LAYOUT_INTERLEAVED = 0,
+			/**
+			* Each attribute is stored in its own tightly packed array
+			* (positions, then normals, then colors, then UV coordinates).
+			* Each array starts on the alignment of the buffer.
+			*/
+			LAYOUT_SEPARATE
+		};
+
+		/**
+		* Where each attribute is in an interleaved vertex. An offset of -1
+		* means the vertex does not have that attribute. Positions are
+		* always there.
+		*
+		* Positions and normals are 3 floats, colors are one 32 bit
+		* 0xAARRGGBB value, and UV coordinates are 2 floats. The stride and
+		* the offsets must be multiples of 4 so every attribute is aligned.
+		*/
+		struct GeometryFormat
+		{
+			/**The size of one vertex in bytes.*/
+			int stride;
+			/**The byte offset of the position.*/
+			int positionOffset;
+			/**The byte offset of the normal, or -1.*/
+			int normalOffset;
+			/**The byte offset of the color, or -1.*/
+			int colorOffset;
+			/**The byte offset of the UV coordinates, or -1.*/
+			int UVOffset;
+
+			/**
+			* Position, UV coordinates and color. 24 bytes.
+			*/
+			BIOSKY_API static GeometryFormat PositionUVColor();
+
+			/**
+			* Position, normal, color and UV coordinates. 36 bytes. This is
+			* the layout of the standard vertex of many engines (Irrlicht's
+			* S3DVertex for one).
+			*/
+			BIOSKY_API static GeometryFormat PositionNormalColorUV();
+		};
+
+		/**
+		* A view of elements in memory that may have other data between
+		* them.
+		*/
+		template <typename T>
+		struct GeometrySpan
+		{
+			/**The first element, or NULL.*/
+			T * data;
+			/**The number of elements.*/
+			int count;
+			/**The distance in bytes from one element to the next.*/
+			int stride;
+
+			/**
+			* Get an element.
+			*/
+			T & operator [] (int index) const;
+
+			/**
+			* Get the number of elements.
+			*/
+			int size() const;
+
+			/**
+			* Check if there are no elements.
+			*/
+			bool empty() const;
+		};
+
+		/**
+		* Vertecies and indecies in a single block of memory from the
+		* library allocator. The vertex data comes first and the index data
+		* starts on the next multiple of the alignment.
+		*
+		* GeometryBuffers can be moved but not copied.
+		*/
+		class GeometryBuffer
+		{
+		public:
+			/**
+			* Constructor. The buffer is empty.
+			*/
+			BIOSKY_API GeometryBuffer();
+
+			/**
+			* Constructor. Copies a RawGeometry into the buffer. See Create
+			* and CopyFrom.
+			*/
+			BIOSKY_API GeometryBuffer(const RawGeometry & geometry, const GeometryFormat & format, GEOMETRY_LAYOUT layout = LAYOUT_INTERLEAVED, std::size_t alignment = DefaultAlignment, unsigned int color = 0xFFFFFFFF);
+
+			/**
+			* Move constructor. other is left empty.
+			*/
+			BIOSKY_API GeometryBuffer(GeometryBuffer && other);
+
+			/**
+			* Move assignment. other is left empty.
+			*/
+			BIOSKY_API GeometryBuffer & operator = (GeometryBuffer && other);
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API ~GeometryBuffer();
+
+			/**
+			* Allocate the buffer. Anything already held is released first.
+			* The memory is zeroed.
+			*
+			* @param numVertecies The number of vertecies.
+			*
+			* @param numIndecies The number of indecies.
+			*
+			* @param largeIndecies If true the indecies are 32 bit, otherwise
+			*			16 bit.
+			*
+			* @param format The attributes of each vertex.
+			*
+			* @param layout Whether the attributes are interleaved.
+			*
+			* @param alignment The alignment of the memory and of the index
+			*			data (and of each attribute array in the separate
+			*			layout). Usually 16 or 64. Must be a power of 2.
+			*
+			* @return Returns false if the format is bad or the memory could
+			*			not be allocated.
+			*/
+			BIOSKY_API bool Create(int numVertecies, int numIndecies, bool largeIndecies, const GeometryFormat & format, GEOMETRY_LAYOUT layout = LAYOUT_INTERLEAVED, std::size_t alignment = DefaultAlignment);
+
+			/**
+			* Fill the buffer from a RawGeometry. The buffer must already be
+			* big enough (see Create). Normals point to the center of the
+			* dome, which is where the sky is seen from.
+			*
+			* @param geometry The geometry to copy.
+			*
+			* @param color The color given to every vertex as 0xAARRGGBB.
+			*
+			* @return Returns false if the buffer is too small, or if the
+			*			buffer has 16 bit indecies and the geometry has an
+			*			index that does not fit in 16 bits. Nothing is
+			*			copied when it fails.
+			*/
+			BIOSKY_API bool CopyFrom(const RawGeometry & geometry, unsigned int color = 0xFFFFFFFF);
+
+			/**
+			* Release the memory.
+			*/
+			BIOSKY_API void Release();
+
+			BIOSKY_API int GetVertexCount() const;
+			BIOSKY_API int GetIndexCount() const;
+			BIOSKY_API bool HasLargeIndecies() const;
+			BIOSKY_API const GeometryFormat & GetFormat() const;
+			BIOSKY_API GEOMETRY_LAYOUT GetLayout() const;
+			BIOSKY_API std::size_t GetAlignment() const;
+
+			/**
+			* Get the whole block of memory.
+			*/
+			BIOSKY_API void * GetData();
+			BIOSKY_API const void * GetData() const;
+			BIOSKY_API std::size_t GetDataSize() const;
+
+			/**
+			* Get the vertex data. With the interleaved layout this can be
+			* copied straight into a vertex buffer of the same format.
+			*/
+			BIOSKY_API void * GetVertexData();
+			BIOSKY_API const void * GetVertexData() const;
+			BIOSKY_API std::size_t GetVertexDataSize() const;
+
+			/**
+			* Get the index data. This can be copied straight into an index
+			* buffer of the same index size.
+			*/
+			BIOSKY_API void * GetIndexData();
+			BIOSKY_API const void * GetIndexData() const;
+			BIOSKY_API std::size_t GetIndexDataSize() const;
+
+			/**
+			* Get the attributes. The spans are empty when the format does not
+			* have the attribute.
+			*/
+			BIOSKY_API GeometrySpan<Vector3D> GetPositions();
+			BIOSKY_API GeometrySpan<Vector3D> GetNormals();
+			BIOSKY_API GeometrySpan<unsigned int> GetColors();
+			BIOSKY_API GeometrySpan<Vector2D> GetUVTextureCoordinates();
+
+			/**
+			* Get the indecies. Only the one that matches HasLargeIndecies
+			* is not empty.
+			*/
+			BIOSKY_API GeometrySpan<unsigned short> GetIndecies16();
+			BIOSKY_API GeometrySpan<unsigned int> GetIndecies32();
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			unsigned char * _data;
+			std::size_t _dataSize;
+			std::size_t _alignment;
+			GeometryFormat _format;
+			GEOMETRY_LAYOUT _layout;
+			int _numVertecies;
+			int _numIndecies;
+			bool _largeIndecies;
+			/**The size of the vertex data before the padding.*/
+			std::size_t _vertexDataSize;
+			/**The byte offset of the index data.*/
+			std::size_t _indexOffset;
+			/**The byte offset of each attribute array in the separate layout.*/
+			std::size_t _positionArray;
+			std::size_t _normalArray;
+			std::size_t _colorArray;
+			std::size_t _UVArray;
+
+			/**
+			* Build a span for an attribute.
+			*/
+			template <typename T>
+			GeometrySpan<T> _GetAttribute(int offset, std::size_t array);
+
+			/**
+			* Take everything from other and leave it empty.
+			*/
+			void _Take(GeometryBuffer & other);
+
+			/**
+			* Copying is not allowed. Use the move constructor.
+			*/
+			GeometryBuffer(const GeometryBuffer & other);
+			GeometryBuffer & operator = (const GeometryBuffer & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+template <typename T>
+inline T & BIO::SKY::GeometrySpan<T>::operator [] (int index) const
+{
+	return *(T *)((unsigned char *)data + (std::size_t)index * stride);
+}
+
+template <typename T>
+inline int BIO::SKY::GeometrySpan<T>::size() const
+{
+	return count;
+}
+
+template <typename T>
+inline bool BIO::SKY::GeometrySpan<T>::empty() const
+{
+	return count == 0;
+}
+
+inline int BIO::SKY::GeometryBuffer::GetVertexCount() const
+{
+	return _numVertecies;
+}
+
+inline int BIO::SKY::GeometryBuffer::GetIndexCount() const
+{
+	return _numIndecies;
+}
+
+inline bool BIO::SKY::GeometryBuffer::HasLargeIndecies() const
+{
+	return _largeIndecies;
+}
+
+inline const BIO::SKY::GeometryFormat & BIO::SKY::GeometryBuffer::GetFormat() const
+{
+	return _format;
+}
+
+inline BIO::SKY::GEOMETRY_LAYOUT BIO::SKY::GeometryBuffer::GetLayout() const
+{
+	return _layout;
+}
+
+inline std::size_t BIO::SKY::GeometryBuffer::GetAlignment() const
+{
+	return _alignment;
+}
+
+inline void * BIO::SKY::GeometryBuffer::GetData()
+{
+	return _data;
+}
+
+inline const void * BIO::SKY::GeometryBuffer::GetData() const
+{
+	return _data;
+}
+
+inline std::size_t BIO::SKY::GeometryBuffer::GetDataSize() const
+{
+	return _dataSize;
+}
+
+inline void * BIO::SKY::GeometryBuffer::GetVertexData()
+{
+	return _data;
+}
+
+inline const void * BIO::SKY::GeometryBuffer::GetVertexData() const
+{
+	return _data;
+}
+
+inline std::size_t BIO::SKY::GeometryBuffer::GetVertexDataSize() const
+{
+	return _vertexDataSize;
+}
+
+inline void * BIO::SKY::GeometryBuffer::GetIndexData()
+{
+	return (_data) ? _data + _indexOffset : NULL;
+}
+
+inline const void * BIO::SKY::GeometryBuffer::GetIndexData() const
+{
+	return (_data) ? _data + _indexOffset : NULL;
+}
+
+inline std::size_t BIO::SKY::GeometryBuffer::GetIndexDataSize() const
+{
+	return (std::size_t)_numIndecies * ((_largeIndecies) ? sizeof(unsigned int) : sizeof(unsigned short));
+}
+
+#endif //___BIOSKY_GEOMETRYBUFFER_HPP__2015___
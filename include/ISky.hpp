@@ -226,6 +226,18 @@ namespace BIO
 			*		NOT be called every frame.
 			*/
 			virtual void UpdateSunPosition() = 0;
+
+			//New virtual functions go after this line and have a default
+			//so the vtable of existing skies does not change.
+
+			/**
+			* Set the turbidity of the air used for the sky color. 2 is a
+			* very clear sky and 10 a hazy one. The default does nothing, for
+			* skies that do not use a turbidity.
+			*
+			* @param turbidity The turbidity.
+			*/
+			virtual void SetTurbidity(float) {}
 		};
 	}
 }
@@ -0,0 +1,439 @@
+/**
+* @file NightSkyTiles.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A tiled copy of the night sky texture so only the part of the sky that is
+* above the horizon has to be decoded and uploaded.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_NIGHTSKYTILES_HPP__2015___
+#define ___BIOSKY_NIGHTSKYTILES_HPP__2015___
+
+#include "CompileConfig.h"
+#include "AssetStore.hpp"
+#include "Error.hpp"
+#include "Vector3D.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**The default width and height of a night sky tile in pixels.*/
+		const int DefaultNightSkyTileSize = 256;
+
+		/**
+		* The night sky texture cut into square tiles. Every tile is stored
+		* run length encoded (the sky is mostly black) and is only expanded
+		* when it is needed.
+		*
+		* Each tile also has a bounding cone on the star dome. The cone is
+		* built from the triangles of CreateNightSkyDomeGeometry whose UV
+		* coordinates touch the tile, so tiles can be tested against the
+		* horizon once the dome has been rotated with SetStarPosition. Tiles
+		* that no triangle touches are never visible.
+		*/
+		class NightSkyTiles : public Asset
+		{
+		public:
+			/**
+			* A single tile.
+			*/
+			struct Tile
+			{
+				/**The left edge of the tile in the full texture.*/
+				int x;
+				/**The top edge of the tile in the full texture.*/
+				int y;
+				/**The width of the tile. Tiles on the right edge may be smaller.*/
+				int width;
+				/**The height of the tile. Tiles on the bottom edge may be smaller.*/
+				int height;
+				/**The center of the tile's bounding cone on the unit star dome.*/
+				Vector3D axis;
+				/**The half angle of the bounding cone in radians.*/
+				float halfAngle;
+				/**True if no part of the star dome uses this tile.*/
+				bool unused;
+				/**The run length encoded pixels of this tile.*/
+				const unsigned char * encoded;
+				/**The size of encoded in bytes.*/
+				std::size_t encodedSize;
+			};
+
+			/**
+			* Constructor. Cuts an image into tiles and encodes them.
+			*
+			* @param image The night sky texture in B G R A format.
+			*
+			* @param width The width of the image.
+			*
+			* @param height The height of the image.
+			*
+			* @param tileSize The width and height of a tile in pixels.
+			*/
+			BIOSKY_API NightSkyTiles(const unsigned char * image, int width, int height, int tileSize = DefaultNightSkyTileSize);
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API virtual ~NightSkyTiles();
+
+			/**
+			* Get the width of the full texture.
+			*/
+			BIOSKY_API int GetWidth() const;
+
+			/**
+			* Get the height of the full texture.
+			*/
+			BIOSKY_API int GetHeight() const;
+
+			/**
+			* Get the width and height of a full tile.
+			*/
+			BIOSKY_API int GetTileSize() const;
+
+			/**
+			* Get the number of tiles across the texture.
+			*/
+			BIOSKY_API int GetTilesX() const;
+
+			/**
+			* Get the number of tiles down the texture.
+			*/
+			BIOSKY_API int GetTilesY() const;
+
+			/**
+			* Get the total number of tiles.
+			*/
+			BIOSKY_API int GetTileCount() const;
+
+			/**
+			* Get a tile. Tiles are numbered left to right, top to bottom.
+			* Values out of range are clamped.
+			*/
+			BIOSKY_API const Tile & GetTile(int index) const;
+
+			/**
+			* Get the size in bytes of all the encoded tiles.
+			*/
+			BIOSKY_API std::size_t GetEncodedSize() const;
+
+			/**
+			* Expand a tile into B G R A pixels.
+			*
+			* @param index The tile to decode.
+			*
+			* @param[out] pixels The decoded tile, tile width x tile height
+			*			pixels with no padding between the rows. This must
+			*			be at least GetTileSize() x GetTileSize() x 4 bytes.
+			*
+			* @return Returns true if the tile was decoded.
+			*/
+			BIOSKY_API bool DecodeTile(int index, unsigned char * pixels) const;
+
+			/**
+			* Find the tiles that are above the horizon.
+			*
+			* The star dome is rotated the same way as
+			* IDomeGeometry::SetStarRotation(northStarZenith, starRotation, 0):
+			* first about the Y axis by starRotation and then about the X axis
+			* by northStarZenith. +Y is up after the rotation.
+			*
+			* @param northStarZenith The zenith of the celestial north pole
+			*			in radians. See CalculateCelestialNorthPoleZenith.
+			*
+			* @param starRotation The rotation of the stars in radians. See
+			*			CalculateStarRotation.
+			*
+			* @param horizonMargin How far below the horizon, in radians, a
+			*			tile still counts as visible.
+			*
+			* @param[out] visible One value for each tile. Set to true if the
+			*			tile is visible.
+			*
+			* @return Returns the number of visible tiles.
+			*/
+			BIOSKY_API int FindVisibleTiles(float northStarZenith, float starRotation, float horizonMargin, bool * visible) const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class and the NightSkyTileStreamer class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			int _width;
+			int _height;
+			int _tileSize;
+			int _tilesX;
+			int _tilesY;
+			/**All the tiles.*/
+			Tile * _tiles;
+			/**The encoded pixels of every tile.*/
+			unsigned char * _data;
+			/**The size of _data in bytes.*/
+			std::size_t _dataSize;
+
+			/**
+			* Build the bounding cones from the night sky dome geometry.
+			*/
+			void _BuildBounds();
+
+			/**
+			* Copying is not allowed. The tiles are shared through the
+			* AssetStore instead.
+			*/
+			NightSkyTiles(const NightSkyTiles & other);
+			NightSkyTiles & operator = (const NightSkyTiles & other);
+		};
+
+		/**
+		* Receives the night sky tiles as they are made resident or evicted.
+		* Implement this to copy tiles into a texture (or texture array) on
+		* the GPU.
+		*/
+		class INightSkyTileSink
+		{
+		public:
+			/**
+			* Destructor
+			*/
+			virtual ~INightSkyTileSink() {}
+
+			/**
+			* A tile has come above the horizon and should be uploaded.
+			*
+			* @param index The index of the tile.
+			*
+			* @param tile The tile. Its x, y, width, and height give its
+			*			place in the full texture.
+			*
+			* @param pixels The decoded B G R A pixels of the tile. Only
+			*			valid for the length of the call.
+			*/
+			virtual void UploadTile(int index, const NightSkyTiles::Tile & tile, const unsigned char * pixels) = 0;
+
+			/**
+			* A tile has been below the horizon long enough that it can be
+			* released.
+			*
+			* @param index The index of the tile.
+			*
+			* @param tile The tile.
+			*/
+			virtual void EvictTile(int index, const NightSkyTiles::Tile & tile) = 0;
+		};
+
+		/**
+		* Keeps the visible night sky tiles resident in a sink. Call Update
+		* whenever the star position changes (or every frame); tiles that
+		* come above the horizon are decoded and uploaded, and tiles that
+		* stay below the horizon for longer than the eviction delay are
+		* evicted.
+		*/
+		class NightSkyTileStreamer
+		{
+		public:
+			/**
+			* Constructor
+			*
+			* @param tiles The tiled night sky. If this is empty the
+			*			streamer has no tiles and GetErrorCode returns
+			*			ERROR_CREATING_OBJECT.
+			*
+			* @param sink Where tiles are uploaded to. This must stay alive as
+			*			long as the streamer.
+			*
+			* @param evictionDelay The number of seconds a tile has to stay
+			*			below the horizon before it is evicted.
+			*
+			* @param horizonMargin How far below the horizon, in radians, a
+			*			tile is still uploaded. A small margin hides the
+			*			upload of tiles that are about to rise.
+			*/
+			BIOSKY_API NightSkyTileStreamer(std::shared_ptr<const NightSkyTiles> tiles, INightSkyTileSink * sink, float evictionDelay = 60.0f, float horizonMargin = 0.1f);
+
+			/**
+			* Destructor. Resident tiles are not evicted from the sink.
+			*/
+			BIOSKY_API ~NightSkyTileStreamer();
+
+			/**
+			* Update which tiles are resident.
+			*
+			* @param northStarZenith The zenith of the celestial north pole
+			*			in radians.
+			*
+			* @param starRotation The rotation of the stars in radians.
+			*
+			* @param elapsedSeconds The time since the last update.
+			*
+			* @param maxUploads The most tiles to upload in this update, or 0
+			*			for no limit. Tiles that are not uploaded are tried
+			*			again on the next update.
+			*
+			* @return Returns the number of tiles uploaded.
+			*/
+			BIOSKY_API int Update(float northStarZenith, float starRotation, float elapsedSeconds, int maxUploads = 0);
+
+			/**
+			* Evict every resident tile.
+			*/
+			BIOSKY_API void EvictAll();
+
+			/**
+			* Check if a tile is resident in the sink.
+			*/
+			BIOSKY_API bool IsTileResident(int index) const;
+
+			/**
+			* Check if a tile was visible in the last update.
+			*/
+			BIOSKY_API bool IsTileVisible(int index) const;
+
+			/**
+			* Get the number of resident tiles.
+			*/
+			BIOSKY_API int GetResidentCount() const;
+
+			/**
+			* Get the error code. OK if the streamer was created with tiles.
+			*/
+			BIOSKY_API ErrorType GetErrorCode() const;
+
+		private:
+			std::shared_ptr<const NightSkyTiles> _tiles;
+			/**The number of tiles, 0 without tiles.*/
+			int _tileCount;
+			ErrorType _error;
+			INightSkyTileSink * _sink;
+			float _evictionDelay;
+			float _horizonMargin;
+			/**Visibility of each tile from the last update.*/
+			bool * _visible;
+			/**True for each tile that is in the sink.*/
+			bool * _resident;
+			/**Seconds each tile has been below the horizon.*/
+			float * _hiddenTime;
+			/**Space for one decoded tile.*/
+			unsigned char * _scratch;
+			int _residentCount;
+
+			NightSkyTileStreamer(const NightSkyTileStreamer & other);
+			NightSkyTileStreamer & operator = (const NightSkyTileStreamer & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline int BIO::SKY::NightSkyTiles::GetWidth() const
+{
+	return _width;
+}
+
+inline int BIO::SKY::NightSkyTiles::GetHeight() const
+{
+	return _height;
+}
+
+inline int BIO::SKY::NightSkyTiles::GetTileSize() const
+{
+	return _tileSize;
+}
+
+inline int BIO::SKY::NightSkyTiles::GetTilesX() const
+{
+	return _tilesX;
+}
+
+inline int BIO::SKY::NightSkyTiles::GetTilesY() const
+{
+	return _tilesY;
+}
+
+inline int BIO::SKY::NightSkyTiles::GetTileCount() const
+{
+	return _tilesX * _tilesY;
+}
+
+inline const BIO::SKY::NightSkyTiles::Tile & BIO::SKY::NightSkyTiles::GetTile(int index) const
+{
+	if (index < 0)
+		index = 0;
+
+	if (index >= GetTileCount())
+		index = GetTileCount() - 1;
+
+	return _tiles[index];
+}
+
+inline std::size_t BIO::SKY::NightSkyTiles::GetEncodedSize() const
+{
+	return _dataSize;
+}
+
+inline bool BIO::SKY::NightSkyTileStreamer::IsTileResident(int index) const
+{
+	if (index < 0 || index >= _tileCount)
+		return false;
+
+	return _resident[index];
+}
+
+inline bool BIO::SKY::NightSkyTileStreamer::IsTileVisible(int index) const
+{
+	if (index < 0 || index >= _tileCount)
+		return false;
+
+	return _visible[index];
+}
+
+inline int BIO::SKY::NightSkyTileStreamer::GetResidentCount() const
+{
+	return _residentCount;
+}
+
+inline BIO::ErrorType BIO::SKY::NightSkyTileStreamer::GetErrorCode() const
+{
+	return _error;
+}
+
+#endif //___BIOSKY_NIGHTSKYTILES_HPP__2015___
@@ -0,0 +1,144 @@
+/**
+* @file Planets.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* The positions and brightness of the naked eye planets.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_PLANETS_HPP__2015___
+#define ___BIOSKY_PLANETS_HPP__2015___
+
+#include "CompileConfig.h"
+#include "SkyPosition.hpp"
+#include "Date.hpp"
+#include "Timestamp.hpp"
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The planets that can be seen without a telescope. The values are
+		* the indecies into the array filled by CalculatePlanetPositions.
+		*/
+		enum PLANET
+		{
+			PLANET_MERCURY = 0,
+			PLANET_VENUS,
+			PLANET_MARS,
+			PLANET_JUPITER,
+			PLANET_SATURN
+		};
+
+		/**
+		* The number of planets filled by CalculatePlanetPositions.
+		*/
+		const int NumPlanets = 5;
+
+		/**
+		* Where a planet is in the sky and how bright it is.
+		*/
+		struct PlanetPosition
+		{
+			/**
+			* The azimuth and zenith of the planet, the same as
+			* CalculateSunPosition.
+			*/
+			SkyPosition position;
+
+			/**
+			* The visual magnitude of the planet. Smaller is brighter.
+			*/
+			float magnitude;
+
+			/**
+			* The distance from the Earth in astronomical units.
+			*/
+			float distance;
+		};
+
+		/**
+		* Calculate the positions and magnitudes of Mercury, Venus, Mars,
+		* Jupiter and Saturn.
+		*
+		* This uses the same method as CalculateSunPosition (Paul Schlyter's)
+		* and is good to a few arc minutes. All the planets and the sun are
+		* done together in one pass: the orbit of the sun gives the position
+		* of the Earth, and the obliquity, sidereal time and horizon
+		* transform are worked out once for all of them.
+		*
+		* @param standardTime The time in 24 hr decimal format. For Example
+		*			1:15 PM == 13.25.
+		*
+		* @param UTCoffset The number of hours offset from UTC-0 time.
+		*
+		* @param month The month of the year.
+		*
+		* @param day The day of the month.
+		*
+		* @param year The year.
+		*
+		* @param latitude The latitude of the location in radians. Range:
+		*			-PI/2 to PI/2.
+		*
+		* @param longitude The longitude of the location in radians.
+		*			Locations east of the prime meridian are positive.
+		*			Range: -PI to PI.
+		*
+		* @param[out] planets An array of NumPlanets that is filled in the
+		*			order of PLANET.
+		*
+		* @param[out] sunPosition If this is not NULL it is set to the
+		*			position of the sun from the same pass.
+		*
+		* @return Returns false if planets is NULL.
+		*/
+		BIOSKY_API bool CalculatePlanetPositions(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude, PlanetPosition * planets, SkyPosition * sunPosition = NULL);
+
+		/**
+		* Calculate the positions and magnitudes of the planets at a
+		* Timestamp. The rest of the parameters are the same as the calendar
+		* version.
+		*/
+		BIOSKY_API bool CalculatePlanetPositions(const Timestamp & time, float latitude, float longitude, PlanetPosition * planets, SkyPosition * sunPosition = NULL);
+
+#if BIOSKY_TESTING == 1
+		/**
+		* Test the planet functions.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		bool PlanetTests(XNELO::TESTING::Test * test);
+#endif
+	}//end namespace SKY
+}//end namespace BIO
+
+#endif //___BIOSKY_PLANETS_HPP__2015___
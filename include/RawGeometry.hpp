@@ -40,14 +40,37 @@
 #include "CompileConfig.h"
 #include "Vector3D.hpp"
 #include "Vector2D.hpp"
+#include "Allocator.hpp"
 
 namespace BIO
 {
 	namespace SKY
 	{
+		/**
+		* How the indecies of a RawGeometry are to be drawn.
+		*/
+		enum GEOMETRY_PRIMITIVE
+		{
+			/**Every 3 indecies make a triangle.*/
+			PRIMITIVE_TRIANGLE_LIST = 0,
+			/**
+			* A triangle strip. Every index after the first two makes a
+			* triangle with the two before it. Degenerate triangles join
+			* separate strips together.
+			*/
+			PRIMITIVE_TRIANGLE_STRIP
+		};
+
 		/**
 		* RawGeometry class holds geometry data. Indecies, vertecies and UV 
 		* coordinates.
+		*
+		* Geometry with more than 65535 vertecies uses 32 bit indecies. In
+		* that case indecies is NULL and indecies32 holds the data.
+		*
+		* Arrays created with AllocateArrays are released through the
+		* library allocator. Arrays set on the members directly must be
+		* created with new[], as before, and are released with delete[].
 		*/
 		class RawGeometry
 		{
@@ -55,6 +78,8 @@ namespace BIO
 
 			/**The indecies for the geometry*/
 			unsigned short * indecies;
+			/**The indecies for the geometry when 32 bit indecies are used.*/
+			unsigned int * indecies32;
 			/**Number of indecies.*/
 			int numIndecies;
 			/**Vertex corrdinates data*/
@@ -63,6 +88,8 @@ namespace BIO
 			Vector2D *UVTextureCoordinates;
 			/**Number of vertecies.*/
 			int numVertecies;
+			/**How the indecies are drawn.*/
+			GEOMETRY_PRIMITIVE primitiveType;
 
 			/**
 			* Default Constructor
@@ -73,35 +100,128 @@ namespace BIO
 			* Destructor
 			*/
 			~RawGeometry();
+
+			/**
+			* Allocate the index, vertex and UV arrays through the library
+			* allocator. Any arrays already held are released first. Do not
+			* replace the arrays with new[] ones after this.
+			*
+			* @param numVerts The number of vertecies.
+			*
+			* @param numIndex The number of indecies.
+			*
+			* @param largeIndecies If true indecies32 is allocated instead of
+			*			indecies.
+			*
+			* @note Throws std::bad_alloc when an array can not be allocated.
+			*		The arrays that were allocated are released with the
+			*		geometry.
+			*/
+			void AllocateArrays(int numVerts, int numIndex, bool largeIndecies = false);
+
+			/**
+			* Get one index no matter which index array is in use.
+			*/
+			unsigned int GetIndex(int i) const;
+
+			/**
+			* Release the index, vertex and UV arrays.
+			*/
+			void FreeArrays();
+
+			/**
+			* RawGeometry objects are created through the library allocator
+			* so they can still be released with delete.
+			*/
+			static void * operator new(std::size_t size);
+			static void operator delete(void * memory);
+
+		private:
+			/**True if the arrays came from AllocateArrays.*/
+			bool _allocatorArrays;
+
+			/**
+			* Copying is not allowed. The arrays would be released twice.
+			*/
+			RawGeometry(const RawGeometry & other);
+			RawGeometry & operator = (const RawGeometry & other);
 		};
 	}//end namespace SKY
 }// end namespace BIO
 
-inline BIO::SKY::RawGeometry::RawGeometry() : indecies(NULL), numIndecies(0), vertecies(NULL), UVTextureCoordinates(NULL), numVertecies(0)
+inline BIO::SKY::RawGeometry::RawGeometry() : indecies(NULL), indecies32(NULL), numIndecies(0), vertecies(NULL), UVTextureCoordinates(NULL), numVertecies(0), primitiveType(PRIMITIVE_TRIANGLE_LIST), _allocatorArrays(false)
 {}
 
 inline BIO::SKY::RawGeometry::~RawGeometry()
 {
-	if (indecies)
-	{
-		delete[] indecies;
-		indecies = NULL;
-	}
+	FreeArrays();
+}
+
+inline void BIO::SKY::RawGeometry::AllocateArrays(int numVerts, int numIndex, bool largeIndecies)
+{
+	FreeArrays();
+
+	//set first so the arrays made before a failed one are released
+	_allocatorArrays = true;
 
-	if (vertecies)
+	if (largeIndecies)
+		indecies32 = AllocateArray<unsigned int>(numIndex);
+	else
+		indecies = AllocateArray<unsigned short>(numIndex);
+
+	vertecies = AllocateArray<Vector3D>(numVerts);
+	UVTextureCoordinates = AllocateArray<Vector2D>(numVerts);
+
+	numIndecies = (indecies || indecies32) ? numIndex : 0;
+	numVertecies = (vertecies && UVTextureCoordinates) ? numVerts : 0;
+}
+
+inline void BIO::SKY::RawGeometry::FreeArrays()
+{
+	if (_allocatorArrays)
 	{
-		delete[] vertecies;
-		vertecies = NULL;
+		FreeArray(indecies);
+		FreeArray(indecies32);
+		FreeArray(vertecies);
+		FreeArray(UVTextureCoordinates);
 	}
-
-	if (UVTextureCoordinates)
+	else
 	{
+		//filled by the user with new[]
+		delete[] indecies;
+		delete[] indecies32;
+		delete[] vertecies;
 		delete[] UVTextureCoordinates;
-		UVTextureCoordinates = NULL;
 	}
 
+	indecies = NULL;
+	indecies32 = NULL;
+	vertecies = NULL;
+	UVTextureCoordinates = NULL;
+	_allocatorArrays = false;
+
 	numIndecies = 0;
 	numVertecies = 0;
 }
 
+inline unsigned int BIO::SKY::RawGeometry::GetIndex(int i) const
+{
+	return (indecies32) ? indecies32[i] : indecies[i];
+}
+
+inline void * BIO::SKY::RawGeometry::operator new(std::size_t size)
+{
+	void * memory = Allocate(size);
+
+	if (memory == NULL)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+inline void BIO::SKY::RawGeometry::operator delete(void * memory)
+{
+	Free(memory);
+}
+
 #endif //___BIOSKY_RAWGEOMETRY_HPP__2015___
\ No newline at end of file
@@ -41,12 +41,18 @@
 #include "ISky.hpp"
 #include "IDomeGeometry.hpp"
 #include "MathUtils.hpp"
+#include <algorithm>
 #include <vector>
 
 namespace BIO
 {
 	namespace SKY
 	{
+		/**
+		* The turbidity of the air a Sky starts with.
+		*/
+		const float DefaultTurbidity = 3.5f;
+
 		/**
 		* This class defines the interface for a sky class. All BIOSky Skies
 		* should inherit from this class. This is an abstract class.
@@ -80,6 +86,10 @@ namespace BIO
 			*/
 			SkyPosition _sunPos;
 			/**
+			* The turbidity of the air.
+			*/
+			float _turbidity;
+			/**
 			* The error code for this class. If it is 0 or BIO::SKY::OK then 
 			* there was no error. Otherwise there is an error.
 			*/
@@ -203,6 +213,63 @@ namespace BIO
 			* @retunr Returns an YyxColor structure with the zenith color.
 			*/
 			BIOSKY_API static YyxColor GetYyxColorForZenithAndTurbidity(double zenith, double turbidity);
+
+			/**
+			* Calculate the sky color for a sun position and set it on a set
+			* of vertecies. This is CalculateSkyColors without the stored sun
+			* position, so it can run on another thread while the sky is
+			* being drawn.
+			*
+			* @param sunPos The position of the sun.
+			*
+			* @param verts The vertecies to color.
+			*
+			* @param turbidity The turbidity of the air.
+			*/
+			BIOSKY_API static void CalculateSkyColorsForSun(const SkyPosition & sunPos, IDomeVertecies * verts, float turbidity = DefaultTurbidity);
+
+			/**
+			* Calculate the color of the skylights for a sun position. This is
+			* CalculateSkyLights without the stored sun position.
+			*/
+			BIOSKY_API LightData CalculateSkyLightsForSun(const SkyPosition & sunPos) const;
+
+			/**
+			* Get the number of pixels in the moon texture.
+			*/
+			BIOSKY_API static int GetMoonTexturePixelCount();
+
+			/**
+			* Calculate the alpha plane of the moon texture, the same as
+			* SetMoonPhase followed by SetMoonVisibility but without touching
+			* the geometry.
+			*
+			* @param phase The phase of the moon, see SetMoonPhase.
+			*
+			* @param visibility The visibility of the moon, see
+			*			SetMoonVisibility.
+			*
+			* @param[out] alpha GetMoonTexturePixelCount bytes, one for each
+			*			pixel.
+			*/
+			BIOSKY_API static void CalculateMoonAlpha(float phase, float visibility, unsigned char * alpha);
+
+			/**
+			* Write an alpha plane from CalculateMoonAlpha into the moon
+			* texture. The color of the texture is left as it is, so
+			* SetMoonPhase must have been called once before.
+			*/
+			BIOSKY_API void SetMoonAlpha(const unsigned char * alpha);
+
+			/**
+			* Lock and unlock the geometry and the moon texture of the
+			* skydome. These time the locks when the performance counters are
+			* on, so use them instead of calling the skydome.
+			*/
+			BIOSKY_API void _LockGeometry();
+			BIOSKY_API void _UnlockGeometry();
+			BIOSKY_API void _LockMoonTexture();
+			BIOSKY_API void _UnlockMoonTexture();
 		public:
 			/**
 			* Constructor
@@ -323,6 +390,21 @@ namespace BIO
 			*/
 			BIOSKY_API virtual void SetSunPosition(float SolarAzimuth, float SolarZenith);
 
+			/**
+			* Set the turbidity of the air used for the sky color. It is
+			* clamped to the range the Perez model was fit for, [2, 10]. The
+			* colors change on the next UpdateSkyColor.
+			*
+			* @param turbidity The turbidity. 2 is a very clear sky and 10 a
+			*			hazy one.
+			*/
+			BIOSKY_API virtual void SetTurbidity(float turbidity);
+
+			/**
+			* Get the turbidity of the air.
+			*/
+			float GetTurbidity() const;
+
 			/**
 			* Update the sky simulation according to the currently stored time
 			* and location in this object.
@@ -402,6 +484,19 @@ namespace BIO
 			*/
 			BIOSKY_API virtual void UpdateSunPosition() = 0;
 
+			//New virtual functions go after this line so the vtable of
+			//existing clients does not change.
+
+			/**
+			* Calculate the sky color for the current sun position and set it
+			* on a set of vertecies. UpdateSkyColor calls this with the
+			* vertecies of the sky dome. Call it yourself to color other
+			* geometry, such as the finest level of a SkyDomeLODSet.
+			*
+			* @param verts The vertecies to color.
+			*/
+			BIOSKY_API virtual void CalculateSkyColors(IDomeVertecies * verts);
+
 #if BIOSKY_TESTING == 1
 			BIOSKY_API static bool Tests(XNELO::TESTING::Test * test);
 #endif
@@ -440,11 +535,31 @@ inline void BIO::SKY::Sky::SetStarPosition(float zenith, float rotation)
 	_skydome->SetStarRotation(zenith, rotation, 0);
 }
 
+inline void BIO::SKY::Sky::SetTurbidity(float turbidity)
+{
+	_turbidity = std::max(2.0f, std::min(10.0f, turbidity));
+}
+
+inline float BIO::SKY::Sky::GetTurbidity() const
+{
+	return _turbidity;
+}
+
 inline void BIO::SKY::Sky::SetSunPosition(SkyPosition pos)
 {
 	SetSunPosition(pos.Azimuth, pos.Zenith);
 }
 
+inline BIO::SKY::LightData BIO::SKY::Sky::CalculateSkyLights()
+{
+	return CalculateSkyLightsForSun(_sunPos);
+}
+
+inline void BIO::SKY::Sky::CalculateSkyColors(IDomeVertecies * verts)
+{
+	CalculateSkyColorsForSun(_sunPos, verts, _turbidity);
+}
+
 inline void BIO::SKY::Sky::UpdateSkyLights()
 {
 	LightData data = CalculateSkyLights();
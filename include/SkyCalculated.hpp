@@ -39,6 +39,7 @@
 #include "CompileConfig.h"
 #include "Sky.hpp"
 #include "SkyCalculations.hpp"
+#include "SkyStatePublisher.hpp"
 
 namespace BIO
 {
@@ -50,6 +51,12 @@ namespace BIO
 		*/
 		class SkyCalculated : public Sky, public SkyCalculations
 		{
+		protected:
+			/**
+			* Where the sky is published for other threads. May be NULL.
+			*/
+			SkyStatePublisher * _statePublisher;
+
 		public:
 			/**
 			* Constructor
@@ -137,34 +144,32 @@ namespace BIO
 			* @note This function should NOT be called every frame.
 			*/
 			BIOSKY_API virtual void UpdateSunPosition();
+
+			/**
+			* Set where the sky is published each time all the sky objects are
+			* updated, so other threads can read the sun, moon and lights
+			* without calling into this class. The publisher is not owned by
+			* this class.
+			*
+			* @param publisher The publisher, or NULL to stop publishing.
+			*/
+			void SetStatePublisher(SkyStatePublisher * publisher);
+
+			/**
+			* Get the publisher set with SetStatePublisher.
+			*/
+			SkyStatePublisher * GetStatePublisher();
 		};
 	}//end namespace SKY
 }//end namespace BIO
 
 inline BIO::SKY::SkyCalculated::SkyCalculated(IDomeGeometry * skydome, DateTime * dateTime, GPS * gps) :
-Sky(skydome), SkyCalculations(dateTime, gps)
+Sky(skydome), SkyCalculations(dateTime, gps), _statePublisher(NULL)
 {}
 
 inline BIO::SKY::SkyCalculated::~SkyCalculated()
 {}
 
-inline void BIO::SKY::SkyCalculated::UpdateAllSkyObjects()
-{
-	SkyData skyInfo;
-	skyInfo = CalculateAllSkyData();
-
-	SetMoonPosition(skyInfo.moonPos);
-	SetStarPosition(skyInfo.northStarZenith, skyInfo.starRotation);
-	SetSunPosition(skyInfo.sunPos);
-
-	SetMoonPhase(skyInfo.phase);
-
-	SetMoonVisibility(skyInfo.moonVisibility);
-
-	UpdateSkyColor();
-	UpdateSkyLights();
-}
-
 inline void BIO::SKY::SkyCalculated::UpdateMoonPosition()
 {
 	SetMoonPosition(CalculateMoonPosition());
@@ -185,4 +190,14 @@ inline void BIO::SKY::SkyCalculated::UpdateSunPosition()
 	SetSunPosition(CalculateSunPosition());
 }
 
+inline void BIO::SKY::SkyCalculated::SetStatePublisher(SkyStatePublisher * publisher)
+{
+	_statePublisher = publisher;
+}
+
+inline BIO::SKY::SkyStatePublisher * BIO::SKY::SkyCalculated::GetStatePublisher()
+{
+	return _statePublisher;
+}
+
 #endif //___BIOSKY_SKYCALCULATED_HPP__2015___
\ No newline at end of file
@@ -0,0 +1,255 @@
+/**
+* @file SkyCalculatedAsync.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A calculated sky that does its work on another thread.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#ifndef ___BIOSKY_SKYCALCULATEDASYNC_HPP__2015___
+#define ___BIOSKY_SKYCALCULATEDASYNC_HPP__2015___
+
+#include "CompileConfig.h"
+#include "SkyCalculated.hpp"
+#include "Timestamp.hpp"
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* A piece of work handed to a SkyTaskScheduler.
+		*
+		* @param task The task pointer passed to the scheduler.
+		*/
+		typedef void(*SkyTaskFunction)(void * task);
+
+		/**
+		* A function that runs a task on some other thread, such as the job
+		* system of an engine. It must not run the task on the calling
+		* thread unless it is fine for Update to wait for the work, and it
+		* must make everything written before the call visible to the task
+		* (any queue guarded by a lock or an atomic does).
+		*
+		* The scheduler must run every task it is given, even while the
+		* application is shutting down. The SkyCalculatedAsync destructor
+		* spins until the task it handed out has run, so a task that is
+		* dropped makes the destructor never return.
+		*
+		* @param function The function to run.
+		*
+		* @param task Passed to the function.
+		*
+		* @param userData The pointer given to SkyCalculatedAsync.
+		*/
+		typedef void(*SkyTaskScheduler)(SkyTaskFunction function, void * task, void * userData);
+
+		/**
+		* A dynamic sky that works out the sky on another thread.
+		*
+		* The work of UpdateAllSkyObjects (the positions of the sun and the
+		* moon, the vertex colors, the sky lights and the alpha of the moon
+		* texture) is done by a worker into a back buffer. Update only
+		* applies the last finished buffer to the IDomeGeometry and hands the
+		* current time to the worker, so the render thread never waits for
+		* it. What is shown is the time of the previous Update as long as the
+		* work takes less than a frame. If it takes longer the last result
+		* stays up and no new work is started until the worker is done.
+		*
+		* The worker is a thread owned by this class unless a
+		* SkyTaskScheduler is given. The vertex positions of the dome are
+		* read once, in the constructor.
+		*/
+		class SkyCalculatedAsync : public SkyCalculated
+		{
+		public:
+			/**
+			* Constructor. The sky is worked out once, on this thread, before
+			* it returns.
+			*
+			* @param geometry A pointer to the geometry class that renders the
+			*			skydome.
+			*
+			* @param dateTime A pointer to the DateTime object that keeps track
+			*			of the current time. It is only read by Update.
+			*
+			* @param gps A pointer to the GPS object the keeps track of the
+			*			current GPS location. It is only read by Update.
+			*
+			* @param scheduler Runs the work. If this is NULL a thread is
+			*			started for it.
+			*
+			* @param schedulerData Passed to the scheduler.
+			*/
+			BIOSKY_API SkyCalculatedAsync(IDomeGeometry * geometry, DateTime * dateTime, GPS * gps, SkyTaskScheduler scheduler = NULL, void * schedulerData = NULL);
+
+			/**
+			* Destructor. If the worker is busy this waits for it. With a
+			* SkyTaskScheduler it spins until the last task handed to the
+			* scheduler has run, so destroy the sky before the scheduler
+			* stops running tasks.
+			*/
+			BIOSKY_API virtual ~SkyCalculatedAsync();
+
+			/**
+			* Apply the last finished result, if there is a new one, and start
+			* work on the current time if the worker is free.
+			*/
+			BIOSKY_API virtual void Update();
+
+			/**
+			* Add the time to the DateTime object, then Update.
+			*
+			* @param deltaTime The time passed since the last call to this
+			*			Update function.
+			*/
+			BIOSKY_API virtual void Update(float deltaTime);
+
+			/**
+			* Get the SkyData that was last applied.
+			*/
+			const SkyData & GetSkyData() const;
+
+			/**
+			* Get the time of the SkyData that was last applied.
+			*/
+			Timestamp GetSkyDataTime() const;
+
+			/**
+			* Returns true if the worker has been given the time and has not
+			* finished.
+			*/
+			BIOSKY_API bool IsBusy() const;
+
+			/**
+			* Returns true if there is a finished result the next Update will
+			* apply.
+			*/
+			BIOSKY_API bool HasResult() const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			/**What the worker is given.*/
+			struct _Input
+			{
+				Timestamp time;
+				float latitude;
+				float longitude;
+				EPHEMERIS_MODEL model;
+				float turbidity;
+				/**The result to fill.*/
+				int target;
+			};
+
+			/**Everything the worker works out for one time.*/
+			struct _Result
+			{
+				Timestamp time;
+				SkyData skyData;
+				LightData lights;
+				/**The color of each vertex, ARGB.*/
+				unsigned int * colors;
+				/**The alpha of each pixel of the moon texture.*/
+				unsigned char * moonAlpha;
+			};
+
+			/**The thread and the flags shared with the worker.*/
+			struct _Shared;
+
+			_Shared * _shared;
+			SkyTaskScheduler _scheduler;
+			void * _schedulerData;
+
+			_Input _input;
+			_Result _results[2];
+			/**The result that was last applied. The worker fills the other.*/
+			int _front;
+			/**True from handing the worker a time until its result is applied.*/
+			bool _inFlight;
+
+			/**The positions of the dome's vertecies.*/
+			Vector3D * _positions;
+			int _numVertecies;
+
+			/**The worker's own cache for EPHEMERIS_ACCURATE.*/
+			EphemerisCache * _workerCache;
+
+			SkyCalculatedAsync(const SkyCalculatedAsync & other);
+			SkyCalculatedAsync & operator = (const SkyCalculatedAsync & other);
+
+			/**Fill _input from the DateTime and GPS.*/
+			void _TakeInput(int target);
+
+			/**Start the worker on _input.*/
+			void _Submit();
+
+			/**Do the work for _input. Called on the worker.*/
+			void _Compute();
+
+			/**Set a result on the geometry.*/
+			void _Apply(const _Result & result);
+
+			static void _RunTask(void * task);
+			static void _WorkerLoop(SkyCalculatedAsync * sky);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline void BIO::SKY::SkyCalculatedAsync::Update(float deltaTime)
+{
+	_dateTime->AddTime(deltaTime);
+
+	Update();
+}
+
+inline const BIO::SKY::SkyData & BIO::SKY::SkyCalculatedAsync::GetSkyData() const
+{
+	return _results[_front].skyData;
+}
+
+inline BIO::Timestamp BIO::SKY::SkyCalculatedAsync::GetSkyDataTime() const
+{
+	return _results[_front].time;
+}
+
+#endif //___BIOSKY_SKYCALCULATEDASYNC_HPP__2015___
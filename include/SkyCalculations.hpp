@@ -41,6 +41,7 @@
 #include "GPS.hpp"
 #include "SkyPosition.hpp"
 #include "BIOSkyFunctions.hpp"
+#include "Ephemeris.hpp"
 
 namespace BIO
 {
@@ -60,6 +61,10 @@ namespace BIO
 			bool _userGPS;
 			/**The GPS coordinates on the Earth for the sky calculations.*/
 			GPS * _gps;
+			/**How the sun and moon are found.*/
+			EPHEMERIS_MODEL _ephemerisModel;
+			/**The cache of the accurate model, or NULL.*/
+			EphemerisCache * _ephemerisCache;
 
 			/**
 			* Delete all the pointers in this class
@@ -81,6 +86,11 @@ namespace BIO
 			* @note It actually only deletes if this class created the pointer.
 			*/
 			void _deleteGPS();
+
+			/**
+			* Calculate the sky data with the accurate model.
+			*/
+			SkyData _CalculateAccurateSkyData();
 		private:
 			/**
 			* Copy constructor
@@ -127,6 +137,14 @@ namespace BIO
 			*/
 			BIOSKY_API SkyData CalculateAllSkyData();
 
+			/**
+			* Calculates all the sky data for a Timestamp at the current GPS
+			* coordinates. The DateTime is not used or changed.
+			*
+			* @param time The moment to calculate the sky for.
+			*/
+			BIOSKY_API SkyData CalculateAllSkyData(const Timestamp & time);
+
 			/**
 			* Calculate the position of the moon.
 			*
@@ -146,6 +164,20 @@ namespace BIO
 			*/
 			BIOSKY_API SkyPosition CalculateSunPosition();
 
+			/**
+			* Get how the sun and moon are found.
+			*/
+			BIOSKY_API EPHEMERIS_MODEL GetEphemerisModel();
+
+			/**
+			* Set how the sun and moon are found. The accurate model keeps an
+			* EphemerisCache for this object, so it is fast when the time
+			* moves a little each frame.
+			*
+			* @param model The model to use. EPHEMERIS_SIMPLE by default.
+			*/
+			BIOSKY_API void SetEphemerisModel(EPHEMERIS_MODEL model);
+
 			/**
 			* Get the date and time.
 			*
@@ -201,6 +233,9 @@ namespace BIO
 
 inline BIO::SKY::SkyData BIO::SKY::SkyCalculations::CalculateAllSkyData()
 {
+	if (_ephemerisModel == EPHEMERIS_ACCURATE)
+		return _CalculateAccurateSkyData();
+
 	return BIO::SKY::CalculateSkyData(
 		_dateTime->GetTimeHours(),
 		_dateTime->GetUTCOffset(),
@@ -214,6 +249,9 @@ inline BIO::SKY::SkyData BIO::SKY::SkyCalculations::CalculateAllSkyData()
 
 inline BIO::SKY::SkyPosition BIO::SKY::SkyCalculations::CalculateMoonPosition()
 {
+	if (_ephemerisModel == EPHEMERIS_ACCURATE)
+		return _CalculateAccurateSkyData().moonPos;
+
 	return BIO::SKY::CalculateMoonPosition(
 		_dateTime->GetTimeHours(),	//Time in hours
 		_dateTime->GetUTCOffset(),  //Offset from UTC-0 time
@@ -237,6 +275,9 @@ inline float BIO::SKY::SkyCalculations::CalculateStarRotation()
 
 inline BIO::SKY::SkyPosition BIO::SKY::SkyCalculations::CalculateSunPosition()
 {
+	if (_ephemerisModel == EPHEMERIS_ACCURATE)
+		return _CalculateAccurateSkyData().sunPos;
+
 	return BIO::SKY::CalculateSunPosition(
 		_dateTime->GetTimeHours(),	//Time in hours
 		_dateTime->GetUTCOffset(),  //Offset from UTC-0 time
@@ -248,6 +289,11 @@ inline BIO::SKY::SkyPosition BIO::SKY::SkyCalculations::CalculateSunPosition()
 		);
 }
 
+inline BIO::SKY::EPHEMERIS_MODEL BIO::SKY::SkyCalculations::GetEphemerisModel()
+{
+	return _ephemerisModel;
+}
+
 inline BIO::DateTime * BIO::SKY::SkyCalculations::GetDateTime()
 {
 	return _dateTime;
@@ -262,6 +308,7 @@ inline void BIO::SKY::SkyCalculations::SetDateTime(DateTime * dateTime)
 {
 	_deleteDateTime();
 	_dateTime = dateTime;
+	_userDateTime = true;
 }
 
 inline void BIO::SKY::SkyCalculations::SetDateTime(DateTime dateTime)
@@ -273,6 +320,7 @@ inline void BIO::SKY::SkyCalculations::SetGPS(GPS * gps)
 {
 	_deleteGPS();
 	_gps = gps;
+	_userGPS = true;
 }
 
 inline void BIO::SKY::SkyCalculations::SetGPS(GPS gps)
@@ -284,7 +332,7 @@ inline void BIO::SKY::SkyCalculations::SetGPS(GPS gps)
 //				Private Functions
 ///////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////
-inline BIO::SKY::SkyCalculations::SkyCalculations(const SkyCalculations & other) : _userDateTime(false), _dateTime(NULL), _userGPS(false), _gps(NULL)
+inline BIO::SKY::SkyCalculations::SkyCalculations(const SkyCalculations & other) : _userDateTime(false), _dateTime(NULL), _userGPS(false), _gps(NULL), _ephemerisModel(EPHEMERIS_SIMPLE), _ephemerisCache(NULL)
 {
 }
 
@@ -0,0 +1,267 @@
+/**
+* @file SkyCommandQueue.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A queue for changing a sky from other threads.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#ifndef ___BIOSKY_SKYCOMMANDQUEUE_HPP__2015___
+#define ___BIOSKY_SKYCOMMANDQUEUE_HPP__2015___
+
+#include "CompileConfig.h"
+#include "ISky.hpp"
+#include "SkyCalculations.hpp"
+#include "DateTime.hpp"
+#include "GPS.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The changes that can be made through a SkyCommandQueue. The values
+		* are also the order they are applied in by SkyCommandQueue::Drain.
+		*/
+		enum SKY_COMMAND
+		{
+			/**SkyCalculations::SetDateTime with dateTime.*/
+			SKY_COMMAND_DATE_TIME = 0,
+			/**SkyCalculations::SetGPS with gps.*/
+			SKY_COMMAND_GPS,
+			/**ISky::SetTurbidity with value.*/
+			SKY_COMMAND_TURBIDITY,
+			/**ISky::SetSunPosition with position.*/
+			SKY_COMMAND_SUN_POSITION,
+			/**ISky::SetMoonPosition with position.*/
+			SKY_COMMAND_MOON_POSITION,
+			/**ISky::SetStarPosition with value (the zenith) and rotation.*/
+			SKY_COMMAND_STAR_POSITION,
+			/**ISky::SetMoonPhase with value.*/
+			SKY_COMMAND_MOON_PHASE,
+			/**ISky::SetMoonVisibility with value.*/
+			SKY_COMMAND_MOON_VISIBILITY
+		};
+
+		/**
+		* The number of SKY_COMMANDs.
+		*/
+		const int NumSkyCommands = 8;
+
+		/**
+		* One change to a sky. Only the members used by the type are read.
+		*/
+		struct SkyCommand
+		{
+			SKY_COMMAND type;
+			SkyPosition position;
+			float value;
+			float rotation;
+			DateTime dateTime;
+			GPS gps;
+
+			/**
+			* Constructor
+			*/
+			SkyCommand();
+		};
+
+		/**
+		* A bounded queue of SkyCommands with many producers and one
+		* consumer.
+		*
+		* Any thread may push; a push never blocks or allocates and fails if
+		* the queue is full. The thread that owns the sky calls Drain once an
+		* update, which applies only the last command of each type, so a
+		* tool dragging the sun around costs one SetSunPosition a frame no
+		* matter how many it sent. Neither side takes a lock.
+		*
+		* This is Dmitry Vyukov's bounded queue: each cell has a sequence
+		* number that says whether it is free for the producer of a given
+		* position or full for the consumer, and producers claim positions
+		* with a compare and swap.
+		*/
+		class SkyCommandQueue
+		{
+		public:
+			/**The capacity used by the default constructor.*/
+			enum { DefaultCapacity = 256 };
+
+			/**
+			* Constructor
+			*
+			* @param capacity The most commands that can wait. It is rounded
+			*			up to a power of 2.
+			*/
+			BIOSKY_API SkyCommandQueue(int capacity = DefaultCapacity);
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API ~SkyCommandQueue();
+
+			/**
+			* Add a command. Safe from any thread.
+			*
+			* @return Returns false if the queue is full. The command is
+			*			dropped and counted in GetDroppedCount.
+			*/
+			BIOSKY_API bool Push(const SkyCommand & command);
+
+			/**
+			* Push a SKY_COMMAND_SUN_POSITION. Safe from any thread.
+			*/
+			BIOSKY_API bool PushSunPosition(SkyPosition position);
+
+			/**
+			* Push a SKY_COMMAND_MOON_POSITION. Safe from any thread.
+			*/
+			BIOSKY_API bool PushMoonPosition(SkyPosition position);
+
+			/**
+			* Push a SKY_COMMAND_STAR_POSITION. Safe from any thread.
+			*/
+			BIOSKY_API bool PushStarPosition(float zenith, float rotation);
+
+			/**
+			* Push a SKY_COMMAND_MOON_PHASE. Safe from any thread.
+			*/
+			BIOSKY_API bool PushMoonPhase(float phase);
+
+			/**
+			* Push a SKY_COMMAND_MOON_VISIBILITY. Safe from any thread.
+			*/
+			BIOSKY_API bool PushMoonVisibility(float visibility);
+
+			/**
+			* Push a SKY_COMMAND_TURBIDITY. Safe from any thread.
+			*/
+			BIOSKY_API bool PushTurbidity(float turbidity);
+
+			/**
+			* Push a SKY_COMMAND_DATE_TIME. Safe from any thread.
+			*/
+			BIOSKY_API bool PushDateTime(const DateTime & dateTime);
+
+			/**
+			* Push a SKY_COMMAND_GPS. Safe from any thread.
+			*/
+			BIOSKY_API bool PushGPS(const GPS & gps);
+
+			/**
+			* Take the oldest command. Only the consumer may call this.
+			*
+			* @param[out] command The command.
+			*
+			* @return Returns false if command is NULL or the queue is empty.
+			*/
+			BIOSKY_API bool Pop(SkyCommand * command);
+
+			/**
+			* Take the commands waiting and apply the last one of each type,
+			* in the order of SKY_COMMAND. Only the consumer may call this. At
+			* most the capacity of the queue is taken, so producers that keep
+			* pushing can not keep it from returning.
+			*
+			* @param sky The sky to change.
+			*
+			* @param calculations Where the date, time and location are set.
+			*			If this is NULL those commands are dropped.
+			*
+			* @return Returns the number of commands taken.
+			*/
+			BIOSKY_API int Drain(ISky * sky, SkyCalculations * calculations = NULL);
+
+			/**
+			* Get the most commands that can wait.
+			*/
+			int GetCapacity() const;
+
+			/**
+			* Get the number of commands dropped because the queue was full.
+			*/
+			unsigned int GetDroppedCount() const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			struct _Cell
+			{
+				/**
+				* Equal to the position when the cell is free for the producer
+				* of that position, and one more when it holds its command.
+				*/
+				std::atomic<std::size_t> sequence;
+				SkyCommand command;
+			};
+
+			_Cell * _cells;
+			std::size_t _mask;
+			/**The next position to push to.*/
+			std::atomic<std::size_t> _enqueuePosition;
+			/**The next position to pop from. Only the consumer uses it.*/
+			std::size_t _dequeuePosition;
+			std::atomic<unsigned int> _dropped;
+
+			SkyCommandQueue(const SkyCommandQueue & other);
+			SkyCommandQueue & operator = (const SkyCommandQueue & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline BIO::SKY::SkyCommand::SkyCommand() : type(SKY_COMMAND_DATE_TIME), position(), value(0.0f), rotation(0.0f), dateTime(), gps()
+{}
+
+inline int BIO::SKY::SkyCommandQueue::GetCapacity() const
+{
+	return (int)(_mask + 1);
+}
+
+inline unsigned int BIO::SKY::SkyCommandQueue::GetDroppedCount() const
+{
+	return _dropped.load(std::memory_order_relaxed);
+}
+
+#endif //___BIOSKY_SKYCOMMANDQUEUE_HPP__2015___
@@ -0,0 +1,278 @@
+/**
+* @file SkyDome.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Sky dome geometry with a fixed resolution that is generated into static
+* data instead of being allocated.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_SKYDOME_HPP__2015___
+#define ___BIOSKY_SKYDOME_HPP__2015___
+
+#include "CompileConfig.h"
+#include "Vector3D.hpp"
+#include "Vector2D.hpp"
+
+#include <type_traits>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The same dome as CreateSkyDomeGeometry (same vertecies, UV
+		* coordinates, indecies and winding) with the resolution chosen at
+		* compile time. The data is held in fixed size arrays in the object,
+		* so nothing is allocated. The dome has a radius of 1; scale the
+		* vertecies by your radius when you use them (CopyTo does this).
+		*
+		* Declare the dome as static data:
+		*
+		*		static BIOSKY_CONSTEXPR const BIO::SKY::SkyDome<32, 16, false> dome;
+		*
+		* When the compiler supports C++14 constexpr (BIOSKY_HAS_CONSTEXPR)
+		* the arrays are built by the compiler and placed in read only data.
+		* Otherwise (Visual Studio 2013) the same code builds them once when
+		* the static data is initialized.
+		*
+		* @tparam numVerticalSegments The number of segments around the
+		*			dome. Must be at least 3.
+		*
+		* @tparam numHorozontalSegments The number of segments from the top
+		*			of the dome to the bottom. Must be even.
+		*
+		* @tparam fullDome Whether this is a full sphere or a hemisphere.
+		*/
+		template <int numVerticalSegments, int numHorozontalSegments, bool fullDome>
+		class SkyDome
+		{
+			static_assert(numVerticalSegments >= 3, "A sky dome needs at least 3 vertical segments.");
+			static_assert(numHorozontalSegments >= 2 && numHorozontalSegments % 2 == 0, "A sky dome needs an even number of horozontal segments.");
+
+		public:
+			enum
+			{
+				/**The number of rings of vertecies, not counting the poles.*/
+				NumRings = (fullDome) ? numHorozontalSegments - 1 : numHorozontalSegments,
+				/**The number of vertecies.*/
+				NumVertecies = NumRings * numVerticalSegments + ((fullDome) ? 2 : 1),
+				/**The number of indecies in the triangle list.*/
+				NumIndecies = ((2 * numHorozontalSegments) - ((fullDome) ? 2 : 1)) * numVerticalSegments * 3
+			};
+
+			/**16 bit indecies when the vertecies fit, otherwise 32 bit.*/
+			typedef typename std::conditional<(NumVertecies > 65535), unsigned int, unsigned short>::type IndexType;
+
+			/**The X, Y and Z of each vertex on a dome of radius 1.*/
+			float vertecies[NumVertecies][3];
+			/**The U and V texture coordinates of each vertex.*/
+			float UVTextureCoordinates[NumVertecies][2];
+			/**The triangle list.*/
+			IndexType indecies[NumIndecies];
+
+			/**
+			* Constructor. Builds the dome.
+			*/
+			BIOSKY_CONSTEXPR SkyDome();
+
+			/**
+			* Copy the dome into buffers, scaling it to a radius.
+			*
+			* @param radius The radius of the dome.
+			*
+			* @param[out] vertecies The buffer for the vertecies.
+			*
+			* @param[out] UVTextureCoordinates The buffer for the UV
+			*			coordinates.
+			*
+			* @param numVertecies The number of elements in the vertecies and
+			*			UVTextureCoordinates buffers.
+			*
+			* @param[out] indecies The buffer for the indecies.
+			*
+			* @param numIndecies The number of elements in indecies.
+			*
+			* @return Returns false if a buffer is NULL or too small.
+			*/
+			bool CopyTo(float radius, Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, IndexType * indecies, int numIndecies) const;
+
+		private:
+			/**
+			* Sine by its Taylor series so it can run at compile time.
+			*/
+			static BIOSKY_CONSTEXPR double _Sin(double x);
+
+			static BIOSKY_CONSTEXPR double _Pi();
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+template <int numVerticalSegments, int numHorozontalSegments, bool fullDome>
+inline BIOSKY_CONSTEXPR double BIO::SKY::SkyDome<numVerticalSegments, numHorozontalSegments, fullDome>::_Pi()
+{
+	return 3.1415926535897932384626433832795;
+}
+
+template <int numVerticalSegments, int numHorozontalSegments, bool fullDome>
+inline BIOSKY_CONSTEXPR double BIO::SKY::SkyDome<numVerticalSegments, numHorozontalSegments, fullDome>::_Sin(double x)
+{
+	//bring x into [-PI, PI]
+	while (x > _Pi())
+		x -= 2.0 * _Pi();
+
+	while (x < -_Pi())
+		x += 2.0 * _Pi();
+
+	double term = x;
+	double sum = x;
+
+	for (int n = 1; n < 14; n++)
+	{
+		term *= -(x * x) / ((2.0 * n) * (2.0 * n + 1.0));
+		sum += term;
+	}
+
+	return sum;
+}
+
+template <int numVerticalSegments, int numHorozontalSegments, bool fullDome>
+inline BIOSKY_CONSTEXPR BIO::SKY::SkyDome<numVerticalSegments, numHorozontalSegments, fullDome>::SkyDome() :
+	vertecies(),
+	UVTextureCoordinates(),
+	indecies()
+{
+	//first vert is at 0,1,0
+	vertecies[0][1] = 1.0f;
+	UVTextureCoordinates[0][0] = UVTextureCoordinates[0][1] = 0.5f;
+
+	double angleStep = ((fullDome) ? _Pi() : _Pi() / 2.0) / numHorozontalSegments;
+	double circleStep = 2.0 * _Pi() / numVerticalSegments;
+	int equator = (fullDome) ? (numHorozontalSegments / 2) - 1 : numHorozontalSegments - 1;
+
+	int vertOn = 1;
+
+	for (int i = 0; i < NumRings; i++)
+	{
+		double ringAngle = (_Pi() / 2.0) - (angleStep * (i + 1));
+		double height = (i == equator) ? 0.0 : _Sin(ringAngle);
+		double ringRadius = (i == equator) ? 1.0 : _Sin(ringAngle + _Pi() / 2.0);
+
+		//the UV is a projection from the bottom of the sphere
+		double uvScale = 1.0 / (2.0 * (1.0 + height));
+
+		for (int j = 0; j < numVerticalSegments; j++)
+		{
+			double x = ringRadius * _Sin(circleStep * j + _Pi() / 2.0);
+			double z = ringRadius * _Sin(circleStep * j);
+
+			vertecies[vertOn][0] = (float)x;
+			vertecies[vertOn][1] = (float)height;
+			vertecies[vertOn][2] = (float)z;
+
+			UVTextureCoordinates[vertOn][0] = (float)(x * uvScale + 0.5);
+			UVTextureCoordinates[vertOn][1] = (float)(z * uvScale + 0.5);
+
+			vertOn++;
+		}
+	}
+
+	if (fullDome)
+	{
+		vertecies[vertOn][1] = -1.0f;
+		UVTextureCoordinates[vertOn][0] = UVTextureCoordinates[vertOn][1] = 0.5f;
+	}
+
+	//triangles, one latitude band at a time
+	int bottom = NumRings * numVerticalSegments + 1;
+	int indexOn = 0;
+
+	for (int band = 0; band < numHorozontalSegments; band++)
+	{
+		int top = (band - 1) * numVerticalSegments + 1;
+		int below = band * numVerticalSegments + 1;
+
+		for (int j = 0; j < numVerticalSegments; j++)
+		{
+			int next = (j + 1) % numVerticalSegments;
+
+			if (band == 0)
+			{
+				indecies[indexOn++] = (IndexType)0;
+				indecies[indexOn++] = (IndexType)(below + j);
+				indecies[indexOn++] = (IndexType)(below + next);
+			}
+			else if (fullDome && band == numHorozontalSegments - 1)
+			{
+				//same order as CreateSkyDomeGeometry
+				int i = j + 1;
+
+				indecies[indexOn++] = (IndexType)bottom;
+				indecies[indexOn++] = (IndexType)(top + (numVerticalSegments - i));
+				indecies[indexOn++] = (IndexType)(top + ((2 * numVerticalSegments - i - 1) % numVerticalSegments));
+			}
+			else
+			{
+				indecies[indexOn++] = (IndexType)(top + j);
+				indecies[indexOn++] = (IndexType)(below + j);
+				indecies[indexOn++] = (IndexType)(below + next);
+
+				indecies[indexOn++] = (IndexType)(top + j);
+				indecies[indexOn++] = (IndexType)(below + next);
+				indecies[indexOn++] = (IndexType)(top + next);
+			}
+		}
+	}
+}
+
+template <int numVerticalSegments, int numHorozontalSegments, bool fullDome>
+inline bool BIO::SKY::SkyDome<numVerticalSegments, numHorozontalSegments, fullDome>::CopyTo(float radius, Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, IndexType * indecies, int numIndecies) const
+{
+	if (vertecies == NULL || UVTextureCoordinates == NULL || indecies == NULL ||
+		numVertecies < NumVertecies || numIndecies < NumIndecies)
+		return false;
+
+	for (int i = 0; i < NumVertecies; i++)
+	{
+		vertecies[i].X = this->vertecies[i][0] * radius;
+		vertecies[i].Y = this->vertecies[i][1] * radius;
+		vertecies[i].Z = this->vertecies[i][2] * radius;
+
+		UVTextureCoordinates[i].X = this->UVTextureCoordinates[i][0];
+		UVTextureCoordinates[i].Y = this->UVTextureCoordinates[i][1];
+	}
+
+	for (int i = 0; i < NumIndecies; i++)
+		indecies[i] = this->indecies[i];
+
+	return true;
+}
+
+#endif //___BIOSKY_SKYDOME_HPP__2015___
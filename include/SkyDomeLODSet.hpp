@@ -0,0 +1,258 @@
+/**
+* @file SkyDomeLODSet.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Several nested resolutions of the sky dome that share one set of vertex
+* colors.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_SKYDOMELODSET_HPP__2015___
+#define ___BIOSKY_SKYDOMELODSET_HPP__2015___
+
+#include "CompileConfig.h"
+#include "IDomeVertecies.hpp"
+#include "RawGeometry.hpp"
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The default largest size, in pixels, of one horozontal band of the
+		* dome on the screen. The sky color is interpolated across each
+		* triangle, so bands much bigger than this smear the gradient near
+		* the horizon.
+		*/
+		const float DefaultLODPixelsPerBand = 24.0f;
+
+		/**
+		* A set of latitude/longitude sky domes (the same as
+		* CreateSkyDomeGeometry) where each level has half the vertical and
+		* horozontal segments of the level before it. Level 0 is the finest.
+		*
+		* The levels are nested: every vertex of a coarse level is also a
+		* vertex of level 0. The sky color is only calculated for level 0
+		* (see GetFinestVertecies and Sky::CalculateSkyColors) and the
+		* coarser levels take their colors from the matching level 0
+		* vertecies with CopyColors.
+		*/
+		class SkyDomeLODSet
+		{
+		public:
+			/**
+			* Constructor. Builds every level.
+			*
+			* @param radius The radius of the domes.
+			*
+			* @param numVerticalSegments The vertical segments of level 0.
+			*			This is rounded up so every level has a whole
+			*			number of segments.
+			*
+			* @param numHorozontalSegments The horozontal segments of level
+			*			0. This is rounded up so every level has an even
+			*			number of segments.
+			*
+			* @param fullDome Whether the domes are full spheres or
+			*			hemispheres.
+			*
+			* @param numLevels The number of levels. This is reduced if the
+			*			coarsest level would have fewer than 4 vertical
+			*			segments.
+			*/
+			BIOSKY_API SkyDomeLODSet(float radius = 1.0f, int numVerticalSegments = 64, int numHorozontalSegments = 32, bool fullDome = false, int numLevels = 4);
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API ~SkyDomeLODSet();
+
+			/**
+			* Get the number of levels.
+			*/
+			BIOSKY_API int GetLevelCount() const;
+
+			/**
+			* Get the geometry of a level. Values out of range are clamped.
+			* The geometry belongs to this class.
+			*/
+			BIOSKY_API const RawGeometry * GetLevelGeometry(int level) const;
+
+			/**
+			* Get the vertical segments of a level.
+			*/
+			BIOSKY_API int GetVerticalSegments(int level) const;
+
+			/**
+			* Get the horozontal segments of a level.
+			*/
+			BIOSKY_API int GetHorozontalSegments(int level) const;
+
+			/**
+			* Get the level 0 vertex that each vertex of a level sits on.
+			* There is one value for each vertex of the level.
+			*/
+			BIOSKY_API const int * GetLevelVertexMap(int level) const;
+
+			/**
+			* Get the vertecies of level 0 as IDomeVertecies. Colors set on
+			* it are stored in this class, so the sky color can be
+			* calculated once with Sky::CalculateSkyColors.
+			*/
+			BIOSKY_API IDomeVertecies * GetFinestVertecies();
+
+			/**
+			* Get the color of a vertex of a level as 0xAARRGGBB.
+			*/
+			BIOSKY_API unsigned int GetColor(int level, int index) const;
+
+			/**
+			* Copy the colors of a level onto a set of vertecies. Nothing is
+			* calculated; each vertex takes the color of the level 0 vertex
+			* it sits on.
+			*
+			* @param level The level to copy.
+			*
+			* @param target The vertecies of the level. Only the first
+			*			GetLevelGeometry(level)->numVertecies are set.
+			*/
+			BIOSKY_API void CopyColors(int level, IDomeVertecies * target) const;
+
+			/**
+			* Pick a level for a view. This is the coarsest level whose
+			* horozontal bands are no taller than maxPixelsPerBand pixels on
+			* the screen.
+			*
+			* @param viewportHeight The height of the view in pixels.
+			*
+			* @param fieldOfView The vertical field of view in radians.
+			*
+			* @param maxPixelsPerBand The tallest a band can be on the
+			*			screen.
+			*
+			* @return Returns the level to draw. If no level is fine enough
+			*			level 0 is returned.
+			*/
+			BIOSKY_API int SelectLOD(int viewportHeight, float fieldOfView, float maxPixelsPerBand = DefaultLODPixelsPerBand) const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			/**
+			* Stores the colors set on level 0.
+			*/
+			class _FinestVertecies : public IDomeVertecies
+			{
+			public:
+				SkyDomeLODSet * owner;
+
+				virtual int GetVertexCount();
+				virtual Vector3D GetVertexPosition(int index);
+				virtual void SetVertexColor(int index, int A, int R, int G, int B);
+			};
+
+			bool _fullDome;
+			int _numLevels;
+			int _numVerticalSegments;
+			int _numHorozontalSegments;
+			/**The geometry of each level.*/
+			RawGeometry ** _levels;
+			/**The level 0 vertex of each vertex of each level.*/
+			int ** _vertexMaps;
+			/**The color of each level 0 vertex.*/
+			unsigned int * _colors;
+			_FinestVertecies _finest;
+
+			int _ClampLevel(int level) const;
+
+			SkyDomeLODSet(const SkyDomeLODSet & other);
+			SkyDomeLODSet & operator = (const SkyDomeLODSet & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline int BIO::SKY::SkyDomeLODSet::GetLevelCount() const
+{
+	return _numLevels;
+}
+
+inline int BIO::SKY::SkyDomeLODSet::_ClampLevel(int level) const
+{
+	if (level < 0)
+		return 0;
+
+	if (level >= _numLevels)
+		return _numLevels - 1;
+
+	return level;
+}
+
+inline const BIO::SKY::RawGeometry * BIO::SKY::SkyDomeLODSet::GetLevelGeometry(int level) const
+{
+	return _levels[_ClampLevel(level)];
+}
+
+inline int BIO::SKY::SkyDomeLODSet::GetVerticalSegments(int level) const
+{
+	return _numVerticalSegments >> _ClampLevel(level);
+}
+
+inline int BIO::SKY::SkyDomeLODSet::GetHorozontalSegments(int level) const
+{
+	return _numHorozontalSegments >> _ClampLevel(level);
+}
+
+inline const int * BIO::SKY::SkyDomeLODSet::GetLevelVertexMap(int level) const
+{
+	return _vertexMaps[_ClampLevel(level)];
+}
+
+inline BIO::SKY::IDomeVertecies * BIO::SKY::SkyDomeLODSet::GetFinestVertecies()
+{
+	return &_finest;
+}
+
+inline unsigned int BIO::SKY::SkyDomeLODSet::GetColor(int level, int index) const
+{
+	return _colors[_vertexMaps[_ClampLevel(level)][index]];
+}
+
+#endif //___BIOSKY_SKYDOMELODSET_HPP__2015___
@@ -0,0 +1,274 @@
+/**
+* @file SkyEvents.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Finding when the sun and the moon rise, set and cross the meridian, and
+* the phases of the moon and the seasons.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#ifndef ___BIOSKY_SKYEVENTS_HPP__2015___
+#define ___BIOSKY_SKYEVENTS_HPP__2015___
+
+#include "CompileConfig.h"
+#include "Date.hpp"
+#include "DateTime.hpp"
+#include "GPS.hpp"
+#include "Timestamp.hpp"
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The events found by CalculateDailyEvents. The values are the
+		* indecies into the arrays of DailyEvents.
+		*/
+		enum SKY_EVENT
+		{
+			/**The sun rises to 18 degrees below the horizon.*/
+			SKY_EVENT_ASTRONOMICAL_DAWN = 0,
+			/**The sun rises to 12 degrees below the horizon.*/
+			SKY_EVENT_NAUTICAL_DAWN,
+			/**The sun rises to 6 degrees below the horizon.*/
+			SKY_EVENT_CIVIL_DAWN,
+			/**The top of the sun appears, with refraction.*/
+			SKY_EVENT_SUNRISE,
+			/**The sun crosses the meridian at its highest.*/
+			SKY_EVENT_SOLAR_NOON,
+			/**The top of the sun disappears, with refraction.*/
+			SKY_EVENT_SUNSET,
+			/**The sun sets to 6 degrees below the horizon.*/
+			SKY_EVENT_CIVIL_DUSK,
+			/**The sun sets to 12 degrees below the horizon.*/
+			SKY_EVENT_NAUTICAL_DUSK,
+			/**The sun sets to 18 degrees below the horizon.*/
+			SKY_EVENT_ASTRONOMICAL_DUSK,
+			/**The top of the moon appears.*/
+			SKY_EVENT_MOONRISE,
+			/**The moon crosses the meridian at its highest.*/
+			SKY_EVENT_LUNAR_TRANSIT,
+			/**The top of the moon disappears.*/
+			SKY_EVENT_MOONSET
+		};
+
+		/**
+		* The number of SKY_EVENTs.
+		*/
+		const int NumSkyEvents = 12;
+
+		/**
+		* The sun and moon events of one day.
+		*/
+		struct DailyEvents
+		{
+			/**
+			* True if the event happens on this day. Near the poles the sun
+			* may not rise or set, and about one day a month the moon does
+			* not rise, set or cross the meridian.
+			*/
+			bool occurs[NumSkyEvents];
+
+			/**
+			* The standard time of the event in 24 hr decimal format, the
+			* same as the standardTime parameter of the sky functions. Only
+			* set if the event occurs.
+			*/
+			float hours[NumSkyEvents];
+
+			/**
+			* The moment of the event. Only set if the event occurs.
+			*/
+			Timestamp times[NumSkyEvents];
+		};
+
+		/**
+		* A function whose zero crossing is looked for by FindCrossing.
+		*
+		* @param t The time, in whatever unit the caller uses.
+		*
+		* @param userData The pointer passed to FindCrossing.
+		*/
+		typedef double(*CrossingFunction)(double t, void * userData);
+
+		/**
+		* Find where a function crosses zero between two times with Brent's
+		* method. It mixes bisection with secant and inverse quadratic
+		* steps, so it never does worse than bisection and on smooth
+		* functions like an altitude it usually takes only a few steps.
+		*
+		* @param function The function.
+		*
+		* @param userData Passed to the function.
+		*
+		* @param a The start of the interval.
+		*
+		* @param b The end of the interval.
+		*
+		* @param tolerance How close to the crossing the result must be.
+		*
+		* @param[out] root The crossing.
+		*
+		* @return Returns false if the function has the same sign at a and
+		*			b, or function or root is NULL.
+		*/
+		BIOSKY_API bool FindCrossing(CrossingFunction function, void * userData, double a, double b, double tolerance, double * root);
+
+		/**
+		* Find the sun and moon events of one or more days.
+		*
+		* The sun and the moon are sampled every hour, which brackets every
+		* crossing that is more than an hour from the next, and each
+		* bracket is refined with FindCrossing to a fraction of a second.
+		* This uses the same positions as CalculateSunPosition and
+		* CalculateMoonPosition. Sunrise and sunset are when the sun is
+		* 0.833 degrees below the horizon, for refraction and the size of
+		* the sun, and moonrise and moonset when the center of the moon is
+		* 0.125 degrees above it, for the parallax of the moon as well.
+		*
+		* @param UTCoffset The number of hours offset from UTC-0 time.
+		*
+		* @param month The month of the first day.
+		*
+		* @param day The day of the month of the first day.
+		*
+		* @param year The year of the first day.
+		*
+		* @param latitude The latitude of the location in radians.
+		*
+		* @param longitude The longitude of the location in radians, east
+		*			positive.
+		*
+		* @param[out] events An array of numDays DailyEvents, one for each
+		*			day starting at the first.
+		*
+		* @param numDays The number of days to find.
+		*
+		* @return Returns false if events is NULL or numDays is less than 1.
+		*/
+		BIOSKY_API bool CalculateDailyEvents(float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude, DailyEvents * events, int numDays = 1);
+
+		/**
+		* Find the sun and moon events of one or more days, starting with
+		* the date of a DateTime (the time of day is not used) at a GPS
+		* location.
+		*/
+		BIOSKY_API bool CalculateDailyEvents(DateTime & dateTime, GPS & gps, DailyEvents * events, int numDays = 1);
+
+		/**
+		* The phases of the moon and the seasons found by
+		* CalculateCalendarEvents.
+		*/
+		enum CALENDAR_EVENT
+		{
+			/**The moon and the sun have the same ecliptic longitude.*/
+			CALENDAR_EVENT_NEW_MOON = 0,
+			/**The moon is 90 degrees east of the sun.*/
+			CALENDAR_EVENT_FIRST_QUARTER,
+			/**The moon is opposite the sun.*/
+			CALENDAR_EVENT_FULL_MOON,
+			/**The moon is 90 degrees west of the sun.*/
+			CALENDAR_EVENT_LAST_QUARTER,
+			/**The sun reaches ecliptic longitude 0.*/
+			CALENDAR_EVENT_MARCH_EQUINOX,
+			/**The sun reaches ecliptic longitude 90 degrees.*/
+			CALENDAR_EVENT_JUNE_SOLSTICE,
+			/**The sun reaches ecliptic longitude 180 degrees.*/
+			CALENDAR_EVENT_SEPTEMBER_EQUINOX,
+			/**The sun reaches ecliptic longitude 270 degrees.*/
+			CALENDAR_EVENT_DECEMBER_SOLSTICE
+		};
+
+		/**
+		* The most CalendarEvents there can be in one year: 13 of each
+		* phase of the moon and the 4 seasons.
+		*/
+		const int MaxCalendarEventsPerYear = 4 * 13 + 4;
+
+		/**
+		* A phase of the moon or the start of a season.
+		*/
+		struct CalendarEvent
+		{
+			/**What happens.*/
+			CALENDAR_EVENT type;
+			/**When it happens.*/
+			Timestamp time;
+		};
+
+		/**
+		* Find the phases of the moon and the equinoxes and solstices of one
+		* or more years.
+		*
+		* Each instant is found with FindCrossing on the apparent longitude
+		* of the sun, or the longitude of the moon less the sun's, from
+		* CalculateSunEcliptic and CalculateMoonEcliptic. A guess is made
+		* from the mean motion and refined to about a second, so a year
+		* takes a few hundred sums of the series instead of sampling the
+		* whole year. The times are good to about a minute.
+		*
+		* @param firstYear The first year. The years are in Universal Time,
+		*			from January 1 0:00 UT.
+		*
+		* @param numYears The number of years.
+		*
+		* @param[out] events An array of at least maxEvents CalendarEvents.
+		*			It is filled in time order.
+		*
+		* @param maxEvents The size of events. numYears *
+		*			MaxCalendarEventsPerYear is always enough.
+		*
+		* @param[out] numEvents The number of events filled.
+		*
+		* @return Returns false if events or numEvents is NULL, numYears is
+		*			less than 1 or there was not room for all the events.
+		*/
+		BIOSKY_API bool CalculateCalendarEvents(unsigned int firstYear, int numYears, CalendarEvent * events, int maxEvents, int * numEvents);
+
+#if BIOSKY_TESTING == 1
+		/**
+		* Test the event solver.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		bool SkyEventTests(XNELO::TESTING::Test * test);
+
+		/**
+		* Test the calendar events.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		bool CalendarEventTests(XNELO::TESTING::Test * test);
+#endif
+	}//end namespace SKY
+}//end namespace BIO
+
+#endif //___BIOSKY_SKYEVENTS_HPP__2015___
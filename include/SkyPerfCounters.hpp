@@ -0,0 +1,214 @@
+/**
+* @file SkyPerfCounters.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Counters for where the time of a sky update goes.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#ifndef ___BIOSKY_SKYPERFCOUNTERS_HPP__2015___
+#define ___BIOSKY_SKYPERFCOUNTERS_HPP__2015___
+
+#include "CompileConfig.h"
+#include "SkyTrace.hpp"
+
+#include <chrono>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The stages of a sky update that are timed.
+		*/
+		enum SKY_PERF_STAGE
+		{
+			/**Working out the SkyData (CalculateAllSkyData).*/
+			SKY_PERF_EPHEMERIS = 0,
+			/**Sky::SetMoonPhase, or the moon alpha of SkyCalculatedAsync.*/
+			SKY_PERF_MOON_PHASE,
+			/**Sky::SetMoonVisibility.*/
+			SKY_PERF_MOON_VISIBILITY,
+			/**The vertex colors of the dome.*/
+			SKY_PERF_SKY_COLOR,
+			/**Sky::CalculateSkyLights.*/
+			SKY_PERF_SKY_LIGHTS,
+			/**IDomeGeometry::LockMoonTexture.*/
+			SKY_PERF_TEXTURE_LOCK,
+			/**IDomeGeometry::UnlockMoonTexture.*/
+			SKY_PERF_TEXTURE_UNLOCK,
+			/**IDomeGeometry::LockGeometry.*/
+			SKY_PERF_GEOMETRY_LOCK,
+			/**IDomeGeometry::UnlockGeometry.*/
+			SKY_PERF_GEOMETRY_UNLOCK
+		};
+
+		/**
+		* The number of SKY_PERF_STAGEs.
+		*/
+		const int NumSkyPerfStages = 9;
+
+		/**
+		* The number of histogram buckets. Bucket i counts the calls that
+		* took [2^i, 2^(i+1)) nanoseconds, with 0 in bucket 0 and anything
+		* longer than 2^31 in the last.
+		*/
+		const int NumSkyPerfBuckets = 32;
+
+		/**
+		* The counters of one stage.
+		*/
+		struct SkyPerfStage
+		{
+			/**The number of calls.*/
+			unsigned long long calls;
+			/**The time of all the calls.*/
+			unsigned long long totalNanoseconds;
+			/**The time of the last call.*/
+			unsigned long long lastNanoseconds;
+			/**The time of the quickest call. 0 if there were no calls.*/
+			unsigned long long minNanoseconds;
+			/**The time of the slowest call.*/
+			unsigned long long maxNanoseconds;
+			/**The calls by how long they took, see NumSkyPerfBuckets.*/
+			unsigned int histogram[NumSkyPerfBuckets];
+		};
+
+		/**
+		* The counters of every stage, indexed by SKY_PERF_STAGE.
+		*
+		* @note There is one set of counters for the whole process. Every
+		*		Sky (including a SkyCalculated or a SkyCalculatedAsync and
+		*		its worker) adds to the same stages, so with more than one
+		*		sky, such as split screen views, the calls, min, max and
+		*		histogram are of all of them together.
+		*/
+		struct SkyPerfCounters
+		{
+			SkyPerfStage stages[NumSkyPerfStages];
+		};
+
+		/**
+		* Get a copy of the counters. They only count when the library is
+		* built with BIOSKY_ENABLE_PERF_COUNTERS, otherwise they stay 0.
+		*
+		* The counters are of every sky in the process, not one sky. To
+		* time a single sky, update only that sky between a
+		* ResetSkyPerfCounters and this call.
+		*
+		* @param[out] counters The counters.
+		*/
+		BIOSKY_API void GetSkyPerfCounters(SkyPerfCounters * counters);
+
+		/**
+		* Set all the counters back to 0. This resets them for every sky in
+		* the process.
+		*/
+		BIOSKY_API void ResetSkyPerfCounters();
+
+		/**
+		* Add the time of one call to a stage. Safe from any thread.
+		*
+		* @param stage The stage.
+		*
+		* @param nanoseconds How long the call took.
+		*/
+		BIOSKY_API void RecordSkyPerfSample(SKY_PERF_STAGE stage, unsigned long long nanoseconds);
+
+		/**
+		* Estimate a percentile of a stage from its histogram. The result is
+		* the top of the bucket the percentile falls in, kept within the min
+		* and max, so it is good to a factor of 2.
+		*
+		* @param stage The counters of the stage.
+		*
+		* @param percentile From 0 to 100.
+		*
+		* @return Returns the time in nanoseconds, or 0 if there were no
+		*			calls.
+		*/
+		BIOSKY_API unsigned long long GetSkyPerfPercentile(const SkyPerfStage & stage, float percentile);
+
+		/**
+		* Get the name of a stage, the name its trace events have.
+		*
+		* @return Returns the name, or "Unknown" if stage is not a
+		*			SKY_PERF_STAGE.
+		*/
+		BIOSKY_API const char * GetSkyPerfStageName(SKY_PERF_STAGE stage);
+
+		/**
+		* Times the scope it is in and adds it to a stage. Use it through
+		* BIOSKY_PERF_SCOPE so it is compiled out when the counters are off.
+		* BIOSKY_PERF_SCOPE also records the scope as a trace event when
+		* tracing is on.
+		*/
+		class SkyPerfScope
+		{
+		public:
+			explicit SkyPerfScope(SKY_PERF_STAGE stage);
+			~SkyPerfScope();
+
+		private:
+			SKY_PERF_STAGE _stage;
+			std::chrono::high_resolution_clock::time_point _start;
+		};
+
+#if BIOSKY_TESTING == 1
+		/**
+		* Test the performance counters.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		bool SkyPerfCounterTests(XNELO::TESTING::Test * test);
+#endif
+	}//end namespace SKY
+}//end namespace BIO
+
+#if BIOSKY_PERF_COUNTERS == 1
+	#define BIOSKY_PERF_CONCAT_(first, second) first##second
+	#define BIOSKY_PERF_CONCAT(first, second) BIOSKY_PERF_CONCAT_(first, second)
+	#define BIOSKY_PERF_COUNT_SCOPE(stage) BIO::SKY::SkyPerfScope BIOSKY_PERF_CONCAT(_bioskyPerfScope, __LINE__)(stage)
+#else
+	#define BIOSKY_PERF_COUNT_SCOPE(stage)
+#endif //BIOSKY_PERF_COUNTERS
+
+#define BIOSKY_PERF_SCOPE(stage) BIOSKY_PERF_COUNT_SCOPE(stage); BIOSKY_TRACE_SCOPE(BIO::SKY::GetSkyPerfStageName(stage))
+
+inline BIO::SKY::SkyPerfScope::SkyPerfScope(SKY_PERF_STAGE stage) : _stage(stage), _start(std::chrono::high_resolution_clock::now())
+{}
+
+inline BIO::SKY::SkyPerfScope::~SkyPerfScope()
+{
+	RecordSkyPerfSample(_stage, (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - _start).count());
+}
+
+#endif //___BIOSKY_SKYPERFCOUNTERS_HPP__2015___
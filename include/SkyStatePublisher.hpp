@@ -0,0 +1,217 @@
+/**
+* @file SkyStatePublisher.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A snapshot of the sky that any thread can read while it is updated.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#ifndef ___BIOSKY_SKYSTATEPUBLISHER_HPP__2015___
+#define ___BIOSKY_SKYSTATEPUBLISHER_HPP__2015___
+
+#include "CompileConfig.h"
+#include "SkyData.hpp"
+#include "LightData.hpp"
+#include "Vector3D.hpp"
+#include "Timestamp.hpp"
+
+#include <atomic>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* Everything other threads usually want to know about the sky at
+		* one moment.
+		*/
+		struct SkySnapshot
+		{
+			/**The time the sky was worked out for.*/
+			Timestamp time;
+			/**The positions of the sun and moon, the phase and the rest.*/
+			SkyData skyData;
+			/**The color of the sky lights.*/
+			LightData lights;
+			/**The unit vector toward the sun, in the same axes as the dome.*/
+			Vector3D sunDirection;
+			/**The unit vector toward the moon, in the same axes as the dome.*/
+			Vector3D moonDirection;
+		};
+
+		/**
+		* Make a snapshot, working out the directions of the sun and moon.
+		*/
+		BIOSKY_API SkySnapshot MakeSkySnapshot(const Timestamp & time, const SkyData & skyData, const LightData & lights);
+
+		/**
+		* Get the unit vector toward a place in the sky. This is the vector
+		* given to IDomeGeometry::SetSunPosition.
+		*/
+		BIOSKY_API Vector3D SkyPositionToUnitVector(const SkyPosition & position);
+
+		/**
+		* Hands SkySnapshots from the thread that updates the sky to any
+		* number of readers.
+		*
+		* The snapshots are kept in a ring of slots, each a seqlock: the
+		* writer fills the slot after the newest one and then points the
+		* readers at it, and a reader copies the newest slot and checks that
+		* its sequence did not change. Since the writer never writes the
+		* slot the readers are pointed at, a reader only has to try again
+		* if the writer published more than NumSlots - 1 times while it was
+		* copying a few dozen bytes. Neither side takes a lock or
+		* allocates. The slots hold the snapshot as plain values, so
+		* copying one while the writer is in it is never undefined
+		* behavior; the sequence tells the reader to throw it away.
+		*
+		* There must be only one writer at a time.
+		*/
+		class SkyStatePublisher
+		{
+		public:
+			/**The number of snapshots kept.*/
+			enum { NumSlots = 4 };
+
+			/**The most times Read tries to read the newest snapshot.*/
+			enum { MaxReadAttempts = 1000 };
+
+			/**
+			* Constructor. Nothing is published.
+			*/
+			BIOSKY_API SkyStatePublisher();
+
+			/**
+			* Publish a snapshot. Only one thread may publish at a time.
+			*/
+			BIOSKY_API void Publish(const SkySnapshot & snapshot);
+
+			/**
+			* Read the newest snapshot. This tries again while the writer
+			* is reusing the slot, but only MaxReadAttempts times, so it
+			* never spins forever against a writer that publishes
+			* without stopping.
+			*
+			* @param[out] snapshot The snapshot. It is not changed if this
+			*			fails.
+			*
+			* @return Returns false if nothing has been published or every
+			*			try failed (see TryRead).
+			*/
+			BIOSKY_API bool Read(SkySnapshot * snapshot) const;
+
+			/**
+			* Try once to read the newest snapshot.
+			*
+			* @param[out] snapshot The snapshot. It is not changed if this
+			*			fails.
+			*
+			* @return Returns false if nothing has been published or the
+			*			writer reused the slot while it was being read.
+			*/
+			BIOSKY_API bool TryRead(SkySnapshot * snapshot) const;
+
+			/**
+			* Get the number of snapshots published. A reader can compare
+			* this with the last count it saw to know if the sky changed.
+			*/
+			unsigned int GetPublishCount() const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			/**
+			* A SkySnapshot as plain values, which can be copied to and
+			* from the words of a slot.
+			*/
+			struct _PackedSnapshot
+			{
+				long long microseconds;
+				float moonAzimuth;
+				float moonZenith;
+				float sunAzimuth;
+				float sunZenith;
+				float starRotation;
+				float northStarZenith;
+				float phase;
+				float moonVisibility;
+				float color[4];
+				float ambientColor[4];
+				float sunDirection[3];
+				float moonDirection[3];
+			};
+
+			/**The number of 32 bit words in a snapshot.*/
+			enum { _NumWords = (sizeof(_PackedSnapshot) + 3) / 4 };
+
+			/**
+			* One snapshot. The words are atomics so the copy a reader makes
+			* while the writer is in the slot is not a data race; the
+			* sequence tells the reader to throw it away.
+			*/
+			struct _Slot
+			{
+				/**Odd while the writer is filling the slot.*/
+				std::atomic<unsigned int> sequence;
+				std::atomic<unsigned int> words[_NumWords];
+			};
+
+			_Slot _slots[NumSlots];
+
+			static void _Pack(const SkySnapshot & snapshot, _PackedSnapshot * packed);
+			static void _Unpack(const _PackedSnapshot & packed, SkySnapshot * snapshot);
+
+			/**The number of snapshots published. The newest is in slot _published % NumSlots.*/
+			std::atomic<unsigned int> _published;
+
+			SkyStatePublisher(const SkyStatePublisher & other);
+			SkyStatePublisher & operator = (const SkyStatePublisher & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline unsigned int BIO::SKY::SkyStatePublisher::GetPublishCount() const
+{
+	return _published.load(std::memory_order_acquire);
+}
+
+#endif //___BIOSKY_SKYSTATEPUBLISHER_HPP__2015___
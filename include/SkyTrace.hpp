@@ -0,0 +1,166 @@
+/**
+* @file SkyTrace.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A timeline of what the library is doing, written as a Chrome trace.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#ifndef ___BIOSKY_SKYTRACE_HPP__2015___
+#define ___BIOSKY_SKYTRACE_HPP__2015___
+
+#include "CompileConfig.h"
+
+#include <ostream>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The number of events kept for each thread. Once a thread has
+		* recorded more than this its oldest events are written over. The
+		* buffer of a thread that has ended is kept and given to the next
+		* new thread that records, so memory grows with the most threads
+		* recording at once rather than with every thread ever made.
+		*/
+		const int SkyTraceEventsPerThread = 16384;
+
+		/**
+		* Start recording trace events. Events recorded before this are
+		* dropped.
+		*
+		* The events are only recorded where BIOSKY_TRACE_SCOPE is used, and
+		* the library only uses it when it is built with
+		* BIOSKY_ENABLE_TRACING. When it is built in and the trace is not
+		* recording a scope costs one function call.
+		*/
+		BIOSKY_API void StartSkyTrace();
+
+		/**
+		* Stop recording trace events. The events that were recorded are
+		* kept until the next StartSkyTrace.
+		*/
+		BIOSKY_API void StopSkyTrace();
+
+		/**
+		* Get if trace events are being recorded.
+		*/
+		BIOSKY_API bool IsSkyTraceRecording();
+
+		/**
+		* Start an event.
+		*
+		* @return Returns the time the event started, or a negative number
+		*			if the trace is not recording.
+		*/
+		BIOSKY_API long long BeginSkyTraceEvent();
+
+		/**
+		* End an event and add it to the trace buffer of this thread. Each
+		* thread has its own buffer so this never waits on another thread.
+		*
+		* @param name The name of the event. The pointer is kept, so it must
+		*			be a string literal or live until the trace is written.
+		*
+		* @param begin The time from BeginSkyTraceEvent. Nothing is
+		*			recorded if it is negative.
+		*/
+		BIOSKY_API void EndSkyTraceEvent(const char * name, long long begin);
+
+		/**
+		* Write the recorded events in the Chrome Trace Event format. The
+		* file can be opened in chrome://tracing or Perfetto. It can be
+		* written while the trace is still recording.
+		*
+		* @param out The stream to write to.
+		*
+		* @return Returns the number of events written.
+		*/
+		BIOSKY_API int WriteSkyTrace(std::ostream & out);
+
+		/**
+		* Write the recorded events to a file in the Chrome Trace Event
+		* format.
+		*
+		* @param fileName The file to write.
+		*
+		* @param[out] numEvents If this is not NULL it is set to the number
+		*			of events written.
+		*
+		* @return Returns false if the file could not be written.
+		*/
+		BIOSKY_API bool WriteSkyTrace(const char * fileName, int * numEvents = NULL);
+
+		/**
+		* Records the scope it is in as one event. Use it through
+		* BIOSKY_TRACE_SCOPE so it is compiled out when tracing is off.
+		*/
+		class SkyTraceScope
+		{
+		public:
+			explicit SkyTraceScope(const char * name);
+			~SkyTraceScope();
+
+		private:
+			const char * _name;
+			long long _begin;
+		};
+
+#if BIOSKY_TESTING == 1
+		/**
+		* Test the trace functions.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		bool SkyTraceTests(XNELO::TESTING::Test * test);
+#endif
+	}//end namespace SKY
+}//end namespace BIO
+
+#if BIOSKY_TRACING == 1
+	#define BIOSKY_TRACE_CONCAT_(first, second) first##second
+	#define BIOSKY_TRACE_CONCAT(first, second) BIOSKY_TRACE_CONCAT_(first, second)
+	#define BIOSKY_TRACE_SCOPE(name) BIO::SKY::SkyTraceScope BIOSKY_TRACE_CONCAT(_bioskyTraceScope, __LINE__)(name)
+#else
+	#define BIOSKY_TRACE_SCOPE(name)
+#endif //BIOSKY_TRACING
+
+inline BIO::SKY::SkyTraceScope::SkyTraceScope(const char * name) : _name(name), _begin(BeginSkyTraceEvent())
+{}
+
+inline BIO::SKY::SkyTraceScope::~SkyTraceScope()
+{
+	if (_begin >= 0)
+		EndSkyTraceEvent(_name, _begin);
+}
+
+#endif //___BIOSKY_SKYTRACE_HPP__2015___
@@ -0,0 +1,584 @@
+/**
+* @file StarCatalog.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A catalog of individual stars that can be drawn as point sprites instead
+* of the baked night sky texture.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_STARCATALOG_HPP__2015___
+#define ___BIOSKY_STARCATALOG_HPP__2015___
+
+#include "CompileConfig.h"
+#include "AssetStore.hpp"
+#include "Vector3D.hpp"
+
+#include <cstddef>
+#include <memory>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The faintest magnitude seen by the naked eye under a dark sky.
+		*/
+		const float DefaultLimitingMagnitude = 6.5f;
+
+		/**
+		* One star of a point sprite star field. The layout is a position,
+		* the brightness and size, and a 0xAARRGGBB color, 24 bytes in all, so
+		* the array can be copied straight into a vertex buffer.
+		*/
+		struct StarVertex
+		{
+			/**The position of the star on the dome.*/
+			Vector3D position;
+			/**How bright the star is from 0 to 1.*/
+			float brightness;
+			/**
+			* The suggested point size in pixels. Brighter stars are drawn
+			* a little bigger.
+			*/
+			float size;
+			/**
+			* The color of the star from its color index. The alpha is the
+			* brightness.
+			*/
+			unsigned int color;
+		};
+
+		/**
+		* A catalog of stars sorted from brightest to faintest.
+		*
+		* Each star is stored as a unit vector in the equatorial frame of the
+		* star dome: +Y is the celestial north pole, right ascension 0 is
+		* along +X and right ascension 6 hours is along +Z. The magnitude
+		* and the B-V color index are quantized to a byte each (steps of
+		* 0.05 magnitudes and 0.01 in color index), the same as the compact
+		* file format, so saving and loading a catalog does not change them.
+		* The compact format keeps the directions to within a few seconds
+		* of arc.
+		*
+		* The quantized magnitudes go from -2 to 10.75, which covers every
+		* naked eye and binocular star. Fainter stars are stored as
+		* magnitude 10.75, so a limiting magnitude of 10.75 or more shows
+		* all of them.
+		*
+		* Stars can be loaded from the binary Yale Bright Star Catalogue
+		* (the BSC5 file) or from the compact format written by SaveCompact.
+		* GetBrightStarCatalog returns the brightest stars, which are built
+		* into the library.
+		*
+		* @note The library only has 82 of the brightest stars (most are
+		*		brighter than magnitude 2.5) built in, not the full
+		*		catalogue of about 9,100 stars: the catalogue data is not
+		*		part of this source tree. For the full star field load the
+		*		BSC5 file once with LoadBSC5 and ship the result of
+		*		SaveCompact (about 73 KB) with the application.
+		*/
+		class StarCatalog : public Asset
+		{
+		public:
+			/**
+			* A star as it is given to SetStars.
+			*/
+			struct Star
+			{
+				/**The right ascension in radians.*/
+				float rightAscension;
+				/**The declination in radians.*/
+				float declination;
+				/**The visual magnitude.*/
+				float magnitude;
+				/**The B-V color index.*/
+				float colorIndex;
+			};
+
+			/**
+			* Constructor. The catalog is empty.
+			*/
+			BIOSKY_API StarCatalog();
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API virtual ~StarCatalog();
+
+			/**
+			* Replace the stars of the catalog.
+			*
+			* @param stars The stars. They do not need to be sorted.
+			*
+			* @param count The number of stars.
+			*
+			* @return Returns false if the stars could not be stored.
+			*/
+			BIOSKY_API bool SetStars(const Star * stars, int count);
+
+			/**
+			* Replace the stars of the catalog with the stars of a binary
+			* Yale Bright Star Catalogue file (BSC5, either byte order).
+			* Entries without a position are skipped. The catalog has no
+			* B-V color index, so it is estimated from the spectral type.
+			*
+			* @param data The contents of the file.
+			*
+			* @param size The size of data in bytes.
+			*
+			* @return Returns false if the data is not a catalog.
+			*/
+			BIOSKY_API bool LoadBSC5(const unsigned char * data, std::size_t size);
+
+			/**
+			* Replace the stars of the catalog with stars saved by
+			* SaveCompact.
+			*
+			* @param data The saved catalog.
+			*
+			* @param size The size of data in bytes.
+			*
+			* @return Returns false if the data is not a compact catalog.
+			*/
+			BIOSKY_API bool LoadCompact(const unsigned char * data, std::size_t size);
+
+			/**
+			* Save the catalog in the compact format: a 12 byte header and 8
+			* bytes for each star.
+			*
+			* @param[out] buffer Where to save the catalog, or NULL to get
+			*			the size.
+			*
+			* @param bufferSize The size of buffer in bytes.
+			*
+			* @return Returns the size of the saved catalog, or 0 if buffer
+			*			is too small.
+			*/
+			BIOSKY_API std::size_t SaveCompact(unsigned char * buffer, std::size_t bufferSize) const;
+
+			/**
+			* Get the number of stars.
+			*/
+			BIOSKY_API int GetStarCount() const;
+
+			/**
+			* Get the direction of a star in the equatorial frame.
+			*/
+			BIOSKY_API Vector3D GetStarDirection(int index) const;
+
+			/**
+			* Get the magnitude of a star. This is at most 10.75, see
+			* StarCatalog.
+			*/
+			BIOSKY_API float GetStarMagnitude(int index) const;
+
+			/**
+			* Get the B-V color index of a star.
+			*/
+			BIOSKY_API float GetStarColorIndex(int index) const;
+
+			/**
+			* Get the color of a star as 0xAARRGGBB with an alpha of 255.
+			*/
+			BIOSKY_API unsigned int GetStarColor(int index) const;
+
+			/**
+			* Get the number of stars brighter than or equal to a magnitude.
+			* These are the first stars of the catalog.
+			*/
+			BIOSKY_API int CountStarsBrighterThan(float magnitude) const;
+
+			/**
+			* Rotate stars from the equatorial frame into the horizon frame.
+			*
+			* The stars are rotated the same way as
+			* IDomeGeometry::SetStarRotation(northStarZenith, starRotation, 0):
+			* first about the Y axis by starRotation and then about the X axis
+			* by northStarZenith. +Y is up after the rotation.
+			*
+			* @param northStarZenith The zenith of the celestial north pole
+			*			in radians. See CalculateCelestialNorthPoleZenith.
+			*
+			* @param starRotation The rotation of the stars in radians. See
+			*			CalculateStarRotation.
+			*
+			* @param first The first star to rotate.
+			*
+			* @param count The number of stars to rotate.
+			*
+			* @param[out] x The X of each rotated star.
+			*
+			* @param[out] y The Y of each rotated star.
+			*
+			* @param[out] z The Z of each rotated star.
+			*
+			* @return Returns the number of stars rotated.
+			*/
+			BIOSKY_API int RotateStars(float northStarZenith, float starRotation, int first, int count, float * x, float * y, float * z) const;
+
+			/**
+			* Build the point sprites of the stars that are above the horizon
+			* and brighter than the limiting magnitude.
+			*
+			* The brightness of a star is the square root of its brightness
+			* compared to a magnitude 1 star, which keeps faint stars visible
+			* on an 8 bit display, up to 1. Stars fade out over the last half
+			* magnitude before the limit so they do not pop when the limit
+			* changes with the brightness of the sky.
+			*
+			* @param northStarZenith The zenith of the celestial north pole
+			*			in radians.
+			*
+			* @param starRotation The rotation of the stars in radians.
+			*
+			* @param limitingMagnitude The faintest star to draw.
+			*
+			* @param radius The radius of the star dome.
+			*
+			* @param[out] vertecies The point sprites.
+			*
+			* @param maxVertecies The number of elements in vertecies.
+			*
+			* @return Returns the number of point sprites written.
+			*/
+			BIOSKY_API int BuildStarField(float northStarZenith, float starRotation, float limitingMagnitude, float radius, StarVertex * vertecies, int maxVertecies) const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			int _numStars;
+			/**
+			* The direction of each star. The arrays are padded to a
+			* multiple of 4.
+			*/
+			float * _x;
+			float * _y;
+			float * _z;
+			/**The quantized magnitude of each star.*/
+			unsigned char * _magnitudes;
+			/**The quantized color index of each star.*/
+			unsigned char * _colorIndecies;
+
+			/**
+			* Allocate space for a number of stars. Anything already held is
+			* released first.
+			*/
+			bool _Allocate(int count);
+
+			/**
+			* Release all the stars.
+			*/
+			void _Release();
+
+			/**
+			* Sort the stars from brightest to faintest.
+			*/
+			void _SortByMagnitude();
+
+			/**
+			* Copying is not allowed. Catalogs are shared through the
+			* AssetStore instead.
+			*/
+			StarCatalog(const StarCatalog & other);
+			StarCatalog & operator = (const StarCatalog & other);
+
+			friend class StarIndex;
+		};
+
+		/**
+		* The default number of stars in each cell of a StarIndex.
+		*/
+		const int DefaultStarsPerCell = 32;
+
+		/**
+		* A spatial index over a StarCatalog so only the stars that can be
+		* seen are looked at each frame.
+		*
+		* The stars are split into levels one magnitude wide (everything
+		* brighter than magnitude 2 is the first level). Each level cuts the
+		* sky into cells on the faces of a cube (warped so the cells are
+		* close to the same size), with as many cells as its stars need, so
+		* the few bright stars are in a few big cells and the many faint
+		* stars are in many small ones. Each cell keeps its stars together,
+		* sorted from brightest to faintest, with a bounding cone like the
+		* night sky tiles.
+		*
+		* A query stops at the first level that is fainter than the
+		* limiting magnitude, skips the cells that are below the horizon and
+		* only reads the stars of the other cells that are bright enough.
+		* The time it takes depends on the number of stars that can be seen,
+		* not on the size of the catalog.
+		*
+		* The index keeps its own copy of the directions, magnitudes and
+		* color indecies so the stars of a cell are next to each other in
+		* memory: 18 bytes for each star plus 24 bytes for each cell. No
+		* level has more than 64 x 64 cells on a face.
+		*/
+		class StarIndex
+		{
+		public:
+			/**
+			* A cell of the index.
+			*/
+			struct Cell
+			{
+				/**The first star of the cell in the index.*/
+				int first;
+				/**The number of stars in the cell.*/
+				int count;
+				/**The center of the cell's bounding cone on the unit star dome.*/
+				Vector3D axis;
+				/**The half angle of the bounding cone in radians.*/
+				float halfAngle;
+			};
+
+			/**
+			* A level of the index.
+			*/
+			struct Level
+			{
+				/**The first cell of the level.*/
+				int firstCell;
+				/**The number of cells across each face of the cube.*/
+				int cellsPerFace;
+				/**The number of stars in the level.*/
+				int numStars;
+				/**The magnitude of the brightest star of the level.*/
+				float brightest;
+			};
+
+			/**
+			* Constructor. Builds the index.
+			*
+			* @param catalog The stars to index.
+			*
+			* @param starsPerCell About how many stars to put in each cell.
+			*/
+			BIOSKY_API StarIndex(std::shared_ptr<const StarCatalog> catalog, int starsPerCell = DefaultStarsPerCell);
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API ~StarIndex();
+
+			/**
+			* Get the catalog that is indexed.
+			*/
+			BIOSKY_API const std::shared_ptr<const StarCatalog> & GetCatalog() const;
+
+			/**
+			* Get the number of stars in the index.
+			*/
+			BIOSKY_API int GetStarCount() const;
+
+			/**
+			* Get the number of levels.
+			*/
+			BIOSKY_API int GetLevelCount() const;
+
+			/**
+			* Get a level. Values out of range are clamped.
+			*/
+			BIOSKY_API const Level & GetLevel(int level) const;
+
+			/**
+			* Get the total number of cells of all the levels.
+			*/
+			BIOSKY_API int GetCellCount() const;
+
+			/**
+			* Get a cell. Values out of range are clamped.
+			*/
+			BIOSKY_API const Cell & GetCell(int index) const;
+
+			/**
+			* Find the cell a direction is in on a level.
+			*/
+			BIOSKY_API int FindCell(int level, const Vector3D & direction) const;
+
+			/**
+			* Get the memory used by the index in bytes.
+			*/
+			BIOSKY_API std::size_t GetMemorySize() const;
+
+			/**
+			* Find the stars that are above the horizon and bright enough to
+			* be seen. The rotation is the same as StarCatalog::RotateStars.
+			* The stars come out one cell at a time, so if there are more
+			* than maxStars the ones left out are not always the faintest.
+			* The catalog's CountStarsBrighterThan is a safe size.
+			*
+			* @param northStarZenith The zenith of the celestial north pole
+			*			in radians.
+			*
+			* @param starRotation The rotation of the stars in radians.
+			*
+			* @param limitingMagnitude The faintest star to find. See
+			*			CalculateLimitingMagnitude.
+			*
+			* @param[out] stars The index of each star in the catalog.
+			*
+			* @param maxStars The number of elements in stars.
+			*
+			* @return Returns the number of stars found.
+			*/
+			BIOSKY_API int FindVisibleStars(float northStarZenith, float starRotation, float limitingMagnitude, int * stars, int maxStars) const;
+
+			/**
+			* Build the point sprites of the stars that are above the horizon
+			* and bright enough to be seen. This gives the same stars as
+			* StarCatalog::BuildStarField, in a different order.
+			*
+			* @param northStarZenith The zenith of the celestial north pole
+			*			in radians.
+			*
+			* @param starRotation The rotation of the stars in radians.
+			*
+			* @param limitingMagnitude The faintest star to draw.
+			*
+			* @param radius The radius of the star dome.
+			*
+			* @param[out] vertecies The point sprites.
+			*
+			* @param maxVertecies The number of elements in vertecies.
+			*
+			* @return Returns the number of point sprites written.
+			*/
+			BIOSKY_API int BuildStarField(float northStarZenith, float starRotation, float limitingMagnitude, float radius, StarVertex * vertecies, int maxVertecies) const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			std::shared_ptr<const StarCatalog> _catalog;
+			int _numStars;
+			int _numLevels;
+			int _numCells;
+			/**All the levels.*/
+			Level * _levels;
+			/**The cells of every level.*/
+			Cell * _cells;
+			/**The direction of each star, cell by cell.*/
+			float * _x;
+			float * _y;
+			float * _z;
+			/**The quantized magnitude of each star.*/
+			unsigned char * _magnitudes;
+			/**The quantized color index of each star.*/
+			unsigned char * _colorIndecies;
+			/**The index of each star in the catalog.*/
+			int * _catalogIndecies;
+
+			/**
+			* Find the visible stars. Either stars or vertecies is filled in.
+			*/
+			int _Query(float northStarZenith, float starRotation, float limitingMagnitude, float radius, int * stars, StarVertex * vertecies, int maxStars) const;
+
+			StarIndex(const StarIndex & other);
+			StarIndex & operator = (const StarIndex & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline int BIO::SKY::StarCatalog::GetStarCount() const
+{
+	return _numStars;
+}
+
+inline BIO::Vector3D BIO::SKY::StarCatalog::GetStarDirection(int index) const
+{
+	return Vector3D(_x[index], _y[index], _z[index]);
+}
+
+inline const std::shared_ptr<const BIO::SKY::StarCatalog> & BIO::SKY::StarIndex::GetCatalog() const
+{
+	return _catalog;
+}
+
+inline int BIO::SKY::StarIndex::GetStarCount() const
+{
+	return _numStars;
+}
+
+inline int BIO::SKY::StarIndex::GetLevelCount() const
+{
+	return _numLevels;
+}
+
+inline const BIO::SKY::StarIndex::Level & BIO::SKY::StarIndex::GetLevel(int level) const
+{
+	if (level < 0)
+		level = 0;
+
+	if (level >= _numLevels)
+		level = _numLevels - 1;
+
+	return _levels[level];
+}
+
+inline int BIO::SKY::StarIndex::GetCellCount() const
+{
+	return _numCells;
+}
+
+inline const BIO::SKY::StarIndex::Cell & BIO::SKY::StarIndex::GetCell(int index) const
+{
+	if (index < 0)
+		index = 0;
+
+	if (index >= _numCells)
+		index = _numCells - 1;
+
+	return _cells[index];
+}
+
+#endif //___BIOSKY_STARCATALOG_HPP__2015___
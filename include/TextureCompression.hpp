@@ -0,0 +1,240 @@
+/**
+* @file TextureCompression.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Block compression (BC1/DXT1 and BC3/DXT5) for the BGRA textures created by
+* this library.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_TEXTURECOMPRESSION_HPP__2015___
+#define ___BIOSKY_TEXTURECOMPRESSION_HPP__2015___
+
+#include "CompileConfig.h"
+#include "AssetStore.hpp"
+#include "TextureMipChain.hpp"
+
+#include <cstddef>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* The block compression formats this library can create.
+		*/
+		enum TEXTURE_BLOCK_FORMAT
+		{
+			/**BC1 (DXT1). 8 bytes per 4x4 block. Color with 1 bit alpha.*/
+			BLOCK_FORMAT_BC1 = 0,
+			/**BC3 (DXT5). 16 bytes per 4x4 block. Color with 8 bit alpha.*/
+			BLOCK_FORMAT_BC3
+		};
+
+		/**
+		* Get the number of bytes a compressed image needs.
+		*
+		* @param width The width of the image in pixels.
+		*
+		* @param height The height of the image in pixels.
+		*
+		* @param format The block format.
+		*/
+		BIOSKY_API std::size_t GetCompressedTextureSize(int width, int height, TEXTURE_BLOCK_FORMAT format);
+
+		/**
+		* Compress a BGRA image into blocks. Images whose sizes are not a
+		* multiple of 4 repeat their last row/column to fill the edge blocks.
+		*
+		* For BC1, blocks that contain pixels with alpha below 128 use the
+		* three color mode so those pixels are transparent.
+		*
+		* @param image The image in B G R A format.
+		*
+		* @param width The width of the image.
+		*
+		* @param height The height of the image.
+		*
+		* @param format The block format to create.
+		*
+		* @param[out] blocks The compressed blocks. This must be at least
+		*			GetCompressedTextureSize(width, height, format) bytes.
+		*/
+		BIOSKY_API void CompressTexture(const unsigned char * image, int width, int height, TEXTURE_BLOCK_FORMAT format, unsigned char * blocks);
+
+		/**
+		* Decompress blocks back into a BGRA image.
+		*
+		* @param blocks The compressed blocks.
+		*
+		* @param width The width of the image.
+		*
+		* @param height The height of the image.
+		*
+		* @param format The block format of blocks.
+		*
+		* @param[out] image The image in B G R A format. This must be at
+		*			least width x height x 4 bytes.
+		*/
+		BIOSKY_API void DecompressTexture(const unsigned char * blocks, int width, int height, TEXTURE_BLOCK_FORMAT format, unsigned char * image);
+
+		/**
+		* A block compressed texture with all of its mip levels. The levels
+		* are stored one after another in a single block of memory.
+		*
+		* A compressed texture can also keep the alpha channel of each level
+		* as a separate uncompressed 8 bit plane. This is meant for textures
+		* like the moon, where the alpha is rewritten every time the phase
+		* changes but the color never does.
+		*/
+		class CompressedTexture : public Asset
+		{
+		public:
+			/**
+			* A single level of the texture.
+			*/
+			struct Level
+			{
+				/**The width of the level in pixels.*/
+				int width;
+				/**The height of the level in pixels.*/
+				int height;
+				/**The compressed blocks of this level.*/
+				const unsigned char * blocks;
+				/**The size of blocks in bytes.*/
+				std::size_t blocksSize;
+				/**
+				* The alpha of this level, one byte per pixel, or NULL if
+				* the alpha is not kept separately.
+				*/
+				const unsigned char * alpha;
+			};
+
+			/**
+			* Constructor. Compresses every level of a mip chain.
+			*
+			* @param chain The mip chain to compress.
+			*
+			* @param format The block format to use.
+			*
+			* @param separateAlpha If true the alpha of every level is kept
+			*			in its own uncompressed plane.
+			*/
+			BIOSKY_API CompressedTexture(const TextureMipChain & chain, TEXTURE_BLOCK_FORMAT format, bool separateAlpha = false);
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API virtual ~CompressedTexture();
+
+			/**
+			* Get the block format of this texture.
+			*/
+			BIOSKY_API TEXTURE_BLOCK_FORMAT GetFormat() const;
+
+			/**
+			* Get the number of levels in this texture.
+			*/
+			BIOSKY_API int GetLevelCount() const;
+
+			/**
+			* Get a level. Values out of range are clamped to the available
+			* levels.
+			*/
+			BIOSKY_API const Level & GetLevel(int level) const;
+
+			/**
+			* Get the size in bytes of all the levels, including the
+			* separate alpha planes.
+			*/
+			BIOSKY_API std::size_t GetDataSize() const;
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class and the compression functions.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			/**The format of the blocks.*/
+			TEXTURE_BLOCK_FORMAT _format;
+			/**All of the blocks and alpha planes.*/
+			unsigned char * _data;
+			/**The size of _data in bytes.*/
+			std::size_t _dataSize;
+			/**Level descriptions pointing into _data.*/
+			Level * _levels;
+			/**The number of levels.*/
+			int _numLevels;
+
+			/**
+			* Copying is not allowed. The texture is shared through the
+			* AssetStore instead.
+			*/
+			CompressedTexture(const CompressedTexture & other);
+			CompressedTexture & operator = (const CompressedTexture & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline BIO::SKY::TEXTURE_BLOCK_FORMAT BIO::SKY::CompressedTexture::GetFormat() const
+{
+	return _format;
+}
+
+inline int BIO::SKY::CompressedTexture::GetLevelCount() const
+{
+	return _numLevels;
+}
+
+inline const BIO::SKY::CompressedTexture::Level & BIO::SKY::CompressedTexture::GetLevel(int level) const
+{
+	if (level < 0)
+		level = 0;
+
+	if (level >= _numLevels)
+		level = _numLevels - 1;
+
+	return _levels[level];
+}
+
+inline std::size_t BIO::SKY::CompressedTexture::GetDataSize() const
+{
+	return _dataSize;
+}
+
+#endif //___BIOSKY_TEXTURECOMPRESSION_HPP__2015___
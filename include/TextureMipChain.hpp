@@ -0,0 +1,198 @@
+/**
+* @file TextureMipChain.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A chain of mip levels for a texture stored in one contiguous block of
+* memory.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_TEXTUREMIPCHAIN_HPP__2015___
+#define ___BIOSKY_TEXTUREMIPCHAIN_HPP__2015___
+
+#include "CompileConfig.h"
+#include "AssetStore.hpp"
+
+#include <cstddef>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		/**
+		* Holds every mip level of a BGRA texture, from the base level down to
+		* 1x1. All of the levels are stored one after another in a single
+		* block of memory so levels 1..n can be handed to a renderer that
+		* expects the mip data in one contiguous array.
+		*
+		* Each level is created from the previous one with a 2x2 box filter
+		* using premultiplied alpha averaging, so bright pixels with a low
+		* alpha (stars) are not washed out by transparent neighbors.
+		*/
+		class TextureMipChain : public Asset
+		{
+		public:
+			/**
+			* A single level in the chain.
+			*/
+			struct Level
+			{
+				/**The width of the level in pixels.*/
+				int width;
+				/**The height of the level in pixels.*/
+				int height;
+				/**The BGRA pixels of this level.*/
+				const unsigned char * pixels;
+			};
+
+			/**
+			* Constructor. Builds the full mip chain for an image.
+			*
+			* @param image The base image in BGRA format.
+			*
+			* @param width The width of the image.
+			*
+			* @param height The height of the image.
+			*
+			* @param maxSize The largest width or height the first level of
+			*			the chain may have. The image is filtered down until
+			*			it fits and the larger levels are not kept. Pass 0 to
+			*			keep the full resolution image as the first level.
+			*/
+			BIOSKY_API TextureMipChain(const unsigned char * image, int width, int height, int maxSize = 0);
+
+			/**
+			* Destructor
+			*/
+			BIOSKY_API virtual ~TextureMipChain();
+
+			/**
+			* Get the number of levels in this chain.
+			*/
+			BIOSKY_API int GetLevelCount() const;
+
+			/**
+			* Get a level from the chain.
+			*
+			* @param level The level to get. 0 is the largest level. Values
+			*			out of range are clamped to the available levels.
+			*/
+			BIOSKY_API const Level & GetLevel(int level) const;
+
+			/**
+			* Find the largest level whose width and height are both less
+			* than or equal to maxSize.
+			*
+			* @return Returns the index of the level. If no level is small
+			*			enough the index of the last (1x1) level is returned.
+			*/
+			BIOSKY_API int FindLevelForSize(int maxSize) const;
+
+			/**
+			* Get the size in bytes of all the levels.
+			*/
+			BIOSKY_API std::size_t GetDataSize() const;
+
+			/**
+			* Create the next mip level of a BGRA image with a 2x2 box filter
+			* and premultiplied alpha averaging. Odd dimensions clamp to the
+			* last row/column.
+			*
+			* @param src The source image.
+			*
+			* @param srcWidth The width of the source image.
+			*
+			* @param srcHeight The height of the source image.
+			*
+			* @param[out] dst The destination image. This must be at least
+			*			max(1, srcWidth/2) x max(1, srcHeight/2) x 4 bytes.
+			*/
+			BIOSKY_API static void Downsample(const unsigned char * src, int srcWidth, int srcHeight, unsigned char * dst);
+
+			/**
+			* Count the number of levels in a full chain for an image.
+			*/
+			BIOSKY_API static int CalculateLevelCount(int width, int height);
+
+#if BIOSKY_TESTING == 1
+			/**
+			* Test this class.
+			*
+			* @param test A pointer to a Test class that holds all the function
+			*				for testing and will hold all the results of the
+			*				testing.
+			*
+			* @return Returns true iff all the tests pass.
+			*/
+			static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+		private:
+			/**All the levels' pixels, one after the other.*/
+			unsigned char * _data;
+			/**The size of the _data array in bytes.*/
+			std::size_t _dataSize;
+			/**Level descriptions pointing into _data.*/
+			Level * _levels;
+			/**The number of levels.*/
+			int _numLevels;
+
+			/**
+			* Copying is not allowed. The chain is shared through the
+			* AssetStore instead.
+			*/
+			TextureMipChain(const TextureMipChain & other);
+			TextureMipChain & operator = (const TextureMipChain & other);
+		};
+	}//end namespace SKY
+}//end namespace BIO
+
+inline int BIO::SKY::TextureMipChain::GetLevelCount() const
+{
+	return _numLevels;
+}
+
+inline const BIO::SKY::TextureMipChain::Level & BIO::SKY::TextureMipChain::GetLevel(int level) const
+{
+	if (level < 0)
+		level = 0;
+
+	if (level >= _numLevels)
+		level = _numLevels - 1;
+
+	return _levels[level];
+}
+
+inline std::size_t BIO::SKY::TextureMipChain::GetDataSize() const
+{
+	return _dataSize;
+}
+
+#endif //___BIOSKY_TEXTUREMIPCHAIN_HPP__2015___
@@ -0,0 +1,200 @@
+/**
+* @file Timestamp.hpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* A moment in time as a single 64 bit number.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#ifndef ___BIOSKY_TIMESTAMP_HPP__2015___
+#define ___BIOSKY_TIMESTAMP_HPP__2015___
+
+#include "CompileConfig.h"
+#include "Date.hpp"
+
+namespace BIO
+{
+	/**
+	* A moment in Universal Time, stored as the number of microseconds since
+	* J2000.0 (2000 January 1, 12:00 UT).
+	*
+	* Unlike a DateTime there is no calendar to walk and no float seconds:
+	* the sky functions get the days since J2000 straight from the count,
+	* and a microsecond is kept for more than 290,000 years either way.
+	* It is a single integer so it can be copied with memcpy and passed
+	* between threads freely.
+	*/
+	class Timestamp
+	{
+	public:
+		/**The number of microseconds in one day.*/
+		static const long long MicrosecondsPerDay = 86400000000LL;
+
+		/**
+		* Default constructor. The time is J2000.0.
+		*/
+		Timestamp();
+
+		/**
+		* Constructor
+		*
+		* @param microseconds The microseconds since J2000.0.
+		*/
+		explicit Timestamp(long long microseconds);
+
+		/**
+		* Make a timestamp from a calendar date and a time of day.
+		*
+		* @param standardTime The time in 24 hr decimal format.
+		*
+		* @param UTCoffset The number of hours offset from UTC-0 time.
+		*
+		* @param month The month of the year.
+		*
+		* @param day The day of the month.
+		*
+		* @param year The year.
+		*/
+		BIOSKY_API static Timestamp FromCalendar(double standardTime, double UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year);
+
+		/**
+		* Make a timestamp from a Julian day in Universal Time. This is only
+		* good to about 40 microseconds since a double Julian day is.
+		*/
+		BIOSKY_API static Timestamp FromJulianDay(double julianDay);
+
+		/**
+		* Move the time forward or back.
+		*
+		* @param microseconds The microseconds to add.
+		*/
+		void AddMicroseconds(long long microseconds);
+
+		/**
+		* Move the time forward or back.
+		*
+		* @param seconds The seconds to add. This is rounded to the nearest
+		*			microsecond.
+		*/
+		BIOSKY_API void AddSeconds(double seconds);
+
+		/**
+		* Get the number of days from 2000 Jan 0.0 UT, the day count used by
+		* the sky functions (DaysSinceJan02000 plus the fraction of the day).
+		*/
+		double GetDaysSinceJan02000() const;
+
+		/**
+		* Get the Julian day in Universal Time.
+		*/
+		double GetJulianDay() const;
+
+		/**
+		* Get the microseconds since J2000.0.
+		*/
+		long long GetMicroseconds() const;
+
+		/**
+		* Get the Universal Time of day in hours, [0, 24).
+		*/
+		BIOSKY_API double GetUniversalTimeHours() const;
+
+		/**
+		* Get the calendar date in Universal Time.
+		*/
+		BIOSKY_API Date GetUniversalDate() const;
+
+		bool operator == (const Timestamp & other) const;
+		bool operator != (const Timestamp & other) const;
+		bool operator < (const Timestamp & other) const;
+
+#if BIOSKY_TESTING == 1
+		/**
+		* Test this class.
+		*
+		* @param test A pointer to a Test class that holds all the function
+		*				for testing and will hold all the results of the
+		*				testing.
+		*
+		* @return Returns true iff all the tests pass.
+		*/
+		static bool Test(XNELO::TESTING::Test * test);
+#endif
+
+	private:
+		/**The microseconds since J2000.0.*/
+		long long _microseconds;
+	};
+
+}//end namespace BIO
+
+inline BIO::Timestamp::Timestamp() : _microseconds(0)
+{}
+
+inline BIO::Timestamp::Timestamp(long long microseconds) : _microseconds(microseconds)
+{}
+
+inline void BIO::Timestamp::AddMicroseconds(long long microseconds)
+{
+	_microseconds += microseconds;
+}
+
+inline double BIO::Timestamp::GetDaysSinceJan02000() const
+{
+	//J2000.0 is 1.5 days after 2000 Jan 0.0
+	return 1.5 + (double)_microseconds / (double)MicrosecondsPerDay;
+}
+
+inline double BIO::Timestamp::GetJulianDay() const
+{
+	return 2451545.0 + (double)_microseconds / (double)MicrosecondsPerDay;
+}
+
+inline long long BIO::Timestamp::GetMicroseconds() const
+{
+	return _microseconds;
+}
+
+inline bool BIO::Timestamp::operator == (const Timestamp & other) const
+{
+	return _microseconds == other._microseconds;
+}
+
+inline bool BIO::Timestamp::operator != (const Timestamp & other) const
+{
+	return _microseconds != other._microseconds;
+}
+
+inline bool BIO::Timestamp::operator < (const Timestamp & other) const
+{
+	return _microseconds < other._microseconds;
+}
+
+#endif //___BIOSKY_TIMESTAMP_HPP__2015___
@@ -0,0 +1,415 @@
+/**
+* @file Allocator.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the library allocator functions.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "Allocator.hpp"
+
+#include <atomic>
+#include <cstdlib>
+
+#if BIOSKY_TESTING == 1
+#include "RawGeometry.hpp"
+
+#include <map>
+#include <vector>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**
+			* The allocator used when the application has not set one. It
+			* uses malloc and aligns the block by hand.
+			*/
+			class DefaultAllocator : public IAllocator
+			{
+			public:
+				virtual void * Allocate(std::size_t size, std::size_t alignment)
+				{
+					unsigned char * raw = (unsigned char *)malloc(size + alignment + sizeof(void *));
+
+					if (raw == NULL)
+						return NULL;
+
+					std::size_t address = (std::size_t)(raw + sizeof(void *));
+					address = (address + alignment - 1) & ~(alignment - 1);
+
+					unsigned char * aligned = (unsigned char *)address;
+					((void **)aligned)[-1] = raw;
+
+					return aligned;
+				}
+
+				virtual void Deallocate(void * memory)
+				{
+					if (memory)
+						free(((void **)memory)[-1]);
+				}
+			};
+
+			/**
+			* Placed directly in front of every block handed out by Allocate
+			* so the block can be released through the allocator that created
+			* it.
+			*/
+			struct AllocationHeader
+			{
+				/**The allocator that created the block.*/
+				IAllocator * allocator;
+				/**The size that was requested.*/
+				std::size_t size;
+				/**Bytes from the start of the raw block to the user memory.*/
+				std::size_t offset;
+			};
+
+			DefaultAllocator _defaultAllocator;
+			std::atomic<IAllocator *> _allocator(&_defaultAllocator);
+
+			std::atomic<std::size_t> _currentBytes(0);
+			std::atomic<std::size_t> _peakBytes(0);
+			std::atomic<std::size_t> _totalBytes(0);
+			std::atomic<std::size_t> _currentAllocations(0);
+			std::atomic<std::size_t> _totalAllocations(0);
+			std::atomic<std::size_t> _totalFrees(0);
+
+			inline AllocationHeader * _GetHeader(const void * memory)
+			{
+				return (AllocationHeader *)((const unsigned char *)memory - sizeof(AllocationHeader));
+			}
+
+			void _TrackAllocation(std::size_t size)
+			{
+				std::size_t current = _currentBytes.fetch_add(size) + size;
+				_totalBytes.fetch_add(size);
+				_currentAllocations.fetch_add(1);
+				_totalAllocations.fetch_add(1);
+
+				std::size_t peak = _peakBytes.load();
+				while (current > peak && !_peakBytes.compare_exchange_weak(peak, current))
+				{
+					//peak was reloaded by compare_exchange_weak
+				}
+			}
+
+			void _TrackFree(std::size_t size)
+			{
+				_currentBytes.fetch_sub(size);
+				_currentAllocations.fetch_sub(1);
+				_totalFrees.fetch_add(1);
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		void SetAllocator(IAllocator * allocator)
+		{
+			if (allocator == NULL)
+				allocator = &_defaultAllocator;
+
+			_allocator.store(allocator);
+		}
+
+		IAllocator * GetAllocator()
+		{
+			return _allocator.load();
+		}
+
+		void * Allocate(std::size_t size, std::size_t alignment)
+		{
+			if (size == 0)
+				return NULL;
+
+			//the header has to be aligned as well
+			if (alignment < sizeof(std::size_t))
+				alignment = sizeof(std::size_t);
+
+			//round the space for the header up to the alignment so the user
+			//memory keeps the requested alignment.
+			std::size_t offset = (sizeof(AllocationHeader) + alignment - 1) & ~(alignment - 1);
+
+			IAllocator * allocator = _allocator.load();
+			unsigned char * raw = (unsigned char *)allocator->Allocate(size + offset, alignment);
+
+			if (raw == NULL)
+				return NULL;
+
+			unsigned char * memory = raw + offset;
+
+			AllocationHeader * header = _GetHeader(memory);
+			header->allocator = allocator;
+			header->size = size;
+			header->offset = offset;
+
+			_TrackAllocation(size);
+
+			return memory;
+		}
+
+		void Free(void * memory)
+		{
+			if (memory == NULL)
+				return;
+
+			AllocationHeader * header = _GetHeader(memory);
+
+			IAllocator * allocator = header->allocator;
+			std::size_t size = header->size;
+			unsigned char * raw = (unsigned char *)memory - header->offset;
+
+			_TrackFree(size);
+
+			allocator->Deallocate(raw);
+		}
+
+		std::size_t GetAllocationSize(const void * memory)
+		{
+			if (memory == NULL)
+				return 0;
+
+			return _GetHeader(memory)->size;
+		}
+
+		AllocationStats GetAllocationStats()
+		{
+			AllocationStats stats;
+			stats.currentBytes = _currentBytes.load();
+			stats.peakBytes = _peakBytes.load();
+			stats.totalBytes = _totalBytes.load();
+			stats.currentAllocations = _currentAllocations.load();
+			stats.totalAllocations = _totalAllocations.load();
+			stats.totalFrees = _totalFrees.load();
+
+			return stats;
+		}
+
+		void ResetAllocationPeak()
+		{
+			_peakBytes.store(_currentBytes.load());
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			class CountingAllocator : public IAllocator
+			{
+			public:
+				int allocations;
+				int deallocations;
+
+				CountingAllocator() : allocations(0), deallocations(0)
+				{}
+
+				virtual void * Allocate(std::size_t size, std::size_t alignment)
+				{
+					++allocations;
+					return _defaultAllocator.Allocate(size, alignment);
+				}
+
+				virtual void Deallocate(void * memory)
+				{
+					++deallocations;
+					_defaultAllocator.Deallocate(memory);
+				}
+			};
+
+			/**
+			* Fails every allocation after the first allowed ones, like an
+			* arena that has run out.
+			*/
+			class FailingAllocator : public IAllocator
+			{
+			public:
+				int allowed;
+
+				FailingAllocator(int numAllowed) : allowed(numAllowed)
+				{}
+
+				virtual void * Allocate(std::size_t size, std::size_t alignment)
+				{
+					if (allowed <= 0)
+						return NULL;
+
+					--allowed;
+					return _defaultAllocator.Allocate(size, alignment);
+				}
+
+				virtual void Deallocate(void * memory)
+				{
+					_defaultAllocator.Deallocate(memory);
+				}
+			};
+
+			struct Counted
+			{
+				static int alive;
+				int value;
+
+				Counted() : value(7) { ++alive; }
+				Counted(const Counted & other) : value(other.value) { ++alive; }
+				~Counted() { --alive; }
+			};
+
+			int Counted::alive = 0;
+		}
+
+		bool AllocatorTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Allocator Tests");
+
+			AllocationStats before = GetAllocationStats();
+
+			test->UnitTest(Allocate(0) == NULL, "Allocate zero bytes");
+
+			void * block = Allocate(100);
+			test->UnitTest(block != NULL, "Allocate block");
+			test->UnitTest(((std::size_t)block % DefaultAlignment) == 0, "Default alignment");
+			test->UnitTest(GetAllocationSize(block) == 100, "Allocation size");
+
+			void * aligned = Allocate(10, 64);
+			test->UnitTest(((std::size_t)aligned % 64) == 0, "Requested alignment");
+
+			AllocationStats during = GetAllocationStats();
+			test->UnitTest(during.currentBytes - before.currentBytes == 110, "Current bytes");
+			test->UnitTest(during.currentAllocations - before.currentAllocations == 2, "Current allocations");
+			test->UnitTest(during.totalAllocations - before.totalAllocations == 2, "Total allocations");
+			test->UnitTest(during.peakBytes >= during.currentBytes, "Peak bytes");
+
+			Free(block);
+			Free(aligned);
+			Free(NULL);
+
+			AllocationStats after = GetAllocationStats();
+			test->UnitTest(after.currentBytes == before.currentBytes, "Current bytes after free");
+			test->UnitTest(after.currentAllocations == before.currentAllocations, "Current allocations after free");
+			test->UnitTest(after.totalFrees - before.totalFrees == 2, "Total frees");
+			test->UnitTest(after.totalBytes - before.totalBytes == 110, "Total bytes");
+
+			//custom allocator
+			CountingAllocator counting;
+			SetAllocator(&counting);
+			test->UnitTest(GetAllocator() == &counting, "Set allocator");
+
+			block = Allocate(32);
+			test->UnitTest(counting.allocations == 1, "Custom allocator used");
+
+			SetAllocator(NULL);
+			test->UnitTest(GetAllocator() != &counting, "Reset allocator");
+
+			//memory goes back to the allocator that created it
+			Free(block);
+			test->UnitTest(counting.deallocations == 1, "Free uses creating allocator");
+
+			//arrays and objects
+			Counted * array = AllocateArray<Counted>(5);
+			test->UnitTest(Counted::alive == 5 && array[4].value == 7, "Array constructed");
+			FreeArray(array);
+			test->UnitTest(Counted::alive == 0, "Array destroyed");
+			test->UnitTest(AllocateArray<Counted>(0) == NULL, "Empty array");
+
+			Counted * object = New<Counted>();
+			Counted * copy = New<Counted>(*object);
+			test->UnitTest(Counted::alive == 2 && copy->value == 7, "Objects constructed");
+			Delete(object);
+			Delete(copy);
+			test->UnitTest(Counted::alive == 0, "Objects destroyed");
+
+			//standard containers
+			AllocationStats beforeContainers = GetAllocationStats();
+
+			{
+				std::vector<Counted, StlAllocator<Counted> > vector(10);
+				vector.push_back(Counted());
+				test->UnitTest(Counted::alive == 11, "Vector constructed");
+				test->UnitTest(GetAllocationStats().currentBytes > beforeContainers.currentBytes, "Vector uses the allocator");
+
+				std::map<int, int, std::less<int>, StlAllocator<std::pair<const int, int> > > map;
+				map[1] = 2;
+				map[3] = 4;
+				test->UnitTest(map[3] == 4 && map.size() == 2, "Map with the allocator");
+			}
+
+			test->UnitTest(Counted::alive == 0, "Vector destroyed");
+			test->UnitTest(GetAllocationStats().currentBytes == beforeContainers.currentBytes, "Containers free their memory");
+
+			//an allocator that runs out throws like new does
+			AllocationStats beforeFailing = GetAllocationStats();
+			FailingAllocator failing(0);
+			SetAllocator(&failing);
+
+			test->UnitTest(Allocate(16) == NULL, "Allocate returns NULL on failure");
+
+			bool arrayThrew = false;
+			try { AllocateArray<int>(10); }
+			catch (const std::bad_alloc &) { arrayThrew = true; }
+			test->UnitTest(arrayThrew, "AllocateArray throws on failure");
+
+			bool newThrew = false;
+			try { New<Counted>(); }
+			catch (const std::bad_alloc &) { newThrew = true; }
+			test->UnitTest(newThrew && Counted::alive == 0, "New throws on failure");
+
+			bool stlThrew = false;
+			try { std::vector<int, StlAllocator<int> > vector(10); }
+			catch (const std::bad_alloc &) { stlThrew = true; }
+			test->UnitTest(stlThrew, "StlAllocator throws on failure");
+
+			//the index and vertex arrays are made, the UVs fail
+			failing.allowed = 3;
+			bool geometryThrew = false;
+			RawGeometry * geometry = new RawGeometry();
+			try { geometry->AllocateArrays(10, 30); }
+			catch (const std::bad_alloc &) { geometryThrew = true; }
+			delete geometry;
+			test->UnitTest(geometryThrew, "AllocateArrays throws on failure");
+
+			SetAllocator(NULL);
+			test->UnitTest(GetAllocationStats().currentBytes == beforeFailing.currentBytes, "Nothing leaks when an allocation fails");
+
+			ResetAllocationPeak();
+			test->UnitTest(GetAllocationStats().peakBytes == GetAllocationStats().currentBytes, "Reset peak");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,163 @@
+/**
+* @file AssetStore.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the AssetStore class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "AssetStore.hpp"
+
+#include <map>
+#include <mutex>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		//The store lives at namespace scope. Function local statics are not
+		//initialized in a thread safe way by every compiler we support.
+		namespace
+		{
+			typedef std::map<std::string, std::shared_ptr<const Asset> > AssetMap;
+
+			std::mutex _assetMutex;
+			AssetMap _assets;
+		}
+
+		std::shared_ptr<const Asset> AssetStore::Find(const std::string & key)
+		{
+			std::lock_guard<std::mutex> lock(_assetMutex);
+
+			AssetMap::const_iterator it = _assets.find(key);
+
+			if (it == _assets.end())
+				return std::shared_ptr<const Asset>();
+
+			return it->second;
+		}
+
+		std::shared_ptr<const Asset> AssetStore::Insert(const std::string & key, const std::shared_ptr<const Asset> & asset)
+		{
+			if (!asset)
+				return Find(key);
+
+			std::lock_guard<std::mutex> lock(_assetMutex);
+
+			//if another thread beat us here keep the asset that is already
+			//in the store so everyone shares the same copy.
+			std::pair<AssetMap::iterator, bool> result = _assets.insert(AssetMap::value_type(key, asset));
+
+			return result.first->second;
+		}
+
+		bool AssetStore::Remove(const std::string & key)
+		{
+			std::lock_guard<std::mutex> lock(_assetMutex);
+
+			return _assets.erase(key) > 0;
+		}
+
+		void AssetStore::Clear()
+		{
+			//release the assets outside of the lock so an asset's destructor
+			//can use the store.
+			AssetMap released;
+
+			{
+				std::lock_guard<std::mutex> lock(_assetMutex);
+				released.swap(_assets);
+			}
+		}
+
+		int AssetStore::GetCount()
+		{
+			std::lock_guard<std::mutex> lock(_assetMutex);
+
+			return (int)_assets.size();
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			class TestAsset : public Asset
+			{
+			public:
+				int value;
+
+				TestAsset(int v) : value(v)
+				{}
+			};
+		}
+
+		bool AssetStore::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("AssetStore Tests");
+
+			const std::string key1 = "BIOSky/Test/Asset1";
+			const std::string key2 = "BIOSky/Test/Asset2";
+
+			AssetStore::Remove(key1);
+			AssetStore::Remove(key2);
+
+			int startCount = AssetStore::GetCount();
+
+			test->UnitTest(!AssetStore::Find(key1), "Find missing asset");
+			test->UnitTest(!AssetStore::Get<TestAsset>(key1), "Get missing asset");
+
+			std::shared_ptr<const Asset> first = AssetStore::Insert(key1, std::make_shared<TestAsset>(1));
+			test->UnitTest(AssetStore::GetCount() == startCount + 1, "Count after insert");
+
+			std::shared_ptr<const TestAsset> found = AssetStore::Get<TestAsset>(key1);
+			test->UnitTest(found && found->value == 1, "Get inserted asset");
+			test->UnitTest(found.get() == first.get(), "Get returns the stored asset");
+
+			//second insert under the same key keeps the first asset
+			std::shared_ptr<const Asset> second = AssetStore::Insert(key1, std::make_shared<TestAsset>(2));
+			test->UnitTest(second.get() == first.get(), "Insert keeps existing asset");
+			test->UnitTest(AssetStore::Get<TestAsset>(key1)->value == 1, "Existing asset value unchanged");
+			test->UnitTest(AssetStore::GetCount() == startCount + 1, "Count after duplicate insert");
+
+			AssetStore::Insert(key2, std::make_shared<TestAsset>(3));
+			test->UnitTest(AssetStore::GetCount() == startCount + 2, "Count after second insert");
+
+			test->UnitTest(AssetStore::Remove(key1), "Remove existing asset");
+			test->UnitTest(!AssetStore::Remove(key1), "Remove missing asset");
+			test->UnitTest(!AssetStore::Find(key1), "Removed asset not found");
+			test->UnitTest(found->value == 1, "Removed asset still referenced");
+
+			test->UnitTest(AssetStore::Remove(key2), "Remove second asset");
+			test->UnitTest(AssetStore::GetCount() == startCount, "Count after remove");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -35,6 +35,12 @@
 
 #include "BIOSkyFunctions.hpp"
 #include "MathUtils.hpp"
+#include "AssetStore.hpp"
+#include "DomeGeometryBuilder.hpp"
+#include "Planets.hpp"
+#include "Ephemeris.hpp"
+#include "SkyEvents.hpp"
+#include "SkyTrace.hpp"
 
 #include "lodepng.h"
 //#include <iostream>
@@ -44,7 +50,10 @@
 #include "../source/NightSky_C.c"
 //#include "ImageData.hpp"
 
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
+#include <string>
 
 #include <iostream>//needed for testing functions
 #if BIOSKY_TESTING == 1
@@ -52,137 +61,283 @@
 #include "DateTime.hpp"
 #include "GPS.hpp"
 #include "Sky.hpp"
+#include "SkyDomeLODSet.hpp"
+#include "SkyCalculatedAsync.hpp"
+#include "SkyCommandQueue.hpp"
+#include "SkyPerfCounters.hpp"
+#include "GeometryBuffer.hpp"
+#include <thread>
+#include <vector>
 #endif
 
 namespace BIO
 {
 	namespace SKY
 	{
-		float CalculateMoonPhase(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year)
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//				Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
 		{
-			float UT = standardTime - UTCoffset;	// universal time
+			//The sky functions all work from d, the days since 2000 Jan 0.0
+			//UT, and UT, the universal time of day in hours. d is kept in
+			//double until the angles are reduced so a Timestamp keeps its
+			//precision far from 2000.
 
-			float d = (float)DaysSinceJan02000(month, day, year);
-			d = d + (UT / 24.0f);
-
-			//Moon Phase from: http://www.aphayes.pwp.blueyonder.co.uk/library/moon.js
-
-			//float j = d + 2451544.5;
-			float T = (d - 1.5f) / 36525;
-			float T2 = T*T;
-			float T3 = T2*T;
-			float T4 = T3*T;
-			// Moons mean elongation Meeus second edition
-			float D = 297.8501921f + 445267.1114034f*T - 0.0018819f*T2 + T3 / 545868.0f - T4 / 113065000.0f;
-			// Moons mean anomaly M' Meeus second edition
-			float MP = 134.9633964f + 477198.8675055f*T + 0.0087414f*T2 + T3 / 69699.0f - T4 / 14712000.0f;
-			// Suns mean anomaly
-			float M = 357.5291092f + 35999.0502909f*T - 0.0001536f*T2 + T3 / 24490000.0f;
-			// phase angle
-			//float pa = 180.0 - D - 6.289*sin(MP*MATH::DegreesToRadiansf) + 2.1*sin(M* MATH::DegreesToRadiansf) - 1.274*sin((2 * D - MP) * MATH::DegreesToRadiansf) - 0.658*sin((2 * D) * MATH::DegreesToRadiansf) - 0.214*sin((2 * MP) * MATH::DegreesToRadiansf) - 0.11*sin(D*MATH::DegreesToRadiansf);
-			//modified
-			float pa = 0.0f + D + 6.289f*sin(MP*MATH::DegreesToRadiansf) - 2.1f*sin(M* MATH::DegreesToRadiansf) + 1.274f*sin((2 * D - MP) * MATH::DegreesToRadiansf) + 0.658f*sin((2 * D) * MATH::DegreesToRadiansf) + 0.214f*sin((2 * MP) * MATH::DegreesToRadiansf) + 0.11f*sin(D*MATH::DegreesToRadiansf);
-			return MATH::RevolutionReductionDegrees(pa);
-		}
+			float _CalculateMoonPhase(double d)
+			{
+				//Moon Phase from: http://www.aphayes.pwp.blueyonder.co.uk/library/moon.js
+
+				//float j = d + 2451544.5;
+				//the angles grow fast so they are reduced in double
+				double T = (d - 1.5) / 36525;
+				double T2 = T*T;
+				double T3 = T2*T;
+				double T4 = T3*T;
+				// Moons mean elongation Meeus second edition
+				float D = (float)MATH::RevolutionReductionDegrees(297.8501921 + 445267.1114034*T - 0.0018819*T2 + T3 / 545868.0 - T4 / 113065000.0);
+				// Moons mean anomaly M' Meeus second edition
+				float MP = (float)MATH::RevolutionReductionDegrees(134.9633964 + 477198.8675055*T + 0.0087414*T2 + T3 / 69699.0 - T4 / 14712000.0);
+				// Suns mean anomaly
+				float M = (float)MATH::RevolutionReductionDegrees(357.5291092 + 35999.0502909*T - 0.0001536*T2 + T3 / 24490000.0);
+				// phase angle
+				//float pa = 180.0 - D - 6.289*sin(MP*MATH::DegreesToRadiansf) + 2.1*sin(M* MATH::DegreesToRadiansf) - 1.274*sin((2 * D - MP) * MATH::DegreesToRadiansf) - 0.658*sin((2 * D) * MATH::DegreesToRadiansf) - 0.214*sin((2 * MP) * MATH::DegreesToRadiansf) - 0.11*sin(D*MATH::DegreesToRadiansf);
+				//modified
+				float pa = 0.0f + D + 6.289f*sin(MP*MATH::DegreesToRadiansf) - 2.1f*sin(M* MATH::DegreesToRadiansf) + 1.274f*sin((2 * D - MP) * MATH::DegreesToRadiansf) + 0.658f*sin((2 * D) * MATH::DegreesToRadiansf) + 0.214f*sin((2 * MP) * MATH::DegreesToRadiansf) + 0.11f*sin(D*MATH::DegreesToRadiansf);
+				return MATH::RevolutionReductionDegrees(pa);
+			}
 
-		SkyPosition CalculateMoonPosition(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude)
-		{
-			//Method from http://www.stjarnhimlen.se/comp/ppcomp.html
-			// by: Paul Schlyter, Stockholm, Sweden
+			SkyPosition _CalculateMoonPosition(double d, float UT, float latitude, float longitude)
+			{
+				//Method from http://www.stjarnhimlen.se/comp/ppcomp.html
+				// by: Paul Schlyter, Stockholm, Sweden
 
-			//int monthint = Date::MonthToInt(month);
-			float UT = standardTime - UTCoffset;	// universal time
-			//
-			float d = (float)DaysSinceJan02000(month, day, year);//(float)(367 * (int)year - (7 * ((int)year + ((monthint + 9) / 12))) / 4 + (275 * monthint) / 9 + (int)day - 730530);
-			d = d + (UT / 24.0f);
-
-			//Calculate the Moon Position ----------------------------------------------
-			float N = MATH::RevolutionReductionDegrees(125.1228f - 0.0529538083f  * d);//in degrees (Long asc.node)
-			float i = 5.1454f;//In degrees (Inclination)
-			float w = MATH::RevolutionReductionDegrees(318.0634f + 0.1643573223f  * d);//in degrees (Arg.of perigee)
-			float a = 60.2666f;//                                (Mean distance)
-			float e = 0.054900f;//                               (Eccentricity)
-			float M = MATH::RevolutionReductionDegrees(115.3654f + 13.0649929509f * d);//in degrees (Mean anomaly)
-
-			//BIO_LOG_CRITICAL(std::endl <<
-			//	"N: " << N << std::endl <<
-			//	"i: " << i << std::endl <<
-			//	"w: " << w << std::endl <<
-			//	"a: " << a << std::endl <<
-			//	"e: " << e << std::endl <<
-			//	"M: " << M << std::endl
-			//	);
-
-			float E = M + (180 / MATH::PIf) * e * sin(M * MATH::DegreesToRadiansf) * (1 + e * cos(M * MATH::DegreesToRadiansf));//in degrees
-			//BIO_LOG_CRITICAL("E0: " << E);
-
-			float x = a * (cos(E * MATH::DegreesToRadiansf) - e);
-			float y = a * sqrt(1 - e*e) * sin(E * MATH::DegreesToRadiansf);
-			//BIO_LOG_CRITICAL("x: " << x << " y: " << y);
-
-			float r = sqrt(x*x + y*y);// = 60.67134 Earth radii
-			float v = MATH::RevolutionReductionDegrees(atan2(y, x) * MATH::RadiansToDegreesf);// in degrees = 259.8605_deg
-			//BIO_LOG_CRITICAL("r: " << r << " v: " << v);
-
-			float xeclip = r * (cos(N* MATH::DegreesToRadiansf) * cos((v + w)* MATH::DegreesToRadiansf) - sin(N* MATH::DegreesToRadiansf) * sin((v + w)* MATH::DegreesToRadiansf) * cos(i* MATH::DegreesToRadiansf));
-			float yeclip = r * (sin(N* MATH::DegreesToRadiansf) * cos((v + w) * MATH::DegreesToRadiansf) + cos(N* MATH::DegreesToRadiansf) * sin((v + w)* MATH::DegreesToRadiansf) * cos(i* MATH::DegreesToRadiansf));
-			float zeclip = r * sin((v + w)* MATH::DegreesToRadiansf) * sin(i* MATH::DegreesToRadiansf);
-			//BIO_LOG_CRITICAL("xeclip: " << xeclip << " yeclip: " << yeclip << " zeclip: " << zeclip);
-
-			//geocentric longetude and latitude
-			float lonecl = atan2(yeclip, xeclip) * MATH::RadiansToDegreesf;//in degrees
-			float latecl = atan2(zeclip, sqrt(xeclip*xeclip + yeclip*yeclip))* MATH::RadiansToDegreesf;//in degrees
-			//BIO_LOG_CRITICAL("lonecl: " << lonecl << " latecl: " << latecl);
-
-			float xh = r * cos(lonecl * MATH::DegreesToRadiansf) * cos(latecl * MATH::DegreesToRadiansf);
-			float yh = r * sin(lonecl * MATH::DegreesToRadiansf) * cos(latecl * MATH::DegreesToRadiansf);
-			float zh = r * sin(latecl * MATH::DegreesToRadiansf);
-
-			float ecl = 23.4393f - 3.563E-7f * d; //in degrees
-
-			float xequat = xh;
-			float yequat = yh * cos(ecl * MATH::DegreesToRadiansf) - zh * sin(ecl * MATH::DegreesToRadiansf);
-			float zequat = yh * sin(ecl * MATH::DegreesToRadiansf) + zh * cos(ecl * MATH::DegreesToRadiansf);
-
-			float RA = MATH::RevolutionReductionDegrees(atan2(yequat, xequat) * MATH::RadiansToDegreesf); //in degrees
-			float Dec = atan2(zequat, sqrt(xequat*xequat + yequat*yequat)) * MATH::RadiansToDegreesf; //in degrees
-			
-			//BIO_LOG_CRITICAL("RA: " << RA << " Dec: " << Dec);
+				//Calculate the Moon Position ----------------------------------------------
+				float N = (float)MATH::RevolutionReductionDegrees(125.1228 - 0.0529538083  * d);//in degrees (Long asc.node)
+				float i = 5.1454f;//In degrees (Inclination)
+				float w = (float)MATH::RevolutionReductionDegrees(318.0634 + 0.1643573223  * d);//in degrees (Arg.of perigee)
+				float a = 60.2666f;//                                (Mean distance)
+				float e = 0.054900f;//                               (Eccentricity)
+				float M = (float)MATH::RevolutionReductionDegrees(115.3654 + 13.0649929509 * d);//in degrees (Mean anomaly)
 
-			float ws = MATH::RevolutionReductionDegrees(282.9404f + 4.70935E-5f   * d); //in degrees (longitude of perihelion)
-			float Ms = MATH::RevolutionReductionDegrees(356.0470f + 0.9856002585f * d);//in degrees (mean anomaly)
+				//BIO_LOG_CRITICAL(std::endl <<
+				//	"N: " << N << std::endl <<
+				//	"i: " << i << std::endl <<
+				//	"w: " << w << std::endl <<
+				//	"a: " << a << std::endl <<
+				//	"e: " << e << std::endl <<
+				//	"M: " << M << std::endl
+				//	);
 
-			float L = MATH::RevolutionReductionDegrees(ws + Ms);//mean longitude in degrees
-			//BIO_LOG_CRITICAL("L: " << L);
+				float E = M + (180 / MATH::PIf) * e * sin(M * MATH::DegreesToRadiansf) * (1 + e * cos(M * MATH::DegreesToRadiansf));//in degrees
+				//BIO_LOG_CRITICAL("E0: " << E);
 
-			float GMST0 = (L / 15.0f) + 12.0f;//in hours
-			//BIO_LOG_CRITICAL("GMST0: " << GMST0);
-			//float GMST = GMST0 + UT;//in hours
+				float x = a * (cos(E * MATH::DegreesToRadiansf) - e);
+				float y = a * sqrt(1 - e*e) * sin(E * MATH::DegreesToRadiansf);
+				//BIO_LOG_CRITICAL("x: " << x << " y: " << y);
 
-			//BIO_LOG_CRITICAL("GMST0: " << GMST0);
+				float r = sqrt(x*x + y*y);// = 60.67134 Earth radii
+				float v = MATH::RevolutionReductionDegrees(atan2(y, x) * MATH::RadiansToDegreesf);// in degrees = 259.8605_deg
+				//BIO_LOG_CRITICAL("r: " << r << " v: " << v);
 
-			float SIDTIME = GMST0 + UT + (longitude * MATH::RadiansToDegreesf) / 15.0f;
-			//BIO_LOG_CRITICAL("SIDTIME: " << SIDTIME);
+				float xeclip = r * (cos(N* MATH::DegreesToRadiansf) * cos((v + w)* MATH::DegreesToRadiansf) - sin(N* MATH::DegreesToRadiansf) * sin((v + w)* MATH::DegreesToRadiansf) * cos(i* MATH::DegreesToRadiansf));
+				float yeclip = r * (sin(N* MATH::DegreesToRadiansf) * cos((v + w) * MATH::DegreesToRadiansf) + cos(N* MATH::DegreesToRadiansf) * sin((v + w)* MATH::DegreesToRadiansf) * cos(i* MATH::DegreesToRadiansf));
+				float zeclip = r * sin((v + w)* MATH::DegreesToRadiansf) * sin(i* MATH::DegreesToRadiansf);
+				//BIO_LOG_CRITICAL("xeclip: " << xeclip << " yeclip: " << yeclip << " zeclip: " << zeclip);
 
-			float HA = MATH::RevolutionReductionDegrees((SIDTIME * 15.0f) - RA);//in degrees
-			//BIO_LOG_CRITICAL("HA: " << HA);
+				//geocentric longetude and latitude
+				float lonecl = atan2(yeclip, xeclip) * MATH::RadiansToDegreesf;//in degrees
+				float latecl = atan2(zeclip, sqrt(xeclip*xeclip + yeclip*yeclip))* MATH::RadiansToDegreesf;//in degrees
+				//BIO_LOG_CRITICAL("lonecl: " << lonecl << " latecl: " << latecl);
 
-			x = cos(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
-			y = sin(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
-			float z = sin(Dec * MATH::DegreesToRadiansf);
+				float xh = r * cos(lonecl * MATH::DegreesToRadiansf) * cos(latecl * MATH::DegreesToRadiansf);
+				float yh = r * sin(lonecl * MATH::DegreesToRadiansf) * cos(latecl * MATH::DegreesToRadiansf);
+				float zh = r * sin(latecl * MATH::DegreesToRadiansf);
 
-			float xhor = x * sin(latitude) - z * cos(latitude);
-			float yhor = y;
-			float zhor = x * cos(latitude) + z * sin(latitude);
+				float ecl = (float)(23.4393 - 3.563E-7 * d); //in degrees
 
-			float azimuth = atan2(yhor, xhor) + MATH::PIf;
-			float altitude = asin(zhor);
-			//--------------------------------------------------------------------------
+				float xequat = xh;
+				float yequat = yh * cos(ecl * MATH::DegreesToRadiansf) - zh * sin(ecl * MATH::DegreesToRadiansf);
+				float zequat = yh * sin(ecl * MATH::DegreesToRadiansf) + zh * cos(ecl * MATH::DegreesToRadiansf);
 
-			//(*v_out) = v;
+				float RA = MATH::RevolutionReductionDegrees(atan2(yequat, xequat) * MATH::RadiansToDegreesf); //in degrees
+				float Dec = atan2(zequat, sqrt(xequat*xequat + yequat*yequat)) * MATH::RadiansToDegreesf; //in degrees
+				
+				//BIO_LOG_CRITICAL("RA: " << RA << " Dec: " << Dec);
 
-			return SkyPosition(azimuth, MATH::PId2f - altitude);
-			
+				float ws = (float)MATH::RevolutionReductionDegrees(282.9404 + 4.70935E-5   * d); //in degrees (longitude of perihelion)
+				float Ms = (float)MATH::RevolutionReductionDegrees(356.0470 + 0.9856002585 * d);//in degrees (mean anomaly)
+
+				float L = MATH::RevolutionReductionDegrees(ws + Ms);//mean longitude in degrees
+				//BIO_LOG_CRITICAL("L: " << L);
+
+				float GMST0 = (L / 15.0f) + 12.0f;//in hours
+				//BIO_LOG_CRITICAL("GMST0: " << GMST0);
+				//float GMST = GMST0 + UT;//in hours
+
+				//BIO_LOG_CRITICAL("GMST0: " << GMST0);
+
+				float SIDTIME = GMST0 + UT + (longitude * MATH::RadiansToDegreesf) / 15.0f;
+				//BIO_LOG_CRITICAL("SIDTIME: " << SIDTIME);
+
+				float HA = MATH::RevolutionReductionDegrees((SIDTIME * 15.0f) - RA);//in degrees
+				//BIO_LOG_CRITICAL("HA: " << HA);
+
+				x = cos(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
+				y = sin(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
+				float z = sin(Dec * MATH::DegreesToRadiansf);
+
+				float xhor = x * sin(latitude) - z * cos(latitude);
+				float yhor = y;
+				float zhor = x * cos(latitude) + z * sin(latitude);
+
+				float azimuth = atan2(yhor, xhor) + MATH::PIf;
+				float altitude = asin(zhor);
+				//--------------------------------------------------------------------------
+
+				//(*v_out) = v;
+
+				return SkyPosition(azimuth, MATH::PId2f - altitude);
+				
+			}
+
+			SkyPosition _CalculateSunPosition(double d, float UT, float latitude, float longitude)
+			{
+				//Method from http://www.stjarnhimlen.se/comp/ppcomp.html
+				// by: Paul Schlyter, Stockholm, Sweden
+				float w = (float)MATH::RevolutionReductionDegrees(282.9404 + 4.70935E-5   * d); //in degrees (longitude of perihelion)
+				float a = 1.000000f;//mean distance in a.u.
+				float e = (float)(0.016709 - 1.151E-9 * d); //(eccentricity)
+				float M = (float)MATH::RevolutionReductionDegrees(356.0470 + 0.9856002585 * d);//in degrees (mean anomaly)
+
+				float oblecl = (float)MATH::RevolutionReductionDegrees(23.4393 - 3.563E-7 * d);//in degrees
+				float L = MATH::RevolutionReductionDegrees(w + M);//mean longitude in degrees
+
+				float E = M + (180 / MATH::PIf) * e * sin(M * MATH::DegreesToRadiansf) * (1 + e * cos(M*MATH::DegreesToRadiansf));//in degrees
+				E = MATH::RevolutionReductionDegrees(E);
+				//BIO_LOG_CRITICAL("E: " << E);
+
+				float x = cos(E * MATH::DegreesToRadiansf) - e;
+				float y = sin(E * MATH::DegreesToRadiansf) * sqrt(1 - e*e);
+
+				//BIO_LOG_CRITICAL("x: " << x << " y: " << y);
+
+				float r = sqrt(x*x + y*y);
+				float v = atan2(y, x) * MATH::RadiansToDegreesf;//in degrees
+
+				//BIO_LOG_CRITICAL("r: " << r << " v: " << v);
+
+				//--------------------------------------------------------------------------------
+				//--------------------------------------------------------------------------------
+				//--------------------------------------------------------------------------------
+				//
+				//				Need lon for moon phase
+				//
+				//--------------------------------------------------------------------------------
+				//--------------------------------------------------------------------------------
+				//--------------------------------------------------------------------------------
+				float lon = MATH::RevolutionReductionDegrees(v + w);//longitude of sun in degrees
+
+				//BIO_LOG_CRITICAL("long: " << lon);
+
+				x = r * cos(lon * MATH::DegreesToRadiansf);//geocentric longitude
+				y = r * sin(lon * MATH::DegreesToRadiansf);//geocentric latitude
+				float z = 0.0;//sun is always zero
+
+				//BIO_LOG_CRITICAL("x: " << x << " y: " << y << " z: " << z);
+
+				float xequat = x;
+				float yequat = y * cos(23.4406f * MATH::DegreesToRadiansf) - z * sin(23.4406f * MATH::DegreesToRadiansf);
+				float zequat = y * sin(23.4406f * MATH::DegreesToRadiansf) + z * cos(23.4406f * MATH::DegreesToRadiansf);
+
+				//BIO_LOG_CRITICAL("xequat: " << xequat << " yequat: " << yequat << " zequat: " << zequat);
+
+				float RA = atan2(yequat, xequat) * MATH::RadiansToDegreesf; //In Degrees 
+				float Dec = atan2(zequat, sqrt(xequat*xequat + yequat*yequat)) * MATH::RadiansToDegreesf;//in Degrees
+				//BIO_LOG_CRITICAL("RA: " << RA << " Dec: " << Dec);
+
+				float GMST0 = (L / 15.0f) + 12.0f;//in hours
+				//float GMST = GMST0 + UT;//in hours
+
+				//BIO_LOG_CRITICAL("GMST0: " << GMST0);
+
+				float SIDTIME = GMST0 + UT + (longitude * MATH::RadiansToDegreesf) / 15.0f;
+
+				//BIO_LOG_CRITICAL("SidTime: " << SIDTIME);
+
+				float HA = (SIDTIME * 15.0f) - RA;//ha is in degrees
+
+				//BIO_LOG_CRITICAL("HA: " << HA);
+
+				x = cos(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
+				y = sin(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
+				z = sin(Dec * MATH::DegreesToRadiansf);
+
+				//BIO_LOG_CRITICAL("x: " << x << " y: " << y << " z: " << z);
+
+				float xhor = x * sin(latitude) - z * cos(latitude);
+				float yhor = y;
+				float zhor = x * cos(latitude) + z * sin(latitude);
+
+				//BIO_LOG_CRITICAL("xhor: " << xhor << " yhor: " << yhor << " zhor: " << zhor);
+
+				float azimuth = atan2(yhor, xhor) + MATH::PIf;
+				float altitude = asin(zhor);//atan2(zhor, sqrt(xhor*xhor + yhor*yhor));
+
+				//BIO_LOG_CRITICAL("azimuth: " << azimuth* MATH::BIO_180_PIf << " altitude: " << altitude* MATH::BIO_180_PIf);
+
+				return SkyPosition(azimuth, MATH::PId2f - altitude);
+			}
+
+			SkyData _CalculateSkyData(double d, float UT, float latitude, float longitude)
+			{
+				SkyData rtn;
+
+				rtn.moonPos = _CalculateMoonPosition(d, UT, latitude, longitude);
+
+				rtn.sunPos = _CalculateSunPosition(d, UT, latitude, longitude);
+
+				rtn.northStarZenith = CalculateCelestialNorthPoleZenith(latitude);
+
+				rtn.starRotation = CalculateStarRotation(UT, 0.0f);
+
+				rtn.phase = _CalculateMoonPhase(d);
+
+				rtn.moonVisibility = CalculateMoonVisibility(
+					rtn.sunPos.Azimuth, rtn.sunPos.Zenith,
+					rtn.moonPos.Azimuth, rtn.moonPos.Zenith);
+
+				return rtn;
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		float CalculateMoonPhase(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year)
+		{
+			float UT = standardTime - UTCoffset;	// universal time
+
+			return _CalculateMoonPhase(DaysSinceJan02000(month, day, year) + UT / 24.0);
+		}
+
+		float CalculateMoonPhase(const Timestamp & time)
+		{
+			return _CalculateMoonPhase(time.GetDaysSinceJan02000());
+		}
+
+		SkyPosition CalculateMoonPosition(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude)
+		{
+			float UT = standardTime - UTCoffset;	// universal time
+
+			return _CalculateMoonPosition(DaysSinceJan02000(month, day, year) + UT / 24.0, UT, latitude, longitude);
+		}
+
+		SkyPosition CalculateMoonPosition(const Timestamp & time, float latitude, float longitude)
+		{
+			return _CalculateMoonPosition(time.GetDaysSinceJan02000(), (float)time.GetUniversalTimeHours(), latitude, longitude);
 		}
 
 		float CalculateMoonVisibility(float SunAzimuth, float SunZenith, float MoonAzimuth, float MoonZenith)
@@ -203,23 +358,14 @@ namespace BIO
 
 		SkyData CalculateSkyData(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude)
 		{
-			SkyData rtn;
-
-			rtn.moonPos = CalculateMoonPosition(standardTime, UTCoffset, month, day, year, latitude, longitude);
-
-			rtn.sunPos = CalculateSunPosition(standardTime, UTCoffset, month, day, year, latitude, longitude);
-
-			rtn.northStarZenith = CalculateCelestialNorthPoleZenith(latitude);
-			
-			rtn.starRotation = CalculateStarRotation(standardTime, UTCoffset);
-
-			rtn.phase = CalculateMoonPhase(standardTime, UTCoffset, month, day, year);
+			float UT = standardTime - UTCoffset;	// universal time
 
-			rtn.moonVisibility = CalculateMoonVisibility(
-				rtn.sunPos.Azimuth, rtn.sunPos.Zenith, 
-				rtn.moonPos.Azimuth, rtn.moonPos.Zenith);
+			return _CalculateSkyData(DaysSinceJan02000(month, day, year) + UT / 24.0, UT, latitude, longitude);
+		}
 
-			return rtn;
+		SkyData CalculateSkyData(const Timestamp & time, float latitude, float longitude)
+		{
+			return _CalculateSkyData(time.GetDaysSinceJan02000(), (float)time.GetUniversalTimeHours(), latitude, longitude);
 		}
 
 		/*
@@ -250,115 +396,120 @@ namespace BIO
 
 		SkyPosition CalculateSunPosition(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude)
 		{
-			//Method from http://www.stjarnhimlen.se/comp/ppcomp.html
-			// by: Paul Schlyter, Stockholm, Sweden
-			//int monthint = Date::MonthToInt(month);
 			float UT = standardTime - UTCoffset;	// universal time
-			//
-			float d = (float)DaysSinceJan02000(month, day, year);//(float)(367 * (int)year - (7 * ((int)year + ((monthint + 9) / 12))) / 4 + (275 * monthint) / 9 + (int)day - 730530);
-			d = d + (UT / 24.0f);
 
-			float w = MATH::RevolutionReductionDegrees(282.9404f + 4.70935E-5f   * d); //in degrees (longitude of perihelion)
-			float a = 1.000000f;//mean distance in a.u.
-			float e = 0.016709f - 1.151E-9f * d; //(eccentricity)
-			float M = MATH::RevolutionReductionDegrees(356.0470f + 0.9856002585f * d);//in degrees (mean anomaly)
-
-			float oblecl = MATH::RevolutionReductionDegrees(23.4393f - 3.563E-7f * d);//in degrees
-			float L = MATH::RevolutionReductionDegrees(w + M);//mean longitude in degrees
-
-			float E = M + (180 / MATH::PIf) * e * sin(M * MATH::DegreesToRadiansf) * (1 + e * cos(M*MATH::DegreesToRadiansf));//in degrees
-			E = MATH::RevolutionReductionDegrees(E);
-			//BIO_LOG_CRITICAL("E: " << E);
+			return _CalculateSunPosition(DaysSinceJan02000(month, day, year) + UT / 24.0, UT, latitude, longitude);
+		}
 
-			float x = cos(E * MATH::DegreesToRadiansf) - e;
-			float y = sin(E * MATH::DegreesToRadiansf) * sqrt(1 - e*e);
+		SkyPosition CalculateSunPosition(const Timestamp & time, float latitude, float longitude)
+		{
+			return _CalculateSunPosition(time.GetDaysSinceJan02000(), (float)time.GetUniversalTimeHours(), latitude, longitude);
+		}
 
-			//BIO_LOG_CRITICAL("x: " << x << " y: " << y);
+		float CalculateStarRotation(float standardTime, float UTCoffset)
+		{
+			//15 degrees in radians.
+			const float _15Degrees = 0.2617993878f;//15.0f * MATH::DegreesToRadiansf;
 
-			float r = sqrt(x*x + y*y);
-			float v = atan2(y, x) * MATH::RadiansToDegreesf;//in degrees
+			float UT = standardTime - UTCoffset;	// universal time
 
-			//BIO_LOG_CRITICAL("r: " << r << " v: " << v);
+			//       Time            Degrees       Offset to start
+			//                       per hour      stars at correct spot
+			//    (Universal_Time * 15_Degrees) + 145_Degrees
+			//return (UT * _15Degrees) + (145 * MATH::DegreesToRadiansf);
+			return (UT * _15Degrees) + 2.530727415f;
+		}
 
-			//--------------------------------------------------------------------------------
-			//--------------------------------------------------------------------------------
-			//--------------------------------------------------------------------------------
-			//
-			//				Need lon for moon phase
-			//
-			//--------------------------------------------------------------------------------
-			//--------------------------------------------------------------------------------
-			//--------------------------------------------------------------------------------
-			float lon = MATH::RevolutionReductionDegrees(v + w);//longitude of sun in degrees
+		float CalculateZenithSkyLuminance(float sunZenith)
+		{
+			//log10 of the zenith luminance of a clear sky for altitudes of
+			//the sun from astronomical twilight up
+			const float altitudes[] = { -18.0f, -12.0f, -6.0f, 0.0f, 10.0f, 30.0f, 90.0f };
+			const float luminance[] = { -3.77f, -2.0f, 0.3f, 2.9f, 3.6f, 3.85f, 4.1f };
+			const int count = sizeof(altitudes) / sizeof(altitudes[0]);
 
-			//BIO_LOG_CRITICAL("long: " << lon);
+			float altitude = 90.0f - sunZenith * (180.0f / MATH::PIf);
 
-			x = r * cos(lon * MATH::DegreesToRadiansf);//geocentric longitude
-			y = r * sin(lon * MATH::DegreesToRadiansf);//geocentric latitude
-			float z = 0.0;//sun is always zero
+			if (altitude <= altitudes[0])
+				return std::pow(10.0f, luminance[0]);
 
-			//BIO_LOG_CRITICAL("x: " << x << " y: " << y << " z: " << z);
+			if (altitude >= altitudes[count - 1])
+				return std::pow(10.0f, luminance[count - 1]);
 
-			float xequat = x;
-			float yequat = y * cos(23.4406f * MATH::DegreesToRadiansf) - z * sin(23.4406f * MATH::DegreesToRadiansf);
-			float zequat = y * sin(23.4406f * MATH::DegreesToRadiansf) + z * cos(23.4406f * MATH::DegreesToRadiansf);
+			int i = 1;
+			while (altitudes[i] < altitude)
+				i++;
 
-			//BIO_LOG_CRITICAL("xequat: " << xequat << " yequat: " << yequat << " zequat: " << zequat);
+			float t = (altitude - altitudes[i - 1]) / (altitudes[i] - altitudes[i - 1]);
 
-			float RA = atan2(yequat, xequat) * MATH::RadiansToDegreesf; //In Degrees 
-			float Dec = atan2(zequat, sqrt(xequat*xequat + yequat*yequat)) * MATH::RadiansToDegreesf;//in Degrees
-			//BIO_LOG_CRITICAL("RA: " << RA << " Dec: " << Dec);
+			return std::pow(10.0f, luminance[i - 1] + (luminance[i] - luminance[i - 1]) * t);
+		}
 
-			float GMST0 = (L / 15.0f) + 12.0f;//in hours
-			//float GMST = GMST0 + UT;//in hours
+		float CalculateLimitingMagnitude(float skyLuminance)
+		{
+			//nothing is darker than the natural glow of the night sky
+			if (skyLuminance < 0.00001f)
+				skyLuminance = 0.00001f;
 
-			//BIO_LOG_CRITICAL("GMST0: " << GMST0);
+			//the brightness of the sky in magnitudes per square arc second
+			float skyMagnitude = 12.58f - 2.5f * std::log10(skyLuminance);
 
-			float SIDTIME = GMST0 + UT + (longitude * MATH::RadiansToDegreesf) / 15.0f;
+			return 7.93f - 5.0f * std::log10(std::pow(10.0f, 4.316f - skyMagnitude / 5.0f) + 1.0f);
+		}
 
-			//BIO_LOG_CRITICAL("SidTime: " << SIDTIME);
+		void GetSkyDomeGeometrySize(int numVerticalSegments, int numHorozontalSegments, bool fullDome, int * numVertecies, int * numIndecies)
+		{
+			//is the numHorozontalSegments even
+			if (numHorozontalSegments % 2 != 0)
+				numHorozontalSegments += 1;
 
-			float HA = (SIDTIME * 15.0f) - RA;//ha is in degrees
+			int totalVerts = 0;
+			int totalTris = 0;
 
-			//BIO_LOG_CRITICAL("HA: " << HA);
+			if (fullDome)
+			{
+				totalVerts = ((numHorozontalSegments - 1) * numVerticalSegments) + 2;
+				totalTris = 2 * numVerticalSegments * (numHorozontalSegments - 1);
+			}
+			else
+			{
+				totalVerts = (numHorozontalSegments * numVerticalSegments) + 1;
+				totalTris = ((numHorozontalSegments - 1) * 2 * numVerticalSegments) + numVerticalSegments;
+			}
 
-			x = cos(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
-			y = sin(HA * MATH::DegreesToRadiansf) * cos(Dec * MATH::DegreesToRadiansf);
-			z = sin(Dec * MATH::DegreesToRadiansf);
+			if (numVertecies)
+				(*numVertecies) = totalVerts;
 
-			//BIO_LOG_CRITICAL("x: " << x << " y: " << y << " z: " << z);
+			if (numIndecies)
+				(*numIndecies) = totalTris * 3;
+		}
 
-			float xhor = x * sin(latitude) - z * cos(latitude);
-			float yhor = y;
-			float zhor = x * cos(latitude) + z * sin(latitude);
+		RawGeometry * CreateSkyDomeGeometry(float radius, int numVerticalSegments, int numHorozontalSegments, bool fullDome)
+		{
+			RawGeometry * rtnValue = new RawGeometry();
 
-			//BIO_LOG_CRITICAL("xhor: " << xhor << " yhor: " << yhor << " zhor: " << zhor);
+			int totalVerts = 0;
+			int totalIndecies = 0;
+			GetSkyDomeGeometrySize(numVerticalSegments, numHorozontalSegments, fullDome, &totalVerts, &totalIndecies);
 
-			float azimuth = atan2(yhor, xhor) + MATH::PIf;
-			float altitude = asin(zhor);//atan2(zhor, sqrt(xhor*xhor + yhor*yhor));
+			rtnValue->AllocateArrays(totalVerts, totalIndecies);
 
-			//BIO_LOG_CRITICAL("azimuth: " << azimuth* MATH::BIO_180_PIf << " altitude: " << altitude* MATH::BIO_180_PIf);
+			CreateSkyDomeGeometry(radius, numVerticalSegments, numHorozontalSegments, fullDome,
+				rtnValue->vertecies, rtnValue->UVTextureCoordinates, rtnValue->numVertecies,
+				rtnValue->indecies, rtnValue->numIndecies);
 
-			return SkyPosition(azimuth, MATH::PId2f - altitude);
+			return rtnValue;
 		}
 
-		float CalculateStarRotation(float standardTime, float UTCoffset)
+		bool CreateSkyDomeGeometry(float radius, int numVerticalSegments, int numHorozontalSegments, bool fullDome, Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, unsigned short * indecies, int numIndecies)
 		{
-			//15 degrees in radians.
-			const float _15Degrees = 0.2617993878f;//15.0f * MATH::DegreesToRadiansf;
+			int requiredVerts = 0;
+			int requiredIndecies = 0;
+			GetSkyDomeGeometrySize(numVerticalSegments, numHorozontalSegments, fullDome, &requiredVerts, &requiredIndecies);
 
-			float UT = standardTime - UTCoffset;	// universal time
-
-			//       Time            Degrees       Offset to start
-			//                       per hour      stars at correct spot
-			//    (Universal_Time * 15_Degrees) + 145_Degrees
-			//return (UT * _15Degrees) + (145 * MATH::DegreesToRadiansf);
-			return (UT * _15Degrees) + 2.530727415f;
-		}
-
-		RawGeometry * CreateSkyDomeGeometry(float radius, int numVerticalSegments, int numHorozontalSegments, bool fullDome)
-		{
-			RawGeometry * rtnValue = new RawGeometry();
+			if (vertecies == NULL || UVTextureCoordinates == NULL || indecies == NULL ||
+				numVertecies < requiredVerts || numIndecies < requiredIndecies)
+				return false;
 
 			//is the numHorozontalSegments even
 			if (numHorozontalSegments % 2 != 0)
@@ -368,32 +519,23 @@ namespace BIO
 			{
 				//*
 				//Create a sphere
-				int totalVerts = ((numHorozontalSegments - 1) * numVerticalSegments) + 2;
-				rtnValue->numVertecies = totalVerts;
+				int totalVerts = requiredVerts;
 
-				int totalTris = 2 * numVerticalSegments * (numHorozontalSegments - 1);
-				int totalIndecies = totalTris * 3;
-				rtnValue->numIndecies = totalIndecies;
-
-				rtnValue->indecies = new unsigned short[totalIndecies];
 				int indexOn = 0;
-
-				rtnValue->vertecies = new Vector3D[totalVerts];
-				rtnValue->UVTextureCoordinates = new Vector2D[totalVerts];
 				int vertOn = 0;
 
 				//set the top cap
 				for (int i = 0; i < numVerticalSegments; i++)
 				{
-					rtnValue->indecies[indexOn++] = 0;
-					rtnValue->indecies[indexOn++] = i + 1;
-					rtnValue->indecies[indexOn++] = i + 2;
+					indecies[indexOn++] = 0;
+					indecies[indexOn++] = i + 1;
+					indecies[indexOn++] = i + 2;
 				}
 
 				//fix the last index
 				//doing it this way should be a little faster
 				//than placing an if statment in the for loop
-				rtnValue->indecies[indexOn - 1] = 1;
+				indecies[indexOn - 1] = 1;
 				//Done Setting the top cap -----------------
 
 				//set the horozontal segments
@@ -401,38 +543,38 @@ namespace BIO
 				{
 					for (int j = 0; j < numVerticalSegments; j++)
 					{
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
 
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + 1 + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + 1 + 1;
 					}
 
-					rtnValue->indecies[indexOn - 2] = rtnValue->indecies[indexOn - 4] = (i * numVerticalSegments) + numVerticalSegments + 1;
-					rtnValue->indecies[indexOn - 1] -= numVerticalSegments;
+					indecies[indexOn - 2] = indecies[indexOn - 4] = (i * numVerticalSegments) + numVerticalSegments + 1;
+					indecies[indexOn - 1] -= numVerticalSegments;
 				}
 				//Done Setting the horozontal segments
 
 				//set the bottom cap --------------------------------
 				for (int i = 1; i <= numVerticalSegments; i++)
 				{
-					rtnValue->indecies[indexOn++] = totalVerts - 1;
-					rtnValue->indecies[indexOn++] = totalVerts - 1 - i;
-					rtnValue->indecies[indexOn++] = totalVerts - 2 - i;
+					indecies[indexOn++] = totalVerts - 1;
+					indecies[indexOn++] = totalVerts - 1 - i;
+					indecies[indexOn++] = totalVerts - 2 - i;
 				}
 
 				//fix the last index
 				//doing it this way should be a little faster
 				//than placing an if statment in the for loop
-				rtnValue->indecies[indexOn - 1] = totalVerts - 2;
+				indecies[indexOn - 1] = totalVerts - 2;
 				//Done setting bottom cap ---------------------------
 
 				//create the vertecies ----------------------------------
 				//first vert is at 0,radius,0
-				rtnValue->vertecies[0].X = 0; rtnValue->vertecies[0].Y = radius; rtnValue->vertecies[0].Z = 0;
-				rtnValue->UVTextureCoordinates[0].X = rtnValue->UVTextureCoordinates[0].Y = 0.5f;
+				vertecies[0].X = 0; vertecies[0].Y = radius; vertecies[0].Z = 0;
+				UVTextureCoordinates[0].X = UVTextureCoordinates[0].Y = 0.5f;
 				vertOn++;
 
 				double currHeight = radius;
@@ -459,12 +601,12 @@ namespace BIO
 					double currAngle = 0;
 					for (int j = 0; j < numVerticalSegments; j++)
 					{
-						rtnValue->vertecies[vertOn].X = (float)(currRadius * std::cos(currAngle));
-						rtnValue->vertecies[vertOn].Y = (float)(currHeight);
-						rtnValue->vertecies[vertOn].Z = (float)(currRadius * std::sin(currAngle));
+						vertecies[vertOn].X = (float)(currRadius * std::cos(currAngle));
+						vertecies[vertOn].Y = (float)(currHeight);
+						vertecies[vertOn].Z = (float)(currRadius * std::sin(currAngle));
 
-						rtnValue->UVTextureCoordinates[vertOn].X = (rtnValue->vertecies[vertOn].X / (2 * (radius + rtnValue->vertecies[vertOn].Y))) + 0.5f;
-						rtnValue->UVTextureCoordinates[vertOn].Y = (rtnValue->vertecies[vertOn].Z / (2 * (radius + rtnValue->vertecies[vertOn].Y))) + 0.5f;
+						UVTextureCoordinates[vertOn].X = (vertecies[vertOn].X / (2 * (radius + vertecies[vertOn].Y))) + 0.5f;
+						UVTextureCoordinates[vertOn].Y = (vertecies[vertOn].Z / (2 * (radius + vertecies[vertOn].Y))) + 0.5f;
 						vertOn++;
 
 						currAngle += circleStep;
@@ -472,8 +614,8 @@ namespace BIO
 				}
 
 				//final point
-				rtnValue->vertecies[vertOn].X = 0; rtnValue->vertecies[vertOn].Y = -radius; rtnValue->vertecies[vertOn].Z = 0;
-				rtnValue->UVTextureCoordinates[vertOn].X = rtnValue->UVTextureCoordinates[vertOn].Y = 0.5f;
+				vertecies[vertOn].X = 0; vertecies[vertOn].Y = -radius; vertecies[vertOn].Z = 0;
+				UVTextureCoordinates[vertOn].X = UVTextureCoordinates[vertOn].Y = 0.5f;
 				//Done Creating the vertecies ----------------------------
 				//*/
 			}
@@ -486,57 +628,44 @@ namespace BIO
 				//int numHorzSeg = 3; //Segments that lay horozontal on the sphere
 				//int numVertSeg = 6; //Setments that lay Vertical on the sphere
 
-				int totalVerts = (numHorozontalSegments * numVerticalSegments) + 1; //total number of vertecies on the sphere
-				rtnValue->numVertecies = totalVerts;
-
-				int totalTris = ((numHorozontalSegments - 1) * 2 * numVerticalSegments) + numVerticalSegments; //Total number of triangles that make up the sphere
-				int totalIndecies = totalTris * 3; //Total number of Indecies to make the triangles
-				rtnValue->numIndecies = totalIndecies;
-
-				//irr::u16 * u2 = new irr::u16[totalIndecies];
-				rtnValue->indecies = new unsigned short[totalIndecies];
 				int indexOn = 0;
-
-				//Vector3df * verts = new Vector3df[totalVerts];
-				rtnValue->vertecies = new Vector3D[totalVerts];
-				rtnValue->UVTextureCoordinates = new Vector2D[totalVerts];
 				int vertOn = 0;
 
 				//set the cap
 				for (int i = 0; i < numVerticalSegments; i++)
 				{
-					rtnValue->indecies[indexOn++] = 0;
-					rtnValue->indecies[indexOn++] = i + 1;
-					rtnValue->indecies[indexOn++] = i + 2;
+					indecies[indexOn++] = 0;
+					indecies[indexOn++] = i + 1;
+					indecies[indexOn++] = i + 2;
 				}
 
 				//fix the last index
 				//doing it this way should be a little faster
 				//than placing an if statment in the for loop
-				rtnValue->indecies[indexOn - 1] = 1;
+				indecies[indexOn - 1] = 1;
 
 				//set the horozontal segments
 				for (int i = 0; i < (numHorozontalSegments - 1); i++)
 				{
 					for (int j = 0; j < numVerticalSegments; j++)
 					{
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
 
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
-						rtnValue->indecies[indexOn++] = (i * numVerticalSegments) + j + 1 + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + numVerticalSegments + 1 + 1;
+						indecies[indexOn++] = (i * numVerticalSegments) + j + 1 + 1;
 					}
 
-					rtnValue->indecies[indexOn - 2] = rtnValue->indecies[indexOn - 4] = (i * numVerticalSegments) + numVerticalSegments + 1;
-					rtnValue->indecies[indexOn - 1] -= numVerticalSegments;
+					indecies[indexOn - 2] = indecies[indexOn - 4] = (i * numVerticalSegments) + numVerticalSegments + 1;
+					indecies[indexOn - 1] -= numVerticalSegments;
 				}
 
 				//create the vertecies
 				//first vert is at 0,radius,0
-				rtnValue->vertecies[0].X = 0; rtnValue->vertecies[0].Y = radius; rtnValue->vertecies[0].Z = 0;
-				rtnValue->UVTextureCoordinates[0].X = rtnValue->UVTextureCoordinates[0].Y = 0.5f;
+				vertecies[0].X = 0; vertecies[0].Y = radius; vertecies[0].Z = 0;
+				UVTextureCoordinates[0].X = UVTextureCoordinates[0].Y = 0.5f;
 				vertOn++;
 
 				double currHeight = radius;
@@ -561,12 +690,12 @@ namespace BIO
 					double currAngle = 0;
 					for (int j = 0; j < numVerticalSegments; j++)
 					{
-						rtnValue->vertecies[vertOn].X = (float)(currRadius * std::cos(currAngle));
-						rtnValue->vertecies[vertOn].Y = (float)(currHeight);
-						rtnValue->vertecies[vertOn].Z = (float)(currRadius * std::sin(currAngle));
+						vertecies[vertOn].X = (float)(currRadius * std::cos(currAngle));
+						vertecies[vertOn].Y = (float)(currHeight);
+						vertecies[vertOn].Z = (float)(currRadius * std::sin(currAngle));
 
-						rtnValue->UVTextureCoordinates[vertOn].X = (rtnValue->vertecies[vertOn].X / (2 * (radius + rtnValue->vertecies[vertOn].Y))) + 0.5f;
-						rtnValue->UVTextureCoordinates[vertOn].Y = (rtnValue->vertecies[vertOn].Z / (2 * (radius + rtnValue->vertecies[vertOn].Y))) + 0.5f;
+						UVTextureCoordinates[vertOn].X = (vertecies[vertOn].X / (2 * (radius + vertecies[vertOn].Y))) + 0.5f;
+						UVTextureCoordinates[vertOn].Y = (vertecies[vertOn].Z / (2 * (radius + vertecies[vertOn].Y))) + 0.5f;
 						vertOn++;
 
 						currAngle += circleStep;
@@ -574,348 +703,747 @@ namespace BIO
 				}
 				//*/
 			}
-			return rtnValue;
+			return true;
+		}
+
+		///////////////////////////////////////////////////////////////////////
+		//			Night sky dome data
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			const NightSkyDomeVertex _NightSkyDomeVertecies[] = {
+				/* SPHERE: 146 vertices */
+				{ -0.258819f, 0.965926f, 0.000001f, 0.282584f, 0.241876f },
+				{ -0.224144f, 0.965926f, 0.129410f, 0.274412f, 0.227382f },
+				{ -0.433013f, 0.866025f, 0.250001f, 0.297548f, 0.203968f },
+				{ -0.500000f, 0.866025f, 0.000001f, 0.314328f, 0.233167f },
+				{ -0.612373f, 0.707106f, 0.353554f, 0.322139f, 0.178164f },
+				{ -0.707107f, 0.707107f, 0.000001f, 0.348527f, 0.223116f },
+				{ -0.750000f, 0.499999f, 0.433013f, 0.349687f, 0.148452f },
+				{ -0.866026f, 0.500000f, 0.000000f, 0.387243f, 0.211159f },
+				{ -0.836516f, 0.258819f, 0.482963f, 0.382286f, 0.112823f },
+				{ -0.965926f, 0.258819f, 0.000000f, 0.433294f, 0.196604f },
+				{ -0.866025f, -0.000001f, 0.500000f, 0.423319f, 0.068580f },
+				{ -1.000000f, -0.000000f, -0.000000f, 0.490963f, 0.178809f },
+				{ -1.000000f, -0.000000f, -0.000000f, 0.993060f, 0.685299f },
+				{ -0.866025f, -0.000001f, 0.500000f, 0.928330f, 0.573210f },
+				{ -0.836516f, -0.258819f, 0.482962f, 0.885168f, 0.615448f },
+				{ -0.965926f, -0.258819f, -0.000000f, 0.934549f, 0.700294f },
+				{ -0.750000f, -0.500000f, 0.433012f, 0.850393f, 0.649015f },
+				{ -0.866025f, -0.500000f, -0.000000f, 0.887645f, 0.711975f },
+				{ -0.612372f, -0.707107f, 0.353553f, 0.821401f, 0.677369f },
+				{ -0.707107f, -0.707107f, -0.000001f, 0.848358f, 0.722033f },
+				{ -0.433013f, -0.866026f, 0.249999f, 0.796240f, 0.702659f },
+				{ -0.500000f, -0.866025f, -0.000001f, 0.813922f, 0.731354f },
+				{ -0.224144f, -0.965926f, 0.129408f, 0.773430f, 0.726429f },
+				{ -0.258819f, -0.965926f, -0.000001f, 0.782283f, 0.740535f },
+				{ -0.129410f, 0.965926f, 0.224145f, 0.260088f, 0.218915f },
+				{ -0.250000f, 0.866025f, 0.433013f, 0.268417f, 0.187070f },
+				{ -0.353554f, 0.707106f, 0.612373f, 0.276811f, 0.152430f },
+				{ -0.433013f, 0.499999f, 0.750000f, 0.285813f, 0.112926f },
+				{ -0.482963f, 0.258818f, 0.836516f, 0.296229f, 0.065775f },
+				{ -0.500000f, -0.000001f, 0.866025f, 0.309643f, 0.006950f },
+				{ -0.500000f, -0.000001f, 0.866025f, 0.816247f, 0.508511f },
+				{ -0.482963f, -0.258820f, 0.836516f, 0.799987f, 0.566666f },
+				{ -0.433013f, -0.500001f, 0.749999f, 0.786655f, 0.613119f },
+				{ -0.353554f, -0.707107f, 0.612372f, 0.775725f, 0.652168f },
+				{ -0.250000f, -0.866026f, 0.433012f, 0.766580f, 0.686650f },
+				{ -0.129410f, -0.965926f, 0.224143f, 0.758711f, 0.718639f },
+				{ -0.000000f, 0.965926f, 0.258820f, 0.243449f, 0.218745f },
+				{ -0.000000f, 0.866025f, 0.500001f, 0.234740f, 0.187002f },
+				{ -0.000000f, 0.707106f, 0.707107f, 0.224690f, 0.152805f },
+				{ -0.000000f, 0.499999f, 0.866026f, 0.212735f, 0.114094f },
+				{ -0.000000f, 0.258818f, 0.965926f, 0.198183f, 0.068052f },
+				{ -0.000000f, -0.000001f, 1.000000f, 0.180393f, 0.010402f },
+				{ -0.000000f, -0.000001f, 1.000000f, 0.686842f, 0.508511f },
+				{ -0.000000f, -0.258820f, 0.965925f, 0.701832f, 0.567004f },
+				{ -0.000000f, -0.500001f, 0.866025f, 0.713510f, 0.613899f },
+				{ -0.000000f, -0.707107f, 0.707106f, 0.723568f, 0.653181f },
+				{ -0.000000f, -0.866026f, 0.499999f, 0.732888f, 0.687615f },
+				{ -0.000000f, -0.965926f, 0.258818f, 0.742069f, 0.719253f },
+				{ 0.129409f, 0.965926f, 0.224145f, 0.228954f, 0.226916f },
+				{ 0.250000f, 0.866025f, 0.433013f, 0.205540f, 0.203781f },
+				{ 0.353553f, 0.707106f, 0.612373f, 0.179738f, 0.179190f },
+				{ 0.433012f, 0.499999f, 0.750000f, 0.150029f, 0.151641f },
+				{ 0.482962f, 0.258818f, 0.836516f, 0.114406f, 0.119041f },
+				{ 0.499999f, -0.000001f, 0.866025f, 0.070177f, 0.078005f },
+				{ 0.499999f, -0.000001f, 0.866025f, 0.574767f, 0.573202f },
+				{ 0.482962f, -0.258820f, 0.836516f, 0.616993f, 0.616368f },
+				{ 0.433012f, -0.500001f, 0.749999f, 0.650553f, 0.651143f },
+				{ 0.353553f, -0.707107f, 0.612372f, 0.678904f, 0.680135f },
+				{ 0.249999f, -0.866026f, 0.433012f, 0.704193f, 0.705296f },
+				{ 0.129409f, -0.965926f, 0.224143f, 0.727963f, 0.728105f },
+				{ 0.224143f, 0.965926f, 0.129410f, 0.220487f, 0.241241f },
+				{ 0.433012f, 0.866025f, 0.250001f, 0.188641f, 0.232911f },
+				{ 0.612372f, 0.707106f, 0.353554f, 0.153999f, 0.224516f },
+				{ 0.749999f, 0.499999f, 0.433013f, 0.114494f, 0.215512f },
+				{ 0.836516f, 0.258819f, 0.482963f, 0.067340f, 0.205089f },
+				{ 0.866025f, -0.000001f, 0.500000f, 0.008513f, 0.191662f },
+				{ 0.866025f, -0.000001f, 0.500000f, 0.510037f, 0.685266f },
+				{ 0.836516f, -0.258819f, 0.482962f, 0.568195f, 0.701539f },
+				{ 0.749999f, -0.500000f, 0.433012f, 0.614650f, 0.714877f },
+				{ 0.612372f, -0.707107f, 0.353553f, 0.653700f, 0.725810f },
+				{ 0.433012f, -0.866026f, 0.249999f, 0.688182f, 0.734955f },
+				{ 0.224143f, -0.965926f, 0.129408f, 0.720173f, 0.742824f },
+				{ 0.258819f, 0.965926f, 0.000001f, 0.220316f, 0.257879f },
+				{ 0.499999f, 0.866025f, 0.000001f, 0.188572f, 0.266589f },
+				{ 0.707106f, 0.707107f, 0.000001f, 0.154373f, 0.276640f },
+				{ 0.866025f, 0.500000f, 0.000000f, 0.115657f, 0.288596f },
+				{ 0.965925f, 0.258819f, 0.000000f, 0.069605f, 0.303151f },
+				{ 0.999999f, -0.000000f, -0.000000f, 0.011937f, 0.320946f },
+				{ 0.999999f, -0.000000f, -0.000000f, 0.510009f, 0.814704f },
+				{ 0.965925f, -0.258819f, -0.000000f, 0.568520f, 0.799708f },
+				{ 0.866025f, -0.500000f, -0.000000f, 0.615424f, 0.788027f },
+				{ 0.707106f, -0.707107f, -0.000001f, 0.654711f, 0.777968f },
+				{ 0.499999f, -0.866025f, -0.000001f, 0.689147f, 0.768647f },
+				{ 0.258818f, -0.965926f, -0.000001f, 0.720786f, 0.759466f },
+				{ 0.224143f, 0.965926f, -0.129409f, 0.228488f, 0.272374f },
+				{ 0.433012f, 0.866026f, -0.249999f, 0.205352f, 0.295788f },
+				{ 0.612372f, 0.707107f, -0.353553f, 0.180760f, 0.321591f },
+				{ 0.749999f, 0.500000f, -0.433012f, 0.153212f, 0.351304f },
+				{ 0.836516f, 0.258819f, -0.482963f, 0.120613f, 0.386932f },
+				{ 0.866025f, 0.000000f, -0.500000f, 0.079580f, 0.431175f },
+				{ 0.866025f, 0.000000f, -0.500000f, 0.574740f, 0.926792f },
+				{ 0.836516f, -0.258819f, -0.482963f, 0.617902f, 0.884553f },
+				{ 0.749999f, -0.500000f, -0.433013f, 0.652676f, 0.850986f },
+				{ 0.612372f, -0.707106f, -0.353554f, 0.681668f, 0.822632f },
+				{ 0.433012f, -0.866025f, -0.250001f, 0.706829f, 0.797342f },
+				{ 0.224143f, -0.965926f, -0.129410f, 0.729638f, 0.773572f },
+				{ 0.129409f, 0.965926f, -0.224143f, 0.242812f, 0.280841f },
+				{ 0.249999f, 0.866026f, -0.433012f, 0.234483f, 0.312685f },
+				{ 0.353553f, 0.707107f, -0.612372f, 0.226088f, 0.347326f },
+				{ 0.433012f, 0.500001f, -0.749999f, 0.217087f, 0.386830f },
+				{ 0.482962f, 0.258820f, -0.836516f, 0.206670f, 0.433981f },
+				{ 0.499999f, 0.000001f, -0.866025f, 0.193256f, 0.492806f },
+				{ 0.499999f, 0.000001f, -0.866025f, 0.686823f, 0.991489f },
+				{ 0.482962f, -0.258818f, -0.836516f, 0.703083f, 0.933335f },
+				{ 0.433012f, -0.499999f, -0.750000f, 0.716414f, 0.886881f },
+				{ 0.353553f, -0.707106f, -0.612373f, 0.727345f, 0.847833f },
+				{ 0.249999f, -0.866025f, -0.433013f, 0.736489f, 0.813351f },
+				{ 0.129409f, -0.965926f, -0.224144f, 0.744358f, 0.781361f },
+				{ -0.000000f, 0.965926f, -0.258818f, 0.259451f, 0.281011f },
+				{ -0.000000f, 0.866026f, -0.499999f, 0.268160f, 0.312754f },
+				{ -0.000000f, 0.707107f, -0.707106f, 0.278210f, 0.346951f },
+				{ -0.000000f, 0.500001f, -0.866025f, 0.290165f, 0.385662f },
+				{ -0.000000f, 0.258820f, -0.965925f, 0.304717f, 0.431704f },
+				{ -0.000001f, 0.000001f, -0.999999f, 0.322508f, 0.489354f },
+				{ -0.000001f, 0.000001f, -0.999999f, 0.816227f, 0.991488f },
+				{ -0.000000f, -0.258818f, -0.965926f, 0.801237f, 0.932996f },
+				{ -0.000000f, -0.499999f, -0.866025f, 0.789559f, 0.886101f },
+				{ -0.000001f, -0.707106f, -0.707107f, 0.779501f, 0.846819f },
+				{ -0.000000f, -0.866025f, -0.500000f, 0.770181f, 0.812386f },
+				{ -0.000000f, -0.965926f, -0.258819f, 0.761000f, 0.780748f },
+				{ -0.129410f, 0.965926f, -0.224143f, 0.273946f, 0.272839f },
+				{ -0.250000f, 0.866026f, -0.433012f, 0.297360f, 0.295975f },
+				{ -0.353554f, 0.707107f, -0.612372f, 0.323162f, 0.320566f },
+				{ -0.433013f, 0.500001f, -0.749999f, 0.352871f, 0.348115f },
+				{ -0.482963f, 0.258820f, -0.836516f, 0.388494f, 0.380715f },
+				{ -0.500000f, 0.000001f, -0.866025f, 0.432724f, 0.421751f },
+				{ -0.500000f, 0.000001f, -0.866025f, 0.928302f, 0.926799f },
+				{ -0.482963f, -0.258818f, -0.836516f, 0.886076f, 0.883633f },
+				{ -0.433013f, -0.499999f, -0.750000f, 0.852515f, 0.848857f },
+				{ -0.353554f, -0.707106f, -0.612373f, 0.824164f, 0.819865f },
+				{ -0.250000f, -0.866025f, -0.433013f, 0.798876f, 0.794705f },
+				{ -0.129410f, -0.965926f, -0.224144f, 0.775106f, 0.771896f },
+				{ -0.224144f, 0.965926f, -0.129409f, 0.282413f, 0.258515f },
+				{ -0.433013f, 0.866026f, -0.249999f, 0.314259f, 0.266844f },
+				{ -0.612373f, 0.707107f, -0.353553f, 0.348901f, 0.275240f },
+				{ -0.750000f, 0.500000f, -0.433012f, 0.388406f, 0.284243f },
+				{ -0.836516f, 0.258819f, -0.482962f, 0.435560f, 0.294666f },
+				{ -0.866025f, 0.000000f, -0.500000f, 0.494388f, 0.308093f },
+				{ -0.866025f, 0.000000f, -0.500000f, 0.993032f, 0.814735f },
+				{ -0.836516f, -0.258819f, -0.482963f, 0.934874f, 0.798462f },
+				{ -0.750000f, -0.500000f, -0.433013f, 0.888419f, 0.785124f },
+				{ -0.612372f, -0.707106f, -0.353554f, 0.849368f, 0.774191f },
+				{ -0.433013f, -0.866025f, -0.250000f, 0.814886f, 0.765045f },
+				{ -0.224144f, -0.965926f, -0.129410f, 0.782896f, 0.757177f },
+				{ -0.000000f, 1.000000f, 0.000001f, 0.251450f, 0.249878f },
+				{ -0.000001f, -1.000000f, -0.000001f, 0.751534f, 0.750000f }
+			};
+
+			const unsigned short _NightSkyDomeIndecies[] = {
+				/* SPHERE 264 faces */
+				0, 1, 2, 0, 2, 3, 3, 2, 4, 3, 4, 5, 5, 4, 6, 5, 6, 7, 7, 6, 8, 7, 8, 9, 9, 8, 10, 9, 10, 11, 12, 13, 14, 12, 14, 15, 15, 14, 16, 15, 16, 17, 17, 16, 18, 17, 18, 19, 19, 18, 20, 19, 20, 21, 22, 23, 21, 22, 21, 20, 1, 24, 25, 1, 25, 2, 2, 25, 26, 2, 26, 4, 4, 26, 27, 4, 27, 6, 6, 27, 28, 6, 28, 8, 8, 28, 29, 8, 29, 10, 13, 30, 31, 13, 31, 14, 14, 31, 32, 14, 32, 16, 16, 32, 33, 16, 33, 18, 18, 33, 34, 18, 34, 20, 20, 34, 35, 20, 35, 22, 24, 36, 37, 24, 37, 25, 25, 37, 38, 25, 38, 26, 26, 38, 39, 26, 39, 27, 27, 39, 40, 27, 40, 28, 28, 40, 41, 28, 41, 29, 30, 42, 43, 30, 43, 31, 31, 43, 44, 31, 44, 32, 32, 44, 45, 32, 45, 33, 33, 45, 46, 33, 46, 34, 34, 46, 47, 34, 47, 35, 36, 48, 49, 36, 49, 37, 37, 49, 50, 37, 50, 38, 38, 50, 51, 38, 51, 39, 39, 51, 52, 39, 52, 40, 40, 52, 53, 40, 53, 41, 42, 54, 55, 42, 55, 43, 43, 55, 56, 43, 56, 44, 44, 56, 57, 44, 57, 45, 45, 57, 58, 45, 58, 46, 46, 58, 59, 46, 59, 47, 48, 60, 61, 48, 61, 49, 49, 61, 62, 49, 62, 50, 50, 62, 63, 50, 63, 51, 51, 63, 64, 51, 64, 52, 52, 64, 65, 52, 65, 53, 54, 66, 67, 54, 67, 55, 55, 67, 68, 55, 68, 56, 56, 68, 69, 56, 69, 57, 57, 69, 70, 57, 70, 58, 58, 70, 71, 58, 71, 59, 60, 72, 73, 60, 73, 61, 61, 73, 74, 61, 74, 62, 62, 74, 75, 62, 75, 63, 63, 75, 76, 63, 76, 64, 64, 76, 77, 64, 77, 65, 66, 78, 79, 66, 79, 67, 67, 79, 80, 67, 80, 68, 68, 80, 81, 68, 81, 69, 69, 81, 82, 69, 82, 70, 70, 82, 83, 70, 83, 71, 72, 84, 85, 72, 85, 73, 73, 85, 86, 73, 86, 74, 74, 86, 87, 74, 87, 75, 75, 87, 88, 75, 88, 76, 76, 88, 89, 76, 89, 77, 78, 90, 91, 78, 91, 79, 79, 91, 92, 79, 92, 80, 80, 92, 93, 80, 93, 81, 81, 93, 94, 81, 94, 82, 82, 94, 95, 82, 95, 83, 84, 96, 97, 84, 97, 85, 85, 97, 98, 85, 98, 86, 86, 98, 99, 86, 99, 87, 87, 99, 100, 87, 100, 88, 88, 100, 101, 88, 101, 89, 90, 102, 103, 90, 103, 91, 91, 103, 104, 91, 104, 92, 92, 104, 105, 92, 105, 93, 93, 105, 106, 93, 106, 94, 94, 106, 107, 94, 107, 95, 96, 108, 109, 96, 109, 97, 97, 109, 110, 97, 110, 98, 98, 110, 111, 98, 111, 99, 99, 111, 112, 99, 112, 100, 100, 112, 113, 100, 113, 101, 102, 114, 115, 102, 115, 103, 103, 115, 116, 103, 116, 104, 104, 116, 117, 104, 117, 105, 105, 117, 118, 105, 118, 106, 106, 118, 119, 106, 119, 107, 108, 120, 121, 108, 121, 109, 109, 121, 122, 109, 122, 110, 110, 122, 123, 110, 123, 111, 111, 123, 124, 111, 124, 112, 112, 124, 125, 112, 125, 113, 114, 126, 127, 114, 127, 115, 115, 127, 128, 115, 128, 116, 116, 128, 129, 116, 129, 117, 117, 129, 130, 117, 130, 118, 118, 130, 131, 118, 131, 119, 120, 132, 133, 120, 133, 121, 121, 133, 134, 121, 134, 122, 122, 134, 135, 122, 135, 123, 123, 135, 136, 123, 136, 124, 124, 136, 137, 124, 137, 125, 126, 138, 139, 126, 139, 127, 127, 139, 140, 127, 140, 128, 128, 140, 141, 128, 141, 129, 129, 141, 142, 129, 142, 130, 130, 142, 143, 130, 143, 131, 144, 1, 0, 23, 22, 145, 144, 24, 1, 22, 35, 145, 144, 36, 24, 35, 47, 145, 144, 48, 36, 47, 59, 145, 144, 60, 48, 59, 71, 145, 144, 72, 60, 71, 83, 145, 144, 84, 72, 83, 95, 145, 144, 96, 84, 95, 107, 145, 144, 108, 96, 107, 119, 145, 144, 120, 108, 119, 131, 145, 144, 132, 120, 131, 143, 145, 144, 0, 132, 132, 0, 3, 132, 3, 133, 133, 3, 5, 133, 5, 134, 134, 5, 7, 134, 7, 135, 135, 7, 9, 135, 9, 136, 136, 9, 11, 136, 11, 137, 138, 12, 15, 138, 15, 139, 139, 15, 17, 139, 17, 140, 140, 17, 19, 140, 19, 141, 141, 19, 21, 141, 21, 142, 23, 143, 142, 23, 142, 21, 143, 23, 145
+			};
+		}
+
+		void GetNightSkyDomeGeometrySize(int * numVertecies, int * numIndecies)
+		{
+			int numFaces = 264;
+
+			if (numVertecies)
+				(*numVertecies) = 146;
+
+			if (numIndecies)
+				(*numIndecies) = numFaces * 3;
+		}
+
+		const NightSkyDomeVertex * GetNightSkyDomeVertecies()
+		{
+			return _NightSkyDomeVertecies;
+		}
+
+		const unsigned short * GetNightSkyDomeIndecies()
+		{
+			return _NightSkyDomeIndecies;
 		}
 
 		RawGeometry * CreateNightSkyDomeGeometry(float radius)
 		{
 			RawGeometry * rtnVal = new RawGeometry();
 
-			int numFaces = 264;
+			int totalVerts = 0;
+			int totalIndecies = 0;
+			GetNightSkyDomeGeometrySize(&totalVerts, &totalIndecies);
 
-			rtnVal->numIndecies = numFaces * 3;
-			rtnVal->indecies = new unsigned short[rtnVal->numIndecies];
+			rtnVal->AllocateArrays(totalVerts, totalIndecies);
 
-			rtnVal->numVertecies = 146;
-			rtnVal->UVTextureCoordinates = new Vector2D[rtnVal->numVertecies];
-			rtnVal->vertecies = new Vector3D[rtnVal->numVertecies];
+			CreateNightSkyDomeGeometry(radius,
+				rtnVal->vertecies, rtnVal->UVTextureCoordinates, rtnVal->numVertecies,
+				rtnVal->indecies, rtnVal->numIndecies);
 
-			struct vertex_struct {
-				float x, y, z;
-				float nx, ny, nz;
-				float u, v;
-			};
-			struct vertex_struct vertices[] = {
-				/* SPHERE: 146 vertices */
-				{ -0.258819f, 0.965926f, 0.000001f, 0.278848f, -0.960326f, 0.000000f, 0.282584f, 0.241876f },
-				{ -0.224144f, 0.965926f, 0.129410f, 0.241493f, -0.960326f, -0.139409f, 0.274412f, 0.227382f },
-				{ -0.433013f, 0.866025f, 0.250001f, 0.446791f, -0.856624f, -0.257942f, 0.297548f, 0.203968f },
-				{ -0.500000f, 0.866025f, 0.000001f, 0.515915f, -0.856624f, 0.000000f, 0.314328f, 0.233167f },
-				{ -0.612373f, 0.707106f, 0.353554f, 0.621448f, -0.696432f, -0.358776f, 0.322139f, 0.178164f },
-				{ -0.707107f, 0.707107f, 0.000001f, 0.717582f, -0.696432f, 0.000000f, 0.348527f, 0.223116f },
-				{ -0.750000f, 0.499999f, 0.433013f, 0.754479f, -0.490860f, -0.435591f, 0.349687f, 0.148452f },
-				{ -0.866026f, 0.500000f, 0.000000f, 0.871212f, -0.490860f, 0.000000f, 0.387243f, 0.211159f },
-				{ -0.836516f, 0.258819f, 0.482963f, 0.837703f, -0.253578f, -0.483627f, 0.382286f, 0.112823f },
-				{ -0.965926f, 0.258819f, 0.000000f, 0.967284f, -0.253578f, 0.000000f, 0.433294f, 0.196604f },
-				{ -0.866025f, -0.000001f, 0.500000f, 0.866024f, 0.000000f, -0.499985f, 0.423319f, 0.068580f },
-				{ -1.000000f, -0.000000f, -0.000000f, 1.000000f, 0.000000f, 0.000000f, 0.490963f, 0.178809f },
-				{ -1.000000f, -0.000000f, -0.000000f, 1.000000f, 0.000000f, 0.000000f, 0.993060f, 0.685299f },
-				{ -0.866025f, -0.000001f, 0.500000f, 0.866024f, 0.000000f, -0.499985f, 0.928330f, 0.573210f },
-				{ -0.836516f, -0.258819f, 0.482962f, 0.837703f, 0.253578f, -0.483627f, 0.885168f, 0.615448f },
-				{ -0.965926f, -0.258819f, -0.000000f, 0.967284f, 0.253578f, 0.000000f, 0.934549f, 0.700294f },
-				{ -0.750000f, -0.500000f, 0.433012f, 0.754479f, 0.490860f, -0.435591f, 0.850393f, 0.649015f },
-				{ -0.866025f, -0.500000f, -0.000000f, 0.871212f, 0.490860f, 0.000000f, 0.887645f, 0.711975f },
-				{ -0.612372f, -0.707107f, 0.353553f, 0.621448f, 0.696432f, -0.358776f, 0.821401f, 0.677369f },
-				{ -0.707107f, -0.707107f, -0.000001f, 0.717582f, 0.696432f, 0.000000f, 0.848358f, 0.722033f },
-				{ -0.433013f, -0.866026f, 0.249999f, 0.446791f, 0.856624f, -0.257942f, 0.796240f, 0.702659f },
-				{ -0.500000f, -0.866025f, -0.000001f, 0.515915f, 0.856624f, 0.000000f, 0.813922f, 0.731354f },
-				{ -0.224144f, -0.965926f, 0.129408f, 0.241493f, 0.960326f, -0.139409f, 0.773430f, 0.726429f },
-				{ -0.258819f, -0.965926f, -0.000001f, 0.278848f, 0.960326f, 0.000000f, 0.782283f, 0.740535f },
-				{ -0.129410f, 0.965926f, 0.224145f, 0.139409f, -0.960326f, -0.241493f, 0.260088f, 0.218915f },
-				{ -0.250000f, 0.866025f, 0.433013f, 0.257942f, -0.856624f, -0.446791f, 0.268417f, 0.187070f },
-				{ -0.353554f, 0.707106f, 0.612373f, 0.358776f, -0.696432f, -0.621448f, 0.276811f, 0.152430f },
-				{ -0.433013f, 0.499999f, 0.750000f, 0.435591f, -0.490860f, -0.754479f, 0.285813f, 0.112926f },
-				{ -0.482963f, 0.258818f, 0.836516f, 0.483627f, -0.253578f, -0.837703f, 0.296229f, 0.065775f },
-				{ -0.500000f, -0.000001f, 0.866025f, 0.499985f, 0.000000f, -0.866024f, 0.309643f, 0.006950f },
-				{ -0.500000f, -0.000001f, 0.866025f, 0.499985f, 0.000000f, -0.866024f, 0.816247f, 0.508511f },
-				{ -0.482963f, -0.258820f, 0.836516f, 0.483627f, 0.253578f, -0.837703f, 0.799987f, 0.566666f },
-				{ -0.433013f, -0.500001f, 0.749999f, 0.435591f, 0.490860f, -0.754479f, 0.786655f, 0.613119f },
-				{ -0.353554f, -0.707107f, 0.612372f, 0.358776f, 0.696432f, -0.621448f, 0.775725f, 0.652168f },
-				{ -0.250000f, -0.866026f, 0.433012f, 0.257942f, 0.856624f, -0.446791f, 0.766580f, 0.686650f },
-				{ -0.129410f, -0.965926f, 0.224143f, 0.139409f, 0.960326f, -0.241493f, 0.758711f, 0.718639f },
-				{ -0.000000f, 0.965926f, 0.258820f, 0.000000f, -0.960326f, -0.278848f, 0.243449f, 0.218745f },
-				{ -0.000000f, 0.866025f, 0.500001f, 0.000000f, -0.856624f, -0.515915f, 0.234740f, 0.187002f },
-				{ -0.000000f, 0.707106f, 0.707107f, 0.000000f, -0.696432f, -0.717582f, 0.224690f, 0.152805f },
-				{ -0.000000f, 0.499999f, 0.866026f, 0.000000f, -0.490860f, -0.871212f, 0.212735f, 0.114094f },
-				{ -0.000000f, 0.258818f, 0.965926f, 0.000000f, -0.253578f, -0.967284f, 0.198183f, 0.068052f },
-				{ -0.000000f, -0.000001f, 1.000000f, 0.000000f, 0.000000f, -1.000000f, 0.180393f, 0.010402f },
-				{ -0.000000f, -0.000001f, 1.000000f, 0.000000f, 0.000000f, -1.000000f, 0.686842f, 0.508511f },
-				{ -0.000000f, -0.258820f, 0.965925f, 0.000000f, 0.253578f, -0.967284f, 0.701832f, 0.567004f },
-				{ -0.000000f, -0.500001f, 0.866025f, 0.000000f, 0.490860f, -0.871212f, 0.713510f, 0.613899f },
-				{ -0.000000f, -0.707107f, 0.707106f, 0.000000f, 0.696432f, -0.717582f, 0.723568f, 0.653181f },
-				{ -0.000000f, -0.866026f, 0.499999f, 0.000000f, 0.856624f, -0.515915f, 0.732888f, 0.687615f },
-				{ -0.000000f, -0.965926f, 0.258818f, 0.000000f, 0.960326f, -0.278848f, 0.742069f, 0.719253f },
-				{ 0.129409f, 0.965926f, 0.224145f, -0.139409f, -0.960326f, -0.241493f, 0.228954f, 0.226916f },
-				{ 0.250000f, 0.866025f, 0.433013f, -0.257942f, -0.856624f, -0.446791f, 0.205540f, 0.203781f },
-				{ 0.353553f, 0.707106f, 0.612373f, -0.358776f, -0.696432f, -0.621448f, 0.179738f, 0.179190f },
-				{ 0.433012f, 0.499999f, 0.750000f, -0.435591f, -0.490860f, -0.754479f, 0.150029f, 0.151641f },
-				{ 0.482962f, 0.258818f, 0.836516f, -0.483627f, -0.253578f, -0.837703f, 0.114406f, 0.119041f },
-				{ 0.499999f, -0.000001f, 0.866025f, -0.499985f, 0.000000f, -0.866024f, 0.070177f, 0.078005f },
-				{ 0.499999f, -0.000001f, 0.866025f, -0.499985f, 0.000000f, -0.866024f, 0.574767f, 0.573202f },
-				{ 0.482962f, -0.258820f, 0.836516f, -0.483627f, 0.253578f, -0.837703f, 0.616993f, 0.616368f },
-				{ 0.433012f, -0.500001f, 0.749999f, -0.435591f, 0.490860f, -0.754479f, 0.650553f, 0.651143f },
-				{ 0.353553f, -0.707107f, 0.612372f, -0.358776f, 0.696432f, -0.621448f, 0.678904f, 0.680135f },
-				{ 0.249999f, -0.866026f, 0.433012f, -0.257942f, 0.856624f, -0.446791f, 0.704193f, 0.705296f },
-				{ 0.129409f, -0.965926f, 0.224143f, -0.139409f, 0.960326f, -0.241493f, 0.727963f, 0.728105f },
-				{ 0.224143f, 0.965926f, 0.129410f, -0.241493f, -0.960326f, -0.139409f, 0.220487f, 0.241241f },
-				{ 0.433012f, 0.866025f, 0.250001f, -0.446791f, -0.856624f, -0.257942f, 0.188641f, 0.232911f },
-				{ 0.612372f, 0.707106f, 0.353554f, -0.621448f, -0.696432f, -0.358776f, 0.153999f, 0.224516f },
-				{ 0.749999f, 0.499999f, 0.433013f, -0.754479f, -0.490860f, -0.435591f, 0.114494f, 0.215512f },
-				{ 0.836516f, 0.258819f, 0.482963f, -0.837703f, -0.253578f, -0.483627f, 0.067340f, 0.205089f },
-				{ 0.866025f, -0.000001f, 0.500000f, -0.866024f, 0.000000f, -0.499985f, 0.008513f, 0.191662f },
-				{ 0.866025f, -0.000001f, 0.500000f, -0.866024f, 0.000000f, -0.499985f, 0.510037f, 0.685266f },
-				{ 0.836516f, -0.258819f, 0.482962f, -0.837703f, 0.253578f, -0.483627f, 0.568195f, 0.701539f },
-				{ 0.749999f, -0.500000f, 0.433012f, -0.754479f, 0.490860f, -0.435591f, 0.614650f, 0.714877f },
-				{ 0.612372f, -0.707107f, 0.353553f, -0.621448f, 0.696432f, -0.358776f, 0.653700f, 0.725810f },
-				{ 0.433012f, -0.866026f, 0.249999f, -0.446791f, 0.856624f, -0.257942f, 0.688182f, 0.734955f },
-				{ 0.224143f, -0.965926f, 0.129408f, -0.241493f, 0.960326f, -0.139409f, 0.720173f, 0.742824f },
-				{ 0.258819f, 0.965926f, 0.000001f, -0.278848f, -0.960326f, 0.000000f, 0.220316f, 0.257879f },
-				{ 0.499999f, 0.866025f, 0.000001f, -0.515915f, -0.856624f, 0.000000f, 0.188572f, 0.266589f },
-				{ 0.707106f, 0.707107f, 0.000001f, -0.717582f, -0.696432f, 0.000000f, 0.154373f, 0.276640f },
-				{ 0.866025f, 0.500000f, 0.000000f, -0.871212f, -0.490860f, 0.000000f, 0.115657f, 0.288596f },
-				{ 0.965925f, 0.258819f, 0.000000f, -0.967284f, -0.253578f, 0.000000f, 0.069605f, 0.303151f },
-				{ 0.999999f, -0.000000f, -0.000000f, -1.000000f, 0.000000f, 0.000000f, 0.011937f, 0.320946f },
-				{ 0.999999f, -0.000000f, -0.000000f, -1.000000f, 0.000000f, 0.000000f, 0.510009f, 0.814704f },
-				{ 0.965925f, -0.258819f, -0.000000f, -0.967284f, 0.253578f, 0.000000f, 0.568520f, 0.799708f },
-				{ 0.866025f, -0.500000f, -0.000000f, -0.871212f, 0.490860f, 0.000000f, 0.615424f, 0.788027f },
-				{ 0.707106f, -0.707107f, -0.000001f, -0.717582f, 0.696432f, 0.000000f, 0.654711f, 0.777968f },
-				{ 0.499999f, -0.866025f, -0.000001f, -0.515915f, 0.856624f, 0.000000f, 0.689147f, 0.768647f },
-				{ 0.258818f, -0.965926f, -0.000001f, -0.278848f, 0.960326f, 0.000000f, 0.720786f, 0.759466f },
-				{ 0.224143f, 0.965926f, -0.129409f, -0.241493f, -0.960326f, 0.139409f, 0.228488f, 0.272374f },
-				{ 0.433012f, 0.866026f, -0.249999f, -0.446791f, -0.856624f, 0.257942f, 0.205352f, 0.295788f },
-				{ 0.612372f, 0.707107f, -0.353553f, -0.621448f, -0.696432f, 0.358776f, 0.180760f, 0.321591f },
-				{ 0.749999f, 0.500000f, -0.433012f, -0.754479f, -0.490860f, 0.435591f, 0.153212f, 0.351304f },
-				{ 0.836516f, 0.258819f, -0.482963f, -0.837703f, -0.253578f, 0.483627f, 0.120613f, 0.386932f },
-				{ 0.866025f, 0.000000f, -0.500000f, -0.866024f, 0.000000f, 0.499985f, 0.079580f, 0.431175f },
-				{ 0.866025f, 0.000000f, -0.500000f, -0.866024f, 0.000000f, 0.499985f, 0.574740f, 0.926792f },
-				{ 0.836516f, -0.258819f, -0.482963f, -0.837703f, 0.253578f, 0.483627f, 0.617902f, 0.884553f },
-				{ 0.749999f, -0.500000f, -0.433013f, -0.754479f, 0.490860f, 0.435591f, 0.652676f, 0.850986f },
-				{ 0.612372f, -0.707106f, -0.353554f, -0.621448f, 0.696432f, 0.358776f, 0.681668f, 0.822632f },
-				{ 0.433012f, -0.866025f, -0.250001f, -0.446791f, 0.856624f, 0.257942f, 0.706829f, 0.797342f },
-				{ 0.224143f, -0.965926f, -0.129410f, -0.241493f, 0.960326f, 0.139409f, 0.729638f, 0.773572f },
-				{ 0.129409f, 0.965926f, -0.224143f, -0.139409f, -0.960326f, 0.241493f, 0.242812f, 0.280841f },
-				{ 0.249999f, 0.866026f, -0.433012f, -0.257942f, -0.856624f, 0.446791f, 0.234483f, 0.312685f },
-				{ 0.353553f, 0.707107f, -0.612372f, -0.358776f, -0.696432f, 0.621448f, 0.226088f, 0.347326f },
-				{ 0.433012f, 0.500001f, -0.749999f, -0.435591f, -0.490860f, 0.754479f, 0.217087f, 0.386830f },
-				{ 0.482962f, 0.258820f, -0.836516f, -0.483627f, -0.253578f, 0.837703f, 0.206670f, 0.433981f },
-				{ 0.499999f, 0.000001f, -0.866025f, -0.499985f, 0.000000f, 0.866024f, 0.193256f, 0.492806f },
-				{ 0.499999f, 0.000001f, -0.866025f, -0.499985f, 0.000000f, 0.866024f, 0.686823f, 0.991489f },
-				{ 0.482962f, -0.258818f, -0.836516f, -0.483627f, 0.253578f, 0.837703f, 0.703083f, 0.933335f },
-				{ 0.433012f, -0.499999f, -0.750000f, -0.435591f, 0.490860f, 0.754479f, 0.716414f, 0.886881f },
-				{ 0.353553f, -0.707106f, -0.612373f, -0.358776f, 0.696432f, 0.621448f, 0.727345f, 0.847833f },
-				{ 0.249999f, -0.866025f, -0.433013f, -0.257942f, 0.856624f, 0.446791f, 0.736489f, 0.813351f },
-				{ 0.129409f, -0.965926f, -0.224144f, -0.139409f, 0.960326f, 0.241493f, 0.744358f, 0.781361f },
-				{ -0.000000f, 0.965926f, -0.258818f, 0.000000f, -0.960326f, 0.278848f, 0.259451f, 0.281011f },
-				{ -0.000000f, 0.866026f, -0.499999f, 0.000000f, -0.856624f, 0.515915f, 0.268160f, 0.312754f },
-				{ -0.000000f, 0.707107f, -0.707106f, 0.000000f, -0.696432f, 0.717582f, 0.278210f, 0.346951f },
-				{ -0.000000f, 0.500001f, -0.866025f, 0.000000f, -0.490860f, 0.871212f, 0.290165f, 0.385662f },
-				{ -0.000000f, 0.258820f, -0.965925f, 0.000000f, -0.253578f, 0.967284f, 0.304717f, 0.431704f },
-				{ -0.000001f, 0.000001f, -0.999999f, 0.000000f, 0.000000f, 0.999969f, 0.322508f, 0.489354f },
-				{ -0.000001f, 0.000001f, -0.999999f, 0.000000f, 0.000000f, 0.999969f, 0.816227f, 0.991488f },
-				{ -0.000000f, -0.258818f, -0.965926f, 0.000000f, 0.253578f, 0.967284f, 0.801237f, 0.932996f },
-				{ -0.000000f, -0.499999f, -0.866025f, 0.000000f, 0.490860f, 0.871212f, 0.789559f, 0.886101f },
-				{ -0.000001f, -0.707106f, -0.707107f, 0.000000f, 0.696432f, 0.717582f, 0.779501f, 0.846819f },
-				{ -0.000000f, -0.866025f, -0.500000f, 0.000000f, 0.856624f, 0.515915f, 0.770181f, 0.812386f },
-				{ -0.000000f, -0.965926f, -0.258819f, 0.000000f, 0.960326f, 0.278848f, 0.761000f, 0.780748f },
-				{ -0.129410f, 0.965926f, -0.224143f, 0.139409f, -0.960326f, 0.241493f, 0.273946f, 0.272839f },
-				{ -0.250000f, 0.866026f, -0.433012f, 0.257942f, -0.856624f, 0.446791f, 0.297360f, 0.295975f },
-				{ -0.353554f, 0.707107f, -0.612372f, 0.358776f, -0.696432f, 0.621448f, 0.323162f, 0.320566f },
-				{ -0.433013f, 0.500001f, -0.749999f, 0.435591f, -0.490860f, 0.754479f, 0.352871f, 0.348115f },
-				{ -0.482963f, 0.258820f, -0.836516f, 0.483627f, -0.253578f, 0.837703f, 0.388494f, 0.380715f },
-				{ -0.500000f, 0.000001f, -0.866025f, 0.499985f, 0.000000f, 0.866024f, 0.432724f, 0.421751f },
-				{ -0.500000f, 0.000001f, -0.866025f, 0.499985f, 0.000000f, 0.866024f, 0.928302f, 0.926799f },
-				{ -0.482963f, -0.258818f, -0.836516f, 0.483627f, 0.253578f, 0.837703f, 0.886076f, 0.883633f },
-				{ -0.433013f, -0.499999f, -0.750000f, 0.435591f, 0.490860f, 0.754479f, 0.852515f, 0.848857f },
-				{ -0.353554f, -0.707106f, -0.612373f, 0.358776f, 0.696432f, 0.621448f, 0.824164f, 0.819865f },
-				{ -0.250000f, -0.866025f, -0.433013f, 0.257942f, 0.856624f, 0.446791f, 0.798876f, 0.794705f },
-				{ -0.129410f, -0.965926f, -0.224144f, 0.139409f, 0.960326f, 0.241493f, 0.775106f, 0.771896f },
-				{ -0.224144f, 0.965926f, -0.129409f, 0.241493f, -0.960326f, 0.139409f, 0.282413f, 0.258515f },
-				{ -0.433013f, 0.866026f, -0.249999f, 0.446791f, -0.856624f, 0.257942f, 0.314259f, 0.266844f },
-				{ -0.612373f, 0.707107f, -0.353553f, 0.621448f, -0.696432f, 0.358776f, 0.348901f, 0.275240f },
-				{ -0.750000f, 0.500000f, -0.433012f, 0.754479f, -0.490860f, 0.435591f, 0.388406f, 0.284243f },
-				{ -0.836516f, 0.258819f, -0.482962f, 0.837703f, -0.253578f, 0.483627f, 0.435560f, 0.294666f },
-				{ -0.866025f, 0.000000f, -0.500000f, 0.866024f, 0.000000f, 0.499985f, 0.494388f, 0.308093f },
-				{ -0.866025f, 0.000000f, -0.500000f, 0.866024f, 0.000000f, 0.499985f, 0.993032f, 0.814735f },
-				{ -0.836516f, -0.258819f, -0.482963f, 0.837703f, 0.253578f, 0.483627f, 0.934874f, 0.798462f },
-				{ -0.750000f, -0.500000f, -0.433013f, 0.754479f, 0.490860f, 0.435591f, 0.888419f, 0.785124f },
-				{ -0.612372f, -0.707106f, -0.353554f, 0.621448f, 0.696432f, 0.358776f, 0.849368f, 0.774191f },
-				{ -0.433013f, -0.866025f, -0.250000f, 0.446791f, 0.856624f, 0.257942f, 0.814886f, 0.765045f },
-				{ -0.224144f, -0.965926f, -0.129410f, 0.241493f, 0.960326f, 0.139409f, 0.782896f, 0.757177f },
-				{ -0.000000f, 1.000000f, 0.000001f, 0.000000f, -1.000000f, 0.000000f, 0.251450f, 0.249878f },
-				{ -0.000001f, -1.000000f, -0.000001f, 0.000000f, 1.000000f, 0.000000f, 0.751534f, 0.750000f }
-			};
+			return rtnVal;
+		}
 
-			unsigned short indexes[] = {
-				/* SPHERE 264 faces */
-				0, 1, 2, 0, 2, 3, 3, 2, 4, 3, 4, 5, 5, 4, 6, 5, 6, 7, 7, 6, 8, 7, 8, 9, 9, 8, 10, 9, 10, 11, 12, 13, 14, 12, 14, 15, 15, 14, 16, 15, 16, 17, 17, 16, 18, 17, 18, 19, 19, 18, 20, 19, 20, 21, 22, 23, 21, 22, 21, 20, 1, 24, 25, 1, 25, 2, 2, 25, 26, 2, 26, 4, 4, 26, 27, 4, 27, 6, 6, 27, 28, 6, 28, 8, 8, 28, 29, 8, 29, 10, 13, 30, 31, 13, 31, 14, 14, 31, 32, 14, 32, 16, 16, 32, 33, 16, 33, 18, 18, 33, 34, 18, 34, 20, 20, 34, 35, 20, 35, 22, 24, 36, 37, 24, 37, 25, 25, 37, 38, 25, 38, 26, 26, 38, 39, 26, 39, 27, 27, 39, 40, 27, 40, 28, 28, 40, 41, 28, 41, 29, 30, 42, 43, 30, 43, 31, 31, 43, 44, 31, 44, 32, 32, 44, 45, 32, 45, 33, 33, 45, 46, 33, 46, 34, 34, 46, 47, 34, 47, 35, 36, 48, 49, 36, 49, 37, 37, 49, 50, 37, 50, 38, 38, 50, 51, 38, 51, 39, 39, 51, 52, 39, 52, 40, 40, 52, 53, 40, 53, 41, 42, 54, 55, 42, 55, 43, 43, 55, 56, 43, 56, 44, 44, 56, 57, 44, 57, 45, 45, 57, 58, 45, 58, 46, 46, 58, 59, 46, 59, 47, 48, 60, 61, 48, 61, 49, 49, 61, 62, 49, 62, 50, 50, 62, 63, 50, 63, 51, 51, 63, 64, 51, 64, 52, 52, 64, 65, 52, 65, 53, 54, 66, 67, 54, 67, 55, 55, 67, 68, 55, 68, 56, 56, 68, 69, 56, 69, 57, 57, 69, 70, 57, 70, 58, 58, 70, 71, 58, 71, 59, 60, 72, 73, 60, 73, 61, 61, 73, 74, 61, 74, 62, 62, 74, 75, 62, 75, 63, 63, 75, 76, 63, 76, 64, 64, 76, 77, 64, 77, 65, 66, 78, 79, 66, 79, 67, 67, 79, 80, 67, 80, 68, 68, 80, 81, 68, 81, 69, 69, 81, 82, 69, 82, 70, 70, 82, 83, 70, 83, 71, 72, 84, 85, 72, 85, 73, 73, 85, 86, 73, 86, 74, 74, 86, 87, 74, 87, 75, 75, 87, 88, 75, 88, 76, 76, 88, 89, 76, 89, 77, 78, 90, 91, 78, 91, 79, 79, 91, 92, 79, 92, 80, 80, 92, 93, 80, 93, 81, 81, 93, 94, 81, 94, 82, 82, 94, 95, 82, 95, 83, 84, 96, 97, 84, 97, 85, 85, 97, 98, 85, 98, 86, 86, 98, 99, 86, 99, 87, 87, 99, 100, 87, 100, 88, 88, 100, 101, 88, 101, 89, 90, 102, 103, 90, 103, 91, 91, 103, 104, 91, 104, 92, 92, 104, 105, 92, 105, 93, 93, 105, 106, 93, 106, 94, 94, 106, 107, 94, 107, 95, 96, 108, 109, 96, 109, 97, 97, 109, 110, 97, 110, 98, 98, 110, 111, 98, 111, 99, 99, 111, 112, 99, 112, 100, 100, 112, 113, 100, 113, 101, 102, 114, 115, 102, 115, 103, 103, 115, 116, 103, 116, 104, 104, 116, 117, 104, 117, 105, 105, 117, 118, 105, 118, 106, 106, 118, 119, 106, 119, 107, 108, 120, 121, 108, 121, 109, 109, 121, 122, 109, 122, 110, 110, 122, 123, 110, 123, 111, 111, 123, 124, 111, 124, 112, 112, 124, 125, 112, 125, 113, 114, 126, 127, 114, 127, 115, 115, 127, 128, 115, 128, 116, 116, 128, 129, 116, 129, 117, 117, 129, 130, 117, 130, 118, 118, 130, 131, 118, 131, 119, 120, 132, 133, 120, 133, 121, 121, 133, 134, 121, 134, 122, 122, 134, 135, 122, 135, 123, 123, 135, 136, 123, 136, 124, 124, 136, 137, 124, 137, 125, 126, 138, 139, 126, 139, 127, 127, 139, 140, 127, 140, 128, 128, 140, 141, 128, 141, 129, 129, 141, 142, 129, 142, 130, 130, 142, 143, 130, 143, 131, 144, 1, 0, 23, 22, 145, 144, 24, 1, 22, 35, 145, 144, 36, 24, 35, 47, 145, 144, 48, 36, 47, 59, 145, 144, 60, 48, 59, 71, 145, 144, 72, 60, 71, 83, 145, 144, 84, 72, 83, 95, 145, 144, 96, 84, 95, 107, 145, 144, 108, 96, 107, 119, 145, 144, 120, 108, 119, 131, 145, 144, 132, 120, 131, 143, 145, 144, 0, 132, 132, 0, 3, 132, 3, 133, 133, 3, 5, 133, 5, 134, 134, 5, 7, 134, 7, 135, 135, 7, 9, 135, 9, 136, 136, 9, 11, 136, 11, 137, 138, 12, 15, 138, 15, 139, 139, 15, 17, 139, 17, 140, 140, 17, 19, 140, 19, 141, 141, 19, 21, 141, 21, 142, 23, 143, 142, 23, 142, 21, 143, 23, 145
-			};
+		bool CreateNightSkyDomeGeometry(float radius, Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, unsigned short * indecies, int numIndecies)
+		{
+			int requiredVerts = 0;
+			int requiredIndecies = 0;
+			GetNightSkyDomeGeometrySize(&requiredVerts, &requiredIndecies);
+
+			if (vertecies == NULL || UVTextureCoordinates == NULL || indecies == NULL ||
+				numVertecies < requiredVerts || numIndecies < requiredIndecies)
+				return false;
 
 			//copy the vertecies
-			for (int i = 0; i < rtnVal->numVertecies; i++)
+			for (int i = 0; i < requiredVerts; i++)
 			{
-				vertex_struct tmp = vertices[i];
-				rtnVal->vertecies[i].X = tmp.x * radius;
-				rtnVal->vertecies[i].Y = tmp.y * radius;
-				rtnVal->vertecies[i].Z = tmp.z * radius;
+				const NightSkyDomeVertex & tmp = _NightSkyDomeVertecies[i];
+				vertecies[i].X = tmp.x * radius;
+				vertecies[i].Y = tmp.y * radius;
+				vertecies[i].Z = tmp.z * radius;
 
-				rtnVal->UVTextureCoordinates[i].X = tmp.u;
-				rtnVal->UVTextureCoordinates[i].Y = tmp.v;
+				UVTextureCoordinates[i].X = tmp.u;
+				UVTextureCoordinates[i].Y = tmp.v;
 			}
 
 			//copy the indecies
-			for (int i = 0; i < rtnVal->numIndecies; i++)
+			memcpy(indecies, _NightSkyDomeIndecies, requiredIndecies * sizeof(unsigned short));
+
+			return true;
+		}
+
+		///////////////////////////////////////////////////////////////////////
+		//			Shared geometry
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**
+			* Holds a RawGeometry in the AssetStore.
+			*/
+			class _GeometryAsset : public Asset
+			{
+			public:
+				RawGeometry * geometry;
+
+				_GeometryAsset(RawGeometry * geo) : geometry(geo)
+				{}
+
+				virtual ~_GeometryAsset()
+				{
+					delete geometry;
+				}
+
+			private:
+				_GeometryAsset(const _GeometryAsset & other);
+				_GeometryAsset & operator = (const _GeometryAsset & other);
+			};
+
+			/**
+			* The exact bits of a float for an asset key, so radii that only
+			* differ in the last bit are not mixed up.
+			*/
+			std::string _FloatKey(float value)
 			{
-				rtnVal->indecies[i] = indexes[i];
+				unsigned int bits = 0;
+				memcpy(&bits, &value, sizeof(bits));
+
+				return std::to_string(bits);
 			}
 
-			return rtnVal;
+			/**
+			* Get a shared pointer to the geometry held by an asset. The
+			* pointer shares ownership with the asset.
+			*/
+			std::shared_ptr<const RawGeometry> _GetGeometry(const std::shared_ptr<const Asset> & asset)
+			{
+				std::shared_ptr<const _GeometryAsset> geometryAsset = std::dynamic_pointer_cast<const _GeometryAsset>(asset);
+
+				if (!geometryAsset)
+					return std::shared_ptr<const RawGeometry>();
+
+				return std::shared_ptr<const RawGeometry>(geometryAsset, geometryAsset->geometry);
+			}
 		}
 
-		unsigned char * CreateMoonTexture(int * width, int * height)
+		std::shared_ptr<const RawGeometry> GetSharedSkyDomeGeometry(float radius, int numVerticalSegments, int numHorozontalSegments, bool fullDome, bool largeIndecies)
 		{
-			(*width) = moonImageData.width;
-			(*height) = moonImageData.height;
+			//the builder fixes up the segments the same way
+			//CreateSkyDomeGeometry does, so equal domes get equal keys
+			DomeGeometryBuilder builder(radius, numVerticalSegments, numHorozontalSegments, fullDome);
 
-			//format B G R A all 8 bits;
-			unsigned char * rtn = new unsigned char[moonImageData.width * moonImageData.height * 4];
+			largeIndecies = largeIndecies || builder.NeedsLargeIndecies();
 
-			memcpy(rtn, moonImageData.pixel_data, moonImageData.width * moonImageData.height * 4);
+			std::string key = "BIOSky/Geometry/SkyDome/" + _FloatKey(radius) +
+				"/" + std::to_string(builder.GetVerticalSegments()) +
+				"/" + std::to_string(builder.GetHorozontalSegments()) +
+				((fullDome) ? "/Full" : "/Half") +
+				((largeIndecies) ? "/32" : "/16");
 
-			/*
-			//convert from RGBA format to BGRA format
-			for (unsigned int y = 0; y < moonImageData.height; y++)
+			std::shared_ptr<const RawGeometry> shared = _GetGeometry(AssetStore::Find(key));
+
+			if (shared)
+				return shared;
+
+			RawGeometry * geometry = builder.Build();
+
+			if (largeIndecies && geometry->indecies)
 			{
-				for (unsigned int x = 0; x < moonImageData.width; x++)
-				{
-					int index = ((y * moonImageData.width) + x) * 4;
+				unsigned int * wide = AllocateArray<unsigned int>(geometry->numIndecies);
 
-					rtn[index] = moonImageData.pixel_data[index + 2];
-					rtn[index + 1] = moonImageData.pixel_data[index + 1];
-					rtn[index + 2] = moonImageData.pixel_data[index];
-					rtn[index + 3] = moonImageData.pixel_data[index + 3];
-				}
+				for (int i = 0; i < geometry->numIndecies; i++)
+					wide[i] = geometry->indecies[i];
+
+				FreeArray(geometry->indecies);
+				geometry->indecies = NULL;
+				geometry->indecies32 = wide;
 			}
-			//*/
+
+			//if another thread built it first the store keeps theirs
+			return _GetGeometry(AssetStore::Insert(key, std::make_shared<_GeometryAsset>(geometry)));
+		}
+
+		std::shared_ptr<const RawGeometry> GetSharedUnitSkyDomeGeometry(int numVerticalSegments, int numHorozontalSegments, bool fullDome, bool largeIndecies)
+		{
+			return GetSharedSkyDomeGeometry(1.0f, numVerticalSegments, numHorozontalSegments, fullDome, largeIndecies);
+		}
+
+		std::shared_ptr<const RawGeometry> GetSharedNightSkyDomeGeometry(float radius)
+		{
+			std::string key = "BIOSky/Geometry/NightSkyDome/" + _FloatKey(radius);
+
+			std::shared_ptr<const RawGeometry> shared = _GetGeometry(AssetStore::Find(key));
+
+			if (shared)
+				return shared;
+
+			return _GetGeometry(AssetStore::Insert(key, std::make_shared<_GeometryAsset>(CreateNightSkyDomeGeometry(radius))));
+		}
+
+		unsigned char * CreateMoonTexture(int * width, int * height)
+		{
+			int size = CreateMoonTexture(width, height, NULL, 0);
+
+			//format B G R A all 8 bits;
+			unsigned char * rtn = new unsigned char[size];
+
+			CreateMoonTexture(width, height, rtn, size);
 
 			return rtn;
 		}
 
+		int CreateMoonTexture(int * width, int * height, unsigned char * buffer, int bufferSize)
+		{
+			int size = moonImageData.width * moonImageData.height * 4;
+
+			if (width)
+				(*width) = moonImageData.width;
+
+			if (height)
+				(*height) = moonImageData.height;
+
+			//the image is already stored in B G R A format
+			if (buffer != NULL && bufferSize >= size)
+				memcpy(buffer, moonImageData.pixel_data, size);
+
+			return size;
+		}
+
 		unsigned char * CreateNightSkyTexture(int * width, int * height)
 		{
-			std::string filename = "NightSky.png";
+			int size = CreateNightSkyTexture(width, height, NULL, 0);
 
-			//std::vector<unsigned char> image;
-			unsigned char * image = NULL;
-			//unsigned char * buffer = NULL;
-			//std::size_t bufferSize = loadFile(&buffer, filename);
-			unsigned int w, h;
+			if (size == 0)
+				return NULL;
 
-			//if ((buffer == NULL) || (bufferSize == 0))
-			//	//std::cout << "Error loading file" << std::endl;
-			//	return NULL;
+			//format B G R A all 8 bits;
+			unsigned char * rtn = new unsigned char[size];
 
-			//lodepng::State tmp;
-			
-			//clock_t t = clock();
-			//int error = lodepng::decode(image, w, h, buffer, bufferSize);// tmp, buffer);
-			unsigned int error = lodepng_decode32(&image, &w, &h, xd_data, sizeof(xd_data));//buffer, bufferSize);
-			//t = clock() - t;
+			if (CreateNightSkyTexture(width, height, rtn, size) == 0)
+			{
+				delete[] rtn;
+				return NULL;
+			}
 
-			//std::cout << "Deconding png took: " << t << " clicks and " << ((float)t) / CLOCKS_PER_SEC << " seconds" << std::endl;
-			
+			return rtn;
+		}
+
+		int CreateNightSkyTexture(int * width, int * height, unsigned char * buffer, int bufferSize)
+		{
+			unsigned int w = 0;
+			unsigned int h = 0;
+
+			//read the size from the png header without decoding the image
+			LodePNGState state;
+			lodepng_state_init(&state);
+			unsigned int error = lodepng_inspect(&w, &h, &state, xd_data, sizeof(xd_data));
+			lodepng_state_cleanup(&state);
+
+			if (error != 0)
+				return 0;
+
+			if (width)
+				(*width) = w;
+
+			if (height)
+				(*height) = h;
+
+			int size = w * h * 4;
+
+			if (buffer == NULL || bufferSize < size)
+				return size;
+
+			BIOSKY_TRACE_SCOPE("Decode Night Sky Texture");
+
+			unsigned char * image = NULL;
+			error = lodepng_decode32(&image, &w, &h, xd_data, sizeof(xd_data));
 
 			if (error != 0)
-				//std::cout << "Error Decoding PNG" << std::endl;
+			{
+				//lodepng allocates with malloc
+				free(image);
+				return 0;
+			}
+
+			for (int i = 0; i < size; i = i + 4)
+			{
+				//RGBA to BGRA
+				buffer[i] = image[i + 2];
+				buffer[i + 1] = image[i + 1];
+				buffer[i + 2] = image[i];
+				buffer[i + 3] = image[i + 3];
+			}
+
+			free(image);
+
+			return size;
+		}
+
+		void FreeTexture(unsigned char * texture)
+		{
+			delete[] texture;
+		}
+
+		unsigned char * CreateNightSkyTexture(int * width, int * height, int maxSize)
+		{
+			std::shared_ptr<const TextureMipChain> chain = CreateNightSkyTextureMipChain(maxSize);
+
+			if (!chain)
 				return NULL;
 
-			(*width) = w;
-			(*height) = h;
+			const TextureMipChain::Level & level = chain->GetLevel(0);
 
-			//format B G R A all 8 bits;
-			unsigned char * rtn = new unsigned char[w * h * 4];
+			if (width)
+				(*width) = level.width;
+
+			if (height)
+				(*height) = level.height;
+
+			unsigned char * rtn = new unsigned char[level.width * level.height * 4];
+			memcpy(rtn, level.pixels, level.width * level.height * 4);
+
+			return rtn;
+		}
+
+		std::shared_ptr<const TextureMipChain> CreateNightSkyTextureMipChain(int maxSize)
+		{
+			int imageWidth = 0;
+			int imageHeight = 0;
+
+			//a maxSize the image already fits in is the full chain. Only the
+			//png header is read for the size.
+			if (maxSize < 0 || (CreateNightSkyTexture(&imageWidth, &imageHeight, NULL, 0) > 0 && maxSize >= std::max(imageWidth, imageHeight)))
+				maxSize = 0;
+
+			std::string key = "BIOSky/NightSky/MipChain/" + std::to_string(maxSize);
+
+			std::shared_ptr<const TextureMipChain> chain = AssetStore::Get<TextureMipChain>(key);
 
-			//t = clock();
-			for (unsigned int i = 0; i < w * h * 4; i = i + 4)
+			if (chain)
+				return chain;
+
+			if (maxSize > 0)
+			{
+				//if the full chain was already created start from the closest
+				//level instead of decoding the png again.
+				std::shared_ptr<const TextureMipChain> full = AssetStore::Get<TextureMipChain>("BIOSky/NightSky/MipChain/0");
+
+				if (full)
+				{
+					const TextureMipChain::Level & level = full->GetLevel(full->FindLevelForSize(maxSize));
+					chain = std::make_shared<TextureMipChain>(level.pixels, level.width, level.height);
+				}
+			}
+
+			if (!chain)
 			{
-				//RGBA
-				rtn[i] = image[i + 2];
-				rtn[i + 1] = image[i + 1];
-				rtn[i + 2] = image[i];
-				rtn[i + 3] = image[i + 3];
+				int w = 0;
+				int h = 0;
+
+				//decode into library memory rather than new[]
+				int size = CreateNightSkyTexture(&w, &h, NULL, 0);
+				unsigned char * image = AllocateArray<unsigned char>(size);
+
+				if (image == NULL || CreateNightSkyTexture(&w, &h, image, size) == 0)
+				{
+					FreeArray(image);
+					return chain;
+				}
+
+				chain = std::make_shared<TextureMipChain>(image, w, h, maxSize);
+
+				FreeArray(image);
 			}
-			//t = clock() - t;
-			//std::cout << "Converting to correct format took: " << t << " clicks and " << ((float)t) / CLOCKS_PER_SEC << " seconds"<<std::endl;
 
-			delete[] image;
-			//delete[] buffer;
+			return std::static_pointer_cast<const TextureMipChain>(AssetStore::Insert(key, chain));
+		}
+
+		unsigned char * CreateMoonTexture(int * width, int * height, int maxSize)
+		{
+			std::shared_ptr<const TextureMipChain> chain = CreateMoonTextureMipChain(maxSize);
+
+			if (!chain)
+				return NULL;
+
+			const TextureMipChain::Level & level = chain->GetLevel(0);
+
+			if (width)
+				(*width) = level.width;
+
+			if (height)
+				(*height) = level.height;
+
+			unsigned char * rtn = new unsigned char[level.width * level.height * 4];
+			memcpy(rtn, level.pixels, level.width * level.height * 4);
 
 			return rtn;
 		}
 
-		unsigned char * CreateSunTexture(int sideLength)
+		std::shared_ptr<const TextureMipChain> CreateMoonTextureMipChain(int maxSize)
 		{
-			//get the center point of the texture
-			float c = sideLength / 2.0f; //cx = cy = c
+			if (maxSize < 0 || maxSize >= (int)moonImageData.width)
+				maxSize = 0;
 
-			//calculate the radius of the sun
-			float radius = c * 0.45f;
+			std::string key = "BIOSky/Moon/MipChain/" + std::to_string(maxSize);
 
-			//calculate the fade radius of the sun
-			float radiusF = c * 0.55f;
+			std::shared_ptr<const TextureMipChain> chain = AssetStore::Get<TextureMipChain>(key);
 
-			//calculate the glow radius of the sun
-			float radiusG = c * 0.98f;
+			if (chain)
+				return chain;
 
-			const float glowStartPercent = 0.125f;
+			chain = std::make_shared<TextureMipChain>(moonImageData.pixel_data, moonImageData.width, moonImageData.height, maxSize);
 
-			//format B G R A all 8 bits;
-			unsigned char * rtn = new unsigned char[sideLength * sideLength * 4];
+			return std::static_pointer_cast<const TextureMipChain>(AssetStore::Insert(key, chain));
+		}
+
+		std::shared_ptr<const CompressedTexture> CreateNightSkyTextureCompressed(TEXTURE_BLOCK_FORMAT format, int maxSize)
+		{
+			int imageWidth = 0;
+			int imageHeight = 0;
 
-			for (int i = 0; i < sideLength; i++)
+			if (maxSize < 0 || (CreateNightSkyTexture(&imageWidth, &imageHeight, NULL, 0) > 0 && maxSize >= std::max(imageWidth, imageHeight)))
+				maxSize = 0;
+
+			std::string key = std::string("BIOSky/NightSky/") + ((format == BLOCK_FORMAT_BC3) ? "BC3/" : "BC1/") + std::to_string(maxSize);
+
+			std::shared_ptr<const CompressedTexture> texture = AssetStore::Get<CompressedTexture>(key);
+
+			if (texture)
+				return texture;
+
+			std::shared_ptr<const TextureMipChain> chain = CreateNightSkyTextureMipChain(maxSize);
+
+			if (!chain)
+				return std::shared_ptr<const CompressedTexture>();
+
+			texture = std::make_shared<CompressedTexture>(*chain, format);
+
+			return std::static_pointer_cast<const CompressedTexture>(AssetStore::Insert(key, texture));
+		}
+
+		std::shared_ptr<const NightSkyTiles> CreateNightSkyTiles(int tileSize)
+		{
+			if (tileSize <= 0)
+				tileSize = DefaultNightSkyTileSize;
+
+			std::string key = "BIOSky/NightSky/Tiles/" + std::to_string(tileSize);
+
+			std::shared_ptr<const NightSkyTiles> tiles = AssetStore::Get<NightSkyTiles>(key);
+
+			if (tiles)
+				return tiles;
+
+			//use the full resolution image if it is already decoded
+			std::shared_ptr<const TextureMipChain> full = AssetStore::Get<TextureMipChain>("BIOSky/NightSky/MipChain/0");
+
+			if (full)
+			{
+				const TextureMipChain::Level & level = full->GetLevel(0);
+				tiles = std::make_shared<NightSkyTiles>(level.pixels, level.width, level.height, tileSize);
+			}
+			else
 			{
-				for (int j = 0; j < sideLength; j++)
+				int w = 0;
+				int h = 0;
+				int size = CreateNightSkyTexture(&w, &h, NULL, 0);
+				unsigned char * image = AllocateArray<unsigned char>(size);
+
+				if (image == NULL || CreateNightSkyTexture(&w, &h, image, size) == 0)
 				{
-					int index = ((i * sideLength) + j) * 4;
+					FreeArray(image);
+					return std::shared_ptr<const NightSkyTiles>();
+				}
 
-					//B value
-					rtn[index] = 255;
+				tiles = std::make_shared<NightSkyTiles>(image, w, h, tileSize);
 
-					//G value
-					rtn[index + 1] = 255;
+				FreeArray(image);
+			}
 
-					//R Value
-					rtn[index + 2] = 255;
+			return std::static_pointer_cast<const NightSkyTiles>(AssetStore::Insert(key, tiles));
+		}
 
-					float dist = MATH::Distance((float)i, (float)j, c, c);
+		std::shared_ptr<const CompressedTexture> CreateMoonTextureCompressed(TEXTURE_BLOCK_FORMAT format, bool separateAlpha)
+		{
+			std::string key = std::string("BIOSky/Moon/") + ((format == BLOCK_FORMAT_BC3) ? "BC3" : "BC1") + (separateAlpha ? "A8" : "");
 
-					if (dist <= radius)
-					{
-						//A Value
-						rtn[index + 3] = 255; //completely opaque
-					}
-					else if (dist <= radiusF)
-					{
-						//fade the sun
-						//A Value
-						rtn[index + 3] = (unsigned char)((((1 - ((dist - radius) / (radiusF - radius))) * (1.0f - glowStartPercent)) + glowStartPercent) * 255.0f);
-					}
-					else if (dist <= radiusG)
-					{
-						//Add the glow
-						//A Value
-						rtn[index + 3] = (unsigned char)(((1 - ((dist - radius) / (radiusG - radius))) * glowStartPercent) * 255.0f);
-					}
-					else
+			std::shared_ptr<const CompressedTexture> texture = AssetStore::Get<CompressedTexture>(key);
+
+			if (texture)
+				return texture;
+
+			std::shared_ptr<const TextureMipChain> chain = CreateMoonTextureMipChain();
+
+			if (!chain)
+				return std::shared_ptr<const CompressedTexture>();
+
+			texture = std::make_shared<CompressedTexture>(*chain, format, separateAlpha);
+
+			return std::static_pointer_cast<const CompressedTexture>(AssetStore::Insert(key, texture));
+		}
+
+		void ApplyMoonPhaseToAlpha(float phase, unsigned char * alpha, int width, int height, int pixelStride)
+		{
+			if (alpha == NULL || width <= 0 || height <= 0)
+				return;
+
+			//reduce phase to [0,360]
+			phase = MATH::RevolutionReductionDegrees(phase);
+
+			int quarter = 0; //0=first 1=second 2=third 3=fourth
+
+			//calculate center
+			int centerX = (int)(((float)width) * 0.5f);
+			int centerY = (int)(((float)height) * 0.5f);
+
+			//calculate height of Ellipse
+			int ellipseHeight = (int)(((float)height - 1) / 2.0f);
+
+			//calculate width of Ellipse
+			int ellipseWidth;
+
+			if (phase > 180)
+			{
+				phase -= 180;
+				quarter += 2;
+			}
+
+			if (phase > 90)
+			{
+				phase -= 90;
+				quarter += 1;
+				ellipseWidth = (int)(centerX - ((float)(centerX - 1) * (1 - (phase / 90.0f))));
+			}
+			else
+			{
+				ellipseWidth = (int)(centerX - ((float)(centerX - 1) * (phase / 90.0f)));
+			}
+
+			int hh = ellipseHeight * ellipseHeight;
+			int ww = ellipseWidth * ellipseWidth;
+			int hhww = hh * ww;
+			int x0 = ellipseWidth;
+			int dx = 0;
+
+			//start at the horozontal diameter and work out
+			for (int y = 0; y <= ellipseHeight; y++)
+			{
+				if (y > 0)
+				{
+					int x1 = x0 - (dx - 1);
+					for (; x1 > 0; x1--)
 					{
-						//A Value
-						rtn[index + 3] = 0; //completely transparent
+						if (x1*x1*hh + y*y*ww <= hhww)
+							break;
 					}
+					dx = x0 - x1;
+					x0 = x1;
 				}
-			}
 
-			return rtn;
-		}
+				int start;
+				int end;
+
+				if (quarter == 0)//first Quarter
+				{
+					start = 0;
+					end = centerX + x0;
+				}
+				else if (quarter == 1)//second quarter
+				{
+					start = 0;
+					end = centerX - x0;
+				}
+				else if (quarter == 2)//third quarter
+				{
+					start = centerX + x0;
+					end = width - 1;
+				}
+				else //fourth quarter
+				{
+					start = centerX - x0;
+					end = width - 1;
+				}
+
+				if (start < 0)
+					start = 0;
 
+				if (end > width - 1)
+					end = width - 1;
+
+				int rows[2] = { centerY + y, centerY - y };
+				int numRows = (y == 0) ? 1 : 2;
+
+				for (int r = 0; r < numRows; r++)
+				{
+					if (rows[r] < 0 || rows[r] >= height)
+						continue;
+
+					unsigned char * line = alpha + (std::size_t)rows[r] * width * pixelStride;
+
+					for (int x = start; x <= end; x++)
+						line[x * pixelStride] = 0;
+				}
+			}
+		}
 
 		///////////////////////////////////////////////////////////////////////
 		///////////////////////////////////////////////////////////////////////
@@ -930,6 +1458,12 @@ namespace BIO
 		///////////////////////////////////////////////////////////////////////
 
 #if BIOSKY_TESTING == 1
+		//defined in SunTexture.cpp
+		bool SunTextureTests(XNELO::TESTING::Test * test);
+
+		//defined in SkyDomeGenerators.cpp
+		bool DomeGeneratorTests(XNELO::TESTING::Test * test);
+
 		bool LibraryTests(XNELO::TESTING::Test * test)
 		{
 			test->SetName("BIOSky Functions Test");
@@ -1111,6 +1645,31 @@ namespace BIO
 			zenith = CalculateCelestialNorthPoleZenith(-21.06f * MATH::DegreesToRadiansf);
 			test->UnitTest(zenith, 1.938362667f, rotationTolerance, "StarZenith [1]");
 
+			//sky luminance and the limiting magnitude
+			float night = CalculateZenithSkyLuminance(120.0f * MATH::DegreesToRadiansf);
+			float twilight = CalculateZenithSkyLuminance(99.0f * MATH::DegreesToRadiansf);
+			float day = CalculateZenithSkyLuminance(40.0f * MATH::DegreesToRadiansf);
+			test->UnitTest(night < 0.001f && twilight > night && day > 5000.0f, "Zenith sky luminance");
+			test->UnitTest(std::fabs(CalculateZenithSkyLuminance(MATH::PId2f) - 794.3f) < 1.0f, "Zenith sky luminance at sunset");
+
+			float darkLimit = CalculateLimitingMagnitude(night);
+			test->UnitTest(darkLimit > 6.0f && darkLimit < 7.0f, "Dark sky limiting magnitude");
+			test->UnitTest(CalculateLimitingMagnitude(0.0f) < 8.0f && CalculateLimitingMagnitude(0.0f) >= darkLimit, "Darkest sky limiting magnitude");
+			test->UnitTest(CalculateLimitingMagnitude(day) < -3.0f, "Day limiting magnitude");
+
+			bool fading = true;
+			float lastLimit = 100.0f;
+			for (float sunZenith = 0.0f; sunZenith < MATH::PIf; sunZenith += 0.01f)
+			{
+				float limit = CalculateLimitingMagnitude(CalculateZenithSkyLuminance(MATH::PIf - sunZenith));
+
+				if (limit > lastLimit + 0.0001f)
+					fading = false;
+
+				lastLimit = limit;
+			}
+			test->UnitTest(fading, "Stars fade as the sun rises");
+
 			SkyPosition sun = CalculateSunPosition(6.6f, -6, MARCH, 13, 2015, 41 * MATH::DegreesToRadiansf, -112 * MATH::DegreesToRadiansf);
 			SkyPosition moon = CalculateMoonPosition(6.6f, -6, MARCH, 13, 2015, 41 * MATH::DegreesToRadiansf, -112 * MATH::DegreesToRadiansf);
 			SkyData tmp;
@@ -1124,7 +1683,8 @@ namespace BIO
 
 			float phaseTolerance = 0.01f;
 
-			test->UnitTest(tmp.phase, 267.164f, phaseTolerance, "SkyData[3]");
+			//the same formula summed in double precision
+			test->UnitTest(tmp.phase, 267.1746f, phaseTolerance, "SkyData[3]");
 
 			test->UnitTest(tmp.starRotation, 5.829399701f, rotationTolerance, "SkyData[4]");
 
@@ -1191,6 +1751,194 @@ namespace BIO
 			delete[] rtn;
 			*/
 
+			//Geometry in caller buffers
+			int domeVerts = 0;
+			int domeIndecies = 0;
+			GetSkyDomeGeometrySize(12, 11, true, &domeVerts, &domeIndecies);
+			test->UnitTest(domeVerts == 11 * 12 + 2 && domeIndecies == 2 * 12 * 11 * 3, "Sky dome geometry size");
+
+			AllocationStats statsBefore = GetAllocationStats();
+			RawGeometry * dome = CreateSkyDomeGeometry(2.0f, 12, 11, true);
+			test->UnitTest(dome->numVertecies == domeVerts && dome->numIndecies == domeIndecies, "Sky dome geometry counts");
+			test->UnitTest(GetAllocationStats().currentAllocations == statsBefore.currentAllocations + 4, "Sky dome geometry uses the allocator");
+
+			Vector3D * domeVertBuffer = new Vector3D[domeVerts];
+			Vector2D * domeUVBuffer = new Vector2D[domeVerts];
+			unsigned short * domeIndexBuffer = new unsigned short[domeIndecies];
+
+			test->UnitTest(!CreateSkyDomeGeometry(2.0f, 12, 11, true, domeVertBuffer, domeUVBuffer, domeVerts - 1, domeIndexBuffer, domeIndecies), "Sky dome buffer too small");
+			test->UnitTest(CreateSkyDomeGeometry(2.0f, 12, 11, true, domeVertBuffer, domeUVBuffer, domeVerts, domeIndexBuffer, domeIndecies), "Sky dome in caller buffers");
+
+			bool sameDome = memcmp(domeIndexBuffer, dome->indecies, domeIndecies * sizeof(unsigned short)) == 0;
+			for (int i = 0; i < domeVerts; ++i)
+			{
+				if (domeVertBuffer[i].X != dome->vertecies[i].X || domeVertBuffer[i].Y != dome->vertecies[i].Y || domeVertBuffer[i].Z != dome->vertecies[i].Z ||
+					domeUVBuffer[i].X != dome->UVTextureCoordinates[i].X || domeUVBuffer[i].Y != dome->UVTextureCoordinates[i].Y)
+					sameDome = false;
+			}
+			test->UnitTest(sameDome, "Sky dome caller buffers match");
+
+			delete[] domeIndexBuffer;
+			delete[] domeUVBuffer;
+			delete[] domeVertBuffer;
+
+			delete dome;
+			test->UnitTest(GetAllocationStats().currentBytes == statsBefore.currentBytes, "Sky dome geometry released");
+
+			GetSkyDomeGeometrySize(8, 4, false, &domeVerts, &domeIndecies);
+			dome = CreateSkyDomeGeometry(1.0f, 8, 4, false);
+			test->UnitTest(dome->numVertecies == domeVerts && dome->numIndecies == domeIndecies, "Hemisphere geometry counts");
+			delete dome;
+
+			GetNightSkyDomeGeometrySize(&domeVerts, &domeIndecies);
+			test->UnitTest(domeVerts == 146 && domeIndecies == 792, "Night sky geometry size");
+
+			dome = CreateNightSkyDomeGeometry(2.0f);
+			const NightSkyDomeVertex * nightVerts = GetNightSkyDomeVertecies();
+			const unsigned short * nightIndecies = GetNightSkyDomeIndecies();
+			bool sameNightSky = true;
+			for (int i = 0; i < domeVerts; i++)
+			{
+				if (dome->vertecies[i].Y != nightVerts[i].y * 2.0f || dome->UVTextureCoordinates[i].X != nightVerts[i].u)
+					sameNightSky = false;
+			}
+			for (int i = 0; i < domeIndecies; i++)
+			{
+				if (dome->indecies[i] != nightIndecies[i])
+					sameNightSky = false;
+			}
+			test->UnitTest(sameNightSky, "Night sky geometry view");
+			test->UnitTest(nightVerts[144].y == 1.0f && nightVerts[145].y == -1.0f, "Night sky geometry poles");
+			delete dome;
+
+			//Shared geometry
+			std::shared_ptr<const RawGeometry> shared = GetSharedSkyDomeGeometry(3.0f, 12, 12, true);
+			test->UnitTest(shared && shared.get() == GetSharedSkyDomeGeometry(3.0f, 12, 12, true).get(), "Shared dome is shared");
+			test->UnitTest(shared.get() == GetSharedSkyDomeGeometry(3.0f, 12, 11, true).get(), "Shared dome segments are fixed up before lookup");
+			test->UnitTest(shared.get() != GetSharedSkyDomeGeometry(3.0f, 12, 12, false).get(), "Shared hemisphere is separate");
+			test->UnitTest(shared.get() != GetSharedSkyDomeGeometry(3.0000002f, 12, 12, true).get(), "Shared dome radius key is exact");
+
+			dome = CreateSkyDomeGeometry(3.0f, 12, 12, true);
+			bool sameShared = (dome->numVertecies == shared->numVertecies && dome->numIndecies == shared->numIndecies && shared->indecies != NULL);
+			for (int i = 0; sameShared && i < dome->numIndecies; i++)
+				sameShared = (dome->indecies[i] == shared->indecies[i]);
+			for (int i = 0; sameShared && i < dome->numVertecies; i++)
+				sameShared = (std::fabs(dome->vertecies[i].Y - shared->vertecies[i].Y) < 0.0001f);
+			test->UnitTest(sameShared, "Shared dome matches CreateSkyDomeGeometry");
+
+			std::shared_ptr<const RawGeometry> sharedWide = GetSharedSkyDomeGeometry(3.0f, 12, 12, true, true);
+			bool sameWide = (sharedWide->indecies == NULL && sharedWide->indecies32 != NULL && sharedWide->numIndecies == dome->numIndecies);
+			for (int i = 0; sameWide && i < dome->numIndecies; i++)
+				sameWide = (dome->indecies[i] == sharedWide->indecies32[i]);
+			test->UnitTest(sameWide, "Shared dome with 32 bit indecies");
+			delete dome;
+
+			std::shared_ptr<const RawGeometry> sharedUnit = GetSharedUnitSkyDomeGeometry(12, 12);
+			test->UnitTest(sharedUnit.get() == GetSharedSkyDomeGeometry(1.0f).get() && sharedUnit->vertecies[0].Y == 1.0f, "Shared unit dome");
+
+			std::shared_ptr<const RawGeometry> sharedNight = GetSharedNightSkyDomeGeometry(1.0f);
+			test->UnitTest(sharedNight && sharedNight.get() == GetSharedNightSkyDomeGeometry(1.0f).get() && sharedNight->numVertecies == 146, "Shared night sky dome");
+
+			//every thread gets the same copy
+			const RawGeometry * threadResults[4] = { NULL, NULL, NULL, NULL };
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; t++)
+			{
+				threads.push_back(std::thread([&threadResults, t]()
+				{
+					threadResults[t] = GetSharedSkyDomeGeometry(5.0f, 24, 12, false).get();
+				}));
+			}
+			for (int t = 0; t < 4; t++)
+				threads[t].join();
+			test->UnitTest(threadResults[0] != NULL && threadResults[0] == threadResults[1] &&
+				threadResults[0] == threadResults[2] && threadResults[0] == threadResults[3], "Shared dome is the same on every thread");
+
+			//Textures in caller buffers
+			int textureWidth = 0;
+			int textureHeight = 0;
+			int textureSize = CreateMoonTexture(&textureWidth, &textureHeight, NULL, 0);
+			test->UnitTest(textureSize == 256 * 256 * 4 && textureWidth == 256 && textureHeight == 256, "Moon texture size query");
+
+			textureSize = CreateNightSkyTexture(&textureWidth, &textureHeight, NULL, 0);
+			test->UnitTest(textureSize == 4096 * 4096 * 4 && textureWidth == 4096 && textureHeight == 4096, "Night sky texture size query");
+
+			//the returned textures are still new[] so callers can delete[] them
+			statsBefore = GetAllocationStats();
+			unsigned char * moonTexture = CreateMoonTexture(&textureWidth, &textureHeight);
+			test->UnitTest(GetAllocationStats().currentBytes == statsBefore.currentBytes, "Moon texture is created with new[]");
+			delete[] moonTexture;
+
+			//user filled geometry is released with delete[]
+			statsBefore = GetAllocationStats();
+			RawGeometry * userGeometry = new RawGeometry();
+			userGeometry->vertecies = new Vector3D[4];
+			userGeometry->UVTextureCoordinates = new Vector2D[4];
+			userGeometry->indecies = new unsigned short[6];
+			delete userGeometry;
+
+			RawGeometry * allocatedGeometry = new RawGeometry();
+			allocatedGeometry->AllocateArrays(4, 6);
+			test->UnitTest(GetAllocationStats().currentBytes > statsBefore.currentBytes, "RawGeometry::AllocateArrays uses the allocator");
+			delete allocatedGeometry;
+			test->UnitTest(GetAllocationStats().currentBytes == statsBefore.currentBytes, "RawGeometry released");
+
+			//Texture mip chains
+			std::shared_ptr<const TextureMipChain> moonChain = CreateMoonTextureMipChain();
+			test->UnitTest(moonChain && moonChain->GetLevelCount() == 9, "Moon mip chain level count");
+			test->UnitTest(moonChain->GetLevel(0).width == 256 && moonChain->GetLevel(0).height == 256, "Moon mip chain level 0 size");
+			test->UnitTest(memcmp(moonChain->GetLevel(0).pixels, moonImageData.pixel_data, 256 * 256 * 4) == 0, "Moon mip chain level 0 data");
+			test->UnitTest(CreateMoonTextureMipChain().get() == moonChain.get(), "Moon mip chain is cached");
+			test->UnitTest(CreateMoonTextureMipChain(256).get() == moonChain.get(), "Moon mip chain full size request");
+
+			std::shared_ptr<const TextureMipChain> nightChain = CreateNightSkyTextureMipChain();
+			test->UnitTest(nightChain && nightChain->GetLevel(0).width == 4096, "Night sky mip chain level 0 size");
+			test->UnitTest(CreateNightSkyTextureMipChain(8192).get() == nightChain.get(), "Night sky mip chain full size request");
+			nightChain.reset();
+			AssetStore::Remove("BIOSky/NightSky/MipChain/0");
+
+			int reducedWidth = 0;
+			int reducedHeight = 0;
+			unsigned char * reduced = CreateMoonTexture(&reducedWidth, &reducedHeight, 100);
+			test->UnitTest(reducedWidth == 64 && reducedHeight == 64, "Reduced moon texture size");
+			test->UnitTest(memcmp(reduced, moonChain->GetLevel(2).pixels, 64 * 64 * 4) == 0, "Reduced moon texture matches mip level");
+			FreeTexture(reduced);
+
+			reduced = CreateMoonTexture(NULL, NULL, 100);
+			test->UnitTest(reduced != NULL, "Reduced moon texture without a size");
+			FreeTexture(reduced);
+
+			//Compressed textures
+			std::shared_ptr<const CompressedTexture> moonCompressed = CreateMoonTextureCompressed();
+			test->UnitTest(moonCompressed && moonCompressed->GetLevelCount() == 9, "Compressed moon level count");
+			test->UnitTest(moonCompressed->GetLevel(0).blocksSize == 256 * 256 / 2, "Compressed moon is BC1");
+			test->UnitTest(CreateMoonTextureCompressed().get() == moonCompressed.get(), "Compressed moon is cached");
+			test->UnitTest(CreateMoonTextureCompressed(BLOCK_FORMAT_BC3, false).get() != moonCompressed.get(), "Compressed moon keyed by format");
+
+			bool alphaMatches = true;
+			for (int i = 0; i < 256 * 256; ++i)
+			{
+				if (moonCompressed->GetLevel(0).alpha[i] != moonImageData.pixel_data[i * 4 + 3])
+					alphaMatches = false;
+			}
+			test->UnitTest(alphaMatches, "Compressed moon alpha plane");
+
+			//moon phase mask
+			unsigned char * alphaPlane = new unsigned char[256 * 256];
+			memcpy(alphaPlane, moonCompressed->GetLevel(0).alpha, 256 * 256);
+			ApplyMoonPhaseToAlpha(0.0f, alphaPlane, 256, 256, 1);
+			test->UnitTest(alphaPlane[128 * 256 + 128] == 0 && alphaPlane[128 * 256 + 255] == 0, "New moon hides the center row");
+			test->UnitTest(alphaPlane[0] == moonImageData.pixel_data[3], "New moon leaves the corner");
+
+			memcpy(alphaPlane, moonCompressed->GetLevel(0).alpha, 256 * 256);
+			ApplyMoonPhaseToAlpha(180.0f, alphaPlane, 256, 256, 1);
+			test->UnitTest(alphaPlane[128 * 256 + 128] == moonImageData.pixel_data[(128 * 256 + 128) * 4 + 3], "Full moon keeps the center");
+
+			memcpy(alphaPlane, moonCompressed->GetLevel(0).alpha, 256 * 256);
+			ApplyMoonPhaseToAlpha(270.0f, alphaPlane, 256, 256, 1);
+			test->UnitTest(alphaPlane[128 * 256 + 200] == 0 && alphaPlane[128 * 256 + 50] == moonImageData.pixel_data[(128 * 256 + 50) * 4 + 3], "Third quarter hides the right half");
+			delete[] alphaPlane;
+
 			return test->GetSuccess();
 		}
 
@@ -1207,11 +1955,34 @@ namespace BIO
 			tests.AddTestFunction(&SkyPosition::Test);
 			tests.AddTestFunction(&Vector3D::Test);
 			tests.AddTestFunction(&Vector2D::Test);
+			tests.AddTestFunction(&CALENDAR::CalendarTests);
 			tests.AddTestFunction(&Date::Test);
 			tests.AddTestFunction(&DateTime::Test);
+			tests.AddTestFunction(&Timestamp::Test);
 			tests.AddTestFunction(&GPS::Test);
+			tests.AddTestFunction(&AllocatorTests);
+			tests.AddTestFunction(&AssetStore::Test);
+			tests.AddTestFunction(&TextureMipChain::Test);
+			tests.AddTestFunction(&CompressedTexture::Test);
+			tests.AddTestFunction(&NightSkyTiles::Test);
+			tests.AddTestFunction(&DomeGeometryBuilder::Test);
+			tests.AddTestFunction(&DomeGeneratorTests);
+			tests.AddTestFunction(&SkyDomeLODSet::Test);
+			tests.AddTestFunction(&GeometryBuffer::Test);
+			tests.AddTestFunction(&StarCatalog::Test);
+			tests.AddTestFunction(&StarIndex::Test);
+			tests.AddTestFunction(&PlanetTests);
+			tests.AddTestFunction(&EphemerisCache::Test);
+			tests.AddTestFunction(&SkyEventTests);
+			tests.AddTestFunction(&CalendarEventTests);
 			tests.AddTestFunction(&LibraryTests);
+			tests.AddTestFunction(&SunTextureTests);
 			tests.AddTestFunction(&Sky::Tests);
+			tests.AddTestFunction(&SkyStatePublisher::Test);
+			tests.AddTestFunction(&SkyCalculatedAsync::Test);
+			tests.AddTestFunction(&SkyCommandQueue::Test);
+			tests.AddTestFunction(&SkyPerfCounterTests);
+			tests.AddTestFunction(&SkyTraceTests);
 
 			tests.ExecuteTests();
 
@@ -0,0 +1,279 @@
+/**
+* @file Calendar.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Tests for the calendar functions.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "Calendar.hpp"
+
+#if BIOSKY_TESTING == 1
+#include "Date.hpp"
+#include "BIOSkyFunctions.hpp"
+#endif
+
+#if BIOSKY_HAS_CONSTEXPR
+//These fold at compile time or the library does not build.
+static_assert(BIO::CALENDAR::JulianDay(BIO::JANUARY, 1, 2000) == 2451544.5, "JulianDay is not constexpr");
+static_assert(BIO::CALENDAR::DaysSinceJan02000(BIO::JANUARY, 1, 2000) == 1, "DaysSinceJan02000 is not constexpr");
+static_assert(BIO::CALENDAR::DayOfYear(BIO::DECEMBER, 31, 2000) == 366, "DayOfYear is not constexpr");
+static_assert(BIO::CALENDAR::IntToMonth(BIO::CALENDAR::MonthToInt(BIO::MAY)) == BIO::MAY, "MonthToInt is not constexpr");
+#endif
+
+namespace BIO
+{
+	namespace CALENDAR
+	{
+#if BIOSKY_TESTING == 1
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//				Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			//The switch statements and float math the tables replaced, kept
+			//to test against.
+
+			bool _ReferenceIsLeapYear(unsigned int year)
+			{
+				if ((year % 4) == 0)
+				{
+					if ((year % 100) == 0)
+					{
+						if ((year % 400) == 0)
+							return true;
+					}
+					else
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			unsigned int _ReferenceDaysInMonth(DATE_MONTH month, unsigned int year)
+			{
+				switch (month)
+				{
+				case JANUARY: return 31;
+				case FEBRUARY: return _ReferenceIsLeapYear(year) ? 29 : 28;
+				case MARCH: return 31;
+				case APRIL: return 30;
+				case MAY: return 31;
+				case JUNE: return 30;
+				case JULY: return 31;
+				case AUGUST: return 31;
+				case SEPTEMBER: return 30;
+				case OCTOBER: return 31;
+				case NOVEMBER: return 30;
+				case DECEMBER: return 31;
+				default: return 30;
+				}
+			}
+
+			unsigned int _ReferenceNumDaysBefore(DATE_MONTH month, unsigned int year)
+			{
+				int addValue = _ReferenceIsLeapYear(year) ? 1 : 0;
+
+				switch (month)
+				{
+				case FEBRUARY: return 31;
+				case MARCH: return 59 + addValue;
+				case APRIL: return 90 + addValue;
+				case MAY: return 120 + addValue;
+				case JUNE: return 151 + addValue;
+				case JULY: return 181 + addValue;
+				case AUGUST: return 212 + addValue;
+				case SEPTEMBER: return 243 + addValue;
+				case OCTOBER: return 273 + addValue;
+				case NOVEMBER: return 304 + addValue;
+				case DECEMBER: return 334 + addValue;
+				case JANUARY:
+				default: return 0;
+				}
+			}
+
+			int _ReferenceMonthToInt(DATE_MONTH month)
+			{
+				switch (month)
+				{
+				case JANUARY: return 1;
+				case FEBRUARY: return 2;
+				case MARCH: return 3;
+				case APRIL: return 4;
+				case MAY: return 5;
+				case JUNE: return 6;
+				case JULY: return 7;
+				case AUGUST: return 8;
+				case SEPTEMBER: return 9;
+				case OCTOBER: return 10;
+				case NOVEMBER: return 11;
+				case DECEMBER: return 12;
+				default: return 1;
+				}
+			}
+
+			DATE_MONTH _ReferenceIntToMonth(int month)
+			{
+				switch (month)
+				{
+				case 2: return FEBRUARY;
+				case 3: return MARCH;
+				case 4: return APRIL;
+				case 5: return MAY;
+				case 6: return JUNE;
+				case 7: return JULY;
+				case 8: return AUGUST;
+				case 9: return SEPTEMBER;
+				case 10: return OCTOBER;
+				case 11: return NOVEMBER;
+				case 12: return DECEMBER;
+				default: return JANUARY;
+				}
+			}
+
+			float _ReferenceJulianDay(DATE_MONTH month, unsigned int day, int year)
+			{
+				int monthInt = _ReferenceMonthToInt(month);
+
+				if (monthInt <= 2)
+				{
+					year -= 1;
+					monthInt += 12;
+				}
+
+				int A = 0;
+				int B = 0;
+
+				if (year > 1582)
+				{
+					A = (int)(year / 100);
+					B = 2 - A + (int)(A / 4);
+				}
+
+				return (int)(365.25*(year + 4716)) + (int)(30.6001 * (monthInt + 1)) + day + B - 1524.5f;
+			}
+
+			int _ReferenceDaysSinceJan02000(DATE_MONTH month, unsigned int day, unsigned int year)
+			{
+				int monthint = _ReferenceMonthToInt(month);
+
+				return (367 * (int)year - (7 * ((int)year + ((monthint + 9) / 12))) / 4 + (275 * monthint) / 9 + (int)day - 730530);
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		bool CalendarTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Calendar Tests");
+
+			static BIOSKY_CONSTEXPR const double j2000 = JulianDay(JANUARY, 1, 2000) + 0.5;
+			test->UnitTest(j2000 == 2451545.0, "Test constant Julian day");
+
+			bool monthsMatch = true;
+			for (int i = -5; i <= 20; i++)
+			{
+				if (IntToMonth(i) != _ReferenceIntToMonth(i))
+					monthsMatch = false;
+			}
+			for (int i = 0; i < 14; i++)
+			{
+				if (MonthToInt((DATE_MONTH)i) != _ReferenceMonthToInt((DATE_MONTH)i))
+					monthsMatch = false;
+			}
+			test->UnitTest(monthsMatch, "Test MonthToInt and IntToMonth");
+
+			//every day from -4712 to 9999
+			bool julianMatches = true;
+			bool leapMatches = true;
+			bool daysInMonthMatch = true;
+			bool daysBeforeMatch = true;
+			bool dayOfYearMatches = true;
+			bool daysSince2000Match = true;
+
+			for (int year = -4712; year <= 9999; year++)
+			{
+				if ((year >= 0) && (IsLeapYear(year) != _ReferenceIsLeapYear(year)))
+					leapMatches = false;
+
+				for (int m = 0; m < 12; m++)
+				{
+					DATE_MONTH month = (DATE_MONTH)m;
+
+					if (year >= 0)
+					{
+						if (DaysInMonth(month, year) != _ReferenceDaysInMonth(month, year))
+							daysInMonthMatch = false;
+
+						if (DaysBeforeMonth(month, year) != _ReferenceNumDaysBefore(month, year))
+							daysBeforeMatch = false;
+					}
+
+					for (unsigned int day = 1; day <= 31; day++)
+					{
+						if ((float)JulianDay(month, day, year) != _ReferenceJulianDay(month, day, year))
+							julianMatches = false;
+
+						if (year >= 0)
+						{
+							if (DayOfYear(month, day, year) != _ReferenceNumDaysBefore(month, year) + day)
+								dayOfYearMatches = false;
+
+							if (DaysSinceJan02000(month, day, year) != _ReferenceDaysSinceJan02000(month, day, year))
+								daysSince2000Match = false;
+						}
+					}
+				}
+			}
+
+			test->UnitTest(julianMatches, "Test JulianDay from -4712 to 9999");
+			test->UnitTest(leapMatches, "Test IsLeapYear from 0 to 9999");
+			test->UnitTest(daysInMonthMatch, "Test DaysInMonth from 0 to 9999");
+			test->UnitTest(daysBeforeMatch, "Test DaysBeforeMonth from 0 to 9999");
+			test->UnitTest(dayOfYearMatches, "Test DayOfYear from 0 to 9999");
+			test->UnitTest(daysSince2000Match, "Test DaysSinceJan02000 from 0 to 9999");
+
+			//the old entry points go through the tables
+			test->UnitTest(SKY::CalculateJulianDay(JANUARY, 2, -4712) == 0.5f, "Test CalculateJulianDay");
+			test->UnitTest(SKY::DaysSinceJan02000(JANUARY, 1, 2000) == 1, "Test SKY::DaysSinceJan02000");
+			test->UnitTest(Date::DaysInMonth(FEBRUARY, 1900) == 28, "Test Date::DaysInMonth");
+			test->UnitTest(Date::CalculateDayOfYear(MARCH, 1, 2000) == 61, "Test Date::CalculateDayOfYear");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace CALENDAR
+}//end namespace BIO
@@ -138,79 +138,47 @@ namespace BIO
 		return tmp;//return the old value
 	}
 
+	long long Date::DaysFromCivil(DATE_MONTH month, unsigned int day, unsigned int year)
+	{
+		//Count from March 1 so the leap day is the last day of the year.
+		long long m = MonthToInt(month);
+		long long y = (long long)year - ((m <= 2) ? 1 : 0);
+		long long era = ((y >= 0) ? y : (y - 399)) / 400;
+		long long yearOfEra = y - era * 400;//[0, 399]
+		long long dayOfYear = (153 * ((m > 2) ? (m - 3) : (m + 9)) + 2) / 5 + day - 1;//[0, 365]
+		long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;//[0, 146096]
+
+		return era * 146097 + dayOfEra - 719468;
+	}
+
+	void Date::CivilFromDays(long long dayNumber, DATE_MONTH * month, unsigned int * day, unsigned int * year)
+	{
+		long long z = dayNumber + 719468;
+		long long era = ((z >= 0) ? z : (z - 146096)) / 146097;
+		long long dayOfEra = z - era * 146097;//[0, 146096]
+		long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;//[0, 399]
+		long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);//[0, 365]
+		long long mp = (5 * dayOfYear + 2) / 153;//[0, 11] from March
+		long long m = (mp < 10) ? (mp + 3) : (mp - 9);
+
+		*day = (unsigned int)(dayOfYear - (153 * mp + 2) / 5 + 1);
+		*month = IntToMonth((int)m);
+		*year = (unsigned int)(yearOfEra + era * 400 + ((m <= 2) ? 1 : 0));
+	}
+
 	unsigned int Date::DaysInMonth(DATE_MONTH month, unsigned int year)
 	{
-		switch (month)
-		{
-		case JANUARY:
-			return 31;
-		case FEBRUARY:
-			if (IsLeapYear(year))
-				return 29;
-			return 28;
-		case MARCH:
-			return 31;
-		case APRIL:
-			return 30;
-		case MAY:
-			return 31;
-		case JUNE:
-			return 30;
-		case JULY:
-			return 31;
-		case AUGUST:
-			return 31;
-		case SEPTEMBER:
-			return 30;
-		case OCTOBER:
-			return 31;
-		case NOVEMBER:
-			return 30;
-		case DECEMBER:
-			return 31;
-		default:
-			return 30;
-		}
+		return CALENDAR::DaysInMonth(month, (int)year);
 	}
 
 	DATE_MONTH Date::IntToMonth(int month)
 	{
-		switch (month)
-		{
-		case 2: return FEBRUARY;
-		case 3: return MARCH;
-		case 4: return APRIL;
-		case 5: return MAY;
-		case 6: return JUNE;
-		case 7: return JULY;
-		case 8: return AUGUST;
-		case 9: return SEPTEMBER;
-		case 10: return OCTOBER;
-		case 11: return NOVEMBER;
-		case 12: return DECEMBER;
-		case 1:
-		default: return JANUARY;
-		}
+		return CALENDAR::IntToMonth(month);
 	}
 
 	bool Date::IsLeapYear(unsigned int year)
 	{
-		if ((year % 4) == 0)
-		{//it is divisible by 4
-			if ((year % 100) == 0)
-			{//it is divisible by 100
-				if ((year % 400) == 0)
-				{//it is divisible by 400
-					return true;
-				}
-			}
-			else
-			{
-				return true;
-			}
-		}
-
-		return false;
+		return CALENDAR::IsLeapYear((int)year);
 	}
 
 	void Date::SetDate(DATE_MONTH month, unsigned int day, unsigned int year)
@@ -228,6 +196,18 @@ namespace BIO
 		_dayOfTheYear = CalculateDayOfYear(_month, _day, _year);
 	}
 
+	void Date::SetDayNumber(long long dayNumber)
+	{
+		//January 1 of year 0
+		const long long firstDay = -719528;
+
+		if (dayNumber < firstDay)
+			dayNumber = firstDay;
+
+		CivilFromDays(dayNumber, &_month, &_day, &_year);
+		_dayOfTheYear = CalculateDayOfYear(_month, _day, _year);
+	}
+
 	DATE_MONTH Date::StringToMonth(char * month)
 	{
 		
@@ -275,39 +255,7 @@ namespace BIO
 
 	unsigned int Date::_NumDaysBefore(DATE_MONTH month, unsigned int year)
 	{
-		int addValue = 0;
-
-		if (IsLeapYear(year))
-			addValue = 1;
-
-		switch (month)
-		{
-		case FEBRUARY:
-			return 31;
-		case MARCH:
-			return 59 + addValue;
-		case APRIL:
-			return 90 + addValue;
-		case MAY:
-			return 120 + addValue;
-		case JUNE:
-			return 151 + addValue;
-		case JULY:
-			return 181 + addValue;
-		case AUGUST:
-			return 212 + addValue;
-		case SEPTEMBER:
-			return 243 + addValue;
-		case OCTOBER:
-			return 273 + addValue;
-		case NOVEMBER:
-			return 304 + addValue;
-		case DECEMBER:
-			return 334 + addValue;
-		case JANUARY:
-		default:
-			return 0;
-		}
+		return CALENDAR::DaysBeforeMonth(month, (int)year);
 	}
 	//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 	//			  End Private Functions
@@ -628,6 +576,67 @@ namespace BIO
 			(date3.GetMonth() == MARCH) &&
 			(date3.GetYear() == 2020), "Test incrementor [27]");
 
+		//day numbers
+		test->UnitTest(DaysFromCivil(JANUARY, 1, 1970) == 0, "Test DaysFromCivil [1]");
+		test->UnitTest(DaysFromCivil(JANUARY, 1, 2000) == 10957, "Test DaysFromCivil [2]");
+		test->UnitTest(DaysFromCivil(DECEMBER, 31, 1969) == -1, "Test DaysFromCivil [3]");
+		test->UnitTest(DaysFromCivil(MARCH, 1, 2000) - DaysFromCivil(FEBRUARY, 28, 2000) == 2, "Test DaysFromCivil [4]");
+		test->UnitTest(DaysFromCivil(MARCH, 1, 1900) - DaysFromCivil(FEBRUARY, 28, 1900) == 1, "Test DaysFromCivil [5]");
+		test->UnitTest(DaysFromCivil(JANUARY, 1, 0) == -719528, "Test DaysFromCivil [6]");
+
+		//Walk every day from year 0 to 3000 with the incrementor and check
+		//the day number arithmetic agrees with it.
+		Date walk(JANUARY, 1, 0);
+		long long walkDay = DaysFromCivil(JANUARY, 1, 0);
+		bool walkMatches = true;
+
+		while (walk.GetYear() < 3000)
+		{
+			Date fromNumber;
+			fromNumber.SetDayNumber(walkDay);
+
+			if ((walk.GetDayNumber() != walkDay) || (fromNumber != walk) ||
+				(fromNumber.GetDayOfTheYear() != walk.GetDayOfTheYear()))
+			{
+				walkMatches = false;
+				break;
+			}
+
+			walk++;
+			walkDay++;
+		}
+
+		test->UnitTest(walkMatches, "Test day numbers match the incrementor");
+
+		//add days
+		date3.SetDate(JANUARY, 1, 2000);
+		date3.AddDays(-1);
+		test->UnitTest((date3.GetDay() == 31) &&
+			(date3.GetDayOfTheYear() == 365) &&
+			(date3.GetMonth() == DECEMBER) &&
+			(date3.GetYear() == 1999), "Test AddDays [1]");
+
+		date3.SetDate(MARCH, 1, 2016);
+		date3.AddDays(-1);
+		test->UnitTest((date3.GetDay() == 29) &&
+			(date3.GetDayOfTheYear() == 60) &&
+			(date3.GetMonth() == FEBRUARY) &&
+			(date3.GetYear() == 2016), "Test AddDays [2]");
+
+		date3.SetDate(JANUARY, 1, 2000);
+		date3.AddDays(4096);
+		test->UnitTest((date3.GetDay() == 20) &&
+			(date3.GetDayOfTheYear() == 79) &&
+			(date3.GetMonth() == MARCH) &&
+			(date3.GetYear() == 2011), "Test AddDays [3]");
+
+		date3.AddDays(1000000).AddDays(-1000000);
+		test->UnitTest(date3 == Date(MARCH, 20, 2011), "Test AddDays [4]");
+
+		date3.SetDate(JANUARY, 5, 0);
+		date3.AddDays(-10);
+		test->UnitTest(date3 == Date(JANUARY, 1, 0), "Test AddDays stops at year 0");
+
 		return test->GetSuccess();
 	}
 #endif
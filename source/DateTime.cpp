@@ -35,21 +35,79 @@
 
 #include "DateTime.hpp"
 
+#include <cfloat>
+#include <cmath>
 #include <iostream>
 
+#if BIOSKY_TESTING == 1
+#include <limits>
+#endif
+
 namespace BIO
 {
 
 	void DateTime::AddTime(float timeToAdd)
 	{
-		_time += timeToAdd;
+		//NaN and infinity are not a time
+		if (!(std::fabs(timeToAdd) <= FLT_MAX))
+			return;
 
-		//if (_time >= 86400.0f)//initial implementation
-		while (_time >= 86400.0f)//allows adding of multiple days
+		//Split the new time into whole days and seconds in double so a
+		//jump of years costs the same as a frame and keeps its seconds.
+		double time = (double)_time + (double)timeToAdd;
+		double days = std::floor(time / 86400.0);
+
+		_time = (float)(time - days * 86400.0);
+
+		//rounding to float can land on the end of the day
+		if (_time >= 86400.0f)
 		{
-			_time -= 86400.0f;
+			_time = 0.0f;
+			days += 1.0;
+		}
+		else if (_time < 0.0f)
+			_time = 0.0f;
+
+		if (days == 0.0)
+			return;
+
+		//keep the day count in range of a long long and the year in range
+		//of an unsigned int
+		const double maxDays = 1.0e12;
+		days = (days > maxDays) ? maxDays : ((days < -maxDays) ? -maxDays : days);
 
-			_date++;
+		//the date stops at the start of year 0, and so does the time
+		const Date first(JANUARY, 1, 0);
+
+		if (_date.GetDayNumber() + (long long)days < first.GetDayNumber())
+		{
+			_date = first;
+			_time = 0.0f;
+			return;
+		}
+
+		_date.AddDays((long long)days);
+	}
+
+	Timestamp DateTime::GetTimestamp()
+	{
+		return Timestamp::FromCalendar((double)_time / 3600.0, _UTCOffset, _date.GetMonth(), _date.GetDay(), _date.GetYear());
+	}
+
+	void DateTime::SetTimestamp(Timestamp timestamp)
+	{
+		//move to local time, then the universal date and time of the
+		//shifted timestamp are the local date and time
+		timestamp.AddSeconds((double)_UTCOffset * 3600.0);
+
+		_date = timestamp.GetUniversalDate();
+		_time = (float)(timestamp.GetUniversalTimeHours() * 3600.0);
+
+		//the last microsecond of a day rounds up to 86400 in float
+		if (_time >= 86400.0f)
+		{
+			_time = 0.0f;
+			_date.AddDays(1);
 		}
 	}
 
@@ -181,6 +239,39 @@ namespace BIO
 		test->UnitTest(dt.GetTime() == 1.0f, "Test Auto Day Increment [14]");
 		test->UnitTest(dt.GetYear() == 1999, "Test Auto Day Increment [15]");
 
+		dt.AddTime(-2.0f);//back over midnight
+		test->UnitTest(dt.GetDay() == 26, "Test Negative Add Time [1]");
+		test->UnitTest(dt.GetDayOfYear() == 360, "Test Negative Add Time [2]");
+		test->UnitTest(dt.GetMonth() == DECEMBER, "Test Negative Add Time [3]");
+		test->UnitTest(dt.GetTime() == 86399.0f, "Test Negative Add Time [4]");
+		test->UnitTest(dt.GetYear() == 1999, "Test Negative Add Time [5]");
+
+		dt.AddTime(2.0f);
+		test->UnitTest(dt.GetDay() == 27, "Test Negative Add Time [6]");
+		test->UnitTest(dt.GetTime() == 1.0f, "Test Negative Add Time [7]");
+
+		DateTime jump;
+		jump.SetTime(3600.0f);
+		jump.AddTime(4096.0f * 86400.0f);//4096 days
+		test->UnitTest(jump.GetDate() == Date(MARCH, 20, 2011), "Test Large Add Time [1]");
+		test->UnitTest(jump.GetDayOfYear() == 79, "Test Large Add Time [2]");
+		test->UnitTest(jump.GetTime() == 3600.0f, "Test Large Add Time [3]");
+
+		jump.AddTime(-4096.0f * 86400.0f - 7200.0f);//back past the start
+		test->UnitTest(jump.GetDate() == Date(DECEMBER, 31, 1999), "Test Large Add Time [4]");
+		test->UnitTest(jump.GetTime() == 82800.0f, "Test Large Add Time [5]");
+
+		jump.AddTime(std::numeric_limits<float>::quiet_NaN());
+		jump.AddTime(std::numeric_limits<float>::infinity());
+		jump.AddTime(-std::numeric_limits<float>::infinity());
+		test->UnitTest(jump.GetDate() == Date(DECEMBER, 31, 1999) && jump.GetTime() == 82800.0f, "Test Add Time ignores NaN and infinity");
+
+		jump.AddTime(-1.0e15f);//before year 0
+		test->UnitTest(jump.GetDate() == Date(JANUARY, 1, 0) && jump.GetTime() == 0.0f, "Test Add Time stops at year 0");
+
+		jump.AddTime(-1.0f);
+		test->UnitTest(jump.GetDate() == Date(JANUARY, 1, 0) && jump.GetTime() == 0.0f, "Test Add Time stays at year 0");
+
 		test->UnitTest((dt == dt3) == false, "Test Equality operator == false");
 		test->UnitTest((dt2 == dt3) == true, "Test Equality operator == true");
 
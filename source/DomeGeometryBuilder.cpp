@@ -0,0 +1,855 @@
+/**
+* @file DomeGeometryBuilder.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the DomeGeometryBuilder class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "DomeGeometryBuilder.hpp"
+#include "MathUtils.hpp"
+#include "Allocator.hpp"
+#include "SkyTrace.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+#if BIOSKY_TESTING == 1
+#include "BIOSkyFunctions.hpp"
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			//Forsyth scoring constants
+			const int ForsythCacheSize = DefaultVertexCacheSize;
+			const float ForsythCacheDecayPower = 1.5f;
+			const float ForsythLastTriScore = 0.75f;
+			const float ForsythValenceBoostScale = 2.0f;
+			const float ForsythValenceBoostPower = 0.5f;
+
+			/**The remaining triangle counts the valence boost is kept for.*/
+			const int ForsythValenceTableSize = 32;
+
+			/**
+			* The scores are looked up instead of calling pow for every
+			* vertex that moves in the cache, which was most of the time.
+			*/
+			struct _ForsythScoreTable
+			{
+				float cache[ForsythCacheSize];
+				float valence[ForsythValenceTableSize];
+			};
+
+			float _ForsythValenceBoost(int remainingTriangles)
+			{
+				//boost vertecies with few triangles left so they get
+				//finished instead of left behind.
+				return ForsythValenceBoostScale * std::pow((float)remainingTriangles, -ForsythValenceBoostPower);
+			}
+
+			void _FillForsythScoreTable(_ForsythScoreTable * table)
+			{
+				float scaler = 1.0f / (ForsythCacheSize - 3);
+
+				for (int i = 0; i < ForsythCacheSize; i++)
+				{
+					//used by the last triangle. A fixed score so there is no
+					//preference for which of its edges is used.
+					if (i < 3)
+						table->cache[i] = ForsythLastTriScore;
+					else
+						table->cache[i] = std::pow(1.0f - (i - 3) * scaler, ForsythCacheDecayPower);
+				}
+
+				table->valence[0] = 0.0f;
+
+				for (int i = 1; i < ForsythValenceTableSize; i++)
+					table->valence[i] = _ForsythValenceBoost(i);
+			}
+
+			float _ForsythVertexScore(const _ForsythScoreTable & table, int cachePosition, int remainingTriangles)
+			{
+				//no triangles left means the vertex is done
+				if (remainingTriangles == 0)
+					return -1.0f;
+
+				float score = (cachePosition >= 0) ? table.cache[cachePosition] : 0.0f;
+
+				if (remainingTriangles < ForsythValenceTableSize)
+					score += table.valence[remainingTriangles];
+				else
+					score += _ForsythValenceBoost(remainingTriangles);
+
+				return score;
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		DomeGeometryBuilder::DomeGeometryBuilder(float radius, int numVerticalSegments, int numHorozontalSegments, bool fullDome) :
+			_radius(radius),
+			_numVerticalSegments(0),
+			_numHorozontalSegments(0),
+			_fullDome(fullDome),
+			_order(DOME_ORDER_BANDS)
+		{
+			SetSegments(numVerticalSegments, numHorozontalSegments);
+		}
+
+		void DomeGeometryBuilder::SetRadius(float radius)
+		{
+			_radius = radius;
+		}
+
+		void DomeGeometryBuilder::SetSegments(int numVerticalSegments, int numHorozontalSegments)
+		{
+			if (numVerticalSegments < 3)
+				numVerticalSegments = 3;
+
+			if (numHorozontalSegments < 2)
+				numHorozontalSegments = 2;
+
+			//is the numHorozontalSegments even
+			if (numHorozontalSegments % 2 != 0)
+				numHorozontalSegments += 1;
+
+			_numVerticalSegments = numVerticalSegments;
+			_numHorozontalSegments = numHorozontalSegments;
+		}
+
+		void DomeGeometryBuilder::SetFullDome(bool fullDome)
+		{
+			_fullDome = fullDome;
+		}
+
+		void DomeGeometryBuilder::SetIndexOrder(DOME_INDEX_ORDER order)
+		{
+			_order = order;
+		}
+
+		int DomeGeometryBuilder::_GetRingCount() const
+		{
+			return (_fullDome) ? _numHorozontalSegments - 1 : _numHorozontalSegments;
+		}
+
+		int DomeGeometryBuilder::GetVertexCount() const
+		{
+			return (_GetRingCount() * _numVerticalSegments) + ((_fullDome) ? 2 : 1);
+		}
+
+		int DomeGeometryBuilder::GetIndexCount() const
+		{
+			//every horozontal segment is one band of triangles
+			int numBands = _numHorozontalSegments;
+
+			if (_order == DOME_ORDER_STRIP)
+			{
+				//each band is 2 indecies per segment plus 2 to close the
+				//ring, with 2 degenerate indecies between bands and 1 at
+				//the start.
+				return 1 + (numBands * (2 * _numVerticalSegments + 2)) + (2 * (numBands - 1));
+			}
+
+			int numTris = 2 * _numVerticalSegments * numBands;
+
+			//the caps only have one triangle per segment
+			numTris -= (_fullDome) ? 2 * _numVerticalSegments : _numVerticalSegments;
+
+			return numTris * 3;
+		}
+
+		RawGeometry * DomeGeometryBuilder::Build() const
+		{
+			BIOSKY_TRACE_SCOPE("Build Dome Geometry");
+
+			RawGeometry * rtnVal = new RawGeometry();
+
+			int numVerts = GetVertexCount();
+			int numIndecies = GetIndexCount();
+			bool large = NeedsLargeIndecies();
+
+			rtnVal->AllocateArrays(numVerts, numIndecies, large);
+			rtnVal->primitiveType = (_order == DOME_ORDER_STRIP) ? PRIMITIVE_TRIANGLE_STRIP : PRIMITIVE_TRIANGLE_LIST;
+
+			_BuildVertecies(rtnVal->vertecies, rtnVal->UVTextureCoordinates);
+
+			if (large)
+			{
+				_BuildIndecies(rtnVal->indecies32);
+			}
+			else
+			{
+				unsigned int * tmp = AllocateArray<unsigned int>(numIndecies);
+
+				_BuildIndecies(tmp);
+
+				for (int i = 0; i < numIndecies; i++)
+					rtnVal->indecies[i] = (unsigned short)tmp[i];
+
+				FreeArray(tmp);
+			}
+
+			return rtnVal;
+		}
+
+		bool DomeGeometryBuilder::Build(Vector3D * vertecies, Vector2D * UVTextureCoordinates, int numVertecies, unsigned int * indecies, int numIndecies) const
+		{
+			if (vertecies == NULL || UVTextureCoordinates == NULL || indecies == NULL ||
+				numVertecies < GetVertexCount() || numIndecies < GetIndexCount())
+				return false;
+
+			BIOSKY_TRACE_SCOPE("Build Dome Geometry");
+
+			_BuildVertecies(vertecies, UVTextureCoordinates);
+			_BuildIndecies(indecies);
+
+			return true;
+		}
+
+		void DomeGeometryBuilder::_BuildVertecies(Vector3D * vertecies, Vector2D * UVTextureCoordinates) const
+		{
+			int numRings = _GetRingCount();
+			int numSegments = _numVerticalSegments;
+
+			//sine and cosine of every segment around a ring
+			float * segmentCos = AllocateArray<float>(numSegments);
+			float * segmentSin = AllocateArray<float>(numSegments);
+
+			double circleStep = MATH::PIx2 / numSegments;
+			for (int j = 0; j < numSegments; j++)
+			{
+				segmentCos[j] = (float)std::cos(circleStep * j);
+				segmentSin[j] = (float)std::sin(circleStep * j);
+			}
+
+			//first vert is at 0,radius,0
+			vertecies[0].X = 0; vertecies[0].Y = _radius; vertecies[0].Z = 0;
+			UVTextureCoordinates[0].X = UVTextureCoordinates[0].Y = 0.5f;
+
+			double angleStep = ((_fullDome) ? MATH::PI : MATH::PId2) / (double)_numHorozontalSegments;
+			int equator = (_fullDome) ? (_numHorozontalSegments / 2) - 1 : _numHorozontalSegments - 1;
+
+			int vertOn = 1;
+
+			for (int i = 0; i < numRings; i++)
+			{
+				double ringAngle = MATH::PId2 - (angleStep * (i + 1));
+				double ringHeight = (i == equator) ? 0.0 : std::sin(ringAngle) * _radius;
+				float ringRadius = (float)std::sqrt((_radius * _radius) - (ringHeight * ringHeight));
+				float height = (float)ringHeight;
+
+				//the UV is a projection from the bottom of the sphere
+				float uvScale = 1.0f / (2 * (_radius + height));
+
+				for (int j = 0; j < numSegments; j++)
+				{
+					Vector3D & v = vertecies[vertOn];
+					v.X = ringRadius * segmentCos[j];
+					v.Y = height;
+					v.Z = ringRadius * segmentSin[j];
+
+					UVTextureCoordinates[vertOn].X = (v.X * uvScale) + 0.5f;
+					UVTextureCoordinates[vertOn].Y = (v.Z * uvScale) + 0.5f;
+					vertOn++;
+				}
+			}
+
+			if (_fullDome)
+			{
+				//final point
+				vertecies[vertOn].X = 0; vertecies[vertOn].Y = -_radius; vertecies[vertOn].Z = 0;
+				UVTextureCoordinates[vertOn].X = UVTextureCoordinates[vertOn].Y = 0.5f;
+			}
+
+			FreeArray(segmentSin);
+			FreeArray(segmentCos);
+		}
+
+		void DomeGeometryBuilder::_BuildIndecies(unsigned int * indecies) const
+		{
+			int numSegments = _numVerticalSegments;
+			int numRings = _GetRingCount();
+			int numBands = _numHorozontalSegments;
+			unsigned int bottom = (unsigned int)(numRings * numSegments + 1);
+
+			int indexOn = 0;
+
+			for (int band = 0; band < numBands; band++)
+			{
+				//the band is between ring band - 1 (the top pole for the
+				//first band) and ring band (the bottom pole for the last
+				//band of a full dome).
+				bool topPole = (band == 0);
+				bool bottomPole = (_fullDome && band == numBands - 1);
+				unsigned int top = (unsigned int)((band - 1) * numSegments + 1);
+				unsigned int below = (unsigned int)(band * numSegments + 1);
+
+				if (_order == DOME_ORDER_STRIP)
+				{
+					//Each band starts on an odd triangle so the strip has
+					//the same triangles and winding as the triangle list.
+					//The first index is repeated to get there, and the
+					//bands are joined with 2 degenerate indecies.
+					unsigned int first = (bottomPole) ? bottom : below;
+
+					if (band == 0)
+					{
+						indecies[indexOn++] = first;
+					}
+					else
+					{
+						indecies[indexOn] = indecies[indexOn - 1];
+						indexOn++;
+						indecies[indexOn++] = first;
+					}
+
+					for (int j = 0; j <= numSegments; j++)
+					{
+						int s = (j == numSegments) ? 0 : j;
+
+						indecies[indexOn++] = (bottomPole) ? bottom : below + s;
+						indecies[indexOn++] = (topPole) ? 0 : top + s;
+					}
+				}
+				else if (topPole)
+				{
+					for (int j = 0; j < numSegments; j++)
+					{
+						indecies[indexOn++] = 0;
+						indecies[indexOn++] = below + j;
+						indecies[indexOn++] = below + ((j + 1) % numSegments);
+					}
+				}
+				else if (bottomPole)
+				{
+					//same order as CreateSkyDomeGeometry
+					for (int i = 1; i <= numSegments; i++)
+					{
+						indecies[indexOn++] = bottom;
+						indecies[indexOn++] = top + (numSegments - i);
+						indecies[indexOn++] = top + ((2 * numSegments - i - 1) % numSegments);
+					}
+				}
+				else
+				{
+					for (int j = 0; j < numSegments; j++)
+					{
+						unsigned int next = (j + 1) % numSegments;
+
+						indecies[indexOn++] = top + j;
+						indecies[indexOn++] = below + j;
+						indecies[indexOn++] = below + next;
+
+						indecies[indexOn++] = top + j;
+						indecies[indexOn++] = below + next;
+						indecies[indexOn++] = top + next;
+					}
+				}
+			}
+
+			if (_order == DOME_ORDER_VERTEX_CACHE)
+				OptimizeVertexCache(indecies, indexOn, GetVertexCount());
+		}
+
+		void DomeGeometryBuilder::OptimizeVertexCache(unsigned int * indecies, int numIndecies, int numVertecies)
+		{
+			int numTris = numIndecies / 3;
+
+			if (indecies == NULL || numTris <= 1 || numVertecies <= 0)
+				return;
+
+			_ForsythScoreTable table;
+			_FillForsythScoreTable(&table);
+
+			//triangles that use each vertex
+			int * triOffsets = AllocateArray<int>(numVertecies + 1);
+			int * remaining = AllocateArray<int>(numVertecies);
+			int * cachePosition = AllocateArray<int>(numVertecies);
+			float * vertexScore = AllocateArray<float>(numVertecies);
+			int * vertexTris = AllocateArray<int>(numTris * 3);
+			float * triScore = AllocateArray<float>(numTris);
+			bool * triAdded = AllocateArray<bool>(numTris);
+			unsigned int * output = AllocateArray<unsigned int>(numTris * 3);
+
+			for (int i = 0; i < numTris * 3; i++)
+				remaining[indecies[i]]++;
+
+			for (int v = 0; v < numVertecies; v++)
+			{
+				triOffsets[v + 1] = triOffsets[v] + remaining[v];
+				remaining[v] = 0;
+				cachePosition[v] = -1;
+			}
+
+			for (int t = 0; t < numTris; t++)
+			{
+				for (int k = 0; k < 3; k++)
+				{
+					unsigned int v = indecies[t * 3 + k];
+					vertexTris[triOffsets[v] + remaining[v]] = t;
+					remaining[v]++;
+				}
+			}
+
+			for (int v = 0; v < numVertecies; v++)
+				vertexScore[v] = _ForsythVertexScore(table, -1, remaining[v]);
+
+			int bestTri = -1;
+			float bestScore = -1.0f;
+
+			for (int t = 0; t < numTris; t++)
+			{
+				triScore[t] = vertexScore[indecies[t * 3]] + vertexScore[indecies[t * 3 + 1]] + vertexScore[indecies[t * 3 + 2]];
+
+				if (triScore[t] > bestScore)
+				{
+					bestScore = triScore[t];
+					bestTri = t;
+				}
+			}
+
+			//the cache is 3 bigger so the vertecies that drop out of it can
+			//be rescored
+			int cache[ForsythCacheSize + 3];
+			int cacheUsed = 0;
+			int newCache[ForsythCacheSize + 3];
+
+			int searchFrom = 0;
+
+			for (int out = 0; out < numTris; out++)
+			{
+				if (bestTri < 0)
+				{
+					//nothing in the cache has triangles left. Start again at
+					//the best triangle anywhere.
+					bestScore = -1.0f;
+
+					for (int t = searchFrom; t < numTris; t++)
+					{
+						if (!triAdded[t] && triScore[t] > bestScore)
+						{
+							bestScore = triScore[t];
+							bestTri = t;
+						}
+					}
+
+					while (searchFrom < numTris && triAdded[searchFrom])
+						searchFrom++;
+				}
+
+				triAdded[bestTri] = true;
+
+				int newUsed = 0;
+
+				for (int k = 0; k < 3; k++)
+				{
+					unsigned int v = indecies[bestTri * 3 + k];
+					output[out * 3 + k] = v;
+
+					//take the triangle off the vertex's list
+					int * tris = vertexTris + triOffsets[v];
+					for (int i = 0; i < remaining[v]; i++)
+					{
+						if (tris[i] == bestTri)
+						{
+							tris[i] = tris[remaining[v] - 1];
+							break;
+						}
+					}
+					remaining[v]--;
+
+					newCache[newUsed++] = (int)v;
+				}
+
+				//the rest of the old cache goes after the new triangle
+				for (int i = 0; i < cacheUsed && newUsed < ForsythCacheSize + 3; i++)
+				{
+					int v = cache[i];
+
+					if (v != newCache[0] && v != newCache[1] && v != newCache[2])
+						newCache[newUsed++] = v;
+				}
+
+				for (int i = 0; i < newUsed; i++)
+				{
+					int v = newCache[i];
+					cachePosition[v] = (i < ForsythCacheSize) ? i : -1;
+					vertexScore[v] = _ForsythVertexScore(table, cachePosition[v], remaining[v]);
+				}
+
+				//rescore the triangles that use the cached vertecies
+				bestTri = -1;
+				bestScore = -1.0f;
+
+				for (int i = 0; i < newUsed; i++)
+				{
+					int v = newCache[i];
+					const int * tris = vertexTris + triOffsets[v];
+
+					for (int j = 0; j < remaining[v]; j++)
+					{
+						int t = tris[j];
+						triScore[t] = vertexScore[indecies[t * 3]] + vertexScore[indecies[t * 3 + 1]] + vertexScore[indecies[t * 3 + 2]];
+
+						if (triScore[t] > bestScore)
+						{
+							bestScore = triScore[t];
+							bestTri = t;
+						}
+					}
+				}
+
+				cacheUsed = (newUsed < ForsythCacheSize) ? newUsed : ForsythCacheSize;
+				for (int i = 0; i < cacheUsed; i++)
+					cache[i] = newCache[i];
+			}
+
+			for (int i = 0; i < numTris * 3; i++)
+				indecies[i] = output[i];
+
+			FreeArray(output);
+			FreeArray(triAdded);
+			FreeArray(triScore);
+			FreeArray(vertexTris);
+			FreeArray(vertexScore);
+			FreeArray(cachePosition);
+			FreeArray(remaining);
+			FreeArray(triOffsets);
+		}
+
+		float DomeGeometryBuilder::CalculateACMR(const unsigned int * indecies, int numIndecies, GEOMETRY_PRIMITIVE primitive, int cacheSize)
+		{
+			if (indecies == NULL || numIndecies < 3 || cacheSize <= 0)
+				return 0.0f;
+
+			//FIFO cache
+			unsigned int * cache = AllocateArray<unsigned int>(cacheSize);
+			int cacheUsed = 0;
+			int cacheNext = 0;
+			int misses = 0;
+
+			for (int i = 0; i < numIndecies; i++)
+			{
+				bool hit = false;
+
+				for (int c = 0; c < cacheUsed; c++)
+				{
+					if (cache[c] == indecies[i])
+					{
+						hit = true;
+						break;
+					}
+				}
+
+				if (!hit)
+				{
+					misses++;
+					cache[cacheNext] = indecies[i];
+					cacheNext = (cacheNext + 1) % cacheSize;
+
+					if (cacheUsed < cacheSize)
+						cacheUsed++;
+				}
+			}
+
+			FreeArray(cache);
+
+			int numTris = 0;
+
+			if (primitive == PRIMITIVE_TRIANGLE_STRIP)
+			{
+				for (int i = 2; i < numIndecies; i++)
+				{
+					if (indecies[i] != indecies[i - 1] && indecies[i] != indecies[i - 2] && indecies[i - 1] != indecies[i - 2])
+						numTris++;
+				}
+			}
+			else
+			{
+				numTris = numIndecies / 3;
+			}
+
+			return (numTris > 0) ? (float)misses / numTris : 0.0f;
+		}
+
+		void BenchmarkDomeGeometryBuilder(std::ostream & out)
+		{
+			const int numSizes = 4;
+			const int sizes[numSizes][2] = { { 32, 32 }, { 128, 64 }, { 256, 128 }, { 512, 256 } };
+			const char * orderNames[3] = { "bands", "vertex cache", "strip" };
+
+			std::ios::fmtflags flags = out.flags();
+			std::streamsize precision = out.precision();
+
+			out << "Dome build benchmark (full dome, FIFO cache " << DefaultVertexCacheSize << ")\n";
+			out << std::left << std::setw(11) << "segments" << std::setw(14) << "order"
+				<< std::right << std::setw(10) << "vertecies" << std::setw(8) << "ACMR" << std::setw(12) << "build ms" << "\n";
+
+			DomeGeometryBuilder builder;
+
+			for (int s = 0; s < numSizes; s++)
+			{
+				builder.SetSegments(sizes[s][0], sizes[s][1]);
+
+				for (int order = 0; order < 3; order++)
+				{
+					builder.SetIndexOrder((DOME_INDEX_ORDER)order);
+
+					//repeat the small domes so the clock resolution does
+					//not matter
+					int builds = 0;
+					float acmr = 0.0f;
+					std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+					std::chrono::high_resolution_clock::duration elapsed;
+
+					do
+					{
+						RawGeometry * geometry = builder.Build();
+
+						if (builds == 0)
+						{
+							unsigned int * list = AllocateArray<unsigned int>(geometry->numIndecies);
+
+							for (int i = 0; i < geometry->numIndecies; i++)
+								list[i] = geometry->GetIndex(i);
+
+							acmr = DomeGeometryBuilder::CalculateACMR(list, geometry->numIndecies, geometry->primitiveType);
+							FreeArray(list);
+						}
+
+						delete geometry;
+						builds++;
+						elapsed = std::chrono::high_resolution_clock::now() - start;
+					} while (elapsed < std::chrono::milliseconds(100));
+
+					double ms = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / 1000.0 / builds;
+
+					std::ostringstream segments;
+					segments << sizes[s][0] << " x " << sizes[s][1];
+
+					out << std::left << std::setw(11) << segments.str() << std::setw(14) << orderNames[order]
+						<< std::right << std::setw(10) << builder.GetVertexCount() << std::fixed << std::setprecision(3)
+						<< std::setw(8) << acmr << std::setw(12) << ms << "\n";
+				}
+			}
+
+			out.flags(flags);
+			out.precision(precision);
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* Check that a list of indecies draws the same triangles (with the
+			* same winding) as a triangle list.
+			*/
+			bool _SameTriangles(const unsigned int * indecies, int numIndecies, GEOMETRY_PRIMITIVE primitive, const RawGeometry * reference)
+			{
+				int numTris = reference->numIndecies / 3;
+				int * found = AllocateArray<int>(numTris);
+				bool same = true;
+
+				int step = (primitive == PRIMITIVE_TRIANGLE_STRIP) ? 1 : 3;
+				int count = (primitive == PRIMITIVE_TRIANGLE_STRIP) ? numIndecies - 2 : numIndecies / 3;
+
+				int drawn = 0;
+
+				for (int n = 0; n < count; n++)
+				{
+					unsigned int a = indecies[n * step];
+					unsigned int b = indecies[n * step + 1];
+					unsigned int c = indecies[n * step + 2];
+
+					if (primitive == PRIMITIVE_TRIANGLE_STRIP && (n % 2) == 1)
+					{
+						unsigned int tmp = a;
+						a = b;
+						b = tmp;
+					}
+
+					if (a == b || b == c || a == c)
+						continue;
+
+					drawn++;
+
+					bool match = false;
+					for (int t = 0; t < numTris && !match; t++)
+					{
+						unsigned int r0 = reference->GetIndex(t * 3);
+						unsigned int r1 = reference->GetIndex(t * 3 + 1);
+						unsigned int r2 = reference->GetIndex(t * 3 + 2);
+
+						//any rotation of the same winding
+						if ((a == r0 && b == r1 && c == r2) || (a == r1 && b == r2 && c == r0) || (a == r2 && b == r0 && c == r1))
+						{
+							found[t]++;
+							match = true;
+						}
+					}
+
+					if (!match)
+						same = false;
+				}
+
+				if (primitive != PRIMITIVE_TRIANGLE_STRIP)
+				{
+					for (int t = 0; t < numTris; t++)
+					{
+						if (found[t] != 1)
+							same = false;
+					}
+				}
+
+				FreeArray(found);
+
+				return same;
+			}
+		}
+
+		bool DomeGeometryBuilder::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Dome Geometry Builder Tests");
+
+			//the bands order matches CreateSkyDomeGeometry exactly
+			for (int full = 0; full < 2; full++)
+			{
+				RawGeometry * reference = CreateSkyDomeGeometry(3.0f, 10, 7, full == 1);
+
+				DomeGeometryBuilder builder(3.0f, 10, 7, full == 1);
+				RawGeometry * built = builder.Build();
+
+				std::string name = (full == 1) ? "Full dome " : "Hemisphere ";
+
+				test->UnitTest(built->numVertecies == reference->numVertecies && built->numIndecies == reference->numIndecies, (name + "sizes").c_str());
+				test->UnitTest(built->indecies != NULL && built->indecies32 == NULL && built->primitiveType == PRIMITIVE_TRIANGLE_LIST, (name + "16 bit triangle list").c_str());
+
+				bool indeciesMatch = true;
+				for (int i = 0; i < reference->numIndecies; i++)
+				{
+					if (built->indecies[i] != reference->indecies[i])
+						indeciesMatch = false;
+				}
+				test->UnitTest(indeciesMatch, (name + "indecies").c_str());
+
+				float maxError = 0.0f;
+				for (int i = 0; i < reference->numVertecies; i++)
+				{
+					float e[5] = {
+						std::fabs(built->vertecies[i].X - reference->vertecies[i].X),
+						std::fabs(built->vertecies[i].Y - reference->vertecies[i].Y),
+						std::fabs(built->vertecies[i].Z - reference->vertecies[i].Z),
+						std::fabs(built->UVTextureCoordinates[i].X - reference->UVTextureCoordinates[i].X),
+						std::fabs(built->UVTextureCoordinates[i].Y - reference->UVTextureCoordinates[i].Y) };
+
+					for (int k = 0; k < 5; k++)
+						maxError = (e[k] > maxError) ? e[k] : maxError;
+				}
+				test->UnitTest(maxError < 0.0001f, (name + "vertecies").c_str());
+
+				//same triangles in the other orders
+				builder.SetIndexOrder(DOME_ORDER_VERTEX_CACHE);
+				RawGeometry * cached = builder.Build();
+				unsigned int * list = AllocateArray<unsigned int>(cached->numIndecies);
+				for (int i = 0; i < cached->numIndecies; i++)
+					list[i] = cached->GetIndex(i);
+				test->UnitTest(_SameTriangles(list, cached->numIndecies, PRIMITIVE_TRIANGLE_LIST, reference), (name + "vertex cache order").c_str());
+				FreeArray(list);
+
+				builder.SetIndexOrder(DOME_ORDER_STRIP);
+				test->UnitTest(builder.GetIndexCount() == 8 * 22 + 15, (name + "strip index count").c_str());
+				RawGeometry * strip = builder.Build();
+				list = AllocateArray<unsigned int>(strip->numIndecies);
+				for (int i = 0; i < strip->numIndecies; i++)
+					list[i] = strip->GetIndex(i);
+				test->UnitTest(strip->primitiveType == PRIMITIVE_TRIANGLE_STRIP, (name + "strip primitive").c_str());
+				test->UnitTest(_SameTriangles(list, strip->numIndecies, PRIMITIVE_TRIANGLE_STRIP, reference), (name + "strip triangles").c_str());
+				FreeArray(list);
+
+				delete strip;
+				delete cached;
+				delete built;
+				delete reference;
+			}
+
+			//large domes need 32 bit indecies
+			DomeGeometryBuilder large(1.0f, 512, 256, true);
+			test->UnitTest(large.GetVertexCount() == 512 * 255 + 2 && large.NeedsLargeIndecies(), "Large dome vertex count");
+
+			RawGeometry * largeGeometry = large.Build();
+			test->UnitTest(largeGeometry->indecies == NULL && largeGeometry->indecies32 != NULL, "Large dome uses 32 bit indecies");
+
+			unsigned int maxIndex = 0;
+			for (int i = 0; i < largeGeometry->numIndecies; i++)
+				maxIndex = (largeGeometry->indecies32[i] > maxIndex) ? largeGeometry->indecies32[i] : maxIndex;
+			test->UnitTest(maxIndex == (unsigned int)(largeGeometry->numVertecies - 1), "Large dome index range");
+			delete largeGeometry;
+
+			//caller buffers
+			DomeGeometryBuilder small(1.0f, 12, 12, false);
+			Vector3D verts[145];
+			Vector2D uvs[145];
+			unsigned int indecies[12 * 23 * 3];
+			test->UnitTest(small.GetVertexCount() == 145 && small.GetIndexCount() == 12 * 23 * 3, "Caller buffer sizes");
+			test->UnitTest(!small.Build(verts, uvs, 144, indecies, 12 * 23 * 3), "Caller buffer too small");
+			test->UnitTest(small.Build(verts, uvs, 145, indecies, 12 * 23 * 3), "Caller buffers");
+
+			//the cache order of the large dome
+			float acmr[3];
+
+			for (int order = 0; order < 3; order++)
+			{
+				large.SetIndexOrder((DOME_INDEX_ORDER)order);
+
+				RawGeometry * geometry = large.Build();
+				acmr[order] = CalculateACMR(geometry->indecies32, geometry->numIndecies, geometry->primitiveType);
+				delete geometry;
+			}
+
+			test->UnitTest(acmr[DOME_ORDER_VERTEX_CACHE] < acmr[DOME_ORDER_BANDS], "Vertex cache order improves ACMR");
+			test->UnitTest(acmr[DOME_ORDER_VERTEX_CACHE] < 0.8f, "Vertex cache order ACMR");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
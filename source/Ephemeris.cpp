@@ -0,0 +1,976 @@
+/**
+* @file Ephemeris.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the accurate sun and moon.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "Ephemeris.hpp"
+#include "BIOSkyFunctions.hpp"
+#include "MathUtils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+#if BIOSKY_TESTING == 1
+#include "SkyCalculations.hpp"
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**The Julian day of J2000.0.*/
+			const double _J2000 = 2451545.0;
+
+			/**The Julian day of 2000 Jan 0.0, day 0 of DaysSinceJan02000.*/
+			const double _Jan02000 = 2451543.5;
+
+			/**Kilometers in an astronomical unit.*/
+			const double _AstronomicalUnit = 149597870.7;
+
+			/**The equatorial radius of the Earth in kilometers.*/
+			const double _EarthRadius = 6378.14;
+
+			/**The indecies of the values kept at each node of the cache.*/
+			enum
+			{
+				_SunLongitude = 0,
+				_SunLatitude,
+				_SunDistance,
+				_MoonLongitude,
+				_MoonLatitude,
+				_MoonDistance,
+				_Obliquity,
+				_NutationLongitude
+			};
+
+			/*
+			* The periodic terms of the Earth's heliocentric position from
+			* the truncated VSOP87 series of NREL's Solar Position Algorithm
+			* (Reda and Andreas, 2004). Each term is A * cos(B + C * t), t in
+			* Julian millennia from J2000.0, summed to 1e-8 radians or au.
+			*/
+			const double _EarthL0[][3] = {
+				{ 175347046.0, 0.0, 0.0 }, { 3341656.0, 4.6692568, 6283.07585 }, { 34894.0, 4.6261, 12566.1517 },
+				{ 3497.0, 2.7441, 5753.3849 }, { 3418.0, 2.8289, 3.5231 }, { 3136.0, 3.6277, 77713.7715 },
+				{ 2676.0, 4.4181, 7860.4194 }, { 2343.0, 6.1352, 3930.2097 }, { 1324.0, 0.7425, 11506.7698 },
+				{ 1273.0, 2.0371, 529.691 }, { 1199.0, 1.1096, 1577.3435 }, { 990.0, 5.233, 5884.927 },
+				{ 902.0, 2.045, 26.298 }, { 857.0, 3.508, 398.149 }, { 780.0, 1.179, 5223.694 },
+				{ 753.0, 2.533, 5507.553 }, { 505.0, 4.583, 18849.228 }, { 492.0, 4.205, 775.523 },
+				{ 357.0, 2.92, 0.067 }, { 317.0, 5.849, 11790.629 }, { 284.0, 1.899, 796.298 },
+				{ 271.0, 0.315, 10977.079 }, { 243.0, 0.345, 5486.778 }, { 206.0, 4.806, 2544.314 },
+				{ 205.0, 1.869, 5573.143 }, { 202.0, 2.458, 6069.777 }, { 156.0, 0.833, 213.299 },
+				{ 132.0, 3.411, 2942.463 }, { 126.0, 1.083, 20.775 }, { 115.0, 0.645, 0.98 },
+				{ 103.0, 0.636, 4694.003 }, { 102.0, 0.976, 15720.839 }, { 102.0, 4.267, 7.114 },
+				{ 99.0, 6.21, 2146.17 }, { 98.0, 0.68, 155.42 }, { 86.0, 5.98, 161000.69 },
+				{ 85.0, 1.3, 6275.96 }, { 85.0, 3.67, 71430.7 }, { 80.0, 1.81, 17260.15 },
+				{ 79.0, 3.04, 12036.46 }, { 75.0, 1.76, 5088.63 }, { 74.0, 3.5, 3154.69 },
+				{ 74.0, 4.68, 801.82 }, { 70.0, 0.83, 9437.76 }, { 62.0, 3.98, 8827.39 },
+				{ 61.0, 1.82, 7084.9 }, { 57.0, 2.78, 6286.6 }, { 56.0, 4.39, 14143.5 },
+				{ 56.0, 3.47, 6279.55 }, { 52.0, 0.19, 12139.55 }, { 52.0, 1.33, 1748.02 },
+				{ 51.0, 0.28, 5856.48 }, { 49.0, 0.49, 1194.45 }, { 41.0, 5.37, 8429.24 },
+				{ 41.0, 2.4, 19651.05 }, { 39.0, 6.17, 10447.39 }, { 37.0, 6.04, 10213.29 },
+				{ 37.0, 2.57, 1059.38 }, { 36.0, 1.71, 2352.87 }, { 36.0, 1.78, 6812.77 },
+				{ 33.0, 0.59, 17789.85 }, { 30.0, 0.44, 83996.85 }, { 30.0, 2.74, 1349.87 },
+				{ 25.0, 3.16, 4690.48 }
+			};
+
+			const double _EarthL1[][3] = {
+				{ 628331966747.0, 0.0, 0.0 }, { 206059.0, 2.678235, 6283.07585 }, { 4303.0, 2.6351, 12566.1517 },
+				{ 425.0, 1.59, 3.523 }, { 119.0, 5.796, 26.298 }, { 109.0, 2.966, 1577.344 },
+				{ 93.0, 2.59, 18849.23 }, { 72.0, 1.14, 529.69 }, { 68.0, 1.87, 398.15 },
+				{ 67.0, 4.41, 5507.55 }, { 59.0, 2.89, 5223.69 }, { 56.0, 2.17, 155.42 },
+				{ 45.0, 0.4, 796.3 }, { 36.0, 0.47, 775.52 }, { 29.0, 2.65, 7.11 },
+				{ 21.0, 5.34, 0.98 }, { 19.0, 1.85, 5486.78 }, { 19.0, 4.97, 213.3 },
+				{ 17.0, 2.99, 6275.96 }, { 16.0, 0.03, 2544.31 }, { 16.0, 1.43, 2146.17 },
+				{ 15.0, 1.21, 10977.08 }, { 12.0, 2.83, 1748.02 }, { 12.0, 3.26, 5088.63 },
+				{ 12.0, 5.27, 1194.45 }, { 12.0, 2.08, 4694.0 }, { 11.0, 0.77, 553.57 },
+				{ 10.0, 1.3, 6286.6 }, { 10.0, 4.24, 1349.87 }, { 9.0, 2.7, 242.73 },
+				{ 9.0, 5.64, 951.72 }, { 8.0, 5.3, 2352.87 }, { 6.0, 2.65, 9437.76 },
+				{ 6.0, 4.67, 4690.48 }
+			};
+
+			const double _EarthL2[][3] = {
+				{ 52919.0, 0.0, 0.0 }, { 8720.0, 1.0721, 6283.0758 }, { 309.0, 0.867, 12566.152 },
+				{ 27.0, 0.05, 3.52 }, { 16.0, 5.19, 26.3 }, { 16.0, 3.68, 155.42 },
+				{ 10.0, 0.76, 18849.23 }, { 9.0, 2.06, 77713.77 }, { 7.0, 0.83, 775.52 },
+				{ 5.0, 4.66, 1577.34 }, { 4.0, 1.03, 7.11 }, { 4.0, 3.44, 5573.14 },
+				{ 3.0, 5.14, 796.3 }, { 3.0, 6.05, 5507.55 }, { 3.0, 1.19, 242.73 },
+				{ 3.0, 6.12, 529.69 }, { 3.0, 0.31, 398.15 }, { 3.0, 2.28, 553.57 },
+				{ 2.0, 4.38, 5223.69 }, { 2.0, 3.75, 0.98 }
+			};
+
+			const double _EarthL3[][3] = {
+				{ 289.0, 5.844, 6283.076 }, { 35.0, 0.0, 0.0 }, { 17.0, 5.49, 12566.15 },
+				{ 3.0, 5.2, 155.42 }, { 1.0, 4.72, 3.52 }, { 1.0, 5.3, 18849.23 },
+				{ 1.0, 5.97, 242.73 }
+			};
+
+			const double _EarthL4[][3] = {
+				{ 114.0, 3.142, 0.0 }, { 8.0, 4.13, 6283.08 }, { 1.0, 3.84, 12566.15 }
+			};
+
+			const double _EarthL5[][3] = {
+				{ 1.0, 3.14, 0.0 }
+			};
+
+			const double _EarthB0[][3] = {
+				{ 280.0, 3.199, 84334.662 }, { 102.0, 5.422, 5507.553 }, { 80.0, 3.88, 5223.69 },
+				{ 44.0, 3.7, 2352.87 }, { 32.0, 4.0, 1577.34 }
+			};
+
+			const double _EarthB1[][3] = {
+				{ 9.0, 3.9, 5507.55 }, { 6.0, 1.73, 5223.69 }
+			};
+
+			const double _EarthR0[][3] = {
+				{ 100013989.0, 0.0, 0.0 }, { 1670700.0, 3.0984635, 6283.07585 }, { 13956.0, 3.05525, 12566.1517 },
+				{ 3084.0, 5.1985, 77713.7715 }, { 1628.0, 1.1739, 5753.3849 }, { 1576.0, 2.8469, 7860.4194 },
+				{ 925.0, 5.453, 11506.77 }, { 542.0, 4.564, 3930.21 }, { 472.0, 3.661, 5884.927 },
+				{ 346.0, 0.964, 5507.553 }, { 329.0, 5.9, 5223.694 }, { 307.0, 0.299, 5573.143 },
+				{ 243.0, 4.273, 11790.629 }, { 212.0, 5.847, 1577.344 }, { 186.0, 5.022, 10977.079 },
+				{ 175.0, 3.012, 18849.228 }, { 110.0, 5.055, 5486.778 }, { 98.0, 0.89, 6069.78 },
+				{ 86.0, 5.69, 15720.84 }, { 86.0, 1.27, 161000.69 }, { 65.0, 0.27, 17260.15 },
+				{ 63.0, 0.92, 529.69 }, { 57.0, 2.01, 83996.85 }, { 56.0, 5.24, 71430.7 },
+				{ 49.0, 3.25, 2544.31 }, { 47.0, 2.58, 775.52 }, { 45.0, 5.54, 9437.76 },
+				{ 43.0, 6.01, 6275.96 }, { 39.0, 5.36, 4694.0 }, { 38.0, 2.39, 8827.39 },
+				{ 37.0, 0.83, 19651.05 }, { 37.0, 4.9, 12139.55 }, { 36.0, 1.67, 12036.46 },
+				{ 35.0, 1.84, 2942.46 }, { 33.0, 0.24, 7084.9 }, { 32.0, 0.18, 5088.63 },
+				{ 32.0, 1.78, 398.15 }, { 28.0, 1.21, 6286.6 }, { 28.0, 1.9, 6279.55 },
+				{ 26.0, 4.59, 10447.39 }
+			};
+
+			const double _EarthR1[][3] = {
+				{ 103019.0, 1.10749, 6283.07585 }, { 1721.0, 1.0644, 12566.1517 }, { 702.0, 3.142, 0.0 },
+				{ 32.0, 1.02, 18849.23 }, { 31.0, 2.84, 5507.55 }, { 25.0, 1.32, 5223.69 },
+				{ 18.0, 1.42, 1577.34 }, { 10.0, 5.91, 10977.08 }, { 9.0, 1.42, 6275.96 },
+				{ 9.0, 0.27, 5486.78 }
+			};
+
+			const double _EarthR2[][3] = {
+				{ 4359.0, 5.7846, 6283.0758 }, { 124.0, 5.579, 12566.152 }, { 12.0, 3.14, 0.0 },
+				{ 9.0, 3.63, 77713.77 }, { 6.0, 1.87, 5573.14 }, { 3.0, 5.47, 18849.23 }
+			};
+
+			const double _EarthR3[][3] = {
+				{ 145.0, 4.273, 6283.076 }, { 7.0, 3.92, 12566.15 }
+			};
+
+			const double _EarthR4[][3] = {
+				{ 4.0, 2.56, 6283.08 }
+			};
+
+			/*
+			* The periodic terms of the moon from Meeus, Astronomical
+			* Algorithms, tables 47.A and 47.B. The multiples of D, M, M' and
+			* F, then the longitude (1e-6 degrees) and distance (1e-3 km)
+			* coefficients, or the latitude (1e-6 degrees) coefficient.
+			*/
+			const int _MoonLongitudeDistance[][6] = {
+				{ 0, 0, 1, 0, 6288774, -20905355 }, { 2, 0, -1, 0, 1274027, -3699111 },
+				{ 2, 0, 0, 0, 658314, -2955968 }, { 0, 0, 2, 0, 213618, -569925 },
+				{ 0, 1, 0, 0, -185116, 48888 }, { 0, 0, 0, 2, -114332, -3149 },
+				{ 2, 0, -2, 0, 58793, 246158 }, { 2, -1, -1, 0, 57066, -152138 },
+				{ 2, 0, 1, 0, 53322, -170733 }, { 2, -1, 0, 0, 45758, -204586 },
+				{ 0, 1, -1, 0, -40923, -129620 }, { 1, 0, 0, 0, -34720, 108743 },
+				{ 0, 1, 1, 0, -30383, 104755 }, { 2, 0, 0, -2, 15327, 10321 },
+				{ 0, 0, 1, 2, -12528, 0 }, { 0, 0, 1, -2, 10980, 79661 },
+				{ 4, 0, -1, 0, 10675, -34782 }, { 0, 0, 3, 0, 10034, -23210 },
+				{ 4, 0, -2, 0, 8548, -21636 }, { 2, 1, -1, 0, -7888, 24208 },
+				{ 2, 1, 0, 0, -6766, 30824 }, { 1, 0, -1, 0, -5163, -8379 },
+				{ 1, 1, 0, 0, 4987, -16675 }, { 2, -1, 1, 0, 4036, -12831 },
+				{ 2, 0, 2, 0, 3994, -10445 }, { 4, 0, 0, 0, 3861, -11650 },
+				{ 2, 0, -3, 0, 3665, 14403 }, { 0, 1, -2, 0, -2689, -7003 },
+				{ 2, 0, -1, 2, -2602, 0 }, { 2, -1, -2, 0, 2390, 10056 },
+				{ 1, 0, 1, 0, -2348, 6322 }, { 2, -2, 0, 0, 2236, -9884 },
+				{ 0, 1, 2, 0, -2120, 5751 }, { 0, 2, 0, 0, -2069, 0 },
+				{ 2, -2, -1, 0, 2048, -4950 }, { 2, 0, 1, -2, -1773, 4130 },
+				{ 2, 0, 0, 2, -1595, 0 }, { 4, -1, -1, 0, 1215, -3958 },
+				{ 0, 0, 2, 2, -1110, 0 }, { 3, 0, -1, 0, -892, 3258 },
+				{ 2, 1, 1, 0, -810, 2616 }, { 4, -1, -2, 0, 759, -1897 },
+				{ 0, 2, -1, 0, -713, -2117 }, { 2, 2, -1, 0, -700, 2354 },
+				{ 2, 1, -2, 0, 691, 0 }, { 2, -1, 0, -2, 596, 0 },
+				{ 4, 0, 1, 0, 549, -1423 }, { 0, 0, 4, 0, 537, -1117 },
+				{ 4, -1, 0, 0, 520, -1571 }, { 1, 0, -2, 0, -487, -1739 },
+				{ 2, 1, 0, -2, -399, 0 }, { 0, 0, 2, -2, -381, -4421 },
+				{ 1, 1, 1, 0, 351, 0 }, { 3, 0, -2, 0, -340, 0 },
+				{ 4, 0, -3, 0, 330, 0 }, { 2, -1, 2, 0, 327, 0 },
+				{ 0, 2, 1, 0, -323, 1165 }, { 1, 1, -1, 0, 299, 0 },
+				{ 2, 0, 3, 0, 294, 0 }, { 2, 0, -1, -2, 0, 8752 }
+			};
+
+			const int _MoonLatitudeTerms[][5] = {
+				{ 0, 0, 0, 1, 5128122 }, { 0, 0, 1, 1, 280602 }, { 0, 0, 1, -1, 277693 },
+				{ 2, 0, 0, -1, 173237 }, { 2, 0, -1, 1, 55413 }, { 2, 0, -1, -1, 46271 },
+				{ 2, 0, 0, 1, 32573 }, { 0, 0, 2, 1, 17198 }, { 2, 0, 1, -1, 9266 },
+				{ 0, 0, 2, -1, 8822 }, { 2, -1, 0, -1, 8216 }, { 2, 0, -2, -1, 4324 },
+				{ 2, 0, 1, 1, 4200 }, { 2, 1, 0, -1, -3359 }, { 2, -1, -1, 1, 2463 },
+				{ 2, -1, 0, 1, 2211 }, { 2, -1, -1, -1, 2065 }, { 0, 1, -1, -1, -1870 },
+				{ 4, 0, -1, -1, 1828 }, { 0, 1, 0, 1, -1794 }, { 0, 0, 0, 3, -1749 },
+				{ 0, 1, -1, 1, -1565 }, { 1, 0, 0, 1, -1491 }, { 0, 1, 1, 1, -1475 },
+				{ 0, 1, 1, -1, -1410 }, { 0, 1, 0, -1, -1344 }, { 1, 0, 0, -1, -1335 },
+				{ 0, 0, 3, 1, 1107 }, { 4, 0, 0, -1, 1021 }, { 4, 0, -1, 1, 833 },
+				{ 0, 0, 1, -3, 777 }, { 4, 0, -2, 1, 671 }, { 2, 0, 0, -3, 607 },
+				{ 2, 0, 2, -1, 596 }, { 2, -1, 1, -1, 491 }, { 2, 0, -2, 1, -451 },
+				{ 0, 0, 3, -1, 439 }, { 2, 0, 2, 1, 422 }, { 2, 0, -3, -1, 421 },
+				{ 2, 1, -1, 1, -366 }, { 2, 1, 0, 1, -351 }, { 4, 0, 0, 1, 331 },
+				{ 2, -1, 1, 1, 315 }, { 2, -2, 0, -1, 302 }, { 0, 0, 1, 3, -283 },
+				{ 2, 1, 1, -1, -229 }, { 1, 1, 0, -1, 223 }, { 1, 1, 0, 1, 223 },
+				{ 0, 1, -2, -1, -220 }, { 2, 1, -1, -1, -220 }, { 1, 0, 1, 1, -185 },
+				{ 2, -1, -2, -1, 181 }, { 0, 1, 2, 1, -177 }, { 4, 0, -2, -1, 176 },
+				{ 4, -1, -1, -1, 166 }, { 1, 0, 1, -1, -164 }, { 4, 0, 1, -1, 132 },
+				{ 1, 0, -1, -1, -119 }, { 4, -1, 0, -1, 115 }, { 2, -2, 0, 1, 107 }
+			};
+
+			/**
+			* Sum one series of VSOP87 terms.
+			*/
+			template <int count>
+			double _SumTerms(const double(&terms)[count][3], double t)
+			{
+				double sum = 0.0;
+
+				for (int i = 0; i < count; i++)
+					sum += terms[i][0] * std::cos(terms[i][1] + terms[i][2] * t);
+
+				return sum;
+			}
+
+			/**
+			* Reduce an angle in degrees and convert it to radians.
+			*/
+			double _DegreesToRadians(double degrees)
+			{
+				return MATH::RevolutionReductionDegrees(degrees) * MATH::DegreesToRadians;
+			}
+
+			/**
+			* Sum the series of the sun and the moon for a node.
+			*/
+			void _EvaluateNode(double julianDay, double * values)
+			{
+				double year = 2000.0 + (julianDay - _J2000) / 365.25;
+				double julianEphemerisDay = julianDay + CalculateDeltaT(year) / 86400.0;
+
+				EclipticPosition sun = CalculateSunEcliptic(julianEphemerisDay);
+				EclipticPosition moon = CalculateMoonEcliptic(julianEphemerisDay);
+
+				values[_SunLongitude] = sun.longitude;
+				values[_SunLatitude] = sun.latitude;
+				values[_SunDistance] = sun.distance;
+				values[_MoonLongitude] = moon.longitude;
+				values[_MoonLatitude] = moon.latitude;
+				values[_MoonDistance] = moon.distance;
+
+				CalculateNutation(julianEphemerisDay, &values[_NutationLongitude], &values[_Obliquity]);
+			}
+
+			/**
+			* Find the place in the sky of something from its right
+			* ascension and declination.
+			*
+			* @param hourAngle The local hour angle in radians.
+			*/
+			SkyPosition _Horizon(double hourAngle, double declination, double latitude)
+			{
+				double x = std::cos(hourAngle) * std::cos(declination);
+				double y = std::sin(hourAngle) * std::cos(declination);
+				double z = std::sin(declination);
+
+				double xhor = x * std::sin(latitude) - z * std::cos(latitude);
+				double yhor = y;
+				double zhor = x * std::cos(latitude) + z * std::sin(latitude);
+
+				if (zhor > 1.0)
+					zhor = 1.0;
+				else if (zhor < -1.0)
+					zhor = -1.0;
+
+				//same as CalculateSunPosition
+				return SkyPosition((float)(std::atan2(yhor, xhor) + MATH::PI), (float)std::acos(zhor));
+			}
+
+			/**
+			* The angle between two places in the sky in degrees.
+			*/
+			double _Separation(const SkyPosition & first, const SkyPosition & second)
+			{
+				double dot = std::sin((double)first.Zenith) * std::sin((double)second.Zenith) * std::cos((double)first.Azimuth - second.Azimuth) +
+					std::cos((double)first.Zenith) * std::cos((double)second.Zenith);
+
+				return std::acos(std::max(-1.0, std::min(1.0, dot))) * MATH::RadiansToDegrees;
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		double CalculateDeltaT(double year)
+		{
+			double t;
+
+			if (year < 1900.0 || year >= 2150.0)
+			{
+				double u = (year - 1820.0) / 100.0;
+				return -20.0 + 32.0 * u * u;
+			}
+
+			if (year < 1920.0)
+			{
+				t = year - 1900.0;
+				return -2.79 + 1.494119 * t - 0.0598939 * t * t + 0.0061966 * t * t * t - 0.000197 * t * t * t * t;
+			}
+
+			if (year < 1941.0)
+			{
+				t = year - 1920.0;
+				return 21.20 + 0.84493 * t - 0.076100 * t * t + 0.0020936 * t * t * t;
+			}
+
+			if (year < 1961.0)
+			{
+				t = year - 1950.0;
+				return 29.07 + 0.407 * t - t * t / 233.0 + t * t * t / 2547.0;
+			}
+
+			if (year < 1986.0)
+			{
+				t = year - 1975.0;
+				return 45.45 + 1.067 * t - t * t / 260.0 - t * t * t / 718.0;
+			}
+
+			if (year < 2005.0)
+			{
+				t = year - 2000.0;
+				return 63.86 + 0.3345 * t - 0.060374 * t * t + 0.0017275 * t * t * t + 0.000651814 * t * t * t * t + 0.00002373599 * t * t * t * t * t;
+			}
+
+			if (year < 2050.0)
+			{
+				t = year - 2000.0;
+				return 62.92 + 0.32217 * t + 0.005589 * t * t;
+			}
+
+			double u = (year - 1820.0) / 100.0;
+			return -20.0 + 32.0 * u * u - 0.5628 * (2150.0 - year);
+		}
+
+		void CalculateNutation(double julianEphemerisDay, double * nutationLongitude, double * obliquity)
+		{
+			double T = (julianEphemerisDay - _J2000) / 36525.0;
+
+			//longitude of the moon's ascending node and the mean longitudes
+			//of the sun and the moon
+			double omega = _DegreesToRadians(125.04452 - 1934.136261 * T);
+			double sunLongitude = _DegreesToRadians(280.4665 + 36000.7698 * T);
+			double moonLongitude = _DegreesToRadians(218.3165 + 481267.8813 * T);
+
+			//in arc seconds
+			double deltaPsi = -17.20 * std::sin(omega) - 1.32 * std::sin(2.0 * sunLongitude) - 0.23 * std::sin(2.0 * moonLongitude) + 0.21 * std::sin(2.0 * omega);
+			double deltaEpsilon = 9.20 * std::cos(omega) + 0.57 * std::cos(2.0 * sunLongitude) + 0.10 * std::cos(2.0 * moonLongitude) - 0.09 * std::cos(2.0 * omega);
+
+			double meanObliquity = 84381.448 - 46.8150 * T - 0.00059 * T * T + 0.001813 * T * T * T;
+
+			if (nutationLongitude != NULL)
+				*nutationLongitude = deltaPsi / 3600.0 * MATH::DegreesToRadians;
+
+			if (obliquity != NULL)
+				*obliquity = (meanObliquity + deltaEpsilon) / 3600.0 * MATH::DegreesToRadians;
+		}
+
+		EclipticPosition CalculateSunEcliptic(double julianEphemerisDay)
+		{
+			double t = (julianEphemerisDay - _J2000) / 365250.0;
+
+			double L = (_SumTerms(_EarthL0, t) +
+				t * (_SumTerms(_EarthL1, t) +
+				t * (_SumTerms(_EarthL2, t) +
+				t * (_SumTerms(_EarthL3, t) +
+				t * (_SumTerms(_EarthL4, t) +
+				t * _SumTerms(_EarthL5, t)))))) / 1e8;
+
+			double B = (_SumTerms(_EarthB0, t) + t * _SumTerms(_EarthB1, t)) / 1e8;
+
+			double R = (_SumTerms(_EarthR0, t) +
+				t * (_SumTerms(_EarthR1, t) +
+				t * (_SumTerms(_EarthR2, t) +
+				t * (_SumTerms(_EarthR3, t) +
+				t * _SumTerms(_EarthR4, t))))) / 1e8;
+
+			double nutationLongitude;
+			CalculateNutation(julianEphemerisDay, &nutationLongitude, NULL);
+
+			//the sun is opposite the Earth, then aberration
+			double aberration = -20.4898 / (3600.0 * R) * MATH::DegreesToRadians;
+
+			EclipticPosition rtn;
+			rtn.longitude = MATH::RevolutionReduction(L + MATH::PI + nutationLongitude + aberration);
+			rtn.latitude = -B;
+			rtn.distance = R * _AstronomicalUnit;
+
+			return rtn;
+		}
+
+		EclipticPosition CalculateMoonEcliptic(double julianEphemerisDay)
+		{
+			double T = (julianEphemerisDay - _J2000) / 36525.0;
+			double T2 = T * T;
+			double T3 = T2 * T;
+			double T4 = T3 * T;
+
+			//mean longitude, mean elongation, the sun's mean anomaly, the
+			//moon's mean anomaly and argument of latitude
+			double Lp = _DegreesToRadians(218.3164477 + 481267.88123421 * T - 0.0015786 * T2 + T3 / 538841.0 - T4 / 65194000.0);
+			double D = _DegreesToRadians(297.8501921 + 445267.1114034 * T - 0.0018819 * T2 + T3 / 545868.0 - T4 / 113065000.0);
+			double M = _DegreesToRadians(357.5291092 + 35999.0502909 * T - 0.0001536 * T2 + T3 / 24490000.0);
+			double Mp = _DegreesToRadians(134.9633964 + 477198.8675055 * T + 0.0087414 * T2 + T3 / 69699.0 - T4 / 14712000.0);
+			double F = _DegreesToRadians(93.2720950 + 483202.0175233 * T - 0.0036539 * T2 - T3 / 3526000.0 + T4 / 863310000.0);
+
+			double A1 = _DegreesToRadians(119.75 + 131.849 * T);
+			double A2 = _DegreesToRadians(53.09 + 479264.290 * T);
+			double A3 = _DegreesToRadians(313.45 + 481266.484 * T);
+
+			//the shrinking eccentricity of the Earth's orbit
+			double E = 1.0 - 0.002516 * T - 0.0000074 * T2;
+			double scale[3] = { E * E, E, 1.0 };
+
+			double sumL = 0.0;
+			double sumR = 0.0;
+			double sumB = 0.0;
+
+			const int numLongitudeTerms = sizeof(_MoonLongitudeDistance) / sizeof(_MoonLongitudeDistance[0]);
+			for (int i = 0; i < numLongitudeTerms; i++)
+			{
+				const int * term = _MoonLongitudeDistance[i];
+				double argument = term[0] * D + term[1] * M + term[2] * Mp + term[3] * F;
+				double factor = (term[1] == 0) ? 1.0 : scale[(term[1] < 0) ? 2 + term[1] : 2 - term[1]];
+
+				sumL += term[4] * factor * std::sin(argument);
+				sumR += term[5] * factor * std::cos(argument);
+			}
+
+			const int numLatitudeTerms = sizeof(_MoonLatitudeTerms) / sizeof(_MoonLatitudeTerms[0]);
+			for (int i = 0; i < numLatitudeTerms; i++)
+			{
+				const int * term = _MoonLatitudeTerms[i];
+				double argument = term[0] * D + term[1] * M + term[2] * Mp + term[3] * F;
+				double factor = (term[1] == 0) ? 1.0 : scale[(term[1] < 0) ? 2 + term[1] : 2 - term[1]];
+
+				sumB += term[4] * factor * std::sin(argument);
+			}
+
+			//Venus, Jupiter and the flattening of the Earth
+			sumL += 3958.0 * std::sin(A1) + 1962.0 * std::sin(Lp - F) + 318.0 * std::sin(A2);
+			sumB += -2235.0 * std::sin(Lp) + 382.0 * std::sin(A3) + 175.0 * std::sin(A1 - F) +
+				175.0 * std::sin(A1 + F) + 127.0 * std::sin(Lp - Mp) - 115.0 * std::sin(Lp + Mp);
+
+			double nutationLongitude;
+			CalculateNutation(julianEphemerisDay, &nutationLongitude, NULL);
+
+			EclipticPosition rtn;
+			rtn.longitude = MATH::RevolutionReduction(Lp + sumL / 1e6 * MATH::DegreesToRadians + nutationLongitude);
+			rtn.latitude = sumB / 1e6 * MATH::DegreesToRadians;
+			rtn.distance = 385000.56 + sumR / 1000.0;
+
+			return rtn;
+		}
+
+		void EclipticToEquatorial(const EclipticPosition & position, double obliquity, double * rightAscension, double * declination)
+		{
+			double sinLongitude = std::sin(position.longitude);
+
+			if (rightAscension != NULL)
+			{
+				*rightAscension = MATH::RevolutionReduction(std::atan2(
+					sinLongitude * std::cos(obliquity) - std::tan(position.latitude) * std::sin(obliquity),
+					std::cos(position.longitude)));
+			}
+
+			if (declination != NULL)
+			{
+				*declination = std::asin(std::sin(position.latitude) * std::cos(obliquity) +
+					std::cos(position.latitude) * std::sin(obliquity) * sinLongitude);
+			}
+		}
+
+		double CalculateGreenwichSiderealTime(double julianDay)
+		{
+			double T = (julianDay - _J2000) / 36525.0;
+
+			double theta = 280.46061837 + 360.98564736629 * (julianDay - _J2000) +
+				0.000387933 * T * T - T * T * T / 38710000.0;
+
+			return _DegreesToRadians(theta);
+		}
+
+		double CalculateJulianDayUT(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year)
+		{
+			return _Jan02000 + DaysSinceJan02000(month, day, year) + ((double)standardTime - UTCoffset) / 24.0;
+		}
+
+		EphemerisCache::EphemerisCache(double nodeSpacing) :
+			_nodeSpacing((nodeSpacing > 0.0) ? nodeSpacing : DefaultEphemerisNodeSpacing),
+			_evaluations(0)
+		{
+			Clear();
+		}
+
+		void EphemerisCache::Clear()
+		{
+			for (int i = 0; i < _NumNodes; i++)
+			{
+				_nodes[i].valid = false;
+				_nodes[i].index = 0;
+			}
+		}
+
+		const EphemerisCache::_Node & EphemerisCache::_GetNode(long long index)
+		{
+			int slot = (int)(((index % _NumNodes) + _NumNodes) % _NumNodes);
+			_Node & node = _nodes[slot];
+
+			if (!node.valid || node.index != index)
+			{
+				_EvaluateNode(_J2000 + index * _nodeSpacing / 24.0, node.values);
+				node.valid = true;
+				node.index = index;
+				_evaluations++;
+			}
+
+			return node;
+		}
+
+		void EphemerisCache::GetPositions(double julianDay, EclipticPosition * sun, EclipticPosition * moon, double * obliquity, double * nutationLongitude)
+		{
+			double position = (julianDay - _J2000) * 24.0 / _nodeSpacing;
+			long long index = (long long)std::floor(position);
+			double t = position - (double)index;
+
+			//cubic through the nodes before and after
+			const _Node * nodes[4] = { &_GetNode(index - 1), &_GetNode(index), &_GetNode(index + 1), &_GetNode(index + 2) };
+			double weights[4] = {
+				-t * (t - 1.0) * (t - 2.0) / 6.0,
+				(t + 1.0) * (t - 1.0) * (t - 2.0) / 2.0,
+				-(t + 1.0) * t * (t - 2.0) / 2.0,
+				(t + 1.0) * t * (t - 1.0) / 6.0
+			};
+
+			double values[_NumValues];
+
+			for (int v = 0; v < _NumValues; v++)
+			{
+				double first = nodes[0]->values[v];
+				double sum = 0.0;
+
+				for (int n = 0; n < 4; n++)
+				{
+					double value = nodes[n]->values[v];
+
+					//longitudes wrap at 2PI
+					if (v == _SunLongitude || v == _MoonLongitude)
+					{
+						if (value - first > MATH::PI)
+							value -= MATH::PIx2;
+						else if (first - value > MATH::PI)
+							value += MATH::PIx2;
+					}
+
+					sum += weights[n] * value;
+				}
+
+				values[v] = sum;
+			}
+
+			if (sun != NULL)
+			{
+				sun->longitude = MATH::RevolutionReduction(values[_SunLongitude]);
+				sun->latitude = values[_SunLatitude];
+				sun->distance = values[_SunDistance];
+			}
+
+			if (moon != NULL)
+			{
+				moon->longitude = MATH::RevolutionReduction(values[_MoonLongitude]);
+				moon->latitude = values[_MoonLatitude];
+				moon->distance = values[_MoonDistance];
+			}
+
+			if (obliquity != NULL)
+				*obliquity = values[_Obliquity];
+
+			if (nutationLongitude != NULL)
+				*nutationLongitude = values[_NutationLongitude];
+		}
+
+		SkyData EphemerisCache::CalculateSkyData(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude)
+		{
+			return CalculateSkyData(CalculateJulianDayUT(standardTime, UTCoffset, month, day, year), latitude, longitude);
+		}
+
+		SkyData EphemerisCache::CalculateSkyData(const Timestamp & time, float latitude, float longitude)
+		{
+			return CalculateSkyData(time.GetJulianDay(), latitude, longitude);
+		}
+
+		SkyData EphemerisCache::CalculateSkyData(double julianDay, float latitude, float longitude)
+		{
+			EclipticPosition sun, moon;
+			double obliquity, nutationLongitude;
+			GetPositions(julianDay, &sun, &moon, &obliquity, &nutationLongitude);
+
+			//apparent sidereal time, with the equation of the equinoxes
+			double localSiderealTime = CalculateGreenwichSiderealTime(julianDay) + nutationLongitude * std::cos(obliquity) + longitude;
+
+			double rightAscension, declination;
+
+			SkyData rtn;
+
+			EclipticToEquatorial(sun, obliquity, &rightAscension, &declination);
+			rtn.sunPos = _Horizon(localSiderealTime - rightAscension, declination, latitude);
+
+			EclipticToEquatorial(moon, obliquity, &rightAscension, &declination);
+			rtn.moonPos = _Horizon(localSiderealTime - rightAscension, declination, latitude);
+
+			//the moon is close enough that it sits lower in the sky than it
+			//would from the center of the Earth
+			double altitude = MATH::PId2 - rtn.moonPos.Zenith;
+			rtn.moonPos.Zenith += (float)std::asin(_EarthRadius / moon.distance * std::cos(altitude));
+
+			rtn.northStarZenith = CalculateCelestialNorthPoleZenith(latitude);
+
+			double UT = (julianDay + 0.5 - std::floor(julianDay + 0.5)) * 24.0;
+			rtn.starRotation = CalculateStarRotation((float)UT, 0.0f);
+
+			rtn.phase = (float)(MATH::RevolutionReduction(moon.longitude - sun.longitude) * MATH::RadiansToDegrees);
+
+			rtn.moonVisibility = CalculateMoonVisibility(rtn.sunPos.Azimuth, rtn.sunPos.Zenith, rtn.moonPos.Azimuth, rtn.moonPos.Zenith);
+
+			return rtn;
+		}
+
+		void BenchmarkEphemeris(std::ostream & out)
+		{
+			//a 20 hour time lapse from 2015 March 1 0h UT, 3.6 seconds a
+			//frame
+			const int numFrames = 20000;
+			const float hoursPerFrame = 0.001f;
+			const float latitude = 41.0f * MATH::DegreesToRadiansf;
+			const float longitude = -112.0f * MATH::DegreesToRadiansf;
+
+			const char * names[4] = { "simple", "accurate, hourly nodes", "accurate, daily nodes", "series every frame" };
+			double microseconds[4];
+			int sums[4] = { 0, 0, 0, 0 };
+			double worstSun[4] = { 0.0, 0.0, 0.0, 0.0 };
+			double worstMoon[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+			//keeps the compiler from dropping the work
+			volatile float sink = 0.0f;
+
+			for (int model = 0; model < 4; model++)
+			{
+				EphemerisCache cache((model == 2) ? 24.0 : DefaultEphemerisNodeSpacing);
+
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+				for (int f = 0; f < numFrames; f++)
+				{
+					float hour = f * hoursPerFrame;
+
+					if (model == 0)
+					{
+						sink += SKY::CalculateSkyData(hour, 0.0f, MARCH, 1, 2015, latitude, longitude).sunPos.Zenith;
+					}
+					else if (model == 3)
+					{
+						//only the series, not the rest of the SkyData
+						double time = 2457082.5 + hour / 24.0;
+						sink += (float)(CalculateSunEcliptic(time).longitude + CalculateMoonEcliptic(time).longitude);
+					}
+					else
+					{
+						sink += cache.CalculateSkyData(hour, 0.0f, MARCH, 1, 2015, latitude, longitude).sunPos.Zenith;
+					}
+				}
+
+				std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+				microseconds[model] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000.0 / numFrames;
+				sums[model] = (model == 0) ? 0 : ((model == 3) ? numFrames : cache.GetEvaluationCount());
+			}
+
+			//nodes every 36 seconds interpolate to far less than SkyPosition
+			//can hold, so they stand in for the series
+			EphemerisCache reference(0.01);
+			EphemerisCache hourly;
+			EphemerisCache daily(24.0);
+
+			for (int f = 0; f < numFrames; f += 20)
+			{
+				float hour = f * hoursPerFrame;
+				SkyData exact = reference.CalculateSkyData(hour, 0.0f, MARCH, 1, 2015, latitude, longitude);
+				SkyData data[3] =
+				{
+					SKY::CalculateSkyData(hour, 0.0f, MARCH, 1, 2015, latitude, longitude),
+					hourly.CalculateSkyData(hour, 0.0f, MARCH, 1, 2015, latitude, longitude),
+					daily.CalculateSkyData(hour, 0.0f, MARCH, 1, 2015, latitude, longitude)
+				};
+
+				for (int model = 0; model < 3; model++)
+				{
+					worstSun[model] = std::max(worstSun[model], _Separation(data[model].sunPos, exact.sunPos) * 3600.0);
+					worstMoon[model] = std::max(worstMoon[model], _Separation(data[model].moonPos, exact.moonPos) * 3600.0);
+				}
+			}
+
+			std::ios::fmtflags flags = out.flags();
+			std::streamsize precision = out.precision();
+
+			out << "Ephemeris benchmark (" << numFrames << " frames, " << hoursPerFrame * 3600.0f << " seconds apart)\n";
+			out << std::left << std::setw(24) << "model" << std::right << std::setw(12) << "us/frame" << std::setw(13) << "series sums"
+				<< std::setw(14) << "sun error \"" << std::setw(15) << "moon error \"" << "\n";
+
+			for (int model = 0; model < 4; model++)
+			{
+				out << std::left << std::setw(24) << names[model] << std::right << std::fixed << std::setprecision(3)
+					<< std::setw(12) << microseconds[model] << std::setw(13) << sums[model];
+
+				//the series are what the others are measured against
+				if (model == 3)
+					out << std::setw(14) << "-" << std::setw(15) << "-";
+				else
+					out << std::setw(14) << worstSun[model] << std::setw(15) << worstMoon[model];
+
+				out << "\n";
+			}
+
+			out.flags(flags);
+			out.precision(precision);
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* The difference of two angles in radians, in degrees.
+			*/
+			double _AngleDifference(double first, double second)
+			{
+				double difference = MATH::RevolutionReduction(first - second);
+
+				if (difference > MATH::PI)
+					difference = MATH::PIx2 - difference;
+
+				return difference * MATH::RadiansToDegrees;
+			}
+		}
+
+		bool EphemerisCache::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Ephemeris Tests");
+
+			const double toDegrees = MATH::RadiansToDegrees;
+
+			//NREL SPA example: 2003 October 17 19:30:30 UT, Delta T 67 s
+			double julianDay = CalculateJulianDayUT(12.5f + 30.0f / 3600.0f, -7.0f, OCTOBER, 17, 2003);
+			test->UnitTest(std::fabs(julianDay - 2452930.312847) < 1e-5, "Julian day");
+
+			EclipticPosition sun = CalculateSunEcliptic(julianDay + 67.0 / 86400.0);
+			double nutationLongitude, obliquity;
+			CalculateNutation(julianDay + 67.0 / 86400.0, &nutationLongitude, &obliquity);
+
+			double rightAscension, declination;
+			EclipticToEquatorial(sun, obliquity, &rightAscension, &declination);
+
+			test->UnitTest(std::fabs(sun.distance / _AstronomicalUnit - 0.9965422974) < 1e-7, "Sun distance SPA");
+			test->UnitTest(std::fabs(sun.longitude * toDegrees - 204.0085519281) < 0.0003, "Sun longitude SPA");
+			test->UnitTest(std::fabs(rightAscension * toDegrees - 202.22741) < 0.0003, "Sun right ascension SPA");
+			test->UnitTest(std::fabs(declination * toDegrees + 9.31434) < 0.0003, "Sun declination SPA");
+			test->UnitTest(std::fabs(obliquity * toDegrees - 23.440465) < 0.0001, "Obliquity SPA");
+
+			//Meeus example 47.a: 1992 April 12 0h TD
+			EclipticPosition moon = CalculateMoonEcliptic(2448724.5);
+			CalculateNutation(2448724.5, &nutationLongitude, &obliquity);
+			EclipticToEquatorial(moon, obliquity, &rightAscension, &declination);
+
+			test->UnitTest(std::fabs(moon.longitude * toDegrees - 133.167265) < 0.0003, "Moon longitude Meeus");
+			test->UnitTest(std::fabs(moon.latitude * toDegrees + 3.229126) < 0.00001, "Moon latitude Meeus");
+			test->UnitTest(std::fabs(moon.distance - 368409.7) < 0.1, "Moon distance Meeus");
+			test->UnitTest(std::fabs(rightAscension * toDegrees - 134.688470) < 0.0003, "Moon right ascension Meeus");
+			test->UnitTest(std::fabs(declination * toDegrees - 13.768368) < 0.0003, "Moon declination Meeus");
+
+			//Delta T
+			test->UnitTest(std::fabs(CalculateDeltaT(2003.8) - 64.6) < 0.5, "Delta T 2003");
+			test->UnitTest(std::fabs(CalculateDeltaT(1950.0) - 29.1) < 0.5, "Delta T 1950");
+			test->UnitTest(std::fabs(CalculateDeltaT(2005.0) - CalculateDeltaT(2004.9999)) < 0.1, "Delta T continuous");
+
+			//Greenwich sidereal time, Meeus example 12.a: 1987 April 10 0h UT
+			test->UnitTest(std::fabs(CalculateGreenwichSiderealTime(2446895.5) * toDegrees - 197.693195) < 1e-5, "Sidereal time");
+
+			//interpolating between nodes against summing the series
+			{
+				EphemerisCache hourly;
+				EphemerisCache daily(24.0);
+
+				double worstHourly = 0.0;
+				double worstDaily = 0.0;
+
+				for (int i = 0; i < 200; i++)
+				{
+					double time = 2457000.5 + i * 1.8371;
+					double deltaT = CalculateDeltaT(2000.0 + (time - _J2000) / 365.25) / 86400.0;
+
+					EclipticPosition sunDirect = CalculateSunEcliptic(time + deltaT);
+					EclipticPosition moonDirect = CalculateMoonEcliptic(time + deltaT);
+
+					EclipticPosition sunCached, moonCached;
+
+					hourly.GetPositions(time, &sunCached, &moonCached);
+					worstHourly = std::max(worstHourly, _AngleDifference(sunCached.longitude, sunDirect.longitude));
+					worstHourly = std::max(worstHourly, _AngleDifference(moonCached.longitude, moonDirect.longitude));
+					worstHourly = std::max(worstHourly, std::fabs(moonCached.latitude - moonDirect.latitude) * toDegrees);
+
+					daily.GetPositions(time, &sunCached, &moonCached);
+					worstDaily = std::max(worstDaily, _AngleDifference(sunCached.longitude, sunDirect.longitude));
+					worstDaily = std::max(worstDaily, _AngleDifference(moonCached.longitude, moonDirect.longitude));
+					worstDaily = std::max(worstDaily, std::fabs(moonCached.latitude - moonDirect.latitude) * toDegrees);
+				}
+
+				//about 0.00003 and 4.4 arc seconds
+				test->UnitTest(worstHourly * 3600.0 < 0.001, "Hourly nodes interpolate to 0.001 arc seconds");
+				test->UnitTest(worstDaily * 3600.0 < 6.0, "Daily nodes interpolate to 6 arc seconds");
+			}
+
+			//frames only sum the series when they move into a new hour
+			{
+				EphemerisCache cache;
+
+				for (int frame = 0; frame < 60 * 60 * 60; frame++)
+					cache.CalculateSkyData(20.5f + frame / (60.0f * 3600.0f), -7.0f, MARCH, 13, 2015, 0.7155f, -1.9548f);
+
+				test->UnitTest(cache.GetEvaluationCount() == 5, "An hour of frames sums 5 nodes");
+
+				cache.CalculateSkyData(20.75f, -7.0f, MARCH, 13, 2015, 0.7155f, -1.9548f);
+				test->UnitTest(cache.GetEvaluationCount() == 5, "Going back is cached");
+
+				cache.Clear();
+				cache.CalculateSkyData(20.75f, -7.0f, MARCH, 13, 2015, 0.7155f, -1.9548f);
+				test->UnitTest(cache.GetEvaluationCount() == 9, "Clear forgets the nodes");
+
+				EphemerisCache bad(-1.0);
+				test->UnitTest(bad.GetNodeSpacing() == DefaultEphemerisNodeSpacing, "Bad node spacing");
+			}
+
+			//the accurate SkyData against the simple one
+			{
+				EphemerisCache cache;
+
+				double worstSun = 0.0;
+				double worstMoon = 0.0;
+				double worstPhase = 0.0;
+
+				const float latitude = 41.0f * MATH::DegreesToRadiansf;
+				const float longitude = -112.0f * MATH::DegreesToRadiansf;
+
+				for (int i = 0; i < 100; i++)
+				{
+					DATE_MONTH month = (DATE_MONTH)(i % 12);
+					unsigned int day = 1 + (i * 7) % 28;
+					float hour = (float)((i * 5) % 24);
+
+					SkyData simple = SKY::CalculateSkyData(hour, -6.0f, month, day, 2015, latitude, longitude);
+					SkyData accurate = cache.CalculateSkyData(hour, -6.0f, month, day, 2015, latitude, longitude);
+
+					worstSun = std::max(worstSun, _Separation(simple.sunPos, accurate.sunPos));
+					worstMoon = std::max(worstMoon, _Separation(simple.moonPos, accurate.moonPos));
+
+					double phase = std::fabs(simple.phase - accurate.phase);
+					worstPhase = std::max(worstPhase, std::min(phase, 360.0 - phase));
+
+					if (i == 0)
+					{
+						test->UnitTest(simple.northStarZenith == accurate.northStarZenith, "Same north star zenith");
+						test->UnitTest(std::fabs(simple.starRotation - accurate.starRotation) < 1e-4f, "Same star rotation");
+					}
+				}
+
+				//about 0.5 arc minutes for the sun. The simple moon leaves out
+				//the largest perturbations and the parallax, so it is off by
+				//up to about 2.7 degrees but the phase only by about 0.3.
+				test->UnitTest(worstSun < 1.0 / 60.0, "Simple sun is within an arc minute");
+				test->UnitTest(worstMoon < 3.0, "Simple moon is within 3 degrees");
+				test->UnitTest(worstPhase < 0.5, "Simple moon phase is within half a degree");
+			}
+
+			//selecting the model of a SkyCalculations
+			{
+				DateTime dateTime;
+				dateTime.SetDate(MARCH, 13, 2015);
+				dateTime.SetTimeHours(6.6f);
+				dateTime.SetUTCOffset(-6.0f);
+
+				GPS gps;
+				gps.SetLatitude(41.0f);
+				gps.SetLongitude(-112.0f);
+
+				SkyCalculations calculations(&dateTime, &gps);
+				test->UnitTest(calculations.GetEphemerisModel() == EPHEMERIS_SIMPLE, "Simple by default");
+
+				SkyData simple = calculations.CalculateAllSkyData();
+				calculations.SetEphemerisModel(EPHEMERIS_ACCURATE);
+				SkyData accurate = calculations.CalculateAllSkyData();
+
+				EphemerisCache cache;
+				SkyData expected = cache.CalculateSkyData(6.6f, -6.0f, MARCH, 13, 2015, gps.GetLatitudeRadians(), gps.GetLongitudeRadians());
+
+				test->UnitTest(calculations.GetEphemerisModel() == EPHEMERIS_ACCURATE, "Model selected");
+				test->UnitTest(accurate.sunPos.Azimuth == expected.sunPos.Azimuth && accurate.moonPos.Zenith == expected.moonPos.Zenith, "Accurate model used");
+				test->UnitTest(calculations.CalculateSunPosition().Zenith == expected.sunPos.Zenith, "Accurate sun position");
+				test->UnitTest(calculations.CalculateMoonPosition().Zenith == expected.moonPos.Zenith, "Accurate moon position");
+				test->UnitTest(simple.sunPos.Zenith != accurate.sunPos.Zenith, "Models differ");
+
+				calculations.SetEphemerisModel(EPHEMERIS_SIMPLE);
+				test->UnitTest(calculations.CalculateAllSkyData().sunPos.Zenith == simple.sunPos.Zenith, "Back to simple");
+			}
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,515 @@
+/**
+* @file GeometryBuffer.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the GeometryBuffer class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "GeometryBuffer.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#if BIOSKY_TESTING == 1
+#include "BIOSkyFunctions.hpp"
+#include <utility>
+#endif
+
+//the spans read the vertex attributes through these types
+static_assert(sizeof(BIO::Vector3D) == 3 * sizeof(float), "Vector3D must be 3 packed floats.");
+static_assert(sizeof(BIO::Vector2D) == 2 * sizeof(float), "Vector2D must be 2 packed floats.");
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			inline std::size_t _AlignUp(std::size_t value, std::size_t alignment)
+			{
+				return (value + alignment - 1) & ~(alignment - 1);
+			}
+
+			/**
+			* Check that an attribute of a given size fits in the vertex and
+			* is 4 byte aligned.
+			*/
+			inline bool _AttributeFits(int offset, int size, int stride, bool required)
+			{
+				if (offset < 0)
+					return !required && offset == -1;
+
+				return (offset % 4) == 0 && (stride % 4) == 0 && offset + size <= stride;
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		GeometryFormat GeometryFormat::PositionUVColor()
+		{
+			GeometryFormat format;
+			format.stride = 24;
+			format.positionOffset = 0;
+			format.normalOffset = -1;
+			format.UVOffset = 12;
+			format.colorOffset = 20;
+
+			return format;
+		}
+
+		GeometryFormat GeometryFormat::PositionNormalColorUV()
+		{
+			GeometryFormat format;
+			format.stride = 36;
+			format.positionOffset = 0;
+			format.normalOffset = 12;
+			format.colorOffset = 24;
+			format.UVOffset = 28;
+
+			return format;
+		}
+
+		GeometryBuffer::GeometryBuffer() :
+			_data(NULL),
+			_dataSize(0),
+			_alignment(DefaultAlignment),
+			_format(GeometryFormat::PositionUVColor()),
+			_layout(LAYOUT_INTERLEAVED),
+			_numVertecies(0),
+			_numIndecies(0),
+			_largeIndecies(false),
+			_vertexDataSize(0),
+			_indexOffset(0),
+			_positionArray(0),
+			_normalArray(0),
+			_colorArray(0),
+			_UVArray(0)
+		{
+		}
+
+		GeometryBuffer::GeometryBuffer(const RawGeometry & geometry, const GeometryFormat & format, GEOMETRY_LAYOUT layout, std::size_t alignment, unsigned int color) :
+			_data(NULL),
+			_dataSize(0),
+			_alignment(DefaultAlignment),
+			_format(format),
+			_layout(layout),
+			_numVertecies(0),
+			_numIndecies(0),
+			_largeIndecies(false),
+			_vertexDataSize(0),
+			_indexOffset(0),
+			_positionArray(0),
+			_normalArray(0),
+			_colorArray(0),
+			_UVArray(0)
+		{
+			if (Create(geometry.numVertecies, geometry.numIndecies, geometry.indecies32 != NULL, format, layout, alignment))
+				CopyFrom(geometry, color);
+		}
+
+		GeometryBuffer::GeometryBuffer(GeometryBuffer && other) :
+			_data(NULL),
+			_dataSize(0)
+		{
+			_Take(other);
+		}
+
+		GeometryBuffer & GeometryBuffer::operator = (GeometryBuffer && other)
+		{
+			if (this != &other)
+			{
+				Release();
+				_Take(other);
+			}
+
+			return *this;
+		}
+
+		GeometryBuffer::~GeometryBuffer()
+		{
+			Release();
+		}
+
+		bool GeometryBuffer::Create(int numVertecies, int numIndecies, bool largeIndecies, const GeometryFormat & format, GEOMETRY_LAYOUT layout, std::size_t alignment)
+		{
+			Release();
+
+			if (numVertecies < 0 || numIndecies < 0 ||
+				alignment < sizeof(float) || (alignment & (alignment - 1)) != 0 ||
+				format.stride <= 0 ||
+				!_AttributeFits(format.positionOffset, 12, format.stride, true) ||
+				!_AttributeFits(format.normalOffset, 12, format.stride, false) ||
+				!_AttributeFits(format.colorOffset, 4, format.stride, false) ||
+				!_AttributeFits(format.UVOffset, 8, format.stride, false))
+				return false;
+
+			_format = format;
+			_layout = layout;
+			_alignment = alignment;
+			_numVertecies = numVertecies;
+			_numIndecies = numIndecies;
+			_largeIndecies = largeIndecies;
+
+			std::size_t count = (std::size_t)numVertecies;
+
+			if (layout == LAYOUT_INTERLEAVED)
+			{
+				_positionArray = _normalArray = _colorArray = _UVArray = 0;
+				_vertexDataSize = count * format.stride;
+			}
+			else
+			{
+				std::size_t end = 0;
+
+				_positionArray = 0;
+				end = count * sizeof(Vector3D);
+
+				_normalArray = _AlignUp(end, alignment);
+				if (format.normalOffset >= 0)
+					end = _normalArray + count * sizeof(Vector3D);
+
+				_colorArray = _AlignUp(end, alignment);
+				if (format.colorOffset >= 0)
+					end = _colorArray + count * sizeof(unsigned int);
+
+				_UVArray = _AlignUp(end, alignment);
+				if (format.UVOffset >= 0)
+					end = _UVArray + count * sizeof(Vector2D);
+
+				_vertexDataSize = end;
+			}
+
+			_indexOffset = _AlignUp(_vertexDataSize, alignment);
+			_dataSize = _indexOffset + GetIndexDataSize();
+
+			_data = (unsigned char *)Allocate((_dataSize > 0) ? _dataSize : alignment, alignment);
+
+			if (_data == NULL)
+			{
+				Release();
+				return false;
+			}
+
+			memset(_data, 0, _dataSize);
+
+			return true;
+		}
+
+		bool GeometryBuffer::CopyFrom(const RawGeometry & geometry, unsigned int color)
+		{
+			if (_data == NULL || geometry.numVertecies > _numVertecies || geometry.numIndecies > _numIndecies)
+				return false;
+
+			//32 bit indecies must fit in a 16 bit buffer
+			if (!_largeIndecies && geometry.indecies32)
+			{
+				for (int i = 0; i < geometry.numIndecies; i++)
+				{
+					if (geometry.indecies32[i] > 0xFFFF)
+						return false;
+				}
+			}
+
+			GeometrySpan<Vector3D> positions = GetPositions();
+			GeometrySpan<Vector3D> normals = GetNormals();
+			GeometrySpan<unsigned int> colors = GetColors();
+			GeometrySpan<Vector2D> uvs = GetUVTextureCoordinates();
+
+			for (int i = 0; i < geometry.numVertecies; i++)
+			{
+				const Vector3D & v = geometry.vertecies[i];
+
+				positions[i] = v;
+
+				if (!normals.empty())
+				{
+					float length = std::sqrt(v.X * v.X + v.Y * v.Y + v.Z * v.Z);
+					float scale = (length > 0.0f) ? -1.0f / length : 0.0f;
+
+					normals[i] = Vector3D(v.X * scale, v.Y * scale, v.Z * scale);
+				}
+
+				if (!colors.empty())
+					colors[i] = color;
+
+				if (!uvs.empty())
+					uvs[i] = geometry.UVTextureCoordinates[i];
+			}
+
+			if (_largeIndecies)
+			{
+				unsigned int * indecies = (unsigned int *)GetIndexData();
+
+				for (int i = 0; i < geometry.numIndecies; i++)
+					indecies[i] = geometry.GetIndex(i);
+			}
+			else
+			{
+				unsigned short * indecies = (unsigned short *)GetIndexData();
+
+				if (geometry.indecies)
+				{
+					memcpy(indecies, geometry.indecies, geometry.numIndecies * sizeof(unsigned short));
+				}
+				else
+				{
+					for (int i = 0; i < geometry.numIndecies; i++)
+						indecies[i] = (unsigned short)geometry.GetIndex(i);
+				}
+			}
+
+			return true;
+		}
+
+		void GeometryBuffer::Release()
+		{
+			if (_data)
+			{
+				Free(_data);
+				_data = NULL;
+			}
+
+			_dataSize = 0;
+			_numVertecies = 0;
+			_numIndecies = 0;
+			_vertexDataSize = 0;
+			_indexOffset = 0;
+		}
+
+		GeometrySpan<Vector3D> GeometryBuffer::GetPositions()
+		{
+			return _GetAttribute<Vector3D>(_format.positionOffset, _positionArray);
+		}
+
+		GeometrySpan<Vector3D> GeometryBuffer::GetNormals()
+		{
+			return _GetAttribute<Vector3D>(_format.normalOffset, _normalArray);
+		}
+
+		GeometrySpan<unsigned int> GeometryBuffer::GetColors()
+		{
+			return _GetAttribute<unsigned int>(_format.colorOffset, _colorArray);
+		}
+
+		GeometrySpan<Vector2D> GeometryBuffer::GetUVTextureCoordinates()
+		{
+			return _GetAttribute<Vector2D>(_format.UVOffset, _UVArray);
+		}
+
+		GeometrySpan<unsigned short> GeometryBuffer::GetIndecies16()
+		{
+			GeometrySpan<unsigned short> span;
+			span.data = (_largeIndecies) ? NULL : (unsigned short *)GetIndexData();
+			span.count = (span.data) ? _numIndecies : 0;
+			span.stride = sizeof(unsigned short);
+
+			return span;
+		}
+
+		GeometrySpan<unsigned int> GeometryBuffer::GetIndecies32()
+		{
+			GeometrySpan<unsigned int> span;
+			span.data = (_largeIndecies) ? (unsigned int *)GetIndexData() : NULL;
+			span.count = (span.data) ? _numIndecies : 0;
+			span.stride = sizeof(unsigned int);
+
+			return span;
+		}
+
+		template <typename T>
+		GeometrySpan<T> GeometryBuffer::_GetAttribute(int offset, std::size_t array)
+		{
+			GeometrySpan<T> span;
+			span.data = NULL;
+			span.count = 0;
+			span.stride = sizeof(T);
+
+			if (_data == NULL || offset < 0)
+				return span;
+
+			if (_layout == LAYOUT_INTERLEAVED)
+			{
+				span.data = (T *)(_data + offset);
+				span.stride = _format.stride;
+			}
+			else
+			{
+				span.data = (T *)(_data + array);
+			}
+
+			span.count = _numVertecies;
+
+			return span;
+		}
+
+		void GeometryBuffer::_Take(GeometryBuffer & other)
+		{
+			_data = other._data;
+			_dataSize = other._dataSize;
+			_alignment = other._alignment;
+			_format = other._format;
+			_layout = other._layout;
+			_numVertecies = other._numVertecies;
+			_numIndecies = other._numIndecies;
+			_largeIndecies = other._largeIndecies;
+			_vertexDataSize = other._vertexDataSize;
+			_indexOffset = other._indexOffset;
+			_positionArray = other._positionArray;
+			_normalArray = other._normalArray;
+			_colorArray = other._colorArray;
+			_UVArray = other._UVArray;
+
+			//leave other empty without releasing the memory it gave us
+			other._data = NULL;
+			other.Release();
+		}
+
+#if BIOSKY_TESTING == 1
+		bool GeometryBuffer::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Geometry Buffer Tests");
+
+			AllocationStats statsBefore = GetAllocationStats();
+
+			RawGeometry * dome = CreateSkyDomeGeometry(3.0f, 12, 12, true);
+
+			{
+				//interleaved
+				GeometryBuffer buffer(*dome, GeometryFormat::PositionNormalColorUV(), LAYOUT_INTERLEAVED, 64, 0xFF102030);
+
+				test->UnitTest(buffer.GetVertexCount() == dome->numVertecies && buffer.GetIndexCount() == dome->numIndecies, "Interleaved counts");
+				test->UnitTest(((std::size_t)buffer.GetData() % 64) == 0 && ((std::size_t)buffer.GetIndexData() % 64) == 0, "Interleaved alignment");
+				test->UnitTest(buffer.GetVertexDataSize() == (std::size_t)dome->numVertecies * 36, "Interleaved vertex size");
+				test->UnitTest(GetAllocationStats().currentAllocations == statsBefore.currentAllocations + 4 + 1, "One allocation");
+
+				bool same = true;
+				const unsigned char * bytes = (const unsigned char *)buffer.GetVertexData();
+				for (int i = 0; i < dome->numVertecies; i++)
+				{
+					float pos[3];
+					float uv[2];
+					unsigned int color = 0;
+					memcpy(pos, bytes + i * 36, sizeof(pos));
+					memcpy(&color, bytes + i * 36 + 24, sizeof(color));
+					memcpy(uv, bytes + i * 36 + 28, sizeof(uv));
+
+					if (pos[0] != dome->vertecies[i].X || pos[1] != dome->vertecies[i].Y || pos[2] != dome->vertecies[i].Z ||
+						uv[0] != dome->UVTextureCoordinates[i].X || uv[1] != dome->UVTextureCoordinates[i].Y || color != 0xFF102030)
+						same = false;
+				}
+				test->UnitTest(same, "Interleaved vertecies");
+
+				Vector3D normal = buffer.GetNormals()[0];
+				test->UnitTest(normal.Y == -1.0f && buffer.GetNormals().stride == 36, "Normals point inward");
+				test->UnitTest(memcmp(buffer.GetIndexData(), dome->indecies, dome->numIndecies * sizeof(unsigned short)) == 0, "Interleaved indecies");
+				test->UnitTest(buffer.GetIndecies32().empty() && buffer.GetIndecies16().size() == dome->numIndecies, "Index spans");
+
+				//move
+				GeometryBuffer moved(std::move(buffer));
+				test->UnitTest(buffer.GetData() == NULL && buffer.GetVertexCount() == 0, "Moved from buffer is empty");
+				test->UnitTest(moved.GetVertexCount() == dome->numVertecies && moved.GetColors()[5] == 0xFF102030, "Moved to buffer");
+
+				GeometryBuffer assigned;
+				assigned = std::move(moved);
+				test->UnitTest(moved.GetData() == NULL && assigned.GetPositions()[1].Y == dome->vertecies[1].Y, "Move assignment");
+			}
+
+			{
+				//separate arrays
+				GeometryBuffer buffer(*dome, GeometryFormat::PositionUVColor(), LAYOUT_SEPARATE, 16);
+
+				GeometrySpan<Vector3D> positions = buffer.GetPositions();
+				GeometrySpan<Vector2D> uvs = buffer.GetUVTextureCoordinates();
+				GeometrySpan<unsigned int> colors = buffer.GetColors();
+
+				test->UnitTest(buffer.GetNormals().empty() && positions.stride == 12 && uvs.stride == 8 && colors.stride == 4, "Separate strides");
+				test->UnitTest(((std::size_t)uvs.data % 16) == 0 && ((std::size_t)colors.data % 16) == 0, "Separate arrays are aligned");
+
+				bool same = true;
+				for (int i = 0; i < dome->numVertecies; i++)
+				{
+					if (positions[i].Z != dome->vertecies[i].Z || uvs[i].X != dome->UVTextureCoordinates[i].X || colors[i] != 0xFFFFFFFF)
+						same = false;
+				}
+				test->UnitTest(same, "Separate vertecies");
+			}
+
+			{
+				//32 bit indecies
+				GeometryBuffer buffer;
+				test->UnitTest(buffer.Create(dome->numVertecies, dome->numIndecies, true, GeometryFormat::PositionUVColor()), "Create");
+				test->UnitTest(buffer.CopyFrom(*dome), "Copy");
+				test->UnitTest(buffer.GetIndecies16().empty() && buffer.GetIndecies32()[7] == dome->indecies[7], "32 bit indecies");
+				test->UnitTest(buffer.GetIndexDataSize() == (std::size_t)dome->numIndecies * 4, "32 bit index size");
+
+				GeometryFormat bad = GeometryFormat::PositionUVColor();
+				bad.UVOffset = 20;
+				test->UnitTest(!buffer.Create(4, 6, false, bad) && buffer.GetData() == NULL, "Attributes must fit the stride");
+				test->UnitTest(!buffer.Create(4, 6, false, GeometryFormat::PositionUVColor(), LAYOUT_INTERLEAVED, 24), "Alignment must be a power of 2");
+
+				bad = GeometryFormat::PositionUVColor();
+				bad.UVOffset = 14;
+				test->UnitTest(!buffer.Create(4, 6, false, bad), "Offsets must be 4 byte aligned");
+
+				bad = GeometryFormat::PositionUVColor();
+				bad.stride = 26;
+				test->UnitTest(!buffer.Create(4, 6, false, bad), "Stride must be 4 byte aligned");
+
+				RawGeometry * big = CreateSkyDomeGeometry(3.0f, 24, 12, true);
+				test->UnitTest(buffer.Create(4, 6, false, GeometryFormat::PositionUVColor()) && !buffer.CopyFrom(*big), "Buffer too small");
+				delete big;
+
+				//a 32 bit index above 65535 does not fit a 16 bit buffer
+				RawGeometry wide;
+				wide.AllocateArrays(3, 3, true);
+				wide.indecies32[0] = 0;
+				wide.indecies32[1] = 1;
+				wide.indecies32[2] = 70000;
+				test->UnitTest(buffer.Create(3, 3, false, GeometryFormat::PositionUVColor()) && !buffer.CopyFrom(wide), "32 bit indecies are not truncated");
+
+				wide.indecies32[2] = 2;
+				test->UnitTest(buffer.CopyFrom(wide) && buffer.GetIndecies16()[2] == 2, "Small 32 bit indecies fit");
+			}
+
+			delete dome;
+			test->UnitTest(GetAllocationStats().currentBytes == statsBefore.currentBytes, "Buffers are released");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
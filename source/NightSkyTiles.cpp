@@ -0,0 +1,662 @@
+/**
+* @file NightSkyTiles.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the NightSkyTiles and NightSkyTileStreamer classes.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "NightSkyTiles.hpp"
+#include "BIOSkyFunctions.hpp"
+#include "Allocator.hpp"
+#include "MathUtils.hpp"
+#include "SkyTrace.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			inline bool _SamePixel(const unsigned char * a, const unsigned char * b)
+			{
+				return a[0] == b[0] && a[1] == b[1] && a[2] == b[2] && a[3] == b[3];
+			}
+
+			/**
+			* Run length encode pixels. Each packet starts with a control
+			* byte. Values below 128 are followed by one pixel that repeats
+			* control + 1 times. Values of 128 and up are followed by
+			* control - 127 literal pixels.
+			*
+			* @param pixels The pixels to encode.
+			*
+			* @param count The number of pixels.
+			*
+			* @param[out] out Where to write the encoded data. If NULL only the
+			*			size is calculated.
+			*
+			* @return Returns the size of the encoded data.
+			*/
+			std::size_t _EncodeRLE(const unsigned char * pixels, int count, unsigned char * out)
+			{
+				std::size_t size = 0;
+				int i = 0;
+
+				while (i < count)
+				{
+					int run = 1;
+					while (i + run < count && run < 128 && _SamePixel(pixels + (i + run) * 4, pixels + i * 4))
+						run++;
+
+					if (run > 1)
+					{
+						if (out)
+						{
+							out[size] = (unsigned char)(run - 1);
+							memcpy(out + size + 1, pixels + i * 4, 4);
+						}
+
+						size += 5;
+						i += run;
+						continue;
+					}
+
+					//gather literals until the next run starts
+					int start = i;
+					int literal = 0;
+
+					while (i < count && literal < 128)
+					{
+						if (i + 1 < count && _SamePixel(pixels + i * 4, pixels + (i + 1) * 4))
+							break;
+
+						i++;
+						literal++;
+					}
+
+					if (out)
+					{
+						out[size] = (unsigned char)(127 + literal);
+						memcpy(out + size + 1, pixels + start * 4, literal * 4);
+					}
+
+					size += 1 + literal * 4;
+				}
+
+				return size;
+			}
+
+			/**
+			* Copy one tile out of the full image into a packed buffer.
+			*/
+			void _CopyTile(const unsigned char * image, int imageWidth, const NightSkyTiles::Tile & tile, unsigned char * pixels)
+			{
+				for (int y = 0; y < tile.height; ++y)
+				{
+					memcpy(pixels + y * tile.width * 4,
+						image + ((tile.y + y) * imageWidth + tile.x) * 4,
+						tile.width * 4);
+				}
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		NightSkyTiles::NightSkyTiles(const unsigned char * image, int width, int height, int tileSize) :
+			_width(width),
+			_height(height),
+			_tileSize(tileSize),
+			_tilesX(0),
+			_tilesY(0),
+			_tiles(NULL),
+			_data(NULL),
+			_dataSize(0)
+		{
+			if (image == NULL || width <= 0 || height <= 0 || tileSize <= 0)
+			{
+				_width = _height = _tileSize = 0;
+				return;
+			}
+
+			_tilesX = (width + tileSize - 1) / tileSize;
+			_tilesY = (height + tileSize - 1) / tileSize;
+
+			int count = _tilesX * _tilesY;
+			_tiles = AllocateArray<Tile>(count);
+
+			unsigned char * pixels = AllocateArray<unsigned char>(tileSize * tileSize * 4);
+
+			//size every tile first so all of them fit in one block
+			for (int i = 0; i < count; ++i)
+			{
+				Tile & tile = _tiles[i];
+				tile.x = (i % _tilesX) * tileSize;
+				tile.y = (i / _tilesX) * tileSize;
+				tile.width = (tile.x + tileSize <= width) ? tileSize : width - tile.x;
+				tile.height = (tile.y + tileSize <= height) ? tileSize : height - tile.y;
+				tile.encoded = NULL;
+
+				_CopyTile(image, width, tile, pixels);
+				tile.encodedSize = _EncodeRLE(pixels, tile.width * tile.height, NULL);
+
+				_dataSize += tile.encodedSize;
+			}
+
+			_data = (unsigned char *)Allocate(_dataSize);
+
+			unsigned char * next = _data;
+
+			for (int i = 0; i < count; ++i)
+			{
+				Tile & tile = _tiles[i];
+
+				_CopyTile(image, width, tile, pixels);
+				_EncodeRLE(pixels, tile.width * tile.height, next);
+
+				tile.encoded = next;
+				next += tile.encodedSize;
+			}
+
+			FreeArray(pixels);
+
+			_BuildBounds();
+		}
+
+		NightSkyTiles::~NightSkyTiles()
+		{
+			if (_data)
+			{
+				Free(_data);
+				_data = NULL;
+			}
+
+			if (_tiles)
+			{
+				FreeArray(_tiles);
+				_tiles = NULL;
+			}
+
+			_dataSize = 0;
+			_tilesX = 0;
+			_tilesY = 0;
+		}
+
+		void NightSkyTiles::_BuildBounds()
+		{
+			int numIndecies = 0;
+			GetNightSkyDomeGeometrySize(NULL, &numIndecies);
+
+			const NightSkyDomeVertex * verts = GetNightSkyDomeVertecies();
+			const unsigned short * indecies = GetNightSkyDomeIndecies();
+
+			int count = GetTileCount();
+			float * sums = AllocateArray<float>(count * 3);
+			float * minCos = AllocateArray<float>(count);
+
+			for (int i = 0; i < count; ++i)
+			{
+				_tiles[i].unused = true;
+				minCos[i] = 1.0f;
+			}
+
+			//two passes. The first finds the axis of each cone and the
+			//second the angle needed to hold every vertex.
+			for (int pass = 0; pass < 2; ++pass)
+			{
+				for (int f = 0; f + 2 < numIndecies; f += 3)
+				{
+					const unsigned short * face = indecies + f;
+
+					float uMin = verts[face[0]].u;
+					float uMax = uMin;
+					float vMin = verts[face[0]].v;
+					float vMax = vMin;
+
+					for (int k = 1; k < 3; ++k)
+					{
+						uMin = (verts[face[k]].u < uMin) ? verts[face[k]].u : uMin;
+						uMax = (verts[face[k]].u > uMax) ? verts[face[k]].u : uMax;
+						vMin = (verts[face[k]].v < vMin) ? verts[face[k]].v : vMin;
+						vMax = (verts[face[k]].v > vMax) ? verts[face[k]].v : vMax;
+					}
+
+					int tx0 = (int)(uMin * _width) / _tileSize;
+					int tx1 = (int)(uMax * _width) / _tileSize;
+					int ty0 = (int)(vMin * _height) / _tileSize;
+					int ty1 = (int)(vMax * _height) / _tileSize;
+
+					tx0 = (tx0 < 0) ? 0 : tx0;
+					ty0 = (ty0 < 0) ? 0 : ty0;
+					tx1 = (tx1 >= _tilesX) ? _tilesX - 1 : tx1;
+					ty1 = (ty1 >= _tilesY) ? _tilesY - 1 : ty1;
+
+					for (int ty = ty0; ty <= ty1; ++ty)
+					{
+						for (int tx = tx0; tx <= tx1; ++tx)
+						{
+							int t = ty * _tilesX + tx;
+
+							for (int k = 0; k < 3; ++k)
+							{
+								Vector3D v(verts[face[k]].x, verts[face[k]].y, verts[face[k]].z);
+
+								if (pass == 0)
+								{
+									sums[t * 3] += v.X;
+									sums[t * 3 + 1] += v.Y;
+									sums[t * 3 + 2] += v.Z;
+									_tiles[t].unused = false;
+								}
+								else
+								{
+									const Vector3D & a = _tiles[t].axis;
+									float c = (a.X * v.X + a.Y * v.Y + a.Z * v.Z) / std::sqrt(v.X * v.X + v.Y * v.Y + v.Z * v.Z);
+
+									if (c < minCos[t])
+										minCos[t] = c;
+								}
+							}
+						}
+					}
+				}
+
+				if (pass == 0)
+				{
+					for (int t = 0; t < count; ++t)
+					{
+						float length = std::sqrt(sums[t * 3] * sums[t * 3] + sums[t * 3 + 1] * sums[t * 3 + 1] + sums[t * 3 + 2] * sums[t * 3 + 2]);
+
+						if (length > 0.000001f)
+						{
+							_tiles[t].axis = Vector3D(sums[t * 3] / length, sums[t * 3 + 1] / length, sums[t * 3 + 2] / length);
+						}
+						else
+						{
+							//no usable axis. Make the cone cover everything.
+							_tiles[t].axis = Vector3D(0.0f, 1.0f, 0.0f);
+							minCos[t] = -1.0f;
+						}
+					}
+				}
+			}
+
+			for (int t = 0; t < count; ++t)
+			{
+				float c = minCos[t];
+				c = (c < -1.0f) ? -1.0f : c;
+				c = (c > 1.0f) ? 1.0f : c;
+
+				_tiles[t].halfAngle = _tiles[t].unused ? 0.0f : std::acos(c);
+			}
+
+			FreeArray(minCos);
+			FreeArray(sums);
+		}
+
+		bool NightSkyTiles::DecodeTile(int index, unsigned char * pixels) const
+		{
+			if (pixels == NULL || index < 0 || index >= GetTileCount())
+				return false;
+
+			BIOSKY_TRACE_SCOPE("Decode Night Sky Tile");
+
+			const Tile & tile = _tiles[index];
+
+			const unsigned char * in = tile.encoded;
+			const unsigned char * end = in + tile.encodedSize;
+			unsigned char * out = pixels;
+			unsigned char * outEnd = pixels + tile.width * tile.height * 4;
+
+			while (in < end)
+			{
+				int control = *in++;
+
+				if (control < 128)
+				{
+					int run = control + 1;
+
+					if (out + run * 4 > outEnd)
+						return false;
+
+					for (int i = 0; i < run; ++i)
+					{
+						memcpy(out, in, 4);
+						out += 4;
+					}
+
+					in += 4;
+				}
+				else
+				{
+					int literal = control - 127;
+
+					if (out + literal * 4 > outEnd)
+						return false;
+
+					memcpy(out, in, literal * 4);
+					out += literal * 4;
+					in += literal * 4;
+				}
+			}
+
+			return out == outEnd;
+		}
+
+		int NightSkyTiles::FindVisibleTiles(float northStarZenith, float starRotation, float horizonMargin, bool * visible) const
+		{
+			if (visible == NULL)
+				return 0;
+
+			float cosZ = std::cos(northStarZenith);
+			float sinZ = std::sin(northStarZenith);
+			float cosR = std::cos(starRotation);
+			float sinR = std::sin(starRotation);
+
+			int count = GetTileCount();
+			int numVisible = 0;
+
+			for (int i = 0; i < count; ++i)
+			{
+				const Tile & tile = _tiles[i];
+
+				if (tile.unused)
+				{
+					visible[i] = false;
+					continue;
+				}
+
+				//rotate about Y then X. Only the height is needed.
+				float z = -tile.axis.X * sinR + tile.axis.Z * cosR;
+				float up = tile.axis.Y * cosZ - z * sinZ;
+
+				//the cone reaches above the horizon when its axis is less
+				//than 90 degrees + the half angle from straight up.
+				float reach = tile.halfAngle + horizonMargin;
+				if (reach > MATH::PId2f)
+					reach = MATH::PId2f;
+
+				visible[i] = up > -std::sin(reach);
+
+				if (visible[i])
+					numVisible++;
+			}
+
+			return numVisible;
+		}
+
+		NightSkyTileStreamer::NightSkyTileStreamer(std::shared_ptr<const NightSkyTiles> tiles, INightSkyTileSink * sink, float evictionDelay, float horizonMargin) :
+			_tiles(tiles),
+			_tileCount(0),
+			_error(OK),
+			_sink(sink),
+			_evictionDelay(evictionDelay),
+			_horizonMargin(horizonMargin),
+			_visible(NULL),
+			_resident(NULL),
+			_hiddenTime(NULL),
+			_scratch(NULL),
+			_residentCount(0)
+		{
+			if (!_tiles)
+			{
+				_error = ERROR_CREATING_OBJECT;
+				return;
+			}
+
+			int count = _tileCount = _tiles->GetTileCount();
+
+			_visible = AllocateArray<bool>(count);
+			_resident = AllocateArray<bool>(count);
+			_hiddenTime = AllocateArray<float>(count);
+			_scratch = AllocateArray<unsigned char>(_tiles->GetTileSize() * _tiles->GetTileSize() * 4);
+
+			for (int i = 0; i < count; ++i)
+			{
+				_visible[i] = false;
+				_resident[i] = false;
+				_hiddenTime[i] = 0.0f;
+			}
+		}
+
+		NightSkyTileStreamer::~NightSkyTileStreamer()
+		{
+			FreeArray(_scratch);
+			FreeArray(_hiddenTime);
+			FreeArray(_resident);
+			FreeArray(_visible);
+
+			_sink = NULL;
+		}
+
+		int NightSkyTileStreamer::Update(float northStarZenith, float starRotation, float elapsedSeconds, int maxUploads)
+		{
+			int count = _tileCount;
+			int uploads = 0;
+
+			if (count == 0)
+				return 0;
+
+			_tiles->FindVisibleTiles(northStarZenith, starRotation, _horizonMargin, _visible);
+
+			for (int i = 0; i < count; ++i)
+			{
+				if (_visible[i])
+				{
+					_hiddenTime[i] = 0.0f;
+
+					if (!_resident[i] && (maxUploads <= 0 || uploads < maxUploads))
+					{
+						if (_tiles->DecodeTile(i, _scratch))
+						{
+							if (_sink)
+								_sink->UploadTile(i, _tiles->GetTile(i), _scratch);
+
+							_resident[i] = true;
+							_residentCount++;
+							uploads++;
+						}
+					}
+				}
+				else
+				{
+					_hiddenTime[i] += elapsedSeconds;
+
+					if (_resident[i] && _hiddenTime[i] >= _evictionDelay)
+					{
+						if (_sink)
+							_sink->EvictTile(i, _tiles->GetTile(i));
+
+						_resident[i] = false;
+						_residentCount--;
+					}
+				}
+			}
+
+			return uploads;
+		}
+
+		void NightSkyTileStreamer::EvictAll()
+		{
+			int count = _tileCount;
+
+			for (int i = 0; i < count; ++i)
+			{
+				if (_resident[i])
+				{
+					if (_sink)
+						_sink->EvictTile(i, _tiles->GetTile(i));
+
+					_resident[i] = false;
+				}
+			}
+
+			_residentCount = 0;
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			class CountingTileSink : public INightSkyTileSink
+			{
+			public:
+				const unsigned char * image;
+				int imageWidth;
+				int uploads;
+				int evictions;
+				bool pixelsMatch;
+
+				CountingTileSink(const unsigned char * img, int w) : image(img), imageWidth(w), uploads(0), evictions(0), pixelsMatch(true)
+				{}
+
+				virtual void UploadTile(int, const NightSkyTiles::Tile & tile, const unsigned char * pixels)
+				{
+					uploads++;
+
+					for (int y = 0; y < tile.height; ++y)
+					{
+						if (memcmp(pixels + y * tile.width * 4, image + ((tile.y + y) * imageWidth + tile.x) * 4, tile.width * 4) != 0)
+							pixelsMatch = false;
+					}
+				}
+
+				virtual void EvictTile(int, const NightSkyTiles::Tile &)
+				{
+					evictions++;
+				}
+			};
+		}
+
+		bool NightSkyTiles::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Night Sky Tile Tests");
+
+			const int size = 1024;
+			unsigned char * image = new unsigned char[size * size * 4];
+
+			//black sky with a few stars
+			memset(image, 0, size * size * 4);
+			for (int i = 0; i < size * size; i += 97)
+			{
+				image[i * 4] = (unsigned char)(i & 0xFF);
+				image[i * 4 + 1] = (unsigned char)((i >> 8) & 0xFF);
+				image[i * 4 + 2] = 200;
+				image[i * 4 + 3] = 255;
+			}
+
+			NightSkyTiles tiles(image, size, size, 128);
+
+			test->UnitTest(tiles.GetTilesX() == 8 && tiles.GetTilesY() == 8 && tiles.GetTileCount() == 64, "Tile count");
+			test->UnitTest(tiles.GetEncodedSize() < (std::size_t)(size * size), "Tiles are encoded smaller");
+
+			unsigned char * pixels = new unsigned char[256 * 256 * 4];
+			bool decoded = true;
+			for (int i = 0; i < tiles.GetTileCount(); ++i)
+			{
+				const Tile & tile = tiles.GetTile(i);
+
+				if (!tiles.DecodeTile(i, pixels))
+					decoded = false;
+
+				for (int y = 0; y < tile.height; ++y)
+				{
+					if (memcmp(pixels + y * tile.width * 4, image + ((tile.y + y) * size + tile.x) * 4, tile.width * 4) != 0)
+						decoded = false;
+				}
+			}
+			test->UnitTest(decoded, "Tiles decode losslessly");
+			test->UnitTest(!tiles.DecodeTile(64, pixels), "Decode out of range");
+
+			//uneven edge tiles
+			NightSkyTiles uneven(image, 1000, 700, 256);
+			test->UnitTest(uneven.GetTilesX() == 4 && uneven.GetTilesY() == 3, "Uneven tile count");
+			test->UnitTest(uneven.GetTile(3).width == 232 && uneven.GetTile(11).height == 188, "Uneven edge tiles");
+			test->UnitTest(uneven.DecodeTile(11, pixels), "Uneven edge tile decodes");
+
+			//the corners of the texture are not used by the star dome
+			test->UnitTest(tiles.GetTile(7).unused && tiles.GetTile(56).unused, "Unused corner tiles");
+			test->UnitTest(!tiles.GetTile(9).unused && !tiles.GetTile(54).unused, "Used tiles");
+
+			//tile 9 is near the north pole, tile 54 near the south pole
+			bool visible[64];
+			int numVisible = tiles.FindVisibleTiles(0.0f, 0.0f, 0.0f, visible);
+			test->UnitTest(visible[9] && !visible[54], "North pole overhead");
+			test->UnitTest(numVisible > 0 && numVisible < 64, "North pole overhead count");
+
+			tiles.FindVisibleTiles(MATH::PIf, 1.0f, 0.0f, visible);
+			test->UnitTest(!visible[9] && visible[54], "South pole overhead");
+
+			//streaming
+			std::shared_ptr<const NightSkyTiles> shared = std::make_shared<NightSkyTiles>(image, size, size, 128);
+			CountingTileSink sink(image, size);
+			NightSkyTileStreamer streamer(shared, &sink, 60.0f, 0.0f);
+
+			int uploaded = streamer.Update(0.0f, 0.0f, 0.0f, 5);
+			test->UnitTest(uploaded == 5 && streamer.GetResidentCount() == 5, "Upload limit");
+
+			uploaded += streamer.Update(0.0f, 0.0f, 0.0f);
+			test->UnitTest(uploaded == numVisible && sink.uploads == numVisible, "Visible tiles uploaded");
+			test->UnitTest(streamer.IsTileResident(9) && !streamer.IsTileResident(54), "North tiles resident");
+			test->UnitTest(sink.pixelsMatch, "Uploaded pixels");
+
+			streamer.Update(MATH::PIf, 0.0f, 1.0f);
+			test->UnitTest(streamer.IsTileResident(9) && streamer.IsTileResident(54), "Hidden tile kept until the delay");
+			test->UnitTest(sink.evictions == 0, "No evictions before the delay");
+
+			streamer.Update(MATH::PIf, 0.0f, 60.0f);
+			test->UnitTest(!streamer.IsTileResident(9) && streamer.IsTileResident(54), "Hidden tile evicted");
+			test->UnitTest(sink.evictions > 0 && streamer.GetResidentCount() == sink.uploads - sink.evictions, "Resident count");
+
+			streamer.EvictAll();
+			test->UnitTest(streamer.GetResidentCount() == 0 && sink.evictions == sink.uploads, "Evict all");
+			test->UnitTest(streamer.GetErrorCode() == OK, "Streamer error code");
+
+			NightSkyTileStreamer empty(std::shared_ptr<const NightSkyTiles>(), &sink);
+			test->UnitTest(empty.GetErrorCode() == ERROR_CREATING_OBJECT, "Streamer without tiles error");
+			test->UnitTest(empty.Update(0.0f, 0.0f, 1.0f) == 0 && !empty.IsTileResident(0) && empty.GetResidentCount() == 0, "Streamer without tiles is empty");
+			empty.EvictAll();
+
+			delete[] pixels;
+			delete[] image;
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
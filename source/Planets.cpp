@@ -0,0 +1,647 @@
+/**
+* @file Planets.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the planet functions.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "Planets.hpp"
+#include "BIOSkyFunctions.hpp"
+#include "MathUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if BIOSKY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**
+			* The number of bodies worked out together: the planets, then the
+			* sun, then padding to a multiple of 4.
+			*/
+			const int _NumLanes = 8;
+
+			/**The lane that holds the sun.*/
+			const int _SunLane = NumPlanets;
+
+			/**The number of Newton steps taken on Kepler's equation.*/
+			const int _KeplerSteps = 3;
+
+			/**
+			* The orbital elements from Paul Schlyter, for the planets and
+			* then the sun, each as the value on 2000 Jan 0.0 and the change
+			* per day: longitude of the ascending node, inclination, argument
+			* of perihelion (degrees), mean distance (au), eccentricity and
+			* mean anomaly (degrees).
+			*/
+			const double _OrbitalElements[NumPlanets + 1][12] = {
+				{  48.3313, 3.24587E-5, 7.0047,  5.00E-8,  29.1241, 1.01444E-5, 0.387098, 0.0, 0.205635,  5.59E-10, 168.6562, 4.0923344368 }, //Mercury
+				{  76.6799, 2.46590E-5, 3.3946,  2.75E-8,  54.8910, 1.38374E-5, 0.723330, 0.0, 0.006773, -1.302E-9,   48.0052, 1.6021302244 }, //Venus
+				{  49.5574, 2.11081E-5, 1.8497, -1.78E-8, 286.5016, 2.92961E-5, 1.523688, 0.0, 0.093405,  2.516E-9,   18.6021, 0.5240207766 }, //Mars
+				{ 100.4542, 2.76854E-5, 1.3030, -1.557E-7, 273.8777, 1.64505E-5, 5.20256, 0.0, 0.048498,  4.469E-9,   19.8950, 0.0830853001 }, //Jupiter
+				{ 113.6634, 2.38980E-5, 2.4886, -1.081E-7, 339.3939, 2.97661E-5, 9.55475, 0.0, 0.055546, -9.499E-9,  316.9670, 0.0334442282 }, //Saturn
+				{   0.0,    0.0,        0.0,     0.0,     282.9404, 4.70935E-5, 1.000000, 0.0, 0.016709, -1.151E-9,  356.0470, 0.9856002585 }  //Sun
+			};
+
+			/**
+			* The magnitude of each planet when it is 1 au from both the sun
+			* and the Earth and fully lit.
+			*/
+			const float _PlanetMagnitudes[NumPlanets] = { -0.36f, -4.34f, -1.51f, -9.25f, -9.0f };
+
+			/**
+			* The sine and cosine of 4 angles in radians. This is the Cephes
+			* single precision method, good to about 1e-7 for angles that are
+			* not huge.
+			*/
+#if BIOSKY_USE_SSE2
+			void _SinCos(__m128 x, __m128 * s, __m128 * c)
+			{
+				const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000));
+
+				__m128 signSin = _mm_and_ps(x, signMask);
+				x = _mm_andnot_ps(signMask, x);
+
+				//which octant, rounded to an even one
+				__m128i j = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+				j = _mm_and_si128(_mm_add_epi32(j, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+				__m128 y = _mm_cvtepi32_ps(j);
+
+				__m128 swapSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(j, _mm_set1_epi32(4)), 29));
+				__m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(j, _mm_set1_epi32(2)), _mm_setzero_si128()));
+				__m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(j, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+				signSin = _mm_xor_ps(signSin, swapSin);
+
+				//x - y * PI/4 in three parts
+				x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-0.78515625f)));
+				x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-2.4187564849853515625e-4f)));
+				x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(-3.77489497744594108e-8f)));
+
+				__m128 z = _mm_mul_ps(x, x);
+
+				__m128 cosPoly = _mm_set1_ps(2.443315711809948E-005f);
+				cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(-1.388731625493765E-003f));
+				cosPoly = _mm_add_ps(_mm_mul_ps(cosPoly, z), _mm_set1_ps(4.166664568298827E-002f));
+				cosPoly = _mm_mul_ps(_mm_mul_ps(cosPoly, z), z);
+				cosPoly = _mm_sub_ps(cosPoly, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+				cosPoly = _mm_add_ps(cosPoly, _mm_set1_ps(1.0f));
+
+				__m128 sinPoly = _mm_set1_ps(-1.9515295891E-4f);
+				sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(8.3321608736E-3f));
+				sinPoly = _mm_add_ps(_mm_mul_ps(sinPoly, z), _mm_set1_ps(-1.6666654611E-1f));
+				sinPoly = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sinPoly, z), x), x);
+
+				//pick the polynomial for each octant
+				__m128 sinValue = _mm_or_ps(_mm_and_ps(polyMask, sinPoly), _mm_andnot_ps(polyMask, cosPoly));
+				__m128 cosValue = _mm_or_ps(_mm_and_ps(polyMask, cosPoly), _mm_andnot_ps(polyMask, sinPoly));
+
+				*s = _mm_xor_ps(sinValue, signSin);
+				*c = _mm_xor_ps(cosValue, signCos);
+			}
+#endif
+
+			/**
+			* The sine and cosine of every lane.
+			*/
+			void _SinCos(const float * x, float * s, float * c)
+			{
+#if BIOSKY_USE_SSE2
+				for (int i = 0; i < _NumLanes; i += 4)
+				{
+					__m128 sinValue, cosValue;
+					_SinCos(_mm_loadu_ps(x + i), &sinValue, &cosValue);
+					_mm_storeu_ps(s + i, sinValue);
+					_mm_storeu_ps(c + i, cosValue);
+				}
+#else
+				for (int i = 0; i < _NumLanes; i++)
+				{
+					s[i] = std::sin(x[i]);
+					c[i] = std::cos(x[i]);
+				}
+#endif
+			}
+
+			/**
+			* Add the perturbations of Jupiter and Saturn on each other to
+			* their heliocentric positions.
+			*
+			* @param Mj The mean anomaly of Jupiter in degrees.
+			*
+			* @param Ms The mean anomaly of Saturn in degrees.
+			*/
+			void _Perturb(double Mj, double Ms, float * xh, float * yh, float * zh)
+			{
+				const double toRadians = MATH::DegreesToRadians;
+
+				double lonCorrection[NumPlanets] = { 0.0 };
+				double latCorrection[NumPlanets] = { 0.0 };
+
+				lonCorrection[PLANET_JUPITER] =
+					-0.332 * std::sin((2 * Mj - 5 * Ms - 67.6) * toRadians)
+					- 0.056 * std::sin((2 * Mj - 2 * Ms + 21) * toRadians)
+					+ 0.042 * std::sin((3 * Mj - 5 * Ms + 21) * toRadians)
+					- 0.036 * std::sin((Mj - 2 * Ms) * toRadians)
+					+ 0.022 * std::cos((Mj - Ms) * toRadians)
+					+ 0.023 * std::sin((2 * Mj - 3 * Ms + 52) * toRadians)
+					- 0.016 * std::sin((Mj - 5 * Ms - 69) * toRadians);
+
+				lonCorrection[PLANET_SATURN] =
+					0.812 * std::sin((2 * Mj - 5 * Ms - 67.6) * toRadians)
+					- 0.229 * std::cos((2 * Mj - 4 * Ms - 2) * toRadians)
+					+ 0.119 * std::sin((Mj - 2 * Ms - 3) * toRadians)
+					+ 0.046 * std::sin((2 * Mj - 6 * Ms - 69) * toRadians)
+					+ 0.014 * std::sin((Mj - 3 * Ms + 32) * toRadians);
+
+				latCorrection[PLANET_SATURN] =
+					-0.020 * std::cos((2 * Mj - 4 * Ms - 2) * toRadians)
+					+ 0.018 * std::sin((2 * Mj - 6 * Ms - 49) * toRadians);
+
+				for (int i = PLANET_JUPITER; i <= PLANET_SATURN; i++)
+				{
+					double flat = std::sqrt((double)xh[i] * xh[i] + (double)yh[i] * yh[i]);
+					double r = std::sqrt(flat * flat + (double)zh[i] * zh[i]);
+					double lon = std::atan2((double)yh[i], (double)xh[i]) + lonCorrection[i] * toRadians;
+					double lat = std::atan2((double)zh[i], flat) + latCorrection[i] * toRadians;
+
+					xh[i] = (float)(r * std::cos(lon) * std::cos(lat));
+					yh[i] = (float)(r * std::sin(lon) * std::cos(lat));
+					zh[i] = (float)(r * std::sin(lat));
+				}
+			}
+
+			/**
+			* The brightness of the rings of Saturn.
+			*
+			* @param d The days since 2000 Jan 0.0.
+			*
+			* @param xg, yg, zg The geocentric ecliptic position of Saturn.
+			*/
+			float _SaturnRingMagnitude(double d, float xg, float yg, float zg)
+			{
+				const double toRadians = MATH::DegreesToRadians;
+
+				double lon = std::atan2((double)yg, (double)xg);
+				double lat = std::atan2((double)zg, std::sqrt((double)xg * xg + (double)yg * yg));
+
+				//the tilt and node of the rings
+				double ir = 28.06 * toRadians;
+				double Nr = (169.51 + 3.82E-5 * d) * toRadians;
+
+				double sinB = std::sin(lat) * std::cos(ir) - std::cos(lat) * std::sin(ir) * std::sin(lon - Nr);
+
+				return (float)(-2.6 * std::fabs(sinB) + 1.2 * sinB * sinB);
+			}
+
+			/**
+			* CalculatePlanetPositions from the days since 2000 Jan 0.0 and
+			* the universal time of day in hours.
+			*/
+			void _CalculatePlanetPositions(double d, double UT, float latitude, float longitude, PlanetPosition * planets, SkyPosition * sunPosition)
+			{
+				float N[_NumLanes], incline[_NumLanes], w[_NumLanes], a[_NumLanes], e[_NumLanes], M[_NumLanes];
+
+				//the elements are reduced in double precision so the float
+				//lanes only see angles in [0, 2PI)
+				for (int i = 0; i < _NumLanes; i++)
+				{
+					const double * elements = _OrbitalElements[(i < _SunLane) ? i : _SunLane];
+
+					N[i] = (float)(MATH::RevolutionReductionDegrees(elements[0] + elements[1] * d) * MATH::DegreesToRadians);
+					incline[i] = (float)((elements[2] + elements[3] * d) * MATH::DegreesToRadians);
+					w[i] = (float)(MATH::RevolutionReductionDegrees(elements[4] + elements[5] * d) * MATH::DegreesToRadians);
+					a[i] = (float)(elements[6] + elements[7] * d);
+					e[i] = (float)(elements[8] + elements[9] * d);
+					M[i] = (float)(MATH::RevolutionReductionDegrees(elements[10] + elements[11] * d) * MATH::DegreesToRadians);
+				}
+
+				float sinN[_NumLanes], cosN[_NumLanes], sinI[_NumLanes], cosI[_NumLanes], sinW[_NumLanes], cosW[_NumLanes];
+				float sinE[_NumLanes], cosE[_NumLanes], E[_NumLanes];
+
+				_SinCos(N, sinN, cosN);
+				_SinCos(incline, sinI, cosI);
+				_SinCos(w, sinW, cosW);
+				_SinCos(M, sinE, cosE);
+
+				//Kepler's equation, M = E - e * sin(E), by Newton's method from
+				//a second order first guess
+				for (int i = 0; i < _NumLanes; i++)
+					E[i] = M[i] + e[i] * sinE[i] * (1.0f + e[i] * cosE[i]);
+
+				for (int step = 0; step < _KeplerSteps; step++)
+				{
+					_SinCos(E, sinE, cosE);
+
+					for (int i = 0; i < _NumLanes; i++)
+						E[i] -= (E[i] - e[i] * sinE[i] - M[i]) / (1.0f - e[i] * cosE[i]);
+				}
+
+				_SinCos(E, sinE, cosE);
+
+				//heliocentric ecliptic position. For the sun lane this is the
+				//position of the sun from the Earth.
+				float xh[_NumLanes], yh[_NumLanes], zh[_NumLanes], r[_NumLanes];
+
+				for (int i = 0; i < _NumLanes; i++)
+				{
+					float xv = a[i] * (cosE[i] - e[i]);
+					float yv = a[i] * std::sqrt(1.0f - e[i] * e[i]) * sinE[i];
+
+					r[i] = std::sqrt(xv * xv + yv * yv);
+
+					//r * cos(v + w) and r * sin(v + w)
+					float xw = xv * cosW[i] - yv * sinW[i];
+					float yw = yv * cosW[i] + xv * sinW[i];
+
+					xh[i] = cosN[i] * xw - sinN[i] * yw * cosI[i];
+					yh[i] = sinN[i] * xw + cosN[i] * yw * cosI[i];
+					zh[i] = yw * sinI[i];
+				}
+
+				double Mj = _OrbitalElements[PLANET_JUPITER][10] + _OrbitalElements[PLANET_JUPITER][11] * d;
+				double Ms = _OrbitalElements[PLANET_SATURN][10] + _OrbitalElements[PLANET_SATURN][11] * d;
+				_Perturb(MATH::RevolutionReductionDegrees(Mj), MATH::RevolutionReductionDegrees(Ms), xh, yh, zh);
+
+				//everything below is shared by all the lanes
+				const float xs = xh[_SunLane];
+				const float ys = yh[_SunLane];
+				const float sunDistance = r[_SunLane];
+
+				float obliquity = (float)((23.4393 - 3.563E-7 * d) * MATH::DegreesToRadians);
+				float sinObliquity = std::sin(obliquity);
+				float cosObliquity = std::cos(obliquity);
+
+				//local sidereal time from the sun's mean longitude
+				double sunLongitude = _OrbitalElements[_SunLane][4] + _OrbitalElements[_SunLane][5] * d +
+					_OrbitalElements[_SunLane][10] + _OrbitalElements[_SunLane][11] * d;
+				float siderealTime = (float)(MATH::RevolutionReductionDegrees(sunLongitude + 180.0 + UT * 15.0 + longitude * MATH::RadiansToDegrees) * MATH::DegreesToRadians);
+				float sinSidereal = std::sin(siderealTime);
+				float cosSidereal = std::cos(siderealTime);
+
+				float sinLatitude = std::sin(latitude);
+				float cosLatitude = std::cos(latitude);
+
+				float xg[_NumLanes], yg[_NumLanes], xhor[_NumLanes], yhor[_NumLanes], zhor[_NumLanes], distance[_NumLanes];
+
+				for (int i = 0; i < _NumLanes; i++)
+				{
+					//geocentric ecliptic. The sun lane is already geocentric.
+					float toEarth = (i < _SunLane) ? 1.0f : 0.0f;
+					xg[i] = xh[i] + xs * toEarth;
+					yg[i] = yh[i] + ys * toEarth;
+
+					//equatorial
+					float xe = xg[i];
+					float ye = yg[i] * cosObliquity - zh[i] * sinObliquity;
+					float ze = yg[i] * sinObliquity + zh[i] * cosObliquity;
+
+					distance[i] = std::sqrt(xe * xe + ye * ye + ze * ze);
+
+					//hour angle frame, then the horizon
+					float x = (cosSidereal * xe + sinSidereal * ye) / distance[i];
+					float y = (sinSidereal * xe - cosSidereal * ye) / distance[i];
+					float z = ze / distance[i];
+
+					xhor[i] = x * sinLatitude - z * cosLatitude;
+					yhor[i] = y;
+					zhor[i] = x * cosLatitude + z * sinLatitude;
+				}
+
+				for (int i = 0; i < NumPlanets; i++)
+				{
+					float zenith = std::acos(std::max(-1.0f, std::min(1.0f, zhor[i])));
+					planets[i].position = SkyPosition(std::atan2(yhor[i], xhor[i]) + MATH::PIf, zenith);
+					planets[i].distance = distance[i];
+
+					//the phase angle in degrees
+					float cosPhase = (r[i] * r[i] + distance[i] * distance[i] - sunDistance * sunDistance) / (2.0f * r[i] * distance[i]);
+					float FV = std::acos(std::max(-1.0f, std::min(1.0f, cosPhase))) * MATH::RadiansToDegreesf;
+
+					float magnitude = _PlanetMagnitudes[i] + 5.0f * std::log10(r[i] * distance[i]);
+
+					switch (i)
+					{
+					case PLANET_MERCURY:
+						magnitude += 0.027f * FV + 2.2E-13f * std::pow(FV, 6.0f);
+						break;
+					case PLANET_VENUS:
+						magnitude += 0.013f * FV + 4.2E-7f * FV * FV * FV;
+						break;
+					case PLANET_MARS:
+						magnitude += 0.016f * FV;
+						break;
+					case PLANET_JUPITER:
+						magnitude += 0.014f * FV;
+						break;
+					default:
+						magnitude += 0.044f * FV + _SaturnRingMagnitude(d, xg[i], yg[i], zh[i]);
+						break;
+					}
+
+					planets[i].magnitude = magnitude;
+				}
+
+				if (sunPosition != NULL)
+				{
+					float zenith = std::acos(std::max(-1.0f, std::min(1.0f, zhor[_SunLane])));
+					*sunPosition = SkyPosition(std::atan2(yhor[_SunLane], xhor[_SunLane]) + MATH::PIf, zenith);
+				}
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		bool CalculatePlanetPositions(float standardTime, float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude, PlanetPosition * planets, SkyPosition * sunPosition)
+		{
+			if (planets == NULL)
+				return false;
+
+			double UT = standardTime - UTCoffset;
+
+			_CalculatePlanetPositions(DaysSinceJan02000(month, day, year) + UT / 24.0, UT, latitude, longitude, planets, sunPosition);
+			return true;
+		}
+
+		bool CalculatePlanetPositions(const Timestamp & time, float latitude, float longitude, PlanetPosition * planets, SkyPosition * sunPosition)
+		{
+			if (planets == NULL)
+				return false;
+
+			_CalculatePlanetPositions(time.GetDaysSinceJan02000(), time.GetUniversalTimeHours(), latitude, longitude, planets, sunPosition);
+			return true;
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* Schlyter's method for one planet written out the long way in
+			* double precision, to check the combined pass against.
+			*/
+			PlanetPosition _ReferencePlanet(double d, int planet, double latitude, double longitude, double UT)
+			{
+				const double rad = MATH::DegreesToRadians;
+
+				//the sun
+				const double * sun = _OrbitalElements[_SunLane];
+				double ws = sun[4] + sun[5] * d;
+				double es = sun[8] + sun[9] * d;
+				double Msun = MATH::RevolutionReductionDegrees(sun[10] + sun[11] * d);
+				double Es = Msun + es * MATH::RadiansToDegrees * std::sin(Msun * rad) * (1.0 + es * std::cos(Msun * rad));
+				double xvs = std::cos(Es * rad) - es;
+				double yvs = std::sqrt(1.0 - es * es) * std::sin(Es * rad);
+				double rs = std::sqrt(xvs * xvs + yvs * yvs);
+				double lonsun = std::atan2(yvs, xvs) / rad + ws;
+				double xs = rs * std::cos(lonsun * rad);
+				double ys = rs * std::sin(lonsun * rad);
+
+				//the planet
+				const double * el = _OrbitalElements[planet];
+				double N = el[0] + el[1] * d;
+				double i = el[2] + el[3] * d;
+				double w = el[4] + el[5] * d;
+				double a = el[6];
+				double e = el[8] + el[9] * d;
+				double M = MATH::RevolutionReductionDegrees(el[10] + el[11] * d);
+
+				double E = M + e * MATH::RadiansToDegrees * std::sin(M * rad) * (1.0 + e * std::cos(M * rad));
+				for (int step = 0; step < 50; step++)
+				{
+					double next = E - (E - e * MATH::RadiansToDegrees * std::sin(E * rad) - M) / (1.0 - e * std::cos(E * rad));
+					if (std::fabs(next - E) < 1e-9)
+						break;
+					E = next;
+				}
+
+				double xv = a * (std::cos(E * rad) - e);
+				double yv = a * std::sqrt(1.0 - e * e) * std::sin(E * rad);
+				double v = std::atan2(yv, xv) / rad;
+				double r = std::sqrt(xv * xv + yv * yv);
+
+				double xh = r * (std::cos(N * rad) * std::cos((v + w) * rad) - std::sin(N * rad) * std::sin((v + w) * rad) * std::cos(i * rad));
+				double yh = r * (std::sin(N * rad) * std::cos((v + w) * rad) + std::cos(N * rad) * std::sin((v + w) * rad) * std::cos(i * rad));
+				double zh = r * (std::sin((v + w) * rad) * std::sin(i * rad));
+
+				double lon = std::atan2(yh, xh) / rad;
+				double lat = std::atan2(zh, std::sqrt(xh * xh + yh * yh)) / rad;
+
+				double Mj = _OrbitalElements[PLANET_JUPITER][10] + _OrbitalElements[PLANET_JUPITER][11] * d;
+				double Ms = _OrbitalElements[PLANET_SATURN][10] + _OrbitalElements[PLANET_SATURN][11] * d;
+
+				if (planet == PLANET_JUPITER)
+				{
+					lon += -0.332 * std::sin((2 * Mj - 5 * Ms - 67.6) * rad) - 0.056 * std::sin((2 * Mj - 2 * Ms + 21) * rad)
+						+ 0.042 * std::sin((3 * Mj - 5 * Ms + 21) * rad) - 0.036 * std::sin((Mj - 2 * Ms) * rad)
+						+ 0.022 * std::cos((Mj - Ms) * rad) + 0.023 * std::sin((2 * Mj - 3 * Ms + 52) * rad)
+						- 0.016 * std::sin((Mj - 5 * Ms - 69) * rad);
+				}
+				else if (planet == PLANET_SATURN)
+				{
+					lon += 0.812 * std::sin((2 * Mj - 5 * Ms - 67.6) * rad) - 0.229 * std::cos((2 * Mj - 4 * Ms - 2) * rad)
+						+ 0.119 * std::sin((Mj - 2 * Ms - 3) * rad) + 0.046 * std::sin((2 * Mj - 6 * Ms - 69) * rad)
+						+ 0.014 * std::sin((Mj - 3 * Ms + 32) * rad);
+					lat += -0.020 * std::cos((2 * Mj - 4 * Ms - 2) * rad) + 0.018 * std::sin((2 * Mj - 6 * Ms - 49) * rad);
+				}
+
+				xh = r * std::cos(lon * rad) * std::cos(lat * rad);
+				yh = r * std::sin(lon * rad) * std::cos(lat * rad);
+				zh = r * std::sin(lat * rad);
+
+				double xg = xh + xs;
+				double yg = yh + ys;
+				double zg = zh;
+
+				double ecl = 23.4393 - 3.563E-7 * d;
+				double xe = xg;
+				double ye = yg * std::cos(ecl * rad) - zg * std::sin(ecl * rad);
+				double ze = yg * std::sin(ecl * rad) + zg * std::cos(ecl * rad);
+
+				double RA = std::atan2(ye, xe) / rad;
+				double Dec = std::atan2(ze, std::sqrt(xe * xe + ye * ye)) / rad;
+				double R = std::sqrt(xe * xe + ye * ye + ze * ze);
+
+				double L = ws + Msun;
+				double HA = L + 180.0 + UT * 15.0 + longitude / rad - RA;
+
+				double x = std::cos(HA * rad) * std::cos(Dec * rad);
+				double y = std::sin(HA * rad) * std::cos(Dec * rad);
+				double z = std::sin(Dec * rad);
+
+				double xhor = x * std::sin(latitude) - z * std::cos(latitude);
+				double yhor = y;
+				double zhor = x * std::cos(latitude) + z * std::sin(latitude);
+
+				double FV = std::acos((r * r + R * R - rs * rs) / (2.0 * r * R)) / rad;
+				double magnitude = _PlanetMagnitudes[planet] + 5.0 * std::log10(r * R);
+
+				switch (planet)
+				{
+				case PLANET_MERCURY: magnitude += 0.027 * FV + 2.2E-13 * std::pow(FV, 6.0); break;
+				case PLANET_VENUS: magnitude += 0.013 * FV + 4.2E-7 * FV * FV * FV; break;
+				case PLANET_MARS: magnitude += 0.016 * FV; break;
+				case PLANET_JUPITER: magnitude += 0.014 * FV; break;
+				default:
+					{
+						double los = std::atan2(zg, std::sqrt(xg * xg + yg * yg));
+						double lons = std::atan2(yg, xg);
+						double ir = 28.06 * rad;
+						double Nr = (169.51 + 3.82E-5 * d) * rad;
+						double B = std::asin(std::sin(los) * std::cos(ir) - std::cos(los) * std::sin(ir) * std::sin(lons - Nr));
+						magnitude += 0.044 * FV - 2.6 * std::sin(std::fabs(B)) + 1.2 * std::sin(B) * std::sin(B);
+					}
+					break;
+				}
+
+				PlanetPosition rtn;
+				rtn.position = SkyPosition((float)(std::atan2(yhor, xhor) + MATH::PI), (float)(MATH::PId2 - std::asin(zhor)));
+				rtn.magnitude = (float)magnitude;
+				rtn.distance = (float)R;
+
+				return rtn;
+			}
+
+			/**
+			* The angle between two places in the sky in degrees.
+			*/
+			float _Separation(const SkyPosition & first, const SkyPosition & second)
+			{
+				//in double so acos near 1 can resolve small angles
+				double dot = std::sin((double)first.Zenith) * std::sin((double)second.Zenith) * std::cos((double)first.Azimuth - second.Azimuth) +
+					std::cos((double)first.Zenith) * std::cos((double)second.Zenith);
+
+				return (float)(std::acos(std::max(-1.0, std::min(1.0, dot))) * MATH::RadiansToDegrees);
+			}
+		}
+
+		bool PlanetTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Planet Tests");
+
+			const float latitude = 41.0f * MATH::DegreesToRadiansf;
+			const float longitude = -112.0f * MATH::DegreesToRadiansf;
+
+			PlanetPosition planets[NumPlanets];
+			SkyPosition sun;
+
+			test->UnitTest(!CalculatePlanetPositions(12.0f, 0.0f, JANUARY, 1, 2015, latitude, longitude, NULL), "NULL planets");
+
+			//the combined pass against the long way for many times
+			float worstAngle = 0.0f;
+			float worstMagnitude = 0.0f;
+			float worstSun = 0.0f;
+
+			const DATE_MONTH months[] = { JANUARY, APRIL, JULY, OCTOBER };
+
+			for (unsigned int year = 1990; year <= 2030; year += 4)
+			{
+				for (int m = 0; m < 4; m++)
+				{
+					for (float hour = 0.0f; hour < 24.0f; hour += 5.5f)
+					{
+						CalculatePlanetPositions(hour, -7.0f, months[m], 11, year, latitude, longitude, planets, &sun);
+
+						double d = DaysSinceJan02000(months[m], 11, year) + (hour + 7.0) / 24.0;
+
+						for (int i = 0; i < NumPlanets; i++)
+						{
+							PlanetPosition expected = _ReferencePlanet(d, i, latitude, longitude, hour + 7.0);
+
+							worstAngle = std::max(worstAngle, _Separation(expected.position, planets[i].position));
+							worstMagnitude = std::max(worstMagnitude, std::fabs(expected.magnitude - planets[i].magnitude));
+						}
+
+						worstSun = std::max(worstSun, _Separation(sun, CalculateSunPosition(hour, -7.0f, months[m], 11, year, latitude, longitude)));
+					}
+				}
+			}
+
+test->UnitTest(worstAngle < 0.005f, "Combined pass matches the long way");
+			test->UnitTest(worstMagnitude < 0.01f, "Combined pass magnitudes match the long way");
+			test->UnitTest(worstSun < 0.01f, "Sun lane matches CalculateSunPosition");
+
+			//the sun is never far from Mercury and Venus
+			float mercuryElongation = 0.0f;
+			float venusElongation = 0.0f;
+			bool venusBright = true;
+
+			for (unsigned int day = 1; day <= 28; day += 3)
+			{
+				for (int m = 0; m < 12; m++)
+				{
+					CalculatePlanetPositions(12.0f, 0.0f, (DATE_MONTH)(JANUARY + m), day, 2016, latitude, longitude, planets, &sun);
+
+					mercuryElongation = std::max(mercuryElongation, _Separation(sun, planets[PLANET_MERCURY].position));
+					venusElongation = std::max(venusElongation, _Separation(sun, planets[PLANET_VENUS].position));
+					venusBright = venusBright && planets[PLANET_VENUS].magnitude < -3.0f && planets[PLANET_VENUS].magnitude > -5.0f;
+				}
+			}
+
+			test->UnitTest(mercuryElongation > 17.0f && mercuryElongation < 28.5f, "Mercury elongation");
+			test->UnitTest(venusElongation > 40.0f && venusElongation < 48.0f, "Venus elongation");
+			test->UnitTest(venusBright, "Venus magnitude");
+
+			//the great conjunction of Jupiter and Saturn, 6 arc minutes apart
+			CalculatePlanetPositions(18.0f, 0.0f, DECEMBER, 21, 2020, latitude, longitude, planets);
+			test->UnitTest(_Separation(planets[PLANET_JUPITER].position, planets[PLANET_SATURN].position) < 0.25f, "Jupiter Saturn conjunction 2020");
+
+			//Venus and Jupiter, a third of a degree apart
+			CalculatePlanetPositions(22.0f, 0.0f, JUNE, 30, 2015, latitude, longitude, planets);
+			test->UnitTest(_Separation(planets[PLANET_VENUS].position, planets[PLANET_JUPITER].position) < 0.6f, "Venus Jupiter conjunction 2015");
+
+			//the close opposition of Mars
+			CalculatePlanetPositions(10.0f, 0.0f, AUGUST, 27, 2003, latitude, longitude, planets, &sun);
+			test->UnitTest(std::fabs(planets[PLANET_MARS].distance - 0.373f) < 0.005f, "Mars opposition distance 2003");
+			test->UnitTest(std::fabs(planets[PLANET_MARS].magnitude + 2.9f) < 0.2f, "Mars opposition magnitude 2003");
+			test->UnitTest(_Separation(sun, planets[PLANET_MARS].position) > 170.0f, "Mars opposite the sun 2003");
+
+			//the outer planets
+			test->UnitTest(planets[PLANET_JUPITER].magnitude < -1.5f && planets[PLANET_JUPITER].magnitude > -3.0f, "Jupiter magnitude");
+			test->UnitTest(planets[PLANET_SATURN].magnitude < 1.5f && planets[PLANET_SATURN].magnitude > -0.6f, "Saturn magnitude");
+			test->UnitTest(planets[PLANET_SATURN].distance > 8.0f && planets[PLANET_SATURN].distance < 11.1f, "Saturn distance");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -35,10 +35,13 @@
 
 #include "Sky.hpp"
 #include "IDomeVertecies.hpp"
+#include "BIOSkyFunctions.hpp"
+#include "SkyPerfCounters.hpp"
 
 #include "../source/MoonTexture.c"
 
 #include <algorithm>
+#include <cstring>
 
 #include <iostream>
 #include <fstream>
@@ -47,7 +50,7 @@ namespace BIO
 {
 	namespace SKY
 	{
-		Sky::Sky(IDomeGeometry * skydome) : _skydome(skydome), _moonPos(), _sunPos(), _error(OK), _lightInterpolation()
+		Sky::Sky(IDomeGeometry * skydome) : _skydome(skydome), _moonPos(), _sunPos(), _turbidity(DefaultTurbidity), _error(OK), _lightInterpolation()
 		{
 			if (_skydome == NULL)
 				_error = BIOSKY_FAILED_TO_INIT__GEOMETRY_NULL;
@@ -95,18 +98,20 @@ namespace BIO
 			_skydome = NULL;
 		}
 
-		LightData Sky::CalculateSkyLights()
+		LightData Sky::CalculateSkyLightsForSun(const SkyPosition & sunPos) const
 		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_SKY_LIGHTS);
+
 			LightData rtn;
 
 			//calculate sun ligh
 			for (unsigned int i = 0; i < _lightInterpolation.size(); i++)
 			{
-				if (_sunPos.Zenith < _lightInterpolation[i].angle)
+				if (sunPos.Zenith < _lightInterpolation[i].angle)
 				{
 					InterpolationData p1 = _lightInterpolation[i];
 					InterpolationData p2 = _lightInterpolation[i-1];
-					float interpolationAmount = ((_sunPos.Zenith - p2.angle) / (p1.angle - p2.angle));
+					float interpolationAmount = ((sunPos.Zenith - p2.angle) / (p1.angle - p2.angle));
 
 					//interpolate (i, i-1)
 					rtn.Color.A = 1.0f;
@@ -114,25 +119,19 @@ namespace BIO
 					rtn.Color.G = p2.light.G + (p1.light.G - p2.light.G) * interpolationAmount;
 					rtn.Color.B = p2.light.B + (p1.light.B - p2.light.B) * interpolationAmount;
 
-					std::cout << "Interpolating[" << i << ":" << i - 1 << "]: AMT:" << interpolationAmount << " RGB: " << rtn.Color.R << "," << rtn.Color.G << "," << rtn.Color.B << std::endl;
-					
 					return rtn;
 				}
-				else if (_sunPos.Zenith == _lightInterpolation[i].angle)
+				else if (sunPos.Zenith == _lightInterpolation[i].angle)
 				{
 					rtn.Color.A = 1.0f;
 					rtn.Color.R = _lightInterpolation[i].light.R;
 					rtn.Color.G = _lightInterpolation[i].light.G;
 					rtn.Color.B = _lightInterpolation[i].light.B;
 
-					std::cout << "Interpolating: Returning item " << i << std::endl;
-
 					return rtn;
 				}
 			}
 
-			std::cout << "Interpolating: Returning last item \n";
-
 			//otherwise return the last item
 			rtn.Color.A = 1.0f;
 			rtn.Color.R = _lightInterpolation.back().light.R;
@@ -144,132 +143,54 @@ namespace BIO
 
 		void Sky::SetMoonPhase(float phase)
 		{
-			//reduce phase to [0,360]
-			phase = MATH::RevolutionReductionDegrees(phase);
-
-			int quarter = 0; //0=first 1=second 2=third 3=fourth
-
-			//calculate centerX
-			int centerX = (int)(((float)moonImageData.width) * 0.5f);
-			int centerY = (int)(((float)moonImageData.height) * 0.5f);
+			BIOSKY_PERF_SCOPE(SKY_PERF_MOON_PHASE);
 
-			//calculate height of Ellipse
-			int height = (int)(((float)moonImageData.height - 1) / 2.0f);
+			//lock image
+			_LockMoonTexture();
+			//update pixels as needed
+			unsigned char * pixel = _skydome->GetMoonTexturePixels();
 
-			//calculate width of Ellipse
-			int width;
+			memcpy(pixel, moonImageData.pixel_data, moonImageData.width * moonImageData.height * 4);
 
-			if (phase > 180)
-			{
-				phase -= 180;
-				quarter += 2;
-			}
+			ApplyMoonPhaseToAlpha(phase, pixel + 3, moonImageData.width, moonImageData.height, 4);
 
-			if (phase > 90)
-			{
-				phase -= 90;
-				quarter += 1;
-				width = (int)(centerX - ((float)(centerX - 1) * (1 - (phase / 90.0f))));
-			}
-			else
-			{
-				width = (int)(centerX - ((float)(centerX - 1) * (phase / 90.0f)));
-			}
+			//unlock image
+			_UnlockMoonTexture();
+		}
 
-			
+		int Sky::GetMoonTexturePixelCount()
+		{
+			return moonImageData.width * moonImageData.height;
+		}
 
-			//lock image
-			_skydome->LockMoonTexture();
-			//update pixels as needed
-			unsigned char * pixel = _skydome->GetMoonTexturePixels();
+		void Sky::CalculateMoonAlpha(float phase, float visibility, unsigned char * alpha)
+		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_MOON_PHASE);
 
-			memcpy(pixel, moonImageData.pixel_data, moonImageData.width * moonImageData.height * 4);
+			int count = GetMoonTexturePixelCount();
 
-			int start = 0;
-			int end = 0;
-			int hh = height * height;
-			int ww = width * width;
-			int hhww = hh * ww;
-			int x0 = width;
-			int dx = 0;
+			for (int i = 0; i < count; i++)
+				alpha[i] = moonImageData.pixel_data[i * 4 + 3];
 
-			//horozontal diameter
-			if (quarter == 0)//first Quarter
-			{
-				start = 0;
-				end = centerX + width;
-			}
-			else if (quarter == 1)//second quarter
-			{
-				start = 0;
-				end = centerX - width;
-			}
-			else if (quarter == 2)//third quarter
-			{
-				start = centerX + width;
-				end = moonImageData.width;
-			}
-			else //fourth quarter
-			{
-				start = centerX- width;
-				end = moonImageData.width;
-			}
+			ApplyMoonPhaseToAlpha(phase, alpha, moonImageData.width, moonImageData.height, 1);
 
-			for (int x = start; x <= end; x++)
-			{
-				int index = ((centerY * moonImageData.width) + x) * 4;
-				pixel[index + 3] = 0;
-			}
-			//---------------------------------------------------
+			unsigned char limit = (unsigned char)(255 * visibility);
 
-			for (int y = 1; y <= height; y++)
-			{
-				int x1 = x0 - (dx - 1);
-				for (; x1 > 0; x1--)
-				{
-					if (x1*x1*hh + y*y*ww <= hhww)
-						break;
-				}
-				dx = x0 - x1;
-				x0 = x1;
+			for (int i = 0; i < count; i++)
+				alpha[i] = std::min(alpha[i], limit);
+		}
 
-				if (quarter == 0)//first Quarter
-				{
-					start = 0;
-					end = centerX + x0;
-				}
-				else if (quarter == 1)//second quarter
-				{
-					start = 0;
-					end = centerX - x0;
-				}
-				else if (quarter == 2)//third quarter
-				{
-					start = centerX + x0;
-					end = moonImageData.width;
-				}
-				else //fourth quarter
-				{
-					start = centerX - x0;
-					end = moonImageData.width;
-				}
+		void Sky::SetMoonAlpha(const unsigned char * alpha)
+		{
+			_LockMoonTexture();
+			unsigned char * pixel = _skydome->GetMoonTexturePixels();
 
-				//for (int x = -x0; x <= x0; x++)
-				//for (int x = 0; x <= (centerX + x0); x++)
-				for (int x = start; x <= end; x++)
-				{
-					//int index = (((centerY + y) * moonImageData.width) + (centerX + x)) * 4;
-					int index = (((centerY + y) * moonImageData.width) + x) * 4;
-					pixel[index + 3] = 0;
+			int count = GetMoonTexturePixelCount();
 
-					//index = (((centerY - y) * moonImageData.width) + (centerX + x)) * 4;
-					index = (((centerY - y) * moonImageData.width) + x) * 4;
-					pixel[index + 3] = 0;
-				}
-			}
+			for (int i = 0; i < count; i++)
+				pixel[i * 4 + 3] = alpha[i];
 
-			//unlock image
-			_skydome->UnlockMoonTexture();
+			_UnlockMoonTexture();
 		}
 
 		void Sky::SetMoonPosition(float lunarAzimuth, float lunarZenith)
@@ -287,8 +208,10 @@ namespace BIO
 
 		void Sky::SetMoonVisibility(float visibility)
 		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_MOON_VISIBILITY);
+
 			//lock image
-			_skydome->LockMoonTexture();
+			_LockMoonTexture();
 			//update pixels as needed
 			unsigned char * pixel = _skydome->GetMoonTexturePixels();
 
@@ -298,7 +221,7 @@ namespace BIO
 			}
 
 			//unlock image
-			_skydome->UnlockMoonTexture();
+			_UnlockMoonTexture();
 		}
 
 		void Sky::SetSunPosition(float SolarAzimuth, float SolarZenith)
@@ -316,9 +239,18 @@ namespace BIO
 
 		void Sky::UpdateSkyColor()
 		{
-			double T = 3.5;
+			_LockGeometry();
+			CalculateSkyColors(_skydome->GetVertecies());
+			_UnlockGeometry();
+		}
+
+		void Sky::CalculateSkyColorsForSun(const SkyPosition & sunPos, IDomeVertecies * verts, float turbidity)
+		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_SKY_COLOR);
+
+			double T = turbidity;
 			PerezYxyCoefficients coeffs = GetPerezCoefficientsForTurbidity(T); //this doesn't need to be called every time this function is called.
-			YyxColor sunYyx = GetYyxColorForZenithAndTurbidity(_sunPos.Zenith, T);//this doesn't need to be called every time this function is called.
+			YyxColor sunYyx = GetYyxColorForZenithAndTurbidity(sunPos.Zenith, T);//this doesn't need to be called every time this function is called.
 
 			YyxColor Yyx;
 			double gamma;
@@ -328,19 +260,17 @@ namespace BIO
 			const float _93degrees = 1.623156204f; //93 degrees in radians
 
 			int alpha = 255;
-			if (_sunPos.Zenith > _103degrees)//103 degrees
+			if (sunPos.Zenith > _103degrees)//103 degrees
 				alpha = 0;
-			else if (_sunPos.Zenith >= _93degrees)//93 degrees
+			else if (sunPos.Zenith >= _93degrees)//93 degrees
 			{
-				alpha -= (int)(((_sunPos.Zenith - _93degrees) / (_103degrees - _93degrees)) * 255);
+				alpha -= (int)(((sunPos.Zenith - _93degrees) / (_103degrees - _93degrees)) * 255);
 			}
 			//else alpha should be left at 255
 			//BIO_LOG_CRITICAL("Sun Zenith: " << _sunPos.zenith << " alpha: " << alpha);
 
 
 			//irr::video::S3DVertex * verts = (irr::video::S3DVertex *)_skydome->getMesh()->getMeshBuffer(0)->getVertices();
-			_skydome->LockGeometry();
-			IDomeVertecies * verts = _skydome->GetVertecies();
 			for (int i = 0; i < verts->GetVertexCount(); i++)
 			{
 				Vector3D vertPos = verts->GetVertexPosition(i);
@@ -349,20 +279,18 @@ namespace BIO
 				if (MATH::PId2f <= pos.Zenith)
 					pos.Zenith = MATH::PId2f - 0.01f;
 
-				gamma = GetPerezGamma(pos.Zenith, pos.Azimuth, _sunPos.Zenith, _sunPos.Azimuth);
+				gamma = GetPerezGamma(pos.Zenith, pos.Azimuth, sunPos.Zenith, sunPos.Azimuth);
 				//if (MATH::BIO_PI2 < pointZenith)
 				//	pointZenith = MATH::BIO_PI2;
-				Yyx.Y = sunYyx.Y * GetPerezLuminance(pos.Zenith, gamma, coeffs.Y) / GetPerezLuminance(0, _sunPos.Zenith, coeffs.Y);
-				Yyx.x = sunYyx.x * GetPerezLuminance(pos.Zenith, gamma, coeffs.x) / GetPerezLuminance(0, _sunPos.Zenith, coeffs.x);
-				Yyx.y = sunYyx.y * GetPerezLuminance(pos.Zenith, gamma, coeffs.y) / GetPerezLuminance(0, _sunPos.Zenith, coeffs.y);
+				Yyx.Y = sunYyx.Y * GetPerezLuminance(pos.Zenith, gamma, coeffs.Y) / GetPerezLuminance(0, sunPos.Zenith, coeffs.Y);
+				Yyx.x = sunYyx.x * GetPerezLuminance(pos.Zenith, gamma, coeffs.x) / GetPerezLuminance(0, sunPos.Zenith, coeffs.x);
+				Yyx.y = sunYyx.y * GetPerezLuminance(pos.Zenith, gamma, coeffs.y) / GetPerezLuminance(0, sunPos.Zenith, coeffs.y);
 
 				rgb = GetRGBColorFromYxy(Yyx);
 
 				//verts[i].Color.set(alpha, rgb.red * 255, rgb.green * 255, rgb.blue * 255);
 				verts->SetVertexColor(i, alpha, (int)(rgb.red * 255), (int)(rgb.green * 255), (int)(rgb.blue * 255));
 			}
-
-			_skydome->UnlockGeometry();
 		}
 
 		///////////////////////////////////////////////////////////////////////
@@ -370,6 +298,30 @@ namespace BIO
 		//			Private Functions
 		///////////////////////////////////////////////////////////////////////
 		///////////////////////////////////////////////////////////////////////
+		void Sky::_LockGeometry()
+		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_GEOMETRY_LOCK);
+			_skydome->LockGeometry();
+		}
+
+		void Sky::_UnlockGeometry()
+		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_GEOMETRY_UNLOCK);
+			_skydome->UnlockGeometry();
+		}
+
+		void Sky::_LockMoonTexture()
+		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_TEXTURE_LOCK);
+			_skydome->LockMoonTexture();
+		}
+
+		void Sky::_UnlockMoonTexture()
+		{
+			BIOSKY_PERF_SCOPE(SKY_PERF_TEXTURE_UNLOCK);
+			_skydome->UnlockMoonTexture();
+		}
+
 		Sky::PerezYxyCoefficients Sky::GetPerezCoefficientsForTurbidity(double turbidity)
 		{
 			PerezCoefficient coeffY, coeffx, coeffy;
@@ -0,0 +1,68 @@
+/**
+* @file SkyCalculated.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* The implementation of the SkyCalculated class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "SkyCalculated.hpp"
+#include "SkyPerfCounters.hpp"
+
+namespace BIO
+{
+	namespace SKY
+	{
+		void SkyCalculated::UpdateAllSkyObjects()
+		{
+			SkyData skyInfo;
+			{
+				BIOSKY_PERF_SCOPE(SKY_PERF_EPHEMERIS);
+				skyInfo = CalculateAllSkyData();
+			}
+
+			SetMoonPosition(skyInfo.moonPos);
+			SetStarPosition(skyInfo.northStarZenith, skyInfo.starRotation);
+			SetSunPosition(skyInfo.sunPos);
+
+			SetMoonPhase(skyInfo.phase);
+
+			SetMoonVisibility(skyInfo.moonVisibility);
+
+			UpdateSkyColor();
+
+			LightData lights = CalculateSkyLights();
+			SetSkyLights(lights);
+
+			if (_statePublisher != NULL)
+				_statePublisher->Publish(MakeSkySnapshot(_dateTime->GetTimestamp(), skyInfo, lights));
+		}
+	}//end namespace SKY
+}//end namespace BIO
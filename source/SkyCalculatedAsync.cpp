@@ -0,0 +1,570 @@
+/**
+* @file SkyCalculatedAsync.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* The implementation of the SkyCalculatedAsync class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "SkyCalculatedAsync.hpp"
+#include "Allocator.hpp"
+#include "SkyPerfCounters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if BIOSKY_TESTING == 1
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include "SkyCalculatedDynamic.hpp"
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		struct SkyCalculatedAsync::_Shared
+		{
+			/**Set by the worker when a result is finished.*/
+			std::atomic<bool> ready;
+
+			/**The owned worker. Not used with a scheduler.*/
+			std::thread thread;
+			std::mutex mutex;
+			std::condition_variable wake;
+			/**Guarded by the mutex.*/
+			bool jobPending;
+			/**Guarded by the mutex.*/
+			bool quit;
+
+			_Shared() : ready(false), jobPending(false), quit(false)
+			{}
+		};
+
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**
+			* The vertecies the worker colors: the positions read from the
+			* dome and the colors of a result.
+			*/
+			class _ColorBuffer : public IDomeVertecies
+			{
+			public:
+				const Vector3D * positions;
+				unsigned int * colors;
+				int count;
+
+				virtual int GetVertexCount()
+				{
+					return count;
+				}
+
+				virtual Vector3D GetVertexPosition(int index)
+				{
+					return positions[index];
+				}
+
+				virtual void SetVertexColor(int index, int A, int R, int G, int B)
+				{
+					colors[index] = ((unsigned int)A << 24) | ((unsigned int)(R & 0xFF) << 16) | ((unsigned int)(G & 0xFF) << 8) | (unsigned int)(B & 0xFF);
+				}
+			};
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		SkyCalculatedAsync::SkyCalculatedAsync(IDomeGeometry * geometry, DateTime * dateTime, GPS * gps, SkyTaskScheduler scheduler, void * schedulerData) :
+			SkyCalculated(geometry, dateTime, gps), _shared(NULL), _scheduler(scheduler), _schedulerData(schedulerData),
+			_front(0), _inFlight(false), _positions(NULL), _numVertecies(0), _workerCache(NULL)
+		{
+			_shared = New<_Shared>();
+
+			for (int i = 0; i < 2; i++)
+			{
+				_results[i].colors = NULL;
+				_results[i].moonAlpha = AllocateArray<unsigned char>(GetMoonTexturePixelCount());
+			}
+
+			if (_skydome == NULL)
+				return;
+
+			//the worker can not touch the geometry, so keep the positions
+			_LockGeometry();
+			IDomeVertecies * verts = _skydome->GetVertecies();
+			_numVertecies = verts->GetVertexCount();
+			_positions = AllocateArray<Vector3D>(_numVertecies);
+
+			for (int i = 0; i < _numVertecies; i++)
+				_positions[i] = verts->GetVertexPosition(i);
+
+			_UnlockGeometry();
+
+			for (int i = 0; i < 2; i++)
+				_results[i].colors = AllocateArray<unsigned int>(_numVertecies);
+
+			//the first sky is worked out here, and sets the color of the moon
+			_TakeInput(_front);
+			_Compute();
+			_shared->ready.store(false);
+
+			SetMoonPhase(_results[_front].skyData.phase);
+			_Apply(_results[_front]);
+
+			if (_scheduler == NULL)
+				_shared->thread = std::thread(&SkyCalculatedAsync::_WorkerLoop, this);
+		}
+
+		SkyCalculatedAsync::~SkyCalculatedAsync()
+		{
+			if (_shared->thread.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> lock(_shared->mutex);
+					_shared->quit = true;
+				}
+
+				_shared->wake.notify_one();
+				_shared->thread.join();
+			}
+			else
+			{
+				//a scheduled task still has a pointer to this. The scheduler
+				//must run it (see SkyTaskScheduler), or this never returns.
+				while (_inFlight && !_shared->ready.load(std::memory_order_acquire))
+					std::this_thread::yield();
+			}
+
+			for (int i = 0; i < 2; i++)
+			{
+				FreeArray(_results[i].colors);
+				FreeArray(_results[i].moonAlpha);
+			}
+
+			FreeArray(_positions);
+
+			if (_workerCache != NULL)
+				Delete(_workerCache);
+
+			Delete(_shared);
+		}
+
+		void SkyCalculatedAsync::Update()
+		{
+			if (_skydome == NULL)
+				return;
+
+			if (_inFlight && _shared->ready.load(std::memory_order_acquire))
+			{
+				_shared->ready.store(false, std::memory_order_relaxed);
+				_inFlight = false;
+
+				_front = _input.target;
+				_Apply(_results[_front]);
+			}
+
+			if (!_inFlight)
+			{
+				_TakeInput(1 - _front);
+				_Submit();
+			}
+		}
+
+		bool SkyCalculatedAsync::IsBusy() const
+		{
+			return _inFlight && !_shared->ready.load(std::memory_order_acquire);
+		}
+
+		bool SkyCalculatedAsync::HasResult() const
+		{
+			return _inFlight && _shared->ready.load(std::memory_order_acquire);
+		}
+
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//			Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		void SkyCalculatedAsync::_TakeInput(int target)
+		{
+			_input.time = _dateTime->GetTimestamp();
+			_input.latitude = _gps->GetLatitudeRadians();
+			_input.longitude = _gps->GetLongitudeRadians();
+			_input.model = _ephemerisModel;
+			_input.turbidity = _turbidity;
+			_input.target = target;
+		}
+
+		void SkyCalculatedAsync::_Submit()
+		{
+			_inFlight = true;
+
+			if (_scheduler != NULL)
+			{
+				_scheduler(&SkyCalculatedAsync::_RunTask, this, _schedulerData);
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(_shared->mutex);
+				_shared->jobPending = true;
+			}
+
+			_shared->wake.notify_one();
+		}
+
+		void SkyCalculatedAsync::_Compute()
+		{
+			_Result & result = _results[_input.target];
+
+			result.time = _input.time;
+
+			if (_input.model == EPHEMERIS_ACCURATE)
+			{
+				if (_workerCache == NULL)
+					_workerCache = New<EphemerisCache>();
+
+				BIOSKY_PERF_SCOPE(SKY_PERF_EPHEMERIS);
+				result.skyData = _workerCache->CalculateSkyData(_input.time, _input.latitude, _input.longitude);
+			}
+			else
+			{
+				BIOSKY_PERF_SCOPE(SKY_PERF_EPHEMERIS);
+				result.skyData = CalculateSkyData(_input.time, _input.latitude, _input.longitude);
+			}
+
+			result.lights = CalculateSkyLightsForSun(result.skyData.sunPos);
+
+			_ColorBuffer buffer;
+			buffer.positions = _positions;
+			buffer.colors = result.colors;
+			buffer.count = _numVertecies;
+			CalculateSkyColorsForSun(result.skyData.sunPos, &buffer, _input.turbidity);
+
+			CalculateMoonAlpha(result.skyData.phase, result.skyData.moonVisibility, result.moonAlpha);
+
+			_shared->ready.store(true, std::memory_order_release);
+		}
+
+		void SkyCalculatedAsync::_Apply(const _Result & result)
+		{
+			SetMoonPosition(result.skyData.moonPos);
+			SetStarPosition(result.skyData.northStarZenith, result.skyData.starRotation);
+			SetSunPosition(result.skyData.sunPos);
+
+			SetMoonAlpha(result.moonAlpha);
+
+			_LockGeometry();
+			IDomeVertecies * verts = _skydome->GetVertecies();
+			int count = std::min(_numVertecies, verts->GetVertexCount());
+
+			for (int i = 0; i < count; i++)
+			{
+				unsigned int color = result.colors[i];
+				verts->SetVertexColor(i, (int)(color >> 24), (int)((color >> 16) & 0xFF), (int)((color >> 8) & 0xFF), (int)(color & 0xFF));
+			}
+
+			_UnlockGeometry();
+
+			LightData lights = result.lights;
+			SetSkyLights(lights);
+
+			if (_statePublisher != NULL)
+				_statePublisher->Publish(MakeSkySnapshot(result.time, result.skyData, lights));
+		}
+
+		void SkyCalculatedAsync::_RunTask(void * task)
+		{
+			((SkyCalculatedAsync *)task)->_Compute();
+		}
+
+		void SkyCalculatedAsync::_WorkerLoop(SkyCalculatedAsync * sky)
+		{
+			_Shared & shared = *sky->_shared;
+			std::unique_lock<std::mutex> lock(shared.mutex);
+
+			while (true)
+			{
+				while (!shared.jobPending && !shared.quit)
+					shared.wake.wait(lock);
+
+				if (shared.quit)
+					return;
+
+				shared.jobPending = false;
+
+				lock.unlock();
+				sky->_Compute();
+				lock.lock();
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End Private Functions
+		///////////////////////////////////////////////////////////////////////
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* A dome of a few vertecies that remembers what is set on it.
+			*/
+			class _TestGeometry : public IDomeGeometry, public IDomeVertecies
+			{
+			public:
+				enum { NumVertecies = 64 };
+
+				Vector3D positions[NumVertecies];
+				unsigned int colors[NumVertecies];
+				unsigned char * moonTexture;
+				Vector3D sun, moon;
+				LightData light;
+				int geometryLocks;
+				int textureLocks;
+
+				_TestGeometry() : geometryLocks(0), textureLocks(0)
+				{
+					//8 rings of 8 from the horizon to near the top
+					for (int i = 0; i < NumVertecies; i++)
+					{
+						float zenith = MATH::PId2f * (1.0f - (i / 8) / 8.0f);
+						float azimuth = MATH::PIx2f * (i % 8) / 8.0f;
+						positions[i] = Vector3D(std::sin(zenith) * std::sin(azimuth), std::cos(zenith), std::sin(zenith) * std::cos(azimuth));
+						colors[i] = 0;
+					}
+
+					moonTexture = AllocateArray<unsigned char>(256 * 256 * 4);
+				}
+
+				~_TestGeometry()
+				{
+					FreeArray(moonTexture);
+				}
+
+				virtual IDomeVertecies * GetVertecies() { return this; }
+				virtual unsigned char * GetMoonTexturePixels() { return moonTexture; }
+				virtual void LockGeometry() { geometryLocks++; }
+				virtual void LockMoonTexture() { textureLocks++; }
+				virtual void SetMoonPosition(float unitX, float unitY, float unitZ) { moon = Vector3D(unitX, unitY, unitZ); }
+				virtual void SetSkyLight(LightData & data) { light = data; }
+				virtual void SetStarRotation(float, float, float) {}
+				virtual void SetSunPosition(float unitX, float unitY, float unitZ) { sun = Vector3D(unitX, unitY, unitZ); }
+				virtual void UnlockGeometry() {}
+				virtual void UnlockMoonTexture() {}
+
+				virtual int GetVertexCount() { return NumVertecies; }
+				virtual Vector3D GetVertexPosition(int index) { return positions[index]; }
+				virtual void SetVertexColor(int index, int A, int R, int G, int B)
+				{
+					colors[index] = ((unsigned int)A << 24) | ((unsigned int)R << 16) | ((unsigned int)G << 8) | (unsigned int)B;
+				}
+			};
+
+			/**
+			* A scheduler that runs the task right away and counts them.
+			*/
+			void _RunNow(SkyTaskFunction function, void * task, void * userData)
+			{
+				(*(int *)userData)++;
+				function(task);
+			}
+
+			/**
+			* The distance between two points.
+			*/
+			float _Distance(const Vector3D & first, const Vector3D & second)
+			{
+				float x = first.X - second.X, y = first.Y - second.Y, z = first.Z - second.Z;
+				return std::sqrt(x * x + y * y + z * z);
+			}
+
+			/**
+			* Wait up to a few seconds for the worker.
+			*/
+			bool _WaitForResult(const SkyCalculatedAsync & sky)
+			{
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+				while (!sky.HasResult())
+				{
+					if (std::chrono::steady_clock::now() - start > std::chrono::seconds(10))
+						return false;
+
+					std::this_thread::yield();
+				}
+
+				return true;
+			}
+		}
+
+		bool SkyCalculatedAsync::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("SkyCalculatedAsync Tests");
+
+			GPS gps(40.76f, -111.89f);
+
+			DateTime syncTime, asyncTime;
+			syncTime.SetDate(JUNE, 21, 2015);
+			syncTime.SetTimeHours(18.0f);
+			syncTime.SetUTCOffset(-6.0f);
+			asyncTime = syncTime;
+
+			_TestGeometry syncDome, asyncDome;
+
+			SkyCalculatedDynamic syncSky(&syncDome, &syncTime, &gps);
+			SkyCalculatedAsync asyncSky(&asyncDome, &asyncTime, &gps);
+
+			//the constructor works out the first sky itself
+			test->UnitTest(!asyncSky.IsBusy() && !asyncSky.HasResult(), "Nothing in flight after the constructor");
+			test->UnitTest(asyncSky.GetSkyDataTime() == asyncTime.GetTimestamp(), "The first sky is the current time");
+			test->UnitTest(_Distance(asyncDome.sun, syncDome.sun) < 0.001f, "The first sun matches the synchronous sky");
+			test->UnitTest(std::memcmp(asyncDome.moonTexture, syncDome.moonTexture, 256 * 256 * 4) == 0, "The first moon texture matches the synchronous sky");
+
+			bool colorsClose = true;
+			for (int i = 0; i < _TestGeometry::NumVertecies; i++)
+			{
+				for (int shift = 0; shift < 32; shift += 8)
+				{
+					int difference = (int)((asyncDome.colors[i] >> shift) & 0xFF) - (int)((syncDome.colors[i] >> shift) & 0xFF);
+					if (difference > 1 || difference < -1)
+						colorsClose = false;
+				}
+			}
+			test->UnitTest(colorsClose, "The first colors match the synchronous sky");
+
+			//The next update hands the worker the new time, and the one
+			//after applies it.
+			Timestamp before = asyncTime.GetTimestamp();
+			Vector3D firstSun = asyncDome.sun;
+			asyncTime.AddTime(2.0f * 3600.0f);
+			Timestamp after = asyncTime.GetTimestamp();
+
+			int textureLocks = asyncDome.textureLocks;
+			asyncSky.Update();
+			test->UnitTest(asyncSky.GetSkyDataTime() == before, "Update does not wait for the worker");
+			test->UnitTest(_Distance(asyncDome.sun, firstSun) == 0.0f && asyncDome.textureLocks == textureLocks, "Update does not touch the geometry before the result is in");
+
+			test->UnitTest(_WaitForResult(asyncSky), "The worker finishes");
+			asyncSky.Update();
+			test->UnitTest(asyncSky.GetSkyDataTime() == after, "The result is applied on the next Update");
+			test->UnitTest(asyncSky.IsBusy() || asyncSky.HasResult(), "The next time is handed to the worker");
+
+			//the applied result is exactly what the synchronous pieces give
+			SkyData expected = CalculateSkyData(after, gps.GetLatitudeRadians(), gps.GetLongitudeRadians());
+			test->UnitTest(asyncSky.GetSkyData().sunPos.Zenith == expected.sunPos.Zenith, "The sun is from the new time");
+
+			_TestGeometry expectedDome;
+			CalculateSkyColorsForSun(expected.sunPos, &expectedDome);
+			test->UnitTest(std::memcmp(asyncDome.colors, expectedDome.colors, sizeof(expectedDome.colors)) == 0, "The vertex colors are from the new time");
+
+			unsigned char * alpha = AllocateArray<unsigned char>(GetMoonTexturePixelCount());
+			CalculateMoonAlpha(expected.phase, expected.moonVisibility, alpha);
+			bool alphaMatches = true;
+			for (int i = 0; i < GetMoonTexturePixelCount(); i++)
+			{
+				if (asyncDome.moonTexture[i * 4 + 3] != alpha[i])
+					alphaMatches = false;
+			}
+			test->UnitTest(alphaMatches, "The moon alpha is from the new time");
+			FreeArray(alpha);
+
+			syncTime.AddTime(2.0f * 3600.0f);
+			syncSky.Update();
+			test->UnitTest(_Distance(asyncDome.sun, syncDome.sun) < 0.001f, "The sun matches the synchronous sky");
+
+			//With a scheduler. This one runs the work right away, so each
+			//Update shows the time of the Update before it.
+			int scheduled = 0;
+			_TestGeometry scheduledDome;
+			DateTime scheduledTime = syncTime;
+			SkyCalculatedAsync scheduledSky(&scheduledDome, &scheduledTime, &gps, &_RunNow, &scheduled);
+			test->UnitTest(scheduled == 0, "The constructor does not schedule");
+
+			bool oneFrame = true;
+			Timestamp previous = scheduledTime.GetTimestamp();
+			for (int frame = 0; frame < 10; frame++)
+			{
+				scheduledTime.AddTime(60.0f);
+				scheduledSky.Update();
+
+				if (frame > 0 && scheduledSky.GetSkyDataTime() != previous)
+					oneFrame = false;
+
+				previous = scheduledTime.GetTimestamp();
+			}
+			test->UnitTest(oneFrame, "The sky is one frame behind");
+			test->UnitTest(scheduled == 10, "One task a frame");
+
+			//other threads see what was applied
+			SkyStatePublisher publisher;
+			SkySnapshot snapshot;
+			syncSky.SetStatePublisher(&publisher);
+			syncSky.Update();
+			test->UnitTest(publisher.Read(&snapshot) && snapshot.time == syncTime.GetTimestamp(), "The synchronous sky is published");
+			syncSky.SetStatePublisher(NULL);
+
+			scheduledSky.SetStatePublisher(&publisher);
+			scheduledSky.Update();
+			test->UnitTest(publisher.Read(&snapshot), "The applied sky is published");
+			test->UnitTest(snapshot.time == scheduledSky.GetSkyDataTime() && snapshot.skyData.sunPos.Zenith == scheduledSky.GetSkyData().sunPos.Zenith, "The published sky is the applied sky");
+			test->UnitTest(_Distance(snapshot.sunDirection, scheduledDome.sun) < 0.000001f, "The published sun direction is the one on the dome");
+			scheduledSky.SetStatePublisher(NULL);
+
+			//the accurate model runs on the worker's own cache
+			scheduledSky.SetEphemerisModel(EPHEMERIS_ACCURATE);
+			scheduledSky.Update();
+			scheduledSky.Update();
+			EphemerisCache cache;
+			SkyData accurate = cache.CalculateSkyData(scheduledSky.GetSkyDataTime(), gps.GetLatitudeRadians(), gps.GetLongitudeRadians());
+			test->UnitTest(scheduledSky.GetSkyData().moonPos.Zenith, accurate.moonPos.Zenith, 0.0001f, "The accurate model on the worker");
+
+			//the worker colors the sky with the turbidity of the sky
+			scheduledSky.SetTurbidity(20.0f);
+			test->UnitTest(scheduledSky.GetTurbidity() == 10.0f, "The turbidity is clamped");
+			scheduledSky.Update();
+			scheduledSky.Update();
+			_TestGeometry hazyDome;
+			CalculateSkyColorsForSun(scheduledSky.GetSkyData().sunPos, &hazyDome, 10.0f);
+			test->UnitTest(std::memcmp(scheduledDome.colors, hazyDome.colors, sizeof(hazyDome.colors)) == 0, "The worker uses the turbidity");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -34,16 +34,17 @@
 */
 
 #include "SkyCalculations.hpp"
+#include "Allocator.hpp"
 
 namespace BIO
 {
 	namespace SKY
 	{
-		SkyCalculations::SkyCalculations(DateTime * dateTime, GPS * gps) : _userDateTime(false), _dateTime(NULL), _userGPS(false), _gps(NULL)
+		SkyCalculations::SkyCalculations(DateTime * dateTime, GPS * gps) : _userDateTime(false), _dateTime(NULL), _userGPS(false), _gps(NULL), _ephemerisModel(EPHEMERIS_SIMPLE), _ephemerisCache(NULL)
 		{
 			if (dateTime == NULL)
 			{
-				_dateTime = new DateTime();
+				_dateTime = New<DateTime>();
 				_userDateTime = false;
 			}
 			else
@@ -54,8 +55,8 @@ namespace BIO
 
 			if (gps == NULL)
 			{
-				_gps = new GPS();
-				_userDateTime = false;
+				_gps = New<GPS>();
+				_userGPS = false;
 			}
 			else
 			{
@@ -69,6 +70,22 @@ namespace BIO
 			_delete();
 		}
 
+		SkyData SkyCalculations::CalculateAllSkyData(const Timestamp & time)
+		{
+			if (_ephemerisModel == EPHEMERIS_ACCURATE)
+				return _ephemerisCache->CalculateSkyData(time, _gps->GetLatitudeRadians(), _gps->GetLongitudeRadians());
+
+			return BIO::SKY::CalculateSkyData(time, _gps->GetLatitudeRadians(), _gps->GetLongitudeRadians());
+		}
+
+		void SkyCalculations::SetEphemerisModel(EPHEMERIS_MODEL model)
+		{
+			_ephemerisModel = model;
+
+			if (model == EPHEMERIS_ACCURATE && _ephemerisCache == NULL)
+				_ephemerisCache = New<EphemerisCache>();
+		}
+
 		///////////////////////////////////////////////////////////////////
 		///////////////////////////////////////////////////////////////////
 		//				Private Functions
@@ -79,12 +96,17 @@ namespace BIO
 			_deleteDateTime();
 
 			_deleteGPS();
+
+			if (_ephemerisCache != NULL)
+				Delete(_ephemerisCache);
+
+			_ephemerisCache = NULL;
 		}
 
 		void SkyCalculations::_deleteDateTime()
 		{
 			if ((_userDateTime == false) && (_dateTime != NULL))
-				delete _dateTime;
+				Delete(_dateTime);
 
 			_dateTime = NULL;
 			_userDateTime = false;
@@ -93,11 +115,24 @@ namespace BIO
 		void SkyCalculations::_deleteGPS()
 		{
 			if ((_userGPS == false) && (_gps != NULL))
-				delete _gps;
+				Delete(_gps);
 
 			_gps = NULL;
 			_userGPS = false;
 		}
+
+		SkyData SkyCalculations::_CalculateAccurateSkyData()
+		{
+			return _ephemerisCache->CalculateSkyData(
+				_dateTime->GetTimeHours(),
+				_dateTime->GetUTCOffset(),
+				_dateTime->GetMonth(),
+				_dateTime->GetDay(),
+				_dateTime->GetYear(),
+				_gps->GetLatitudeRadians(),
+				_gps->GetLongitudeRadians()
+				);
+		}
 		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 		//			End Private Functions
 		///////////////////////////////////////////////////////////////////
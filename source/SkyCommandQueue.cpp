@@ -0,0 +1,434 @@
+/**
+* @file SkyCommandQueue.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the SkyCommandQueue class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "SkyCommandQueue.hpp"
+#include "Allocator.hpp"
+
+#if BIOSKY_TESTING == 1
+#include <thread>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		SkyCommandQueue::SkyCommandQueue(int capacity) : _cells(NULL), _mask(0), _enqueuePosition(0), _dequeuePosition(0), _dropped(0)
+		{
+			std::size_t size = 2;
+
+			while ((int)size < capacity)
+				size <<= 1;
+
+			_cells = AllocateArray<_Cell>((int)size);
+			_mask = size - 1;
+
+			for (std::size_t i = 0; i < size; i++)
+				_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		SkyCommandQueue::~SkyCommandQueue()
+		{
+			FreeArray(_cells);
+		}
+
+		bool SkyCommandQueue::Push(const SkyCommand & command)
+		{
+			_Cell * cell;
+			std::size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+
+			while (true)
+			{
+				cell = &_cells[position & _mask];
+				std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+				std::ptrdiff_t difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+
+				if (difference == 0)
+				{
+					//the cell is free for this position, try to claim it
+					if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (difference < 0)
+				{
+					//the consumer has not taken the command a lap ago
+					_dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				else
+				{
+					//another producer took the position
+					position = _enqueuePosition.load(std::memory_order_relaxed);
+				}
+			}
+
+			cell->command = command;
+			cell->sequence.store(position + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		bool SkyCommandQueue::Pop(SkyCommand * command)
+		{
+			if (command == NULL)
+				return false;
+
+			_Cell * cell = &_cells[_dequeuePosition & _mask];
+			std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+
+			if (sequence != _dequeuePosition + 1)
+				return false;
+
+			*command = cell->command;
+
+			//free the cell for the producer a lap from now
+			cell->sequence.store(_dequeuePosition + _mask + 1, std::memory_order_release);
+			_dequeuePosition++;
+
+			return true;
+		}
+
+		int SkyCommandQueue::Drain(ISky * sky, SkyCalculations * calculations)
+		{
+			SkyCommand latest[NumSkyCommands];
+			bool present[NumSkyCommands] = { false };
+
+			int taken = 0;
+			SkyCommand command;
+
+			while ((taken <= (int)_mask) && Pop(&command))
+			{
+				taken++;
+
+				if ((command.type < 0) || (command.type >= NumSkyCommands))
+					continue;
+
+				latest[command.type] = command;
+				present[command.type] = true;
+			}
+
+			if (calculations != NULL)
+			{
+				if (present[SKY_COMMAND_DATE_TIME])
+					calculations->SetDateTime(latest[SKY_COMMAND_DATE_TIME].dateTime);
+
+				if (present[SKY_COMMAND_GPS])
+					calculations->SetGPS(latest[SKY_COMMAND_GPS].gps);
+			}
+
+			if (sky == NULL)
+				return taken;
+
+			if (present[SKY_COMMAND_TURBIDITY])
+				sky->SetTurbidity(latest[SKY_COMMAND_TURBIDITY].value);
+
+			if (present[SKY_COMMAND_SUN_POSITION])
+				sky->SetSunPosition(latest[SKY_COMMAND_SUN_POSITION].position);
+
+			if (present[SKY_COMMAND_MOON_POSITION])
+				sky->SetMoonPosition(latest[SKY_COMMAND_MOON_POSITION].position);
+
+			if (present[SKY_COMMAND_STAR_POSITION])
+				sky->SetStarPosition(latest[SKY_COMMAND_STAR_POSITION].value, latest[SKY_COMMAND_STAR_POSITION].rotation);
+
+			if (present[SKY_COMMAND_MOON_PHASE])
+				sky->SetMoonPhase(latest[SKY_COMMAND_MOON_PHASE].value);
+
+			if (present[SKY_COMMAND_MOON_VISIBILITY])
+				sky->SetMoonVisibility(latest[SKY_COMMAND_MOON_VISIBILITY].value);
+
+			return taken;
+		}
+
+		bool SkyCommandQueue::PushSunPosition(SkyPosition position)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_SUN_POSITION;
+			command.position = position;
+			return Push(command);
+		}
+
+		bool SkyCommandQueue::PushMoonPosition(SkyPosition position)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_MOON_POSITION;
+			command.position = position;
+			return Push(command);
+		}
+
+		bool SkyCommandQueue::PushStarPosition(float zenith, float rotation)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_STAR_POSITION;
+			command.value = zenith;
+			command.rotation = rotation;
+			return Push(command);
+		}
+
+		bool SkyCommandQueue::PushMoonPhase(float phase)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_MOON_PHASE;
+			command.value = phase;
+			return Push(command);
+		}
+
+		bool SkyCommandQueue::PushMoonVisibility(float visibility)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_MOON_VISIBILITY;
+			command.value = visibility;
+			return Push(command);
+		}
+
+		bool SkyCommandQueue::PushTurbidity(float turbidity)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_TURBIDITY;
+			command.value = turbidity;
+			return Push(command);
+		}
+
+		bool SkyCommandQueue::PushDateTime(const DateTime & dateTime)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_DATE_TIME;
+			command.dateTime = dateTime;
+			return Push(command);
+		}
+
+		bool SkyCommandQueue::PushGPS(const GPS & gps)
+		{
+			SkyCommand command;
+			command.type = SKY_COMMAND_GPS;
+			command.gps = gps;
+			return Push(command);
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* A sky that writes down what is set on it.
+			*/
+			class _RecordingSky : public ISky
+			{
+			public:
+				int calls[NumSkyCommands];
+				/**The order of the calls, as SKY_COMMANDs.*/
+				int order[NumSkyCommands * 4];
+				int numCalls;
+				SkyPosition sun, moon;
+				float phase, visibility, turbidity, starZenith, starRotation;
+
+				_RecordingSky() : numCalls(0), phase(0.0f), visibility(0.0f), turbidity(0.0f), starZenith(0.0f), starRotation(0.0f)
+				{
+					for (int i = 0; i < NumSkyCommands; i++)
+						calls[i] = 0;
+				}
+
+				void Record(SKY_COMMAND type)
+				{
+					calls[type]++;
+
+					if (numCalls < NumSkyCommands * 4)
+						order[numCalls++] = type;
+				}
+
+				virtual LightData CalculateSkyLights() { return LightData(); }
+				virtual ErrorType GetErrorCode() { return OK; }
+				virtual void SetMoonPhase(float value) { phase = value; Record(SKY_COMMAND_MOON_PHASE); }
+				virtual void SetMoonPosition(SkyPosition pos) { moon = pos; Record(SKY_COMMAND_MOON_POSITION); }
+				virtual void SetMoonPosition(float lunarAzimuth, float lunarZenith) { SetMoonPosition(SkyPosition(lunarAzimuth, lunarZenith)); }
+				virtual void SetMoonVisibility(float value) { visibility = value; Record(SKY_COMMAND_MOON_VISIBILITY); }
+				virtual void SetSkyLights(LightData &) {}
+				virtual void SetStarPosition(float zenith, float rotation) { starZenith = zenith; starRotation = rotation; Record(SKY_COMMAND_STAR_POSITION); }
+				virtual void SetSunPosition(SkyPosition pos) { sun = pos; Record(SKY_COMMAND_SUN_POSITION); }
+				virtual void SetSunPosition(float SolarAzimuth, float SolarZenith) { SetSunPosition(SkyPosition(SolarAzimuth, SolarZenith)); }
+				virtual void SetTurbidity(float value) { turbidity = value; Record(SKY_COMMAND_TURBIDITY); }
+				virtual void Update() {}
+				virtual void Update(float) {}
+				virtual void UpdateAllSkyObjects() {}
+				virtual void UpdateMoonPosition() {}
+				virtual void UpdateSkyLights() {}
+				virtual void UpdateStarPosition() {}
+				virtual void UpdateStarRotation() {}
+				virtual void UpdateSkyColor() {}
+				virtual void UpdateSunPosition() {}
+			};
+
+			/**The commands each producer of the stress test pushes.*/
+			const int _CommandsPerProducer = 50000;
+
+			/**The producers of the stress test.*/
+			const int _NumProducers = 4;
+
+			struct _ProducerData
+			{
+				SkyCommandQueue * queue;
+				int producer;
+				int retries;
+			};
+
+			/**
+			* Push numbered moon phases, trying again when the queue is full.
+			*/
+			void _Producer(_ProducerData * data)
+			{
+				for (int i = 0; i < _CommandsPerProducer; i++)
+				{
+					//the producer and the number both fit in a float exactly
+					float value = (float)(data->producer * 1000000 + i);
+
+					while (!data->queue->PushMoonPhase(value))
+					{
+						data->retries++;
+						std::this_thread::yield();
+					}
+				}
+			}
+		}
+
+		bool SkyCommandQueue::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("SkyCommandQueue Tests");
+
+			test->UnitTest(SkyCommandQueue(5).GetCapacity() == 8, "The capacity is rounded up to a power of 2");
+			test->UnitTest(SkyCommandQueue().GetCapacity() == DefaultCapacity, "The default capacity");
+
+			//the last command of each type wins, in a fixed order
+			SkyCommandQueue queue(16);
+			_RecordingSky sky;
+			SkyCalculations calculations(NULL, NULL);
+
+			queue.PushMoonVisibility(0.5f);
+			queue.PushSunPosition(SkyPosition(1.0f, 0.1f));
+			queue.PushMoonPhase(90.0f);
+			queue.PushSunPosition(SkyPosition(2.0f, 0.2f));
+			queue.PushTurbidity(5.0f);
+			queue.PushSunPosition(SkyPosition(3.0f, 0.3f));
+			queue.PushMoonPhase(180.0f);
+			queue.PushGPS(GPS(40.76f, -111.89f));
+			queue.PushGPS(GPS(51.48f, 0.0f));
+
+			test->UnitTest(queue.Drain(&sky, &calculations) == 9, "Every command is taken");
+			test->UnitTest(sky.calls[SKY_COMMAND_SUN_POSITION] == 1 && sky.sun.Azimuth == 3.0f, "Only the last sun position");
+			test->UnitTest(sky.calls[SKY_COMMAND_MOON_PHASE] == 1 && sky.phase == 180.0f, "Only the last moon phase");
+			test->UnitTest(sky.calls[SKY_COMMAND_MOON_VISIBILITY] == 1 && sky.visibility == 0.5f, "The moon visibility");
+			test->UnitTest(sky.turbidity == 5.0f, "The turbidity");
+			test->UnitTest(calculations.GetGPS()->GetLatitude() == 51.48f, "Only the last GPS");
+			test->UnitTest(sky.numCalls == 4 && sky.order[0] == SKY_COMMAND_TURBIDITY && sky.order[1] == SKY_COMMAND_SUN_POSITION &&
+				sky.order[2] == SKY_COMMAND_MOON_PHASE && sky.order[3] == SKY_COMMAND_MOON_VISIBILITY, "Applied in the order of SKY_COMMAND");
+			test->UnitTest(queue.Drain(&sky, &calculations) == 0 && sky.numCalls == 4, "An empty drain does nothing");
+
+			//the date and time
+			DateTime dateTime;
+			dateTime.SetDate(MARCH, 20, 2015);
+			dateTime.SetTimeHours(6.5f);
+			queue.PushDateTime(dateTime);
+			queue.PushStarPosition(0.8f, 1.2f);
+			queue.Drain(&sky, &calculations);
+			test->UnitTest(calculations.GetDateTime()->GetDay() == 20 && calculations.GetDateTime()->GetTimeHours() == 6.5f, "The date and time");
+			test->UnitTest(sky.starZenith == 0.8f && sky.starRotation == 1.2f, "The star position");
+
+			//a full queue drops and counts
+			SkyCommandQueue small(4);
+			bool filled = true;
+			for (int i = 0; i < 4; i++)
+				filled = small.PushMoonPhase((float)i) && filled;
+			test->UnitTest(filled, "Fill the queue");
+			test->UnitTest(!small.PushMoonPhase(4.0f) && small.GetDroppedCount() == 1, "A full queue drops the command");
+
+			SkyCommand command;
+			test->UnitTest(!small.Pop(NULL), "Pop catches NULL");
+			test->UnitTest(small.Pop(&command) && command.value == 0.0f, "Pop takes the oldest");
+			test->UnitTest(small.PushMoonPhase(5.0f), "Popping makes room");
+
+			bool inOrder = true;
+			float expected[4] = { 1.0f, 2.0f, 3.0f, 5.0f };
+			for (int i = 0; i < 4; i++)
+			{
+				if (!small.Pop(&command) || command.value != expected[i])
+					inOrder = false;
+			}
+			test->UnitTest(inOrder && !small.Pop(&command), "First in first out around the ring");
+
+			//many producers at once
+			SkyCommandQueue shared(64);
+			_ProducerData producers[_NumProducers];
+			std::thread threads[_NumProducers];
+
+			for (int p = 0; p < _NumProducers; p++)
+			{
+				producers[p].queue = &shared;
+				producers[p].producer = p;
+				producers[p].retries = 0;
+				threads[p] = std::thread(&_Producer, &producers[p]);
+			}
+
+			int next[_NumProducers] = { 0 };
+			int received = 0;
+			bool producerOrder = true;
+
+			while (received < _NumProducers * _CommandsPerProducer)
+			{
+				if (!shared.Pop(&command))
+				{
+					std::this_thread::yield();
+					continue;
+				}
+
+				int value = (int)command.value;
+				int producer = value / 1000000;
+
+				if ((producer < 0) || (producer >= _NumProducers) || (value % 1000000 != next[producer]))
+					producerOrder = false;
+				else
+					next[producer]++;
+
+				received++;
+			}
+
+			for (int p = 0; p < _NumProducers; p++)
+				threads[p].join();
+
+			test->UnitTest(producerOrder, "Each producer's commands arrive once and in order");
+			test->UnitTest(!shared.Pop(&command), "Nothing extra");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
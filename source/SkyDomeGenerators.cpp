@@ -0,0 +1,671 @@
+/**
+* @file SkyDomeGenerators.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the icosphere and densified sky dome functions defined in
+* BIOSkyFunctions.hpp.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "BIOSkyFunctions.hpp"
+#include "DomeGeometryBuilder.hpp"
+#include "SkyDome.hpp"
+#include "Allocator.hpp"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			//scratch containers use the library allocator
+			typedef std::vector<Vector3D, StlAllocator<Vector3D> > _VertexList;
+			typedef std::vector<unsigned int, StlAllocator<unsigned int> > _IndexList;
+			typedef std::vector<float, StlAllocator<float> > _FloatList;
+			typedef std::vector<int, StlAllocator<int> > _IntList;
+			typedef std::map<unsigned long long, unsigned int, std::less<unsigned long long>, StlAllocator<std::pair<const unsigned long long, unsigned int> > > _MidpointMap;
+
+			inline Vector3D _Normalize(const Vector3D & v)
+			{
+				float length = std::sqrt(v.X * v.X + v.Y * v.Y + v.Z * v.Z);
+				return Vector3D(v.X / length, v.Y / length, v.Z / length);
+			}
+
+			/**
+			* Make every triangle face the inside of the dome, the same as
+			* CreateSkyDomeGeometry.
+			*/
+			void _FaceInward(const _VertexList & verts, _IndexList & indecies)
+			{
+				for (std::size_t t = 0; t + 2 < indecies.size(); t += 3)
+				{
+					const Vector3D & a = verts[indecies[t]];
+					const Vector3D & b = verts[indecies[t + 1]];
+					const Vector3D & c = verts[indecies[t + 2]];
+
+					float e1x = b.X - a.X, e1y = b.Y - a.Y, e1z = b.Z - a.Z;
+					float e2x = c.X - a.X, e2y = c.Y - a.Y, e2z = c.Z - a.Z;
+
+					float nx = e1y * e2z - e1z * e2y;
+					float ny = e1z * e2x - e1x * e2z;
+					float nz = e1x * e2y - e1y * e2x;
+
+					if (nx * (a.X + b.X + c.X) + ny * (a.Y + b.Y + c.Y) + nz * (a.Z + b.Z + c.Z) > 0.0f)
+					{
+						unsigned int tmp = indecies[t + 1];
+						indecies[t + 1] = indecies[t + 2];
+						indecies[t + 2] = tmp;
+					}
+				}
+			}
+
+			/**
+			* Copy unit sphere vertecies and triangles into a RawGeometry,
+			* scaling to the radius and adding the dome UV coordinates.
+			*/
+			RawGeometry * _CreateGeometry(float radius, const _VertexList & verts, const _IndexList & indecies)
+			{
+				RawGeometry * rtnVal = new RawGeometry();
+
+				int numVerts = (int)verts.size();
+				int numIndecies = (int)indecies.size();
+
+				rtnVal->AllocateArrays(numVerts, numIndecies, numVerts > 65535);
+
+				for (int i = 0; i < numVerts; i++)
+				{
+					Vector3D & v = rtnVal->vertecies[i];
+					v.X = verts[i].X * radius;
+					v.Y = verts[i].Y * radius;
+					v.Z = verts[i].Z * radius;
+
+					//the UV is a projection from the bottom of the sphere
+					float below = radius + v.Y;
+
+					if (below > radius * 0.000001f)
+					{
+						rtnVal->UVTextureCoordinates[i].X = (v.X / (2 * below)) + 0.5f;
+						rtnVal->UVTextureCoordinates[i].Y = (v.Z / (2 * below)) + 0.5f;
+					}
+					else
+					{
+						rtnVal->UVTextureCoordinates[i].X = rtnVal->UVTextureCoordinates[i].Y = 0.5f;
+					}
+				}
+
+				for (int i = 0; i < numIndecies; i++)
+				{
+					if (rtnVal->indecies32)
+						rtnVal->indecies32[i] = indecies[i];
+					else
+						rtnVal->indecies[i] = (unsigned short)indecies[i];
+				}
+
+				return rtnVal;
+			}
+
+			/**
+			* Get the vertex halfway along an edge, creating it the first
+			* time the edge is split.
+			*/
+			unsigned int _Midpoint(_VertexList & verts, _MidpointMap & midpoints, unsigned int a, unsigned int b)
+			{
+				unsigned long long key = (a < b) ?
+					((unsigned long long)a << 32) | b :
+					((unsigned long long)b << 32) | a;
+
+				_MidpointMap::iterator found = midpoints.find(key);
+
+				if (found != midpoints.end())
+					return found->second;
+
+				Vector3D m((verts[a].X + verts[b].X) * 0.5f, (verts[a].Y + verts[b].Y) * 0.5f, (verts[a].Z + verts[b].Z) * 0.5f);
+
+				//keep the horizon exactly flat
+				bool horizon = (m.Y > -0.000001f && m.Y < 0.000001f);
+
+				m = _Normalize(m);
+
+				if (horizon)
+					m.Y = 0.0f;
+
+				unsigned int index = (unsigned int)verts.size();
+				verts.push_back(m);
+				midpoints[key] = index;
+
+				return index;
+			}
+
+			/**
+			* Stitch two rings of vertecies together. The rings both start
+			* at angle 0 and may have different numbers of vertecies.
+			*/
+			void _StitchRings(unsigned int upper, int numUpper, unsigned int lower, int numLower, _IndexList & indecies)
+			{
+				int i = 0;
+				int j = 0;
+
+				while (i < numUpper || j < numLower)
+				{
+					//advance the ring whose next vertex has the smaller angle
+					bool advanceLower = (j < numLower) &&
+						(i >= numUpper || (long long)(j + 1) * numUpper <= (long long)(i + 1) * numLower);
+
+					if (advanceLower)
+					{
+						indecies.push_back(upper + (i % numUpper));
+						indecies.push_back(lower + (j % numLower));
+						indecies.push_back(lower + ((j + 1) % numLower));
+						j++;
+					}
+					else
+					{
+						indecies.push_back(upper + (i % numUpper));
+						indecies.push_back(lower + (j % numLower));
+						indecies.push_back(upper + ((i + 1) % numUpper));
+						i++;
+					}
+				}
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		RawGeometry * CreateIcosphereDomeGeometry(float radius, int subdivisions, bool fullDome)
+		{
+			if (subdivisions < 0)
+				subdivisions = 0;
+
+			//the horizon loop is made by the first split, so a hemisphere
+			//needs at least one
+			if (!fullDome && subdivisions < 1)
+				subdivisions = 1;
+
+			//an icosahedron with a vertex at the zenith
+			_VertexList verts;
+			_IndexList indecies;
+
+			float ringHeight = 1.0f / std::sqrt(5.0f);
+			float ringRadius = 2.0f / std::sqrt(5.0f);
+
+			verts.push_back(Vector3D(0.0f, 1.0f, 0.0f));
+
+			for (int k = 0; k < 5; k++)
+			{
+				float angle = k * MATH::PIx2f / 5.0f;
+				verts.push_back(Vector3D(ringRadius * std::cos(angle), ringHeight, ringRadius * std::sin(angle)));
+			}
+
+			for (int k = 0; k < 5; k++)
+			{
+				float angle = (k + 0.5f) * MATH::PIx2f / 5.0f;
+				verts.push_back(Vector3D(ringRadius * std::cos(angle), -ringHeight, ringRadius * std::sin(angle)));
+			}
+
+			verts.push_back(Vector3D(0.0f, -1.0f, 0.0f));
+
+			for (int k = 0; k < 5; k++)
+			{
+				unsigned int u0 = 1 + k;
+				unsigned int u1 = 1 + ((k + 1) % 5);
+				unsigned int l0 = 6 + k;
+				unsigned int l1 = 6 + ((k + 1) % 5);
+
+				unsigned int faces[12] = { 0, u0, u1, u0, l0, u1, u1, l0, l1, 11, l1, l0 };
+				indecies.insert(indecies.end(), faces, faces + 12);
+			}
+
+			//split every triangle into 4
+			for (int s = 0; s < subdivisions; s++)
+			{
+				_MidpointMap midpoints;
+				_IndexList next;
+				next.reserve(indecies.size() * 4);
+
+				for (std::size_t t = 0; t < indecies.size(); t += 3)
+				{
+					unsigned int a = indecies[t];
+					unsigned int b = indecies[t + 1];
+					unsigned int c = indecies[t + 2];
+
+					unsigned int ab = _Midpoint(verts, midpoints, a, b);
+					unsigned int bc = _Midpoint(verts, midpoints, b, c);
+					unsigned int ca = _Midpoint(verts, midpoints, c, a);
+
+					unsigned int faces[12] = { a, ab, ca, ab, b, bc, ca, bc, c, ab, bc, ca };
+					next.insert(next.end(), faces, faces + 12);
+				}
+
+				indecies.swap(next);
+			}
+
+			if (!fullDome)
+			{
+				//keep the triangles on or above the horizon
+				_IntList remap(verts.size(), -1);
+				_VertexList keptVerts;
+				_IndexList keptIndecies;
+
+				for (std::size_t t = 0; t < indecies.size(); t += 3)
+				{
+					if (verts[indecies[t]].Y < -0.0001f || verts[indecies[t + 1]].Y < -0.0001f || verts[indecies[t + 2]].Y < -0.0001f)
+						continue;
+
+					for (int k = 0; k < 3; k++)
+					{
+						unsigned int v = indecies[t + k];
+
+						if (remap[v] < 0)
+						{
+							remap[v] = (int)keptVerts.size();
+							keptVerts.push_back(verts[v]);
+						}
+
+						keptIndecies.push_back((unsigned int)remap[v]);
+					}
+				}
+
+				verts.swap(keptVerts);
+				indecies.swap(keptIndecies);
+			}
+
+			_FaceInward(verts, indecies);
+
+			DomeGeometryBuilder::OptimizeVertexCache(&indecies[0], (int)indecies.size(), (int)verts.size());
+
+			return _CreateGeometry(radius, verts, indecies);
+		}
+
+		float DefaultDomeDensity(float zenith, void *)
+		{
+			//distance from the horizon in radians
+			float fromHorizon = (zenith - MATH::PId2f) / 0.35f;
+
+			return 1.0f + 3.0f * std::exp(-fromHorizon * fromHorizon);
+		}
+
+		RawGeometry * CreateDensifiedSkyDomeGeometry(float radius, int numRings, int maxSegments, bool fullDome, DomeDensityFunction density, void * userData)
+		{
+			if (numRings < 1)
+				numRings = 1;
+
+			if (fullDome && numRings < 2)
+				numRings = 2;
+
+			if (maxSegments < 3)
+				maxSegments = 3;
+
+			if (density == NULL)
+				density = &DefaultDomeDensity;
+
+			float maxZenith = (fullDome) ? MATH::PIf : MATH::PId2f;
+
+			//integrate the density from the zenith down
+			const int steps = 2048;
+			_FloatList cumulative(steps + 1, 0.0f);
+
+			for (int i = 1; i <= steps; i++)
+			{
+				float z = (i - 0.5f) * maxZenith / steps;
+				cumulative[i] = cumulative[i - 1] + density(z, userData);
+			}
+
+			//place the rings at equal steps of the integral
+			int numInnerRings = (fullDome) ? numRings - 1 : numRings;
+			_FloatList ringZenith(numInnerRings);
+			_IntList ringSegments(numInnerRings);
+
+			int step = 0;
+			float maxWeight = 0.0f;
+
+			for (int k = 0; k < numInnerRings; k++)
+			{
+				float target = cumulative[steps] * (k + 1) / numRings;
+
+				while (step < steps && cumulative[step + 1] < target)
+					step++;
+
+				float z = maxZenith;
+
+				if (step < steps)
+				{
+					float into = (target - cumulative[step]) / (cumulative[step + 1] - cumulative[step]);
+					z = (step + into) * maxZenith / steps;
+				}
+
+				if (!fullDome && k == numInnerRings - 1)
+					z = MATH::PId2f;
+
+				ringZenith[k] = z;
+
+				float weight = std::sin(z) * density(z, userData);
+				maxWeight = (weight > maxWeight) ? weight : maxWeight;
+			}
+
+			for (int k = 0; k < numInnerRings; k++)
+			{
+				//segments follow the size of the ring and the density
+				float weight = std::sin(ringZenith[k]) * density(ringZenith[k], userData);
+				int segments = (int)(maxSegments * weight / maxWeight + 0.5f);
+
+				segments = (segments < 3) ? 3 : segments;
+				segments = (segments > maxSegments) ? maxSegments : segments;
+
+				ringSegments[k] = segments;
+			}
+
+			//vertecies
+			_VertexList verts;
+			_IndexList ringStart(numInnerRings);
+
+			verts.push_back(Vector3D(0.0f, 1.0f, 0.0f));
+
+			for (int k = 0; k < numInnerRings; k++)
+			{
+				ringStart[k] = (unsigned int)verts.size();
+
+				float height = std::cos(ringZenith[k]);
+				float size = std::sin(ringZenith[k]);
+
+				if (ringZenith[k] == MATH::PId2f)
+					height = 0.0f;
+
+				for (int j = 0; j < ringSegments[k]; j++)
+				{
+					float angle = j * MATH::PIx2f / ringSegments[k];
+					verts.push_back(Vector3D(size * std::cos(angle), height, size * std::sin(angle)));
+				}
+			}
+
+			unsigned int bottom = (unsigned int)verts.size();
+
+			if (fullDome)
+				verts.push_back(Vector3D(0.0f, -1.0f, 0.0f));
+
+			//indecies, in the same band order as CreateSkyDomeGeometry
+			_IndexList indecies;
+
+			for (int j = 0; j < ringSegments[0]; j++)
+			{
+				indecies.push_back(0);
+				indecies.push_back(ringStart[0] + j);
+				indecies.push_back(ringStart[0] + ((j + 1) % ringSegments[0]));
+			}
+
+			for (int k = 0; k + 1 < numInnerRings; k++)
+				_StitchRings(ringStart[k], ringSegments[k], ringStart[k + 1], ringSegments[k + 1], indecies);
+
+			if (fullDome)
+			{
+				int last = numInnerRings - 1;
+
+				for (int j = 0; j < ringSegments[last]; j++)
+				{
+					indecies.push_back(ringStart[last] + j);
+					indecies.push_back(bottom);
+					indecies.push_back(ringStart[last] + ((j + 1) % ringSegments[last]));
+				}
+			}
+
+			return _CreateGeometry(radius, verts, indecies);
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* Check that every triangle faces the center of the dome and that
+			* every edge is shared by exactly 2 triangles, except for edges
+			* on the horizon of a hemisphere.
+			*/
+			bool _CheckDome(const RawGeometry * geometry, bool fullDome, float radius)
+			{
+				std::map<unsigned long long, int> edges;
+
+				for (int t = 0; t + 2 < geometry->numIndecies; t += 3)
+				{
+					unsigned int idx[3] = { geometry->GetIndex(t), geometry->GetIndex(t + 1), geometry->GetIndex(t + 2) };
+
+					const Vector3D & a = geometry->vertecies[idx[0]];
+					const Vector3D & b = geometry->vertecies[idx[1]];
+					const Vector3D & c = geometry->vertecies[idx[2]];
+
+					float nx = (b.Y - a.Y) * (c.Z - a.Z) - (b.Z - a.Z) * (c.Y - a.Y);
+					float ny = (b.Z - a.Z) * (c.X - a.X) - (b.X - a.X) * (c.Z - a.Z);
+					float nz = (b.X - a.X) * (c.Y - a.Y) - (b.Y - a.Y) * (c.X - a.X);
+
+					if (nx * (a.X + b.X + c.X) + ny * (a.Y + b.Y + c.Y) + nz * (a.Z + b.Z + c.Z) >= 0.0f)
+						return false;
+
+					for (int k = 0; k < 3; k++)
+					{
+						unsigned int v0 = idx[k];
+						unsigned int v1 = idx[(k + 1) % 3];
+
+						//each directed edge once
+						unsigned long long key = ((unsigned long long)v0 << 32) | v1;
+						if (++edges[key] > 1)
+							return false;
+					}
+				}
+
+				for (std::map<unsigned long long, int>::iterator it = edges.begin(); it != edges.end(); ++it)
+				{
+					unsigned int v0 = (unsigned int)(it->first >> 32);
+					unsigned int v1 = (unsigned int)(it->first & 0xFFFFFFFF);
+
+					if (edges.find(((unsigned long long)v1 << 32) | v0) == edges.end())
+					{
+						//open edges are only allowed on the horizon
+						if (fullDome || geometry->vertecies[v0].Y != 0.0f || geometry->vertecies[v1].Y != 0.0f)
+							return false;
+					}
+				}
+
+				for (int i = 0; i < geometry->numVertecies; i++)
+				{
+					const Vector3D & v = geometry->vertecies[i];
+					float length = std::sqrt(v.X * v.X + v.Y * v.Y + v.Z * v.Z);
+
+					if (std::fabs(length - radius) > radius * 0.0001f)
+						return false;
+
+					if (!fullDome && v.Y < 0.0f)
+						return false;
+				}
+
+				return true;
+			}
+
+			float _ConstantDensity(float, void *)
+			{
+				return 1.0f;
+			}
+
+			/**
+			* Compare a SkyDome with the DomeGeometryBuilder dome of the same
+			* size.
+			*/
+			template <int numVerticalSegments, int numHorozontalSegments, bool fullDome>
+			bool _SameAsBuilder(const SkyDome<numVerticalSegments, numHorozontalSegments, fullDome> & dome)
+			{
+				RawGeometry * built = DomeGeometryBuilder(1.0f, numVerticalSegments, numHorozontalSegments, fullDome).Build();
+
+				bool same = (built->numVertecies == dome.NumVertecies && built->numIndecies == dome.NumIndecies);
+
+				for (int i = 0; same && i < built->numVertecies; i++)
+				{
+					if (std::fabs(built->vertecies[i].X - dome.vertecies[i][0]) > 0.00001f ||
+						std::fabs(built->vertecies[i].Y - dome.vertecies[i][1]) > 0.00001f ||
+						std::fabs(built->vertecies[i].Z - dome.vertecies[i][2]) > 0.00001f ||
+						std::fabs(built->UVTextureCoordinates[i].X - dome.UVTextureCoordinates[i][0]) > 0.00001f ||
+						std::fabs(built->UVTextureCoordinates[i].Y - dome.UVTextureCoordinates[i][1]) > 0.00001f)
+						same = false;
+				}
+
+				for (int i = 0; same && i < built->numIndecies; i++)
+				{
+					if (built->GetIndex(i) != dome.indecies[i])
+						same = false;
+				}
+
+				delete built;
+
+				return same;
+			}
+
+			static BIOSKY_CONSTEXPR const SkyDome<16, 8, false> _TestHemisphere;
+			static BIOSKY_CONSTEXPR const SkyDome<12, 6, true> _TestSphere;
+
+#if BIOSKY_HAS_CONSTEXPR
+			static_assert(_TestHemisphere.vertecies[0][1] == 1.0f && _TestHemisphere.vertecies[8 * 16][1] == 0.0f, "The sky dome is built at compile time.");
+#endif
+		}
+
+		bool DomeGeneratorTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Dome Generator Tests");
+
+			//icosphere
+			RawGeometry * ico = CreateIcosphereDomeGeometry(2.0f, 0, true);
+			test->UnitTest(ico->numVertecies == 12 && ico->numIndecies == 60, "Icosahedron size");
+			test->UnitTest(_CheckDome(ico, true, 2.0f), "Icosahedron is closed and faces inward");
+			delete ico;
+
+			ico = CreateIcosphereDomeGeometry(2.0f, 3, true);
+			test->UnitTest(ico->numVertecies == 642 && ico->numIndecies == 1280 * 3, "Icosphere size");
+			test->UnitTest(_CheckDome(ico, true, 2.0f), "Icosphere is closed and faces inward");
+			delete ico;
+
+			ico = CreateIcosphereDomeGeometry(2.0f, 3, false);
+			test->UnitTest(ico->numIndecies == 640 * 3, "Icosphere hemisphere triangles");
+			test->UnitTest(_CheckDome(ico, false, 2.0f), "Icosphere hemisphere rim is on the horizon");
+
+			bool hasZenith = false;
+			for (int i = 0; i < ico->numVertecies; i++)
+			{
+				if (ico->vertecies[i].Y == 2.0f)
+					hasZenith = true;
+			}
+			test->UnitTest(hasZenith, "Icosphere has a zenith vertex");
+			test->UnitTest(ico->UVTextureCoordinates[0].X >= 0.0f && ico->UVTextureCoordinates[0].X <= 1.0f, "Icosphere UV");
+			delete ico;
+
+			//a hemisphere always reaches the horizon
+			ico = CreateIcosphereDomeGeometry(1.0f, 0, false);
+			test->UnitTest(ico->numIndecies == 40 * 3, "Unsplit hemisphere uses one split");
+
+			int rimCount = 0;
+			for (int i = 0; i < ico->numVertecies; i++)
+			{
+				if (ico->vertecies[i].Y == 0.0f)
+					rimCount++;
+			}
+			test->UnitTest(rimCount == 10 && _CheckDome(ico, false, 1.0f), "Unsplit hemisphere rim is on the horizon");
+			delete ico;
+
+			ico = CreateIcosphereDomeGeometry(1.0f, 7, true);
+			test->UnitTest(ico->numVertecies == 163842 && ico->indecies32 != NULL, "Large icosphere uses 32 bit indecies");
+			delete ico;
+
+			//densified dome
+			RawGeometry * dome = CreateDensifiedSkyDomeGeometry(3.0f, 16, 48, false);
+			test->UnitTest(_CheckDome(dome, false, 3.0f), "Densified hemisphere faces inward");
+
+			//the horizon ring is the densest and the zenith ring the sparsest
+			int horizonCount = 0;
+			float lowestRing = 3.0f;
+			for (int i = 0; i < dome->numVertecies; i++)
+			{
+				if (dome->vertecies[i].Y == 0.0f)
+					horizonCount++;
+				else if (dome->vertecies[i].Y < lowestRing)
+					lowestRing = dome->vertecies[i].Y;
+			}
+			test->UnitTest(horizonCount == 48, "Densified horizon ring");
+			test->UnitTest(lowestRing < 3.0f * std::cos(MATH::PId2f * 15.0f / 16.0f), "Densified rings bunch near the horizon");
+			test->UnitTest(dome->GetIndex(1) == 1 && dome->GetIndex(2) != 1, "Densified cap");
+
+			RawGeometry * latLong = CreateSkyDomeGeometry(3.0f, 48, 16, false);
+			test->UnitTest(dome->numVertecies < latLong->numVertecies, "Densified dome uses fewer vertecies");
+			delete latLong;
+			delete dome;
+
+			dome = CreateDensifiedSkyDomeGeometry(1.0f, 12, 36, true);
+			test->UnitTest(_CheckDome(dome, true, 1.0f), "Densified sphere is closed and faces inward");
+			delete dome;
+
+			//constant density spaces the rings evenly
+			dome = CreateDensifiedSkyDomeGeometry(1.0f, 8, 24, false, &_ConstantDensity);
+			bool even = true;
+			int vertOn = 1;
+			for (int k = 1; k <= 8 && vertOn < dome->numVertecies; k++)
+			{
+				float expected = std::cos(k * MATH::PId2f / 8.0f);
+
+				if (std::fabs(dome->vertecies[vertOn].Y - expected) > 0.001f)
+					even = false;
+
+				//skip to the next ring
+				float y = dome->vertecies[vertOn].Y;
+				while (vertOn < dome->numVertecies && dome->vertecies[vertOn].Y == y)
+					vertOn++;
+			}
+			test->UnitTest(even, "Constant density rings");
+			test->UnitTest(_CheckDome(dome, false, 1.0f), "Constant density dome");
+			delete dome;
+
+			//compile time domes
+			test->UnitTest(_SameAsBuilder(_TestHemisphere), "SkyDome hemisphere matches the builder");
+			test->UnitTest(_SameAsBuilder(_TestSphere), "SkyDome sphere matches the builder");
+			test->UnitTest(sizeof(SkyDome<16, 8, false>::IndexType) == 2 && sizeof(SkyDome<512, 256, true>::IndexType) == 4, "SkyDome index size");
+
+			Vector3D domeVerts[_TestSphere.NumVertecies];
+			Vector2D domeUVs[_TestSphere.NumVertecies];
+			unsigned short domeIndecies[_TestSphere.NumIndecies];
+			test->UnitTest(!_TestSphere.CopyTo(2.0f, domeVerts, domeUVs, _TestSphere.NumVertecies - 1, domeIndecies, _TestSphere.NumIndecies), "SkyDome buffer too small");
+			test->UnitTest(_TestSphere.CopyTo(2.0f, domeVerts, domeUVs, _TestSphere.NumVertecies, domeIndecies, _TestSphere.NumIndecies) &&
+				domeVerts[_TestSphere.NumVertecies - 1].Y == -2.0f, "SkyDome copied with a radius");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
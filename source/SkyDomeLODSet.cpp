@@ -0,0 +1,329 @@
+/**
+* @file SkyDomeLODSet.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the SkyDomeLODSet class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "SkyDomeLODSet.hpp"
+#include "DomeGeometryBuilder.hpp"
+#include "MathUtils.hpp"
+#include "Allocator.hpp"
+
+#if BIOSKY_TESTING == 1
+#include <cmath>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			inline unsigned int _ClampColor(int value)
+			{
+				if (value < 0)
+					return 0;
+
+				if (value > 255)
+					return 255;
+
+				return (unsigned int)value;
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		SkyDomeLODSet::SkyDomeLODSet(float radius, int numVerticalSegments, int numHorozontalSegments, bool fullDome, int numLevels) :
+			_fullDome(fullDome),
+			_numLevels(0),
+			_numVerticalSegments(0),
+			_numHorozontalSegments(0),
+			_levels(NULL),
+			_vertexMaps(NULL),
+			_colors(NULL)
+		{
+			if (numVerticalSegments < 4)
+				numVerticalSegments = 4;
+
+			if (numHorozontalSegments < 2)
+				numHorozontalSegments = 2;
+
+			if (numLevels < 1)
+				numLevels = 1;
+
+			while (numLevels > 1 && (numVerticalSegments >> (numLevels - 1)) < 4)
+				numLevels--;
+
+			//every level needs whole vertical segments and an even number
+			//of horozontal segments
+			int verticalStep = 1 << (numLevels - 1);
+			int horozontalStep = 1 << numLevels;
+
+			_numLevels = numLevels;
+			_numVerticalSegments = ((numVerticalSegments + verticalStep - 1) / verticalStep) * verticalStep;
+			_numHorozontalSegments = ((numHorozontalSegments + horozontalStep - 1) / horozontalStep) * horozontalStep;
+
+			_levels = AllocateArray<RawGeometry *>(_numLevels);
+			_vertexMaps = AllocateArray<int *>(_numLevels);
+
+			int fineVerts = 0;
+
+			for (int level = 0; level < _numLevels; level++)
+			{
+				int numVertical = _numVerticalSegments >> level;
+				int numHorozontal = _numHorozontalSegments >> level;
+
+				DomeGeometryBuilder builder(radius, numVertical, numHorozontal, fullDome);
+				_levels[level] = builder.Build();
+
+				int numVerts = _levels[level]->numVertecies;
+				int * map = AllocateArray<int>(numVerts);
+
+				if (level == 0)
+					fineVerts = numVerts;
+
+				//ring i of this level is ring ((i + 1) << level) - 1 of
+				//level 0, and segment j is segment j << level.
+				int numRings = (fullDome) ? numHorozontal - 1 : numHorozontal;
+				int vertOn = 1;
+
+				map[0] = 0;
+
+				for (int i = 0; i < numRings; i++)
+				{
+					int fineRing = ((i + 1) << level) - 1;
+
+					for (int j = 0; j < numVertical; j++)
+						map[vertOn++] = 1 + fineRing * _numVerticalSegments + (j << level);
+				}
+
+				if (fullDome)
+					map[vertOn] = fineVerts - 1;
+
+				_vertexMaps[level] = map;
+			}
+
+			_colors = AllocateArray<unsigned int>(fineVerts);
+			_finest.owner = this;
+		}
+
+		SkyDomeLODSet::~SkyDomeLODSet()
+		{
+			for (int level = 0; level < _numLevels; level++)
+			{
+				delete _levels[level];
+				FreeArray(_vertexMaps[level]);
+			}
+
+			FreeArray(_levels);
+			FreeArray(_vertexMaps);
+			FreeArray(_colors);
+		}
+
+		void SkyDomeLODSet::CopyColors(int level, IDomeVertecies * target) const
+		{
+			if (target == NULL)
+				return;
+
+			level = _ClampLevel(level);
+
+			const int * map = _vertexMaps[level];
+			int numVerts = _levels[level]->numVertecies;
+
+			for (int i = 0; i < numVerts; i++)
+			{
+				unsigned int color = _colors[map[i]];
+
+				target->SetVertexColor(i, (int)(color >> 24), (int)((color >> 16) & 0xFF), (int)((color >> 8) & 0xFF), (int)(color & 0xFF));
+			}
+		}
+
+		int SkyDomeLODSet::SelectLOD(int viewportHeight, float fieldOfView, float maxPixelsPerBand) const
+		{
+			if (viewportHeight <= 0)
+				return _numLevels - 1;
+
+			if (fieldOfView <= 0.0f)
+				return 0;
+
+			//the angle of one band of level 0
+			float bandAngle = ((_fullDome) ? MATH::PIf : MATH::PId2f) / _numHorozontalSegments;
+			float pixelsPerRadian = viewportHeight / fieldOfView;
+
+			for (int level = _numLevels - 1; level > 0; level--)
+			{
+				if (bandAngle * (1 << level) * pixelsPerRadian <= maxPixelsPerBand)
+					return level;
+			}
+
+			return 0;
+		}
+
+		int SkyDomeLODSet::_FinestVertecies::GetVertexCount()
+		{
+			return owner->_levels[0]->numVertecies;
+		}
+
+		Vector3D SkyDomeLODSet::_FinestVertecies::GetVertexPosition(int index)
+		{
+			return owner->_levels[0]->vertecies[index];
+		}
+
+		void SkyDomeLODSet::_FinestVertecies::SetVertexColor(int index, int A, int R, int G, int B)
+		{
+			owner->_colors[index] = (_ClampColor(A) << 24) | (_ClampColor(R) << 16) | (_ClampColor(G) << 8) | _ClampColor(B);
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* Records the colors set on it.
+			*/
+			class _ColorRecorder : public IDomeVertecies
+			{
+			public:
+				unsigned int colors[4096];
+				int count;
+
+				_ColorRecorder() : count(0) {}
+
+				virtual int GetVertexCount() { return count; }
+				virtual Vector3D GetVertexPosition(int) { return Vector3D(); }
+				virtual void SetVertexColor(int index, int A, int R, int G, int B)
+				{
+					if (index < 4096)
+						colors[index] = ((unsigned int)A << 24) | ((unsigned int)R << 16) | ((unsigned int)G << 8) | (unsigned int)B;
+
+					if (index + 1 > count)
+						count = index + 1;
+				}
+			};
+		}
+
+		bool SkyDomeLODSet::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Sky Dome LOD Set Tests");
+
+			SkyDomeLODSet lods(2.0f, 60, 30, false, 4);
+
+			test->UnitTest(lods.GetLevelCount() == 4, "Level count");
+			test->UnitTest(lods.GetVerticalSegments(0) == 64 && lods.GetHorozontalSegments(0) == 32, "Segments rounded up");
+			test->UnitTest(lods.GetVerticalSegments(3) == 8 && lods.GetHorozontalSegments(3) == 4, "Coarsest segments");
+			test->UnitTest(lods.GetLevelGeometry(1)->numVertecies == 32 * 16 + 1, "Level 1 vertecies");
+			test->UnitTest(lods.GetLevelGeometry(10) == lods.GetLevelGeometry(3), "Level is clamped");
+
+			//every coarse vertex is on a level 0 vertex
+			bool nested = true;
+			const RawGeometry * finest = lods.GetLevelGeometry(0);
+			for (int level = 1; level < lods.GetLevelCount(); level++)
+			{
+				const RawGeometry * geometry = lods.GetLevelGeometry(level);
+				const int * map = lods.GetLevelVertexMap(level);
+
+				for (int i = 0; i < geometry->numVertecies; i++)
+				{
+					const Vector3D & a = geometry->vertecies[i];
+					const Vector3D & b = finest->vertecies[map[i]];
+
+					if (std::fabs(a.X - b.X) > 0.0001f || std::fabs(a.Y - b.Y) > 0.0001f || std::fabs(a.Z - b.Z) > 0.0001f)
+						nested = false;
+				}
+			}
+			test->UnitTest(nested, "Levels are nested");
+
+			//colors come from level 0
+			IDomeVertecies * verts = lods.GetFinestVertecies();
+			test->UnitTest(verts->GetVertexCount() == finest->numVertecies, "Finest vertex count");
+
+			for (int i = 0; i < verts->GetVertexCount(); i++)
+				verts->SetVertexColor(i, 255, i & 0xFF, (i >> 8) & 0xFF, 7);
+
+			_ColorRecorder recorder;
+			lods.CopyColors(2, &recorder);
+
+			bool copied = (recorder.count == lods.GetLevelGeometry(2)->numVertecies);
+			const int * map = lods.GetLevelVertexMap(2);
+			for (int i = 0; i < recorder.count; i++)
+			{
+				unsigned int expected = 0xFF000000 | ((map[i] & 0xFF) << 16) | (((map[i] >> 8) & 0xFF) << 8) | 7;
+
+				if (recorder.colors[i] != expected || lods.GetColor(2, i) != expected)
+					copied = false;
+			}
+			test->UnitTest(copied, "Colors are subsampled");
+
+			verts->SetVertexColor(0, 300, -5, 128, 255);
+			test->UnitTest(lods.GetColor(0, 0) == 0xFF0080FF, "Colors are clamped");
+
+			//full dome bottom pole
+			SkyDomeLODSet full(1.0f, 16, 8, true, 3);
+			const RawGeometry * coarse = full.GetLevelGeometry(2);
+			int bottom = full.GetLevelVertexMap(2)[coarse->numVertecies - 1];
+			test->UnitTest(bottom == full.GetLevelGeometry(0)->numVertecies - 1, "Bottom pole maps to the bottom pole");
+			test->UnitTest(std::fabs(coarse->vertecies[coarse->numVertecies - 1].Y + 1.0f) < 0.0001f, "Bottom pole position");
+
+			//too many levels
+			SkyDomeLODSet small(1.0f, 8, 4, false, 8);
+			test->UnitTest(small.GetLevelCount() == 2, "Levels are limited");
+
+			//selection. A level 0 band is 0.049 radians.
+			test->UnitTest(lods.SelectLOD(1080, 1.0f) == 0, "Full screen view uses level 0");
+			test->UnitTest(lods.SelectLOD(120, 1.0f) == 2, "Picture in picture view");
+			test->UnitTest(lods.SelectLOD(40, 1.0f) == 3, "Tiny view uses the coarsest level");
+			test->UnitTest(lods.SelectLOD(540, 1.0f) == 0 && lods.SelectLOD(540, 1.0f, 60.0f) == 1, "Pixels per band");
+			test->UnitTest(lods.SelectLOD(0, 1.0f) == 3 && lods.SelectLOD(100, 0.0f) == 0, "Bad views");
+
+			bool monotonic = true;
+			int last = lods.GetLevelCount() - 1;
+			for (int height = 1; height <= 4096; height *= 2)
+			{
+				int level = lods.SelectLOD(height, 1.2f);
+
+				if (level > last)
+					monotonic = false;
+
+				last = level;
+			}
+			test->UnitTest(monotonic, "Bigger views never use coarser levels");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,789 @@
+/**
+* @file SkyEvents.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implements the sun and moon event solver.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "SkyEvents.hpp"
+#include "BIOSkyFunctions.hpp"
+#include "Ephemeris.hpp"
+#include "MathUtils.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if BIOSKY_TESTING == 1
+#include "Allocator.hpp"
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**The samples of each day, one every hour from 0 to 24.*/
+			const int _NumSamples = 25;
+
+			/**Events are refined to a tenth of a second (in hours).*/
+			const double _Tolerance = 0.1 / 3600.0;
+
+			/**Brent's method stops here even if it has not converged.*/
+			const int _MaxIterations = 50;
+
+			/**The zenith of the center of the sun at sunrise and sunset.*/
+			const float _SunriseZenith = (90.0f + 0.833f) * MATH::DegreesToRadiansf;
+
+			/**The zenith of the center of the moon at moonrise and moonset.*/
+			const float _MoonriseZenith = (90.0f - 0.125f) * MATH::DegreesToRadiansf;
+
+			enum _BODY
+			{
+				_BODY_SUN = 0,
+				_BODY_MOON
+			};
+
+			enum _CROSSING
+			{
+				/**Rising through the zenith, the function goes - to +.*/
+				_CROSSING_RISE = 0,
+				/**Setting through the zenith, the function goes + to -.*/
+				_CROSSING_SET,
+				/**Crossing the meridian at the top, sin(azimuth) goes + to -.*/
+				_CROSSING_TRANSIT
+			};
+
+			struct _EventDefinition
+			{
+				_BODY body;
+				_CROSSING crossing;
+				float zenith;
+			};
+
+			/**How each SKY_EVENT is found, in the order of SKY_EVENT.*/
+			const _EventDefinition _Events[NumSkyEvents] =
+			{
+				{ _BODY_SUN, _CROSSING_RISE, (90.0f + 18.0f) * MATH::DegreesToRadiansf },
+				{ _BODY_SUN, _CROSSING_RISE, (90.0f + 12.0f) * MATH::DegreesToRadiansf },
+				{ _BODY_SUN, _CROSSING_RISE, (90.0f + 6.0f) * MATH::DegreesToRadiansf },
+				{ _BODY_SUN, _CROSSING_RISE, _SunriseZenith },
+				{ _BODY_SUN, _CROSSING_TRANSIT, 0.0f },
+				{ _BODY_SUN, _CROSSING_SET, _SunriseZenith },
+				{ _BODY_SUN, _CROSSING_SET, (90.0f + 6.0f) * MATH::DegreesToRadiansf },
+				{ _BODY_SUN, _CROSSING_SET, (90.0f + 12.0f) * MATH::DegreesToRadiansf },
+				{ _BODY_SUN, _CROSSING_SET, (90.0f + 18.0f) * MATH::DegreesToRadiansf },
+				{ _BODY_MOON, _CROSSING_RISE, _MoonriseZenith },
+				{ _BODY_MOON, _CROSSING_TRANSIT, 0.0f },
+				{ _BODY_MOON, _CROSSING_SET, _MoonriseZenith }
+			};
+
+			/**What the crossing function needs to know.*/
+			struct _EventData
+			{
+				Timestamp midnight;
+				float latitude;
+				float longitude;
+				_BODY body;
+				_CROSSING crossing;
+				float zenith;
+			};
+
+			SkyPosition _Position(const _EventData & data, double hours)
+			{
+				Timestamp time = data.midnight;
+				time.AddSeconds(hours * 3600.0);
+
+				if (data.body == _BODY_SUN)
+					return CalculateSunPosition(time, data.latitude, data.longitude);
+
+				return CalculateMoonPosition(time, data.latitude, data.longitude);
+			}
+
+			/**
+			* The value that crosses zero at an event. For rising and setting
+			* it is how far the body is above the event's zenith, for a
+			* transit it is sin(azimuth), which is 0 on the meridian.
+			*/
+			double _EventValue(const _EventData & data, const SkyPosition & position)
+			{
+				if (data.crossing == _CROSSING_TRANSIT)
+					return std::sin((double)position.Azimuth);
+
+				return (double)data.zenith - position.Zenith;
+			}
+
+			double _EventFunction(double hours, void * userData)
+			{
+				const _EventData & data = *(const _EventData *)userData;
+				return _EventValue(data, _Position(data, hours));
+			}
+
+			/**
+			* Brent's method (zeroin) on [a, b] where fa and fb have
+			* different signs.
+			*/
+			double _Brent(CrossingFunction function, void * userData, double a, double b, double fa, double fb, double tolerance)
+			{
+				double c = a, fc = fa;
+				double d = b - a, e = d;
+
+				for (int i = 0; i < _MaxIterations; i++)
+				{
+					if ((fb > 0.0) == (fc > 0.0))
+					{
+						c = a;
+						fc = fa;
+						d = e = b - a;
+					}
+
+					//b is the best guess
+					if (std::fabs(fc) < std::fabs(fb))
+					{
+						a = b; b = c; c = a;
+						fa = fb; fb = fc; fc = fa;
+					}
+
+					double tol = 2.0 * DBL_EPSILON * std::fabs(b) + 0.5 * tolerance;
+					double m = 0.5 * (c - b);
+
+					if ((std::fabs(m) <= tol) || (fb == 0.0))
+						return b;
+
+					if ((std::fabs(e) < tol) || (std::fabs(fa) <= std::fabs(fb)))
+					{
+						//bisection
+						d = e = m;
+					}
+					else
+					{
+						double s = fb / fa;
+						double p, q;
+
+						if (a == c)
+						{
+							//secant
+							p = 2.0 * m * s;
+							q = 1.0 - s;
+						}
+						else
+						{
+							//inverse quadratic interpolation
+							double r = fb / fc;
+							q = fa / fc;
+							p = s * (2.0 * m * q * (q - r) - (b - a) * (r - 1.0));
+							q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+						}
+
+						if (p > 0.0)
+							q = -q;
+						else
+							p = -p;
+
+						if (2.0 * p < std::min(3.0 * m * q - std::fabs(tol * q), std::fabs(e * q)))
+						{
+							e = d;
+							d = p / q;
+						}
+						else
+						{
+							d = e = m;
+						}
+					}
+
+					a = b;
+					fa = fb;
+					b += (std::fabs(d) > tol) ? d : ((m > 0.0) ? tol : -tol);
+					fb = function(b, userData);
+				}
+
+				return b;
+			}
+
+			/**
+			* Find the events of the day starting at midnight. The sun and the
+			* moon are each sampled once, and every event of a body is
+			* bracketed from the same samples.
+			*/
+			void _FindEvents(const Timestamp & midnight, float latitude, float longitude, DailyEvents * events)
+			{
+				SkyPosition samples[2][_NumSamples];
+
+				_EventData data;
+				data.midnight = midnight;
+				data.latitude = latitude;
+				data.longitude = longitude;
+
+				for (int body = _BODY_SUN; body <= _BODY_MOON; body++)
+				{
+					data.body = (_BODY)body;
+
+					for (int i = 0; i < _NumSamples; i++)
+						samples[body][i] = _Position(data, (double)i);
+				}
+
+				for (int event = 0; event < NumSkyEvents; event++)
+				{
+					const _EventDefinition & definition = _Events[event];
+					data.body = definition.body;
+					data.crossing = definition.crossing;
+					data.zenith = definition.zenith;
+
+					events->occurs[event] = false;
+
+					double previous = _EventValue(data, samples[definition.body][0]);
+
+					for (int i = 1; i < _NumSamples; i++)
+					{
+						double value = _EventValue(data, samples[definition.body][i]);
+
+						bool found = (definition.crossing == _CROSSING_RISE) ?
+							((previous < 0.0) && (value >= 0.0)) :
+							((previous > 0.0) && (value <= 0.0));
+
+						if (found)
+						{
+							double hours = _Brent(&_EventFunction, &data, i - 1.0, (double)i, previous, value, _Tolerance);
+
+							events->occurs[event] = true;
+							events->hours[event] = (float)hours;
+							events->times[event] = midnight;
+							events->times[event].AddSeconds(hours * 3600.0);
+							break;
+						}
+
+						previous = value;
+					}
+				}
+			}
+
+			/**The mean motion of the moon away from the sun in radians a day.*/
+			const double _SynodicRate = MATH::PIx2 / 29.530588853;
+
+			/**The mean motion of the sun in radians a day.*/
+			const double _TropicalRate = MATH::PIx2 / 365.24219;
+
+			/**Calendar events are refined to about a second (in days).*/
+			const double _CalendarTolerance = 1.0 / 86400.0;
+
+			/**What the calendar crossing function needs to know.*/
+			struct _CalendarData
+			{
+				/**The Julian day (UT) that times are counted from.*/
+				double start;
+				/**True for the moon's elongation, false for the sun's longitude.*/
+				bool moon;
+				/**The angle to find in radians.*/
+				double target;
+			};
+
+			/**
+			* The elongation of the moon or the longitude of the sun, in
+			* radians [0, 2PI), at a Julian day in Universal Time.
+			*/
+			double _CalendarAngle(double julianDay, bool moon)
+			{
+				double year = 2000.0 + (julianDay - 2451545.0) / 365.25;
+				double julianEphemerisDay = julianDay + CalculateDeltaT(year) / 86400.0;
+
+				double sun = CalculateSunEcliptic(julianEphemerisDay).longitude;
+
+				if (!moon)
+					return MATH::RevolutionReduction(sun);
+
+				return MATH::RevolutionReduction(CalculateMoonEcliptic(julianEphemerisDay).longitude - sun);
+			}
+
+			/**
+			* How far past the target the angle is, in radians (-PI, PI].
+			*/
+			double _CalendarFunction(double days, void * userData)
+			{
+				const _CalendarData & data = *(const _CalendarData *)userData;
+				return MATH::PI - MATH::RevolutionReduction(MATH::PI - (_CalendarAngle(data.start + days, data.moon) - data.target));
+			}
+
+			/**
+			* Find every time in [0, span) days after start that the angle
+			* reaches a multiple of 90 degrees. The first guess comes from the
+			* angle at the start and the mean rate, and each one after from
+			* the last crossing, so the bracket only has to cover how far the
+			* real motion strays from the mean over a quarter.
+			*
+			* @return Returns the number of times found.
+			*/
+			int _FindQuarters(double start, double span, bool moon, double * days, int * quarters, int maxQuarters)
+			{
+				const double rate = moon ? _SynodicRate : _TropicalRate;
+				const double window = moon ? 2.5 : 5.0;
+
+				_CalendarData data;
+				data.start = start;
+				data.moon = moon;
+
+				int quarter = (int)std::floor(_CalendarAngle(start, moon) / MATH::PId2) + 1;
+				double guess = (quarter * MATH::PId2 - _CalendarAngle(start, moon)) / rate;
+				int found = 0;
+
+				while ((guess - window < span) && (found < maxQuarters))
+				{
+					data.target = (quarter % 4) * MATH::PId2;
+
+					double root;
+					if (FindCrossing(&_CalendarFunction, &data, guess - window, guess + window, _CalendarTolerance, &root))
+					{
+						if (root >= span)
+							break;
+
+						if (root >= 0.0)
+						{
+							days[found] = root;
+							quarters[found] = quarter % 4;
+							found++;
+						}
+
+						guess = root;
+					}
+
+					guess += MATH::PId2 / rate;
+					quarter++;
+				}
+
+				return found;
+			}
+
+			/**
+			* Find the calendar events of one year in time order.
+			*
+			* @return Returns the number of events, at most
+			*			MaxCalendarEventsPerYear.
+			*/
+			int _FindCalendarYear(unsigned int year, CalendarEvent * events)
+			{
+				Timestamp start = Timestamp::FromCalendar(0.0, 0.0, JANUARY, 1, year);
+				Timestamp end = Timestamp::FromCalendar(0.0, 0.0, JANUARY, 1, year + 1);
+				double span = (double)(end.GetMicroseconds() - start.GetMicroseconds()) / (double)Timestamp::MicrosecondsPerDay;
+
+				double moonDays[MaxCalendarEventsPerYear - 4], sunDays[4];
+				int moonQuarters[MaxCalendarEventsPerYear - 4], sunQuarters[4];
+
+				int numMoon = _FindQuarters(start.GetJulianDay(), span, true, moonDays, moonQuarters, MaxCalendarEventsPerYear - 4);
+				int numSun = _FindQuarters(start.GetJulianDay(), span, false, sunDays, sunQuarters, 4);
+
+				//merge the two lists, which are each in order
+				int moon = 0, sun = 0, count = 0;
+				while ((moon < numMoon) || (sun < numSun))
+				{
+					bool takeMoon = (sun >= numSun) || ((moon < numMoon) && (moonDays[moon] < sunDays[sun]));
+					double days = takeMoon ? moonDays[moon] : sunDays[sun];
+
+					events[count].type = takeMoon ? (CALENDAR_EVENT)(CALENDAR_EVENT_NEW_MOON + moonQuarters[moon]) :
+						(CALENDAR_EVENT)(CALENDAR_EVENT_MARCH_EQUINOX + sunQuarters[sun]);
+					events[count].time = start;
+					events[count].time.AddSeconds(days * 86400.0);
+					count++;
+
+					if (takeMoon)
+						moon++;
+					else
+						sun++;
+				}
+
+				return count;
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		bool FindCrossing(CrossingFunction function, void * userData, double a, double b, double tolerance, double * root)
+		{
+			if ((function == NULL) || (root == NULL))
+				return false;
+
+			double fa = function(a, userData);
+			double fb = function(b, userData);
+
+			if (fa == 0.0)
+			{
+				*root = a;
+				return true;
+			}
+
+			if (fb == 0.0)
+			{
+				*root = b;
+				return true;
+			}
+
+			if ((fa > 0.0) == (fb > 0.0))
+				return false;
+
+			*root = _Brent(function, userData, a, b, fa, fb, tolerance);
+			return true;
+		}
+
+		bool CalculateDailyEvents(float UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year, float latitude, float longitude, DailyEvents * events, int numDays)
+		{
+			if ((events == NULL) || (numDays < 1))
+				return false;
+
+			Date date(month, day, year);
+
+			for (int i = 0; i < numDays; i++)
+			{
+				Timestamp midnight = Timestamp::FromCalendar(0.0, UTCoffset, date.GetMonth(), date.GetDay(), date.GetYear());
+
+				_FindEvents(midnight, latitude, longitude, &events[i]);
+
+				date++;
+			}
+
+			return true;
+		}
+
+		bool CalculateDailyEvents(DateTime & dateTime, GPS & gps, DailyEvents * events, int numDays)
+		{
+			return CalculateDailyEvents(dateTime.GetUTCOffset(), dateTime.GetMonth(), dateTime.GetDay(), dateTime.GetYear(),
+				gps.GetLatitudeRadians(), gps.GetLongitudeRadians(), events, numDays);
+		}
+
+		bool CalculateCalendarEvents(unsigned int firstYear, int numYears, CalendarEvent * events, int maxEvents, int * numEvents)
+		{
+			if ((events == NULL) || (numEvents == NULL) || (numYears < 1))
+				return false;
+
+			*numEvents = 0;
+
+			CalendarEvent year[MaxCalendarEventsPerYear];
+
+			for (int i = 0; i < numYears; i++)
+			{
+				int count = _FindCalendarYear(firstYear + i, year);
+
+				for (int e = 0; e < count; e++)
+				{
+					if (*numEvents >= maxEvents)
+						return false;
+
+					events[(*numEvents)++] = year[e];
+				}
+			}
+
+			return true;
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			double _CosineHours(double t, void *)
+			{
+				return std::cos(t);
+			}
+		}
+
+		bool SkyEventTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Sky Event Tests");
+
+			//the root finder
+			double root = 0.0;
+			test->UnitTest(FindCrossing(&_CosineHours, NULL, 0.0, 3.0, 1e-12, &root), "FindCrossing finds a crossing");
+			test->UnitTest(std::fabs(root - MATH::PId2) < 1e-10, "FindCrossing is accurate");
+			test->UnitTest(FindCrossing(&_CosineHours, NULL, 0.0, 1.0, 1e-12, &root) == false, "FindCrossing needs a sign change");
+			test->UnitTest(CalculateDailyEvents(0.0f, MARCH, 20, 2015, 0.0f, 0.0f, NULL) == false, "CalculateDailyEvents catches NULL");
+
+			//Against NOAA's solar calculator, to two minutes.
+			const float minutes = 2.0f / 60.0f;
+			const float toRadians = MATH::DegreesToRadiansf;
+			DailyEvents events;
+
+			//Salt Lake City, summer solstice, MDT
+			CalculateDailyEvents(-6.0f, JUNE, 21, 2015, 40.76f * toRadians, -111.89f * toRadians, &events);
+			test->UnitTest(events.hours[SKY_EVENT_SUNRISE], 5.0f + 56.34f / 60.0f, minutes, "Sunrise June");
+			test->UnitTest(events.hours[SKY_EVENT_SOLAR_NOON], 13.0f + 29.34f / 60.0f, minutes, "Solar noon June");
+			test->UnitTest(events.hours[SKY_EVENT_SUNSET], 21.0f + 2.37f / 60.0f, minutes, "Sunset June");
+			test->UnitTest(events.hours[SKY_EVENT_CIVIL_DAWN], 5.0f + 22.87f / 60.0f, minutes, "Civil dawn June");
+			test->UnitTest(events.hours[SKY_EVENT_CIVIL_DUSK], 21.0f + 35.84f / 60.0f, minutes, "Civil dusk June");
+
+			//Salt Lake City, winter solstice, MST
+			CalculateDailyEvents(-7.0f, DECEMBER, 21, 2015, 40.76f * toRadians, -111.89f * toRadians, &events);
+			test->UnitTest(events.hours[SKY_EVENT_SUNRISE], 7.0f + 48.16f / 60.0f, minutes, "Sunrise December");
+			test->UnitTest(events.hours[SKY_EVENT_SOLAR_NOON], 12.0f + 25.64f / 60.0f, minutes, "Solar noon December");
+			test->UnitTest(events.hours[SKY_EVENT_SUNSET], 17.0f + 3.14f / 60.0f, minutes, "Sunset December");
+
+			//the equator on the equinox
+			CalculateDailyEvents(0.0f, MARCH, 20, 2015, 0.0f, 0.0f, &events);
+			test->UnitTest(events.hours[SKY_EVENT_SUNRISE], 6.0f + 4.28f / 60.0f, minutes, "Sunrise equinox");
+			test->UnitTest(events.hours[SKY_EVENT_SOLAR_NOON], 12.0f + 7.54f / 60.0f, minutes, "Solar noon equinox");
+			test->UnitTest(events.hours[SKY_EVENT_SUNSET], 18.0f + 10.80f / 60.0f, minutes, "Sunset equinox");
+
+			bool allSun = true;
+			for (int i = SKY_EVENT_ASTRONOMICAL_DAWN; i <= SKY_EVENT_ASTRONOMICAL_DUSK; i++)
+			{
+				if (!events.occurs[i] || ((i > SKY_EVENT_ASTRONOMICAL_DAWN) && (events.hours[i] <= events.hours[i - 1])))
+					allSun = false;
+			}
+			test->UnitTest(allSun, "The sun events happen in order");
+
+			//the sun really is on the horizon at sunrise
+			SkyPosition sun = CalculateSunPosition(events.times[SKY_EVENT_SUNRISE], 0.0f, 0.0f);
+			test->UnitTest(sun.Zenith, _SunriseZenith, 0.0001f, "The sun is at the horizon at sunrise");
+
+			//The midnight sun. The sun never sets but still crosses the
+			//meridian.
+			CalculateDailyEvents(2.0f, JUNE, 21, 2015, 78.22f * toRadians, 15.65f * toRadians, &events);
+			test->UnitTest(!events.occurs[SKY_EVENT_SUNRISE] && !events.occurs[SKY_EVENT_SUNSET], "No sunrise in the midnight sun");
+			test->UnitTest(!events.occurs[SKY_EVENT_ASTRONOMICAL_DUSK], "No dusk in the midnight sun");
+			test->UnitTest(events.occurs[SKY_EVENT_SOLAR_NOON], "Solar noon in the midnight sun");
+
+			//A month of moon. The moon rises about 50 minutes later each day
+			//so there is about one day without a moonrise.
+			const int days = 30;
+			DailyEvents month[days];
+			CalculateDailyEvents(-7.0f, MARCH, 1, 2015, 40.76f * toRadians, -111.89f * toRadians, month, days);
+
+			int moonrises = 0, moonsets = 0, transits = 0;
+			bool onHorizon = true, highest = true;
+			for (int i = 0; i < days; i++)
+			{
+				moonrises += month[i].occurs[SKY_EVENT_MOONRISE] ? 1 : 0;
+				moonsets += month[i].occurs[SKY_EVENT_MOONSET] ? 1 : 0;
+
+				if (month[i].occurs[SKY_EVENT_MOONRISE])
+				{
+					SkyPosition moon = CalculateMoonPosition(month[i].times[SKY_EVENT_MOONRISE], 40.76f * toRadians, -111.89f * toRadians);
+					if (std::fabs(moon.Zenith - _MoonriseZenith) > 0.0001f)
+						onHorizon = false;
+				}
+
+				if (month[i].occurs[SKY_EVENT_LUNAR_TRANSIT])
+				{
+					transits++;
+
+					Timestamp before = month[i].times[SKY_EVENT_LUNAR_TRANSIT], after = before;
+					before.AddSeconds(-900.0);
+					after.AddSeconds(900.0);
+
+					float zenith = CalculateMoonPosition(month[i].times[SKY_EVENT_LUNAR_TRANSIT], 40.76f * toRadians, -111.89f * toRadians).Zenith;
+					if ((CalculateMoonPosition(before, 40.76f * toRadians, -111.89f * toRadians).Zenith < zenith) ||
+						(CalculateMoonPosition(after, 40.76f * toRadians, -111.89f * toRadians).Zenith < zenith))
+						highest = false;
+				}
+			}
+			test->UnitTest((moonrises >= 28) && (moonrises <= 29), "About one day a month without a moonrise");
+			test->UnitTest((moonsets >= 28) && (moonsets <= 29), "About one day a month without a moonset");
+			test->UnitTest((transits >= 28) && (transits <= 29), "About one day a month without a transit");
+			test->UnitTest(onHorizon, "The moon is at the horizon at moonrise");
+			test->UnitTest(highest, "The moon is highest at transit");
+
+			//the batch gives the same days as one at a time
+			CalculateDailyEvents(-7.0f, MARCH, 17, 2015, 40.76f * toRadians, -111.89f * toRadians, &events);
+			bool batchMatches = true;
+			for (int i = 0; i < NumSkyEvents; i++)
+			{
+				if ((events.occurs[i] != month[16].occurs[i]) || (events.occurs[i] && (events.times[i] != month[16].times[i])))
+					batchMatches = false;
+			}
+			test->UnitTest(batchMatches, "The batch matches a single day");
+
+			//the DateTime and GPS version
+			DateTime dateTime;
+			dateTime.SetDate(MARCH, 17, 2015);
+			dateTime.SetTimeHours(15.0f);
+			dateTime.SetUTCOffset(-7.0f);
+			GPS gps(40.76f, -111.89f);
+			DailyEvents fromObjects;
+			CalculateDailyEvents(dateTime, gps, &fromObjects);
+			test->UnitTest(fromObjects.times[SKY_EVENT_SUNRISE] == events.times[SKY_EVENT_SUNRISE], "CalculateDailyEvents from a DateTime and GPS");
+
+			//a year of events
+			const int yearDays = 365;
+			DailyEvents * year = AllocateArray<DailyEvents>(yearDays);
+			CalculateDailyEvents(-7.0f, JANUARY, 1, 2015, 40.76f * toRadians, -111.89f * toRadians, year, yearDays);
+
+			bool sunEveryDay = true;
+			for (int i = 0; i < yearDays; i++)
+			{
+				if (!year[i].occurs[SKY_EVENT_SUNRISE] || !year[i].occurs[SKY_EVENT_SUNSET])
+					sunEveryDay = false;
+			}
+			test->UnitTest(sunEveryDay && year[75].times[SKY_EVENT_SUNRISE] == events.times[SKY_EVENT_SUNRISE], "A year of events");
+
+			FreeArray(year);
+
+			return test->GetSuccess();
+		}
+
+		namespace
+		{
+			/**
+			* The minutes between a calendar event and a UT reference time.
+			*/
+			double _MinutesFrom(const CalendarEvent & event, DATE_MONTH month, unsigned int day, int hour, int minute)
+			{
+				Timestamp reference = Timestamp::FromCalendar(hour + minute / 60.0, 0.0, month, day, 2015);
+				return (double)(event.time.GetMicroseconds() - reference.GetMicroseconds()) / 60000000.0;
+			}
+
+			/**
+			* Find the nth event of a type.
+			*/
+			const CalendarEvent * _FindCalendarEvent(const CalendarEvent * events, int numEvents, CALENDAR_EVENT type, int n)
+			{
+				for (int i = 0; i < numEvents; i++)
+				{
+					if (events[i].type == type && (n-- == 0))
+						return &events[i];
+				}
+
+				return NULL;
+			}
+		}
+
+		bool CalendarEventTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Calendar Event Tests");
+
+			CalendarEvent events[MaxCalendarEventsPerYear * 2];
+			int numEvents = 0;
+
+			test->UnitTest(CalculateCalendarEvents(2015, 1, NULL, 0, &numEvents) == false, "CalculateCalendarEvents catches NULL");
+			test->UnitTest(CalculateCalendarEvents(2015, 0, events, MaxCalendarEventsPerYear, &numEvents) == false, "CalculateCalendarEvents needs a year");
+			test->UnitTest(CalculateCalendarEvents(2015, 1, events, 10, &numEvents) == false, "CalculateCalendarEvents catches a small array");
+			test->UnitTest(numEvents == 10, "A small array is still filled");
+
+			test->UnitTest(CalculateCalendarEvents(2015, 1, events, MaxCalendarEventsPerYear, &numEvents), "CalculateCalendarEvents 2015");
+
+			int counts[8] = { 0 };
+			bool inOrder = true, inYear = true;
+			for (int i = 0; i < numEvents; i++)
+			{
+				counts[events[i].type]++;
+
+				if ((i > 0) && !(events[i - 1].time < events[i].time))
+					inOrder = false;
+
+				if (events[i].time.GetUniversalDate().GetYear() != 2015)
+					inYear = false;
+			}
+			test->UnitTest(inOrder, "The events are in order");
+			test->UnitTest(inYear, "The events are in the year");
+			test->UnitTest(counts[CALENDAR_EVENT_NEW_MOON] == 12, "12 new moons in 2015");
+			test->UnitTest(counts[CALENDAR_EVENT_FULL_MOON] == 13, "13 full moons in 2015");
+			test->UnitTest(counts[CALENDAR_EVENT_MARCH_EQUINOX] == 1 && counts[CALENDAR_EVENT_DECEMBER_SOLSTICE] == 1, "One of each season");
+
+			//The seasons and phases of 2015 from the US Naval Observatory,
+			//to two minutes
+			const CalendarEvent * event;
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_MARCH_EQUINOX, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, MARCH, 20, 22, 45)) < 2.0, "March equinox 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_JUNE_SOLSTICE, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, JUNE, 21, 16, 38)) < 2.0, "June solstice 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_SEPTEMBER_EQUINOX, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, SEPTEMBER, 23, 8, 20)) < 2.0, "September equinox 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_DECEMBER_SOLSTICE, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, DECEMBER, 22, 4, 48)) < 2.0, "December solstice 2015");
+
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_NEW_MOON, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, JANUARY, 20, 13, 14)) < 2.0, "New moon January 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_NEW_MOON, 1);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, FEBRUARY, 18, 23, 47)) < 2.0, "New moon February 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_NEW_MOON, 2);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, MARCH, 20, 9, 36)) < 2.0, "New moon March 2015");
+
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_FULL_MOON, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, JANUARY, 5, 4, 53)) < 2.0, "Full moon January 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_FULL_MOON, 1);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, FEBRUARY, 3, 23, 9)) < 2.0, "Full moon February 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_FULL_MOON, 2);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, MARCH, 5, 18, 5)) < 2.0, "Full moon March 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_FULL_MOON, 3);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, APRIL, 4, 12, 6)) < 2.0, "Full moon April 2015");
+
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_FIRST_QUARTER, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, JANUARY, 27, 4, 48)) < 2.0, "First quarter January 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_FIRST_QUARTER, 1);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, FEBRUARY, 25, 17, 14)) < 2.0, "First quarter February 2015");
+
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_LAST_QUARTER, 0);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, JANUARY, 13, 9, 46)) < 2.0, "Last quarter January 2015");
+			event = _FindCalendarEvent(events, numEvents, CALENDAR_EVENT_LAST_QUARTER, 1);
+			test->UnitTest(event != NULL && std::fabs(_MinutesFrom(*event, FEBRUARY, 12, 3, 50)) < 2.0, "Last quarter February 2015");
+
+			//the phases follow each other
+			bool phasesCycle = true;
+			int lastPhase = -1;
+			for (int i = 0; i < numEvents; i++)
+			{
+				if (events[i].type > CALENDAR_EVENT_LAST_QUARTER)
+					continue;
+
+				if ((lastPhase >= 0) && (events[i].type != (lastPhase + 1) % 4))
+					phasesCycle = false;
+
+				lastPhase = events[i].type;
+			}
+			test->UnitTest(phasesCycle, "The phases of the moon follow each other");
+
+			//the batch is the years one after another
+			int numBatch = 0, numNext = 0;
+			CalendarEvent next[MaxCalendarEventsPerYear];
+			test->UnitTest(CalculateCalendarEvents(2015, 2, events, MaxCalendarEventsPerYear * 2, &numBatch), "CalculateCalendarEvents 2015 and 2016");
+			CalculateCalendarEvents(2016, 1, next, MaxCalendarEventsPerYear, &numNext);
+
+			bool batchMatches = (numBatch == numEvents + numNext);
+			for (int i = 0; batchMatches && (i < numNext); i++)
+			{
+				if ((events[numEvents + i].type != next[i].type) || (events[numEvents + i].time != next[i].time))
+					batchMatches = false;
+			}
+			test->UnitTest(batchMatches, "The batch matches a year at a time");
+
+			//a century, about 4 phases a lunation and 4 seasons a year
+			const int years = 100;
+			CalendarEvent * century = AllocateArray<CalendarEvent>(years * MaxCalendarEventsPerYear);
+			int numCentury = 0;
+			test->UnitTest(CalculateCalendarEvents(2000, years, century, years * MaxCalendarEventsPerYear, &numCentury) && numCentury > 5300 && numCentury < 5400, "A century of calendar events");
+			FreeArray(century);
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,290 @@
+/**
+* @file SkyPerfCounters.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the performance counters.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "SkyPerfCounters.hpp"
+
+#include <atomic>
+
+#if BIOSKY_TESTING == 1
+#include <string>
+#include <thread>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			struct _Stage
+			{
+				std::atomic<unsigned long long> calls;
+				std::atomic<unsigned long long> totalNanoseconds;
+				std::atomic<unsigned long long> lastNanoseconds;
+				/**
+				* The minimum is kept inverted (~nanoseconds) so it can be
+				* updated like the maximum and a zeroed stage has no minimum.
+				*/
+				std::atomic<unsigned long long> invertedMinNanoseconds;
+				std::atomic<unsigned long long> maxNanoseconds;
+				std::atomic<unsigned int> histogram[NumSkyPerfBuckets];
+			};
+
+			/**Static storage, so every counter starts at 0.*/
+			_Stage _stages[NumSkyPerfStages];
+
+			void _StoreMax(std::atomic<unsigned long long> & value, unsigned long long candidate)
+			{
+				unsigned long long current = value.load(std::memory_order_relaxed);
+
+				while ((candidate > current) && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed))
+				{
+				}
+			}
+
+			int _Bucket(unsigned long long nanoseconds)
+			{
+				int bucket = 0;
+
+				while ((nanoseconds > 1) && (bucket < NumSkyPerfBuckets - 1))
+				{
+					nanoseconds >>= 1;
+					bucket++;
+				}
+
+				return bucket;
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		void RecordSkyPerfSample(SKY_PERF_STAGE stage, unsigned long long nanoseconds)
+		{
+			if ((stage < 0) || (stage >= NumSkyPerfStages))
+				return;
+
+			_Stage & counters = _stages[stage];
+
+			counters.calls.fetch_add(1, std::memory_order_relaxed);
+			counters.totalNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+			counters.lastNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+			_StoreMax(counters.invertedMinNanoseconds, ~nanoseconds);
+			_StoreMax(counters.maxNanoseconds, nanoseconds);
+			counters.histogram[_Bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void GetSkyPerfCounters(SkyPerfCounters * counters)
+		{
+			if (counters == NULL)
+				return;
+
+			for (int s = 0; s < NumSkyPerfStages; s++)
+			{
+				SkyPerfStage & stage = counters->stages[s];
+
+				stage.calls = _stages[s].calls.load(std::memory_order_relaxed);
+				stage.totalNanoseconds = _stages[s].totalNanoseconds.load(std::memory_order_relaxed);
+				stage.lastNanoseconds = _stages[s].lastNanoseconds.load(std::memory_order_relaxed);
+				stage.minNanoseconds = (stage.calls == 0) ? 0 : ~_stages[s].invertedMinNanoseconds.load(std::memory_order_relaxed);
+				stage.maxNanoseconds = _stages[s].maxNanoseconds.load(std::memory_order_relaxed);
+
+				for (int b = 0; b < NumSkyPerfBuckets; b++)
+					stage.histogram[b] = _stages[s].histogram[b].load(std::memory_order_relaxed);
+			}
+		}
+
+		void ResetSkyPerfCounters()
+		{
+			for (int s = 0; s < NumSkyPerfStages; s++)
+			{
+				_stages[s].calls.store(0, std::memory_order_relaxed);
+				_stages[s].totalNanoseconds.store(0, std::memory_order_relaxed);
+				_stages[s].lastNanoseconds.store(0, std::memory_order_relaxed);
+				_stages[s].invertedMinNanoseconds.store(0, std::memory_order_relaxed);
+				_stages[s].maxNanoseconds.store(0, std::memory_order_relaxed);
+
+				for (int b = 0; b < NumSkyPerfBuckets; b++)
+					_stages[s].histogram[b].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		unsigned long long GetSkyPerfPercentile(const SkyPerfStage & stage, float percentile)
+		{
+			unsigned long long count = 0;
+
+			for (int b = 0; b < NumSkyPerfBuckets; b++)
+				count += stage.histogram[b];
+
+			if (count == 0)
+				return 0;
+
+			if (percentile < 0.0f)
+				percentile = 0.0f;
+			else if (percentile > 100.0f)
+				percentile = 100.0f;
+
+			//the rank of the call the percentile is at, from 1
+			unsigned long long rank = (unsigned long long)(percentile / 100.0f * count + 0.5f);
+			if (rank < 1)
+				rank = 1;
+
+			unsigned long long seen = 0;
+			int bucket = 0;
+
+			for (; bucket < NumSkyPerfBuckets - 1; bucket++)
+			{
+				seen += stage.histogram[bucket];
+
+				if (seen >= rank)
+					break;
+			}
+
+			unsigned long long top = (bucket == NumSkyPerfBuckets - 1) ? stage.maxNanoseconds : (2ULL << bucket) - 1;
+
+			if (top > stage.maxNanoseconds)
+				top = stage.maxNanoseconds;
+
+			if (top < stage.minNanoseconds)
+				top = stage.minNanoseconds;
+
+			return top;
+		}
+
+		const char * GetSkyPerfStageName(SKY_PERF_STAGE stage)
+		{
+			static const char * names[NumSkyPerfStages] =
+			{
+				"Ephemeris",
+				"Moon Phase",
+				"Moon Visibility",
+				"Sky Color",
+				"Sky Lights",
+				"Moon Texture Lock",
+				"Moon Texture Unlock",
+				"Geometry Lock",
+				"Geometry Unlock"
+			};
+
+			if ((stage < 0) || (stage >= NumSkyPerfStages))
+				return "Unknown";
+
+			return names[stage];
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			void _RecordMany(int * stage)
+			{
+				for (int i = 0; i < 10000; i++)
+					RecordSkyPerfSample((SKY_PERF_STAGE)*stage, 100);
+			}
+		}
+
+		bool SkyPerfCounterTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Sky Perf Counter Tests");
+
+			SkyPerfCounters counters;
+
+			ResetSkyPerfCounters();
+			GetSkyPerfCounters(&counters);
+			bool zero = true;
+			for (int s = 0; s < NumSkyPerfStages; s++)
+			{
+				if (counters.stages[s].calls != 0 || counters.stages[s].minNanoseconds != 0 || counters.stages[s].maxNanoseconds != 0)
+					zero = false;
+			}
+			test->UnitTest(zero, "The counters start at 0");
+			test->UnitTest(GetSkyPerfPercentile(counters.stages[SKY_PERF_EPHEMERIS], 50.0f) == 0, "No percentile without calls");
+
+			//1000 calls of 1 to 1000 nanoseconds
+			for (unsigned long long n = 1; n <= 1000; n++)
+				RecordSkyPerfSample(SKY_PERF_SKY_COLOR, n);
+			RecordSkyPerfSample((SKY_PERF_STAGE)NumSkyPerfStages, 5);
+
+			GetSkyPerfCounters(&counters);
+			const SkyPerfStage & color = counters.stages[SKY_PERF_SKY_COLOR];
+			test->UnitTest(color.calls == 1000, "The calls are counted");
+			test->UnitTest(color.totalNanoseconds == 500500, "The time is added up");
+			test->UnitTest(color.lastNanoseconds == 1000, "The last call");
+			test->UnitTest(color.minNanoseconds == 1 && color.maxNanoseconds == 1000, "The min and max");
+			test->UnitTest(color.histogram[0] == 1 && color.histogram[1] == 2 && color.histogram[9] == 1000 - 511, "The histogram");
+			test->UnitTest(counters.stages[SKY_PERF_SKY_LIGHTS].calls == 0, "Other stages are not touched");
+
+			//the true median is 500, in the bucket [256, 512)
+			unsigned long long median = GetSkyPerfPercentile(color, 50.0f);
+			test->UnitTest(median >= 500 && median <= 1000, "The median is within a factor of 2");
+			test->UnitTest(GetSkyPerfPercentile(color, 100.0f) == 1000, "The 100th percentile is the max");
+			test->UnitTest(GetSkyPerfPercentile(color, 0.0f) == 1, "The 0th percentile is the min");
+
+			//from many threads
+			ResetSkyPerfCounters();
+			int stage = SKY_PERF_EPHEMERIS;
+			std::thread first(&_RecordMany, &stage), second(&_RecordMany, &stage);
+			first.join();
+			second.join();
+			GetSkyPerfCounters(&counters);
+			test->UnitTest(counters.stages[SKY_PERF_EPHEMERIS].calls == 20000 && counters.stages[SKY_PERF_EPHEMERIS].totalNanoseconds == 2000000, "Counting from two threads");
+
+			//the scope only counts when it is compiled in
+			ResetSkyPerfCounters();
+			{
+				BIOSKY_PERF_SCOPE(SKY_PERF_SKY_LIGHTS);
+			}
+			GetSkyPerfCounters(&counters);
+#if BIOSKY_PERF_COUNTERS == 1
+			test->UnitTest(counters.stages[SKY_PERF_SKY_LIGHTS].calls == 1, "BIOSKY_PERF_SCOPE counts");
+#else
+			test->UnitTest(counters.stages[SKY_PERF_SKY_LIGHTS].calls == 0, "BIOSKY_PERF_SCOPE is compiled out");
+#endif
+
+			ResetSkyPerfCounters();
+
+			test->UnitTest(std::string(GetSkyPerfStageName(SKY_PERF_SKY_COLOR)) == "Sky Color" && std::string(GetSkyPerfStageName(SKY_PERF_GEOMETRY_UNLOCK)) == "Geometry Unlock", "Stage names");
+			test->UnitTest(std::string(GetSkyPerfStageName((SKY_PERF_STAGE)NumSkyPerfStages)) == "Unknown", "Unknown stage name");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
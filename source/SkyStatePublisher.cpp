@@ -0,0 +1,343 @@
+/**
+* @file SkyStatePublisher.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the SkyStatePublisher class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "SkyStatePublisher.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#if BIOSKY_TESTING == 1
+#include <thread>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		Vector3D SkyPositionToUnitVector(const SkyPosition & position)
+		{
+			return Vector3D(std::sin(position.Zenith) * std::sin(position.Azimuth),
+				std::cos(position.Zenith),
+				std::sin(position.Zenith) * std::cos(position.Azimuth));
+		}
+
+		SkySnapshot MakeSkySnapshot(const Timestamp & time, const SkyData & skyData, const LightData & lights)
+		{
+			SkySnapshot rtn;
+			rtn.time = time;
+			rtn.skyData = skyData;
+			rtn.lights = lights;
+			rtn.sunDirection = SkyPositionToUnitVector(skyData.sunPos);
+			rtn.moonDirection = SkyPositionToUnitVector(skyData.moonPos);
+
+			return rtn;
+		}
+
+		SkyStatePublisher::SkyStatePublisher() : _published(0)
+		{
+			static_assert(std::is_trivially_copyable<_PackedSnapshot>::value, "The slots copy snapshots as plain memory.");
+
+			for (int s = 0; s < NumSlots; s++)
+			{
+				_slots[s].sequence.store(0, std::memory_order_relaxed);
+
+				for (int i = 0; i < _NumWords; i++)
+					_slots[s].words[i].store(0, std::memory_order_relaxed);
+			}
+		}
+
+		void SkyStatePublisher::Publish(const SkySnapshot & snapshot)
+		{
+			_PackedSnapshot packed;
+			_Pack(snapshot, &packed);
+
+			unsigned int words[_NumWords] = { 0 };
+			std::memcpy(words, &packed, sizeof(_PackedSnapshot));
+
+			unsigned int next = _published.load(std::memory_order_relaxed) + 1;
+			_Slot & slot = _slots[next % NumSlots];
+
+			unsigned int sequence = slot.sequence.load(std::memory_order_relaxed);
+			slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			for (int i = 0; i < _NumWords; i++)
+				slot.words[i].store(words[i], std::memory_order_relaxed);
+
+			slot.sequence.store(sequence + 2, std::memory_order_release);
+			_published.store(next, std::memory_order_release);
+		}
+
+		bool SkyStatePublisher::TryRead(SkySnapshot * snapshot) const
+		{
+			unsigned int published = _published.load(std::memory_order_acquire);
+
+			if ((published == 0) || (snapshot == NULL))
+				return false;
+
+			const _Slot & slot = _slots[published % NumSlots];
+
+			unsigned int before = slot.sequence.load(std::memory_order_acquire);
+
+			if (before & 1)
+				return false;
+
+			unsigned int words[_NumWords];
+
+			for (int i = 0; i < _NumWords; i++)
+				words[i] = slot.words[i].load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (slot.sequence.load(std::memory_order_relaxed) != before)
+				return false;
+
+			_PackedSnapshot packed;
+			std::memcpy(&packed, words, sizeof(_PackedSnapshot));
+			_Unpack(packed, snapshot);
+
+			return true;
+		}
+
+		bool SkyStatePublisher::Read(SkySnapshot * snapshot) const
+		{
+			if ((snapshot == NULL) || (GetPublishCount() == 0))
+				return false;
+
+			for (int attempt = 0; attempt < MaxReadAttempts; attempt++)
+			{
+				if (TryRead(snapshot))
+					return true;
+			}
+
+			return false;
+		}
+
+		void SkyStatePublisher::_Pack(const SkySnapshot & snapshot, _PackedSnapshot * packed)
+		{
+			packed->microseconds = snapshot.time.GetMicroseconds();
+			packed->moonAzimuth = snapshot.skyData.moonPos.Azimuth;
+			packed->moonZenith = snapshot.skyData.moonPos.Zenith;
+			packed->sunAzimuth = snapshot.skyData.sunPos.Azimuth;
+			packed->sunZenith = snapshot.skyData.sunPos.Zenith;
+			packed->starRotation = snapshot.skyData.starRotation;
+			packed->northStarZenith = snapshot.skyData.northStarZenith;
+			packed->phase = snapshot.skyData.phase;
+			packed->moonVisibility = snapshot.skyData.moonVisibility;
+
+			packed->color[0] = snapshot.lights.Color.R;
+			packed->color[1] = snapshot.lights.Color.G;
+			packed->color[2] = snapshot.lights.Color.B;
+			packed->color[3] = snapshot.lights.Color.A;
+			packed->ambientColor[0] = snapshot.lights.AmbientColor.R;
+			packed->ambientColor[1] = snapshot.lights.AmbientColor.G;
+			packed->ambientColor[2] = snapshot.lights.AmbientColor.B;
+			packed->ambientColor[3] = snapshot.lights.AmbientColor.A;
+
+			packed->sunDirection[0] = snapshot.sunDirection.X;
+			packed->sunDirection[1] = snapshot.sunDirection.Y;
+			packed->sunDirection[2] = snapshot.sunDirection.Z;
+			packed->moonDirection[0] = snapshot.moonDirection.X;
+			packed->moonDirection[1] = snapshot.moonDirection.Y;
+			packed->moonDirection[2] = snapshot.moonDirection.Z;
+		}
+
+		void SkyStatePublisher::_Unpack(const _PackedSnapshot & packed, SkySnapshot * snapshot)
+		{
+			snapshot->time = Timestamp(packed.microseconds);
+			snapshot->skyData.moonPos = SkyPosition(packed.moonAzimuth, packed.moonZenith);
+			snapshot->skyData.sunPos = SkyPosition(packed.sunAzimuth, packed.sunZenith);
+			snapshot->skyData.starRotation = packed.starRotation;
+			snapshot->skyData.northStarZenith = packed.northStarZenith;
+			snapshot->skyData.phase = packed.phase;
+			snapshot->skyData.moonVisibility = packed.moonVisibility;
+
+			snapshot->lights.Color.R = packed.color[0];
+			snapshot->lights.Color.G = packed.color[1];
+			snapshot->lights.Color.B = packed.color[2];
+			snapshot->lights.Color.A = packed.color[3];
+			snapshot->lights.AmbientColor.R = packed.ambientColor[0];
+			snapshot->lights.AmbientColor.G = packed.ambientColor[1];
+			snapshot->lights.AmbientColor.B = packed.ambientColor[2];
+			snapshot->lights.AmbientColor.A = packed.ambientColor[3];
+
+			snapshot->sunDirection = Vector3D(packed.sunDirection[0], packed.sunDirection[1], packed.sunDirection[2]);
+			snapshot->moonDirection = Vector3D(packed.moonDirection[0], packed.moonDirection[1], packed.moonDirection[2]);
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**The snapshots published by the stress test.*/
+			const unsigned int _StressCount = 200000;
+
+			/**
+			* A snapshot where every value is n, so a torn read shows.
+			*/
+			SkySnapshot _CountedSnapshot(unsigned int n)
+			{
+				SkySnapshot rtn;
+				rtn.time = Timestamp((long long)n);
+				rtn.skyData.phase = (float)n;
+				rtn.skyData.sunPos.Zenith = (float)n;
+				rtn.lights.Color.R = (float)n;
+				rtn.sunDirection = Vector3D((float)n, (float)n, (float)n);
+				rtn.moonDirection = Vector3D((float)n, (float)n, (float)n);
+
+				return rtn;
+			}
+
+			/**
+			* Returns true if every value of the snapshot is the same.
+			*/
+			bool _Consistent(const SkySnapshot & snapshot)
+			{
+				float n = (float)snapshot.time.GetMicroseconds();
+
+				return (snapshot.skyData.phase == n) && (snapshot.skyData.sunPos.Zenith == n) && (snapshot.lights.Color.R == n) &&
+					(snapshot.sunDirection.X == n) && (snapshot.sunDirection.Z == n) && (snapshot.moonDirection.Y == n);
+			}
+
+			struct _ReaderData
+			{
+				const SkyStatePublisher * publisher;
+				const std::atomic<bool> * done;
+				int torn;
+				int backwards;
+			};
+
+			void _Reader(_ReaderData * data)
+			{
+				long long last = 0;
+				SkySnapshot snapshot;
+
+				while (!data->done->load(std::memory_order_acquire))
+				{
+					if (!data->publisher->Read(&snapshot))
+						continue;
+
+					if (!_Consistent(snapshot))
+						data->torn++;
+
+					if (snapshot.time.GetMicroseconds() < last)
+						data->backwards++;
+
+					last = snapshot.time.GetMicroseconds();
+				}
+			}
+
+			void _Writer(SkyStatePublisher * publisher)
+			{
+				for (unsigned int n = 1; n <= _StressCount; n++)
+					publisher->Publish(_CountedSnapshot(n));
+			}
+		}
+
+		bool SkyStatePublisher::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("SkyStatePublisher Tests");
+
+			test->UnitTest(sizeof(_PackedSnapshot) <= _NumWords * sizeof(unsigned int), "The words hold a snapshot");
+
+			SkyStatePublisher publisher;
+			SkySnapshot snapshot;
+			test->UnitTest(!publisher.Read(&snapshot) && !publisher.TryRead(&snapshot), "Nothing to read before a publish");
+			test->UnitTest(publisher.GetPublishCount() == 0, "Nothing published");
+
+			SkyData skyData;
+			skyData.sunPos.Azimuth = 1.0f;
+			skyData.sunPos.Zenith = 0.5f;
+			skyData.moonPos.Azimuth = 4.0f;
+			skyData.moonPos.Zenith = 2.0f;
+			skyData.phase = 123.0f;
+			LightData lights;
+			lights.Color.G = 0.25f;
+
+			publisher.Publish(MakeSkySnapshot(Timestamp(42), skyData, lights));
+			test->UnitTest(publisher.Read(&snapshot), "Read after a publish");
+			test->UnitTest(publisher.GetPublishCount() == 1, "One published");
+			test->UnitTest(snapshot.time == Timestamp(42) && snapshot.skyData.phase == 123.0f && snapshot.lights.Color.G == 0.25f, "The snapshot is what was published");
+			test->UnitTest(snapshot.skyData.moonPos.Azimuth == 4.0f && snapshot.skyData.sunPos.Zenith == 0.5f && snapshot.lights.AmbientColor.A == lights.AmbientColor.A, "Every field is published");
+			test->UnitTest(snapshot.sunDirection.Y, std::cos(0.5f), 0.000001f, "The sun direction");
+			test->UnitTest(snapshot.moonDirection.X, std::sin(2.0f) * std::sin(4.0f), 0.000001f, "The moon direction");
+
+			//the newest wins, all the way around the ring
+			bool newest = true;
+			for (unsigned int n = 1; n <= 3 * NumSlots; n++)
+			{
+				publisher.Publish(_CountedSnapshot(n));
+
+				if (!publisher.TryRead(&snapshot) || snapshot.time.GetMicroseconds() != (long long)n)
+					newest = false;
+			}
+			test->UnitTest(newest, "The newest snapshot is read");
+
+			//one writer and three readers at once
+			SkyStatePublisher shared;
+			std::atomic<bool> done(false);
+			_ReaderData readers[3];
+			std::thread readerThreads[3];
+
+			for (int i = 0; i < 3; i++)
+			{
+				readers[i].publisher = &shared;
+				readers[i].done = &done;
+				readers[i].torn = readers[i].backwards = 0;
+				readerThreads[i] = std::thread(&_Reader, &readers[i]);
+			}
+
+			std::thread writer(&_Writer, &shared);
+			writer.join();
+			done.store(true, std::memory_order_release);
+
+			int torn = 0, backwards = 0;
+			for (int i = 0; i < 3; i++)
+			{
+				readerThreads[i].join();
+				torn += readers[i].torn;
+				backwards += readers[i].backwards;
+			}
+
+			test->UnitTest(torn == 0, "No torn snapshots");
+			test->UnitTest(backwards == 0, "Snapshots never go back in time");
+			test->UnitTest(shared.Read(&snapshot) && snapshot.time.GetMicroseconds() == (long long)_StressCount, "The last snapshot is kept");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
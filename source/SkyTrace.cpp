@@ -0,0 +1,537 @@
+/**
+* @file SkyTrace.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the trace buffers and the Chrome trace writer.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "SkyTrace.hpp"
+#include "Allocator.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+#if BIOSKY_TESTING == 1
+#include <sstream>
+#include <string>
+#include <thread>
+#endif
+
+//Visual Studio 2013 does not have thread_local, and a __declspec(thread)
+//variable can not have a destructor, so a fiber local storage slot hands
+//the ring of a thread back when the thread ends.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+	#define _BIOSKY_TRACE_USE_FLS 1
+
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#define _BIOSKY_TRACE_USE_FLS 0
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**
+			* One event. The fields are atomic words so the writer can read
+			* a slot while its thread writes over it; the sequence tells it
+			* if it did (see SkyStatePublisher).
+			*/
+			struct _TraceEvent
+			{
+				/**2 * index + 2 once event number index is written, odd while it is being written.*/
+				std::atomic<unsigned long long> sequence;
+				std::atomic<const char *> name;
+				std::atomic<long long> begin;
+				std::atomic<long long> end;
+			};
+
+			/**
+			* The ring of events of one thread. Only that thread writes to it.
+			* When the thread ends the ring goes back to the free rings and
+			* the next new thread records into it. Rings are never freed, so
+			* the events of a thread that has ended can still be written, but
+			* there are only as many as the most threads tracing at once.
+			*/
+			struct _TraceRing
+			{
+				_TraceEvent events[SkyTraceEventsPerThread];
+				/**The number of events ever recorded.*/
+				std::atomic<unsigned long long> head;
+				/**False once the thread of the ring has ended.*/
+				std::atomic<bool> inUse;
+				int threadId;
+				_TraceRing * next;
+
+				_TraceRing() : head(0), inUse(true), threadId(0), next(NULL)
+				{
+					for (int i = 0; i < SkyTraceEventsPerThread; i++)
+						events[i].sequence.store(0, std::memory_order_relaxed);
+				}
+			};
+
+			std::atomic<bool> _recording(false);
+			std::atomic<long long> _traceStart(0);
+			std::atomic<_TraceRing *> _rings(NULL);
+			std::atomic<int> _numRings(0);
+
+			/**
+			* Give the ring of a thread that has ended back.
+			*/
+			void _ReleaseRing(_TraceRing * ring)
+			{
+				if (ring != NULL)
+					ring->inUse.store(false, std::memory_order_release);
+			}
+
+#if _BIOSKY_TRACE_USE_FLS
+			__declspec(thread) _TraceRing * _threadRing = NULL;
+
+			VOID WINAPI _ReleaseFiberRing(PVOID ring)
+			{
+				_ReleaseRing((_TraceRing *)ring);
+			}
+
+			//made when the library is loaded, before any thread traces
+			const DWORD _ringSlot = FlsAlloc(&_ReleaseFiberRing);
+
+			inline _TraceRing * _CurrentRing()
+			{
+				return _threadRing;
+			}
+
+			inline void _SetCurrentRing(_TraceRing * ring)
+			{
+				_threadRing = ring;
+
+				if (_ringSlot != FLS_OUT_OF_INDEXES)
+					FlsSetValue(_ringSlot, ring);
+			}
+#else
+			/**
+			* Holds the ring of a thread and gives it back when the thread
+			* ends.
+			*/
+			struct _ThreadRingHolder
+			{
+				_TraceRing * ring;
+
+				_ThreadRingHolder() : ring(NULL) {}
+				~_ThreadRingHolder() { _ReleaseRing(ring); }
+			};
+
+			thread_local _ThreadRingHolder _threadRing;
+
+			inline _TraceRing * _CurrentRing()
+			{
+				return _threadRing.ring;
+			}
+
+			inline void _SetCurrentRing(_TraceRing * ring)
+			{
+				_threadRing.ring = ring;
+			}
+#endif
+
+			long long _Now()
+			{
+				return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+			}
+
+			_TraceRing * _GetThreadRing()
+			{
+				_TraceRing * ring = _CurrentRing();
+
+				if (ring != NULL)
+					return ring;
+
+				//reuse the ring of a thread that has ended
+				for (ring = _rings.load(); ring != NULL; ring = ring->next)
+				{
+					bool inUse = false;
+
+					if (ring->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+					{
+						_SetCurrentRing(ring);
+						return ring;
+					}
+				}
+
+				//called from the destructor of SkyTraceScope, so running out
+				//of memory drops the event rather than throwing
+				try
+				{
+					ring = New<_TraceRing>();
+				}
+				catch (const std::bad_alloc &)
+				{
+					return NULL;
+				}
+
+				ring->threadId = _numRings.fetch_add(1) + 1;
+				ring->next = _rings.load();
+
+				while (!_rings.compare_exchange_weak(ring->next, ring))
+				{
+				}
+
+				_SetCurrentRing(ring);
+
+				return ring;
+			}
+
+			void _WriteString(std::ostream & out, const char * text)
+			{
+				out << '"';
+
+				for (; (text != NULL) && (*text != '\0'); text++)
+				{
+					unsigned char c = (unsigned char)*text;
+
+					if (c == '"' || c == '\\')
+						out << '\\' << (char)c;
+					else if (c < 0x20)
+						out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+					else
+						out << (char)c;
+				}
+
+				out << '"';
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		void StartSkyTrace()
+		{
+			_traceStart.store(_Now());
+			_recording.store(true);
+		}
+
+		void StopSkyTrace()
+		{
+			_recording.store(false);
+		}
+
+		bool IsSkyTraceRecording()
+		{
+			return _recording.load(std::memory_order_relaxed);
+		}
+
+		long long BeginSkyTraceEvent()
+		{
+			if (!_recording.load(std::memory_order_relaxed))
+				return -1;
+
+			return _Now();
+		}
+
+		void EndSkyTraceEvent(const char * name, long long begin)
+		{
+			if (begin < 0)
+				return;
+
+			long long end = _Now();
+			_TraceRing * ring = _GetThreadRing();
+
+			if (ring == NULL)
+				return;
+
+			unsigned long long index = ring->head.load(std::memory_order_relaxed);
+			_TraceEvent & slot = ring->events[index % SkyTraceEventsPerThread];
+
+			slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			slot.name.store(name, std::memory_order_relaxed);
+			slot.begin.store(begin, std::memory_order_relaxed);
+			slot.end.store(end, std::memory_order_relaxed);
+
+			slot.sequence.store(2 * index + 2, std::memory_order_release);
+			ring->head.store(index + 1, std::memory_order_release);
+		}
+
+		int WriteSkyTrace(std::ostream & out)
+		{
+			long long start = _traceStart.load();
+			int numEvents = 0;
+			bool first = true;
+
+			std::ios::fmtflags flags = out.flags();
+			std::streamsize precision = out.precision();
+
+			out << std::fixed << std::setprecision(3);
+			out << "{\"traceEvents\":[";
+
+			for (_TraceRing * ring = _rings.load(); ring != NULL; ring = ring->next)
+			{
+				unsigned long long head = ring->head.load(std::memory_order_acquire);
+				unsigned long long index = (head > (unsigned long long)SkyTraceEventsPerThread) ? head - SkyTraceEventsPerThread : 0;
+				int ringEvents = 0;
+
+				for (; index < head; index++)
+				{
+					_TraceEvent & slot = ring->events[index % SkyTraceEventsPerThread];
+
+					unsigned long long sequence = slot.sequence.load(std::memory_order_acquire);
+					const char * name = slot.name.load(std::memory_order_relaxed);
+					long long begin = slot.begin.load(std::memory_order_relaxed);
+					long long end = slot.end.load(std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					//written over while it was read
+					if ((sequence != 2 * index + 2) || (slot.sequence.load(std::memory_order_relaxed) != sequence))
+						continue;
+
+					if (begin < start)
+						continue;
+
+					out << (first ? "\n" : ",\n");
+					first = false;
+
+					//the times are in microseconds
+					out << "{\"name\":";
+					_WriteString(out, name);
+					out << ",\"cat\":\"BIOSky\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadId;
+					out << ",\"ts\":" << (begin - start) / 1000.0 << ",\"dur\":" << (end - begin) / 1000.0 << "}";
+
+					ringEvents++;
+				}
+
+				if (ringEvents > 0)
+				{
+					out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId;
+					out << ",\"args\":{\"name\":\"BIOSky Thread " << ring->threadId << "\"}}";
+				}
+
+				numEvents += ringEvents;
+			}
+
+			out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+			out.flags(flags);
+			out.precision(precision);
+
+			return numEvents;
+		}
+
+		bool WriteSkyTrace(const char * fileName, int * numEvents)
+		{
+			if (fileName == NULL)
+				return false;
+
+			std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+
+			if (!file.is_open())
+				return false;
+
+			int count = WriteSkyTrace(file);
+
+			file.close();
+
+			if (numEvents != NULL)
+				(*numEvents) = count;
+
+			return !file.fail();
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			int _Count(const std::string & text, const std::string & find)
+			{
+				int count = 0;
+
+				for (std::size_t pos = text.find(find); pos != std::string::npos; pos = text.find(find, pos + 1))
+					count++;
+
+				return count;
+			}
+
+			struct _TraceThreadData
+			{
+				int numEvents;
+				/**
+				* The threads do not end until all of them have recorded, so
+				* none of them gets the ring of another.
+				*/
+				int numThreads;
+				std::atomic<int> finished;
+			};
+
+			void _TraceThread(_TraceThreadData * data)
+			{
+				for (int i = 0; i < data->numEvents; i++)
+				{
+					SkyTraceScope scope("Worker");
+				}
+
+				data->finished.fetch_add(1);
+
+				while (data->finished.load() < data->numThreads)
+					std::this_thread::yield();
+			}
+
+			int _CountRings()
+			{
+				int count = 0;
+
+				for (_TraceRing * ring = _rings.load(); ring != NULL; ring = ring->next)
+					count++;
+
+				return count;
+			}
+		}
+
+		bool SkyTraceTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Sky Trace Tests");
+
+			StopSkyTrace();
+			test->UnitTest(!IsSkyTraceRecording() && BeginSkyTraceEvent() < 0, "Not recording");
+
+			{
+				SkyTraceScope scope("Ignored");
+			}
+
+			//a trace with events from three threads
+			StartSkyTrace();
+			test->UnitTest(IsSkyTraceRecording() && BeginSkyTraceEvent() >= 0, "Recording");
+
+			{
+				SkyTraceScope outer("Outer");
+				SkyTraceScope inner("In \"quotes\"");
+			}
+
+			_TraceThreadData workers;
+			workers.numEvents = 100;
+			workers.numThreads = 2;
+			workers.finished = 0;
+			std::thread first(&_TraceThread, &workers), second(&_TraceThread, &workers);
+			first.join();
+			second.join();
+
+			StopSkyTrace();
+
+			{
+				SkyTraceScope scope("Stopped");
+			}
+
+			std::ostringstream stream;
+			int count = WriteSkyTrace(stream);
+			std::string json = stream.str();
+
+			test->UnitTest(count == 202, "All the events are written");
+			test->UnitTest(_Count(json, "\"ph\":\"X\"") == 202, "One complete event each");
+			test->UnitTest(_Count(json, "\"Worker\"") == 200, "The events of other threads");
+			test->UnitTest(_Count(json, "thread_name") == 3, "A name for each thread");
+			test->UnitTest(_Count(json, "\"In \\\"quotes\\\"\"") == 1, "Names are escaped");
+			test->UnitTest(_Count(json, "Ignored") == 0 && _Count(json, "Stopped") == 0, "Nothing is recorded when not recording");
+			test->UnitTest(json.find("{\"traceEvents\":[") == 0 && json.find("],\"displayTimeUnit\":\"ms\"}") != std::string::npos, "The Chrome trace format");
+
+			//a new trace drops the old events and a full ring keeps the newest
+			StartSkyTrace();
+
+			for (int i = 0; i < SkyTraceEventsPerThread + 100; i++)
+			{
+				SkyTraceScope scope("Overflow");
+			}
+
+			StopSkyTrace();
+
+			std::ostringstream overflow;
+			count = WriteSkyTrace(overflow);
+			test->UnitTest(count == SkyTraceEventsPerThread && _Count(overflow.str(), "Overflow") == SkyTraceEventsPerThread, "A full ring keeps the newest events");
+			test->UnitTest(_Count(overflow.str(), "Worker") == 0, "Starting drops the old events");
+
+			//the macro is only compiled in with BIOSKY_ENABLE_TRACING
+			StartSkyTrace();
+			{
+				BIOSKY_TRACE_SCOPE("Macro");
+			}
+			StopSkyTrace();
+
+			std::ostringstream macro;
+			count = WriteSkyTrace(macro);
+#if BIOSKY_TRACING == 1
+			test->UnitTest(count == 1, "BIOSKY_TRACE_SCOPE records");
+#else
+			test->UnitTest(count == 0, "BIOSKY_TRACE_SCOPE is compiled out");
+#endif
+
+			test->UnitTest(!WriteSkyTrace((const char *)NULL), "No file name");
+
+			//a thread that has ended gives its ring to the next thread
+			StartSkyTrace();
+
+			_TraceThreadData single;
+			single.numEvents = 1;
+			single.numThreads = 1;
+			single.finished = 0;
+
+			std::thread before(&_TraceThread, &single);
+			before.join();
+			int numRings = _CountRings();
+
+			single.finished = 0;
+			std::thread after(&_TraceThread, &single);
+			after.join();
+
+			StopSkyTrace();
+
+			test->UnitTest(_CountRings() == numRings, "The ring of an ended thread is reused");
+
+			std::ostringstream reused;
+			count = WriteSkyTrace(reused);
+			test->UnitTest(count == 2 && _Count(reused.str(), "Worker") == 2, "The events of an ended thread are kept");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
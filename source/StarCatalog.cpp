@@ -0,0 +1,1627 @@
+/**
+* @file StarCatalog.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the StarCatalog class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "StarCatalog.hpp"
+#include "BIOSkyFunctions.hpp"
+#include "Allocator.hpp"
+#include "MathUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if BIOSKY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if BIOSKY_TESTING == 1
+#include <vector>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**The size of the header of the compact format.*/
+			const std::size_t _CompactHeaderSize = 12;
+
+			/**The size of one star in the compact format.*/
+			const std::size_t _CompactStarSize = 8;
+
+			/**The version of the compact format.*/
+			const unsigned int _CompactVersion = 1;
+
+			/**The size of the header of a BSC5 file.*/
+			const std::size_t _BSC5HeaderSize = 28;
+
+			/**The number of stars rotated at a time by BuildStarField.*/
+			const int _StarBatchSize = 64;
+
+			/**The number of magnitude levels of a StarIndex.*/
+			const int _NumStarLevels = 10;
+
+			/**The most cells across a face of a StarIndex level.*/
+			const int _MaxCellsPerFace = 64;
+
+			/**
+			* The brightest stars of the Yale Bright Star Catalogue: right
+			* ascension in hours and declination in degrees (J2000), visual
+			* magnitude and B-V color index. This is not the whole catalogue;
+			* the full star field comes from LoadBSC5 or LoadCompact.
+			*/
+			const float _BrightStars[][4] = {
+				{  6.75247f, -16.71611f, -1.46f,  0.00f }, //Sirius
+				{  6.39919f, -52.69583f, -0.74f,  0.15f }, //Canopus
+				{ 14.66014f, -60.83389f, -0.27f,  0.71f }, //Rigil Kentaurus
+				{ 14.26103f,  19.18250f, -0.05f,  1.23f }, //Arcturus
+				{ 18.61564f,  38.78361f,  0.03f,  0.00f }, //Vega
+				{  5.27817f,  45.99806f,  0.08f,  0.80f }, //Capella
+				{  5.24231f,  -8.20167f,  0.13f, -0.03f }, //Rigel
+				{  7.65503f,   5.22500f,  0.34f,  0.42f }, //Procyon
+				{  1.62856f, -57.23667f,  0.46f, -0.16f }, //Achernar
+				{  5.91953f,   7.40694f,  0.50f,  1.85f }, //Betelgeuse
+				{ 14.06372f, -60.37306f,  0.61f, -0.23f }, //Hadar
+				{ 19.84639f,   8.86833f,  0.76f,  0.22f }, //Altair
+				{ 12.44331f, -63.09917f,  0.76f, -0.24f }, //Acrux
+				{  4.59867f,  16.50917f,  0.86f,  1.54f }, //Aldebaran
+				{ 16.49011f, -26.43194f,  0.96f,  1.83f }, //Antares
+				{ 13.41989f, -11.16139f,  0.97f, -0.23f }, //Spica
+				{  7.75525f,  28.02611f,  1.14f,  1.00f }, //Pollux
+				{ 22.96083f, -29.62222f,  1.16f,  0.09f }, //Fomalhaut
+				{ 20.69053f,  45.28028f,  1.25f,  0.09f }, //Deneb
+				{ 12.79536f, -59.68861f,  1.25f, -0.23f }, //Mimosa
+				{ 10.13953f,  11.96722f,  1.35f, -0.11f }, //Regulus
+				{  6.97708f, -28.97222f,  1.50f, -0.21f }, //Adhara
+				{  7.57664f,  31.88833f,  1.58f,  0.03f }, //Castor
+				{ 12.51942f, -57.11333f,  1.59f,  1.59f }, //Gacrux
+				{ 17.56014f, -37.10389f,  1.63f, -0.22f }, //Shaula
+				{  5.41886f,   6.34972f,  1.64f, -0.22f }, //Bellatrix
+				{  5.43819f,  28.60750f,  1.65f, -0.13f }, //Elnath
+				{  9.22000f, -69.71722f,  1.68f,  0.07f }, //Miaplacidus
+				{  5.60356f,  -1.20194f,  1.69f, -0.18f }, //Alnilam
+				{ 22.13722f, -46.96111f,  1.74f, -0.13f }, //Alnair
+				{  5.67931f,  -1.94278f,  1.77f, -0.21f }, //Alnitak
+				{ 12.90047f,  55.95972f,  1.77f, -0.02f }, //Alioth
+				{ 11.06214f,  61.75083f,  1.79f,  1.07f }, //Dubhe
+				{  3.40539f,  49.86111f,  1.79f,  0.48f }, //Mirfak
+				{  7.13986f, -26.39333f,  1.83f,  0.68f }, //Wezen
+				{  8.15886f, -47.33667f,  1.83f, -0.22f }, //Regor
+				{ 18.40286f, -34.38472f,  1.85f, -0.03f }, //Kaus Australis
+				{  8.37522f, -59.50972f,  1.86f,  1.28f }, //Avior
+				{ 13.79233f,  49.31333f,  1.86f, -0.19f }, //Alkaid
+				{ 17.62197f, -42.99778f,  1.86f,  0.40f }, //Sargas
+				{  5.99214f,  44.94750f,  1.90f,  0.03f }, //Menkalinan
+				{ 16.81108f, -69.02778f,  1.91f,  1.44f }, //Atria
+				{  6.62853f,  16.39917f,  1.93f,  0.00f }, //Alhena
+				{  8.74506f, -54.70833f,  1.93f,  0.04f }, //Alsephina
+				{ 20.42747f, -56.73500f,  1.94f, -0.20f }, //Peacock
+				{  2.53031f,  89.26417f,  1.98f,  0.60f }, //Polaris
+				{  6.37833f, -17.95583f,  1.98f, -0.24f }, //Mirzam
+				{  9.45978f,  -8.65861f,  1.98f,  1.44f }, //Alphard
+				{  2.11956f,  23.46250f,  2.00f,  1.15f }, //Hamal
+				{ 10.33289f,  19.84139f,  2.01f,  1.13f }, //Algieba
+				{  0.72650f, -17.98667f,  2.04f,  1.02f }, //Diphda
+				{ 18.92108f, -26.29667f,  2.05f, -0.13f }, //Nunki
+				{  1.16219f,  35.62056f,  2.05f,  1.58f }, //Mirach
+				{ 14.11139f, -36.37000f,  2.06f,  1.01f }, //Menkent
+				{  0.13981f,  29.09056f,  2.06f, -0.11f }, //Alpheratz
+				{ 17.58225f,  12.56000f,  2.08f,  0.15f }, //Rasalhague
+				{ 14.84508f,  74.15556f,  2.08f,  1.47f }, //Kochab
+				{  5.79594f,  -9.66972f,  2.09f, -0.18f }, //Saiph
+				{  3.13614f,  40.95556f,  2.12f, -0.05f }, //Algol
+				{ 11.81767f,  14.57194f,  2.13f,  0.09f }, //Denebola
+				{ 15.57814f,  26.71472f,  2.23f, -0.02f }, //Alphecca
+				{  5.53344f,  -0.29917f,  2.23f, -0.22f }, //Mintaka
+				{ 20.37047f,  40.25667f,  2.23f,  0.67f }, //Sadr
+				{ 17.94344f,  51.48889f,  2.23f,  1.52f }, //Eltanin
+				{ 13.39875f,  54.92528f,  2.23f,  0.02f }, //Mizar
+				{  0.67511f,  56.53722f,  2.24f,  1.17f }, //Schedar
+				{  0.15297f,  59.14972f,  2.28f,  0.34f }, //Caph
+				{ 16.00556f, -22.62167f,  2.29f, -0.12f }, //Dschubba
+				{ 11.03069f,  56.38250f,  2.37f, -0.02f }, //Merak
+				{ 14.74978f,  27.07417f,  2.37f,  0.97f }, //Izar
+				{ 21.73644f,   9.87500f,  2.39f,  1.52f }, //Enif
+				{  0.43808f, -42.30611f,  2.40f,  1.09f }, //Ankaa
+				{ 23.06292f,  28.08278f,  2.42f,  1.67f }, //Scheat
+				{ 11.89717f,  53.69472f,  2.44f,  0.00f }, //Phecda
+				{  0.94514f,  60.71667f,  2.47f, -0.15f }, //Navi
+				{ 23.07936f,  15.20528f,  2.49f, -0.04f }, //Markab
+				{  3.03800f,   4.08972f,  2.53f,  1.64f }, //Menkar
+				{ 15.28344f,  -9.38306f,  2.61f, -0.07f }, //Zubeneschamali
+				{ 15.73781f,   6.42556f,  2.63f,  1.17f }, //Unukalhai
+				{ 13.03628f,  10.95917f,  2.83f,  0.94f }, //Vindemiatrix
+				{  0.22061f,  15.18361f,  2.83f, -0.23f }, //Algenib
+				{ 12.25711f,  57.03250f,  3.31f,  0.08f }  //Megrez
+			};
+
+			const int _NumBrightStars = sizeof(_BrightStars) / sizeof(_BrightStars[0]);
+
+			/**
+			* The color of a star from its B-V color index, every 0.2 from
+			* -0.4 to 2.0, as 0x00RRGGBB.
+			*/
+			const unsigned int _StarColors[] = {
+				0x9BB2FF, 0xAABFFF, 0xCAD7FF, 0xE4E8FF, 0xFFF4EA, 0xFFECD6, 0xFFDEB4,
+				0xFFD2A1, 0xFFC68C, 0xFFBB7B, 0xFFB06A, 0xFFA65C, 0xFF9B4E
+			};
+
+			/**
+			* Magnitudes from -2 to 10.75 in steps of 0.05. Fainter stars
+			* saturate at 10.75.
+			*/
+			inline unsigned char _QuantizeMagnitude(float magnitude)
+			{
+				float q = std::floor((magnitude + 2.0f) * 20.0f + 0.5f);
+
+				if (q < 0.0f)
+					return 0;
+
+				if (q > 255.0f)
+					return 255;
+
+				return (unsigned char)q;
+			}
+
+			inline float _MagnitudeValue(unsigned char quantized)
+			{
+				return quantized / 20.0f - 2.0f;
+			}
+
+			/**
+			* Get the faintest quantized magnitude that is brighter than or
+			* equal to a magnitude, or -1 if there is none.
+			*/
+			inline int _MagnitudeLimit(float magnitude)
+			{
+				float q = std::floor((magnitude + 2.0f) * 20.0f + 0.001f);
+
+				if (q < 0.0f)
+					return -1;
+
+				if (q > 255.0f)
+					return 255;
+
+				return (int)q;
+			}
+
+			/**
+			* Get the StarIndex level of a quantized magnitude. Level 0 is
+			* everything brighter than magnitude 2 and then each level is
+			* one magnitude.
+			*/
+			inline int _StarLevel(unsigned char quantized)
+			{
+				return std::max(0, std::min(_NumStarLevels - 1, quantized / 20 - 3));
+			}
+
+			inline unsigned char _QuantizeColorIndex(float colorIndex)
+			{
+				float q = std::floor((colorIndex + 0.5f) * 100.0f + 0.5f);
+
+				if (q < 0.0f)
+					return 0;
+
+				if (q > 255.0f)
+					return 255;
+
+				return (unsigned char)q;
+			}
+
+			inline float _ColorIndexValue(unsigned char quantized)
+			{
+				return quantized / 100.0f - 0.5f;
+			}
+
+			/**
+			* Interpolate the color of a star from the color table.
+			*/
+			unsigned int _ColorFromIndex(float colorIndex)
+			{
+				const int last = (sizeof(_StarColors) / sizeof(_StarColors[0])) - 1;
+
+				float t = (colorIndex + 0.4f) / 0.2f;
+
+				if (t <= 0.0f)
+					return _StarColors[0];
+
+				if (t >= last)
+					return _StarColors[last];
+
+				int i = (int)t;
+				float f = t - i;
+
+				unsigned int a = _StarColors[i];
+				unsigned int b = _StarColors[i + 1];
+				unsigned int color = 0;
+
+				for (int shift = 0; shift <= 16; shift += 8)
+				{
+					float ca = (float)((a >> shift) & 0xFF);
+					float cb = (float)((b >> shift) & 0xFF);
+
+					color |= ((unsigned int)(ca + (cb - ca) * f + 0.5f)) << shift;
+				}
+
+				return color;
+			}
+
+			/**
+			* Calculate the brightness and point size of each quantized
+			* magnitude for a limiting magnitude. See BuildStarField.
+			*
+			* @param limitingMagnitude The faintest star to draw.
+			*
+			* @param faintest The last quantized magnitude to calculate.
+			*
+			* @param[out] brightness The brightness of each magnitude.
+			*
+			* @param[out] sizes The point size of each magnitude.
+			*/
+			void _BrightnessTable(float limitingMagnitude, int faintest, float * brightness, float * sizes)
+			{
+				for (int q = 0; q <= faintest; q++)
+				{
+					float magnitude = _MagnitudeValue((unsigned char)q);
+					float b = std::pow(10.0f, -0.2f * (magnitude - 1.0f));
+					float fade = (limitingMagnitude - magnitude) / 0.5f;
+
+					if (b > 1.0f)
+						b = 1.0f;
+
+					if (fade > 1.0f)
+						fade = 1.0f;
+
+					sizes[q] = 1.0f + 2.0f * b;
+					brightness[q] = (fade > 0.0f) ? b * fade : 0.0f;
+				}
+			}
+
+			/**
+			* Fill in the point sprite of a rotated star.
+			*/
+			inline void _SetStarVertex(StarVertex & vertex, float x, float y, float z, float radius, float brightness, float size, unsigned char colorIndex)
+			{
+				vertex.position = Vector3D(x * radius, y * radius, z * radius);
+				vertex.brightness = brightness;
+				vertex.size = size;
+				vertex.color = ((unsigned int)(brightness * 255.0f + 0.5f) << 24) | _ColorFromIndex(_ColorIndexValue(colorIndex));
+			}
+
+			/**
+			* Estimate the B-V color index from a spectral type such as "K5".
+			*/
+			float _ColorIndexFromSpectralType(char type, char subclass)
+			{
+				//main sequence color index at the start of each class
+				const char classes[] = "OBAFGKM";
+				const float start[] = { -0.33f, -0.30f, 0.00f, 0.30f, 0.58f, 0.81f, 1.40f, 2.00f };
+
+				const char * found = (type == '\0') ? NULL : std::strchr(classes, type);
+
+				if (found == NULL)
+				{
+					//carbon and S type stars are very red
+					if (type == 'C' || type == 'N' || type == 'R' || type == 'S')
+						return 2.0f;
+
+					//Wolf-Rayet stars are very blue
+					if (type == 'W')
+						return -0.3f;
+
+					//unknown. Assume a star like the sun.
+					return 0.6f;
+				}
+
+				int c = (int)(found - classes);
+				float fraction = (subclass >= '0' && subclass <= '9') ? (subclass - '0') / 10.0f : 0.0f;
+
+				return start[c] + (start[c + 1] - start[c]) * fraction;
+			}
+
+			inline void _WriteU16(unsigned char * data, unsigned int value)
+			{
+				data[0] = (unsigned char)(value & 0xFF);
+				data[1] = (unsigned char)((value >> 8) & 0xFF);
+			}
+
+			inline void _WriteU32(unsigned char * data, unsigned int value)
+			{
+				_WriteU16(data, value & 0xFFFF);
+				_WriteU16(data + 2, value >> 16);
+			}
+
+			inline unsigned int _ReadU16(const unsigned char * data)
+			{
+				return (unsigned int)data[0] | ((unsigned int)data[1] << 8);
+			}
+
+			inline unsigned int _ReadU32(const unsigned char * data)
+			{
+				return _ReadU16(data) | (_ReadU16(data + 2) << 16);
+			}
+
+			/**
+			* Read a value from a BSC5 file in either byte order.
+			*/
+			template <typename T>
+			inline T _ReadBSC5(const unsigned char * data, bool bigEndian)
+			{
+				unsigned char bytes[sizeof(T)];
+
+				for (std::size_t i = 0; i < sizeof(T); i++)
+					bytes[i] = (bigEndian) ? data[sizeof(T) - 1 - i] : data[i];
+
+				T value;
+				memcpy(&value, bytes, sizeof(T));
+
+				return value;
+			}
+
+			/**
+			* Find the cube face cell of a direction. The face coordinates
+			* are warped by atan so the cells are close to the same size.
+			*/
+			int _CubeCell(float x, float y, float z, int cellsPerFace)
+			{
+				float ax = std::fabs(x);
+				float ay = std::fabs(y);
+				float az = std::fabs(z);
+
+				if (ax == 0.0f && ay == 0.0f && az == 0.0f)
+					return 0;
+
+				int face;
+				float u;
+				float v;
+
+				if (ax >= ay && ax >= az)
+				{
+					face = (x > 0.0f) ? 0 : 1;
+					u = z / ax;
+					v = y / ax;
+				}
+				else if (ay >= az)
+				{
+					face = (y > 0.0f) ? 2 : 3;
+					u = x / ay;
+					v = z / ay;
+				}
+				else
+				{
+					face = (z > 0.0f) ? 4 : 5;
+					u = x / az;
+					v = y / az;
+				}
+
+				u = std::atan(u) * (4.0f / MATH::PIf);
+				v = std::atan(v) * (4.0f / MATH::PIf);
+
+				int column = (int)((u + 1.0f) * 0.5f * cellsPerFace);
+				int row = (int)((v + 1.0f) * 0.5f * cellsPerFace);
+
+				column = std::max(0, std::min(cellsPerFace - 1, column));
+				row = std::max(0, std::min(cellsPerFace - 1, row));
+
+				return (face * cellsPerFace + row) * cellsPerFace + column;
+			}
+
+			/**
+			* Get the unit direction of a point on a face of the cube. u and
+			* v are the warped face coordinates from -1 to 1.
+			*/
+			Vector3D _CubeDirection(int face, float u, float v)
+			{
+				u = std::tan(u * (MATH::PIf / 4.0f));
+				v = std::tan(v * (MATH::PIf / 4.0f));
+
+				Vector3D direction;
+
+				switch (face)
+				{
+				case 0: direction = Vector3D(1.0f, v, u); break;
+				case 1: direction = Vector3D(-1.0f, v, u); break;
+				case 2: direction = Vector3D(u, 1.0f, v); break;
+				case 3: direction = Vector3D(u, -1.0f, v); break;
+				case 4: direction = Vector3D(u, v, 1.0f); break;
+				default: direction = Vector3D(u, v, -1.0f); break;
+				}
+
+				float length = std::sqrt(direction.X * direction.X + direction.Y * direction.Y + direction.Z * direction.Z);
+
+				return Vector3D(direction.X / length, direction.Y / length, direction.Z / length);
+			}
+
+			/**
+			* Rotate stars about Y and then about X. See RotateStars.
+			*/
+			void _RotateStars(const float * x, const float * y, const float * z, int count, float cosZ, float sinZ, float cosR, float sinR, float * outX, float * outY, float * outZ)
+			{
+				int i = 0;
+
+#if BIOSKY_USE_SSE2
+				const __m128 cZ = _mm_set1_ps(cosZ);
+				const __m128 sZ = _mm_set1_ps(sinZ);
+				const __m128 cR = _mm_set1_ps(cosR);
+				const __m128 sR = _mm_set1_ps(sinR);
+
+				for (; i + 4 <= count; i += 4)
+				{
+					__m128 X = _mm_loadu_ps(x + i);
+					__m128 Y = _mm_loadu_ps(y + i);
+					__m128 Z = _mm_loadu_ps(z + i);
+
+					//about Y
+					__m128 rx = _mm_add_ps(_mm_mul_ps(X, cR), _mm_mul_ps(Z, sR));
+					__m128 rz = _mm_sub_ps(_mm_mul_ps(Z, cR), _mm_mul_ps(X, sR));
+
+					//about X
+					_mm_storeu_ps(outX + i, rx);
+					_mm_storeu_ps(outY + i, _mm_sub_ps(_mm_mul_ps(Y, cZ), _mm_mul_ps(rz, sZ)));
+					_mm_storeu_ps(outZ + i, _mm_add_ps(_mm_mul_ps(Y, sZ), _mm_mul_ps(rz, cZ)));
+				}
+#endif
+
+				for (; i < count; i++)
+				{
+					float rx = x[i] * cosR + z[i] * sinR;
+					float rz = z[i] * cosR - x[i] * sinR;
+
+					outX[i] = rx;
+					outY[i] = y[i] * cosZ - rz * sinZ;
+					outZ[i] = y[i] * sinZ + rz * cosZ;
+				}
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		StarCatalog::StarCatalog() :
+			_numStars(0),
+			_x(NULL),
+			_y(NULL),
+			_z(NULL),
+			_magnitudes(NULL),
+			_colorIndecies(NULL)
+		{
+		}
+
+		StarCatalog::~StarCatalog()
+		{
+			_Release();
+		}
+
+		void StarCatalog::_Release()
+		{
+			FreeArray(_x);
+			FreeArray(_y);
+			FreeArray(_z);
+			FreeArray(_magnitudes);
+			FreeArray(_colorIndecies);
+
+			_x = _y = _z = NULL;
+			_magnitudes = _colorIndecies = NULL;
+			_numStars = 0;
+		}
+
+		bool StarCatalog::_Allocate(int count)
+		{
+			_Release();
+
+			if (count <= 0)
+				return true;
+
+			//padded so the stars can be rotated 4 at a time
+			int padded = (count + 3) & ~3;
+
+			_x = AllocateArray<float>(padded);
+			_y = AllocateArray<float>(padded);
+			_z = AllocateArray<float>(padded);
+			_magnitudes = AllocateArray<unsigned char>(padded);
+			_colorIndecies = AllocateArray<unsigned char>(padded);
+
+			if (_x == NULL || _y == NULL || _z == NULL || _magnitudes == NULL || _colorIndecies == NULL)
+			{
+				_Release();
+				return false;
+			}
+
+			_numStars = count;
+
+			return true;
+		}
+
+		void StarCatalog::_SortByMagnitude()
+		{
+			if (_numStars < 2)
+				return;
+
+			//counting sort, stable so stars of the same magnitude keep
+			//their order
+			int starts[256];
+			memset(starts, 0, sizeof(starts));
+
+			for (int i = 0; i < _numStars; i++)
+				starts[_magnitudes[i]]++;
+
+			bool sorted = true;
+			for (int i = 1; i < _numStars; i++)
+			{
+				if (_magnitudes[i] < _magnitudes[i - 1])
+				{
+					sorted = false;
+					break;
+				}
+			}
+
+			if (sorted)
+				return;
+
+			int total = 0;
+			for (int q = 0; q < 256; q++)
+			{
+				int count = starts[q];
+				starts[q] = total;
+				total += count;
+			}
+
+			int padded = (_numStars + 3) & ~3;
+
+			float * x = AllocateArray<float>(padded);
+			float * y = AllocateArray<float>(padded);
+			float * z = AllocateArray<float>(padded);
+			unsigned char * magnitudes = AllocateArray<unsigned char>(padded);
+			unsigned char * colorIndecies = AllocateArray<unsigned char>(padded);
+
+			if (x == NULL || y == NULL || z == NULL || magnitudes == NULL || colorIndecies == NULL)
+			{
+				FreeArray(x);
+				FreeArray(y);
+				FreeArray(z);
+				FreeArray(magnitudes);
+				FreeArray(colorIndecies);
+				return;
+			}
+
+			for (int i = 0; i < _numStars; i++)
+			{
+				int to = starts[_magnitudes[i]]++;
+
+				x[to] = _x[i];
+				y[to] = _y[i];
+				z[to] = _z[i];
+				magnitudes[to] = _magnitudes[i];
+				colorIndecies[to] = _colorIndecies[i];
+			}
+
+			int numStars = _numStars;
+
+			_Release();
+
+			_numStars = numStars;
+			_x = x;
+			_y = y;
+			_z = z;
+			_magnitudes = magnitudes;
+			_colorIndecies = colorIndecies;
+		}
+
+		bool StarCatalog::SetStars(const Star * stars, int count)
+		{
+			if (stars == NULL && count > 0)
+				return false;
+
+			if (!_Allocate(count))
+				return false;
+
+			for (int i = 0; i < count; i++)
+			{
+				float cosDec = std::cos(stars[i].declination);
+
+				_x[i] = cosDec * std::cos(stars[i].rightAscension);
+				_y[i] = std::sin(stars[i].declination);
+				_z[i] = cosDec * std::sin(stars[i].rightAscension);
+				_magnitudes[i] = _QuantizeMagnitude(stars[i].magnitude);
+				_colorIndecies[i] = _QuantizeColorIndex(stars[i].colorIndex);
+			}
+
+			_SortByMagnitude();
+
+			return true;
+		}
+
+		bool StarCatalog::LoadBSC5(const unsigned char * data, std::size_t size)
+		{
+			if (data == NULL || size < _BSC5HeaderSize)
+				return false;
+
+			//the catalog was distributed in both byte orders. Use the one
+			//that gives a sensible header.
+			for (int order = 0; order < 2; order++)
+			{
+				bool bigEndian = (order == 1);
+
+				int numStars = _ReadBSC5<int>(data + 8, bigEndian);
+				int idType = _ReadBSC5<int>(data + 12, bigEndian);
+				int properMotion = _ReadBSC5<int>(data + 16, bigEndian);
+				int numMagnitudes = _ReadBSC5<int>(data + 20, bigEndian);
+				int entrySize = _ReadBSC5<int>(data + 24, bigEndian);
+
+				//a negative count means J2000 coordinates
+				if (numStars < 0)
+					numStars = -numStars;
+
+				if (numMagnitudes < 0)
+					numMagnitudes = -numMagnitudes;
+
+				if (numStars <= 0 || numStars > 10000000 || numMagnitudes < 1 || numMagnitudes > 10 || properMotion < 0 || properMotion > 2)
+					continue;
+
+				//catalog number, position, spectral type, magnitudes and
+				//proper motion
+				int idSize = (idType > 0) ? 4 : 0;
+				int minimumSize = idSize + 16 + 2 + 2 * numMagnitudes + ((properMotion > 0) ? 8 : 0);
+
+				if (entrySize < minimumSize || entrySize > 1024 || (size - _BSC5HeaderSize) / entrySize < (std::size_t)numStars)
+					continue;
+
+				Star * stars = AllocateArray<Star>(numStars);
+
+				if (stars == NULL)
+					return false;
+
+				int count = 0;
+
+				for (int i = 0; i < numStars; i++)
+				{
+					const unsigned char * entry = data + _BSC5HeaderSize + (std::size_t)i * entrySize + idSize;
+
+					double rightAscension = _ReadBSC5<double>(entry, bigEndian);
+					double declination = _ReadBSC5<double>(entry + 8, bigEndian);
+
+					//removed entries have no position
+					if (rightAscension == 0.0 && declination == 0.0)
+						continue;
+
+					stars[count].rightAscension = (float)rightAscension;
+					stars[count].declination = (float)declination;
+					stars[count].colorIndex = _ColorIndexFromSpectralType((char)entry[16], (char)entry[17]);
+					stars[count].magnitude = _ReadBSC5<short>(entry + 18, bigEndian) / 100.0f;
+					count++;
+				}
+
+				bool loaded = SetStars(stars, count);
+
+				FreeArray(stars);
+
+				return loaded;
+			}
+
+			return false;
+		}
+
+		bool StarCatalog::LoadCompact(const unsigned char * data, std::size_t size)
+		{
+			if (data == NULL || size < _CompactHeaderSize)
+				return false;
+
+			if (data[0] != 'B' || data[1] != 'S' || data[2] != 'T' || data[3] != 'R' ||
+				_ReadU16(data + 4) != _CompactVersion || _ReadU16(data + 6) != _CompactStarSize)
+				return false;
+
+			unsigned int count = _ReadU32(data + 8);
+
+			if (count > 0x7FFFFFF0 || (size - _CompactHeaderSize) / _CompactStarSize < count)
+				return false;
+
+			if (!_Allocate((int)count))
+				return false;
+
+			for (int i = 0; i < _numStars; i++)
+			{
+				const unsigned char * star = data + _CompactHeaderSize + i * _CompactStarSize;
+
+				float x = (short)_ReadU16(star) / 32767.0f;
+				float y = (short)_ReadU16(star + 2) / 32767.0f;
+				float z = (short)_ReadU16(star + 4) / 32767.0f;
+				float length = std::sqrt(x * x + y * y + z * z);
+
+				if (length > 0.0f)
+				{
+					x /= length;
+					y /= length;
+					z /= length;
+				}
+
+				_x[i] = x;
+				_y[i] = y;
+				_z[i] = z;
+				_magnitudes[i] = star[6];
+				_colorIndecies[i] = star[7];
+			}
+
+			_SortByMagnitude();
+
+			return true;
+		}
+
+		std::size_t StarCatalog::SaveCompact(unsigned char * buffer, std::size_t bufferSize) const
+		{
+			std::size_t size = _CompactHeaderSize + (std::size_t)_numStars * _CompactStarSize;
+
+			if (buffer == NULL)
+				return size;
+
+			if (bufferSize < size)
+				return 0;
+
+			buffer[0] = 'B';
+			buffer[1] = 'S';
+			buffer[2] = 'T';
+			buffer[3] = 'R';
+			_WriteU16(buffer + 4, _CompactVersion);
+			_WriteU16(buffer + 6, _CompactStarSize);
+			_WriteU32(buffer + 8, (unsigned int)_numStars);
+
+			for (int i = 0; i < _numStars; i++)
+			{
+				unsigned char * star = buffer + _CompactHeaderSize + i * _CompactStarSize;
+
+				_WriteU16(star, (unsigned short)(short)std::floor(_x[i] * 32767.0f + 0.5f));
+				_WriteU16(star + 2, (unsigned short)(short)std::floor(_y[i] * 32767.0f + 0.5f));
+				_WriteU16(star + 4, (unsigned short)(short)std::floor(_z[i] * 32767.0f + 0.5f));
+				star[6] = _magnitudes[i];
+				star[7] = _colorIndecies[i];
+			}
+
+			return size;
+		}
+
+		float StarCatalog::GetStarMagnitude(int index) const
+		{
+			return _MagnitudeValue(_magnitudes[index]);
+		}
+
+		float StarCatalog::GetStarColorIndex(int index) const
+		{
+			return _ColorIndexValue(_colorIndecies[index]);
+		}
+
+		unsigned int StarCatalog::GetStarColor(int index) const
+		{
+			return 0xFF000000 | _ColorFromIndex(_ColorIndexValue(_colorIndecies[index]));
+		}
+
+		int StarCatalog::CountStarsBrighterThan(float magnitude) const
+		{
+			int q = _MagnitudeLimit(magnitude);
+
+			if (q < 0)
+				return 0;
+
+			//the magnitudes are sorted
+			return (int)(std::upper_bound(_magnitudes, _magnitudes + _numStars, (unsigned char)q) - _magnitudes);
+		}
+
+		int StarCatalog::RotateStars(float northStarZenith, float starRotation, int first, int count, float * x, float * y, float * z) const
+		{
+			if (x == NULL || y == NULL || z == NULL || first < 0 || first >= _numStars || count <= 0)
+				return 0;
+
+			if (count > _numStars - first)
+				count = _numStars - first;
+
+			_RotateStars(_x + first, _y + first, _z + first, count, std::cos(northStarZenith), std::sin(northStarZenith),
+				std::cos(starRotation), std::sin(starRotation), x, y, z);
+
+			return count;
+		}
+
+		int StarCatalog::BuildStarField(float northStarZenith, float starRotation, float limitingMagnitude, float radius, StarVertex * vertecies, int maxVertecies) const
+		{
+			if (vertecies == NULL || maxVertecies <= 0)
+				return 0;
+
+			int count = CountStarsBrighterThan(limitingMagnitude);
+
+			if (count == 0)
+				return 0;
+
+			//the brightness and size of each quantized magnitude
+			float brightness[256];
+			float sizes[256];
+			_BrightnessTable(limitingMagnitude, _magnitudes[count - 1], brightness, sizes);
+
+			float cosZ = std::cos(northStarZenith);
+			float sinZ = std::sin(northStarZenith);
+			float cosR = std::cos(starRotation);
+			float sinR = std::sin(starRotation);
+
+			float x[_StarBatchSize];
+			float y[_StarBatchSize];
+			float z[_StarBatchSize];
+
+			int written = 0;
+
+			for (int start = 0; start < count && written < maxVertecies; start += _StarBatchSize)
+			{
+				int batch = std::min(_StarBatchSize, count - start);
+
+				_RotateStars(_x + start, _y + start, _z + start, batch, cosZ, sinZ, cosR, sinR, x, y, z);
+
+				for (int i = 0; i < batch && written < maxVertecies; i++)
+				{
+					int q = _magnitudes[start + i];
+
+					//below the horizon or faded out
+					if (y[i] <= 0.0f || brightness[q] <= 0.0f)
+						continue;
+
+					_SetStarVertex(vertecies[written++], x[i], y[i], z[i], radius, brightness[q], sizes[q], _colorIndecies[start + i]);
+				}
+			}
+
+			return written;
+		}
+
+		std::shared_ptr<const StarCatalog> GetBrightStarCatalog()
+		{
+			std::string key = "BIOSky/Stars/BrightStars";
+
+			std::shared_ptr<const StarCatalog> catalog = AssetStore::Get<StarCatalog>(key);
+
+			if (catalog)
+				return catalog;
+
+			StarCatalog::Star stars[_NumBrightStars];
+
+			for (int i = 0; i < _NumBrightStars; i++)
+			{
+				stars[i].rightAscension = _BrightStars[i][0] * (MATH::PIf / 12.0f);
+				stars[i].declination = _BrightStars[i][1] * MATH::DegreesToRadiansf;
+				stars[i].magnitude = _BrightStars[i][2];
+				stars[i].colorIndex = _BrightStars[i][3];
+			}
+
+			std::shared_ptr<StarCatalog> created = std::make_shared<StarCatalog>();
+			created->SetStars(stars, _NumBrightStars);
+
+			return std::static_pointer_cast<const StarCatalog>(AssetStore::Insert(key, created));
+		}
+
+		StarIndex::StarIndex(std::shared_ptr<const StarCatalog> catalog, int starsPerCell) :
+			_catalog(catalog),
+			_numStars(0),
+			_numLevels(_NumStarLevels),
+			_numCells(0),
+			_levels(NULL),
+			_cells(NULL),
+			_x(NULL),
+			_y(NULL),
+			_z(NULL),
+			_magnitudes(NULL),
+			_colorIndecies(NULL),
+			_catalogIndecies(NULL)
+		{
+			int numStars = (_catalog) ? _catalog->GetStarCount() : 0;
+
+			if (starsPerCell < 1)
+				starsPerCell = 1;
+
+			_levels = AllocateArray<Level>(_numLevels);
+
+			//the catalog is sorted, so the stars of each level are together
+			for (int i = 0; i < numStars; i++)
+			{
+				Level & level = _levels[_StarLevel(_catalog->_magnitudes[i])];
+
+				if (level.numStars == 0)
+					level.brightest = _MagnitudeValue(_catalog->_magnitudes[i]);
+
+				level.numStars++;
+			}
+
+			for (int l = 0; l < _numLevels; l++)
+			{
+				Level & level = _levels[l];
+
+				int cellsPerFace = (int)std::ceil(std::sqrt(level.numStars / (6.0f * starsPerCell)));
+
+				level.firstCell = _numCells;
+				level.cellsPerFace = std::max(1, std::min(_MaxCellsPerFace, cellsPerFace));
+
+				if (level.numStars == 0)
+					level.brightest = _MagnitudeValue(255);
+
+				_numCells += 6 * level.cellsPerFace * level.cellsPerFace;
+			}
+
+			_cells = AllocateArray<Cell>(_numCells);
+
+			//the bounding cone of every cell
+			for (int l = 0; l < _numLevels; l++)
+			{
+				int cellsPerFace = _levels[l].cellsPerFace;
+				float step = 2.0f / cellsPerFace;
+				Cell * cells = _cells + _levels[l].firstCell;
+
+				for (int face = 0; face < 6; face++)
+				{
+					for (int row = 0; row < cellsPerFace; row++)
+					{
+						for (int column = 0; column < cellsPerFace; column++)
+						{
+							Cell & cell = cells[(face * cellsPerFace + row) * cellsPerFace + column];
+
+							float u = -1.0f + column * step;
+							float v = -1.0f + row * step;
+
+							cell.axis = _CubeDirection(face, u + step * 0.5f, v + step * 0.5f);
+
+							//the corners are the farthest points from the center
+							float minDot = 1.0f;
+							for (int corner = 0; corner < 4; corner++)
+							{
+								Vector3D c = _CubeDirection(face, u + step * (corner & 1), v + step * (corner >> 1));
+								float dot = c.X * cell.axis.X + c.Y * cell.axis.Y + c.Z * cell.axis.Z;
+
+								minDot = std::min(minDot, dot);
+							}
+
+							cell.halfAngle = std::acos(std::max(-1.0f, std::min(1.0f, minDot))) + 0.0001f;
+						}
+					}
+				}
+			}
+
+			if (numStars == 0)
+				return;
+
+			//count the stars of each cell
+			int * starCells = AllocateArray<int>(numStars);
+
+			for (int i = 0; i < numStars; i++)
+			{
+				const Level & level = _levels[_StarLevel(_catalog->_magnitudes[i])];
+
+				starCells[i] = level.firstCell + _CubeCell(_catalog->_x[i], _catalog->_y[i], _catalog->_z[i], level.cellsPerFace);
+				_cells[starCells[i]].count++;
+			}
+
+			int total = 0;
+			for (int c = 0; c < _numCells; c++)
+			{
+				_cells[c].first = total;
+				total += _cells[c].count;
+				_cells[c].count = 0;
+			}
+
+			_numStars = numStars;
+			_x = AllocateArray<float>(numStars);
+			_y = AllocateArray<float>(numStars);
+			_z = AllocateArray<float>(numStars);
+			_magnitudes = AllocateArray<unsigned char>(numStars);
+			_colorIndecies = AllocateArray<unsigned char>(numStars);
+			_catalogIndecies = AllocateArray<int>(numStars);
+
+			//going through the sorted catalog in order leaves every cell
+			//sorted too
+			for (int i = 0; i < numStars; i++)
+			{
+				Cell & cell = _cells[starCells[i]];
+				int to = cell.first + cell.count++;
+
+				_x[to] = _catalog->_x[i];
+				_y[to] = _catalog->_y[i];
+				_z[to] = _catalog->_z[i];
+				_magnitudes[to] = _catalog->_magnitudes[i];
+				_colorIndecies[to] = _catalog->_colorIndecies[i];
+				_catalogIndecies[to] = i;
+			}
+
+			FreeArray(starCells);
+		}
+
+		StarIndex::~StarIndex()
+		{
+			FreeArray(_levels);
+			FreeArray(_cells);
+			FreeArray(_x);
+			FreeArray(_y);
+			FreeArray(_z);
+			FreeArray(_magnitudes);
+			FreeArray(_colorIndecies);
+			FreeArray(_catalogIndecies);
+		}
+
+		int StarIndex::FindCell(int level, const Vector3D & direction) const
+		{
+			const Level & l = GetLevel(level);
+
+			return l.firstCell + _CubeCell(direction.X, direction.Y, direction.Z, l.cellsPerFace);
+		}
+
+		std::size_t StarIndex::GetMemorySize() const
+		{
+			return (std::size_t)_numLevels * sizeof(Level) + (std::size_t)_numCells * sizeof(Cell) +
+				(std::size_t)_numStars * (3 * sizeof(float) + 2 * sizeof(unsigned char) + sizeof(int));
+		}
+
+		int StarIndex::FindVisibleStars(float northStarZenith, float starRotation, float limitingMagnitude, int * stars, int maxStars) const
+		{
+			if (stars == NULL)
+				return 0;
+
+			return _Query(northStarZenith, starRotation, limitingMagnitude, 1.0f, stars, NULL, maxStars);
+		}
+
+		int StarIndex::BuildStarField(float northStarZenith, float starRotation, float limitingMagnitude, float radius, StarVertex * vertecies, int maxVertecies) const
+		{
+			if (vertecies == NULL)
+				return 0;
+
+			return _Query(northStarZenith, starRotation, limitingMagnitude, radius, NULL, vertecies, maxVertecies);
+		}
+
+		int StarIndex::_Query(float northStarZenith, float starRotation, float limitingMagnitude, float radius, int * stars, StarVertex * vertecies, int maxStars) const
+		{
+			int limit = _MagnitudeLimit(limitingMagnitude);
+
+			if (maxStars <= 0 || _numStars == 0 || limit < 0)
+				return 0;
+
+			float brightness[256];
+			float sizes[256];
+			_BrightnessTable(limitingMagnitude, limit, brightness, sizes);
+
+			float cosZ = std::cos(northStarZenith);
+			float sinZ = std::sin(northStarZenith);
+			float cosR = std::cos(starRotation);
+			float sinR = std::sin(starRotation);
+
+			float x[_StarBatchSize];
+			float y[_StarBatchSize];
+			float z[_StarBatchSize];
+
+			int found = 0;
+
+			for (int l = 0; l < _numLevels && found < maxStars; l++)
+			{
+				const Level & level = _levels[l];
+
+				//the levels are sorted, so the rest are too faint
+				if (level.numStars > 0 && _QuantizeMagnitude(level.brightest) > limit)
+					break;
+
+				int lastCell = level.firstCell + 6 * level.cellsPerFace * level.cellsPerFace;
+
+				for (int c = level.firstCell; c < lastCell && found < maxStars; c++)
+				{
+					const Cell & cell = _cells[c];
+
+					if (cell.count == 0 || _magnitudes[cell.first] > limit)
+						continue;
+
+					//rotate about Y then X. Only the height is needed.
+					float axisZ = -cell.axis.X * sinR + cell.axis.Z * cosR;
+					float up = cell.axis.Y * cosZ - axisZ * sinZ;
+
+					if (up <= -std::sin(std::min(cell.halfAngle, MATH::PId2f)))
+						continue;
+
+					//the stars of the cell that are bright enough
+					const unsigned char * magnitudes = _magnitudes + cell.first;
+					int count = (int)(std::upper_bound(magnitudes, magnitudes + cell.count, (unsigned char)limit) - magnitudes);
+
+					for (int start = 0; start < count && found < maxStars; start += _StarBatchSize)
+					{
+						int first = cell.first + start;
+						int batch = std::min(_StarBatchSize, count - start);
+
+						_RotateStars(_x + first, _y + first, _z + first, batch, cosZ, sinZ, cosR, sinR, x, y, z);
+
+						for (int i = 0; i < batch && found < maxStars; i++)
+						{
+							int q = _magnitudes[first + i];
+
+							//below the horizon or faded out
+							if (y[i] <= 0.0f || brightness[q] <= 0.0f)
+								continue;
+
+							if (stars)
+								stars[found] = _catalogIndecies[first + i];
+							else
+								_SetStarVertex(vertecies[found], x[i], y[i], z[i], radius, brightness[q], sizes[q], _colorIndecies[first + i]);
+
+							found++;
+						}
+					}
+				}
+			}
+
+			return found;
+		}
+
+#if BIOSKY_TESTING == 1
+		namespace
+		{
+			/**
+			* Write one BSC5 entry with a star number, one magnitude and
+			* proper motion.
+			*/
+			void _WriteBSC5Entry(unsigned char * entry, bool bigEndian, float number, double rightAscension, double declination, const char * type, short magnitude)
+			{
+				unsigned char bytes[8];
+
+				memcpy(bytes, &number, 4);
+				for (int i = 0; i < 4; i++)
+					entry[i] = (bigEndian) ? bytes[3 - i] : bytes[i];
+
+				memcpy(bytes, &rightAscension, 8);
+				for (int i = 0; i < 8; i++)
+					entry[4 + i] = (bigEndian) ? bytes[7 - i] : bytes[i];
+
+				memcpy(bytes, &declination, 8);
+				for (int i = 0; i < 8; i++)
+					entry[12 + i] = (bigEndian) ? bytes[7 - i] : bytes[i];
+
+				entry[20] = (unsigned char)type[0];
+				entry[21] = (unsigned char)type[1];
+
+				memcpy(bytes, &magnitude, 2);
+				for (int i = 0; i < 2; i++)
+					entry[22 + i] = (bigEndian) ? bytes[1 - i] : bytes[i];
+
+				//no proper motion
+				memset(entry + 24, 0, 8);
+			}
+
+			/**
+			* Build a BSC5 file with four entries, one of them removed.
+			*/
+			std::size_t _WriteBSC5(unsigned char * data, bool bigEndian)
+			{
+				const int header[7] = { 0, 1, -4, 1, 1, -1, 32 };
+
+				for (int h = 0; h < 7; h++)
+				{
+					unsigned char bytes[4];
+					memcpy(bytes, &header[h], 4);
+
+					for (int i = 0; i < 4; i++)
+						data[h * 4 + i] = (bigEndian) ? bytes[3 - i] : bytes[i];
+				}
+
+				_WriteBSC5Entry(data + 28, bigEndian, 1.0f, 1.0, 0.5, "K5", 450);
+				_WriteBSC5Entry(data + 60, bigEndian, 2.0f, 0.0, 0.0, "  ", 0);
+				_WriteBSC5Entry(data + 92, bigEndian, 3.0f, 3.0, -0.25, "A0", -120);
+				_WriteBSC5Entry(data + 124, bigEndian, 4.0f, 5.0, 1.5, "G2", 200);
+
+				return 28 + 4 * 32;
+			}
+		}
+
+		bool StarCatalog::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Star Catalog Tests");
+
+			test->UnitTest(sizeof(StarVertex) == 24, "Star vertex size");
+
+			//empty
+			StarCatalog empty;
+			StarVertex vertex;
+			test->UnitTest(empty.GetStarCount() == 0 && empty.CountStarsBrighterThan(10.0f) == 0, "Empty catalog");
+			test->UnitTest(empty.BuildStarField(0.5f, 0.5f, 6.5f, 1.0f, &vertex, 1) == 0, "Empty star field");
+			test->UnitTest(empty.SaveCompact(NULL, 0) == 12, "Empty catalog size");
+
+			//set stars
+			Star stars[3] = {
+				{ 0.0f, 0.0f, 3.0f, 1.5f },
+				{ MATH::PId2f, 0.0f, -1.0f, -0.2f },
+				{ 0.0f, MATH::PId2f, 1.01f, 0.0f }
+			};
+
+			StarCatalog catalog;
+			test->UnitTest(catalog.SetStars(stars, 3) && catalog.GetStarCount() == 3, "Set stars");
+			test->UnitTest(catalog.GetStarMagnitude(0) == -1.0f && catalog.GetStarMagnitude(2) == 3.0f, "Sorted by magnitude");
+			test->UnitTest(std::fabs(catalog.GetStarMagnitude(1) - 1.0f) < 0.001f, "Magnitude is quantized");
+
+			StarCatalog faint;
+			Star faintStar = { 0.0f, 0.0f, 12.0f, 0.0f };
+			test->UnitTest(faint.SetStars(&faintStar, 1) && faint.GetStarMagnitude(0) == 10.75f && faint.CountStarsBrighterThan(10.75f) == 1, "Faint magnitudes saturate at 10.75");
+			test->UnitTest(std::fabs(catalog.GetStarColorIndex(2) - 1.5f) < 0.001f && std::fabs(catalog.GetStarColorIndex(0) + 0.2f) < 0.001f, "Color index");
+
+			Vector3D direction = catalog.GetStarDirection(0);
+			test->UnitTest(std::fabs(direction.X) < 0.0001f && std::fabs(direction.Z - 1.0f) < 0.0001f, "Right ascension 6 hours is +Z");
+			direction = catalog.GetStarDirection(1);
+			test->UnitTest(std::fabs(direction.Y - 1.0f) < 0.0001f, "The north pole is +Y");
+
+			test->UnitTest(catalog.CountStarsBrighterThan(-2.0f) == 0 && catalog.CountStarsBrighterThan(-1.0f) == 1 &&
+				catalog.CountStarsBrighterThan(2.0f) == 2 && catalog.CountStarsBrighterThan(20.0f) == 3, "Count stars brighter than");
+
+			unsigned int red = catalog.GetStarColor(2);
+			unsigned int blue = catalog.GetStarColor(0);
+			test->UnitTest((red >> 24) == 0xFF && ((red >> 16) & 0xFF) > (red & 0xFF) && ((blue >> 16) & 0xFF) < (blue & 0xFF), "Star colors");
+
+			//compact format
+			std::size_t size = catalog.SaveCompact(NULL, 0);
+			unsigned char * compact = new unsigned char[size];
+			test->UnitTest(size == 12 + 3 * 8 && catalog.SaveCompact(compact, size - 1) == 0 && catalog.SaveCompact(compact, size) == size, "Save compact");
+
+			StarCatalog loaded;
+			bool same = loaded.LoadCompact(compact, size) && loaded.GetStarCount() == 3;
+			for (int i = 0; same && i < 3; i++)
+			{
+				Vector3D a = catalog.GetStarDirection(i);
+				Vector3D b = loaded.GetStarDirection(i);
+
+				if (loaded.GetStarMagnitude(i) != catalog.GetStarMagnitude(i) || loaded.GetStarColorIndex(i) != catalog.GetStarColorIndex(i) ||
+					std::fabs(a.X - b.X) > 0.0001f || std::fabs(a.Y - b.Y) > 0.0001f || std::fabs(a.Z - b.Z) > 0.0001f)
+					same = false;
+			}
+			test->UnitTest(same, "Load compact");
+
+			test->UnitTest(!loaded.LoadCompact(compact, size - 1), "Truncated compact catalog");
+			compact[0] = 'X';
+			test->UnitTest(!loaded.LoadCompact(compact, size), "Bad compact catalog");
+			delete[] compact;
+
+			//BSC5 in both byte orders
+			unsigned char bsc5[28 + 4 * 32];
+			for (int order = 0; order < 2; order++)
+			{
+				std::size_t bscSize = _WriteBSC5(bsc5, order == 1);
+
+				StarCatalog bsc;
+				bool read = bsc.LoadBSC5(bsc5, bscSize) && bsc.GetStarCount() == 3;
+
+				if (read)
+				{
+					direction = bsc.GetStarDirection(0);
+
+					read = std::fabs(bsc.GetStarMagnitude(0) + 1.2f) < 0.001f && std::fabs(bsc.GetStarColorIndex(0)) < 0.001f &&
+						std::fabs(direction.Y - std::sin(-0.25f)) < 0.0001f &&
+						std::fabs(direction.X - std::cos(-0.25f) * std::cos(3.0f)) < 0.0001f &&
+						std::fabs(bsc.GetStarMagnitude(2) - 4.5f) < 0.001f && std::fabs(bsc.GetStarColorIndex(2) - 1.11f) < 0.006f &&
+						std::fabs(bsc.GetStarColorIndex(1) - 0.624f) < 0.006f;
+				}
+
+				test->UnitTest(read, (order == 0) ? "Load BSC5 little endian" : "Load BSC5 big endian");
+
+				test->UnitTest(!bsc.LoadBSC5(bsc5, bscSize - 1), "Truncated BSC5");
+			}
+
+			//the bright stars
+			std::shared_ptr<const StarCatalog> bright = GetBrightStarCatalog();
+			test->UnitTest(bright && bright.get() == GetBrightStarCatalog().get(), "Bright star catalog is shared");
+			test->UnitTest(bright->GetStarCount() == _NumBrightStars && std::fabs(bright->GetStarMagnitude(0) + 1.45f) < 0.001f, "Sirius is the brightest star");
+
+			bool ordered = true;
+			for (int i = 1; i < bright->GetStarCount(); i++)
+			{
+				if (bright->GetStarMagnitude(i) < bright->GetStarMagnitude(i - 1))
+					ordered = false;
+			}
+			test->UnitTest(ordered, "Bright stars are sorted");
+
+			//rotation matches the SIMD and scalar code and the night sky dome
+			int numBright = bright->GetStarCount();
+			float * rx = new float[numBright];
+			float * ry = new float[numBright];
+			float * rz = new float[numBright];
+
+			float zenith = CalculateCelestialNorthPoleZenith(40.0f * MATH::DegreesToRadiansf);
+			float rotation = CalculateStarRotation(21.5f, -7.0f);
+
+			test->UnitTest(bright->RotateStars(zenith, rotation, 1, numBright, rx, ry, rz) == numBright - 1, "Rotate stars count");
+
+			bool rotated = true;
+			for (int i = 1; i < numBright; i++)
+			{
+				Vector3D d = bright->GetStarDirection(i);
+
+				double x = d.X * std::cos((double)rotation) + d.Z * std::sin((double)rotation);
+				double z = d.Z * std::cos((double)rotation) - d.X * std::sin((double)rotation);
+				double up = d.Y * std::cos((double)zenith) - z * std::sin((double)zenith);
+				double south = d.Y * std::sin((double)zenith) + z * std::cos((double)zenith);
+
+				if (std::fabs(rx[i - 1] - x) > 0.0001 || std::fabs(ry[i - 1] - up) > 0.0001 || std::fabs(rz[i - 1] - south) > 0.0001)
+					rotated = false;
+			}
+			test->UnitTest(rotated, "Rotate stars");
+
+			//Polaris is as high as the latitude at any time
+			int polaris = -1;
+			for (int i = 0; i < numBright; i++)
+			{
+				if (bright->GetStarDirection(i).Y > 0.999f)
+					polaris = i;
+			}
+			bright->RotateStars(zenith, rotation + 1.0f, 0, numBright, rx, ry, rz);
+			test->UnitTest(polaris >= 0 && std::fabs(std::asin(ry[polaris]) - 40.0f * MATH::DegreesToRadiansf) < 0.015f, "Polaris altitude");
+
+			//star field
+			StarVertex field[256];
+			int numVisible = bright->BuildStarField(zenith, rotation, DefaultLimitingMagnitude, 10.0f, field, 256);
+
+			bright->RotateStars(zenith, rotation, 0, numBright, rx, ry, rz);
+			int above = 0;
+			for (int i = 0; i < numBright; i++)
+			{
+				if (ry[i] > 0.0f)
+					above++;
+			}
+			test->UnitTest(numVisible > 0 && numVisible == above, "Every star above the horizon is drawn");
+
+			bool onDome = true;
+			bool dimmer = true;
+			for (int i = 0; i < numVisible; i++)
+			{
+				float length = std::sqrt(field[i].position.X * field[i].position.X + field[i].position.Y * field[i].position.Y + field[i].position.Z * field[i].position.Z);
+
+				if (field[i].position.Y <= 0.0f || std::fabs(length - 10.0f) > 0.001f)
+					onDome = false;
+
+				if (field[i].brightness <= 0.0f || field[i].brightness > 1.0f || (field[i].color >> 24) != (unsigned int)(field[i].brightness * 255.0f + 0.5f))
+					dimmer = false;
+
+				if (i > 0 && field[i].brightness > field[i - 1].brightness)
+					dimmer = false;
+			}
+			test->UnitTest(onDome, "Stars are above the horizon on the dome");
+			test->UnitTest(dimmer, "Brightness falls with magnitude");
+
+			test->UnitTest(bright->BuildStarField(zenith, rotation, DefaultLimitingMagnitude, 10.0f, field, 3) == 3, "Star field is limited to the buffer");
+			test->UnitTest(bright->BuildStarField(zenith, rotation, 1.0f, 10.0f, field, 256) < numVisible, "Limiting magnitude removes stars");
+
+			//with the pole straight up only the magnitude 1 star is above
+			//the horizon. It fades out over the last half magnitude.
+			test->UnitTest(catalog.BuildStarField(0.0f, 0.0f, 1.0f, 1.0f, field, 256) == 0, "A star at the limit has faded out");
+			test->UnitTest(catalog.BuildStarField(0.0f, 0.0f, 1.25f, 1.0f, field, 256) == 1 && std::fabs(field[0].brightness - 0.5f) < 0.001f, "Stars fade at the limit");
+			test->UnitTest(catalog.BuildStarField(0.0f, 0.0f, 3.0f, 1.0f, field, 256) == 1 && field[0].brightness == 1.0f, "Bright stars are full brightness");
+
+			delete[] rx;
+			delete[] ry;
+			delete[] rz;
+
+			return test->GetSuccess();
+		}
+
+		namespace
+		{
+			/**
+			* Find the visible stars of a catalog without an index.
+			*/
+			int _BruteForceVisible(const StarCatalog & catalog, float northStarZenith, float starRotation, float limitingMagnitude, std::vector<bool> & visible)
+			{
+				int count = catalog.CountStarsBrighterThan(limitingMagnitude);
+				std::vector<float> x(count + 1), y(count + 1), z(count + 1);
+
+				catalog.RotateStars(northStarZenith, starRotation, 0, count, &x[0], &y[0], &z[0]);
+
+				visible.assign(catalog.GetStarCount(), false);
+
+				int numVisible = 0;
+				for (int i = 0; i < count; i++)
+				{
+					//stars right at the limit have faded out
+					if (y[i] > 0.0f && catalog.GetStarMagnitude(i) < limitingMagnitude)
+					{
+						visible[i] = true;
+						numVisible++;
+					}
+				}
+
+				return numVisible;
+			}
+
+			/**
+			* Check that the index finds the same stars as the brute force
+			* search.
+			*/
+			bool _SameStars(const StarIndex & index, float northStarZenith, float starRotation, float limitingMagnitude, std::vector<int> & found)
+			{
+				std::vector<bool> visible;
+				int expected = _BruteForceVisible(*index.GetCatalog(), northStarZenith, starRotation, limitingMagnitude, visible);
+
+				found.resize(index.GetStarCount() + 1);
+				int numFound = index.FindVisibleStars(northStarZenith, starRotation, limitingMagnitude, &found[0], (int)found.size());
+
+				if (numFound != expected)
+					return false;
+
+				for (int i = 0; i < numFound; i++)
+				{
+					if (!visible[found[i]])
+						return false;
+
+					//each star only once
+					visible[found[i]] = false;
+				}
+
+				return true;
+			}
+		}
+
+		bool StarIndex::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Star Index Tests");
+
+			//empty
+			StarIndex empty(std::make_shared<StarCatalog>());
+			int star;
+			StarVertex vertex;
+			test->UnitTest(empty.GetStarCount() == 0, "Empty index");
+			test->UnitTest(empty.FindVisibleStars(0.5f, 0.5f, 6.5f, &star, 1) == 0 && empty.BuildStarField(0.5f, 0.5f, 6.5f, 1.0f, &vertex, 1) == 0, "Empty query");
+
+			test->UnitTest(empty.GetLevelCount() == 10 && empty.GetCellCount() == 60, "Empty levels");
+
+			//levels and cells. The bright stars are magnitude -1.45 to 3.3.
+			std::shared_ptr<const StarCatalog> bright = GetBrightStarCatalog();
+			StarIndex index(bright, 2);
+			test->UnitTest(index.GetStarCount() == bright->GetStarCount(), "Index star count");
+			test->UnitTest(index.GetLevel(0).numStars + index.GetLevel(1).numStars + index.GetLevel(2).numStars == bright->GetStarCount() &&
+				index.GetLevel(3).numStars == 0, "Stars are split by magnitude");
+			test->UnitTest(index.GetLevel(0).brightest == bright->GetStarMagnitude(0) && index.GetLevel(1).brightest >= 2.0f, "Brightest star of each level");
+			int cellsPerFace = (int)std::ceil(std::sqrt(index.GetLevel(0).numStars / 12.0f));
+			test->UnitTest(cellsPerFace > 1 && index.GetLevel(0).cellsPerFace == cellsPerFace && index.GetLevel(3).cellsPerFace == 1 &&
+				index.GetLevel(1).firstCell == 6 * cellsPerFace * cellsPerFace, "Cells per face");
+			test->UnitTest(StarIndex(bright).GetLevel(0).cellsPerFace == 1, "Default stars per cell");
+
+			bool covered = true;
+			for (int i = 0; i < bright->GetStarCount(); i++)
+			{
+				Vector3D d = bright->GetStarDirection(i);
+				int level = (bright->GetStarMagnitude(i) < 2.0f) ? 0 : (bright->GetStarMagnitude(i) < 3.0f) ? 1 : 2;
+				const Cell & cell = index.GetCell(index.FindCell(level, d));
+				float dot = d.X * cell.axis.X + d.Y * cell.axis.Y + d.Z * cell.axis.Z;
+
+				if (std::acos(std::min(1.0f, dot)) > cell.halfAngle)
+					covered = false;
+			}
+			test->UnitTest(covered, "Stars are inside the cone of their cell");
+
+			bool sorted = true;
+			int total = 0;
+			for (int c = 0; c < index.GetCellCount(); c++)
+			{
+				const Cell & cell = index.GetCell(c);
+
+				if (cell.first != total)
+					sorted = false;
+
+				for (int i = cell.first + 1; i < cell.first + cell.count; i++)
+				{
+					if (index._magnitudes[i] < index._magnitudes[i - 1])
+						sorted = false;
+				}
+
+				total += cell.count;
+			}
+			test->UnitTest(sorted && total == index.GetStarCount(), "Cells are sorted by magnitude");
+
+			//queries match the catalog
+			std::vector<int> found;
+			float zenith = CalculateCelestialNorthPoleZenith(-33.0f * MATH::DegreesToRadiansf);
+			bool same = true;
+			for (float hour = 0.0f; hour < 24.0f; hour += 1.5f)
+			{
+				if (!_SameStars(index, zenith, CalculateStarRotation(hour, 0.0f), 2.0f, found) ||
+					!_SameStars(index, zenith, CalculateStarRotation(hour, 0.0f), DefaultLimitingMagnitude, found))
+					same = false;
+			}
+			test->UnitTest(same, "Index finds the same stars as the catalog");
+
+			StarVertex fromIndex[256];
+			StarVertex fromCatalog[256];
+			int numIndex = index.BuildStarField(zenith, 1.0f, 1.5f, 5.0f, fromIndex, 256);
+			int numCatalog = bright->BuildStarField(zenith, 1.0f, 1.5f, 5.0f, fromCatalog, 256);
+			float brightnessIndex = 0.0f;
+			float brightnessCatalog = 0.0f;
+			for (int i = 0; i < numIndex; i++)
+				brightnessIndex += fromIndex[i].brightness;
+			for (int i = 0; i < numCatalog; i++)
+				brightnessCatalog += fromCatalog[i].brightness;
+			test->UnitTest(numIndex > 0 && numIndex == numCatalog && std::fabs(brightnessIndex - brightnessCatalog) < 0.001f, "Index star field");
+			test->UnitTest(index.BuildStarField(zenith, 1.0f, 6.5f, 5.0f, fromIndex, 2) == 2, "Index star field is limited to the buffer");
+
+			//a million stars
+			const int numStars = 1000000;
+			StarCatalog::Star * stars = new StarCatalog::Star[numStars];
+			unsigned int seed = 12345;
+			for (int i = 0; i < numStars; i++)
+			{
+				seed = seed * 1664525u + 1013904223u;
+				float u = (seed >> 8) / 16777216.0f;
+				seed = seed * 1664525u + 1013904223u;
+				float v = (seed >> 8) / 16777216.0f;
+				seed = seed * 1664525u + 1013904223u;
+				float m = (seed >> 8) / 16777216.0f;
+
+				stars[i].rightAscension = u * MATH::PIx2f;
+				stars[i].declination = std::asin(2.0f * v - 1.0f);
+				//about three times as many stars for each magnitude fainter,
+				//like the Tycho catalogue
+				stars[i].magnitude = 12.0f + 2.0f * std::log10(std::max(m, 0.000001f));
+				stars[i].colorIndex = 0.5f;
+			}
+
+			std::shared_ptr<StarCatalog> large = std::make_shared<StarCatalog>();
+			large->SetStars(stars, numStars);
+			delete[] stars;
+
+			StarIndex largeIndex(large);
+
+			test->UnitTest(largeIndex.GetLevel(9).cellsPerFace == 64 && largeIndex.GetLevel(0).cellsPerFace == 1, "Large index cells");
+			test->UnitTest(largeIndex.GetMemorySize() < (std::size_t)numStars * 18 + numStars, "Large index memory");
+
+			float rotation = CalculateStarRotation(3.0f, 0.0f);
+			test->UnitTest(_SameStars(largeIndex, zenith, rotation, 4.0f, found) && _SameStars(largeIndex, zenith, rotation, 9.0f, found), "Large index finds the same stars");
+
+			StarVertex * field = new StarVertex[numStars];
+			bool sameField = true;
+			//twilight, a dark sky, and binoculars
+			const float limits[3] = {
+				CalculateLimitingMagnitude(CalculateZenithSkyLuminance(98.0f * MATH::DegreesToRadiansf)),
+				CalculateLimitingMagnitude(CalculateZenithSkyLuminance(120.0f * MATH::DegreesToRadiansf)),
+				9.0f
+			};
+
+			for (int l = 0; l < 3; l++)
+			{
+				float limit = limits[l];
+
+				int numIndexed = largeIndex.BuildStarField(zenith, rotation, limit, 1.0f, field, numStars);
+				int numAll = large->BuildStarField(zenith, rotation, limit, 1.0f, field, numStars);
+
+				if (numIndexed != numAll)
+					sameField = false;
+			}
+			delete[] field;
+
+			test->UnitTest(sameField, "Large star field");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,346 @@
+/**
+* @file SunTexture.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the sun texture functions defined in BIOSkyFunctions.hpp.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "BIOSkyFunctions.hpp"
+#include "AssetStore.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#if BIOSKY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			/**
+			* The shape of the sun sprite for one texture size.
+			*/
+			struct SunShape
+			{
+				/**radius of the solid sun*/
+				float radius;
+				/**radius where the sun fades into the glow*/
+				float radiusF;
+				/**radius where the glow ends*/
+				float radiusG;
+				/**alpha percentage at the start of the glow*/
+				float glowStart;
+			};
+
+			inline SunShape _GetSunShape(int sideLength)
+			{
+				//get the center point of the texture
+				float c = sideLength / 2.0f;
+
+				SunShape shape;
+				shape.radius = c * 0.45f;
+				shape.radiusF = c * 0.55f;
+				shape.radiusG = c * 0.98f;
+				shape.glowStart = 0.125f;
+
+				return shape;
+			}
+
+			/**
+			* Calculate the alpha of the sun a distance from the center.
+			*/
+			inline unsigned char _SunAlpha(const SunShape & s, float dist)
+			{
+				if (dist <= s.radius)
+					return 255; //completely opaque
+
+				if (dist <= s.radiusF)
+					return (unsigned char)((((1 - ((dist - s.radius) / (s.radiusF - s.radius))) * (1.0f - s.glowStart)) + s.glowStart) * 255.0f);
+
+				if (dist <= s.radiusG)
+					return (unsigned char)(((1 - ((dist - s.radius) / (s.radiusG - s.radius))) * s.glowStart) * 255.0f);
+
+				return 0; //completely transparent
+			}
+
+			/**
+			* Calculate the alpha for one row of the octant.
+			*
+			* @param s The sun shape.
+			*
+			* @param rowOffset The distance of this row from the center.
+			*
+			* @param offsets The distance of every column from the center.
+			*			This array must be padded to a multiple of 4.
+			*
+			* @param count The number of columns to calculate.
+			*
+			* @param[out] alpha The calculated alpha values. Must be padded
+			*			to a multiple of 4.
+			*/
+			void _SunAlphaRow(const SunShape & s, float rowOffset, const float * offsets, int count, unsigned char * alpha)
+			{
+#if BIOSKY_USE_SSE2
+				const __m128 radius = _mm_set1_ps(s.radius);
+				const __m128 radiusF = _mm_set1_ps(s.radiusF);
+				const __m128 radiusG = _mm_set1_ps(s.radiusG);
+				const __m128 one = _mm_set1_ps(1.0f);
+				const __m128 full = _mm_set1_ps(255.0f);
+				const __m128 glowStart = _mm_set1_ps(s.glowStart);
+				const __m128 fadeScale = _mm_set1_ps(1.0f - s.glowStart);
+				const __m128 fadeWidth = _mm_set1_ps(s.radiusF - s.radius);
+				const __m128 glowWidth = _mm_set1_ps(s.radiusG - s.radius);
+				const __m128 row2 = _mm_set1_ps(rowOffset * rowOffset);
+
+				for (int i = 0; i < count; i += 4)
+				{
+					__m128 o = _mm_loadu_ps(offsets + i);
+					__m128 dist = _mm_sqrt_ps(_mm_add_ps(row2, _mm_mul_ps(o, o)));
+					__m128 fromSun = _mm_sub_ps(dist, radius);
+
+					__m128 fade = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(one, _mm_div_ps(fromSun, fadeWidth)), fadeScale), glowStart), full);
+					__m128 glow = _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(one, _mm_div_ps(fromSun, glowWidth)), glowStart), full);
+
+					__m128 inSun = _mm_cmple_ps(dist, radius);
+					__m128 inFade = _mm_cmple_ps(dist, radiusF);
+					__m128 inGlow = _mm_cmple_ps(dist, radiusG);
+
+					//pick from the outside in
+					__m128 value = _mm_and_ps(inGlow, glow);
+					value = _mm_or_ps(_mm_and_ps(inFade, fade), _mm_andnot_ps(inFade, value));
+					value = _mm_or_ps(_mm_and_ps(inSun, full), _mm_andnot_ps(inSun, value));
+
+					__m128i packed = _mm_cvttps_epi32(value);
+					packed = _mm_packs_epi32(packed, packed);
+					packed = _mm_packus_epi16(packed, packed);
+
+					int four = _mm_cvtsi128_si32(packed);
+					memcpy(alpha + i, &four, 4);
+				}
+#else
+				for (int i = 0; i < count; ++i)
+				{
+					alpha[i] = _SunAlpha(s, std::sqrt(rowOffset * rowOffset + offsets[i] * offsets[i]));
+				}
+#endif
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		unsigned char * CreateSunTexture(int sideLength)
+		{
+			if (sideLength <= 0)
+				return NULL;
+
+			int size = CreateSunTexture(sideLength, NULL, 0);
+
+			//format B G R A all 8 bits;
+			unsigned char * rtn = new unsigned char[size];
+
+			CreateSunTexture(sideLength, rtn, size);
+
+			return rtn;
+		}
+
+		int CreateSunTexture(int sideLength, unsigned char * buffer, int bufferSize)
+		{
+			if (sideLength <= 0)
+				return 0;
+
+			int size = sideLength * sideLength * 4;
+
+			if (buffer == NULL || bufferSize < size)
+				return size;
+
+			SunShape shape = _GetSunShape(sideLength);
+			float c = sideLength / 2.0f;
+
+			//The sprite is symmetric around its center. Only the bottom
+			//right quadrant is calculated, and only the octant of that
+			//quadrant below the diagonal. Everything else is mirrored.
+			int n = (sideLength + 1) / 2;		//rows/columns in a quadrant
+			int start = sideLength - n;			//first index of the quadrant
+			int padded = (n + 3) & ~3;
+
+			float * offsets = AllocateArray<float>(padded);
+			unsigned char * quadrant = AllocateArray<unsigned char>(n * padded);
+			unsigned char * row = AllocateArray<unsigned char>(padded);
+
+			for (int i = 0; i < padded; ++i)
+			{
+				//distance from the center of the texture to the center of
+				//the pixel.
+				offsets[i] = (start + i) + 0.5f - c;
+			}
+
+			for (int m = 0; m < n; ++m)
+			{
+				_SunAlphaRow(shape, offsets[m], offsets, m + 1, row);
+
+				for (int l = 0; l <= m; ++l)
+				{
+					quadrant[m * padded + l] = row[l];
+					quadrant[l * padded + m] = row[l];
+				}
+			}
+
+			//write the four quadrants
+			unsigned char * line = AllocateArray<unsigned char>(sideLength * 4);
+
+			for (int m = 0; m < n; ++m)
+			{
+				const unsigned char * alpha = quadrant + m * padded;
+
+				for (int l = 0; l < n; ++l)
+				{
+					unsigned char * right = line + (start + l) * 4;
+					unsigned char * left = line + (n - 1 - l) * 4;
+
+					right[0] = left[0] = 255;	//B value
+					right[1] = left[1] = 255;	//G value
+					right[2] = left[2] = 255;	//R value
+					right[3] = left[3] = alpha[l];	//A value
+				}
+
+				memcpy(buffer + (start + m) * sideLength * 4, line, sideLength * 4);
+				memcpy(buffer + (n - 1 - m) * sideLength * 4, line, sideLength * 4);
+			}
+
+			FreeArray(line);
+			FreeArray(row);
+			FreeArray(quadrant);
+			FreeArray(offsets);
+
+			return size;
+		}
+
+		std::shared_ptr<const TextureMipChain> CreateSunTextureMipChain(int sideLength)
+		{
+			if (sideLength <= 0)
+				return std::shared_ptr<const TextureMipChain>();
+
+			std::string key = "BIOSky/Sun/MipChain/" + std::to_string(sideLength);
+
+			std::shared_ptr<const TextureMipChain> chain = AssetStore::Get<TextureMipChain>(key);
+
+			if (chain)
+				return chain;
+
+			int size = CreateSunTexture(sideLength, NULL, 0);
+			unsigned char * image = AllocateArray<unsigned char>(size);
+
+			CreateSunTexture(sideLength, image, size);
+
+			chain = std::make_shared<TextureMipChain>(image, sideLength, sideLength);
+
+			FreeArray(image);
+
+			return std::static_pointer_cast<const TextureMipChain>(AssetStore::Insert(key, chain));
+		}
+
+#if BIOSKY_TESTING == 1
+		bool SunTextureTests(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Sun Texture Tests");
+
+			const int sizes[] = { 1, 2, 7, 50, 64, 128, 131 };
+			const int numSizes = sizeof(sizes) / sizeof(sizes[0]);
+
+			for (int s = 0; s < numSizes; ++s)
+			{
+				int side = sizes[s];
+				SunShape shape = _GetSunShape(side);
+				float c = side / 2.0f;
+
+				unsigned char * tex = CreateSunTexture(side);
+
+				bool matches = true;
+				bool symmetric = true;
+
+				for (int i = 0; i < side; ++i)
+				{
+					for (int j = 0; j < side; ++j)
+					{
+						const unsigned char * p = tex + (i * side + j) * 4;
+
+						float dist = MATH::Distance(i + 0.5f, j + 0.5f, c, c);
+						int expected = _SunAlpha(shape, dist);
+
+						if (p[0] != 255 || p[1] != 255 || p[2] != 255 || std::abs(expected - (int)p[3]) > 1)
+							matches = false;
+
+						if (p[3] != tex[((side - 1 - i) * side + j) * 4 + 3] ||
+							p[3] != tex[(j * side + i) * 4 + 3])
+							symmetric = false;
+					}
+				}
+
+				std::string name = "Sun texture size " + std::to_string(side);
+				test->UnitTest(matches, (name + " matches radial falloff").c_str());
+				test->UnitTest(symmetric, (name + " is symmetric").c_str());
+
+				int size = CreateSunTexture(side, NULL, 0);
+				test->UnitTest(size == side * side * 4, (name + " size query").c_str());
+
+				unsigned char * buffer = new unsigned char[size];
+				test->UnitTest(CreateSunTexture(side, buffer, size) == size, (name + " caller buffer size").c_str());
+				test->UnitTest(memcmp(buffer, tex, size) == 0, (name + " caller buffer").c_str());
+
+				delete[] buffer;
+				FreeTexture(tex);
+			}
+
+			test->UnitTest(CreateSunTexture(0) == NULL, "Sun texture invalid size");
+
+			std::shared_ptr<const TextureMipChain> chain = CreateSunTextureMipChain(64);
+			test->UnitTest(chain && chain->GetLevelCount() == 7, "Sun mip chain level count");
+			test->UnitTest(CreateSunTextureMipChain(64).get() == chain.get(), "Sun mip chain is cached");
+			test->UnitTest(CreateSunTextureMipChain(32).get() != chain.get(), "Sun mip chain keyed by size");
+			test->UnitTest(chain->GetLevel(0).pixels[(32 * 64 + 32) * 4 + 3] == 255, "Sun mip chain center opaque");
+			test->UnitTest(chain->GetLevel(0).pixels[3] == 0, "Sun mip chain corner transparent");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,726 @@
+/**
+* @file TextureCompression.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the block compression functions and the
+* CompressedTexture class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "TextureCompression.hpp"
+#include "Allocator.hpp"
+#include "SkyTrace.hpp"
+
+#include <cstring>
+
+#if BIOSKY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if BIOSKY_TESTING == 1
+#include <cstdlib>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			inline int _BlockCount(int size)
+			{
+				return (size > 0) ? (size + 3) / 4 : 1;
+			}
+
+			inline unsigned short _To565(const unsigned char * bgr)
+			{
+				int b = (bgr[0] * 31 + 127) / 255;
+				int g = (bgr[1] * 63 + 127) / 255;
+				int r = (bgr[2] * 31 + 127) / 255;
+
+				return (unsigned short)((r << 11) | (g << 5) | b);
+			}
+
+			inline void _From565(unsigned short color, int * bgr)
+			{
+				int r = (color >> 11) & 31;
+				int g = (color >> 5) & 63;
+				int b = color & 31;
+
+				bgr[0] = (b << 3) | (b >> 2);
+				bgr[1] = (g << 2) | (g >> 4);
+				bgr[2] = (r << 3) | (r >> 2);
+			}
+
+			inline void _Write16(unsigned char * out, unsigned int value)
+			{
+				out[0] = (unsigned char)(value & 0xFF);
+				out[1] = (unsigned char)((value >> 8) & 0xFF);
+			}
+
+			inline unsigned int _Read16(const unsigned char * in)
+			{
+				return in[0] | (in[1] << 8);
+			}
+
+			/**
+			* Copy a 4x4 block of pixels out of an image. Pixels outside of
+			* the image repeat the last row/column.
+			*/
+			void _FetchBlock(const unsigned char * image, int width, int height, int blockX, int blockY, unsigned char * block)
+			{
+				for (int y = 0; y < 4; ++y)
+				{
+					int sy = blockY * 4 + y;
+					if (sy >= height)
+						sy = height - 1;
+
+					for (int x = 0; x < 4; ++x)
+					{
+						int sx = blockX * 4 + x;
+						if (sx >= width)
+							sx = width - 1;
+
+						memcpy(block + (y * 4 + x) * 4, image + (sy * width + sx) * 4, 4);
+					}
+				}
+			}
+
+			/**
+			* Find the per channel minimum and maximum of a block.
+			*/
+			void _BlockMinMax(const unsigned char * block, unsigned char * minColor, unsigned char * maxColor)
+			{
+#if BIOSKY_USE_SSE2
+				__m128i r0 = _mm_loadu_si128((const __m128i *)(block));
+				__m128i r1 = _mm_loadu_si128((const __m128i *)(block + 16));
+				__m128i r2 = _mm_loadu_si128((const __m128i *)(block + 32));
+				__m128i r3 = _mm_loadu_si128((const __m128i *)(block + 48));
+
+				__m128i mn = _mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3));
+				__m128i mx = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+
+				mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+				mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+				mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+				mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+
+				int value = _mm_cvtsi128_si32(mn);
+				memcpy(minColor, &value, 4);
+				value = _mm_cvtsi128_si32(mx);
+				memcpy(maxColor, &value, 4);
+#else
+				for (int c = 0; c < 4; ++c)
+				{
+					minColor[c] = 255;
+					maxColor[c] = 0;
+				}
+
+				for (int i = 0; i < 16; ++i)
+				{
+					for (int c = 0; c < 4; ++c)
+					{
+						unsigned char v = block[i * 4 + c];
+
+						if (v < minColor[c])
+							minColor[c] = v;
+
+						if (v > maxColor[c])
+							maxColor[c] = v;
+					}
+				}
+#endif
+			}
+
+			/**
+			* Project every pixel of a block onto the line from start along
+			* axis and quantize the position to [0, steps].
+			*
+			* @param block The 16 B G R A pixels.
+			*
+			* @param start The start of the line (B G R A).
+			*
+			* @param axis The direction of the line (B G R A). Channels with
+			*			a 0 are ignored.
+			*
+			* @param steps The number of steps along the line.
+			*
+			* @param[out] t The 16 quantized positions.
+			*/
+			void _ProjectBlock(const unsigned char * block, const float * start, const float * axis, float steps, int * t)
+			{
+				float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3];
+				float scale = (length > 0.0f) ? steps / length : 0.0f;
+
+#if BIOSKY_USE_SSE2
+				const __m128i mask = _mm_set1_epi32(0xFF);
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 top = _mm_set1_ps(steps);
+				const __m128 s = _mm_set1_ps(scale);
+
+				for (int row = 0; row < 4; ++row)
+				{
+					__m128i v = _mm_loadu_si128((const __m128i *)(block + row * 16));
+
+					__m128 b = _mm_cvtepi32_ps(_mm_and_si128(v, mask));
+					__m128 g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 8), mask));
+					__m128 r = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 16), mask));
+					__m128 a = _mm_cvtepi32_ps(_mm_srli_epi32(v, 24));
+
+					__m128 d = _mm_mul_ps(_mm_sub_ps(b, _mm_set1_ps(start[0])), _mm_set1_ps(axis[0]));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(g, _mm_set1_ps(start[1])), _mm_set1_ps(axis[1])));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(r, _mm_set1_ps(start[2])), _mm_set1_ps(axis[2])));
+					d = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(a, _mm_set1_ps(start[3])), _mm_set1_ps(axis[3])));
+
+					d = _mm_max_ps(zero, _mm_min_ps(top, _mm_mul_ps(d, s)));
+
+					_mm_storeu_si128((__m128i *)(t + row * 4), _mm_cvtps_epi32(d));
+				}
+#else
+				for (int i = 0; i < 16; ++i)
+				{
+					const unsigned char * p = block + i * 4;
+
+					float d = (p[0] - start[0]) * axis[0] + (p[1] - start[1]) * axis[1] +
+						(p[2] - start[2]) * axis[2] + (p[3] - start[3]) * axis[3];
+
+					d *= scale;
+
+					if (d < 0.0f)
+						d = 0.0f;
+
+					if (d > steps)
+						d = steps;
+
+					t[i] = (int)(d + 0.5f);
+				}
+#endif
+			}
+
+			/**
+			* Encode the color of a block into 8 bytes of BC1 data.
+			*
+			* @param block The 16 B G R A pixels.
+			*
+			* @param allowTransparent If true pixels with alpha below 128 are
+			*			encoded as transparent using the three color mode.
+			*
+			* @param[out] out The 8 bytes of block data.
+			*/
+			void _EncodeColorBlock(const unsigned char * block, bool allowTransparent, unsigned char * out)
+			{
+				unsigned char minColor[4];
+				unsigned char maxColor[4];
+
+				_BlockMinMax(block, minColor, maxColor);
+
+				bool transparent = allowTransparent && minColor[3] < 128;
+
+				if (transparent)
+				{
+					//only the visible pixels count toward the endpoints
+					minColor[0] = minColor[1] = minColor[2] = 255;
+					maxColor[0] = maxColor[1] = maxColor[2] = 0;
+
+					for (int i = 0; i < 16; ++i)
+					{
+						const unsigned char * p = block + i * 4;
+
+						if (p[3] < 128)
+							continue;
+
+						for (int c = 0; c < 3; ++c)
+						{
+							if (p[c] < minColor[c])
+								minColor[c] = p[c];
+
+							if (p[c] > maxColor[c])
+								maxColor[c] = p[c];
+						}
+					}
+
+					if (maxColor[0] < minColor[0])
+					{
+						//every pixel is transparent
+						_Write16(out, 0);
+						_Write16(out + 2, 0);
+						out[4] = out[5] = out[6] = out[7] = 0xFF;
+						return;
+					}
+				}
+
+				//pull the endpoints in a little. This lowers the error for
+				//the pixels in the middle of the range.
+				for (int c = 0; c < 3; ++c)
+				{
+					int inset = (maxColor[c] - minColor[c]) >> 4;
+					minColor[c] = (unsigned char)(minColor[c] + inset);
+					maxColor[c] = (unsigned char)(maxColor[c] - inset);
+				}
+
+				unsigned short colorMax = _To565(maxColor);
+				unsigned short colorMin = _To565(minColor);
+
+				unsigned int indices = 0;
+
+				if (colorMax != colorMin)
+				{
+					int low[3];
+					int high[3];
+					_From565(colorMin, low);
+					_From565(colorMax, high);
+
+					float start[4] = { (float)low[0], (float)low[1], (float)low[2], 0.0f };
+					float axis[4] = { (float)(high[0] - low[0]), (float)(high[1] - low[1]), (float)(high[2] - low[2]), 0.0f };
+
+					int t[16];
+
+					if (transparent)
+					{
+						_ProjectBlock(block, start, axis, 2.0f, t);
+
+						//position along the line to the three color index
+						const unsigned int remap[3] = { 0, 2, 1 };
+
+						for (int i = 0; i < 16; ++i)
+						{
+							unsigned int index = (block[i * 4 + 3] < 128) ? 3 : remap[t[i]];
+							indices |= index << (i * 2);
+						}
+					}
+					else
+					{
+						_ProjectBlock(block, start, axis, 3.0f, t);
+
+						//position along the line to the four color index
+						const unsigned int remap[4] = { 1, 3, 2, 0 };
+
+						for (int i = 0; i < 16; ++i)
+							indices |= remap[t[i]] << (i * 2);
+					}
+				}
+				else if (transparent)
+				{
+					for (int i = 0; i < 16; ++i)
+					{
+						if (block[i * 4 + 3] < 128)
+							indices |= 3u << (i * 2);
+					}
+				}
+
+				if (transparent)
+				{
+					//color0 <= color1 selects the three color mode
+					_Write16(out, colorMin);
+					_Write16(out + 2, colorMax);
+				}
+				else
+				{
+					_Write16(out, colorMax);
+					_Write16(out + 2, colorMin);
+				}
+
+				_Write16(out + 4, indices & 0xFFFF);
+				_Write16(out + 6, indices >> 16);
+			}
+
+			/**
+			* Encode the alpha of a block into 8 bytes of BC3 alpha data.
+			*/
+			void _EncodeAlphaBlock(const unsigned char * block, unsigned char * out)
+			{
+				unsigned char minColor[4];
+				unsigned char maxColor[4];
+
+				_BlockMinMax(block, minColor, maxColor);
+
+				out[0] = maxColor[3];
+				out[1] = minColor[3];
+
+				unsigned long long bits = 0;
+
+				if (maxColor[3] != minColor[3])
+				{
+					float start[4] = { 0.0f, 0.0f, 0.0f, (float)minColor[3] };
+					float axis[4] = { 0.0f, 0.0f, 0.0f, (float)(maxColor[3] - minColor[3]) };
+
+					int t[16];
+					_ProjectBlock(block, start, axis, 7.0f, t);
+
+					//position along the line to the eight alpha index
+					const unsigned long long remap[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+
+					for (int i = 0; i < 16; ++i)
+						bits |= remap[t[i]] << (i * 3);
+				}
+
+				for (int i = 0; i < 6; ++i)
+					out[2 + i] = (unsigned char)((bits >> (i * 8)) & 0xFF);
+			}
+
+			void _CompressTexture(const unsigned char * image, int width, int height, TEXTURE_BLOCK_FORMAT format, bool allowTransparent, unsigned char * blocks)
+			{
+				int blocksX = _BlockCount(width);
+				int blocksY = _BlockCount(height);
+
+				unsigned char block[64];
+
+				for (int by = 0; by < blocksY; ++by)
+				{
+					for (int bx = 0; bx < blocksX; ++bx)
+					{
+						_FetchBlock(image, width, height, bx, by, block);
+
+						if (format == BLOCK_FORMAT_BC3)
+						{
+							_EncodeAlphaBlock(block, blocks);
+							_EncodeColorBlock(block, false, blocks + 8);
+							blocks += 16;
+						}
+						else
+						{
+							_EncodeColorBlock(block, allowTransparent, blocks);
+							blocks += 8;
+						}
+					}
+				}
+			}
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		std::size_t GetCompressedTextureSize(int width, int height, TEXTURE_BLOCK_FORMAT format)
+		{
+			std::size_t blockSize = (format == BLOCK_FORMAT_BC3) ? 16 : 8;
+
+			return (std::size_t)_BlockCount(width) * _BlockCount(height) * blockSize;
+		}
+
+		void CompressTexture(const unsigned char * image, int width, int height, TEXTURE_BLOCK_FORMAT format, unsigned char * blocks)
+		{
+			if (image == NULL || blocks == NULL || width <= 0 || height <= 0)
+				return;
+
+			_CompressTexture(image, width, height, format, true, blocks);
+		}
+
+		void DecompressTexture(const unsigned char * blocks, int width, int height, TEXTURE_BLOCK_FORMAT format, unsigned char * image)
+		{
+			if (image == NULL || blocks == NULL || width <= 0 || height <= 0)
+				return;
+
+			BIOSKY_TRACE_SCOPE("Decompress Texture");
+
+			int blocksX = _BlockCount(width);
+			int blocksY = _BlockCount(height);
+
+			for (int by = 0; by < blocksY; ++by)
+			{
+				for (int bx = 0; bx < blocksX; ++bx)
+				{
+					unsigned char alphas[8] = { 255, 255, 255, 255, 255, 255, 255, 255 };
+					unsigned long long alphaBits = 0;
+
+					if (format == BLOCK_FORMAT_BC3)
+					{
+						int a0 = blocks[0];
+						int a1 = blocks[1];
+
+						alphas[0] = (unsigned char)a0;
+						alphas[1] = (unsigned char)a1;
+
+						if (a0 > a1)
+						{
+							for (int i = 2; i < 8; ++i)
+								alphas[i] = (unsigned char)(((8 - i) * a0 + (i - 1) * a1) / 7);
+						}
+						else
+						{
+							for (int i = 2; i < 6; ++i)
+								alphas[i] = (unsigned char)(((6 - i) * a0 + (i - 1) * a1) / 5);
+
+							alphas[6] = 0;
+							alphas[7] = 255;
+						}
+
+						for (int i = 0; i < 6; ++i)
+							alphaBits |= ((unsigned long long)blocks[2 + i]) << (i * 8);
+
+						blocks += 8;
+					}
+
+					unsigned int color0 = _Read16(blocks);
+					unsigned int color1 = _Read16(blocks + 2);
+					unsigned int indices = _Read16(blocks + 4) | (_Read16(blocks + 6) << 16);
+					blocks += 8;
+
+					int c0[3];
+					int c1[3];
+					_From565((unsigned short)color0, c0);
+					_From565((unsigned short)color1, c1);
+
+					unsigned char palette[4][4];
+
+					for (int c = 0; c < 3; ++c)
+					{
+						palette[0][c] = (unsigned char)c0[c];
+						palette[1][c] = (unsigned char)c1[c];
+
+						if (color0 > color1 || format == BLOCK_FORMAT_BC3)
+						{
+							palette[2][c] = (unsigned char)((2 * c0[c] + c1[c]) / 3);
+							palette[3][c] = (unsigned char)((c0[c] + 2 * c1[c]) / 3);
+						}
+						else
+						{
+							palette[2][c] = (unsigned char)((c0[c] + c1[c]) / 2);
+							palette[3][c] = 0;
+						}
+					}
+
+					palette[0][3] = palette[1][3] = palette[2][3] = 255;
+					palette[3][3] = (color0 > color1 || format == BLOCK_FORMAT_BC3) ? 255 : 0;
+
+					for (int y = 0; y < 4; ++y)
+					{
+						int py = by * 4 + y;
+
+						if (py >= height)
+							break;
+
+						for (int x = 0; x < 4; ++x)
+						{
+							int px = bx * 4 + x;
+
+							if (px >= width)
+								break;
+
+							int i = y * 4 + x;
+							unsigned char * out = image + (py * width + px) * 4;
+
+							memcpy(out, palette[(indices >> (i * 2)) & 3], 4);
+
+							if (format == BLOCK_FORMAT_BC3)
+								out[3] = alphas[(alphaBits >> (i * 3)) & 7];
+						}
+					}
+				}
+			}
+		}
+
+		CompressedTexture::CompressedTexture(const TextureMipChain & chain, TEXTURE_BLOCK_FORMAT format, bool separateAlpha) :
+			_format(format),
+			_data(NULL),
+			_dataSize(0),
+			_levels(NULL),
+			_numLevels(chain.GetLevelCount())
+		{
+			_levels = AllocateArray<Level>(_numLevels);
+
+			for (int i = 0; i < _numLevels; ++i)
+			{
+				const TextureMipChain::Level & source = chain.GetLevel(i);
+
+				_levels[i].width = source.width;
+				_levels[i].height = source.height;
+				_levels[i].blocksSize = GetCompressedTextureSize(source.width, source.height, format);
+
+				_dataSize += _levels[i].blocksSize;
+
+				if (separateAlpha)
+					_dataSize += (std::size_t)source.width * source.height;
+			}
+
+			_data = (unsigned char *)Allocate(_dataSize);
+
+			unsigned char * next = _data;
+
+			for (int i = 0; i < _numLevels; ++i)
+			{
+				const TextureMipChain::Level & source = chain.GetLevel(i);
+				Level & level = _levels[i];
+
+				//when the alpha is kept separately the color blocks stay
+				//opaque so the alpha can change without re-encoding.
+				_CompressTexture(source.pixels, source.width, source.height, format, !separateAlpha, next);
+				level.blocks = next;
+				next += level.blocksSize;
+
+				level.alpha = NULL;
+
+				if (separateAlpha)
+				{
+					int count = source.width * source.height;
+
+					for (int p = 0; p < count; ++p)
+						next[p] = source.pixels[p * 4 + 3];
+
+					level.alpha = next;
+					next += count;
+				}
+			}
+		}
+
+		CompressedTexture::~CompressedTexture()
+		{
+			if (_data)
+			{
+				Free(_data);
+				_data = NULL;
+			}
+
+			if (_levels)
+			{
+				FreeArray(_levels);
+				_levels = NULL;
+			}
+
+			_dataSize = 0;
+			_numLevels = 0;
+		}
+
+#if BIOSKY_TESTING == 1
+		bool CompressedTexture::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("Texture Compression Tests");
+
+			test->UnitTest(GetCompressedTextureSize(256, 256, BLOCK_FORMAT_BC1) == 256 * 256 / 2, "BC1 size");
+			test->UnitTest(GetCompressedTextureSize(256, 256, BLOCK_FORMAT_BC3) == 256 * 256, "BC3 size");
+			test->UnitTest(GetCompressedTextureSize(5, 1, BLOCK_FORMAT_BC1) == 16, "BC1 partial block size");
+			test->UnitTest(GetCompressedTextureSize(1, 1, BLOCK_FORMAT_BC3) == 16, "BC3 1x1 size");
+
+			unsigned char image[16 * 16 * 4];
+			unsigned char decoded[16 * 16 * 4];
+			unsigned char blocks[16 * 16];
+
+			//a solid color that is exact in 565
+			for (int i = 0; i < 16 * 16; ++i)
+			{
+				image[i * 4] = 0x08;
+				image[i * 4 + 1] = 0x82;
+				image[i * 4 + 2] = 0xFF;
+				image[i * 4 + 3] = 255;
+			}
+
+			CompressTexture(image, 16, 16, BLOCK_FORMAT_BC1, blocks);
+			DecompressTexture(blocks, 16, 16, BLOCK_FORMAT_BC1, decoded);
+			test->UnitTest(memcmp(image, decoded, sizeof(image)) == 0, "BC1 solid color round trip");
+
+			//smooth gradient with a gradient alpha
+			for (int y = 0; y < 16; ++y)
+			{
+				for (int x = 0; x < 16; ++x)
+				{
+					unsigned char * p = image + (y * 16 + x) * 4;
+					p[0] = (unsigned char)(x * 16);
+					p[1] = (unsigned char)(x * 8);
+					p[2] = (unsigned char)(128 + x * 4);
+					p[3] = (unsigned char)(y * 16 + x);
+				}
+			}
+
+			CompressTexture(image, 16, 16, BLOCK_FORMAT_BC3, blocks);
+			DecompressTexture(blocks, 16, 16, BLOCK_FORMAT_BC3, decoded);
+
+			int maxColorError = 0;
+			int maxAlphaError = 0;
+			for (int i = 0; i < 16 * 16; ++i)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					int error = std::abs(image[i * 4 + c] - decoded[i * 4 + c]);
+					if (error > maxColorError)
+						maxColorError = error;
+				}
+
+				int error = std::abs(image[i * 4 + 3] - decoded[i * 4 + 3]);
+				if (error > maxAlphaError)
+					maxAlphaError = error;
+			}
+			test->UnitTest(maxColorError <= 12, "BC3 gradient color error");
+			test->UnitTest(maxAlphaError <= 4, "BC3 gradient alpha error");
+
+			//BC1 punch through alpha
+			for (int i = 0; i < 16 * 16; ++i)
+				image[i * 4 + 3] = (i % 3 == 0) ? 0 : 255;
+
+			CompressTexture(image, 16, 16, BLOCK_FORMAT_BC1, blocks);
+			DecompressTexture(blocks, 16, 16, BLOCK_FORMAT_BC1, decoded);
+
+			bool alphaMatches = true;
+			for (int i = 0; i < 16 * 16; ++i)
+			{
+				if (decoded[i * 4 + 3] != image[i * 4 + 3])
+					alphaMatches = false;
+			}
+			test->UnitTest(alphaMatches, "BC1 transparent pixels");
+
+			//odd sizes
+			CompressTexture(image, 7, 3, BLOCK_FORMAT_BC1, blocks);
+			DecompressTexture(blocks, 7, 3, BLOCK_FORMAT_BC1, decoded);
+			test->UnitTest(decoded[3] == image[3], "BC1 partial block");
+
+			//compressed mip chain
+			for (int i = 0; i < 16 * 16; ++i)
+				image[i * 4 + 3] = (unsigned char)i;
+
+			TextureMipChain chain(image, 16, 16);
+			CompressedTexture compressed(chain, BLOCK_FORMAT_BC1, true);
+
+			test->UnitTest(compressed.GetFormat() == BLOCK_FORMAT_BC1, "Compressed format");
+			test->UnitTest(compressed.GetLevelCount() == 5, "Compressed level count");
+			test->UnitTest(compressed.GetLevel(4).width == 1 && compressed.GetLevel(4).blocksSize == 8, "Compressed last level");
+			test->UnitTest(compressed.GetDataSize() == (128 + 32 + 8 + 8 + 8) + (256 + 64 + 16 + 4 + 1), "Compressed data size");
+			test->UnitTest(compressed.GetLevel(0).alpha != NULL && compressed.GetLevel(0).alpha[200] == 200, "Separate alpha plane");
+
+			DecompressTexture(compressed.GetLevel(0).blocks, 16, 16, BLOCK_FORMAT_BC1, decoded);
+			bool opaque = true;
+			for (int i = 0; i < 16 * 16; ++i)
+			{
+				if (decoded[i * 4 + 3] != 255)
+					opaque = false;
+			}
+			test->UnitTest(opaque, "Separate alpha keeps color blocks opaque");
+
+			CompressedTexture inline3(chain, BLOCK_FORMAT_BC3);
+			test->UnitTest(inline3.GetLevel(0).alpha == NULL, "No separate alpha plane");
+			test->UnitTest(inline3.GetDataSize() == 256 + 64 + 16 + 16 + 16, "BC3 data size");
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,432 @@
+/**
+* @file TextureMipChain.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implementation of the TextureMipChain class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+#include "TextureMipChain.hpp"
+#include "Allocator.hpp"
+
+#include <cstring>
+
+#if BIOSKY_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if BIOSKY_TESTING == 1
+#include <cstdlib>
+#endif
+
+namespace BIO
+{
+	namespace SKY
+	{
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		//					Private Functions
+		///////////////////////////////////////////////////////////////////////
+		///////////////////////////////////////////////////////////////////////
+		namespace
+		{
+			inline int _NextLevelSize(int size)
+			{
+				return (size > 1) ? size / 2 : 1;
+			}
+
+#if BIOSKY_USE_SSE2
+			/**
+			* Load one BGRA pixel into the four lanes of a float register.
+			*/
+			inline __m128 _LoadPixel(const unsigned char * p)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				int packed;
+				memcpy(&packed, p, 4);
+
+				__m128i px = _mm_cvtsi32_si128(packed);
+				px = _mm_unpacklo_epi8(px, zero);
+				px = _mm_unpacklo_epi16(px, zero);
+
+				return _mm_cvtepi32_ps(px);
+			}
+
+			/**
+			* Filter one 2x2 block of pixels into one pixel.
+			*/
+			inline void _FilterPixel(const unsigned char * p0, const unsigned char * p1, const unsigned char * p2, const unsigned char * p3, unsigned char * out)
+			{
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 quarter = _mm_set1_ps(0.25f);
+				const __m128 alphaLane = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+				__m128 c0 = _LoadPixel(p0);
+				__m128 c1 = _LoadPixel(p1);
+				__m128 c2 = _LoadPixel(p2);
+				__m128 c3 = _LoadPixel(p3);
+
+				__m128 a0 = _mm_shuffle_ps(c0, c0, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 a1 = _mm_shuffle_ps(c1, c1, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 a2 = _mm_shuffle_ps(c2, c2, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 a3 = _mm_shuffle_ps(c3, c3, _MM_SHUFFLE(3, 3, 3, 3));
+
+				__m128 sumA = _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3));
+
+				__m128 premul = _mm_add_ps(
+					_mm_add_ps(_mm_mul_ps(c0, a0), _mm_mul_ps(c1, a1)),
+					_mm_add_ps(_mm_mul_ps(c2, a2), _mm_mul_ps(c3, a3)));
+
+				__m128 plain = _mm_mul_ps(_mm_add_ps(_mm_add_ps(c0, c1), _mm_add_ps(c2, c3)), quarter);
+
+				//if the whole block is transparent fall back to a plain average
+				//so the color under the transparent area is still sensible.
+				__m128 hasAlpha = _mm_cmpgt_ps(sumA, zero);
+				__m128 weighted = _mm_div_ps(premul, _mm_max_ps(sumA, _mm_set1_ps(1.0f)));
+				__m128 color = _mm_or_ps(_mm_and_ps(hasAlpha, weighted), _mm_andnot_ps(hasAlpha, plain));
+
+				__m128 result = _mm_or_ps(_mm_and_ps(alphaLane, _mm_mul_ps(sumA, quarter)), _mm_andnot_ps(alphaLane, color));
+
+				__m128i packed = _mm_cvtps_epi32(result);
+				packed = _mm_packs_epi32(packed, packed);
+				packed = _mm_packus_epi16(packed, packed);
+
+				int value = _mm_cvtsi128_si32(packed);
+				memcpy(out, &value, 4);
+			}
+#else
+			/**
+			* Filter one 2x2 block of pixels into one pixel.
+			*/
+			inline void _FilterPixel(const unsigned char * p0, const unsigned char * p1, const unsigned char * p2, const unsigned char * p3, unsigned char * out)
+			{
+				float a0 = p0[3];
+				float a1 = p1[3];
+				float a2 = p2[3];
+				float a3 = p3[3];
+
+				float sumA = a0 + a1 + a2 + a3;
+
+				for (int c = 0; c < 3; ++c)
+				{
+					float value;
+
+					if (sumA > 0.0f)
+						value = (p0[c] * a0 + p1[c] * a1 + p2[c] * a2 + p3[c] * a3) / sumA;
+					else
+						value = (p0[c] + p1[c] + p2[c] + p3[c]) * 0.25f;
+
+					out[c] = (unsigned char)(value + 0.5f);
+				}
+
+				out[3] = (unsigned char)(sumA * 0.25f + 0.5f);
+			}
+#endif
+		}
+		//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+		//			End private functions
+		///////////////////////////////////////////////////////////////////////
+
+		TextureMipChain::TextureMipChain(const unsigned char * image, int width, int height, int maxSize) :
+			_data(NULL),
+			_dataSize(0),
+			_levels(NULL),
+			_numLevels(0)
+		{
+			unsigned char blank[4] = { 0, 0, 0, 0 };
+
+			if (image == NULL || width <= 0 || height <= 0)
+			{
+				//nothing to filter. Keep a single transparent pixel so the
+				//chain always has at least one level.
+				image = blank;
+				width = 1;
+				height = 1;
+			}
+
+			//skip the levels that are larger than maxSize
+			int firstLevel = 0;
+			int firstWidth = width;
+			int firstHeight = height;
+
+			if (maxSize > 0)
+			{
+				while ((firstWidth > maxSize || firstHeight > maxSize) && (firstWidth > 1 || firstHeight > 1))
+				{
+					firstWidth = _NextLevelSize(firstWidth);
+					firstHeight = _NextLevelSize(firstHeight);
+					++firstLevel;
+				}
+			}
+
+			_numLevels = CalculateLevelCount(firstWidth, firstHeight);
+			_levels = AllocateArray<Level>(_numLevels);
+
+			int w = firstWidth;
+			int h = firstHeight;
+
+			for (int i = 0; i < _numLevels; ++i)
+			{
+				_levels[i].width = w;
+				_levels[i].height = h;
+				_dataSize += (std::size_t)w * h * 4;
+
+				w = _NextLevelSize(w);
+				h = _NextLevelSize(h);
+			}
+
+			_data = (unsigned char *)Allocate(_dataSize);
+
+			std::size_t offset = 0;
+			for (int i = 0; i < _numLevels; ++i)
+			{
+				_levels[i].pixels = _data + offset;
+				offset += (std::size_t)_levels[i].width * _levels[i].height * 4;
+			}
+
+			//create the first level
+			if (firstLevel == 0)
+			{
+				memcpy(_data, image, (std::size_t)width * height * 4);
+			}
+			else
+			{
+				//filter down through the levels that are not kept. Two
+				//scratch buffers are used one after the other.
+				int w1 = _NextLevelSize(width);
+				int h1 = _NextLevelSize(height);
+				std::size_t size1 = (std::size_t)w1 * h1 * 4;
+				std::size_t size2 = (std::size_t)_NextLevelSize(w1) * _NextLevelSize(h1) * 4;
+
+				unsigned char * scratch = (unsigned char *)Allocate(size1 + size2);
+				unsigned char * buffers[2] = { scratch, scratch + size1 };
+
+				const unsigned char * src = image;
+				w = width;
+				h = height;
+
+				for (int i = 1; i <= firstLevel; ++i)
+				{
+					unsigned char * dst = (i == firstLevel) ? _data : buffers[(i - 1) & 1];
+
+					Downsample(src, w, h, dst);
+
+					src = dst;
+					w = _NextLevelSize(w);
+					h = _NextLevelSize(h);
+				}
+
+				Free(scratch);
+			}
+
+			for (int i = 1; i < _numLevels; ++i)
+			{
+				Downsample(_levels[i - 1].pixels, _levels[i - 1].width, _levels[i - 1].height, const_cast<unsigned char *>(_levels[i].pixels));
+			}
+		}
+
+		TextureMipChain::~TextureMipChain()
+		{
+			if (_data)
+			{
+				Free(_data);
+				_data = NULL;
+			}
+
+			if (_levels)
+			{
+				FreeArray(_levels);
+				_levels = NULL;
+			}
+
+			_dataSize = 0;
+			_numLevels = 0;
+		}
+
+		int TextureMipChain::FindLevelForSize(int maxSize) const
+		{
+			for (int i = 0; i < _numLevels; ++i)
+			{
+				if (_levels[i].width <= maxSize && _levels[i].height <= maxSize)
+					return i;
+			}
+
+			return _numLevels - 1;
+		}
+
+		void TextureMipChain::Downsample(const unsigned char * src, int srcWidth, int srcHeight, unsigned char * dst)
+		{
+			int dstWidth = _NextLevelSize(srcWidth);
+			int dstHeight = _NextLevelSize(srcHeight);
+
+			int rowSize = srcWidth * 4;
+
+			for (int y = 0; y < dstHeight; ++y)
+			{
+				int sy0 = y * 2;
+				int sy1 = (sy0 + 1 < srcHeight) ? sy0 + 1 : srcHeight - 1;
+
+				const unsigned char * row0 = src + sy0 * rowSize;
+				const unsigned char * row1 = src + sy1 * rowSize;
+
+				unsigned char * out = dst + y * dstWidth * 4;
+
+				for (int x = 0; x < dstWidth; ++x)
+				{
+					int sx0 = x * 2;
+					int sx1 = (sx0 + 1 < srcWidth) ? sx0 + 1 : srcWidth - 1;
+
+					_FilterPixel(row0 + sx0 * 4, row0 + sx1 * 4, row1 + sx0 * 4, row1 + sx1 * 4, out + x * 4);
+				}
+			}
+		}
+
+		int TextureMipChain::CalculateLevelCount(int width, int height)
+		{
+			if (width <= 0 || height <= 0)
+				return 0;
+
+			int count = 1;
+
+			while (width > 1 || height > 1)
+			{
+				width = _NextLevelSize(width);
+				height = _NextLevelSize(height);
+				++count;
+			}
+
+			return count;
+		}
+
+#if BIOSKY_TESTING == 1
+		bool TextureMipChain::Test(XNELO::TESTING::Test * test)
+		{
+			test->SetName("TextureMipChain Tests");
+
+			test->UnitTest(CalculateLevelCount(1, 1) == 1, "Level count 1x1");
+			test->UnitTest(CalculateLevelCount(256, 256) == 9, "Level count 256x256");
+			test->UnitTest(CalculateLevelCount(4096, 4096) == 13, "Level count 4096x4096");
+			test->UnitTest(CalculateLevelCount(8, 2) == 4, "Level count 8x2");
+			test->UnitTest(CalculateLevelCount(0, 4) == 0, "Level count invalid");
+
+			//2x2 filter with premultiplied alpha.
+			unsigned char block[16] = {
+				200, 100, 50, 255,		0, 0, 0, 0,
+				0, 0, 0, 0,				0, 0, 0, 0 };
+			unsigned char out[4] = { 0, 0, 0, 0 };
+
+			Downsample(block, 2, 2, out);
+
+			test->UnitTest(out[0] == 200 && out[1] == 100 && out[2] == 50, "Transparent pixels do not darken the color");
+			test->UnitTest(out[3] == 64, "Alpha is averaged");
+
+			unsigned char clear[16] = {
+				40, 80, 120, 0,		40, 80, 120, 0,
+				0, 0, 0, 0,			0, 0, 0, 0 };
+			Downsample(clear, 2, 2, out);
+			test->UnitTest(out[0] == 20 && out[1] == 40 && out[2] == 60 && out[3] == 0, "Fully transparent block uses plain average");
+
+			unsigned char opaque[16] = {
+				10, 20, 30, 255,	30, 40, 50, 255,
+				50, 60, 70, 255,	70, 80, 90, 255 };
+			Downsample(opaque, 2, 2, out);
+			test->UnitTest(out[0] == 40 && out[1] == 50 && out[2] == 60 && out[3] == 255, "Opaque block is a plain average");
+
+			//Odd sizes clamp the last column
+			unsigned char odd[12] = { 0, 0, 0, 255,		100, 100, 100, 255,		250, 250, 250, 255 };
+			Downsample(odd, 3, 1, out);
+			test->UnitTest(out[0] == 50 && out[3] == 255, "Odd width filter");
+
+			//compare against a simple reference for a random image
+			const int size = 37;
+			unsigned char * image = new unsigned char[size * size * 4];
+			srand(1234);
+			for (int i = 0; i < size * size * 4; ++i)
+				image[i] = (unsigned char)(rand() & 0xFF);
+
+			const int half = size / 2;
+			unsigned char * filtered = new unsigned char[half * half * 4];
+			Downsample(image, size, size, filtered);
+
+			bool matches = true;
+			for (int y = 0; y < half; ++y)
+			{
+				for (int x = 0; x < half; ++x)
+				{
+					const unsigned char * p[4] = {
+						image + ((y * 2) * size + x * 2) * 4,
+						image + ((y * 2) * size + x * 2 + 1) * 4,
+						image + ((y * 2 + 1) * size + x * 2) * 4,
+						image + ((y * 2 + 1) * size + x * 2 + 1) * 4 };
+
+					int sumA = p[0][3] + p[1][3] + p[2][3] + p[3][3];
+					const unsigned char * o = filtered + (y * half + x) * 4;
+
+					for (int c = 0; c < 3; ++c)
+					{
+						int premul = p[0][c] * p[0][3] + p[1][c] * p[1][3] + p[2][c] * p[2][3] + p[3][c] * p[3][3];
+						int expected = (sumA > 0) ? (premul + sumA / 2) / sumA : (p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4;
+
+						if (std::abs(expected - (int)o[c]) > 1)
+							matches = false;
+					}
+
+					if (std::abs((sumA + 2) / 4 - (int)o[3]) > 1)
+						matches = false;
+				}
+			}
+			test->UnitTest(matches, "Filter matches reference");
+
+			TextureMipChain chain(image, size, size);
+			test->UnitTest(chain.GetLevelCount() == 6, "Chain level count");
+			test->UnitTest(chain.GetLevel(0).width == size && chain.GetLevel(0).height == size, "Chain level 0 size");
+			test->UnitTest(memcmp(chain.GetLevel(0).pixels, image, size * size * 4) == 0, "Chain level 0 data");
+			test->UnitTest(memcmp(chain.GetLevel(1).pixels, filtered, half * half * 4) == 0, "Chain level 1 data");
+			test->UnitTest(chain.GetLevel(5).width == 1 && chain.GetLevel(5).height == 1, "Chain last level is 1x1");
+			test->UnitTest(chain.GetLevel(1).pixels == chain.GetLevel(0).pixels + size * size * 4, "Chain levels are contiguous");
+			test->UnitTest(chain.GetLevel(100).width == 1, "Chain level index clamped");
+			test->UnitTest(chain.FindLevelForSize(18) == 1, "Find level for size [1]");
+			test->UnitTest(chain.FindLevelForSize(17) == 2, "Find level for size [2]");
+			test->UnitTest(chain.FindLevelForSize(0) == 5, "Find level for size [3]");
+
+			TextureMipChain reduced(image, size, size, 10);
+			test->UnitTest(reduced.GetLevelCount() == 4, "Reduced chain level count");
+			test->UnitTest(reduced.GetLevel(0).width == 9, "Reduced chain first level size");
+			test->UnitTest(memcmp(reduced.GetLevel(0).pixels, chain.GetLevel(2).pixels, 9 * 9 * 4) == 0, "Reduced chain matches full chain");
+			test->UnitTest(reduced.GetDataSize() == (9 * 9 + 4 * 4 + 2 * 2 + 1) * 4, "Reduced chain data size");
+
+			delete[] filtered;
+			delete[] image;
+
+			return test->GetSuccess();
+		}
+#endif
+	}//end namespace SKY
+}//end namespace BIO
@@ -0,0 +1,225 @@
+/**
+* @file Timestamp.cpp
+* @author Spencer Hoffa
+*
+* @copyright 2015 Spencer Hoffa
+*
+* Implements the Timestamp class.
+*/
+/*
+* The zlib/libpng License
+*
+* Copyright (c) 2015 Spencer Hoffa
+*
+* This software is provided 'as-is', without any express or implied warranty.
+* In no event will the authors be held liable for any damages arising from the
+* use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+*		1. The origin of this software must not be misrepresented; you must not
+*		claim that you wrote the original software. If you use this software in
+*		a product, an acknowledgment in the product documentation would be
+*		appreciated but is not required.
+*
+*		2. Altered source versions must be plainly marked as such, and must not
+*		be misrepresented as being the original software.
+*
+*		3. This notice may not be removed or altered from any source
+*		distribution.
+*
+* This liscense can also be found at: http://opensource.org/licenses/Zlib
+*/
+
+
+#include "Timestamp.hpp"
+
+#include <cmath>
+
+#if BIOSKY_TESTING == 1
+#include "DateTime.hpp"
+#include "BIOSkyFunctions.hpp"
+#endif
+
+namespace BIO
+{
+	///////////////////////////////////////////////////////////////////////////
+	///////////////////////////////////////////////////////////////////////////
+	//
+	//				Private Functions
+	//
+	///////////////////////////////////////////////////////////////////////////
+	///////////////////////////////////////////////////////////////////////////
+	namespace
+	{
+		/**The day number (Date::GetDayNumber) of 2000 January 1.*/
+		const long long _J2000DayNumber = 10957;
+
+		/**Half a day. J2000.0 is at noon.*/
+		const long long _HalfDay = Timestamp::MicrosecondsPerDay / 2;
+
+		long long _Round(double value)
+		{
+			return (long long)std::floor(value + 0.5);
+		}
+
+		/**
+		* The number of whole days since midnight before J2000.0, rounded
+		* down so times before 2000 fall on the right day.
+		*/
+		long long _DaysSinceJ2000Midnight(long long microseconds)
+		{
+			long long shifted = microseconds + _HalfDay;
+			long long days = shifted / Timestamp::MicrosecondsPerDay;
+
+			if ((shifted % Timestamp::MicrosecondsPerDay) < 0)
+				days--;
+
+			return days;
+		}
+	}
+	//^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
+	//			  End Private Functions
+	///////////////////////////////////////////////////////////////////////////
+
+	Timestamp Timestamp::FromCalendar(double standardTime, double UTCoffset, DATE_MONTH month, unsigned int day, unsigned int year)
+	{
+		long long days = Date::DaysFromCivil(month, day, year) - _J2000DayNumber;
+
+		return Timestamp(days * MicrosecondsPerDay - _HalfDay + _Round((standardTime - UTCoffset) * 3600000000.0));
+	}
+
+	Timestamp Timestamp::FromJulianDay(double julianDay)
+	{
+		return Timestamp(_Round((julianDay - 2451545.0) * (double)MicrosecondsPerDay));
+	}
+
+	void Timestamp::AddSeconds(double seconds)
+	{
+		_microseconds += _Round(seconds * 1000000.0);
+	}
+
+	double Timestamp::GetUniversalTimeHours() const
+	{
+		long long days = _DaysSinceJ2000Midnight(_microseconds);
+		long long ofDay = _microseconds + _HalfDay - days * MicrosecondsPerDay;
+
+		return (double)ofDay / 3600000000.0;
+	}
+
+	Date Timestamp::GetUniversalDate() const
+	{
+		Date date;
+		date.SetDayNumber(_DaysSinceJ2000Midnight(_microseconds) + _J2000DayNumber);
+		return date;
+	}
+
+#if BIOSKY_TESTING == 1
+	bool Timestamp::Test(XNELO::TESTING::Test * test)
+	{
+		test->SetName("Timestamp Tests");
+
+		Timestamp t;
+		test->UnitTest(t.GetMicroseconds() == 0, "Test default is J2000");
+		test->UnitTest(t.GetJulianDay() == 2451545.0, "Test Julian day of J2000");
+		test->UnitTest(t.GetDaysSinceJan02000() == 1.5, "Test days since Jan 0 of J2000");
+		test->UnitTest(t.GetUniversalTimeHours() == 12.0, "Test time of day of J2000");
+		test->UnitTest(t.GetUniversalDate() == Date(JANUARY, 1, 2000), "Test date of J2000");
+
+		test->UnitTest(FromCalendar(12.0, 0.0, JANUARY, 1, 2000) == t, "Test FromCalendar [1]");
+		test->UnitTest(FromCalendar(5.0, -7.0, JANUARY, 1, 2000) == t, "Test FromCalendar [2]");
+		test->UnitTest(FromCalendar(0.0, 0.0, JANUARY, 1, 1970).GetMicroseconds() == -946728000000000LL, "Test FromCalendar [3]");
+
+		//NREL SPA example: 2003 October 17 19:30:30 UT
+		t = FromCalendar(12.5 + 30.0 / 3600.0, -7.0, OCTOBER, 17, 2003);
+		test->UnitTest(std::fabs(t.GetJulianDay() - 2452930.312847) < 1e-6, "Test GetJulianDay");
+		long long julianError = FromJulianDay(t.GetJulianDay()).GetMicroseconds() - t.GetMicroseconds();
+		test->UnitTest((julianError < 100) && (julianError > -100), "Test FromJulianDay");
+		test->UnitTest(t.GetUniversalDate() == Date(OCTOBER, 17, 2003), "Test GetUniversalDate");
+		test->UnitTest(std::fabs(t.GetUniversalTimeHours() - (19.5 + 30.0 / 3600.0)) < 1e-12, "Test GetUniversalTimeHours");
+
+		//the day count the sky functions use. DaysSinceJan02000 is only
+		//good from March 1900 to February 2100.
+		bool daysMatch = true;
+		for (unsigned int year = 1901; year <= 2099; year += 7)
+		{
+			for (int month = 1; month <= 12; month++)
+			{
+				Timestamp noon = FromCalendar(13.0, 1.0, Date::IntToMonth(month), 13, year);
+				double expected = SKY::DaysSinceJan02000(Date::IntToMonth(month), 13, year) + 0.5;
+
+				if (noon.GetDaysSinceJan02000() != expected)
+					daysMatch = false;
+			}
+		}
+		test->UnitTest(daysMatch, "Test GetDaysSinceJan02000 matches DaysSinceJan02000");
+
+		//before 2000 the day still starts at midnight
+		t = FromCalendar(23.5, 0.0, DECEMBER, 31, 1969);
+		test->UnitTest(t.GetUniversalDate() == Date(DECEMBER, 31, 1969), "Test date before 2000 [1]");
+		test->UnitTest(t.GetUniversalTimeHours() == 23.5, "Test date before 2000 [2]");
+		t.AddSeconds(1800.0);
+		test->UnitTest(t.GetUniversalDate() == Date(JANUARY, 1, 1970), "Test date before 2000 [3]");
+		test->UnitTest(t.GetUniversalTimeHours() == 0.0, "Test date before 2000 [4]");
+
+		//a microsecond is kept far from 2000
+		Timestamp far = FromCalendar(6.0, 0.0, MARCH, 1, 2150);
+		Timestamp farNext = far;
+		farNext.AddMicroseconds(1);
+		test->UnitTest(far < farNext && far != farNext, "Test microsecond far from J2000 [1]");
+		test->UnitTest(farNext.GetDaysSinceJan02000() > far.GetDaysSinceJan02000(), "Test microsecond far from J2000 [2]");
+
+		//DateTime to Timestamp and back is exact
+		const float times[] = { 0.0f, 0.25f, 15389.2f, 43200.0f, 86399.99f };
+		const float offsets[] = { 0.0f, -7.0f, 5.5f, 12.0f };
+		bool roundTrip = true;
+		for (int i = 0; i < 5; i++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				DateTime original;
+				original.SetDate(DECEMBER, 31, 1999);
+				original.SetTime(times[i]);
+				original.SetUTCOffset(offsets[j]);
+
+				DateTime copy;
+				copy.SetUTCOffset(offsets[j]);
+				copy.SetTimestamp(original.GetTimestamp());
+
+				if (copy != original)
+					roundTrip = false;
+			}
+		}
+		test->UnitTest(roundTrip, "Test DateTime round trip");
+
+		DateTime local;
+		local.SetDate(DECEMBER, 31, 1999);
+		local.SetTimeHours(23.0f);
+		local.SetUTCOffset(-7.0f);
+		t = local.GetTimestamp();
+		test->UnitTest(t.GetUniversalDate() == Date(JANUARY, 1, 2000), "Test DateTime to Timestamp [1]");
+		test->UnitTest(t.GetUniversalTimeHours() == 6.0, "Test DateTime to Timestamp [2]");
+
+		local.SetUTCOffset(2.0f);
+		local.SetTimestamp(t);
+		test->UnitTest(local.GetDate() == Date(JANUARY, 1, 2000), "Test Timestamp to DateTime [1]");
+		test->UnitTest(local.GetTimeHours() == 8.0f, "Test Timestamp to DateTime [2]");
+
+		//the sky from a timestamp agrees with the sky from the calendar
+		float latitude = 0.7155849933f, longitude = -1.954768762f;
+		SKY::SkyData fromCalendar = SKY::CalculateSkyData(14.5f, -7.0f, JUNE, 6, 2003, latitude, longitude);
+		SKY::SkyData fromTimestamp = SKY::CalculateSkyData(FromCalendar(14.5, -7.0, JUNE, 6, 2003), latitude, longitude);
+		test->UnitTest(fromTimestamp.sunPos.Azimuth, fromCalendar.sunPos.Azimuth, 0.0001f, "Test sky from timestamp [1]");
+		test->UnitTest(fromTimestamp.sunPos.Zenith, fromCalendar.sunPos.Zenith, 0.0001f, "Test sky from timestamp [2]");
+		test->UnitTest(fromTimestamp.moonPos.Azimuth, fromCalendar.moonPos.Azimuth, 0.0001f, "Test sky from timestamp [3]");
+		test->UnitTest(fromTimestamp.moonPos.Zenith, fromCalendar.moonPos.Zenith, 0.0001f, "Test sky from timestamp [4]");
+		test->UnitTest(fromTimestamp.phase, fromCalendar.phase, 0.001f, "Test sky from timestamp [5]");
+		test->UnitTest(fromTimestamp.starRotation, fromCalendar.starRotation, 0.0001f, "Test sky from timestamp [6]");
+
+		return test->GetSuccess();
+	}
+#endif
+
+}//end namespace BIO